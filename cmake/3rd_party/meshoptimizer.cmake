@@ -0,0 +1,6 @@
+option(MESHOPT_BUILD_DEMO "Build demo" OFF)
+option(MESHOPT_BUILD_GLTFPACK "Build gltfpack" OFF)
+option(MESHOPT_BUILD_SHARED_LIBS "Build shared libraries" OFF)
+option(MESHOPT_INSTALL "Install library" OFF)
+
+add_subdirectory(meshoptimizer)
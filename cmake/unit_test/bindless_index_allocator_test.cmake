@@ -0,0 +1,16 @@
+add_executable(bindless_index_allocator_test bindless_index_allocator_test.cpp)
+
+set_target_properties(bindless_index_allocator_test PROPERTIES CXX_STANDARD 17 OUTPUT_NAME "bindless_index_allocator_test")
+# set_target_properties(bindless_index_allocator_test PROPERTIES FOLDER "Engine")
+
+target_include_directories(bindless_index_allocator_test PUBLIC ${ENGINE_ROOT_DIR}/source)
+target_compile_options(bindless_index_allocator_test PUBLIC "$<$<COMPILE_LANG_AND_ID:CXX,MSVC>:/WX->")
+target_link_libraries(bindless_index_allocator_test PUBLIC EngineRuntime)
+# target_compile_definitions(bindless_index_allocator_test PUBLIC UNIT_TEST)
+
+set(POST_BINDLESS_INDEX_ALLOCATOR_TEST_COMMANDS
+    COMMAND ${CMAKE_COMMAND} -E make_directory "${BINARY_ROOT_DIR}/unit_test"
+    COMMAND ${CMAKE_COMMAND} -E copy "$<TARGET_FILE:bindless_index_allocator_test>" "${BINARY_ROOT_DIR}/unit_test/"
+)
+
+add_custom_command(TARGET bindless_index_allocator_test ${POST_BINDLESS_INDEX_ALLOCATOR_TEST_COMMANDS})
\ No newline at end of file
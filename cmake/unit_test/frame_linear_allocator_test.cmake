@@ -0,0 +1,16 @@
+add_executable(frame_linear_allocator_test frame_linear_allocator_test.cpp)
+
+set_target_properties(frame_linear_allocator_test PROPERTIES CXX_STANDARD 17 OUTPUT_NAME "frame_linear_allocator_test")
+# set_target_properties(frame_linear_allocator_test PROPERTIES FOLDER "Engine")
+
+target_include_directories(frame_linear_allocator_test PUBLIC ${ENGINE_ROOT_DIR}/source)
+target_compile_options(frame_linear_allocator_test PUBLIC "$<$<COMPILE_LANG_AND_ID:CXX,MSVC>:/WX->")
+target_link_libraries(frame_linear_allocator_test PUBLIC EngineRuntime)
+# target_compile_definitions(frame_linear_allocator_test PUBLIC UNIT_TEST)
+
+set(POST_FRAME_LINEAR_ALLOCATOR_TEST_COMMANDS
+    COMMAND ${CMAKE_COMMAND} -E make_directory "${BINARY_ROOT_DIR}/unit_test"
+    COMMAND ${CMAKE_COMMAND} -E copy "$<TARGET_FILE:frame_linear_allocator_test>" "${BINARY_ROOT_DIR}/unit_test/"
+)
+
+add_custom_command(TARGET frame_linear_allocator_test ${POST_FRAME_LINEAR_ALLOCATOR_TEST_COMMANDS})
\ No newline at end of file
@@ -0,0 +1,16 @@
+add_executable(image_decode_test image_decode_test.cpp)
+
+set_target_properties(image_decode_test PROPERTIES CXX_STANDARD 17 OUTPUT_NAME "image_decode_test")
+# set_target_properties(image_decode_test PROPERTIES FOLDER "Engine")
+
+target_include_directories(image_decode_test PUBLIC ${ENGINE_ROOT_DIR}/source)
+target_compile_options(image_decode_test PUBLIC "$<$<COMPILE_LANG_AND_ID:CXX,MSVC>:/WX->")
+target_link_libraries(image_decode_test PUBLIC EngineRuntime)
+# target_compile_definitions(image_decode_test PUBLIC UNIT_TEST)
+
+set(POST_IMAGE_DECODE_TEST_COMMANDS
+    COMMAND ${CMAKE_COMMAND} -E make_directory "${BINARY_ROOT_DIR}/unit_test"
+    COMMAND ${CMAKE_COMMAND} -E copy "$<TARGET_FILE:image_decode_test>" "${BINARY_ROOT_DIR}/unit_test/"
+)
+
+add_custom_command(TARGET image_decode_test ${POST_IMAGE_DECODE_TEST_COMMANDS})
\ No newline at end of file
@@ -0,0 +1,16 @@
+add_executable(indirect_draw_test indirect_draw_test.cpp)
+
+set_target_properties(indirect_draw_test PROPERTIES CXX_STANDARD 17 OUTPUT_NAME "indirect_draw_test")
+# set_target_properties(indirect_draw_test PROPERTIES FOLDER "Engine")
+
+target_include_directories(indirect_draw_test PUBLIC ${ENGINE_ROOT_DIR}/source)
+target_compile_options(indirect_draw_test PUBLIC "$<$<COMPILE_LANG_AND_ID:CXX,MSVC>:/WX->")
+target_link_libraries(indirect_draw_test PUBLIC EngineRuntime)
+# target_compile_definitions(indirect_draw_test PUBLIC UNIT_TEST)
+
+set(POST_INDIRECT_DRAW_TEST_COMMANDS
+    COMMAND ${CMAKE_COMMAND} -E make_directory "${BINARY_ROOT_DIR}/unit_test"
+    COMMAND ${CMAKE_COMMAND} -E copy "$<TARGET_FILE:indirect_draw_test>" "${BINARY_ROOT_DIR}/unit_test/"
+)
+
+add_custom_command(TARGET indirect_draw_test ${POST_INDIRECT_DRAW_TEST_COMMANDS})
\ No newline at end of file
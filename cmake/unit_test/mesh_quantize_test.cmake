@@ -0,0 +1,16 @@
+add_executable(mesh_quantize_test mesh_quantize_test.cpp)
+
+set_target_properties(mesh_quantize_test PROPERTIES CXX_STANDARD 17 OUTPUT_NAME "mesh_quantize_test")
+# set_target_properties(mesh_quantize_test PROPERTIES FOLDER "Engine")
+
+target_include_directories(mesh_quantize_test PUBLIC ${ENGINE_ROOT_DIR}/source)
+target_compile_options(mesh_quantize_test PUBLIC "$<$<COMPILE_LANG_AND_ID:CXX,MSVC>:/WX->")
+target_link_libraries(mesh_quantize_test PUBLIC EngineRuntime)
+# target_compile_definitions(mesh_quantize_test PUBLIC UNIT_TEST)
+
+set(POST_MESH_QUANTIZE_TEST_COMMANDS
+    COMMAND ${CMAKE_COMMAND} -E make_directory "${BINARY_ROOT_DIR}/unit_test"
+    COMMAND ${CMAKE_COMMAND} -E copy "$<TARGET_FILE:mesh_quantize_test>" "${BINARY_ROOT_DIR}/unit_test/"
+)
+
+add_custom_command(TARGET mesh_quantize_test ${POST_MESH_QUANTIZE_TEST_COMMANDS})
@@ -0,0 +1,16 @@
+add_executable(parallel_command_recorder_test parallel_command_recorder_test.cpp)
+
+set_target_properties(parallel_command_recorder_test PROPERTIES CXX_STANDARD 17 OUTPUT_NAME "parallel_command_recorder_test")
+# set_target_properties(parallel_command_recorder_test PROPERTIES FOLDER "Engine")
+
+target_include_directories(parallel_command_recorder_test PUBLIC ${ENGINE_ROOT_DIR}/source)
+target_compile_options(parallel_command_recorder_test PUBLIC "$<$<COMPILE_LANG_AND_ID:CXX,MSVC>:/WX->")
+target_link_libraries(parallel_command_recorder_test PUBLIC EngineRuntime)
+# target_compile_definitions(parallel_command_recorder_test PUBLIC UNIT_TEST)
+
+set(POST_PARALLEL_COMMAND_RECORDER_TEST_COMMANDS
+    COMMAND ${CMAKE_COMMAND} -E make_directory "${BINARY_ROOT_DIR}/unit_test"
+    COMMAND ${CMAKE_COMMAND} -E copy "$<TARGET_FILE:parallel_command_recorder_test>" "${BINARY_ROOT_DIR}/unit_test/"
+)
+
+add_custom_command(TARGET parallel_command_recorder_test ${POST_PARALLEL_COMMAND_RECORDER_TEST_COMMANDS})
\ No newline at end of file
@@ -0,0 +1,16 @@
+add_executable(pipeline_state_cache_test pipeline_state_cache_test.cpp)
+
+set_target_properties(pipeline_state_cache_test PROPERTIES CXX_STANDARD 17 OUTPUT_NAME "pipeline_state_cache_test")
+# set_target_properties(pipeline_state_cache_test PROPERTIES FOLDER "Engine")
+
+target_include_directories(pipeline_state_cache_test PUBLIC ${ENGINE_ROOT_DIR}/source)
+target_compile_options(pipeline_state_cache_test PUBLIC "$<$<COMPILE_LANG_AND_ID:CXX,MSVC>:/WX->")
+target_link_libraries(pipeline_state_cache_test PUBLIC EngineRuntime)
+# target_compile_definitions(pipeline_state_cache_test PUBLIC UNIT_TEST)
+
+set(POST_PIPELINE_STATE_CACHE_TEST_COMMANDS
+    COMMAND ${CMAKE_COMMAND} -E make_directory "${BINARY_ROOT_DIR}/unit_test"
+    COMMAND ${CMAKE_COMMAND} -E copy "$<TARGET_FILE:pipeline_state_cache_test>" "${BINARY_ROOT_DIR}/unit_test/"
+)
+
+add_custom_command(TARGET pipeline_state_cache_test ${POST_PIPELINE_STATE_CACHE_TEST_COMMANDS})
\ No newline at end of file
@@ -0,0 +1,16 @@
+add_executable(render_queue_test render_queue_test.cpp)
+
+set_target_properties(render_queue_test PROPERTIES CXX_STANDARD 17 OUTPUT_NAME "render_queue_test")
+# set_target_properties(render_queue_test PROPERTIES FOLDER "Engine")
+
+target_include_directories(render_queue_test PUBLIC ${ENGINE_ROOT_DIR}/source)
+target_compile_options(render_queue_test PUBLIC "$<$<COMPILE_LANG_AND_ID:CXX,MSVC>:/WX->")
+target_link_libraries(render_queue_test PUBLIC EngineRuntime)
+# target_compile_definitions(render_queue_test PUBLIC UNIT_TEST)
+
+set(POST_RENDER_QUEUE_TEST_COMMANDS
+    COMMAND ${CMAKE_COMMAND} -E make_directory "${BINARY_ROOT_DIR}/unit_test"
+    COMMAND ${CMAKE_COMMAND} -E copy "$<TARGET_FILE:render_queue_test>" "${BINARY_ROOT_DIR}/unit_test/"
+)
+
+add_custom_command(TARGET render_queue_test ${POST_RENDER_QUEUE_TEST_COMMANDS})
\ No newline at end of file
@@ -0,0 +1,16 @@
+add_executable(shader_permutation_test shader_permutation_test.cpp)
+
+set_target_properties(shader_permutation_test PROPERTIES CXX_STANDARD 17 OUTPUT_NAME "shader_permutation_test")
+# set_target_properties(shader_permutation_test PROPERTIES FOLDER "Engine")
+
+target_include_directories(shader_permutation_test PUBLIC ${ENGINE_ROOT_DIR}/source)
+target_compile_options(shader_permutation_test PUBLIC "$<$<COMPILE_LANG_AND_ID:CXX,MSVC>:/WX->")
+target_link_libraries(shader_permutation_test PUBLIC EngineRuntime)
+# target_compile_definitions(shader_permutation_test PUBLIC UNIT_TEST)
+
+set(POST_SHADER_PERMUTATION_TEST_COMMANDS
+    COMMAND ${CMAKE_COMMAND} -E make_directory "${BINARY_ROOT_DIR}/unit_test"
+    COMMAND ${CMAKE_COMMAND} -E copy "$<TARGET_FILE:shader_permutation_test>" "${BINARY_ROOT_DIR}/unit_test/"
+)
+
+add_custom_command(TARGET shader_permutation_test ${POST_SHADER_PERMUTATION_TEST_COMMANDS})
\ No newline at end of file
@@ -0,0 +1,16 @@
+add_executable(staging_ring_test staging_ring_test.cpp)
+
+set_target_properties(staging_ring_test PROPERTIES CXX_STANDARD 17 OUTPUT_NAME "staging_ring_test")
+# set_target_properties(staging_ring_test PROPERTIES FOLDER "Engine")
+
+target_include_directories(staging_ring_test PUBLIC ${ENGINE_ROOT_DIR}/source)
+target_compile_options(staging_ring_test PUBLIC "$<$<COMPILE_LANG_AND_ID:CXX,MSVC>:/WX->")
+target_link_libraries(staging_ring_test PUBLIC EngineRuntime)
+# target_compile_definitions(staging_ring_test PUBLIC UNIT_TEST)
+
+set(POST_STAGING_RING_TEST_COMMANDS
+    COMMAND ${CMAKE_COMMAND} -E make_directory "${BINARY_ROOT_DIR}/unit_test"
+    COMMAND ${CMAKE_COMMAND} -E copy "$<TARGET_FILE:staging_ring_test>" "${BINARY_ROOT_DIR}/unit_test/"
+)
+
+add_custom_command(TARGET staging_ring_test ${POST_STAGING_RING_TEST_COMMANDS})
\ No newline at end of file
@@ -0,0 +1,16 @@
+add_executable(texture_atlas_test texture_atlas_test.cpp)
+
+set_target_properties(texture_atlas_test PROPERTIES CXX_STANDARD 17 OUTPUT_NAME "texture_atlas_test")
+# set_target_properties(texture_atlas_test PROPERTIES FOLDER "Engine")
+
+target_include_directories(texture_atlas_test PUBLIC ${ENGINE_ROOT_DIR}/source)
+target_compile_options(texture_atlas_test PUBLIC "$<$<COMPILE_LANG_AND_ID:CXX,MSVC>:/WX->")
+target_link_libraries(texture_atlas_test PUBLIC EngineRuntime)
+# target_compile_definitions(texture_atlas_test PUBLIC UNIT_TEST)
+
+set(POST_TEXTURE_ATLAS_TEST_COMMANDS
+    COMMAND ${CMAKE_COMMAND} -E make_directory "${BINARY_ROOT_DIR}/unit_test"
+    COMMAND ${CMAKE_COMMAND} -E copy "$<TARGET_FILE:texture_atlas_test>" "${BINARY_ROOT_DIR}/unit_test/"
+)
+
+add_custom_command(TARGET texture_atlas_test ${POST_TEXTURE_ATLAS_TEST_COMMANDS})
\ No newline at end of file
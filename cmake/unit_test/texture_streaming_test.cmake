@@ -0,0 +1,16 @@
+add_executable(texture_streaming_test texture_streaming_test.cpp)
+
+set_target_properties(texture_streaming_test PROPERTIES CXX_STANDARD 17 OUTPUT_NAME "texture_streaming_test")
+# set_target_properties(texture_streaming_test PROPERTIES FOLDER "Engine")
+
+target_include_directories(texture_streaming_test PUBLIC ${ENGINE_ROOT_DIR}/source)
+target_compile_options(texture_streaming_test PUBLIC "$<$<COMPILE_LANG_AND_ID:CXX,MSVC>:/WX->")
+target_link_libraries(texture_streaming_test PUBLIC EngineRuntime)
+# target_compile_definitions(texture_streaming_test PUBLIC UNIT_TEST)
+
+set(POST_TEXTURE_STREAMING_TEST_COMMANDS
+    COMMAND ${CMAKE_COMMAND} -E make_directory "${BINARY_ROOT_DIR}/unit_test"
+    COMMAND ${CMAKE_COMMAND} -E copy "$<TARGET_FILE:texture_streaming_test>" "${BINARY_ROOT_DIR}/unit_test/"
+)
+
+add_custom_command(TARGET texture_streaming_test ${POST_TEXTURE_STREAMING_TEST_COMMANDS})
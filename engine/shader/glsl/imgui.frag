@@ -1,12 +1,18 @@
 #version 450 core
+#extension GL_EXT_nonuniform_qualifier : require
 
 layout(location = 0) out vec4 outColor;
 
-layout(set=0, binding=0) uniform sampler2D fontSampler;
+// the bindless table, the vertex stage owns the first 16 bytes of the push constants
+layout(set = 0, binding = 10) uniform sampler2D textures[];
+
+layout(push_constant) uniform uPushConstant {
+    layout(offset = 16) uint textureIndex;
+} pc;
 
 layout (location = 0) in vec2 inUV;
 layout (location = 1) in vec4 inColor;
 
 void main() {
-    outColor = inColor * texture(fontSampler, inUV);
+    outColor = inColor * texture(textures[pc.textureIndex], inUV);
 }
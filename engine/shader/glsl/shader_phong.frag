@@ -1,6 +1,23 @@
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
 
-layout(binding = 1) uniform sampler2D texSampler;
+// permutations (shader/permutations.json):
+// LIGHTING_BLINN - blinn-phong specular instead of phong
+// ALPHA_TEST     - discard texels with alpha below ALPHA_CUTOFF
+#ifndef ALPHA_CUTOFF
+#define ALPHA_CUTOFF 0.5
+#endif
+
+// the bindless table, materials push the indices of their textures
+layout(set = 1, binding = 10) uniform sampler2D textures[];
+
+layout(push_constant) uniform Material {
+    uint baseColour;
+    uint metallicRoughness;
+    uint normal;
+    uint occlusion;
+    uint emissive;
+} material;
 
 layout(binding = 2) uniform LightObject {
     vec3 position;
@@ -16,6 +33,12 @@ layout(location = 4) in vec3 viewPos;
 layout(location = 0) out vec4 outColor;
 
 void main() {
+    vec4 albedo = texture(textures[material.baseColour], fragTexCoord);
+#ifdef ALPHA_TEST
+    if (albedo.a < ALPHA_CUTOFF)
+        discard;
+#endif
+
     // ambient
     float ambientStrength = 0.1;
     vec3 ambient = ambientStrength * light.color;
@@ -29,11 +52,17 @@ void main() {
     // specular
     float specularStrength = 0.5;
     vec3 viewDir = normalize(viewPos - fragPos);
+#ifdef LIGHTING_BLINN
+    // the angle to the half vector is about half the reflection angle, four times the exponent gives a similar highlight
+    vec3 halfDir = normalize(lightDir + viewDir);
+    float spec = pow(max(dot(norm, halfDir), 0.0), 128);
+#else
     vec3 reflectDir = reflect(-lightDir, norm);
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
+#endif
     vec3 specular = specularStrength * spec * light.color;
 
     vec3 result = (ambient + diffuse + specular) * fragColor;
 
-    outColor = vec4(result, 1.0) * texture(texSampler, fragTexCoord);
+    outColor = vec4(result, 1.0) * albedo;
 }
@@ -1,9 +1,66 @@
 #include "runtime/core/base/hash.h"
 
+#include <cstring>
+
 namespace ArchViz
 {
     namespace Hash
     {
+        uint64_t hash_bytes(const void* data, size_t size, uint64_t seed)
+        {
+            constexpr uint64_t k_mul   = 0xc6a4a7935bd1e995ull;
+            constexpr int      k_shift = 47;
+
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            uint64_t       hash_ = seed ^ (size * k_mul);
+
+            const size_t blocks = size / 8;
+            for (size_t i = 0; i < blocks; ++i)
+            {
+                uint64_t k;
+                std::memcpy(&k, bytes + i * 8, 8);
+                k *= k_mul;
+                k ^= k >> k_shift;
+                k *= k_mul;
+                hash_ ^= k;
+                hash_ *= k_mul;
+            }
+
+            const uint8_t* tail = bytes + blocks * 8;
+            switch (size & 7)
+            {
+                case 7:
+                    hash_ ^= static_cast<uint64_t>(tail[6]) << 48;
+                    [[fallthrough]];
+                case 6:
+                    hash_ ^= static_cast<uint64_t>(tail[5]) << 40;
+                    [[fallthrough]];
+                case 5:
+                    hash_ ^= static_cast<uint64_t>(tail[4]) << 32;
+                    [[fallthrough]];
+                case 4:
+                    hash_ ^= static_cast<uint64_t>(tail[3]) << 24;
+                    [[fallthrough]];
+                case 3:
+                    hash_ ^= static_cast<uint64_t>(tail[2]) << 16;
+                    [[fallthrough]];
+                case 2:
+                    hash_ ^= static_cast<uint64_t>(tail[1]) << 8;
+                    [[fallthrough]];
+                case 1:
+                    hash_ ^= static_cast<uint64_t>(tail[0]);
+                    hash_ *= k_mul;
+                    break;
+                default:
+                    break;
+            }
+
+            hash_ ^= hash_ >> k_shift;
+            hash_ *= k_mul;
+            hash_ ^= hash_ >> k_shift;
+            return hash_;
+        }
+
         int32_t hash_1(const std::string& key)
         {
             int32_t hash_ = 5381;
@@ -17,7 +17,7 @@ namespace ArchViz
     inline void hash_combine(std::size_t& seed, const T& v, Ts... rest)
     {
         hash_combine(seed, v);
-        if constexpr (sizeof...(Ts) > 1)
+        if constexpr (sizeof...(Ts) > 0)
         {
             hash_combine(seed, rest...);
         }
@@ -81,6 +81,9 @@ namespace ArchViz
         constexpr uint64_t operator"" _hash(const char* s, size_t) { return details::hasher<std::string>()(s); }
         // constexpr std::uint32_t operator"" _hash(char const* s, size_t count) { return fnv1a_32(s, count); }
 
+        // MurmurHash64A, for content keys (caches, pipeline keys), not stable across endianness
+        uint64_t hash_bytes(const void* data, size_t size, uint64_t seed = 0);
+
         int32_t hash_1(const std::string& key);
         int32_t hash_2(const std::string& key);
         int32_t hash_3(const std::string& key);
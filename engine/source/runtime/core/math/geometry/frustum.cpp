@@ -21,35 +21,35 @@ namespace ArchViz
 {
     void Frustum::update(const FMatrix4& matrix)
     {
-        planes[LEFT][0] = matrix(0, 3) + matrix(0, 0);
-        planes[LEFT][1] = matrix(1, 3) + matrix(1, 0);
-        planes[LEFT][2] = matrix(2, 3) + matrix(2, 0);
-        planes[LEFT][3] = matrix(3, 3) + matrix(3, 0);
+        planes[LEFT][0] = matrix(3, 0) + matrix(0, 0);
+        planes[LEFT][1] = matrix(3, 1) + matrix(0, 1);
+        planes[LEFT][2] = matrix(3, 2) + matrix(0, 2);
+        planes[LEFT][3] = matrix(3, 3) + matrix(0, 3);
 
-        planes[RIGHT][0] = matrix(0, 3) - matrix(0, 0);
-        planes[RIGHT][1] = matrix(1, 3) - matrix(1, 0);
-        planes[RIGHT][2] = matrix(2, 3) - matrix(2, 0);
-        planes[RIGHT][3] = matrix(3, 3) - matrix(3, 0);
+        planes[RIGHT][0] = matrix(3, 0) - matrix(0, 0);
+        planes[RIGHT][1] = matrix(3, 1) - matrix(0, 1);
+        planes[RIGHT][2] = matrix(3, 2) - matrix(0, 2);
+        planes[RIGHT][3] = matrix(3, 3) - matrix(0, 3);
 
-        planes[TOP][0] = matrix(0, 3) - matrix(0, 1);
-        planes[TOP][1] = matrix(1, 3) - matrix(1, 1);
-        planes[TOP][2] = matrix(2, 3) - matrix(2, 1);
-        planes[TOP][3] = matrix(3, 3) - matrix(3, 1);
+        planes[TOP][0] = matrix(3, 0) - matrix(1, 0);
+        planes[TOP][1] = matrix(3, 1) - matrix(1, 1);
+        planes[TOP][2] = matrix(3, 2) - matrix(1, 2);
+        planes[TOP][3] = matrix(3, 3) - matrix(1, 3);
 
-        planes[BOTTOM][0] = matrix(0, 3) + matrix(0, 1);
-        planes[BOTTOM][1] = matrix(1, 3) + matrix(1, 1);
-        planes[BOTTOM][2] = matrix(2, 3) + matrix(2, 1);
-        planes[BOTTOM][3] = matrix(3, 3) + matrix(3, 1);
+        planes[BOTTOM][0] = matrix(3, 0) + matrix(1, 0);
+        planes[BOTTOM][1] = matrix(3, 1) + matrix(1, 1);
+        planes[BOTTOM][2] = matrix(3, 2) + matrix(1, 2);
+        planes[BOTTOM][3] = matrix(3, 3) + matrix(1, 3);
 
-        planes[BACK][0] = matrix(0, 3) + matrix(0, 2);
-        planes[BACK][1] = matrix(1, 3) + matrix(1, 2);
-        planes[BACK][2] = matrix(2, 3) + matrix(2, 2);
-        planes[BACK][3] = matrix(3, 3) + matrix(3, 2);
+        planes[BACK][0] = matrix(3, 0) + matrix(2, 0);
+        planes[BACK][1] = matrix(3, 1) + matrix(2, 1);
+        planes[BACK][2] = matrix(3, 2) + matrix(2, 2);
+        planes[BACK][3] = matrix(3, 3) + matrix(2, 3);
 
-        planes[FRONT][0] = matrix(0, 3) - matrix(0, 2);
-        planes[FRONT][1] = matrix(1, 3) - matrix(1, 2);
-        planes[FRONT][2] = matrix(2, 3) - matrix(2, 2);
-        planes[FRONT][3] = matrix(3, 3) - matrix(3, 2);
+        planes[FRONT][0] = matrix(3, 0) - matrix(2, 0);
+        planes[FRONT][1] = matrix(3, 1) - matrix(2, 1);
+        planes[FRONT][2] = matrix(3, 2) - matrix(2, 2);
+        planes[FRONT][3] = matrix(3, 3) - matrix(2, 3);
 
         for (auto i = 0; i < planes.size(); i++)
         {
@@ -58,7 +58,7 @@ namespace ArchViz
         }
     }
 
-    bool Frustum::checkSphere(const FVector3& pos, float radius)
+    bool Frustum::checkSphere(const FVector3& pos, float radius) const
     {
         for (auto i = 0; i < planes.size(); i++)
         {
@@ -41,7 +41,7 @@ namespace ArchViz
 
         /**
          * @brief Updates the frustums planes based on a matrix
-         * @param matrix The matrix to update the frustum on
+         * @param matrix The view projection matrix (column vectors, clip = matrix * pos) to update the frustum on
          */
         void update(const FMatrix4& matrix);
 
@@ -50,6 +50,6 @@ namespace ArchViz
          * @param pos The center of the sphere
          * @param radius The radius of the sphere
          */
-        bool checkSphere(const FVector3& pos, float radius);
+        bool checkSphere(const FVector3& pos, float radius) const;
     };
 } // namespace ArchViz
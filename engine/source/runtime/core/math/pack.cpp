@@ -0,0 +1,199 @@
+#include "runtime/core/math/pack.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace ArchViz
+{
+    uint16_t float_to_half(float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+
+        uint32_t sign     = (bits >> 16) & 0x8000u;
+        uint32_t exponent = (bits >> 23) & 0xFFu;
+        uint32_t mantissa = bits & 0x7FFFFFu;
+
+        // nan / inf
+        if (exponent == 0xFFu)
+        {
+            return static_cast<uint16_t>(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+        }
+
+        int32_t half_exponent = static_cast<int32_t>(exponent) - 127 + 15;
+
+        // overflow to inf
+        if (half_exponent >= 0x1F)
+        {
+            return static_cast<uint16_t>(sign | 0x7C00u);
+        }
+
+        // subnormal or zero
+        if (half_exponent <= 0)
+        {
+            if (half_exponent < -10)
+            {
+                return static_cast<uint16_t>(sign);
+            }
+
+            mantissa |= 0x800000u;
+
+            uint32_t shift     = static_cast<uint32_t>(14 - half_exponent);
+            uint32_t result    = mantissa >> shift;
+            uint32_t remainder = mantissa & ((1u << shift) - 1u);
+            uint32_t halfway   = 1u << (shift - 1u);
+            if (remainder > halfway || (remainder == halfway && (result & 1u)))
+            {
+                ++result;
+            }
+            return static_cast<uint16_t>(sign | result);
+        }
+
+        uint32_t result    = (static_cast<uint32_t>(half_exponent) << 10) | (mantissa >> 13);
+        uint32_t remainder = mantissa & 0x1FFFu;
+        if (remainder > 0x1000u || (remainder == 0x1000u && (result & 1u)))
+        {
+            // may carry into the exponent, which is still correct
+            ++result;
+        }
+        return static_cast<uint16_t>(sign | result);
+    }
+
+    float half_to_float(uint16_t value)
+    {
+        uint32_t sign     = static_cast<uint32_t>(value & 0x8000u) << 16;
+        uint32_t exponent = (value >> 10) & 0x1Fu;
+        uint32_t mantissa = value & 0x3FFu;
+
+        uint32_t bits;
+        if (exponent == 0)
+        {
+            if (mantissa == 0)
+            {
+                bits = sign;
+            }
+            else
+            {
+                // normalize the subnormal
+                int32_t e = -1;
+                do
+                {
+                    ++e;
+                    mantissa <<= 1;
+                } while ((mantissa & 0x400u) == 0);
+
+                bits = sign | (static_cast<uint32_t>(127 - 15 - e) << 23) | ((mantissa & 0x3FFu) << 13);
+            }
+        }
+        else if (exponent == 0x1Fu)
+        {
+            bits = sign | 0x7F800000u | (mantissa << 13);
+        }
+        else
+        {
+            bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+        }
+
+        float result;
+        std::memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+
+    uint32_t quantize_unorm(float value, int bits)
+    {
+        const float scale = static_cast<float>((1u << bits) - 1u);
+
+        value = std::clamp(value, 0.0f, 1.0f);
+        return static_cast<uint32_t>(value * scale + 0.5f);
+    }
+
+    int32_t quantize_snorm(float value, int bits)
+    {
+        const float scale = static_cast<float>((1 << (bits - 1)) - 1);
+
+        value = std::clamp(value, -1.0f, 1.0f);
+        return static_cast<int32_t>(std::lround(value * scale));
+    }
+
+    float dequantize_unorm(uint32_t value, int bits) { return static_cast<float>(value) / static_cast<float>((1u << bits) - 1u); }
+
+    float dequantize_snorm(int32_t value, int bits) { return std::max(static_cast<float>(value) / static_cast<float>((1 << (bits - 1)) - 1), -1.0f); }
+
+    void octahedral_encode(const float normal[3], float& u, float& v)
+    {
+        float length = std::fabs(normal[0]) + std::fabs(normal[1]) + std::fabs(normal[2]);
+        if (length <= 0.0f)
+        {
+            u = 0.0f;
+            v = 0.0f;
+            return;
+        }
+
+        float x = normal[0] / length;
+        float y = normal[1] / length;
+
+        // fold the lower hemisphere
+        if (normal[2] < 0.0f)
+        {
+            float fx = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+            float fy = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+            x        = fx;
+            y        = fy;
+        }
+
+        u = x;
+        v = y;
+    }
+
+    void octahedral_decode(float u, float v, float normal[3])
+    {
+        float x = u;
+        float y = v;
+        float z = 1.0f - std::fabs(x) - std::fabs(y);
+
+        // unfold the lower hemisphere
+        float t = std::max(-z, 0.0f);
+        x += x >= 0.0f ? -t : t;
+        y += y >= 0.0f ? -t : t;
+
+        float length = std::sqrt(x * x + y * y + z * z);
+        normal[0]    = x / length;
+        normal[1]    = y / length;
+        normal[2]    = z / length;
+    }
+
+    void octahedral_encode_snorm8(const float normal[3], int8_t& u, int8_t& v)
+    {
+        float fu, fv;
+        octahedral_encode(normal, fu, fv);
+
+        const float scale = 127.0f;
+
+        int32_t base_u = static_cast<int32_t>(std::floor(fu * scale));
+        int32_t base_v = static_cast<int32_t>(std::floor(fv * scale));
+
+        float best_dot = -2.0f;
+        for (int32_t du = 0; du <= 1; ++du)
+        {
+            for (int32_t dv = 0; dv <= 1; ++dv)
+            {
+                int32_t cu = std::clamp(base_u + du, -127, 127);
+                int32_t cv = std::clamp(base_v + dv, -127, 127);
+
+                float decoded[3];
+                octahedral_decode_snorm8(static_cast<int8_t>(cu), static_cast<int8_t>(cv), decoded);
+
+                float dot = decoded[0] * normal[0] + decoded[1] * normal[1] + decoded[2] * normal[2];
+                if (dot > best_dot)
+                {
+                    best_dot = dot;
+                    u        = static_cast<int8_t>(cu);
+                    v        = static_cast<int8_t>(cv);
+                }
+            }
+        }
+    }
+
+    void octahedral_decode_snorm8(int8_t u, int8_t v, float normal[3]) { octahedral_decode(dequantize_snorm(u, 8), dequantize_snorm(v, 8), normal); }
+} // namespace ArchViz
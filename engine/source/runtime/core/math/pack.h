@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+
+namespace ArchViz
+{
+    // ieee 754 binary16, round to nearest even, no F16C required
+    uint16_t float_to_half(float value);
+    float    half_to_float(uint16_t value);
+
+    // value in [0, 1] / [-1, 1] to n bit normalized integer, round to nearest
+    uint32_t quantize_unorm(float value, int bits);
+    int32_t  quantize_snorm(float value, int bits);
+
+    float dequantize_unorm(uint32_t value, int bits);
+    float dequantize_snorm(int32_t value, int bits);
+
+    // unit vector <-> octahedral map in [-1, 1]^2
+    void octahedral_encode(const float normal[3], float& u, float& v);
+    void octahedral_decode(float u, float v, float normal[3]);
+
+    // octahedral snorm8 encoding that tests the neighbouring quantized points and keeps the closest one
+    void octahedral_encode_snorm8(const float normal[3], int8_t& u, int8_t& v);
+    void octahedral_decode_snorm8(int8_t u, int8_t v, float normal[3]);
+} // namespace ArchViz
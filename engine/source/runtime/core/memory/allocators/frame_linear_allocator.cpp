@@ -0,0 +1,83 @@
+#include "runtime/core/memory/allocators/frame_linear_allocator.h"
+#include "runtime/core/memory/memory_utils.h"
+
+#include "runtime/core/base/macro.h"
+
+#include <algorithm>
+
+namespace ArchViz
+{
+    void FrameLinearAllocator::initialize(void* memory, size_t frame_size, uint32_t frame_count, size_t alignment)
+    {
+        ASSERT(frame_count > 0);
+        ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+        clear();
+
+        // every frame starts aligned, so does everything allocated in it
+        m_frame_size  = frame_size / alignment * alignment;
+        m_frame_count = frame_count;
+        m_alignment   = alignment;
+
+        if (memory == nullptr)
+        {
+            m_owned.resize(m_frame_size * frame_count);
+            memory = m_owned.data();
+        }
+        m_memory = static_cast<uint8_t*>(memory);
+    }
+
+    void FrameLinearAllocator::clear()
+    {
+        m_memory = nullptr;
+        m_owned.clear();
+        m_owned.shrink_to_fit();
+
+        m_frame_size  = 0;
+        m_frame_count = 0;
+        m_frame       = 0;
+        m_alignment   = 1;
+        m_offset      = 0;
+
+        m_allocations = 0;
+        m_bytes       = 0;
+        m_refused     = 0;
+        m_peak        = 0;
+    }
+
+    void FrameLinearAllocator::beginFrame(uint32_t frame)
+    {
+        ASSERT(frame < m_frame_count);
+
+        m_peak   = std::max(m_peak, used());
+        m_frame  = frame;
+        m_offset = 0;
+    }
+
+    size_t FrameLinearAllocator::allocate(size_t size)
+    {
+        const size_t aligned = memory_align(std::max<size_t>(size, 1), m_alignment);
+        const size_t offset  = m_offset.fetch_add(aligned, std::memory_order_relaxed);
+        if (offset + aligned > m_frame_size)
+        {
+            m_refused.fetch_add(1, std::memory_order_relaxed);
+            return k_invalid_offset;
+        }
+
+        m_allocations.fetch_add(1, std::memory_order_relaxed);
+        m_bytes.fetch_add(size, std::memory_order_relaxed);
+        return static_cast<size_t>(m_frame) * m_frame_size + offset;
+    }
+
+    size_t FrameLinearAllocator::used() const { return std::min(m_offset.load(std::memory_order_relaxed), m_frame_size); }
+
+    FrameLinearStatistics FrameLinearAllocator::getStatistics() const
+    {
+        FrameLinearStatistics statistics;
+        statistics.allocations = m_allocations.load(std::memory_order_relaxed);
+        statistics.bytes       = m_bytes.load(std::memory_order_relaxed);
+        statistics.refused     = m_refused.load(std::memory_order_relaxed);
+        statistics.peak        = std::max(m_peak, used());
+        return statistics;
+    }
+} // namespace ArchViz
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace ArchViz
+{
+    struct FrameLinearStatistics
+    {
+        uint64_t allocations {0};
+        uint64_t bytes {0};   // requested, without the padding up to the alignment
+        uint64_t refused {0}; // allocations that did not fit in what was left of their frame
+        size_t   peak {0};    // most bytes used by one frame
+    };
+
+    // a block split into one range per frame in flight, each used as a linear allocator. Allocations bump the offset of the
+    // current frame and are never freed one by one, beginFrame resets the whole range of a frame once its fence signaled.
+    // The block may be memory of its own or a persistently mapped buffer, offsets are from its start so they can be used as
+    // dynamic offsets. Every allocation is a multiple of the alignment, so allocate is a single atomic add and thread safe.
+    class FrameLinearAllocator
+    {
+    public:
+        static constexpr size_t k_invalid_offset = ~size_t(0);
+
+        // memory of frame_size * frame_count bytes, or nullptr for one of its own. alignment is a power of two
+        void initialize(void* memory, size_t frame_size, uint32_t frame_count, size_t alignment);
+        void clear();
+
+        // the frames that used this range before completed, it is handed out again from its start
+        void beginFrame(uint32_t frame);
+
+        // the offset from the start of the block, k_invalid_offset when the frame is full
+        size_t allocate(size_t size);
+
+        // copies value into a new allocation
+        template<typename T>
+        size_t push(const T& value)
+        {
+            const size_t offset = allocate(sizeof(T));
+            if (offset != k_invalid_offset)
+            {
+                std::memcpy(data(offset), &value, sizeof(T));
+            }
+            return offset;
+        }
+
+        void* data(size_t offset) const { return m_memory + offset; }
+
+        size_t   frameSize() const { return m_frame_size; }
+        uint32_t frameCount() const { return m_frame_count; }
+        uint32_t frame() const { return m_frame; }
+        size_t   alignment() const { return m_alignment; }
+        // bytes used by the current frame, padding included
+        size_t used() const;
+
+        FrameLinearStatistics getStatistics() const;
+
+    private:
+        uint8_t*             m_memory {nullptr};
+        std::vector<uint8_t> m_owned;
+
+        size_t   m_frame_size {0};
+        uint32_t m_frame_count {0};
+        uint32_t m_frame {0};
+        size_t   m_alignment {1};
+
+        std::atomic<size_t> m_offset {0}; // in the current frame, may run past m_frame_size once an allocation was refused
+
+        std::atomic<uint64_t> m_allocations {0};
+        std::atomic<uint64_t> m_bytes {0};
+        std::atomic<uint64_t> m_refused {0};
+        size_t                m_peak {0};
+    };
+} // namespace ArchViz
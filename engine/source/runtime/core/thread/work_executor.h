@@ -5,6 +5,7 @@
 #include "runtime/core/container/queue.h"
 
 #include <atomic>
+#include <cstdint>
 #include <functional>
 #include <future>
 #include <memory>
@@ -56,6 +57,8 @@ namespace ArchViz
                 thread.join();
         }
 
+        std::size_t size() const { return m_count; }
+
         template<typename F, typename... Args>
         void enqueue_work(F&& f, Args&&... args)
         {
@@ -102,4 +105,28 @@ namespace ArchViz
 
         inline static const unsigned int K = 2;
     };
+
+    // run job(begin, end) over [0, count) in chunks of grain, inline when there is no executor
+    template<typename F>
+    void parallel_for(const std::shared_ptr<WorkExecutor>& executor, uint32_t count, uint32_t grain, F&& job)
+    {
+        grain = grain == 0 ? 1 : grain;
+        if (executor == nullptr || count <= grain)
+        {
+            job(0u, count);
+            return;
+        }
+
+        std::vector<std::future<void>> futures;
+        futures.reserve((count + grain - 1) / grain);
+        for (uint32_t begin = 0; begin < count; begin += grain)
+        {
+            uint32_t end = count - begin < grain ? count : begin + grain;
+            futures.push_back(executor->enqueue_task([&job, begin, end]() { job(begin, end); }));
+        }
+        for (auto& future : futures)
+        {
+            future.wait();
+        }
+    }
 } // namespace ArchViz
@@ -1,20 +1,60 @@
 #include "runtime/function/framework/component/mesh/mesh_component.h"
+#include "runtime/function/framework/component/transform/transform_component.h"
 
 #include "runtime/resource/asset_manager/asset_manager.h"
 #include "runtime/resource/res_type/components/material_res.h"
 #include "runtime/resource/resource_manager/resource_manager.h"
 
 #include "runtime/function/framework/object/object.h"
+#include "runtime/function/global/global_context.h"
+#include "runtime/function/render/queue/render_queue.h"
+#include "runtime/function/render/render_system.h"
 
 namespace ArchViz
 {
     void MeshComponent::postLoadResource(std::weak_ptr<GObject> parent_object)
     {
-        // TODO
+        m_parent_object = parent_object;
     }
 
     void MeshComponent::tick(float delta_time)
     {
-        // TODO
+        std::shared_ptr<GObject> parent = m_parent_object.lock();
+        if (!parent || !g_runtime_global_context.m_render_system)
+        {
+            return;
+        }
+
+        std::shared_ptr<RenderQueue> queue = g_runtime_global_context.m_render_system->getRenderQueue();
+        if (!queue)
+        {
+            return;
+        }
+
+        const TransformComponent* transform     = parent->tryGetComponentConst(TransformComponent);
+        const Matrix4x4           object_matrix = transform ? transform->getMatrix() : Matrix4x4::IDENTITY;
+
+        // a packet per sub mesh every frame, the queue merges the objects sharing a mesh and material into one draw
+        for (const SubMeshRes& sub_mesh : m_mesh_res.m_sub_meshes)
+        {
+            const Matrix4x4 matrix = object_matrix * sub_mesh.m_transform.getMatrix();
+
+            DrawInstance instance;
+            for (uint32_t row = 0; row < 4; ++row)
+            {
+                for (uint32_t column = 0; column < 4; ++column)
+                {
+                    instance.model(row, column) = matrix[row][column];
+                }
+            }
+            instance.object_id = static_cast<uint32_t>(parent->getID());
+
+            DrawPacket packet;
+            packet.mesh     = queue->getMeshId(sub_mesh.m_obj_file_ref);
+            packet.material = queue->getMaterialId(sub_mesh.m_material);
+            packet.key      = SortKey::make(static_cast<uint32_t>(DrawPass::Opaque), 0, packet.material, queue->viewDepth(instance.model.block<3, 1>(0, 3)));
+
+            queue->submit(packet, instance);
+        }
     }
 } // namespace ArchViz
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "runtime/function/global/global_context.h"
 
 #include "runtime/core/meta/reflection/reflection_register.h"
+#include "runtime/core/thread/work_executor.h"
 
 #include "runtime/function/render/render_system.h"
 #include "runtime/function/window/window_system.h"
@@ -10,6 +11,8 @@
 #include "runtime/resource/config_manager/config_manager.h"
 #include "runtime/resource/resource_manager/resource_manager.h"
 
+#include <algorithm>
+
 namespace ArchViz
 {
     RuntimeGlobalContext g_runtime_global_context;
@@ -20,6 +23,8 @@ namespace ArchViz
 
         Reflection::TypeMetaRegister::metaRegister();
 
+        m_work_executor = std::make_shared<WorkExecutor>(std::max(1u, std::thread::hardware_concurrency()));
+
         m_config_manager = std::make_shared<ConfigManager>();
         m_config_manager->initialize(config_file_path);
 
@@ -35,7 +40,7 @@ namespace ArchViz
 
         m_asset_manager->setVFS(vfs);
 
-        m_resource_manager = std::make_shared<ResourceManager>();
+        m_resource_manager = std::make_shared<ResourceManager>(m_work_executor);
         m_resource_manager->initialize();
     }
 
@@ -47,5 +52,7 @@ namespace ArchViz
         m_asset_manager.reset();
         m_file_service.reset();
         m_config_manager.reset();
+
+        m_work_executor.reset();
     }
 } // namespace ArchViz
\ No newline at end of file
@@ -5,6 +5,7 @@
 namespace ArchViz
 {
     class VFS;
+    class WorkExecutor;
     class FileService;
     class ConfigManager;
     class AssetManager;
@@ -22,6 +23,7 @@ namespace ArchViz
         void shutdownSystems();
 
     public:
+        std::shared_ptr<WorkExecutor>    m_work_executor; // the one thread pool every system shares
         std::shared_ptr<FileService>     m_file_service;
         std::shared_ptr<ConfigManager>   m_config_manager;
         std::shared_ptr<AssetManager>    m_asset_manager;
@@ -0,0 +1,77 @@
+#include "runtime/function/render/geometry/meshlet_culling.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ArchViz
+{
+    MeshletCullStatistics& MeshletCullStatistics::operator+=(const MeshletCullStatistics& rhs)
+    {
+        meshlet_count += rhs.meshlet_count;
+        visible_meshlet_count += rhs.visible_meshlet_count;
+        frustum_culled_count += rhs.frustum_culled_count;
+        cone_culled_count += rhs.cone_culled_count;
+        triangle_count += rhs.triangle_count;
+        visible_triangle_count += rhs.visible_triangle_count;
+        return *this;
+    }
+
+    MeshletCullStatistics cull_meshlets(const CookedMeshData& mesh, const FMatrix4& model, const Frustum& frustum, const FVector3& camera_position, std::vector<uint32_t>* visible)
+    {
+        MeshletCullStatistics stats;
+        stats.meshlet_count = static_cast<uint32_t>(mesh.meshlets.size());
+
+        if (visible)
+        {
+            visible->clear();
+        }
+
+        const FMatrix3 linear = model.topLeftCorner<3, 3>();
+        const FVector3 offset = model.topRightCorner<3, 1>();
+
+        // spheres are scaled by the largest axis scale to stay conservative
+        const float radius_scale = std::sqrt(std::max({linear.col(0).squaredNorm(), linear.col(1).squaredNorm(), linear.col(2).squaredNorm()}));
+
+        // back facing is invariant under affine transforms keeping the winding, so the cone test runs in object space
+        const float    determinant = linear.determinant();
+        const bool     cone_valid  = determinant > 0.0f;
+        const FVector3 camera      = cone_valid ? FVector3(linear.inverse() * (camera_position - offset)) : FVector3::Zero();
+
+        for (uint32_t i = 0; i < stats.meshlet_count; ++i)
+        {
+            const MeshletData& meshlet = mesh.meshlets[i];
+            stats.triangle_count += meshlet.triangle_count;
+
+            const FVector3 center(meshlet.center.x, meshlet.center.y, meshlet.center.z);
+            if (!frustum.checkSphere(linear * center + offset, meshlet.radius * radius_scale))
+            {
+                ++stats.frustum_culled_count;
+                continue;
+            }
+
+            // a cutoff of 1 means the cone spans more than a hemisphere
+            if (cone_valid && meshlet.cone_cutoff < 1.0f)
+            {
+                FVector3 apex(meshlet.cone_apex.x, meshlet.cone_apex.y, meshlet.cone_apex.z);
+                FVector3 axis(meshlet.cone_axis.x, meshlet.cone_axis.y, meshlet.cone_axis.z);
+
+                FVector3 view = apex - camera;
+                float    norm = view.norm();
+                if (norm > 0.0f && view.dot(axis) >= meshlet.cone_cutoff * norm)
+                {
+                    ++stats.cone_culled_count;
+                    continue;
+                }
+            }
+
+            ++stats.visible_meshlet_count;
+            stats.visible_triangle_count += meshlet.triangle_count;
+            if (visible)
+            {
+                visible->push_back(i);
+            }
+        }
+
+        return stats;
+    }
+} // namespace ArchViz
@@ -0,0 +1,35 @@
+#pragma once
+#include "runtime/core/math/geometry/frustum.h"
+#include "runtime/core/math/math_type.h"
+
+#include "runtime/resource/res_type/data/mesh_data.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace ArchViz
+{
+    struct MeshletCullStatistics
+    {
+        uint32_t meshlet_count {0};
+        uint32_t visible_meshlet_count {0};
+        uint32_t frustum_culled_count {0};
+        uint32_t cone_culled_count {0};
+
+        uint64_t triangle_count {0};
+        uint64_t visible_triangle_count {0};
+
+        float culledTriangleRatio() const { return triangle_count == 0 ? 0.0f : 1.0f - static_cast<float>(visible_triangle_count) / static_cast<float>(triangle_count); }
+
+        MeshletCullStatistics& operator+=(const MeshletCullStatistics& rhs);
+    };
+
+    // cpu meshlet culling against the view frustum (world space spheres) and back facing normal cones (object space camera)
+    // model must keep the winding, a negative determinant flips the cones and they are skipped
+    // visible receives the indices of the surviving meshlets when provided
+    MeshletCullStatistics cull_meshlets(const CookedMeshData&  mesh,
+                                        const FMatrix4&        model,
+                                        const Frustum&         frustum,
+                                        const FVector3&        camera_position,
+                                        std::vector<uint32_t>* visible = nullptr);
+} // namespace ArchViz
@@ -52,7 +52,7 @@ namespace ArchViz
             return attributeDescriptions;
         }
 
-        bool operator==(const Vertex& other) const { return pos == other.pos && color == other.color && tex_coord == other.tex_coord; }
+        bool operator==(const Vertex& other) const { return pos == other.pos && color == other.color && normal == other.normal && tex_coord == other.tex_coord; }
     };
 
 } // namespace ArchViz
@@ -68,19 +68,20 @@ namespace std
             ArchViz::hash_combine(pos_hash, vertex.pos[0], vertex.pos[1], vertex.pos[2]);
             size_t color_hash = 0;
             ArchViz::hash_combine(color_hash, vertex.color[0], vertex.color[1], vertex.color[2]);
+            size_t normal_hash = 0;
+            ArchViz::hash_combine(normal_hash, vertex.normal[0], vertex.normal[1], vertex.normal[2]);
             size_t tex_hash = 0;
             ArchViz::hash_combine(tex_hash, vertex.tex_coord[0], vertex.tex_coord[1]);
-            return pos_hash ^ ((color_hash << 1) >> 1) ^ (tex_hash << 1);
+            size_t seed = 0;
+            ArchViz::hash_combine(seed, pos_hash, color_hash, normal_hash, tex_hash);
+            return seed;
         }
     };
 
     template<>
     struct equal_to<ArchViz::Vertex>
     {
-        bool operator()(const ArchViz::Vertex& lhs, const ArchViz::Vertex& rhs) const
-        {
-            const std::hash<ArchViz::Vertex> _hash_;
-            return _hash_(lhs) == _hash_(rhs);
-        }
+        // equal hashes do not mean equal vertices, compare the members
+        bool operator()(const ArchViz::Vertex& lhs, const ArchViz::Vertex& rhs) const { return lhs == rhs; }
     };
 } // namespace std
@@ -0,0 +1,85 @@
+#pragma once
+#include "runtime/core/math/math_type.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace ArchViz
+{
+    // the order draws are submitted in, compared as one integer. From the top bit down: pass, pipeline, material, depth,
+    // so a pass is drawn whole, pipeline and material changes are as rare as they can be and the depth only orders draws
+    // that share all the state above it.
+    struct SortKey
+    {
+        static constexpr uint32_t k_depth_bits    = 24;
+        static constexpr uint32_t k_material_bits = 22;
+        static constexpr uint32_t k_pipeline_bits = 12;
+        static constexpr uint32_t k_pass_bits     = 6;
+
+        static constexpr uint32_t k_material_shift = k_depth_bits;
+        static constexpr uint32_t k_pipeline_shift = k_material_shift + k_material_bits;
+        static constexpr uint32_t k_pass_shift     = k_pipeline_shift + k_pipeline_bits;
+
+        static_assert(k_pass_shift + k_pass_bits == 64, "the sort key fields have to fill 64 bits");
+
+        // depth is the view depth over the far plane, clamped to [0, 1]. Opaque passes draw front to back for early depth
+        // rejection, transparent ones back to front.
+        static uint64_t make(uint32_t pass, uint32_t pipeline, uint32_t material, float depth, bool back_to_front = false)
+        {
+            const uint64_t depth_max = (1ull << k_depth_bits) - 1;
+
+            uint64_t depth_bits = static_cast<uint64_t>(std::clamp(depth, 0.0f, 1.0f) * static_cast<float>(depth_max));
+            depth_bits          = std::min(depth_bits, depth_max);
+            if (back_to_front)
+            {
+                depth_bits = depth_max - depth_bits;
+            }
+
+            return (static_cast<uint64_t>(pass) & mask(k_pass_bits)) << k_pass_shift | (static_cast<uint64_t>(pipeline) & mask(k_pipeline_bits)) << k_pipeline_shift |
+                   (static_cast<uint64_t>(material) & mask(k_material_bits)) << k_material_shift | depth_bits;
+        }
+
+        static uint32_t pass(uint64_t key) { return static_cast<uint32_t>(key >> k_pass_shift & mask(k_pass_bits)); }
+        static uint32_t pipeline(uint64_t key) { return static_cast<uint32_t>(key >> k_pipeline_shift & mask(k_pipeline_bits)); }
+        static uint32_t material(uint64_t key) { return static_cast<uint32_t>(key >> k_material_shift & mask(k_material_bits)); }
+        static uint32_t depth(uint64_t key) { return static_cast<uint32_t>(key & mask(k_depth_bits)); }
+
+        // everything but the depth, draws with the same state may be merged
+        static uint64_t state(uint64_t key) { return key >> k_depth_bits; }
+
+        static constexpr uint64_t mask(uint32_t bits) { return (1ull << bits) - 1; }
+    };
+
+    // the passes packets go to, in the order they are drawn
+    enum class DrawPass : uint32_t
+    {
+        Opaque,
+        Transparent,
+        Count,
+    };
+
+    // one mesh drawn once, what a mesh component hands the render queue every frame
+    struct DrawPacket
+    {
+        uint64_t key {0};
+        uint32_t mesh {0};
+        uint32_t material {0}; // the whole id, the key may only hold its low bits
+    };
+
+    // what the shaders read per instance, one entry for each packet of a batch
+    struct DrawInstance
+    {
+        alignas(16) FMatrix4 model {FMatrix4::Identity()};
+        uint32_t object_id {0};
+    };
+
+    // packets of one mesh and material with the same state, drawn as one instanced draw
+    struct DrawBatch
+    {
+        uint64_t key {0}; // of the nearest packet (the first in draw order)
+        uint32_t mesh {0};
+        uint32_t material {0};
+        uint32_t first_instance {0}; // into the instance stream of the queue
+        uint32_t instance_count {0};
+    };
+} // namespace ArchViz
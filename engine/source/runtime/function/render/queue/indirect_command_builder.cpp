@@ -0,0 +1,95 @@
+#include "runtime/function/render/queue/indirect_command_builder.h"
+#include "runtime/function/render/rhi/mesh_arena.h"
+
+#include "runtime/core/thread/work_executor.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace ArchViz
+{
+    namespace
+    {
+        constexpr uint32_t k_skipped = ~0u;
+
+        // below this many batches a chunk costs more to schedule than to write
+        constexpr uint32_t k_min_chunk = 4 * 1024;
+    } // namespace
+
+    void IndirectCommandBuilder::build(const std::vector<DrawBatch>& batches, const MeshArena& arena)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+
+        const uint32_t count = static_cast<uint32_t>(batches.size());
+
+        m_statistics         = {};
+        m_statistics.batches = count;
+
+        // where each command goes, a cheap pass over the keys so the commands can be written in any order
+        m_buckets.clear();
+        m_slots.resize(count);
+
+        uint32_t commands    = 0;
+        uint64_t last_bucket = ~0ull;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const DrawBatch& batch = batches[i];
+            if (batch.mesh == m_excluded_mesh)
+            {
+                m_slots[i] = k_skipped;
+                m_statistics.excluded += 1;
+                continue;
+            }
+            if (!arena.isResident(batch.mesh))
+            {
+                m_slots[i] = k_skipped;
+                m_statistics.missing += 1;
+                continue;
+            }
+
+            // pass and pipeline are the top bits of the key
+            const uint64_t bucket = batch.key >> SortKey::k_pipeline_shift;
+            if (bucket != last_bucket)
+            {
+                m_buckets.push_back({SortKey::pass(batch.key), SortKey::pipeline(batch.key), commands, 0});
+                last_bucket = bucket;
+            }
+            m_buckets.back().command_count += 1;
+            m_slots[i] = commands++;
+        }
+
+        m_commands.resize(commands);
+        const uint32_t grain = std::max(k_min_chunk, (count + std::max(m_thread_count, 1u) - 1) / std::max(m_thread_count, 1u));
+        parallel_for(m_executor, count, grain, [this, &batches, &arena](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                if (m_slots[i] == k_skipped)
+                {
+                    continue;
+                }
+
+                const DrawBatch& batch = batches[i];
+                const MeshRange& range = arena.getRange(batch.mesh);
+
+                DrawIndexedCommand& command = m_commands[m_slots[i]];
+                command.index_count         = range.index_count;
+                command.instance_count      = batch.instance_count;
+                command.first_index         = range.first_index;
+                command.vertex_offset       = static_cast<int32_t>(range.vertex_offset);
+                command.first_instance      = batch.first_instance;
+            }
+        });
+
+        m_statistics.commands = commands;
+        m_statistics.buckets  = static_cast<uint32_t>(m_buckets.size());
+        m_statistics.build_ms = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    void IndirectCommandBuilder::clear()
+    {
+        m_commands.clear();
+        m_buckets.clear();
+        m_slots.clear();
+        m_statistics = {};
+    }
+} // namespace ArchViz
@@ -0,0 +1,71 @@
+#pragma once
+#include "runtime/function/render/queue/draw_packet.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ArchViz
+{
+    class MeshArena;
+    class WorkExecutor;
+
+    // laid out as VkDrawIndexedIndirectCommand, so the commands are copied into an indirect buffer as they are
+    struct DrawIndexedCommand
+    {
+        uint32_t index_count {0};
+        uint32_t instance_count {0};
+        uint32_t first_index {0};
+        int32_t  vertex_offset {0};
+        uint32_t first_instance {0};
+    };
+
+    // commands of one pass and pipeline next to each other, drawn by one indirect draw
+    struct DrawBucket
+    {
+        uint32_t pass {0};
+        uint32_t pipeline {0};
+        uint32_t first_command {0};
+        uint32_t command_count {0};
+    };
+
+    struct IndirectBuildStatistics
+    {
+        uint32_t batches {0};
+        uint32_t commands {0};
+        uint32_t buckets {0};
+        uint32_t missing {0};  // batches whose mesh was not in the arena, they are left out
+        uint32_t excluded {0}; // batches of m_excluded_mesh
+        float    build_ms {0.0f};
+    };
+
+    // turns the batches of a render queue into indexed indirect commands. The batches are in key order, so a bucket starts
+    // wherever the pass or pipeline changes and every bucket is one contiguous run of commands. The offsets come from the
+    // mesh arena, the first instance from the batch, so the instance stream of the queue can be bound as it is.
+    class IndirectCommandBuilder
+    {
+    public:
+        static constexpr uint32_t k_no_mesh = ~0u;
+
+        void build(const std::vector<DrawBatch>& batches, const MeshArena& arena);
+        void clear();
+
+        const std::vector<DrawIndexedCommand>& getCommands() const { return m_commands; }
+        const std::vector<DrawBucket>&         getBuckets() const { return m_buckets; }
+
+        const IndirectBuildStatistics& getStatistics() const { return m_statistics; }
+
+    public:
+        std::shared_ptr<WorkExecutor> m_executor; // writes the commands inline when null
+
+        uint32_t m_thread_count {1};
+        uint32_t m_excluded_mesh {k_no_mesh}; // drawn elsewhere, its batches are left out
+
+    private:
+        std::vector<DrawIndexedCommand> m_commands;
+        std::vector<DrawBucket>         m_buckets;
+        std::vector<uint32_t>           m_slots; // per batch, its command
+
+        IndirectBuildStatistics m_statistics;
+    };
+} // namespace ArchViz
@@ -0,0 +1,307 @@
+#include "runtime/function/render/queue/render_queue.h"
+
+#include "runtime/core/base/macro.h"
+#include "runtime/core/thread/work_executor.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+
+namespace ArchViz
+{
+    namespace
+    {
+        constexpr uint32_t k_radix_bits    = 8;
+        constexpr uint32_t k_radix_buckets = 1u << k_radix_bits;
+        constexpr uint32_t k_radix_passes  = 64 / k_radix_bits;
+
+        // below this many packets a chunk costs more to schedule than to sort
+        constexpr uint32_t k_min_chunk = 16 * 1024;
+
+        // the draw ids share a batch id with the state above the depth
+        constexpr uint32_t k_draw_bits = 64 - (SortKey::k_pass_bits + SortKey::k_pipeline_bits + SortKey::k_material_bits);
+        constexpr uint32_t k_new_draw  = ~0u;
+
+        uint64_t draw_id(const DrawPacket& packet) { return static_cast<uint64_t>(packet.mesh) << 32 | packet.material; }
+
+        using clock = std::chrono::high_resolution_clock;
+
+        float elapsed_ms(clock::time_point start) { return std::chrono::duration<float, std::milli>(clock::now() - start).count(); }
+    } // namespace
+
+    void RenderQueue::initialize()
+    {
+        reset();
+        m_statistics = {};
+    }
+
+    void RenderQueue::clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_packets.clear();
+        m_packet_instances.clear();
+        m_items.clear();
+        m_scratch.clear();
+        m_order.clear();
+        m_batches.clear();
+        m_instances.clear();
+        m_batch_of.clear();
+        m_rank.clear();
+        m_histogram.clear();
+        m_batch_ids.clear();
+        m_draw_ids.clear();
+
+        std::lock_guard<std::mutex> id_lock(m_id_mutex);
+        m_mesh_ids.clear();
+        m_material_ids.clear();
+    }
+
+    void RenderQueue::reset()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_packets.clear();
+        m_packet_instances.clear();
+        m_order.clear();
+        m_batches.clear();
+        m_instances.clear();
+    }
+
+    uint32_t RenderQueue::getMeshId(const std::string& name)
+    {
+        std::lock_guard<std::mutex> lock(m_id_mutex);
+        return m_mesh_ids.emplace(name, static_cast<uint32_t>(m_mesh_ids.size())).first->second;
+    }
+
+    uint32_t RenderQueue::getMaterialId(const std::string& name)
+    {
+        std::lock_guard<std::mutex> lock(m_id_mutex);
+        return m_material_ids.emplace(name, static_cast<uint32_t>(m_material_ids.size())).first->second;
+    }
+
+    void RenderQueue::setView(const FVector3& position, const FVector3& forward, float far_plane)
+    {
+        m_view_position = position;
+        m_view_forward  = forward.normalized();
+        m_far_plane     = std::max(far_plane, 1e-4f);
+    }
+
+    float RenderQueue::viewDepth(const FVector3& position) const { return (position - m_view_position).dot(m_view_forward) / m_far_plane; }
+
+    void RenderQueue::submit(const DrawPacket& packet, const DrawInstance& instance)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_packets.push_back(packet);
+        m_packet_instances.push_back(instance);
+    }
+
+    void RenderQueue::submit(const DrawPacket* packets, const DrawInstance* instances, uint32_t count)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_packets.insert(m_packets.end(), packets, packets + count);
+        m_packet_instances.insert(m_packet_instances.end(), instances, instances + count);
+    }
+
+    void RenderQueue::build()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_statistics         = {};
+        m_statistics.packets = static_cast<uint32_t>(m_packets.size());
+
+        auto start = clock::now();
+        sort();
+        m_statistics.sort_ms = elapsed_ms(start);
+
+        start = clock::now();
+        batch();
+        m_statistics.batch_ms = elapsed_ms(start);
+        m_statistics.batches  = static_cast<uint32_t>(m_batches.size());
+    }
+
+    void RenderQueue::sort()
+    {
+        const uint32_t count = static_cast<uint32_t>(m_packets.size());
+
+        m_items.resize(count);
+        m_scratch.resize(count);
+        m_order.resize(count);
+
+        const uint32_t chunks = std::clamp((count + k_min_chunk - 1) / k_min_chunk, 1u, std::max(m_thread_count, 1u));
+        const uint32_t grain  = (count + chunks - 1) / std::max(chunks, 1u);
+        auto           range  = [count, grain](uint32_t chunk, uint32_t& begin, uint32_t& end) {
+            begin = std::min(chunk * grain, count);
+            end   = std::min(begin + grain, count);
+        };
+
+        // the keys and which of their bytes differ at all, a byte every key shares needs no pass. The draw ids are only
+        // looked up here, pairs not seen before are added once the chunks are done
+        std::vector<std::array<uint64_t, 2>> bounds(chunks, {~0ull, 0ull});
+        std::vector<uint8_t>                 new_draws(chunks, 0);
+        parallel_for(m_executor, chunks, 1, [&](uint32_t first, uint32_t last) {
+            for (uint32_t chunk = first; chunk < last; ++chunk)
+            {
+                uint32_t begin, end;
+                range(chunk, begin, end);
+
+                uint64_t all_and = ~0ull;
+                uint64_t all_or  = 0;
+                for (uint32_t i = begin; i < end; ++i)
+                {
+                    const DrawPacket& packet = m_packets[i];
+
+                    auto iter  = m_draw_ids.find(draw_id(packet));
+                    m_items[i] = {packet.key, i, iter == m_draw_ids.end() ? k_new_draw : iter->second};
+                    all_and &= packet.key;
+                    all_or |= packet.key;
+                }
+                bounds[chunk]    = {all_and, all_or};
+                new_draws[chunk] = std::any_of(m_items.begin() + begin, m_items.begin() + end, [](const SortItem& item) { return item.draw == k_new_draw; });
+            }
+        });
+
+        if (std::any_of(new_draws.begin(), new_draws.end(), [](uint8_t found) { return found != 0; }))
+        {
+            for (SortItem& item : m_items)
+            {
+                if (item.draw == k_new_draw)
+                {
+                    item.draw = m_draw_ids.emplace(draw_id(m_packets[item.index]), static_cast<uint32_t>(m_draw_ids.size())).first->second;
+                }
+            }
+            ASSERT(m_draw_ids.size() < (1ull << k_draw_bits));
+        }
+
+        uint64_t all_and = ~0ull;
+        uint64_t all_or  = 0;
+        for (const auto& [chunk_and, chunk_or] : bounds)
+        {
+            all_and &= chunk_and;
+            all_or |= chunk_or;
+        }
+        const uint64_t varying = all_and ^ all_or;
+
+        m_histogram.resize(static_cast<size_t>(chunks) * k_radix_buckets);
+        for (uint32_t pass = 0; pass < k_radix_passes; ++pass)
+        {
+            const uint32_t shift = pass * k_radix_bits;
+            if ((varying >> shift & (k_radix_buckets - 1)) == 0)
+            {
+                continue;
+            }
+            m_statistics.radix_passes += 1;
+
+            // every chunk counts its own bytes, the prefix over bytes then chunks is where each chunk writes, so the scatter
+            // keeps the order of equal bytes and the sort stays stable
+            std::fill(m_histogram.begin(), m_histogram.end(), 0);
+            parallel_for(m_executor, chunks, 1, [&](uint32_t first, uint32_t last) {
+                for (uint32_t chunk = first; chunk < last; ++chunk)
+                {
+                    uint32_t begin, end;
+                    range(chunk, begin, end);
+
+                    uint32_t*       histogram = &m_histogram[static_cast<size_t>(chunk) * k_radix_buckets];
+                    const SortItem* src       = m_items.data();
+                    for (uint32_t i = begin; i < end; ++i)
+                    {
+                        histogram[src[i].key >> shift & (k_radix_buckets - 1)] += 1;
+                    }
+                }
+            });
+
+            uint32_t offset = 0;
+            for (uint32_t bucket = 0; bucket < k_radix_buckets; ++bucket)
+            {
+                for (uint32_t chunk = 0; chunk < chunks; ++chunk)
+                {
+                    uint32_t&      slot         = m_histogram[static_cast<size_t>(chunk) * k_radix_buckets + bucket];
+                    const uint32_t bucket_count = slot;
+                    slot                        = offset;
+                    offset += bucket_count;
+                }
+            }
+
+            parallel_for(m_executor, chunks, 1, [&](uint32_t first, uint32_t last) {
+                for (uint32_t chunk = first; chunk < last; ++chunk)
+                {
+                    uint32_t begin, end;
+                    range(chunk, begin, end);
+
+                    uint32_t*       offsets = &m_histogram[static_cast<size_t>(chunk) * k_radix_buckets];
+                    const SortItem* src     = m_items.data();
+                    SortItem*       dst     = m_scratch.data();
+                    for (uint32_t i = begin; i < end; ++i)
+                    {
+                        dst[offsets[src[i].key >> shift & (k_radix_buckets - 1)]++] = src[i];
+                    }
+                }
+            });
+
+            m_items.swap(m_scratch);
+        }
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            m_order[i] = m_items[i].index;
+        }
+    }
+
+    void RenderQueue::batch()
+    {
+        const uint32_t count = static_cast<uint32_t>(m_order.size());
+
+        m_batches.clear();
+        m_batch_of.resize(count);
+        m_rank.resize(count);
+
+        // packets sharing everything but the depth are next to each other, among them each mesh and material becomes one
+        // batch, placed where its nearest packet was. Neighbours mostly draw the same thing, so the map is the slow path.
+        m_batch_ids.clear();
+
+        uint32_t last_batch = 0;
+        uint64_t last_id    = ~0ull;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const SortItem& item = m_items[i];
+            const uint64_t  id   = SortKey::state(item.key) << k_draw_bits | item.draw;
+
+            if (id != last_id)
+            {
+                auto [iter, inserted] = m_batch_ids.emplace(id, static_cast<uint32_t>(m_batches.size()));
+                if (inserted)
+                {
+                    const DrawPacket& packet = m_packets[item.index];
+
+                    DrawBatch batch;
+                    batch.key      = item.key;
+                    batch.mesh     = packet.mesh;
+                    batch.material = packet.material;
+                    m_batches.push_back(batch);
+                }
+                last_batch = iter->second;
+                last_id    = id;
+            }
+
+            m_batch_of[i] = last_batch;
+            m_rank[i]     = m_batches[last_batch].instance_count++;
+        }
+
+        uint32_t first_instance = 0;
+        for (DrawBatch& batch : m_batches)
+        {
+            batch.first_instance = first_instance;
+            first_instance += batch.instance_count;
+        }
+
+        // every packet knows its slot, the gather is independent per packet
+        m_instances.resize(count);
+        const uint32_t grain = std::max(k_min_chunk, (count + std::max(m_thread_count, 1u) - 1) / std::max(m_thread_count, 1u));
+        parallel_for(m_executor, count, grain, [this](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                m_instances[m_batches[m_batch_of[i]].first_instance + m_rank[i]] = m_packet_instances[m_items[i].index];
+            }
+        });
+    }
+} // namespace ArchViz
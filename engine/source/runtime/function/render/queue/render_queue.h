@@ -0,0 +1,107 @@
+#pragma once
+#include "runtime/function/render/queue/draw_packet.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ArchViz
+{
+    class WorkExecutor;
+
+    struct RenderQueueStatistics
+    {
+        uint32_t packets {0};
+        uint32_t batches {0};
+        uint32_t radix_passes {0}; // byte passes actually run, those where every key has the same byte are skipped
+        float    sort_ms {0.0f};
+        float    batch_ms {0.0f}; // merging and gathering the instance stream
+    };
+
+    // the draws of a frame. Mesh components submit packets from any thread, build sorts them by key with a parallel radix
+    // sort and merges the packets of the same mesh and material that share the state above the depth into instanced
+    // batches. The per instance data is gathered into one stream in batch order, ready to be uploaded as an instance buffer.
+    class RenderQueue
+    {
+    public:
+        void initialize();
+        void clear();
+
+        // drops the packets of the last frame, the capacity is kept
+        void reset();
+
+        // the ids packets use, the same name always gets the same id
+        uint32_t getMeshId(const std::string& name);
+        uint32_t getMaterialId(const std::string& name);
+
+        // where the camera is, so submitters can turn a position into the depth of their key
+        void  setView(const FVector3& position, const FVector3& forward, float far_plane);
+        float viewDepth(const FVector3& position) const;
+
+        // thread safe
+        void submit(const DrawPacket& packet, const DrawInstance& instance);
+        void submit(const DrawPacket* packets, const DrawInstance* instances, uint32_t count);
+
+        // once a frame after everything was submitted
+        void build();
+
+        const std::vector<DrawBatch>&    getBatches() const { return m_batches; }
+        const std::vector<DrawInstance>& getInstances() const { return m_instances; }
+        // packet indices in key order, the radix sort is stable so equal keys keep their submission order
+        const std::vector<uint32_t>& getOrder() const { return m_order; }
+
+        uint32_t size() const { return static_cast<uint32_t>(m_packets.size()); }
+
+        const RenderQueueStatistics& getStatistics() const { return m_statistics; }
+
+    public:
+        std::shared_ptr<WorkExecutor> m_executor; // sorts and gathers inline when null
+
+        uint32_t m_thread_count {1}; // chunks the sort and the gather are split in
+
+    private:
+        struct SortItem
+        {
+            uint64_t key {0};
+            uint32_t index {0};
+            uint32_t draw {0}; // the mesh and material of the packet, from m_draw_ids
+        };
+
+        void sort();
+        void batch();
+
+    private:
+        std::mutex m_mutex;
+
+        std::vector<DrawPacket>   m_packets;
+        std::vector<DrawInstance> m_packet_instances;
+
+        std::vector<SortItem> m_items;
+        std::vector<SortItem> m_scratch;
+        std::vector<uint32_t> m_order;
+
+        std::vector<DrawBatch>    m_batches;
+        std::vector<DrawInstance> m_instances;
+        std::vector<uint32_t>     m_batch_of;  // per sorted packet
+        std::vector<uint32_t>     m_rank;      // per sorted packet, its instance within the batch
+        std::vector<uint32_t>     m_histogram; // per chunk and byte value
+
+        // mesh and material pairs seen so far, so batching only reads the sorted items. Kept across frames
+        std::unordered_map<uint64_t, uint32_t> m_draw_ids;
+        // state and draw to batch, within one build
+        std::unordered_map<uint64_t, uint32_t> m_batch_ids;
+
+        std::mutex                                m_id_mutex;
+        std::unordered_map<std::string, uint32_t> m_mesh_ids;
+        std::unordered_map<std::string, uint32_t> m_material_ids;
+
+        FVector3 m_view_position {FVector3::Zero()};
+        FVector3 m_view_forward {FVector3::UnitZ()};
+        float    m_far_plane {1.0f};
+
+        RenderQueueStatistics m_statistics;
+    };
+} // namespace ArchViz
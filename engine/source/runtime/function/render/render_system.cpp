@@ -1,4 +1,5 @@
 #include "runtime/function/render/render_system.h"
+#include "runtime/function/render/queue/render_queue.h"
 #include "runtime/function/render/render_camera.h"
 #include "runtime/function/render/rhi/vulkan/vulkan_rhi.h"
 
@@ -8,6 +9,7 @@
 #include "runtime/function/window/window_system.h"
 
 #include "runtime/core/math/math.h"
+#include "runtime/core/thread/work_executor.h"
 
 #define GLFW_INCLUDE_NONE
 #include <GLFW/glfw3.h>
@@ -49,6 +51,7 @@ namespace ArchViz
         // render context initialize
         RHIInitInfo rhi_init_info {};
         rhi_init_info.window_system = init_info.window_system;
+        rhi_init_info.executor      = init_info.executor;
 
         m_window_system = init_info.window_system;
 
@@ -62,6 +65,13 @@ namespace ArchViz
         m_render_camera->m_move_speed   = 1.0;
         m_render_camera->m_rotate_speed = 0.1;
 
+        m_render_queue                 = std::make_shared<RenderQueue>();
+        m_render_queue->m_executor     = init_info.executor;
+        m_render_queue->m_thread_count = init_info.executor ? static_cast<uint32_t>(init_info.executor->size()) : 1;
+        m_render_queue->initialize();
+
+        rhi_init_info.render_queue = m_render_queue;
+
         m_rhi = std::make_shared<VulkanRHI>();
         m_rhi->initialize(rhi_init_info);
 
@@ -75,11 +85,16 @@ namespace ArchViz
         // process swap data between logic and render contexts
         processSwapData(delta_time);
 
+        // sort and merge the draws submitted since the last frame
+        m_render_queue->build();
+
         // prepare render command context
         m_rhi->prepareContext();
 
         // render context
         m_rhi->render();
+
+        m_render_queue->reset();
     }
 
     void RenderSystem::processSwapData(float delta_time)
@@ -124,6 +139,8 @@ namespace ArchViz
         FMatrix4 model {FMatrix4::Identity()};
         model.block<3, 3>(0, 0) = Eigen::AngleAxisf(time * 0.1f, FVector3::UnitZ()).toRotationMatrix();
 
+        m_render_queue->setView({2, 2, 2}, {-2, -2, -2}, 100.0f);
+
         m_rhi->m_ubo.view  = Math::lookAt({2, 2, 2}, {0, 0, 0}, {0, 0, 1});                         // m_render_camera->m_view;
         m_rhi->m_ubo.proj  = Math::perspective(45.0f, (float)width / (float)height, 0.01f, 100.0f); // m_render_camera->m_projction;
         m_rhi->m_ubo.model = model;
@@ -136,6 +153,12 @@ namespace ArchViz
 
     void RenderSystem::clear()
     {
+        if (m_render_queue)
+        {
+            m_render_queue->clear();
+        }
+        m_render_queue.reset();
+
         if (m_rhi)
         {
             m_rhi->clear();
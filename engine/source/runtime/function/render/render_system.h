@@ -10,12 +10,15 @@ namespace ArchViz
     class ConfigManager;
     class AssetManager;
     class RenderCamera;
+    class RenderQueue;
+    class WorkExecutor;
     class VulkanRHI;
     class RHI;
 
     struct RenderSystemInitInfo
     {
         std::shared_ptr<WindowSystem> window_system;
+        std::shared_ptr<WorkExecutor> executor; // shared with the rest of the runtime, the frame work runs inline without it
     };
 
     struct EngineContentViewport
@@ -37,6 +40,9 @@ namespace ArchViz
         void tick(float delta_time);
         void clear();
 
+        // where mesh components submit their draws every frame
+        std::shared_ptr<RenderQueue> getRenderQueue() const { return m_render_queue; }
+
     private:
         void processSwapData(float delta_time);
 
@@ -49,6 +55,7 @@ namespace ArchViz
 
         std::shared_ptr<VulkanRHI>    m_rhi;
         std::shared_ptr<RenderCamera> m_render_camera;
+        std::shared_ptr<RenderQueue>  m_render_queue;
 
         // std::shared_ptr<RenderScene>        m_render_scene;
         // std::shared_ptr<RenderResourceBase> m_render_resource;
@@ -0,0 +1,79 @@
+#include "runtime/function/render/rhi/bindless_index_allocator.h"
+
+#include "runtime/core/base/macro.h"
+
+#include <algorithm>
+
+namespace ArchViz
+{
+    void BindlessIndexAllocator::initialize(uint32_t capacity, uint32_t frame_latency)
+    {
+        ASSERT(capacity > 0);
+        clear();
+        m_capacity      = capacity;
+        m_frame_latency = frame_latency;
+        m_allocated.assign(capacity, false);
+    }
+
+    void BindlessIndexAllocator::clear()
+    {
+        m_capacity      = 0;
+        m_frame_latency = 0;
+        m_frame         = 0;
+        m_next          = 0;
+        m_count         = 0;
+        m_free.clear();
+        m_pending.clear();
+        m_allocated.clear();
+        m_statistics = {};
+    }
+
+    uint32_t BindlessIndexAllocator::allocate()
+    {
+        uint32_t index = k_invalid_index;
+        if (!m_free.empty())
+        {
+            index = m_free.back();
+            m_free.pop_back();
+        }
+        else if (m_next < m_capacity)
+        {
+            index = m_next++;
+        }
+        else
+        {
+            m_statistics.refused += 1;
+            return k_invalid_index;
+        }
+
+        m_allocated[index] = true;
+        m_count += 1;
+
+        m_statistics.allocations += 1;
+        m_statistics.peak = std::max(m_statistics.peak, m_count);
+        return index;
+    }
+
+    void BindlessIndexAllocator::free(uint32_t index)
+    {
+        ASSERT(isAllocated(index));
+
+        m_allocated[index] = false;
+        m_count -= 1;
+        m_pending.push_back({index, m_frame});
+
+        m_statistics.frees += 1;
+    }
+
+    void BindlessIndexAllocator::advance()
+    {
+        m_frame += 1;
+
+        // frees are queued in frame order, the oldest are at the front
+        while (!m_pending.empty() && m_pending.front().frame + m_frame_latency <= m_frame)
+        {
+            m_free.push_back(m_pending.front().index);
+            m_pending.pop_front();
+        }
+    }
+} // namespace ArchViz
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace ArchViz
+{
+    struct BindlessIndexStatistics
+    {
+        uint64_t allocations {0};
+        uint64_t frees {0};
+        uint64_t refused {0}; // allocations while every index was in use or waiting for its frame
+        uint32_t peak {0};    // most indices allocated at once
+    };
+
+    // the slots of one bindless descriptor array. An index stays with its resource until it is freed, and a freed index is
+    // only handed out again frame_latency frames later, once the frames that may still sample it completed. Freed indices
+    // are reused before the array grows, so the written part of the array stays as small as the live set.
+    class BindlessIndexAllocator
+    {
+    public:
+        static constexpr uint32_t k_invalid_index = ~0u;
+
+        void initialize(uint32_t capacity, uint32_t frame_latency);
+        void clear();
+
+        // k_invalid_index when every index is in use
+        uint32_t allocate();
+        // the index is given back by the advance that is frame_latency frames after this one
+        void free(uint32_t index);
+
+        // a new frame begins, the fence of the frame frame_latency ago was waited for
+        void advance();
+
+        bool isAllocated(uint32_t index) const { return index < m_allocated.size() && m_allocated[index]; }
+
+        uint32_t capacity() const { return m_capacity; }
+        uint32_t allocated() const { return m_count; }
+        uint32_t pending() const { return static_cast<uint32_t>(m_pending.size()); }
+        uint64_t frame() const { return m_frame; }
+
+        const BindlessIndexStatistics& getStatistics() const { return m_statistics; }
+
+    private:
+        struct Pending
+        {
+            uint32_t index {0};
+            uint64_t frame {0}; // the frame it was freed in
+        };
+
+        uint32_t m_capacity {0};
+        uint32_t m_frame_latency {0};
+        uint64_t m_frame {0};
+
+        uint32_t m_next {0};  // indices from here on were never handed out
+        uint32_t m_count {0}; // allocated and not yet freed
+
+        std::vector<uint32_t> m_free; // reused last in, first out
+        std::deque<Pending>   m_pending;
+        std::vector<bool>     m_allocated;
+
+        BindlessIndexStatistics m_statistics;
+    };
+} // namespace ArchViz
@@ -3,6 +3,8 @@
 #include "runtime/core/base/hash.h"
 #include "runtime/core/base/macro.h"
 
+#include <algorithm>
+#include <cstring>
 #include <stack>
 
 namespace ArchViz
@@ -46,6 +48,118 @@ namespace ArchViz
         return RenderPassOperation::DontCare;
     }
 
+    static VkFormat string_to_format(const std::string& format)
+    {
+        struct FormatName
+        {
+            const char* name;
+            VkFormat    format;
+        };
+
+        static const FormatName k_formats[] = {
+            {"VK_FORMAT_R8_UNORM", VK_FORMAT_R8_UNORM},
+            {"VK_FORMAT_R8G8_UNORM", VK_FORMAT_R8G8_UNORM},
+            {"VK_FORMAT_R8G8B8A8_UNORM", VK_FORMAT_R8G8B8A8_UNORM},
+            {"VK_FORMAT_R8G8B8A8_SRGB", VK_FORMAT_R8G8B8A8_SRGB},
+            {"VK_FORMAT_B8G8R8A8_UNORM", VK_FORMAT_B8G8R8A8_UNORM},
+            {"VK_FORMAT_B8G8R8A8_SRGB", VK_FORMAT_B8G8R8A8_SRGB},
+            {"VK_FORMAT_A2B10G10R10_UNORM_PACK32", VK_FORMAT_A2B10G10R10_UNORM_PACK32},
+            {"VK_FORMAT_B10G11R11_UFLOAT_PACK32", VK_FORMAT_B10G11R11_UFLOAT_PACK32},
+            {"VK_FORMAT_R16_SFLOAT", VK_FORMAT_R16_SFLOAT},
+            {"VK_FORMAT_R16G16_SFLOAT", VK_FORMAT_R16G16_SFLOAT},
+            {"VK_FORMAT_R16G16B16A16_SFLOAT", VK_FORMAT_R16G16B16A16_SFLOAT},
+            {"VK_FORMAT_R32_SFLOAT", VK_FORMAT_R32_SFLOAT},
+            {"VK_FORMAT_R32_UINT", VK_FORMAT_R32_UINT},
+            {"VK_FORMAT_R32G32_SFLOAT", VK_FORMAT_R32G32_SFLOAT},
+            {"VK_FORMAT_R32G32B32A32_SFLOAT", VK_FORMAT_R32G32B32A32_SFLOAT},
+            {"VK_FORMAT_D16_UNORM", VK_FORMAT_D16_UNORM},
+            {"VK_FORMAT_D24_UNORM_S8_UINT", VK_FORMAT_D24_UNORM_S8_UINT},
+            {"VK_FORMAT_D32_SFLOAT", VK_FORMAT_D32_SFLOAT},
+            {"VK_FORMAT_D32_SFLOAT_S8_UINT", VK_FORMAT_D32_SFLOAT_S8_UINT},
+        };
+
+        for (const auto& entry : k_formats)
+        {
+            if (format.compare(entry.name) == 0)
+            {
+                return entry.format;
+            }
+        }
+
+        LOG_WARN("unknown frame graph format {}", format);
+        return VK_FORMAT_R8G8B8A8_UNORM;
+    }
+
+    // Hash::u64 only keeps the last 8 characters of a string, node and resource names are longer than that
+    static uint64_t name_key(const std::string& name) { return Hash::hash_bytes(name.data(), name.size()); }
+
+    // stages, access and layout of one use of a resource, usage is the input or output type
+    static bool resource_access(const FrameGraphResource& resource, FrameGraphResourceType usage, bool output, bool compute, FrameGraphAccess& access)
+    {
+        const VkPipelineStageFlags shader_stage = compute ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+
+        access          = {};
+        access.resource = resource.output_handle;
+        access.write    = output;
+
+        if (resource.type == FrameGraphResourceType::Buffer)
+        {
+            if (usage == FrameGraphResourceType::Reference)
+            {
+                return false;
+            }
+            access.state.stages = output ? shader_stage : shader_stage | (compute ? 0 : VK_PIPELINE_STAGE_VERTEX_SHADER_BIT);
+            access.state.access = output ? VK_ACCESS_SHADER_WRITE_BIT : VK_ACCESS_SHADER_READ_BIT;
+            return true;
+        }
+
+        if (resource.type != FrameGraphResourceType::Texture && resource.type != FrameGraphResourceType::Attachment)
+        {
+            return false;
+        }
+
+        const FrameGraphTexture& texture = resource.resource_info.texture;
+        const bool               depth   = frame_graph_format_is_depth(texture.format);
+
+        access.image  = true;
+        access.aspect = depth ? VK_IMAGE_ASPECT_DEPTH_BIT | (frame_graph_format_has_stencil(texture.format) ? VK_IMAGE_ASPECT_STENCIL_BIT : 0) : VK_IMAGE_ASPECT_COLOR_BIT;
+
+        if (usage == FrameGraphResourceType::Attachment && depth)
+        {
+            // written depth is tested and stored, an input depth attachment is only tested against
+            access.state.stages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+            access.state.access = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | (output ? VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT : 0);
+            access.state.layout = output ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+        }
+        else if (usage == FrameGraphResourceType::Attachment)
+        {
+            // an input color attachment is loaded and drawn over
+            const bool load     = !output || texture.load_op == RenderPassOperation::Load;
+            access.write        = true;
+            access.state.stages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+            access.state.access = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | (load ? VK_ACCESS_COLOR_ATTACHMENT_READ_BIT : 0);
+            access.state.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        }
+        else if (usage == FrameGraphResourceType::Texture && output)
+        {
+            // storage image
+            access.state.stages = shader_stage;
+            access.state.access = VK_ACCESS_SHADER_WRITE_BIT;
+            access.state.layout = VK_IMAGE_LAYOUT_GENERAL;
+        }
+        else if (usage == FrameGraphResourceType::Texture)
+        {
+            access.state.stages = shader_stage;
+            access.state.access = VK_ACCESS_SHADER_READ_BIT;
+            access.state.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    }
+
     void generate_graphviz(const FrameGraph& graph, std::string& result)
     {
         result.clear();
@@ -54,6 +168,10 @@ namespace ArchViz
         for (auto& node_index : graph.nodes)
         {
             auto& node = graph.builder.node_cache.nodes[node_index.index];
+            // a disabled node is only there because an enabled one reads it, its own inputs are not part of the graph
+            if (!node.enabled)
+                continue;
+
             for (auto& edge_index : node.edges_backward)
             {
                 auto& other_node = graph.builder.node_cache.nodes[edge_index.index];
@@ -72,7 +190,7 @@ namespace ArchViz
 
     FrameGraphNode* FrameGraphBuilder::getNode(const std::string& name)
     {
-        auto it = node_cache.node_map.find(Hash::u64(name));
+        auto it = node_cache.node_map.find(name_key(name));
         if (it == node_cache.node_map.end())
             return {};
         return &node_cache.nodes[it->second.index];
@@ -87,7 +205,7 @@ namespace ArchViz
 
     FrameGraphResource* FrameGraphBuilder::getResource(const std::string& name)
     {
-        auto it = resource_cache.resource_map.find(Hash::u64(name));
+        auto it = resource_cache.resource_map.find(name_key(name));
         if (it == resource_cache.resource_map.end())
             return {};
         return &resource_cache.resources[it->second.index];
@@ -102,7 +220,7 @@ namespace ArchViz
 
     FrameGraphResourceHandle FrameGraphBuilder::createNodeOutput(const FrameGraphResourceOutputCreation& creation, FrameGraphNodeHandle producer)
     {
-        auto it = resource_cache.resource_map.find(Hash::u64(creation.name));
+        auto it = resource_cache.resource_map.find(name_key(creation.name));
         if (it == resource_cache.resource_map.end())
         {
             // create resource
@@ -112,7 +230,7 @@ namespace ArchViz
             resource.output_handle = {static_cast<uint32_t>(resource_cache.resources.size())};
 
             resource_cache.resources.push_back(resource);
-            resource_cache.resource_map[Hash::u64(creation.name)] = resource.output_handle;
+            resource_cache.resource_map[name_key(creation.name)] = resource.output_handle;
 
             return resource.output_handle;
         }
@@ -127,9 +245,33 @@ namespace ArchViz
         return it->second;
     }
 
+    void FrameGraphBuilder::setResourceInfo(FrameGraphResourceHandle handle, const FrameGraphResourceOutputCreation& creation)
+    {
+        FrameGraphResource* resource = accessResource(handle);
+
+        // outputs without a type only order the nodes
+        resource->type                   = creation.type_name.empty() ? FrameGraphResourceType::Reference : string_to_resource_type(creation.type_name);
+        resource->resource_info          = {};
+        resource->resource_info.external = creation.external;
+
+        if (resource->type == FrameGraphResourceType::Buffer)
+        {
+            resource->resource_info.buffer.size = creation.size;
+        }
+        else if (resource->type == FrameGraphResourceType::Texture || resource->type == FrameGraphResourceType::Attachment)
+        {
+            FrameGraphTexture& texture = resource->resource_info.texture;
+            texture.width              = creation.width;
+            texture.height             = creation.height;
+            texture.depth              = std::max(creation.depth, 1u);
+            texture.format             = creation.format.empty() ? VK_FORMAT_R8G8B8A8_UNORM : string_to_format(creation.format);
+            texture.load_op            = creation.load_op.empty() ? RenderPassOperation::DontCare : string_to_render_pass_operation(creation.load_op);
+        }
+    }
+
     FrameGraphResourceHandle FrameGraphBuilder::createNodeInput(const FrameGraphResourceInputCreation& creation)
     {
-        auto it = resource_cache.resource_map.find(Hash::u64(creation.name));
+        auto it = resource_cache.resource_map.find(name_key(creation.name));
         if (it == resource_cache.resource_map.end())
         {
             // create resource
@@ -139,7 +281,7 @@ namespace ArchViz
             resource.output_handle = {static_cast<uint32_t>(resource_cache.resources.size())};
 
             resource_cache.resources.push_back(resource);
-            resource_cache.resource_map[Hash::u64(creation.name)] = resource.output_handle;
+            resource_cache.resource_map[name_key(creation.name)] = resource.output_handle;
 
             return resource.output_handle;
         }
@@ -148,17 +290,19 @@ namespace ArchViz
 
     FrameGraphNodeHandle FrameGraphBuilder::createNode(const FrameGraphNodeCreation& creation)
     {
-        auto it = node_cache.node_map.find(Hash::u64(creation.name));
+        auto it = node_cache.node_map.find(name_key(creation.name));
         if (it == node_cache.node_map.end())
         {
             // create resource
             FrameGraphNode node;
-            node.name = creation.name;
+            node.name    = creation.name;
+            node.enabled = creation.enabled;
+            node.compute = creation.compute;
 
-            node_cache.node_map[Hash::u64(creation.name)] = {static_cast<uint32_t>(node_cache.nodes.size())};
+            node_cache.node_map[name_key(creation.name)] = {static_cast<uint32_t>(node_cache.nodes.size())};
             node_cache.nodes.push_back(node);
 
-            return node_cache.node_map[Hash::u64(creation.name)];
+            return node_cache.node_map[name_key(creation.name)];
         }
         return it->second;
     }
@@ -184,11 +328,13 @@ namespace ArchViz
             {
                 auto handle = createNodeInput(input);
                 node->inputs.push_back(handle);
+                node->input_types.push_back(input.type_name.empty() ? FrameGraphResourceType::Invalid : string_to_resource_type(input.type_name));
             }
             // create output resources
             for (auto& output : outputs)
             {
                 auto handle = createNodeOutput(output, node_handle);
+                setResourceInfo(handle, output);
                 node->outputs.push_back(handle);
             }
         }
@@ -229,10 +375,19 @@ namespace ArchViz
         LOG_DEBUG("shutdown frame graph builder");
         builder.shutdown();
         nodes.clear();
+        full_order.clear();
+        compiled_cache.clear();
+        structure_hash = 0;
+        compiled_hash  = 0;
+        schedule       = {};
+        memory_plan    = {};
+        barrier_plan   = {};
     }
 
     void FrameGraph::reset()
     {
+        // compile drops disabled nodes from the list
+        nodes.resize(builder.node_cache.nodes.size());
         for (uint32_t i = 0; i < builder.node_cache.nodes.size(); ++i)
         {
             nodes[i].index = i;
@@ -253,50 +408,70 @@ namespace ArchViz
         }
     }
 
-    void FrameGraph::compile()
+    void FrameGraph::hashGraph(uint64_t& structure, uint64_t& graph) const
     {
-        LOG_DEBUG("start compile frame graph");
+        size_t seed = builder.node_cache.nodes.size();
+        hash_combine(seed, builder.resource_cache.resources.size());
 
-        // - check that input has been produced by a different node
-        // - cull inactive nodes
-
-        // first clear all edges
-        for (uint32_t i = 0; i < nodes.size(); ++i)
+        for (const auto& node : builder.node_cache.nodes)
         {
-            FrameGraphNode* node = builder.accessNode(nodes[i]);
-
-            // NOTE(marco): we want to clear all edges first, then populate them. If we clear them inside the loop
-            // below we risk clearing the list after it has already been used by one of the child nodes
-            node->edges_backward.clear();
+            hash_combine(seed, node.compute, node.inputs.size(), node.outputs.size());
+            for (uint32_t i = 0; i < node.inputs.size(); ++i)
+            {
+                hash_combine(seed, node.inputs[i].index, static_cast<uint32_t>(node.input_types[i]));
+            }
+            for (const auto& output : node.outputs)
+            {
+                hash_combine(seed, output.index);
+            }
         }
 
-        // compute all edges
-        for (uint32_t i = 0; i < nodes.size(); ++i)
+        for (const auto& resource : builder.resource_cache.resources)
         {
-            FrameGraphNode* node = builder.accessNode(nodes[i]);
+            hash_combine(seed, static_cast<uint32_t>(resource.type), resource.producer.index, resource.output_handle.index, resource.resource_info.external);
+            if (resource.type == FrameGraphResourceType::Buffer)
+            {
+                const FrameGraphBuffer& buffer = resource.resource_info.buffer;
+                hash_combine(seed, buffer.size);
+            }
+            else if (resource.type == FrameGraphResourceType::Texture || resource.type == FrameGraphResourceType::Attachment)
+            {
+                const FrameGraphTexture& texture = resource.resource_info.texture;
+                hash_combine(seed, texture.width, texture.height, texture.depth, static_cast<uint32_t>(texture.format), static_cast<uint32_t>(texture.load_op));
+            }
+        }
+        structure = seed;
 
-            if (!node->enabled)
-                continue;
+        for (const auto& node : builder.node_cache.nodes)
+        {
+            hash_combine(seed, node.enabled);
+        }
+        hash_combine(seed, split_barriers, async_compute);
+        graph = seed;
+    }
 
-            computeEdges(node, i);
+    void FrameGraph::sortFullOrder()
+    {
+        // NOTE(marco): we want to clear all edges first, then populate them. If we clear them inside the loop
+        // below we risk clearing the list after it has already been used by one of the child nodes
+        for (auto& node : builder.node_cache.nodes)
+        {
+            node.edges_backward.clear();
+        }
+        for (uint32_t i = 0; i < builder.node_cache.nodes.size(); ++i)
+        {
+            computeEdges(&builder.node_cache.nodes[i], i);
         }
 
-        std::vector<FrameGraphNodeHandle> sorted_nodes;
+        full_order.clear();
 
-        std::vector<uint8_t> visited;
-        visited.resize(nodes.size());
-        memset(visited.data(), 0, sizeof(uint8_t) * visited.size());
+        std::vector<uint8_t> visited(builder.node_cache.nodes.size(), 0);
 
         std::vector<FrameGraphNodeHandle> stack;
 
-        for (uint32_t i = 0; i < nodes.size(); ++i)
+        for (uint32_t i = 0; i < builder.node_cache.nodes.size(); ++i)
         {
-            FrameGraphNode* node = builder.accessNode(nodes[i]);
-
-            if (!node->enabled)
-                continue;
-
-            stack.push_back(nodes[i]);
+            stack.push_back({i});
 
             while (stack.size() > 0)
             {
@@ -310,7 +485,7 @@ namespace ArchViz
                 if (visited[node_handle.index] == 1)
                 {
                     visited[node_handle.index] = 2; // added
-                    sorted_nodes.push_back(node_handle);
+                    full_order.push_back(node_handle);
                     stack.pop_back();
                     continue;
                 }
@@ -333,16 +508,294 @@ namespace ArchViz
                 }
             }
         }
+    }
+
+    void FrameGraph::compile()
+    {
+        LOG_DEBUG("start compile frame graph");
+        compile_statistics.compiles += 1;
+
+        uint64_t structure = 0;
+        uint64_t graph     = 0;
+        hashGraph(structure, graph);
+
+        // seen recently, the members already hold it or get a copy back
+        auto cached = compiled_cache.find(graph);
+        if (cached != compiled_cache.end())
+        {
+            FrameGraphCompiled& compiled = cached->second;
+            compiled.last_compile        = compile_statistics.compiles;
+            compile_statistics.cache_hits += 1;
+
+            nodes = compiled.nodes;
+            if (graph != compiled_hash)
+            {
+                for (uint32_t i = 0; i < builder.resource_cache.resources.size(); ++i)
+                {
+                    builder.resource_cache.resources[i].first_use = compiled.first_use[i];
+                    builder.resource_cache.resources[i].last_use  = compiled.last_use[i];
+                }
+                schedule      = compiled.schedule;
+                memory_plan   = compiled.memory_plan;
+                barrier_plan  = compiled.barrier_plan;
+                compiled_hash = graph;
+            }
+
+            LOG_DEBUG("reuse compiled frame graph");
+            return;
+        }
+
+        // - check that input has been produced by a different node
+        // - cull inactive nodes
+        if (structure != structure_hash || full_order.size() != builder.node_cache.nodes.size())
+        {
+            sortFullOrder();
+            structure_hash = structure;
+            compile_statistics.full += 1;
+        }
+        else
+        {
+            compile_statistics.partial += 1;
+        }
+
+        // enabled nodes and the ones they read from, the full order filtered keeps them sorted
+        std::vector<uint8_t> included(builder.node_cache.nodes.size(), 0);
+        for (uint32_t i = 0; i < builder.node_cache.nodes.size(); ++i)
+        {
+            const FrameGraphNode& node = builder.node_cache.nodes[i];
+            if (!node.enabled)
+                continue;
+
+            included[i] = 1;
+            for (auto& edge : node.edges_backward)
+            {
+                included[edge.index] = 1;
+            }
+        }
 
         nodes.clear();
-        for (auto& sort : sorted_nodes)
+        for (auto& sort : full_order)
+        {
+            if (included[sort.index])
+            {
+                nodes.push_back(sort);
+            }
+        }
+
+        planSchedule();
+        computeLifetimes();
+        planMemory();
+        planBarriers();
+
+        // keep it, dropping the one used longest ago when full
+        if (compiled_cache.size() >= compiled_cache_capacity && !compiled_cache.empty())
+        {
+            auto oldest = std::min_element(compiled_cache.begin(), compiled_cache.end(), [](const auto& a, const auto& b) { return a.second.last_compile < b.second.last_compile; });
+            compiled_cache.erase(oldest);
+        }
+        if (compiled_cache_capacity > 0)
         {
-            nodes.push_back(sort);
+            FrameGraphCompiled& compiled = compiled_cache[graph];
+            compiled.nodes               = nodes;
+            compiled.schedule            = schedule;
+            compiled.memory_plan         = memory_plan;
+            compiled.barrier_plan        = barrier_plan;
+            compiled.last_compile        = compile_statistics.compiles;
+            for (const auto& resource : builder.resource_cache.resources)
+            {
+                compiled.first_use.push_back(resource.first_use);
+                compiled.last_use.push_back(resource.last_use);
+            }
         }
+        compiled_hash = graph;
 
         LOG_DEBUG("finish compile frame graph");
+    }
+
+    void FrameGraph::planSchedule()
+    {
+        std::vector<std::vector<FrameGraphAccess>> accesses;
+        gatherAccesses(accesses);
+
+        std::vector<uint32_t> position_of(builder.node_cache.nodes.size(), k_invalid_index);
+        for (uint32_t position = 0; position < nodes.size(); ++position)
+        {
+            position_of[nodes[position].index] = position;
+        }
+
+        std::vector<FrameGraphSchedulePass> passes(nodes.size());
+        for (uint32_t position = 0; position < nodes.size(); ++position)
+        {
+            FrameGraphNode*         node = builder.accessNode(nodes[position]);
+            FrameGraphSchedulePass& pass = passes[position];
+
+            pass.async = node->compute;
+            for (auto& input : node->inputs)
+            {
+                const FrameGraphResource* resource = builder.accessResource(input);
+                if (resource->producer.index != k_invalid_index && position_of[resource->producer.index] != k_invalid_index)
+                {
+                    pass.dependencies.push_back(position_of[resource->producer.index]);
+                }
+            }
+
+            // cost in full screen RGBA8 passes, a guess from the bytes the pass touches until there are GPU timings to use
+            uint64_t bytes = 0;
+            for (const auto& access : accesses[position])
+            {
+                const FrameGraphResource* resource = builder.accessResource(access.resource);
+
+                bytes += access.image ? frame_graph_texture_size(resource->resource_info.texture) : resource->resource_info.buffer.size;
+                pass.wait_stages |= access.state.stages;
+            }
+            pass.cost = std::max(1.0f, static_cast<float>(bytes) / (1920.0f * 1080.0f * 4.0f));
+        }
+
+        plan_frame_graph_schedule(passes, async_compute, schedule);
+
+        std::vector<FrameGraphNodeHandle> scheduled(nodes.size());
+        for (uint32_t position = 0; position < nodes.size(); ++position)
+        {
+            scheduled[position] = nodes[schedule.order[position]];
+        }
+        nodes = scheduled;
+    }
+
+    void FrameGraph::computeLifetimes()
+    {
+        for (auto& resource : builder.resource_cache.resources)
+        {
+            resource.first_use = k_invalid_index;
+            resource.last_use  = k_invalid_index;
+        }
+
+        auto use = [&](FrameGraphResourceHandle handle, uint32_t position) {
+            FrameGraphResource* resource = builder.accessResource(handle);
+            if (resource == nullptr)
+            {
+                return;
+            }
+            resource->first_use = resource->first_use == k_invalid_index ? position : std::min(resource->first_use, position);
+            resource->last_use  = resource->last_use == k_invalid_index ? position : std::max(resource->last_use, position);
+        };
+
+        for (uint32_t position = 0; position < nodes.size(); ++position)
+        {
+            FrameGraphNode* node = builder.accessNode(nodes[position]);
+            for (auto& output : node->outputs)
+            {
+                use(output, position);
+            }
+            for (auto& input : node->inputs)
+            {
+                use(input, position);
+            }
+        }
+    }
+
+    void FrameGraph::planMemory()
+    {
+        // the compute queue runs beside the graphics one, positions say nothing about when its resources are free
+        std::vector<bool> async_resources(builder.resource_cache.resources.size(), false);
+        for (uint32_t position = 0; position < nodes.size() && position < schedule.queues.size(); ++position)
+        {
+            if (schedule.queues[position] != FrameGraphQueueType::Compute)
+            {
+                continue;
+            }
+
+            FrameGraphNode* node = builder.accessNode(nodes[position]);
+            for (auto& input : node->inputs)
+            {
+                async_resources[input.index] = true;
+            }
+            for (auto& output : node->outputs)
+            {
+                async_resources[output.index] = true;
+            }
+        }
+
+        std::vector<FrameGraphMemoryRequest> requests;
+        for (uint32_t i = 0; i < builder.resource_cache.resources.size(); ++i)
+        {
+            const FrameGraphResource& resource = builder.resource_cache.resources[i];
+
+            // imported resources and the ones nothing in the graph produces keep their own memory
+            const bool transient = !resource.resource_info.external && resource.producer.index != k_invalid_index && resource.first_use != k_invalid_index;
+            if (!transient)
+            {
+                continue;
+            }
+
+            FrameGraphMemoryRequest request;
+            request.resource  = {i};
+            request.first_use = resource.first_use;
+            request.last_use  = resource.last_use;
+            request.aliasable = !async_resources[i];
+            if (resource.type == FrameGraphResourceType::Buffer)
+            {
+                request.heap_type = FrameGraphHeapType::Buffer;
+                request.size      = resource.resource_info.buffer.size;
+                request.alignment = frame_graph_buffer_alignment();
+            }
+            else if (resource.type == FrameGraphResourceType::Texture || resource.type == FrameGraphResourceType::Attachment)
+            {
+                request.heap_type = FrameGraphHeapType::Texture;
+                request.size      = frame_graph_texture_size(resource.resource_info.texture);
+                request.alignment = frame_graph_texture_alignment();
+            }
+            if (request.size != 0)
+            {
+                requests.push_back(request);
+            }
+        }
+
+        plan_frame_graph_memory(requests, memory_plan);
+    }
+
+    void FrameGraph::gatherAccesses(std::vector<std::vector<FrameGraphAccess>>& accesses)
+    {
+        accesses.clear();
+        accesses.resize(nodes.size());
+        for (uint32_t position = 0; position < nodes.size(); ++position)
+        {
+            FrameGraphNode* node = builder.accessNode(nodes[position]);
+
+            FrameGraphAccess access;
+            for (uint32_t i = 0; i < node->inputs.size(); ++i)
+            {
+                const FrameGraphResource* resource = builder.accessResource(node->inputs[i]);
+
+                // an untyped input is sampled, or read from when it is a buffer
+                FrameGraphResourceType usage = i < node->input_types.size() ? node->input_types[i] : FrameGraphResourceType::Invalid;
+                if (usage == FrameGraphResourceType::Invalid)
+                {
+                    usage = resource->type == FrameGraphResourceType::Attachment ? FrameGraphResourceType::Texture : resource->type;
+                }
+
+                if (resource_access(*resource, usage, false, node->compute, access))
+                {
+                    accesses[position].push_back(access);
+                }
+            }
+            for (auto& output : node->outputs)
+            {
+                const FrameGraphResource* resource = builder.accessResource(output);
+                if (resource_access(*resource, resource->type, true, node->compute, access))
+                {
+                    accesses[position].push_back(access);
+                }
+            }
+        }
+    }
+
+    void FrameGraph::planBarriers()
+    {
+        std::vector<std::vector<FrameGraphAccess>> accesses;
+        gatherAccesses(accesses);
 
-        // create graph resource
+        const std::vector<FrameGraphQueueType>* queues = schedule.queues.size() == nodes.size() ? &schedule.queues : nullptr;
+        plan_frame_graph_barriers(accesses, queues, &memory_plan, static_cast<uint32_t>(builder.resource_cache.resources.size()), split_barriers, barrier_plan);
     }
 
     void FrameGraph::printResult()
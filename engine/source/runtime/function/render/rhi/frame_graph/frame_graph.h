@@ -1,4 +1,7 @@
 #pragma once
+#include "runtime/function/render/rhi/frame_graph/frame_graph_barrier.h"
+#include "runtime/function/render/rhi/frame_graph/frame_graph_memory.h"
+#include "runtime/function/render/rhi/frame_graph/frame_graph_schedule.h"
 #include "runtime/function/render/rhi/frame_graph/frame_resource.h"
 
 namespace ArchViz
@@ -25,10 +28,14 @@ namespace ArchViz
         std::vector<FrameGraphResourceHandle> inputs;
         std::vector<FrameGraphResourceHandle> outputs;
 
+        // how each input is read, from the input type or the resource type when it has none
+        std::vector<FrameGraphResourceType> input_types;
+
         // std::vector<FrameGraphNodeHandle> edges_forward;
         std::vector<FrameGraphNodeHandle> edges_backward;
 
         bool enabled {true};
+        bool compute {false};
 
         std::string name {};
     };
@@ -69,6 +76,8 @@ namespace ArchViz
         FrameGraphResourceHandle createNodeInput(const FrameGraphResourceInputCreation& creation);
         FrameGraphNodeHandle     createNode(const FrameGraphNodeCreation& creation);
 
+        void setResourceInfo(FrameGraphResourceHandle handle, const FrameGraphResourceOutputCreation& creation);
+
         static constexpr uint32_t k_max_render_pass_count = 256;
         static constexpr uint32_t k_max_resources_count   = 1024;
         static constexpr uint32_t k_max_nodes_count       = 1024;
@@ -80,6 +89,28 @@ namespace ArchViz
         FrameGraphNodeCache       node_cache {};
     };
 
+    // everything compile derives from the enabled nodes and the resource descriptions, kept to reuse when the graph comes back
+    struct FrameGraphCompiled
+    {
+        std::vector<FrameGraphNodeHandle> nodes;
+        std::vector<uint32_t>             first_use; // by resource
+        std::vector<uint32_t>             last_use;
+
+        FrameGraphSchedule    schedule;
+        FrameGraphMemoryPlan  memory_plan;
+        FrameGraphBarrierPlan barrier_plan;
+
+        uint32_t last_compile {0}; // the entry used longest ago is dropped first
+    };
+
+    struct FrameGraphCompileStatistics
+    {
+        uint32_t compiles {0};
+        uint32_t cache_hits {0}; // graph seen before, nothing planned again
+        uint32_t partial {0};    // only enabled flags changed, the full order is filtered instead of sorted
+        uint32_t full {0};       // edges rebuilt and every node sorted
+    };
+
     struct FrameGraph
     {
         void init(const FrameGraphCreation& info);
@@ -87,9 +118,26 @@ namespace ArchViz
 
         // NOTE(marco): each frame we rebuild the graph so that we can enable only the nodes we are interested in
         void reset();
+        // cheap when nothing changed since a recent compile, see compiled_cache
         void compile();
 
+        // structure covers every node and resource description, graph adds the enabled flags and the compile options
+        void hashGraph(uint64_t& structure, uint64_t& graph) const;
+        // edges of every node and all of them in topological order, only when the structure changed
+        void sortFullOrder();
+
         void computeEdges(FrameGraphNode* node, uint32_t node_index);
+        // queue of every node, reorders nodes so async compute overlaps with graphics
+        void planSchedule();
+        // first and last position in the sorted nodes of every resource
+        void computeLifetimes();
+        // transient textures and buffers whose lifetimes do not overlap share memory
+        void planMemory();
+        // barriers and layout transitions before each sorted node
+        void planBarriers();
+
+        // how every sorted node touches its inputs and outputs
+        void gatherAccesses(std::vector<std::vector<FrameGraphAccess>>& accesses);
 
         void printResult();
 
@@ -100,6 +148,31 @@ namespace ArchViz
         // NOTE(marco): nodes sorted in topological order
         std::vector<FrameGraphNodeHandle> nodes {};
 
+        // queues and submit batches, indexed like nodes, rebuilt by compile
+        FrameGraphSchedule schedule {};
+
+        // offsets of the transient resources in the shared heaps, rebuilt by compile
+        FrameGraphMemoryPlan memory_plan {};
+
+        // indexed like nodes, rebuilt by compile
+        FrameGraphBarrierPlan barrier_plan {};
+
+        // every node, enabled or not, in topological order, valid while structure_hash matches
+        std::vector<FrameGraphNodeHandle> full_order {};
+        uint64_t                          structure_hash {0};
+
+        // recent compiled graphs by graph hash, compiled_hash is the one the members above hold
+        std::unordered_map<uint64_t, FrameGraphCompiled> compiled_cache {};
+        uint32_t                                         compiled_cache_capacity {8};
+        uint64_t                                         compiled_hash {0};
+
+        FrameGraphCompileStatistics compile_statistics {};
+
+        // dependencies that skip passes wait on events instead of stalling right after the producer
+        bool split_barriers {true};
+        // compute nodes run on the compute queue
+        bool async_compute {true};
+
         std::string name {};
     };
 
@@ -0,0 +1,321 @@
+#include "runtime/function/render/rhi/frame_graph/frame_graph_barrier.h"
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <utility>
+
+namespace ArchViz
+{
+    namespace
+    {
+        // what the passes so far left behind on one resource
+        struct ResourceTrack
+        {
+            bool          touched {false};
+            VkImageLayout layout {VK_IMAGE_LAYOUT_UNDEFINED};
+
+            // the last write or layout transition
+            uint32_t             write_pass {k_invalid_index};
+            VkPipelineStageFlags write_stages {0};
+            VkAccessFlags        write_access {0};
+
+            // stages and accesses the last write is already visible to, and the stages that read since
+            VkPipelineStageFlags visible_stages {0};
+            VkAccessFlags        visible_access {0};
+            VkPipelineStageFlags read_stages {0};
+        };
+
+        bool covers(VkFlags flags, VkFlags other) { return (flags & other) == other; }
+
+        // a pass listing a resource more than once touches it once with everything combined
+        std::vector<FrameGraphAccess> merge_accesses(const std::vector<FrameGraphAccess>& accesses)
+        {
+            std::vector<FrameGraphAccess> merged;
+            for (const auto& access : accesses)
+            {
+                FrameGraphAccess* existing = nullptr;
+                for (auto& other : merged)
+                {
+                    if (other.resource.index == access.resource.index)
+                    {
+                        existing = &other;
+                        break;
+                    }
+                }
+
+                if (existing == nullptr)
+                {
+                    merged.push_back(access);
+                    continue;
+                }
+
+                if (existing->state.layout != access.state.layout)
+                {
+                    existing->state.layout = VK_IMAGE_LAYOUT_GENERAL;
+                }
+                existing->state.stages |= access.state.stages;
+                existing->state.access |= access.state.access;
+                existing->aspect |= access.aspect;
+                existing->write = existing->write || access.write;
+            }
+            return merged;
+        }
+    } // namespace
+
+    bool frame_graph_format_is_depth(VkFormat format)
+    {
+        switch (format)
+        {
+            case VK_FORMAT_D16_UNORM:
+            case VK_FORMAT_X8_D24_UNORM_PACK32:
+            case VK_FORMAT_D32_SFLOAT:
+            case VK_FORMAT_S8_UINT:
+            case VK_FORMAT_D16_UNORM_S8_UINT:
+            case VK_FORMAT_D24_UNORM_S8_UINT:
+            case VK_FORMAT_D32_SFLOAT_S8_UINT:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    bool frame_graph_format_has_stencil(VkFormat format)
+    {
+        return format == VK_FORMAT_S8_UINT || format == VK_FORMAT_D16_UNORM_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT || format == VK_FORMAT_D32_SFLOAT_S8_UINT;
+    }
+
+    void plan_frame_graph_barriers(const std::vector<std::vector<FrameGraphAccess>>& passes,
+                                   const std::vector<FrameGraphQueueType>*           queues,
+                                   const FrameGraphMemoryPlan*                       memory,
+                                   uint32_t                                          resource_count,
+                                   bool                                              split,
+                                   FrameGraphBarrierPlan&                            plan)
+    {
+        plan = {};
+        plan.passes.resize(passes.size());
+
+        std::vector<ResourceTrack> tracks(resource_count);
+
+        // resources that had the same bytes before, their last use has to finish before the first use of the new one
+        std::vector<std::vector<uint32_t>> aliased(resource_count);
+        if (memory != nullptr)
+        {
+            // in first use order, the last owner of every byte range so far; an earlier owner of the same bytes already
+            // had the later one wait for it, waiting on the last owners is enough
+            const auto&           allocations = memory->allocations;
+            std::vector<uint32_t> by_first_use(allocations.size());
+            for (uint32_t i = 0; i < allocations.size(); ++i)
+            {
+                by_first_use[i] = i;
+            }
+            std::stable_sort(by_first_use.begin(), by_first_use.end(), [&](uint32_t a, uint32_t b) { return allocations[a].first_use < allocations[b].first_use; });
+
+            std::map<std::pair<uint32_t, uint64_t>, std::pair<uint64_t, uint32_t>> owners; // (heap, begin) -> (end, allocation)
+            for (uint32_t index : by_first_use)
+            {
+                const FrameGraphAllocation& allocation = allocations[index];
+                const uint64_t              begin      = allocation.offset;
+                const uint64_t              end        = allocation.offset + allocation.size;
+                if (allocation.size == 0)
+                {
+                    continue;
+                }
+
+                auto range = owners.upper_bound({allocation.heap, begin});
+                if (range != owners.begin() && std::prev(range)->first.first == allocation.heap && std::prev(range)->second.first > begin)
+                {
+                    --range;
+                }
+
+                while (range != owners.end() && range->first.first == allocation.heap && range->first.second < end)
+                {
+                    const uint64_t range_begin = range->first.second;
+                    const uint64_t range_end   = range->second.first;
+                    const uint32_t owner       = range->second.second;
+
+                    const FrameGraphAllocation& previous = allocations[owner];
+                    if (previous.last_use < allocation.first_use && allocation.resource.index < resource_count)
+                    {
+                        auto& list = aliased[allocation.resource.index];
+                        if (std::find(list.begin(), list.end(), previous.resource.index) == list.end())
+                        {
+                            list.push_back(previous.resource.index);
+                        }
+                    }
+
+                    range = owners.erase(range);
+                    if (range_begin < begin)
+                    {
+                        owners[{allocation.heap, range_begin}] = {begin, owner};
+                    }
+                    if (range_end > end)
+                    {
+                        range = owners.insert(range, {{allocation.heap, end}, {range_end, owner}});
+                    }
+                }
+                owners[{allocation.heap, begin}] = {end, index};
+            }
+        }
+
+        // split barriers with the same signal and wait pass share one event
+        std::map<std::pair<uint32_t, uint32_t>, uint32_t> event_of_passes;
+
+        for (uint32_t pass = 0; pass < passes.size(); ++pass)
+        {
+            FrameGraphPassBarriers& pass_barriers = plan.passes[pass];
+
+            for (const auto& access : merge_accesses(passes[pass]))
+            {
+                if (access.resource.index >= resource_count)
+                {
+                    continue;
+                }
+                plan.statistics.accesses += 1;
+
+                ResourceTrack&                 track = tracks[access.resource.index];
+                const FrameGraphResourceState& dst   = access.state;
+
+                const bool layout_change = access.image && track.layout != dst.layout;
+
+                bool                    needed     = false;
+                bool                    from_write = false;
+                FrameGraphResourceState src {};
+                src.layout = track.layout;
+
+                if (!track.touched)
+                {
+                    for (uint32_t other : aliased[access.resource.index])
+                    {
+                        src.stages |= tracks[other].write_stages | tracks[other].read_stages;
+                        src.access |= tracks[other].write_access;
+                    }
+                    // aliased memory holds nothing this resource can read, it always starts undefined
+                    src.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+                    needed     = (access.image && dst.layout != VK_IMAGE_LAYOUT_UNDEFINED) || src.stages != 0;
+                }
+                else if (access.write)
+                {
+                    // write after read only waits for the readers, the write before them is already available
+                    if (track.read_stages != 0)
+                    {
+                        src.stages = track.read_stages;
+                    }
+                    else
+                    {
+                        src.stages = track.write_stages;
+                        src.access = track.write_access;
+                        from_write = true;
+                    }
+                    needed = true;
+                }
+                else
+                {
+                    const bool visible = track.write_pass == k_invalid_index || (covers(track.visible_stages, dst.stages) && covers(track.visible_access, dst.access));
+                    if (layout_change || !visible)
+                    {
+                        src.stages = track.write_stages | (layout_change ? track.read_stages : 0);
+                        src.access = track.write_access;
+                        from_write = track.read_stages == 0;
+                        needed     = true;
+                    }
+                }
+
+                // the semaphore between the queues already made the other queue's writes visible, only a layout change is left
+                const bool same_queue = queues == nullptr || track.write_pass == k_invalid_index || (*queues)[track.write_pass] == (*queues)[pass];
+                if (needed && !same_queue)
+                {
+                    src.stages = dst.stages;
+                    src.access = 0;
+                    from_write = false;
+                }
+
+                if (needed)
+                {
+                    if (src.stages == 0)
+                    {
+                        src.stages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+                    }
+
+                    FrameGraphBarrier barrier;
+                    barrier.resource = access.resource;
+                    barrier.src      = src;
+                    barrier.dst      = dst;
+                    barrier.image    = access.image;
+                    barrier.aspect   = access.aspect;
+                    if (!access.image)
+                    {
+                        barrier.src.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+                        barrier.dst.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+                    }
+
+                    plan.statistics.barriers += 1;
+                    plan.statistics.transitions += barrier.image && barrier.src.layout != barrier.dst.layout ? 1 : 0;
+
+                    // the producer ran at least one pass earlier, signal right after it and wait only here
+                    if (split && from_write && track.write_pass != k_invalid_index && track.write_pass + 1 < pass)
+                    {
+                        auto key  = std::make_pair(track.write_pass, pass);
+                        auto iter = event_of_passes.find(key);
+                        if (iter == event_of_passes.end())
+                        {
+                            iter = event_of_passes.emplace(key, static_cast<uint32_t>(plan.events.size())).first;
+
+                            FrameGraphEvent event;
+                            event.signal = track.write_pass;
+                            event.wait   = pass;
+                            plan.events.push_back(event);
+
+                            plan.passes[track.write_pass].signal_events.push_back(iter->second);
+                            pass_barriers.wait_events.push_back(iter->second);
+                        }
+
+                        FrameGraphEvent& event = plan.events[iter->second];
+                        event.src_stages |= barrier.src.stages;
+                        event.dst_stages |= barrier.dst.stages;
+                        event.barriers.push_back(barrier);
+
+                        plan.statistics.split += 1;
+                    }
+                    else
+                    {
+                        pass_barriers.src_stages |= barrier.src.stages;
+                        pass_barriers.dst_stages |= barrier.dst.stages;
+                        pass_barriers.barriers.push_back(barrier);
+                    }
+                }
+                else
+                {
+                    plan.statistics.skipped += 1;
+                }
+
+                // a layout transition counts as a write, later readers in other stages still need to see it
+                if (access.write || (needed && layout_change))
+                {
+                    track.write_pass     = pass;
+                    track.write_stages   = dst.stages;
+                    track.write_access   = access.write ? dst.access : 0;
+                    track.visible_stages = access.write ? 0 : dst.stages;
+                    track.visible_access = access.write ? 0 : dst.access;
+                    track.read_stages    = access.write ? 0 : dst.stages;
+                }
+                else
+                {
+                    if (needed)
+                    {
+                        track.visible_stages |= dst.stages;
+                        track.visible_access |= dst.access;
+                    }
+                    track.read_stages |= dst.stages;
+                }
+                track.touched = true;
+                track.layout  = access.image ? dst.layout : VK_IMAGE_LAYOUT_UNDEFINED;
+            }
+
+            if (!pass_barriers.barriers.empty())
+            {
+                plan.statistics.pipeline_barriers += 1;
+            }
+        }
+    }
+} // namespace ArchViz
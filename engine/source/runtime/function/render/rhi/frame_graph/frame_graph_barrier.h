@@ -0,0 +1,95 @@
+#pragma once
+#include "runtime/function/render/rhi/frame_graph/frame_graph_memory.h"
+#include "runtime/function/render/rhi/frame_graph/frame_graph_schedule.h"
+#include "runtime/function/render/rhi/frame_graph/frame_resource.h"
+
+#include <volk.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace ArchViz
+{
+    // how one pass touches a resource
+    struct FrameGraphResourceState
+    {
+        VkPipelineStageFlags stages {0};
+        VkAccessFlags        access {0};
+        VkImageLayout        layout {VK_IMAGE_LAYOUT_UNDEFINED};
+    };
+
+    struct FrameGraphAccess
+    {
+        FrameGraphResourceHandle resource;
+        FrameGraphResourceState  state;
+
+        bool               image {false};
+        bool               write {false};
+        VkImageAspectFlags aspect {0};
+    };
+
+    struct FrameGraphBarrier
+    {
+        FrameGraphResourceHandle resource;
+        FrameGraphResourceState  src;
+        FrameGraphResourceState  dst;
+
+        bool               image {false};
+        VkImageAspectFlags aspect {0};
+    };
+
+    // split barrier: set after pass `signal`, waited on before pass `wait`, the passes in between run without a stall
+    struct FrameGraphEvent
+    {
+        uint32_t signal {k_invalid_index};
+        uint32_t wait {k_invalid_index};
+
+        VkPipelineStageFlags src_stages {0};
+        VkPipelineStageFlags dst_stages {0};
+
+        std::vector<FrameGraphBarrier> barriers;
+    };
+
+    struct FrameGraphPassBarriers
+    {
+        // one vkCmdPipelineBarrier before the pass, the stage masks are merged over every barrier
+        VkPipelineStageFlags           src_stages {0};
+        VkPipelineStageFlags           dst_stages {0};
+        std::vector<FrameGraphBarrier> barriers;
+
+        std::vector<uint32_t> wait_events;   // indices into FrameGraphBarrierPlan::events, waited before the pass
+        std::vector<uint32_t> signal_events; // set after the pass
+    };
+
+    struct FrameGraphBarrierStatistics
+    {
+        uint32_t accesses {0};
+        uint32_t barriers {0};    // image and buffer barriers emitted, split ones included
+        uint32_t transitions {0}; // barriers that change the image layout
+        uint32_t skipped {0};     // accesses the previous barriers already cover
+        uint32_t split {0};       // barriers moved to an event
+        uint32_t pipeline_barriers {0};
+    };
+
+    struct FrameGraphBarrierPlan
+    {
+        std::vector<FrameGraphPassBarriers> passes; // one per sorted node
+        std::vector<FrameGraphEvent>        events;
+
+        FrameGraphBarrierStatistics statistics;
+    };
+
+    bool frame_graph_format_is_depth(VkFormat format);
+    bool frame_graph_format_has_stencil(VkFormat format);
+
+    // one entry per pass in execution order. A resource first used after another one left its bytes in memory
+    // waits for the last use of that one, memory may be null when nothing is aliased.
+    // Dependencies that skip at least one pass become split barriers when split is set. A producer on the other
+    // queue is covered by the schedule's semaphore, only its layout change is left, queues may be null for one queue.
+    void plan_frame_graph_barriers(const std::vector<std::vector<FrameGraphAccess>>& passes,
+                                   const std::vector<FrameGraphQueueType>*           queues,
+                                   const FrameGraphMemoryPlan*                       memory,
+                                   uint32_t                                          resource_count,
+                                   bool                                              split,
+                                   FrameGraphBarrierPlan&                            plan);
+} // namespace ArchViz
@@ -0,0 +1,234 @@
+#include "runtime/function/render/rhi/frame_graph/frame_graph_memory.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace ArchViz
+{
+    namespace
+    {
+        // images are placed at 64k on most desktop drivers, buffers need at most 256 for uniform offsets
+        constexpr uint64_t k_texture_alignment = 64 * 1024;
+        constexpr uint64_t k_buffer_alignment  = 256;
+
+        // allocations alive longer than this are checked one by one instead of being listed at every position
+        constexpr uint32_t k_long_lifetime = 32;
+
+        struct PlacedAllocations
+        {
+            std::vector<std::vector<uint32_t>> alive; // by position
+            std::vector<uint32_t>              long_lived;
+        };
+
+        uint64_t align_up(uint64_t value, uint64_t alignment) { return (value + alignment - 1) / alignment * alignment; }
+    } // namespace
+
+    const FrameGraphAllocation* FrameGraphMemoryPlan::find(FrameGraphResourceHandle resource) const
+    {
+        for (const auto& allocation : allocations)
+        {
+            if (allocation.resource.index == resource.index)
+            {
+                return &allocation;
+            }
+        }
+        return nullptr;
+    }
+
+    uint32_t frame_graph_format_size(VkFormat format)
+    {
+        switch (format)
+        {
+            case VK_FORMAT_R8_UNORM:
+            case VK_FORMAT_R8_UINT:
+            case VK_FORMAT_S8_UINT:
+                return 1;
+            case VK_FORMAT_R8G8_UNORM:
+            case VK_FORMAT_R16_SFLOAT:
+            case VK_FORMAT_R16_UNORM:
+            case VK_FORMAT_D16_UNORM:
+                return 2;
+            case VK_FORMAT_R8G8B8A8_UNORM:
+            case VK_FORMAT_R8G8B8A8_SRGB:
+            case VK_FORMAT_B8G8R8A8_UNORM:
+            case VK_FORMAT_B8G8R8A8_SRGB:
+            case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+            case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
+            case VK_FORMAT_R16G16_SFLOAT:
+            case VK_FORMAT_R32_SFLOAT:
+            case VK_FORMAT_R32_UINT:
+            case VK_FORMAT_D32_SFLOAT:
+            case VK_FORMAT_D24_UNORM_S8_UINT:
+            case VK_FORMAT_X8_D24_UNORM_PACK32:
+                return 4;
+            case VK_FORMAT_D32_SFLOAT_S8_UINT:
+            case VK_FORMAT_R16G16B16A16_SFLOAT:
+            case VK_FORMAT_R32G32_SFLOAT:
+                return 8;
+            case VK_FORMAT_R32G32B32A32_SFLOAT:
+                return 16;
+            default:
+                return 4;
+        }
+    }
+
+    uint64_t frame_graph_texture_size(const FrameGraphTexture& texture)
+    {
+        const uint64_t texels = static_cast<uint64_t>(texture.width) * texture.height * std::max(texture.depth, 1u);
+        return align_up(texels * frame_graph_format_size(texture.format), k_texture_alignment);
+    }
+
+    uint64_t frame_graph_texture_alignment() { return k_texture_alignment; }
+
+    uint64_t frame_graph_buffer_alignment() { return k_buffer_alignment; }
+
+    void plan_frame_graph_memory(const std::vector<FrameGraphMemoryRequest>& requests, FrameGraphMemoryPlan& plan)
+    {
+        plan = {};
+        plan.allocations.resize(requests.size());
+
+        // largest first, ties in graph order so the plan is stable between compiles, the ones that do not alias at the end
+        std::vector<uint32_t> order(requests.size());
+        for (uint32_t i = 0; i < order.size(); ++i)
+        {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            const auto& left  = requests[a];
+            const auto& right = requests[b];
+            if (left.aliasable != right.aliasable)
+            {
+                return left.aliasable;
+            }
+            if (left.size != right.size)
+            {
+                return left.size > right.size;
+            }
+            if (left.first_use != right.first_use)
+            {
+                return left.first_use < right.first_use;
+            }
+            return a < b;
+        });
+
+        uint32_t positions = 0;
+        for (const auto& request : requests)
+        {
+            positions = std::max(positions, request.last_use + 1);
+        }
+
+        // placed allocations by heap and by every position they are alive at, a request only meets the ones alive while it is
+        uint32_t                       heap_of_type[static_cast<uint32_t>(FrameGraphHeapType::Count)];
+        std::vector<PlacedAllocations> placed;
+        std::fill(std::begin(heap_of_type), std::end(heap_of_type), k_invalid_index);
+
+        std::vector<uint32_t>                      seen(requests.size(), k_invalid_index);
+        std::vector<std::pair<uint64_t, uint64_t>> busy;
+        for (uint32_t index : order)
+        {
+            const FrameGraphMemoryRequest& request = requests[index];
+
+            uint32_t& heap = heap_of_type[static_cast<uint32_t>(request.heap_type)];
+            if (heap == k_invalid_index)
+            {
+                heap = static_cast<uint32_t>(plan.heaps.size());
+                plan.heaps.push_back({request.heap_type, 0, 0});
+                placed.push_back({std::vector<std::vector<uint32_t>>(positions), {}});
+            }
+
+            // the ranges taken by resources alive at the same time, the new one goes to the tightest gap between them
+            busy.clear();
+            if (!request.aliasable)
+            {
+                // after everything that aliases, nothing placed later shares its bytes
+                busy.push_back({0, plan.heaps[heap].size});
+            }
+            else
+            {
+                for (uint32_t other : placed[heap].long_lived)
+                {
+                    const FrameGraphAllocation& allocation = plan.allocations[other];
+                    if (allocation.first_use <= request.last_use && request.first_use <= allocation.last_use)
+                    {
+                        busy.push_back({allocation.offset, allocation.offset + allocation.size});
+                    }
+                }
+                for (uint32_t position = request.first_use; position <= request.last_use; ++position)
+                {
+                    for (uint32_t other : placed[heap].alive[position])
+                    {
+                        if (seen[other] != index)
+                        {
+                            const FrameGraphAllocation& allocation = plan.allocations[other];
+                            busy.push_back({allocation.offset, allocation.offset + allocation.size});
+                            seen[other] = index;
+                        }
+                    }
+                }
+            }
+            std::sort(busy.begin(), busy.end());
+
+            const uint64_t alignment = std::max<uint64_t>(request.alignment, 1);
+
+            uint64_t offset   = std::numeric_limits<uint64_t>::max();
+            uint64_t best_gap = std::numeric_limits<uint64_t>::max();
+            uint64_t cursor   = 0;
+            for (const auto& [begin, end] : busy)
+            {
+                const uint64_t candidate = align_up(cursor, alignment);
+                if (candidate + request.size <= begin && begin - cursor < best_gap)
+                {
+                    offset   = candidate;
+                    best_gap = begin - cursor;
+                }
+                cursor = std::max(cursor, end);
+            }
+            if (offset == std::numeric_limits<uint64_t>::max())
+            {
+                offset = align_up(cursor, alignment);
+            }
+
+            FrameGraphAllocation& allocation = plan.allocations[index];
+            allocation.resource              = request.resource;
+            allocation.heap                  = heap;
+            allocation.offset                = offset;
+            allocation.size                  = request.size;
+            allocation.first_use             = request.first_use;
+            allocation.last_use              = request.last_use;
+            if (request.last_use - request.first_use > k_long_lifetime)
+            {
+                placed[heap].long_lived.push_back(index);
+            }
+            else
+            {
+                for (uint32_t position = request.first_use; position <= request.last_use; ++position)
+                {
+                    placed[heap].alive[position].push_back(index);
+                }
+            }
+
+            plan.heaps[heap].size = std::max(plan.heaps[heap].size, offset + request.size);
+            plan.heaps[heap].resource_count += 1;
+            plan.unaliased_size += request.size;
+        }
+
+        for (const auto& heap : plan.heaps)
+        {
+            plan.aliased_size += heap.size;
+        }
+
+        // live bytes per node, the lower bound for any packing
+        std::vector<int64_t> delta(positions + 1, 0);
+        for (const auto& request : requests)
+        {
+            delta[request.first_use] += static_cast<int64_t>(request.size);
+            delta[request.last_use + 1] -= static_cast<int64_t>(request.size);
+        }
+        int64_t live = 0;
+        for (uint32_t i = 0; i < positions; ++i)
+        {
+            live += delta[i];
+            plan.peak_live_size = std::max(plan.peak_live_size, static_cast<uint64_t>(live));
+        }
+    }
+} // namespace ArchViz
@@ -0,0 +1,73 @@
+#pragma once
+#include "runtime/function/render/rhi/frame_graph/frame_resource.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace ArchViz
+{
+    // textures and buffers go to separate heaps, not every device can alias optimal images with buffers
+    enum class FrameGraphHeapType : uint32_t
+    {
+        Texture = 0,
+        Buffer  = 1,
+        Count   = 2
+    };
+
+    // one transient resource to place, first_use and last_use are positions in the sorted node list
+    struct FrameGraphMemoryRequest
+    {
+        FrameGraphResourceHandle resource;
+        FrameGraphHeapType       heap_type {FrameGraphHeapType::Texture};
+
+        uint64_t size {0};
+        uint64_t alignment {1};
+
+        uint32_t first_use {0};
+        uint32_t last_use {0};
+
+        bool aliasable {true}; // false keeps bytes of its own, placed after everything that aliases
+    };
+
+    struct FrameGraphAllocation
+    {
+        FrameGraphResourceHandle resource;
+
+        uint32_t heap {k_invalid_index};
+        uint64_t offset {0};
+        uint64_t size {0};
+
+        uint32_t first_use {0};
+        uint32_t last_use {0};
+    };
+
+    struct FrameGraphHeap
+    {
+        FrameGraphHeapType type {FrameGraphHeapType::Texture};
+        uint64_t           size {0};
+        uint32_t           resource_count {0};
+    };
+
+    struct FrameGraphMemoryPlan
+    {
+        std::vector<FrameGraphAllocation> allocations; // in request order
+        std::vector<FrameGraphHeap>       heaps;       // one per heap type in use
+
+        uint64_t unaliased_size {0}; // every transient in its own memory
+        uint64_t aliased_size {0};   // sum of the heap sizes
+        uint64_t peak_live_size {0}; // most bytes alive at one node, no packing gets below it
+
+        const FrameGraphAllocation* find(FrameGraphResourceHandle resource) const;
+    };
+
+    // bytes and alignment of a transient, a conservative guess of what the device reports
+    uint64_t frame_graph_texture_size(const FrameGraphTexture& texture);
+    uint64_t frame_graph_texture_alignment();
+    uint64_t frame_graph_buffer_alignment();
+
+    uint32_t frame_graph_format_size(VkFormat format);
+
+    // packs the requests into one heap per type, resources whose lifetimes overlap never share bytes.
+    // Greedy by size: largest first, each goes to the best fitting gap left by the resources placed so far that are alive at the same time.
+    void plan_frame_graph_memory(const std::vector<FrameGraphMemoryRequest>& requests, FrameGraphMemoryPlan& plan);
+} // namespace ArchViz
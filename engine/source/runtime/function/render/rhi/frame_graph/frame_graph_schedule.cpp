@@ -0,0 +1,282 @@
+#include "runtime/function/render/rhi/frame_graph/frame_graph_schedule.h"
+
+#include <algorithm>
+#include <map>
+#include <utility>
+
+namespace ArchViz
+{
+    namespace
+    {
+        constexpr uint32_t k_queue_count = static_cast<uint32_t>(FrameGraphQueueType::Count);
+
+        struct Batch
+        {
+            FrameGraphQueueType   queue {FrameGraphQueueType::Graphics};
+            std::vector<uint32_t> passes;
+        };
+    } // namespace
+
+    void plan_frame_graph_schedule(const std::vector<FrameGraphSchedulePass>& passes, bool async_compute, FrameGraphSchedule& schedule)
+    {
+        schedule = {};
+
+        const uint32_t count = static_cast<uint32_t>(passes.size());
+        if (count == 0)
+        {
+            return;
+        }
+
+        std::vector<FrameGraphQueueType>   queue_of(count);
+        std::vector<std::vector<uint32_t>> dependencies(count);
+        std::vector<std::vector<uint32_t>> successors(count);
+        for (uint32_t pass = 0; pass < count; ++pass)
+        {
+            queue_of[pass] = async_compute && passes[pass].async ? FrameGraphQueueType::Compute : FrameGraphQueueType::Graphics;
+
+            for (uint32_t dependency : passes[pass].dependencies)
+            {
+                // only earlier passes, the order given is topological
+                if (dependency < pass && std::find(dependencies[pass].begin(), dependencies[pass].end(), dependency) == dependencies[pass].end())
+                {
+                    dependencies[pass].push_back(dependency);
+                    successors[dependency].push_back(pass);
+                }
+            }
+        }
+
+        // longest path from each pass to the end of the frame
+        std::vector<float> tail(count, 0.0f);
+        for (uint32_t pass = count; pass-- > 0;)
+        {
+            float longest = 0.0f;
+            for (uint32_t successor : successors[pass])
+            {
+                longest = std::max(longest, tail[successor]);
+            }
+            tail[pass] = passes[pass].cost + longest;
+
+            schedule.serial_length += passes[pass].cost;
+            schedule.critical_path = std::max(schedule.critical_path, tail[pass]);
+        }
+
+        // list scheduling on the two queues, graphics passes keep their order, ready compute passes go as soon as a queue is free
+        std::vector<uint32_t> remaining(count);
+        std::vector<uint32_t> ready_compute;
+        for (uint32_t pass = 0; pass < count; ++pass)
+        {
+            remaining[pass] = static_cast<uint32_t>(dependencies[pass].size());
+            if (remaining[pass] == 0 && queue_of[pass] == FrameGraphQueueType::Compute)
+            {
+                ready_compute.push_back(pass);
+            }
+        }
+
+        std::vector<float>    start_of(count, 0.0f);
+        std::vector<float>    finish_of(count, 0.0f);
+        std::vector<uint32_t> queue_index(count, 0);
+        std::vector<uint32_t> queue_passes[k_queue_count];
+        float                 queue_free[k_queue_count] = {};
+
+        auto earliest = [&](uint32_t pass) {
+            float time = queue_free[static_cast<uint32_t>(queue_of[pass])];
+            for (uint32_t dependency : dependencies[pass])
+            {
+                time = std::max(time, finish_of[dependency]);
+            }
+            return time;
+        };
+
+        uint32_t next_graphics = 0;
+        for (uint32_t scheduled = 0; scheduled < count; ++scheduled)
+        {
+            while (next_graphics < count && queue_of[next_graphics] != FrameGraphQueueType::Graphics)
+            {
+                ++next_graphics;
+            }
+
+            uint32_t graphics = next_graphics < count && remaining[next_graphics] == 0 ? next_graphics : k_invalid_index;
+            auto     compute  = std::min_element(ready_compute.begin(), ready_compute.end(), [&](uint32_t a, uint32_t b) { return tail[a] != tail[b] ? tail[a] > tail[b] : a < b; });
+
+            // the earliest pass of a topological order is always ready, one of the two exists
+            uint32_t pass = graphics;
+            if (compute != ready_compute.end() && (graphics == k_invalid_index || earliest(*compute) <= earliest(graphics)))
+            {
+                pass = *compute;
+                ready_compute.erase(compute);
+            }
+            else
+            {
+                ++next_graphics;
+            }
+
+            const uint32_t queue = static_cast<uint32_t>(queue_of[pass]);
+
+            start_of[pass]    = earliest(pass);
+            finish_of[pass]   = start_of[pass] + passes[pass].cost;
+            queue_free[queue] = finish_of[pass];
+            queue_index[pass] = static_cast<uint32_t>(queue_passes[queue].size());
+            queue_passes[queue].push_back(pass);
+
+            for (uint32_t successor : successors[pass])
+            {
+                remaining[successor] -= 1;
+                if (remaining[successor] == 0 && queue_of[successor] == FrameGraphQueueType::Compute)
+                {
+                    ready_compute.push_back(successor);
+                }
+            }
+
+            schedule.scheduled_length = std::max(schedule.scheduled_length, finish_of[pass]);
+        }
+
+        // cross queue edges, a queue that already waited for a later pass of the other queue needs no new wait
+        std::vector<std::pair<uint32_t, uint32_t>> edges;
+        std::vector<bool>                          starts_batch(count, false);
+        std::vector<bool>                          ends_batch(count, false);
+        for (uint32_t queue = 0; queue < k_queue_count; ++queue)
+        {
+            uint32_t waited[k_queue_count];
+            std::fill(std::begin(waited), std::end(waited), k_invalid_index);
+
+            for (uint32_t pass : queue_passes[queue])
+            {
+                for (uint32_t other = 0; other < k_queue_count; ++other)
+                {
+                    if (other == queue)
+                    {
+                        continue;
+                    }
+
+                    uint32_t latest = k_invalid_index;
+                    for (uint32_t dependency : dependencies[pass])
+                    {
+                        if (static_cast<uint32_t>(queue_of[dependency]) == other)
+                        {
+                            schedule.cross_queue_dependencies += 1;
+                            latest = latest == k_invalid_index ? queue_index[dependency] : std::max(latest, queue_index[dependency]);
+                        }
+                    }
+
+                    if (latest != k_invalid_index && (waited[other] == k_invalid_index || latest > waited[other]))
+                    {
+                        const uint32_t signal = queue_passes[other][latest];
+                        edges.push_back({signal, pass});
+                        ends_batch[signal] = true;
+                        starts_batch[pass] = true;
+                        waited[other]      = latest;
+                    }
+                }
+            }
+        }
+
+        // a queue's passes split into batches only where a semaphore is waited or signaled
+        std::vector<Batch>    batches;
+        std::vector<uint32_t> batch_of(count, k_invalid_index);
+        for (uint32_t queue = 0; queue < k_queue_count; ++queue)
+        {
+            bool open = false;
+            for (uint32_t pass : queue_passes[queue])
+            {
+                if (!open || starts_batch[pass])
+                {
+                    batches.push_back({static_cast<FrameGraphQueueType>(queue), {}});
+                    open = true;
+                }
+                batch_of[pass] = static_cast<uint32_t>(batches.size() - 1);
+                batches.back().passes.push_back(pass);
+                open = !ends_batch[pass];
+            }
+        }
+
+        // edges between the same two batches share a semaphore
+        std::map<std::pair<uint32_t, uint32_t>, uint32_t> semaphore_of_batches;
+        for (const auto& [signal, wait] : edges)
+        {
+            auto key  = std::make_pair(batch_of[signal], batch_of[wait]);
+            auto iter = semaphore_of_batches.find(key);
+            if (iter == semaphore_of_batches.end())
+            {
+                iter = semaphore_of_batches.emplace(key, static_cast<uint32_t>(schedule.semaphores.size())).first;
+                schedule.semaphores.push_back({key.first, key.second, 0});
+            }
+            schedule.semaphores[iter->second].wait_stages |= passes[wait].wait_stages;
+        }
+
+        // submission order: every batch after the one before it on its queue and after the batches it waits on, earliest start first
+        const uint32_t        batch_count = static_cast<uint32_t>(batches.size());
+        std::vector<uint32_t> blockers(batch_count, 0);
+        for (uint32_t batch = 0; batch < batch_count; ++batch)
+        {
+            blockers[batch] += batch > 0 && batches[batch - 1].queue == batches[batch].queue ? 1 : 0;
+        }
+        for (const auto& semaphore : schedule.semaphores)
+        {
+            blockers[semaphore.wait_batch] += 1;
+        }
+
+        std::vector<uint32_t> submit_index(batch_count, k_invalid_index);
+        std::vector<uint32_t> submitted;
+        for (uint32_t step = 0; step < batch_count; ++step)
+        {
+            uint32_t best = k_invalid_index;
+            for (uint32_t batch = 0; batch < batch_count; ++batch)
+            {
+                if (submit_index[batch] != k_invalid_index || blockers[batch] != 0)
+                {
+                    continue;
+                }
+
+                const float start      = start_of[batches[batch].passes.front()];
+                const float best_start = best == k_invalid_index ? 0.0f : start_of[batches[best].passes.front()];
+                if (best == k_invalid_index || start < best_start || (start == best_start && batches[batch].queue > batches[best].queue))
+                {
+                    best = batch;
+                }
+            }
+
+            submit_index[best] = step;
+            submitted.push_back(best);
+
+            if (best + 1 < batch_count && batches[best + 1].queue == batches[best].queue)
+            {
+                blockers[best + 1] -= 1;
+            }
+            for (const auto& semaphore : schedule.semaphores)
+            {
+                blockers[semaphore.wait_batch] -= semaphore.signal_batch == best ? 1 : 0;
+            }
+        }
+
+        for (uint32_t batch : submitted)
+        {
+            FrameGraphSubmitBatch submit;
+            submit.queue = batches[batch].queue;
+            submit.first = static_cast<uint32_t>(schedule.order.size());
+            submit.count = static_cast<uint32_t>(batches[batch].passes.size());
+
+            for (uint32_t pass : batches[batch].passes)
+            {
+                schedule.order.push_back(pass);
+                schedule.queues.push_back(queue_of[pass]);
+                schedule.start.push_back(start_of[pass]);
+                schedule.finish.push_back(finish_of[pass]);
+            }
+            schedule.batches.push_back(submit);
+        }
+
+        for (uint32_t index = 0; index < schedule.semaphores.size(); ++index)
+        {
+            FrameGraphSemaphore& semaphore = schedule.semaphores[index];
+            semaphore.signal_batch         = submit_index[semaphore.signal_batch];
+            semaphore.wait_batch           = submit_index[semaphore.wait_batch];
+            if (semaphore.wait_stages == 0)
+            {
+                semaphore.wait_stages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+            }
+
+            schedule.batches[semaphore.signal_batch].signal_semaphores.push_back(index);
+            schedule.batches[semaphore.wait_batch].wait_semaphores.push_back(index);
+        }
+    }
+} // namespace ArchViz
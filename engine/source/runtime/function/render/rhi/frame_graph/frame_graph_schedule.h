@@ -0,0 +1,67 @@
+#pragma once
+#include "runtime/resource/resource_manager/resource_handle.h"
+
+#include <volk.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace ArchViz
+{
+    enum class FrameGraphQueueType : uint32_t
+    {
+        Graphics = 0,
+        Compute  = 1,
+        Count    = 2
+    };
+
+    // one pass to schedule, passes are given in a topological order
+    struct FrameGraphSchedulePass
+    {
+        std::vector<uint32_t> dependencies;    // earlier passes it reads from
+        VkPipelineStageFlags  wait_stages {0}; // where it first needs their results
+
+        float cost {1.0f};
+        bool  async {false}; // may run on the compute queue
+    };
+
+    // binary semaphore signaled at the end of one batch and waited at the start of a batch on the other queue
+    struct FrameGraphSemaphore
+    {
+        uint32_t             signal_batch {k_invalid_index};
+        uint32_t             wait_batch {k_invalid_index};
+        VkPipelineStageFlags wait_stages {0};
+    };
+
+    // passes [first, first + count) of the scheduled order, recorded into one command buffer and submitted together
+    struct FrameGraphSubmitBatch
+    {
+        FrameGraphQueueType queue {FrameGraphQueueType::Graphics};
+        uint32_t            first {0};
+        uint32_t            count {0};
+
+        std::vector<uint32_t> wait_semaphores;
+        std::vector<uint32_t> signal_semaphores;
+    };
+
+    struct FrameGraphSchedule
+    {
+        std::vector<uint32_t>            order;  // scheduled position -> position in the given passes
+        std::vector<FrameGraphQueueType> queues; // by scheduled position
+        std::vector<float>               start;  // estimated, by scheduled position
+        std::vector<float>               finish;
+
+        std::vector<FrameGraphSubmitBatch> batches; // in submission order, a semaphore is always signaled by an earlier batch
+        std::vector<FrameGraphSemaphore>   semaphores;
+
+        uint32_t cross_queue_dependencies {0}; // before dropping the ones an earlier wait already covers
+
+        float serial_length {0.0f};    // every pass one after another
+        float critical_path {0.0f};    // longest dependency chain, no schedule gets below it
+        float scheduled_length {0.0f}; // estimated end of the last pass with the queues overlapping
+    };
+
+    // async passes go to the compute queue when async_compute is set, everything else keeps its order on the graphics queue.
+    // Compute passes are pulled as early as their inputs allow, the ones with the longest path to the end first.
+    void plan_frame_graph_schedule(const std::vector<FrameGraphSchedulePass>& passes, bool async_compute, FrameGraphSchedule& schedule);
+} // namespace ArchViz
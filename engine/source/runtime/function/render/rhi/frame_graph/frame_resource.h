@@ -75,7 +75,7 @@ namespace ArchViz
 
     struct FrameGraphResource
     {
-        FrameGraphResourceType type;
+        FrameGraphResourceType type {FrameGraphResourceType::Invalid};
         FrameGraphResourceInfo resource_info;
 
         FrameGraphNodeHandle     producer;
@@ -83,6 +83,10 @@ namespace ArchViz
 
         int32_t ref_count {0};
 
+        // positions in the sorted node list, filled by FrameGraph::compile
+        uint32_t first_use {k_invalid_index};
+        uint32_t last_use {k_invalid_index};
+
         std::string name {};
     };
 
@@ -114,6 +118,26 @@ namespace ArchViz
 
         META(Enable)
         std::string type_name {};
+
+        // textures and attachments, format is the VkFormat name
+        META(Enable)
+        std::string format {};
+        META(Enable)
+        uint32_t width {0};
+        META(Enable)
+        uint32_t height {0};
+        META(Enable)
+        uint32_t depth {1};
+        META(Enable)
+        std::string load_op {};
+
+        // buffers, in bytes
+        META(Enable)
+        uint32_t size {0};
+
+        // imported from outside the graph, never aliased
+        META(Enable)
+        bool external {false};
     };
 
     REFLECTION_TYPE(FrameGraphNodeCreation)
@@ -126,6 +150,7 @@ namespace ArchViz
         std::vector<FrameGraphResourceOutputCreation> outputs;
 
         bool enabled {false};
+        bool compute {false}; // dispatches instead of draws, shader reads and writes happen in the compute stage
 
         std::string name {};
     };
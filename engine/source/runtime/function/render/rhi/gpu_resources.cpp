@@ -1,7 +1,29 @@
 #include "runtime/function/render/rhi/gpu_resources.h"
 
+#include "runtime/core/base/hash.h"
+
+#include <algorithm>
+#include <initializer_list>
+
 namespace ArchViz
 {
+    namespace
+    {
+        uint64_t hash_values(std::initializer_list<uint32_t> values, uint64_t seed) { return Hash::hash_bytes(values.begin(), values.size() * sizeof(uint32_t), seed); }
+
+        uint64_t hash_stencil(const StencilOperationState& state, uint64_t seed)
+        {
+            return hash_values({static_cast<uint32_t>(state.fail),
+                                static_cast<uint32_t>(state.pass),
+                                static_cast<uint32_t>(state.depth_fail),
+                                static_cast<uint32_t>(state.compare),
+                                state.compare_mask,
+                                state.write_mask,
+                                state.reference},
+                               seed);
+        }
+    } // namespace
+
     // DepthStencilCreation ////////////////////////////////////
 
     DepthStencilCreation& DepthStencilCreation::setDepth(bool write, VkCompareOp comparison_test)
@@ -335,6 +357,77 @@ namespace ArchViz
 
     RenderPassOutput& PipelineCreation::renderPassOutput() { return render_pass; }
 
+    uint64_t PipelineCreation::hash() const
+    {
+        // only the active part of the fixed arrays is hashed, stale entries behind the counts do not split keys
+        uint64_t hash = hash_values({static_cast<uint32_t>(rasterization.cull_mode), static_cast<uint32_t>(rasterization.front), static_cast<uint32_t>(rasterization.fill)}, 0);
+
+        hash = hash_values({static_cast<uint32_t>(depth_stencil.depth_comparison), depth_stencil.depth_enable, depth_stencil.depth_write_enable, depth_stencil.stencil_enable}, hash);
+        if (depth_stencil.stencil_enable)
+        {
+            hash = hash_stencil(depth_stencil.front, hash);
+            hash = hash_stencil(depth_stencil.back, hash);
+        }
+
+        const uint32_t blend_count = std::min<uint32_t>(blend_state.active_states, k_max_image_outputs);
+        hash                       = hash_values({blend_count}, hash);
+        for (uint32_t i = 0; i < blend_count; ++i)
+        {
+            const BlendState& blend = blend_state.blend_states[i];
+
+            hash = hash_values({static_cast<uint32_t>(blend.source_color),
+                                static_cast<uint32_t>(blend.destination_color),
+                                static_cast<uint32_t>(blend.color_operation),
+                                static_cast<uint32_t>(blend.source_alpha),
+                                static_cast<uint32_t>(blend.destination_alpha),
+                                static_cast<uint32_t>(blend.alpha_operation),
+                                static_cast<uint32_t>(blend.color_write_mask),
+                                blend.blend_enabled,
+                                blend.separate_blend},
+                               hash);
+        }
+
+        const uint32_t stream_count    = std::min<uint32_t>(vertex_input.num_vertex_streams, k_max_vertex_streams);
+        const uint32_t attribute_count = std::min<uint32_t>(vertex_input.num_vertex_attributes, k_max_vertex_attributes);
+        hash                           = hash_values({stream_count, attribute_count}, hash);
+        for (uint32_t i = 0; i < stream_count; ++i)
+        {
+            const VertexStream& stream = vertex_input.vertex_streams[i];
+            hash                       = hash_values({stream.binding, stream.stride, static_cast<uint32_t>(stream.input_rate)}, hash);
+        }
+        for (uint32_t i = 0; i < attribute_count; ++i)
+        {
+            const VertexAttribute& attribute = vertex_input.vertex_attributes[i];
+            hash                             = hash_values({attribute.location, attribute.binding, attribute.offset, static_cast<uint32_t>(attribute.format)}, hash);
+        }
+
+        // the stage code is the key, the same source under another name is the same pipeline
+        const uint32_t stage_count = std::min<uint32_t>(shaders.stages_count, k_max_shader_stages);
+        hash                       = hash_values({stage_count, shaders.spv_input}, hash);
+        for (uint32_t i = 0; i < stage_count; ++i)
+        {
+            const ShaderStage& stage = shaders.stages[i];
+            hash                     = hash_values({static_cast<uint32_t>(stage.type), stage.code_size}, hash);
+            hash                     = Hash::hash_bytes(stage.code.data(), stage.code.size(), hash);
+        }
+
+        const uint32_t color_count = std::min<uint32_t>(render_pass.num_color_formats, k_max_image_outputs);
+        hash                       = hash_values({color_count, static_cast<uint32_t>(render_pass.depth_stencil_format)}, hash);
+        for (uint32_t i = 0; i < color_count; ++i)
+        {
+            hash = hash_values({static_cast<uint32_t>(render_pass.color_formats[i])}, hash);
+        }
+        hash = hash_values({static_cast<uint32_t>(render_pass.color_operation), static_cast<uint32_t>(render_pass.depth_operation), static_cast<uint32_t>(render_pass.stencil_operation)}, hash);
+
+        const uint32_t layout_count = std::min<uint32_t>(num_active_layouts, k_max_descriptor_set_layouts);
+        hash                        = hash_values({layout_count}, hash);
+        for (uint32_t i = 0; i < layout_count; ++i)
+        {
+            hash = hash_values({descriptor_set_layout[i].index}, hash);
+        }
+        return hash;
+    }
+
     // RenderPassCreation //////////////////////////////////////
     RenderPassCreation& RenderPassCreation::reset()
     {
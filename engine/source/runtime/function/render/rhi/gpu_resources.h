@@ -390,6 +390,9 @@ namespace ArchViz
         PipelineCreation& addDescriptorSetLayout(DescriptorSetLayoutHandle handle);
         RenderPassOutput& renderPassOutput();
 
+        // key of the compiled pipeline, names and the viewport pointer are left out
+        uint64_t hash() const;
+
     }; // struct PipelineCreation
 
     // API-agnostic structs /////////////////////////////////////////////////////////
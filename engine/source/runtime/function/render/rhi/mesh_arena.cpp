@@ -0,0 +1,143 @@
+#include "runtime/function/render/rhi/mesh_arena.h"
+
+#include "runtime/core/base/macro.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace ArchViz
+{
+    void MeshArena::FreeList::reset(uint32_t size)
+    {
+        blocks.clear();
+        if (size > 0)
+        {
+            blocks.emplace(0, size);
+        }
+        capacity = size;
+        used     = 0;
+    }
+
+    uint32_t MeshArena::FreeList::allocate(uint32_t count)
+    {
+        for (auto iter = blocks.begin(); iter != blocks.end(); ++iter)
+        {
+            const auto [offset, size] = *iter;
+            if (size < count)
+            {
+                continue;
+            }
+
+            blocks.erase(iter);
+            if (size > count)
+            {
+                blocks.emplace(offset + count, size - count);
+            }
+            used += count;
+            return offset;
+        }
+        return k_invalid_offset;
+    }
+
+    void MeshArena::FreeList::release(uint32_t offset, uint32_t count)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+        used -= count;
+
+        // merged with the block right after it and the one right before it
+        auto next = blocks.lower_bound(offset);
+        if (next != blocks.end() && offset + count == next->first)
+        {
+            count += next->second;
+            next = blocks.erase(next);
+        }
+        if (next != blocks.begin())
+        {
+            auto prev = std::prev(next);
+            if (prev->first + prev->second == offset)
+            {
+                prev->second += count;
+                return;
+            }
+        }
+        blocks.emplace_hint(next, offset, count);
+    }
+
+    void MeshArena::initialize(uint32_t vertex_capacity, uint32_t index_capacity, uint32_t frame_latency)
+    {
+        ASSERT(vertex_capacity > 0 && index_capacity > 0);
+        clear();
+        m_vertices.reset(vertex_capacity);
+        m_indices.reset(index_capacity);
+        m_frame_latency = frame_latency;
+    }
+
+    void MeshArena::clear()
+    {
+        m_vertices.reset(0);
+        m_indices.reset(0);
+        m_frame_latency = 0;
+        m_frame         = 0;
+        m_ranges.clear();
+        m_pending.clear();
+        m_statistics = {};
+    }
+
+    bool MeshArena::allocate(uint32_t mesh, uint32_t vertex_count, uint32_t index_count)
+    {
+        ASSERT(index_count > 0 && !isResident(mesh));
+
+        const uint32_t vertex_offset = m_vertices.allocate(vertex_count);
+        if (vertex_offset == FreeList::k_invalid_offset)
+        {
+            m_statistics.refused += 1;
+            return false;
+        }
+
+        const uint32_t first_index = m_indices.allocate(index_count);
+        if (first_index == FreeList::k_invalid_offset)
+        {
+            m_vertices.release(vertex_offset, vertex_count);
+            m_statistics.refused += 1;
+            return false;
+        }
+
+        if (mesh >= m_ranges.size())
+        {
+            m_ranges.resize(static_cast<size_t>(mesh) + 1);
+        }
+        m_ranges[mesh] = {vertex_offset, vertex_count, first_index, index_count};
+
+        m_statistics.allocations += 1;
+        m_statistics.peak_vertices = std::max(m_statistics.peak_vertices, m_vertices.used);
+        m_statistics.peak_indices  = std::max(m_statistics.peak_indices, m_indices.used);
+        return true;
+    }
+
+    void MeshArena::free(uint32_t mesh)
+    {
+        ASSERT(isResident(mesh));
+
+        m_pending.push_back({m_ranges[mesh], m_frame});
+        m_ranges[mesh] = {};
+
+        m_statistics.frees += 1;
+    }
+
+    void MeshArena::advance()
+    {
+        m_frame += 1;
+
+        // frees are queued in frame order, the oldest are at the front
+        while (!m_pending.empty() && m_pending.front().frame + m_frame_latency <= m_frame)
+        {
+            const MeshRange& range = m_pending.front().range;
+            m_vertices.release(range.vertex_offset, range.vertex_count);
+            m_indices.release(range.first_index, range.index_count);
+            m_pending.pop_front();
+        }
+    }
+} // namespace ArchViz
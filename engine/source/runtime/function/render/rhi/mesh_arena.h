@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <vector>
+
+namespace ArchViz
+{
+    // where a mesh lives in the shared vertex and index buffers, in vertices and indices
+    struct MeshRange
+    {
+        uint32_t vertex_offset {0};
+        uint32_t vertex_count {0};
+        uint32_t first_index {0};
+        uint32_t index_count {0};
+    };
+
+    struct MeshArenaStatistics
+    {
+        uint64_t allocations {0};
+        uint64_t frees {0};
+        uint64_t refused {0}; // meshes that found no free block large enough, fragmentation included
+        uint32_t peak_vertices {0};
+        uint32_t peak_indices {0};
+    };
+
+    // the vertices and indices of every mesh in one vertex and one index buffer, so draws of different meshes only differ in
+    // their offsets and can share one indirect draw. Each buffer is a list of free blocks, a mesh takes the first block it
+    // fits in and a freed range is merged with its free neighbours. Like the bindless indices, a freed range is only handed
+    // out again frame_latency frames later, once no frame in flight draws from it. Meshes are keyed by the ids of the
+    // render queue, the arena only keeps offsets, the bytes are uploaded by whoever owns the buffers.
+    class MeshArena
+    {
+    public:
+        void initialize(uint32_t vertex_capacity, uint32_t index_capacity, uint32_t frame_latency);
+        void clear();
+
+        // false when either range does not fit, the mesh is not resident then. index_count is at least 1
+        bool allocate(uint32_t mesh, uint32_t vertex_count, uint32_t index_count);
+        // the ranges are reused by the advance that is frame_latency frames after this one
+        void free(uint32_t mesh);
+
+        // a new frame begins, the fence of the frame frame_latency ago was waited for
+        void advance();
+
+        bool             isResident(uint32_t mesh) const { return mesh < m_ranges.size() && m_ranges[mesh].index_count > 0; }
+        const MeshRange& getRange(uint32_t mesh) const { return m_ranges[mesh]; }
+
+        uint32_t vertexCapacity() const { return m_vertices.capacity; }
+        uint32_t indexCapacity() const { return m_indices.capacity; }
+        // in use or waiting for their frame
+        uint32_t usedVertices() const { return m_vertices.used; }
+        uint32_t usedIndices() const { return m_indices.used; }
+        // free blocks, one when nothing is fragmented
+        uint32_t vertexBlocks() const { return static_cast<uint32_t>(m_vertices.blocks.size()); }
+        uint32_t indexBlocks() const { return static_cast<uint32_t>(m_indices.blocks.size()); }
+
+        const MeshArenaStatistics& getStatistics() const { return m_statistics; }
+
+    private:
+        struct FreeList
+        {
+            static constexpr uint32_t k_invalid_offset = ~0u;
+
+            void reset(uint32_t size);
+
+            uint32_t allocate(uint32_t count);
+            void     release(uint32_t offset, uint32_t count);
+
+            std::map<uint32_t, uint32_t> blocks; // offset to size, meshes are loaded rarely enough for a linear first fit
+            uint32_t                     capacity {0};
+            uint32_t                     used {0};
+        };
+
+        struct Pending
+        {
+            MeshRange range;
+            uint64_t  frame {0}; // the frame it was freed in
+        };
+
+        FreeList m_vertices;
+        FreeList m_indices;
+
+        uint32_t m_frame_latency {0};
+        uint64_t m_frame {0};
+
+        std::vector<MeshRange> m_ranges; // by mesh id, an index count of 0 when not resident
+        std::deque<Pending>    m_pending;
+
+        MeshArenaStatistics m_statistics;
+    };
+} // namespace ArchViz
@@ -0,0 +1,184 @@
+#pragma once
+
+#include "runtime/core/base/macro.h"
+#include "runtime/core/thread/work_executor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace ArchViz
+{
+    struct ParallelRecordThreadStatistics
+    {
+        uint32_t chunks {0};
+        uint32_t draws {0};
+        float    record_ms {0.0f}; // cpu time spent in the record callback
+    };
+
+    struct ParallelRecordStatistics
+    {
+        uint32_t frames {0};
+        uint32_t records {0};
+        uint32_t allocated {0}; // command buffers allocated so far, stays flat once every pool has enough
+        float    wall_ms {0.0f}; // time the caller spent waiting for the chunks
+
+        std::vector<ParallelRecordThreadStatistics> threads;
+    };
+
+    // records draws split in chunks over the executor, one command buffer per chunk, handed back in draw order
+    // every thread slot has its own pool per frame in flight. A record call gives each slot at most one chunk and waits for all of
+    // them, so a pool is only ever used by one task at a time. Buffers are never freed, beginFrame resets the pools of the frame and
+    // the buffers allocated from them are used again.
+    template<typename CommandBuffer>
+    class ParallelCommandRecorder
+    {
+    public:
+        // a new command buffer from the pool of this frame and thread slot
+        using AllocateFunc = std::function<CommandBuffer(uint32_t frame, uint32_t thread)>;
+        // resets the pool of this frame and thread slot, the buffers allocated from it can be begun again
+        using ResetFunc = std::function<void(uint32_t frame, uint32_t thread)>;
+        // begins the buffer, records the draws in [begin, end) and ends it
+        using RecordFunc = std::function<void(CommandBuffer command_buffer, uint32_t thread, uint32_t begin, uint32_t end)>;
+
+        void initialize(uint32_t frames, uint32_t threads, AllocateFunc allocate, ResetFunc reset, std::shared_ptr<WorkExecutor> executor = nullptr)
+        {
+            ASSERT(frames > 0 && threads > 0);
+
+            m_frames   = std::max(frames, 1u);
+            m_threads  = std::max(threads, 1u);
+            m_allocate = std::move(allocate);
+            m_reset    = std::move(reset);
+            m_executor = std::move(executor);
+
+            m_slots.clear();
+            m_slots.resize(m_frames * m_threads);
+            m_frame = 0;
+
+            m_statistics = {};
+            m_statistics.threads.resize(m_threads);
+        }
+
+        void clear()
+        {
+            m_slots.clear();
+            m_recorded.clear();
+        }
+
+        // the previous submission of this frame slot must have finished
+        void beginFrame(uint32_t frame)
+        {
+            m_frame = frame % m_frames;
+            for (uint32_t thread = 0; thread < m_threads; ++thread)
+            {
+                Slot& slot = m_slots[m_frame * m_threads + thread];
+                if (slot.used > 0 && m_reset)
+                {
+                    m_reset(m_frame, thread);
+                }
+                slot.used = 0;
+            }
+            m_statistics.frames += 1;
+        }
+
+        // how many chunks record splits draw_count draws into
+        uint32_t chunkCount(uint32_t draw_count) const
+        {
+            if (draw_count == 0)
+            {
+                return 0;
+            }
+            const uint32_t grain = std::max(m_min_chunk_draws, 1u);
+            return std::min(m_threads, (draw_count + grain - 1) / grain);
+        }
+
+        // records draw_count draws on up to one chunk per thread slot, the buffers come back in draw order
+        const std::vector<CommandBuffer>& record(uint32_t draw_count, const RecordFunc& record_chunk)
+        {
+            const uint32_t chunks = chunkCount(draw_count);
+
+            m_recorded.resize(chunks);
+            for (uint32_t chunk = 0; chunk < chunks; ++chunk)
+            {
+                m_recorded[chunk] = acquire(chunk);
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+
+            // chunk i always goes to thread slot i, the statistics of a slot are only written by its own chunk
+            parallel_for(m_executor, chunks, 1, [&](uint32_t first, uint32_t last) {
+                for (uint32_t chunk = first; chunk < last; ++chunk)
+                {
+                    const uint32_t begin = static_cast<uint32_t>(static_cast<uint64_t>(draw_count) * chunk / chunks);
+                    const uint32_t end   = static_cast<uint32_t>(static_cast<uint64_t>(draw_count) * (chunk + 1) / chunks);
+
+                    const auto chunk_start = std::chrono::steady_clock::now();
+                    record_chunk(m_recorded[chunk], chunk, begin, end);
+                    const auto chunk_end = std::chrono::steady_clock::now();
+
+                    ParallelRecordThreadStatistics& thread = m_statistics.threads[chunk];
+                    thread.chunks += 1;
+                    thread.draws += end - begin;
+                    thread.record_ms += std::chrono::duration<float, std::milli>(chunk_end - chunk_start).count();
+                }
+            });
+
+            const auto end = std::chrono::steady_clock::now();
+
+            m_statistics.records += 1;
+            m_statistics.wall_ms += std::chrono::duration<float, std::milli>(end - start).count();
+            return m_recorded;
+        }
+
+        uint32_t frameCount() const { return m_frames; }
+        uint32_t threadCount() const { return m_threads; }
+
+        const ParallelRecordStatistics& getStatistics() const { return m_statistics; }
+
+        void resetStatistics()
+        {
+            m_statistics = {};
+            m_statistics.threads.resize(m_threads);
+        }
+
+    public:
+        // fewer draws than this are not worth another thread
+        uint32_t m_min_chunk_draws {64};
+
+    private:
+        struct Slot
+        {
+            std::vector<CommandBuffer> buffers;
+            uint32_t                   used {0};
+        };
+
+        // the next unused buffer of the slot, allocated when the pool has none left this frame
+        CommandBuffer acquire(uint32_t thread)
+        {
+            Slot& slot = m_slots[m_frame * m_threads + thread];
+            if (slot.used == slot.buffers.size())
+            {
+                slot.buffers.push_back(m_allocate(m_frame, thread));
+                m_statistics.allocated += 1;
+            }
+            return slot.buffers[slot.used++];
+        }
+
+    private:
+        uint32_t m_frames {1};
+        uint32_t m_threads {1};
+        uint32_t m_frame {0};
+
+        AllocateFunc                  m_allocate;
+        ResetFunc                     m_reset;
+        std::shared_ptr<WorkExecutor> m_executor;
+
+        std::vector<Slot>          m_slots; // [frame * threads + thread]
+        std::vector<CommandBuffer> m_recorded;
+
+        ParallelRecordStatistics m_statistics;
+    };
+} // namespace ArchViz
@@ -0,0 +1,36 @@
+#include "runtime/function/render/rhi/pipeline_state_cache.h"
+
+#include <cstring>
+
+namespace ArchViz
+{
+    bool validate_pipeline_cache(const void* data, size_t size, const VkPhysicalDeviceProperties& properties)
+    {
+        VkPipelineCacheHeaderVersionOne header {};
+        if (data == nullptr || size < sizeof(header))
+        {
+            return false;
+        }
+
+        // the blob has no alignment guarantee, copy the header out
+        std::memcpy(&header, data, sizeof(header));
+
+        if (header.headerSize < sizeof(header) || header.headerSize > size || header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE)
+        {
+            LOG_WARN("pipeline cache header is malformed, version {} size {}", static_cast<uint32_t>(header.headerVersion), header.headerSize);
+            return false;
+        }
+        if (header.vendorID != properties.vendorID || header.deviceID != properties.deviceID)
+        {
+            LOG_INFO("pipeline cache was written by another device, {:#x}:{:#x}", header.vendorID, header.deviceID);
+            return false;
+        }
+        // a driver update changes the uuid, its old cache would be rejected or worse
+        if (std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+        {
+            LOG_INFO("pipeline cache was written by another driver version");
+            return false;
+        }
+        return true;
+    }
+} // namespace ArchViz
@@ -0,0 +1,243 @@
+#pragma once
+#include "runtime/function/render/rhi/gpu_resources.h"
+
+#include "runtime/core/base/macro.h"
+#include "runtime/core/thread/work_executor.h"
+
+#include <volk.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace ArchViz
+{
+    namespace PipelineState
+    {
+        enum Enum
+        {
+            Unknown,
+            Pending,
+            Ready,
+            Failed,
+            Count
+        };
+
+        static const char* s_value_names[] = {"Unknown", "Pending", "Ready", "Failed", "Count"};
+
+        static const char* ToString(Enum e) { return ((uint32_t)e < Enum::Count ? s_value_names[(int)e] : "unsupported"); }
+    } // namespace PipelineState
+
+    struct PipelineStateStatistics
+    {
+        uint32_t requests {0};
+        uint32_t reused {0};
+        uint32_t compiled {0};
+        uint32_t failed {0};
+        uint32_t fallbacks {0}; // requests answered with the fallback while the pipeline was pending
+        float    compile_ms {0.0f};
+    };
+
+    // a VkPipelineCache blob is only fed back to the driver that wrote it, the header must match vendor, device and cache uuid
+    bool validate_pipeline_cache(const void* data, size_t size, const VkPhysicalDeviceProperties& properties);
+
+    // compiled pipelines keyed by PipelineCreation::hash()
+    // the first request of a key starts the compile on the executor and gets the fallback until it is ready,
+    // without an executor the compile runs inline. The compile callback gets its own copy of the creation,
+    // the viewport pointer in it is not kept and must not be used.
+    template<typename Pipeline>
+    class PipelineStateCache
+    {
+    public:
+        using CompileFunc = std::function<bool(const PipelineCreation&, Pipeline&)>;
+        using DestroyFunc = std::function<void(Pipeline&)>;
+
+        ~PipelineStateCache() { wait(); }
+
+        void initialize(CompileFunc compile, DestroyFunc destroy, std::shared_ptr<WorkExecutor> executor = nullptr)
+        {
+            wait();
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_compile    = std::move(compile);
+            m_destroy    = std::move(destroy);
+            m_executor   = std::move(executor);
+            m_statistics = {};
+        }
+
+        // waits for the compiles in flight, then destroys every pipeline
+        void clear()
+        {
+            wait();
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (auto& [key, entry] : m_entries)
+            {
+                if (entry.state == PipelineState::Ready && m_destroy)
+                {
+                    m_destroy(entry.pipeline);
+                }
+            }
+            m_entries.clear();
+        }
+
+        Pipeline request(const PipelineCreation& creation, const Pipeline& fallback) { return request(creation.hash(), creation, fallback); }
+
+        Pipeline request(uint64_t key, const PipelineCreation& creation, const Pipeline& fallback)
+        {
+            if (!submit(key, creation))
+            {
+                return fallback;
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            const Entry& entry = m_entries[key];
+            if (entry.state == PipelineState::Ready)
+            {
+                return entry.pipeline;
+            }
+            if (entry.state == PipelineState::Pending)
+            {
+                m_statistics.fallbacks += 1;
+            }
+            return fallback;
+        }
+
+        // blocks until the pipeline is compiled, for the pipelines nothing can stand in for
+        bool get(const PipelineCreation& creation, Pipeline& pipeline)
+        {
+            const uint64_t key = creation.hash();
+            if (!submit(key, creation))
+            {
+                return false;
+            }
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [&]() { return m_entries[key].state != PipelineState::Pending; });
+
+            const Entry& entry = m_entries[key];
+            pipeline           = entry.pipeline;
+            return entry.state == PipelineState::Ready;
+        }
+
+        PipelineState::Enum state(uint64_t key) const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            auto iter = m_entries.find(key);
+            return iter == m_entries.end() ? PipelineState::Unknown : iter->second.state;
+        }
+
+        void wait()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [&]() { return m_pending == 0; });
+        }
+
+        size_t size() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_entries.size();
+        }
+
+        PipelineStateStatistics getStatistics() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_statistics;
+        }
+
+    private:
+        struct Entry
+        {
+            PipelineState::Enum state {PipelineState::Unknown};
+            Pipeline            pipeline {};
+        };
+
+        // starts the compile of a new key, false when the cache has no compile callback
+        bool submit(uint64_t key, const PipelineCreation& creation)
+        {
+            std::shared_ptr<WorkExecutor> executor;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_compile)
+                {
+                    LOG_ERROR("pipeline state cache used before initialize");
+                    return false;
+                }
+
+                m_statistics.requests += 1;
+
+                Entry& entry = m_entries[key];
+                if (entry.state != PipelineState::Unknown)
+                {
+                    m_statistics.reused += 1;
+                    return true;
+                }
+
+                entry.state = PipelineState::Pending;
+                executor    = m_executor;
+                m_pending += 1;
+            }
+
+            if (executor == nullptr)
+            {
+                compile(key, creation);
+            }
+            else
+            {
+                auto copy = std::make_shared<PipelineCreation>(creation);
+                executor->enqueue_work([this, key, copy]() { compile(key, *copy); });
+            }
+            return true;
+        }
+
+        void compile(uint64_t key, PipelineCreation creation)
+        {
+            creation.viewport = nullptr;
+
+            const auto start    = std::chrono::steady_clock::now();
+            Pipeline   pipeline = {};
+            const bool compiled = m_compile(creation, pipeline);
+            const auto end      = std::chrono::steady_clock::now();
+            if (!compiled)
+            {
+                LOG_ERROR("failed to compile pipeline {}, {:#018x}", creation.name, key);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+
+                Entry& entry   = m_entries[key];
+                entry.state    = compiled ? PipelineState::Ready : PipelineState::Failed;
+                entry.pipeline = compiled ? pipeline : Pipeline {};
+
+                m_statistics.compiled += compiled ? 1 : 0;
+                m_statistics.failed += compiled ? 0 : 1;
+                m_statistics.compile_ms += std::chrono::duration<float, std::milli>(end - start).count();
+                m_pending -= 1;
+
+                // under the lock, a waiter may destroy the cache as soon as it sees the count drop, nothing of this is touched after it
+                m_condition.notify_all();
+            }
+        }
+
+    private:
+        mutable std::mutex      m_mutex;
+        std::condition_variable m_condition;
+
+        CompileFunc                   m_compile;
+        DestroyFunc                   m_destroy;
+        std::shared_ptr<WorkExecutor> m_executor;
+
+        std::unordered_map<uint64_t, Entry> m_entries;
+        uint32_t                            m_pending {0};
+
+        PipelineStateStatistics m_statistics;
+    };
+} // namespace ArchViz
@@ -11,10 +11,14 @@
 namespace ArchViz
 {
     class WindowSystem;
+    class RenderQueue;
+    class WorkExecutor;
 
     struct RHIInitInfo
     {
         std::shared_ptr<WindowSystem> window_system;
+        std::shared_ptr<RenderQueue>  render_queue; // names the meshes, its batches are not drawn yet
+        std::shared_ptr<WorkExecutor> executor;     // pipeline compiles and command recording, inline when null
     };
 
     class RHI
@@ -0,0 +1,474 @@
+#include "runtime/function/render/rhi/shader_permutation.h"
+#include "runtime/function/render/rhi/spirv_parser.h"
+#include "runtime/function/render/rhi/vulkan/utils/vulkan_shader_cache.h"
+#include "runtime/function/render/rhi/vulkan/utils/vulkan_shader_utils.h"
+
+#include "runtime/core/base/hash.h"
+#include "runtime/core/base/macro.h"
+#include "runtime/core/meta/json.h"
+#include "runtime/core/thread/work_executor.h"
+
+#include "runtime/function/global/global_context.h"
+
+#include "runtime/resource/asset_manager/asset_manager.h"
+#include "runtime/resource/config_manager/config_manager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <set>
+#include <sstream>
+
+namespace ArchViz
+{
+    namespace
+    {
+        constexpr int k_manifest_version = 3;
+
+        std::string to_hex(uint64_t value)
+        {
+            std::ostringstream stream;
+            stream << std::hex << std::setw(16) << std::setfill('0') << value;
+            return stream.str();
+        }
+
+        uint64_t from_hex(const std::string& text) { return std::strtoull(text.c_str(), nullptr, 16); }
+
+        bool read_spirv(const std::filesystem::path& path, std::vector<uint32_t>& spirv)
+        {
+            std::ifstream file(path, std::ios::binary | std::ios::ate);
+            if (!file)
+            {
+                return false;
+            }
+            std::streamsize size = file.tellg();
+            if (size < 20 || size % sizeof(uint32_t) != 0)
+            {
+                return false;
+            }
+            spirv.resize(static_cast<size_t>(size) / sizeof(uint32_t));
+            file.seekg(0);
+            file.read(reinterpret_cast<char*>(spirv.data()), size);
+            return static_cast<bool>(file) && spirv[0] == 0x07230203;
+        }
+
+        bool read_reflection(const std::filesystem::path& path, ShaderReflection& reflection)
+        {
+            std::ifstream file(path, std::ios::binary);
+            if (!file)
+            {
+                return false;
+            }
+            std::vector<uint8_t> data {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+            return reflection.deserialize(data.data(), data.size());
+        }
+
+        bool write_file(const std::filesystem::path& path, const void* data, size_t size)
+        {
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            if (!file)
+            {
+                return false;
+            }
+            file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+            return static_cast<bool>(file);
+        }
+    } // namespace
+
+    uint32_t ShaderPermutationDesc::variantCount() const
+    {
+        uint32_t count = 1;
+        for (const auto& axis : axes)
+        {
+            count *= axis.size();
+        }
+        return count;
+    }
+
+    std::vector<std::string> ShaderPermutationDesc::variantDefines(uint32_t variant) const
+    {
+        std::vector<std::string> defines;
+        for (const auto& axis : axes)
+        {
+            uint32_t digit = variant % axis.size();
+            variant /= axis.size();
+
+            if (axis.values.empty())
+            {
+                if (digit == 1)
+                {
+                    defines.push_back(axis.name);
+                }
+            }
+            else
+            {
+                defines.push_back(axis.name + "=" + axis.values[digit]);
+            }
+        }
+        return defines;
+    }
+
+    uint64_t ShaderPermutationManifest::variantKey(const std::string& file, const std::vector<std::string>& defines)
+    {
+        std::vector<std::string> sorted = defines;
+        std::sort(sorted.begin(), sorted.end());
+
+        uint64_t key = Hash::hash_bytes(file.data(), file.size());
+        for (const auto& define : sorted)
+        {
+            key = Hash::hash_bytes(define.data(), define.size(), key);
+        }
+        return key;
+    }
+
+    void ShaderPermutationManifest::clear()
+    {
+        m_entries.clear();
+        m_blobs.clear();
+        m_reflections.clear();
+        m_blob_lookup.clear();
+        m_entry_lookup.clear();
+        m_variant_lookup.clear();
+    }
+
+    uint32_t ShaderPermutationManifest::addBlob(std::vector<uint32_t>&& spirv, ShaderReflection&& reflection)
+    {
+        // variants whose defines do not reach the code compile to the same words, they share one blob
+        const uint64_t hash = Hash::hash_bytes(spirv.data(), spirv.size() * sizeof(uint32_t));
+        auto           iter = m_blob_lookup.find(hash);
+        if (iter != m_blob_lookup.end())
+        {
+            ASSERT(m_blobs[iter->second] == spirv);
+            return iter->second;
+        }
+
+        uint32_t blob = static_cast<uint32_t>(m_blobs.size());
+        m_blobs.push_back(std::move(spirv));
+        m_reflections.push_back(std::move(reflection));
+        m_blob_lookup[hash] = blob;
+        return blob;
+    }
+
+    void ShaderPermutationManifest::addEntry(ShaderManifestEntry&& entry)
+    {
+        uint32_t index = static_cast<uint32_t>(m_entries.size());
+        for (uint32_t v = 0; v < entry.variants.size(); ++v)
+        {
+            m_variant_lookup[variantKey(entry.file, entry.variants[v].defines)] = {index, v};
+        }
+        m_entry_lookup[entry.file] = index;
+        m_entries.push_back(std::move(entry));
+    }
+
+    const ShaderVariant* ShaderPermutationManifest::findVariant(const std::string& file, const std::vector<std::string>& defines) const
+    {
+        auto iter = m_variant_lookup.find(variantKey(file, defines));
+        if (iter == m_variant_lookup.end())
+        {
+            return nullptr;
+        }
+
+        const ShaderManifestEntry& entry = m_entries[iter->second.first];
+        return entry.file == file ? &entry.variants[iter->second.second] : nullptr;
+    }
+
+    const ShaderManifestEntry* ShaderPermutationManifest::findEntry(const std::string& file) const
+    {
+        auto iter = m_entry_lookup.find(file);
+        return iter == m_entry_lookup.end() ? nullptr : &m_entries[iter->second];
+    }
+
+    bool ShaderPermutationManifest::load(const std::filesystem::path& folder)
+    {
+        clear();
+
+        std::ifstream file(folder / k_manifest_name);
+        if (!file)
+        {
+            return false;
+        }
+        std::string json_text {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+
+        std::string error;
+        Json        json = Json::parse(json_text, error);
+        if (!error.empty() || json["version"].int_value() != k_manifest_version)
+        {
+            LOG_ERROR("invalid shader manifest {}: {}", (folder / k_manifest_name).generic_string(), error);
+            return false;
+        }
+
+        const auto& blobs = json["blobs"].array_items();
+        m_blobs.resize(blobs.size());
+        m_reflections.resize(blobs.size());
+        for (size_t i = 0; i < blobs.size(); ++i)
+        {
+            const std::string& name = blobs[i].string_value();
+            if (!read_spirv(folder / (name + ".spv"), m_blobs[i]) || !read_reflection(folder / (name + ".refl"), m_reflections[i]))
+            {
+                LOG_ERROR("missing or damaged shader blob {} in {}", name, folder.generic_string());
+                clear();
+                return false;
+            }
+            m_blob_lookup[from_hex(name)] = static_cast<uint32_t>(i);
+        }
+
+        for (const auto& shader : json["shaders"].array_items())
+        {
+            ShaderManifestEntry entry;
+            entry.file        = shader["file"].string_value();
+            entry.source_hash = from_hex(shader["source_hash"].string_value());
+
+            for (const auto& item : shader["dependencies"].array_items())
+            {
+                entry.dependencies.push_back({item["file"].string_value(), from_hex(item["hash"].string_value())});
+            }
+
+            for (const auto& item : shader["variants"].array_items())
+            {
+                ShaderVariant variant;
+                variant.blob = static_cast<uint32_t>(item["blob"].int_value());
+                if (variant.blob >= m_blobs.size())
+                {
+                    LOG_ERROR("shader manifest variant of {} refers to blob {}", entry.file, variant.blob);
+                    clear();
+                    return false;
+                }
+                for (const auto& define : item["defines"].array_items())
+                {
+                    variant.defines.push_back(define.string_value());
+                }
+                entry.variants.push_back(std::move(variant));
+            }
+            addEntry(std::move(entry));
+        }
+        return true;
+    }
+
+    bool ShaderPermutationManifest::save(const std::filesystem::path& folder) const
+    {
+        std::error_code error;
+        std::filesystem::create_directories(folder, error);
+
+        std::vector<std::string> names(m_blobs.size());
+        for (const auto& [hash, blob] : m_blob_lookup)
+        {
+            names[blob] = to_hex(hash);
+        }
+
+        Json::array blobs;
+        for (size_t i = 0; i < m_blobs.size(); ++i)
+        {
+            const std::vector<uint8_t> reflection = m_reflections[i].serialize();
+            if (!write_file(folder / (names[i] + ".spv"), m_blobs[i].data(), m_blobs[i].size() * sizeof(uint32_t)) ||
+                !write_file(folder / (names[i] + ".refl"), reflection.data(), reflection.size()))
+            {
+                LOG_ERROR("cannot write shader blob {} to {}", names[i], folder.generic_string());
+                return false;
+            }
+            blobs.push_back(names[i]);
+        }
+
+        Json::array shaders;
+        for (const auto& entry : m_entries)
+        {
+            Json::array variants;
+            for (const auto& variant : entry.variants)
+            {
+                Json::array defines(variant.defines.begin(), variant.defines.end());
+                variants.push_back(Json::object {{"defines", defines}, {"blob", static_cast<int>(variant.blob)}});
+            }
+            Json::array dependencies;
+            for (const auto& dependency : entry.dependencies)
+            {
+                dependencies.push_back(Json::object {{"file", dependency.file}, {"hash", to_hex(dependency.hash)}});
+            }
+            shaders.push_back(Json::object {{"file", entry.file}, {"source_hash", to_hex(entry.source_hash)}, {"dependencies", dependencies}, {"variants", variants}});
+        }
+
+        Json json = Json::object {{"version", k_manifest_version}, {"blobs", blobs}, {"shaders", shaders}};
+
+        std::ofstream file(folder / k_manifest_name, std::ios::trunc);
+        if (!file)
+        {
+            LOG_ERROR("cannot write shader manifest to {}", folder.generic_string());
+            return false;
+        }
+        file << json.dump();
+
+        // blobs of an earlier build that no variant uses any more
+        std::set<std::string> current(names.begin(), names.end());
+        for (const auto& item : std::filesystem::directory_iterator(folder, error))
+        {
+            const std::filesystem::path extension = item.path().extension();
+            if ((extension == ".spv" || extension == ".refl") && current.count(item.path().stem().generic_string()) == 0)
+            {
+                std::filesystem::remove(item.path(), error);
+            }
+        }
+        return true;
+    }
+
+    ShaderPermutationBuilder::ShaderPermutationBuilder() :
+        m_compile([](const std::string& code, const std::string& file, const std::vector<std::string>& defines, std::vector<std::string>& dependencies) {
+            return VulkanShaderUtils::createShaderModuleFromCode(code, file, defines, nullptr, &dependencies);
+        })
+    {}
+
+    ShaderPermutationBuilder::ShaderPermutationBuilder(CompileFunction compile) : m_compile(std::move(compile)) {}
+
+    bool ShaderPermutationBuilder::parseDescs(const std::string& json_text, std::vector<ShaderPermutationDesc>& descs)
+    {
+        std::string error;
+        Json        json = Json::parse(json_text, error);
+        if (!error.empty())
+        {
+            LOG_ERROR("parse shader permutations failed: {}", error);
+            return false;
+        }
+
+        for (const auto& shader : json["shaders"].array_items())
+        {
+            ShaderPermutationDesc desc;
+            desc.file = shader["file"].string_value();
+            for (const auto& item : shader["axes"].array_items())
+            {
+                ShaderPermutationAxis axis;
+                axis.name = item["name"].string_value();
+                for (const auto& value : item["values"].array_items())
+                {
+                    axis.values.push_back(value.string_value());
+                }
+                if (axis.name.empty() || axis.values.size() == 1)
+                {
+                    LOG_ERROR("shader {} has an axis without name or with a single value", desc.file);
+                    return false;
+                }
+                desc.axes.push_back(std::move(axis));
+            }
+            descs.push_back(std::move(desc));
+        }
+        return true;
+    }
+
+    bool ShaderPermutationBuilder::build(const std::vector<ShaderPermutationDesc>& descs, std::shared_ptr<WorkExecutor> executor, ShaderPermutationManifest& manifest)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+
+        manifest.clear();
+        m_statistics         = {};
+        m_statistics.shaders = static_cast<uint32_t>(descs.size());
+
+        struct Job
+        {
+            uint32_t                 desc;
+            std::vector<std::string> defines;
+            std::vector<uint32_t>    spirv;
+            ShaderReflection         reflection;
+            std::vector<std::string> dependencies;
+        };
+
+        std::vector<std::string> sources(descs.size());
+        std::vector<Job>         jobs;
+        for (uint32_t d = 0; d < descs.size(); ++d)
+        {
+            g_runtime_global_context.m_asset_manager->readVFSTextFile(descs[d].file, sources[d]);
+            if (sources[d].empty())
+            {
+                LOG_ERROR("cannot read shader {}", descs[d].file);
+                m_statistics.failed += descs[d].variantCount();
+                continue;
+            }
+            for (uint32_t v = 0; v < descs[d].variantCount(); ++v)
+            {
+                jobs.push_back({d, descs[d].variantDefines(v), {}, {}, {}});
+            }
+        }
+
+        parallel_for(executor, static_cast<uint32_t>(jobs.size()), 1, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                Job& job  = jobs[i];
+                job.spirv = m_compile(sources[job.desc], descs[job.desc].file, job.defines, job.dependencies);
+                if (!job.spirv.empty() && !SPIRV::reflect(job.spirv, job.reflection))
+                {
+                    job.spirv.clear();
+                }
+            }
+        });
+
+        // jobs are grouped by shader, blobs are numbered in that order so a rebuild gives the same manifest
+        const std::filesystem::path& root_folder = g_runtime_global_context.m_config_manager->getRootFolder();
+        VulkanShaderCache&           cache       = VulkanShaderUtils::getShaderCache();
+
+        size_t next = 0;
+        for (uint32_t d = 0; d < descs.size(); ++d)
+        {
+            ShaderManifestEntry entry;
+            entry.file        = descs[d].file;
+            entry.source_hash = Hash::hash_bytes(sources[d].data(), sources[d].size());
+
+            size_t                end = next;
+            std::set<std::string> included;
+            for (; end < jobs.size() && jobs[end].desc == d; ++end)
+            {
+                if (!jobs[end].spirv.empty())
+                {
+                    included.insert(jobs[end].dependencies.begin(), jobs[end].dependencies.end());
+                }
+            }
+
+            // every include any variant read, an include that cannot be hashed could never be checked at load time
+            bool tracked = true;
+            for (const auto& path : included)
+            {
+                ShaderDependency dependency;
+                dependency.file = std::filesystem::path(path).lexically_proximate(root_folder).generic_string();
+                if (!cache.dependencyHash(path, dependency.hash))
+                {
+                    LOG_ERROR("shader {} include {} cannot be tracked, left to runtime compiles", entry.file, path);
+                    tracked = false;
+                    break;
+                }
+                entry.dependencies.push_back(std::move(dependency));
+            }
+
+            for (; next < end; ++next)
+            {
+                Job& job = jobs[next];
+                if (!tracked)
+                {
+                    m_statistics.failed += 1;
+                    continue;
+                }
+                if (job.spirv.empty())
+                {
+                    std::string defines;
+                    for (const auto& define : job.defines)
+                    {
+                        defines += (defines.empty() ? "" : " ") + define;
+                    }
+                    LOG_ERROR("shader {} failed to compile or reflect with defines [{}]", entry.file, defines);
+                    m_statistics.failed += 1;
+                    continue;
+                }
+
+                ShaderVariant variant;
+                variant.defines = std::move(job.defines);
+                variant.blob    = manifest.addBlob(std::move(job.spirv), std::move(job.reflection));
+                entry.variants.push_back(std::move(variant));
+                m_statistics.variants += 1;
+            }
+
+            if (!entry.variants.empty())
+            {
+                manifest.addEntry(std::move(entry));
+            }
+        }
+
+        m_statistics.blobs    = manifest.blobCount();
+        m_statistics.build_ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        return m_statistics.failed == 0;
+    }
+} // namespace ArchViz
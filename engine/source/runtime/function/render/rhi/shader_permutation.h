@@ -0,0 +1,126 @@
+#pragma once
+#include "runtime/function/render/rhi/shader_reflection.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ArchViz
+{
+    class WorkExecutor;
+
+    // one define of a shader that varies, without values it is switched off and on ("NAME"),
+    // otherwise every value is one variant ("NAME=VALUE")
+    struct ShaderPermutationAxis
+    {
+        std::string              name;
+        std::vector<std::string> values;
+
+        uint32_t size() const { return values.empty() ? 2 : static_cast<uint32_t>(values.size()); }
+    };
+
+    struct ShaderPermutationDesc
+    {
+        std::string                        file; // vfs path, e.g. shader/glsl/shader_phong.frag
+        std::vector<ShaderPermutationAxis> axes;
+
+        uint32_t variantCount() const;
+
+        // variant index is mixed radix over the axes, the first axis varies fastest
+        std::vector<std::string> variantDefines(uint32_t variant) const;
+    };
+
+    struct ShaderVariant
+    {
+        std::vector<std::string> defines;
+        uint32_t                 blob {0}; // index into the deduplicated spir-v of the manifest
+    };
+
+    // an include any variant of a shader resolved to, relative to the root folder
+    struct ShaderDependency
+    {
+        std::string file;
+        uint64_t    hash {0}; // of its content at build time
+    };
+
+    struct ShaderManifestEntry
+    {
+        std::string                   file;
+        uint64_t                      source_hash {0}; // of the source text the variants were built from
+        std::vector<ShaderDependency> dependencies;
+        std::vector<ShaderVariant>    variants;
+    };
+
+    // prebuilt variants of every shader, <folder>/manifest.json plus one <hash>.spv per distinct spir-v
+    // and its serialized reflection in <hash>.refl
+    class ShaderPermutationManifest
+    {
+    public:
+        static constexpr const char* k_manifest_name = "manifest.json";
+
+        bool load(const std::filesystem::path& folder);
+        bool save(const std::filesystem::path& folder) const;
+
+        void     clear();
+        uint32_t addBlob(std::vector<uint32_t>&& spirv, ShaderReflection&& reflection);
+        void     addEntry(ShaderManifestEntry&& entry);
+
+        // the order of the defines does not matter
+        const ShaderVariant*         findVariant(const std::string& file, const std::vector<std::string>& defines) const;
+        const ShaderManifestEntry*   findEntry(const std::string& file) const;
+        const std::vector<uint32_t>& getBlob(uint32_t blob) const { return m_blobs[blob]; }
+        const ShaderReflection&      getReflection(uint32_t blob) const { return m_reflections[blob]; }
+
+        const std::vector<ShaderManifestEntry>& entries() const { return m_entries; }
+        uint32_t                                blobCount() const { return static_cast<uint32_t>(m_blobs.size()); }
+        bool                                    empty() const { return m_entries.empty(); }
+
+        static uint64_t variantKey(const std::string& file, const std::vector<std::string>& defines);
+
+    private:
+        std::vector<ShaderManifestEntry>                            m_entries;
+        std::vector<std::vector<uint32_t>>                          m_blobs;
+        std::vector<ShaderReflection>                               m_reflections; // of each blob
+        std::unordered_map<uint64_t, uint32_t>                      m_blob_lookup; // spir-v hash -> blob
+        std::unordered_map<std::string, uint32_t>                   m_entry_lookup;
+        std::unordered_map<uint64_t, std::pair<uint32_t, uint32_t>> m_variant_lookup; // variant key -> entry, variant
+    };
+
+    struct ShaderBuildStatistics
+    {
+        uint32_t shaders {0};
+        uint32_t variants {0};
+        uint32_t blobs {0}; // distinct spir-v after deduplication
+        uint32_t failed {0};
+        double   build_ms {0.0};
+    };
+
+    // compiles every variant of every shader as its own job, one glslang shader per job,
+    // identical spir-v is stored once and every variant is reflected through SPIRV::reflect
+    class ShaderPermutationBuilder
+    {
+    public:
+        // source text, vfs path, defines -> spir-v and the include files it read, must be callable from several threads,
+        // empty on failure
+        using CompileFunction = std::function<std::vector<uint32_t>(const std::string&, const std::string&, const std::vector<std::string>&, std::vector<std::string>&)>;
+
+        ShaderPermutationBuilder();
+        explicit ShaderPermutationBuilder(CompileFunction compile);
+
+        // { "shaders": [ { "file": "...", "axes": [ { "name": "...", "values": [ "..." ] } ] } ] }
+        static bool parseDescs(const std::string& json_text, std::vector<ShaderPermutationDesc>& descs);
+
+        // false when any variant failed, the manifest then holds the variants that compiled
+        bool build(const std::vector<ShaderPermutationDesc>& descs, std::shared_ptr<WorkExecutor> executor, ShaderPermutationManifest& manifest);
+
+        const ShaderBuildStatistics& getStatistics() const { return m_statistics; }
+
+    private:
+        CompileFunction       m_compile;
+        ShaderBuildStatistics m_statistics;
+    };
+} // namespace ArchViz
@@ -0,0 +1,281 @@
+#include "runtime/function/render/rhi/shader_reflection.h"
+
+#include "runtime/core/base/hash.h"
+#include "runtime/core/base/macro.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ArchViz
+{
+    namespace
+    {
+        constexpr uint32_t k_reflection_magic   = 0x52535641; // "AVSR"
+        constexpr uint32_t k_reflection_version = 1;
+        constexpr uint32_t k_max_name           = 1024;
+
+        class Writer
+        {
+        public:
+            explicit Writer(std::vector<uint8_t>& output) : m_output(output) {}
+
+            void u32(uint32_t value) { append(&value, sizeof(value)); }
+
+            void str(const std::string& value)
+            {
+                u32(static_cast<uint32_t>(value.size()));
+                append(value.data(), value.size());
+            }
+
+        private:
+            void append(const void* data, size_t size)
+            {
+                const uint8_t* bytes = static_cast<const uint8_t*>(data);
+                m_output.insert(m_output.end(), bytes, bytes + size);
+            }
+
+            std::vector<uint8_t>& m_output;
+        };
+
+        // every read checks the remaining size, a truncated or damaged buffer fails instead of reading past it
+        class Reader
+        {
+        public:
+            Reader(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+
+            bool u32(uint32_t& value) { return read(&value, sizeof(value)); }
+
+            bool str(std::string& value)
+            {
+                uint32_t size = 0;
+                if (!u32(size) || size > k_max_name || size > m_size - m_offset)
+                {
+                    return false;
+                }
+                value.assign(reinterpret_cast<const char*>(m_data + m_offset), size);
+                m_offset += size;
+                return true;
+            }
+
+            // a count read from the buffer, bounded by what the rest of the buffer can hold
+            bool count(uint32_t& value, size_t min_item_size) { return u32(value) && value <= (m_size - m_offset) / min_item_size; }
+
+            bool finished() const { return m_offset == m_size; }
+
+        private:
+            bool read(void* value, size_t size)
+            {
+                if (size > m_size - m_offset)
+                {
+                    return false;
+                }
+                memcpy(value, m_data + m_offset, size);
+                m_offset += size;
+                return true;
+            }
+
+            const uint8_t* m_data;
+            size_t         m_size;
+            size_t         m_offset {0};
+        };
+
+        uint64_t hash_values(std::initializer_list<uint32_t> values, uint64_t seed) { return Hash::hash_bytes(values.begin(), values.size() * sizeof(uint32_t), seed); }
+    } // namespace
+
+    void ShaderReflection::serialize(std::vector<uint8_t>& output) const
+    {
+        Writer writer(output);
+        writer.u32(k_reflection_magic);
+        writer.u32(k_reflection_version);
+        writer.u32(static_cast<uint32_t>(stage));
+        writer.str(entry_point);
+
+        writer.u32(static_cast<uint32_t>(bindings.size()));
+        for (const auto& binding : bindings)
+        {
+            writer.u32(binding.set);
+            writer.u32(binding.binding);
+            writer.u32(static_cast<uint32_t>(binding.type));
+            writer.u32(binding.count);
+            writer.u32(binding.stages);
+            writer.str(binding.name);
+        }
+
+        writer.u32(static_cast<uint32_t>(inputs.size()));
+        for (const auto& input : inputs)
+        {
+            writer.u32(input.location);
+            writer.u32(static_cast<uint32_t>(input.format));
+            writer.str(input.name);
+        }
+
+        writer.u32(static_cast<uint32_t>(push_constants.size()));
+        for (const auto& range : push_constants)
+        {
+            writer.u32(range.offset);
+            writer.u32(range.size);
+            writer.u32(range.stages);
+        }
+
+        writer.u32(static_cast<uint32_t>(specialization_constants.size()));
+        for (const auto& constant : specialization_constants)
+        {
+            writer.u32(constant.id);
+            writer.u32(constant.size);
+            writer.u32(constant.default_value);
+            writer.str(constant.name);
+        }
+
+        for (uint32_t size : workgroup_size)
+        {
+            writer.u32(size);
+        }
+    }
+
+    std::vector<uint8_t> ShaderReflection::serialize() const
+    {
+        std::vector<uint8_t> output;
+        serialize(output);
+        return output;
+    }
+
+    bool ShaderReflection::deserialize(const uint8_t* data, size_t size)
+    {
+        *this = {};
+
+        Reader   reader(data, size);
+        uint32_t magic = 0, version = 0, value = 0, count = 0;
+        if (!reader.u32(magic) || !reader.u32(version) || magic != k_reflection_magic || version != k_reflection_version)
+        {
+            return false;
+        }
+
+        bool valid = reader.u32(value) && reader.str(entry_point);
+        stage      = static_cast<VkShaderStageFlagBits>(value);
+
+        valid = valid && reader.count(count, 6 * sizeof(uint32_t));
+        for (uint32_t i = 0; valid && i < count; ++i)
+        {
+            ShaderBindingReflection binding;
+            valid        = reader.u32(binding.set) && reader.u32(binding.binding) && reader.u32(value) && reader.u32(binding.count) && reader.u32(binding.stages) && reader.str(binding.name);
+            binding.type = static_cast<VkDescriptorType>(value);
+            bindings.push_back(std::move(binding));
+        }
+
+        valid = valid && reader.count(count, 3 * sizeof(uint32_t));
+        for (uint32_t i = 0; valid && i < count; ++i)
+        {
+            ShaderInputReflection input;
+            valid        = reader.u32(input.location) && reader.u32(value) && reader.str(input.name);
+            input.format = static_cast<VkFormat>(value);
+            inputs.push_back(std::move(input));
+        }
+
+        valid = valid && reader.count(count, 3 * sizeof(uint32_t));
+        for (uint32_t i = 0; valid && i < count; ++i)
+        {
+            ShaderPushConstantReflection range;
+            valid = reader.u32(range.offset) && reader.u32(range.size) && reader.u32(range.stages);
+            push_constants.push_back(range);
+        }
+
+        valid = valid && reader.count(count, 4 * sizeof(uint32_t));
+        for (uint32_t i = 0; valid && i < count; ++i)
+        {
+            ShaderSpecializationReflection constant;
+            valid = reader.u32(constant.id) && reader.u32(constant.size) && reader.u32(constant.default_value) && reader.str(constant.name);
+            specialization_constants.push_back(std::move(constant));
+        }
+
+        for (uint32_t& group_size : workgroup_size)
+        {
+            valid = valid && reader.u32(group_size);
+        }
+
+        if (!valid || !reader.finished())
+        {
+            *this = {};
+            return false;
+        }
+        return true;
+    }
+
+    uint64_t DescriptorSetLayoutDesc::hash() const
+    {
+        // names and the set index do not change the layout object, a layout used at different sets is shared
+        uint64_t hash = hash_values({static_cast<uint32_t>(bindings.size())}, 0);
+        for (const auto& binding : bindings)
+        {
+            hash = hash_values({binding.binding, static_cast<uint32_t>(binding.type), binding.count, binding.stages}, hash);
+        }
+        return hash;
+    }
+
+    uint64_t PipelineLayoutDesc::hash() const
+    {
+        uint64_t hash = hash_values({static_cast<uint32_t>(sets.size()), static_cast<uint32_t>(push_constants.size())}, 0);
+        for (const auto& set : sets)
+        {
+            hash = Hash::hash_bytes(&hash, sizeof(hash), set.hash());
+        }
+        for (const auto& range : push_constants)
+        {
+            hash = hash_values({range.offset, range.size, range.stages}, hash);
+        }
+        return hash;
+    }
+
+    bool PipelineLayoutDesc::merge(const std::vector<const ShaderReflection*>& stages, PipelineLayoutDesc& layout)
+    {
+        layout = {};
+
+        bool valid = true;
+        for (const ShaderReflection* reflection : stages)
+        {
+            for (const auto& binding : reflection->bindings)
+            {
+                if (binding.set >= layout.sets.size())
+                {
+                    layout.sets.resize(binding.set + 1);
+                }
+
+                auto& set_bindings = layout.sets[binding.set].bindings;
+                auto  iter         = std::lower_bound(set_bindings.begin(), set_bindings.end(), binding.binding, [](const ShaderBindingReflection& item, uint32_t index) {
+                    return item.binding < index;
+                });
+
+                if (iter == set_bindings.end() || iter->binding != binding.binding)
+                {
+                    iter         = set_bindings.insert(iter, binding);
+                    iter->stages = reflection->stage;
+                }
+                else if (iter->type != binding.type || iter->count != binding.count)
+                {
+                    LOG_ERROR("set {} binding {} is declared as {} ({}) and as {} ({}) by different stages", binding.set, binding.binding, iter->name, static_cast<uint32_t>(iter->type), binding.name, static_cast<uint32_t>(binding.type));
+                    valid = false;
+                }
+                else
+                {
+                    iter->stages |= reflection->stage;
+                }
+            }
+
+            // glsl allows one push constant block per stage, stages share it by declaring the same block, so one
+            // range covering every block is what the layout needs
+            for (const auto& range : reflection->push_constants)
+            {
+                if (layout.push_constants.empty())
+                {
+                    layout.push_constants.push_back({range.offset, range.size, 0});
+                }
+
+                ShaderPushConstantReflection& merged = layout.push_constants[0];
+                const uint32_t                end    = std::max(merged.offset + merged.size, range.offset + range.size);
+                merged.offset                        = std::min(merged.offset, range.offset);
+                merged.size                          = end - merged.offset;
+                merged.stages |= reflection->stage;
+            }
+        }
+        return valid;
+    }
+} // namespace ArchViz
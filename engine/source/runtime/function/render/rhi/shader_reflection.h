@@ -0,0 +1,81 @@
+#pragma once
+#include <volk.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ArchViz
+{
+    struct ShaderBindingReflection
+    {
+        uint32_t           set {0};
+        uint32_t           binding {0};
+        VkDescriptorType   type {VK_DESCRIPTOR_TYPE_MAX_ENUM};
+        uint32_t           count {1}; // array size, 0 for a runtime sized (bindless) array
+        VkShaderStageFlags stages {0};
+        std::string        name;
+    };
+
+    struct ShaderInputReflection
+    {
+        uint32_t    location {0};
+        VkFormat    format {VK_FORMAT_UNDEFINED};
+        std::string name;
+    };
+
+    struct ShaderPushConstantReflection
+    {
+        uint32_t           offset {0};
+        uint32_t           size {0};
+        VkShaderStageFlags stages {0};
+    };
+
+    struct ShaderSpecializationReflection
+    {
+        uint32_t    id {0};
+        uint32_t    size {4};          // bytes, bool constants are passed as 32 bit
+        uint32_t    default_value {0}; // raw bits of the default
+        std::string name;
+    };
+
+    // everything a pipeline needs from one spir-v module, so pipelines are created without parsing it again
+    struct ShaderReflection
+    {
+        VkShaderStageFlagBits stage {VK_SHADER_STAGE_FLAG_BITS_MAX_ENUM};
+        std::string           entry_point;
+
+        std::vector<ShaderBindingReflection>        bindings; // sorted by set, then binding
+        std::vector<ShaderInputReflection>          inputs;   // vertex stage only, sorted by location, built-ins excluded
+        std::vector<ShaderPushConstantReflection>   push_constants;
+        std::vector<ShaderSpecializationReflection> specialization_constants; // sorted by id
+
+        uint32_t workgroup_size[3] {0, 0, 0}; // compute stage only
+
+        void                 serialize(std::vector<uint8_t>& output) const;
+        bool                 deserialize(const uint8_t* data, size_t size);
+        std::vector<uint8_t> serialize() const;
+    };
+
+    struct DescriptorSetLayoutDesc
+    {
+        std::vector<ShaderBindingReflection> bindings; // sorted by binding, the set member is ignored
+
+        bool empty() const { return bindings.empty(); }
+
+        // of what the layout object depends on (binding, type, count, stages), equal hashes share one VkDescriptorSetLayout
+        uint64_t hash() const;
+    };
+
+    struct PipelineLayoutDesc
+    {
+        std::vector<DescriptorSetLayoutDesc>      sets; // indexed by set number, unused sets in between are empty
+        std::vector<ShaderPushConstantReflection> push_constants;
+
+        uint64_t hash() const;
+
+        // one layout for all stages of a pipeline, a binding used by several stages gets all their stage bits;
+        // false when two stages declare the same binding differently
+        static bool merge(const std::vector<const ShaderReflection*>& stages, PipelineLayoutDesc& layout);
+    };
+} // namespace ArchViz
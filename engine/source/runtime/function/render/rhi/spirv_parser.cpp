@@ -4,6 +4,7 @@
 #include "runtime/core/math/math.h"
 
 #include <algorithm>
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -12,39 +13,185 @@ namespace ArchViz
     namespace SPIRV
     {
         static constexpr uint32_t k_bindless_texture_binding = 10;
+        static constexpr uint32_t k_bindless_binding_count   = 4; // textures, storage images, buffers, samplers
+        static constexpr uint32_t k_spirv_magic              = 0x07230203;
+        static constexpr uint32_t k_no_value                 = ~0u;
 
         struct Member
         {
-            uint32_t    id_index;
-            uint32_t    offset;
+            uint32_t    id_index {0};
+            uint32_t    offset {0};
+            uint32_t    matrix_stride {0};
             std::string name;
         };
 
         struct Id
         {
-            SpvOp    op;
-            uint32_t set;
-            uint32_t binding;
+            SpvOp    op {SpvOpMax};
+            uint32_t set {0};
+            uint32_t binding {0};
+            uint32_t location {k_no_value};
+            uint32_t spec_id {k_no_value};
+            uint32_t built_in {k_no_value};
+            bool     buffer_block {false};
 
             // For integers and floats
-            uint8_t width;
-            uint8_t sign;
+            uint8_t width {0};
+            uint8_t sign {0};
 
-            // For arrays, vectors and matrices
-            uint32_t type_index;
-            uint32_t count;
+            // For arrays, vectors, matrices and images; the result type of constants
+            uint32_t type_index {0};
+            uint32_t count {0}; // components, columns, or the id of the array length
+            uint32_t array_stride {0};
+
+            // For images
+            uint32_t dim {0};
+            uint32_t sampled {0};
 
             // For variables
-            SpvStorageClass storage_class;
+            SpvStorageClass storage_class {SpvStorageClassMax};
 
-            // For constants
-            uint32_t value;
+            // For constants, the low 32 bits
+            uint32_t value {0};
 
-            // For structs
+            // For structs, and the constituents of composite constants
             std::string         name;
             std::vector<Member> members;
         };
 
+        namespace
+        {
+            // literal strings are nul terminated and padded to whole words, never read past the instruction
+            std::string read_string(const std::vector<uint32_t>& data, size_t word_index, size_t end_index)
+            {
+                if (word_index >= end_index)
+                {
+                    return {};
+                }
+                const char* text = reinterpret_cast<const char*>(data.data() + word_index);
+                return std::string(text, strnlen(text, (end_index - word_index) * sizeof(uint32_t)));
+            }
+
+            Member& get_member(Id& id, uint32_t member_index)
+            {
+                if (member_index >= id.members.size())
+                {
+                    id.members.resize(member_index + 1);
+                }
+                return id.members[member_index];
+            }
+
+            uint32_t array_length(const std::vector<Id>& ids, const Id& array)
+            {
+                // the length is a constant id, a specialization constant length counts with its default
+                return array.count < ids.size() ? ids[array.count].value : 0;
+            }
+
+            // byte size of a type inside a block, as laid out by its offset and stride decorations
+            uint32_t type_size(const std::vector<Id>& ids, uint32_t type_index, uint32_t matrix_stride, uint32_t depth = 0)
+            {
+                if (type_index >= ids.size() || depth > 16)
+                {
+                    return 0;
+                }
+
+                const Id& type = ids[type_index];
+                switch (type.op)
+                {
+                    case (SpvOpTypeBool): {
+                        return 4;
+                    }
+                    case (SpvOpTypeInt):
+                    case (SpvOpTypeFloat): {
+                        return type.width / 8;
+                    }
+                    case (SpvOpTypeVector): {
+                        return type.count * type_size(ids, type.type_index, 0, depth + 1);
+                    }
+                    case (SpvOpTypeMatrix): {
+                        return type.count * (matrix_stride != 0 ? matrix_stride : type_size(ids, type.type_index, 0, depth + 1));
+                    }
+                    case (SpvOpTypeArray): {
+                        uint32_t stride = type.array_stride != 0 ? type.array_stride : type_size(ids, type.type_index, matrix_stride, depth + 1);
+                        return array_length(ids, type) * stride;
+                    }
+                    case (SpvOpTypeStruct): {
+                        uint32_t size = 0;
+                        for (const auto& member : type.members)
+                        {
+                            size = std::max(size, member.offset + type_size(ids, member.id_index, member.matrix_stride, depth + 1));
+                        }
+                        return size;
+                    }
+                }
+
+                // runtime arrays have no static size
+                return 0;
+            }
+
+            VkFormat input_format(const Id& component, uint32_t count)
+            {
+                static constexpr VkFormat k_float[4]  = {VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT};
+                static constexpr VkFormat k_sint[4]   = {VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT};
+                static constexpr VkFormat k_uint[4]   = {VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT};
+                static constexpr VkFormat k_double[4] = {VK_FORMAT_R64_SFLOAT, VK_FORMAT_R64G64_SFLOAT, VK_FORMAT_R64G64B64_SFLOAT, VK_FORMAT_R64G64B64A64_SFLOAT};
+                static constexpr VkFormat k_half[4]   = {VK_FORMAT_R16_SFLOAT, VK_FORMAT_R16G16_SFLOAT, VK_FORMAT_R16G16B16_SFLOAT, VK_FORMAT_R16G16B16A16_SFLOAT};
+
+                if (count == 0 || count > 4)
+                {
+                    return VK_FORMAT_UNDEFINED;
+                }
+
+                if (component.op == SpvOpTypeFloat)
+                {
+                    return component.width == 64 ? k_double[count - 1] : (component.width == 16 ? k_half[count - 1] : k_float[count - 1]);
+                }
+                if (component.op == SpvOpTypeInt && component.width == 32)
+                {
+                    return component.sign ? k_sint[count - 1] : k_uint[count - 1];
+                }
+                return VK_FORMAT_UNDEFINED;
+            }
+
+            VkDescriptorType descriptor_type(const std::vector<Id>& ids, const Id& variable, const Id& type)
+            {
+                switch (type.op)
+                {
+                    case (SpvOpTypeStruct): {
+                        // spir-v before 1.3 marks storage buffers as uniform blocks with BufferBlock
+                        if (variable.storage_class == SpvStorageClassStorageBuffer || type.buffer_block)
+                        {
+                            return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                        }
+                        return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+                    }
+                    case (SpvOpTypeSampledImage): {
+                        const bool texel_buffer = type.type_index < ids.size() && ids[type.type_index].dim == SpvDimBuffer;
+                        return texel_buffer ? VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+                    }
+                    case (SpvOpTypeImage): {
+                        // sampled 2 is an image used without a sampler, read and written by the shader
+                        if (type.dim == SpvDimBuffer)
+                        {
+                            return type.sampled == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+                        }
+                        if (type.dim == SpvDimSubpassData)
+                        {
+                            return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+                        }
+                        return type.sampled == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+                    }
+                    case (SpvOpTypeSampler): {
+                        return VK_DESCRIPTOR_TYPE_SAMPLER;
+                    }
+                    case (SpvOpTypeAccelerationStructureKHR): {
+                        return VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
+                    }
+                }
+                return VK_DESCRIPTOR_TYPE_MAX_ENUM;
+            }
+        } // namespace
+
         VkShaderStageFlags parse_execution_model(SpvExecutionModel model)
         {
             switch (model)
@@ -52,12 +199,19 @@ namespace ArchViz
                 case (SpvExecutionModelVertex): {
                     return VK_SHADER_STAGE_VERTEX_BIT;
                 }
+                case (SpvExecutionModelTessellationControl): {
+                    return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+                }
+                case (SpvExecutionModelTessellationEvaluation): {
+                    return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+                }
                 case (SpvExecutionModelGeometry): {
                     return VK_SHADER_STAGE_GEOMETRY_BIT;
                 }
                 case (SpvExecutionModelFragment): {
                     return VK_SHADER_STAGE_FRAGMENT_BIT;
                 }
+                case (SpvExecutionModelGLCompute):
                 case (SpvExecutionModelKernel): {
                     return VK_SHADER_STAGE_COMPUTE_BIT;
                 }
@@ -66,370 +220,488 @@ namespace ArchViz
             return 0;
         }
 
-        void parse_binary(const std::vector<uint32_t>& data, std::string& name_buffer, ParseResult& parse_result)
+        bool reflect(const std::vector<uint32_t>& data, ShaderReflection& reflection)
         {
-            uint32_t spv_word_count = safe_cast<uint32_t>(data.size());
-
-            uint32_t magic_number = data[0];
-            ASSERT(magic_number == 0x07230203);
+            reflection = {};
 
-            uint32_t id_bound = data[3];
+            if (data.size() < 5 || data[0] != k_spirv_magic)
+            {
+                LOG_ERROR("reflect spir-v: not a spir-v module");
+                return false;
+            }
 
-            std::vector<Id> ids;
-            ids.resize(id_bound);
+            const size_t   spv_word_count = data.size();
+            const uint32_t id_bound       = data[3];
 
-            memset(ids.data(), 0, id_bound * sizeof(Id));
+            std::vector<Id> ids(id_bound);
 
-            VkShaderStageFlags stage;
+            uint32_t entry_point_id = k_no_value;
+            uint32_t local_size_id[3] {k_no_value, k_no_value, k_no_value};
 
             size_t word_index = 5;
             while (word_index < spv_word_count)
             {
-                SpvOp    op         = (SpvOp)(data[word_index] & 0xFF);
+                SpvOp    op         = (SpvOp)(data[word_index] & 0xFFFF);
                 uint16_t word_count = (uint16_t)(data[word_index] >> 16);
 
-                switch (op)
+                if (word_count == 0 || word_index + word_count > spv_word_count)
                 {
+                    LOG_ERROR("reflect spir-v: instruction at word {} runs past the module", word_index);
+                    return false;
+                }
 
-                    case (SpvOpEntryPoint): {
-                        ASSERT(word_count >= 4);
-
-                        SpvExecutionModel model = (SpvExecutionModel)data[word_index + 1];
+                // the result id of every instruction handled below is one of its first three operands
+                const size_t end_index = word_index + word_count;
+                auto         id_at     = [&](size_t operand) -> Id* {
+                    if (word_index + operand >= end_index || data[word_index + operand] >= id_bound)
+                    {
+                        return nullptr;
+                    }
+                    return &ids[data[word_index + operand]];
+                };
 
-                        stage = parse_execution_model(model);
-                        ASSERT(stage != 0);
+                switch (op)
+                {
+                    case (SpvOpEntryPoint): {
+                        if (word_count >= 4 && entry_point_id == k_no_value)
+                        {
+                            reflection.stage       = (VkShaderStageFlagBits)parse_execution_model((SpvExecutionModel)data[word_index + 1]);
+                            entry_point_id         = data[word_index + 2];
+                            reflection.entry_point = read_string(data, word_index + 3, end_index);
+                        }
+                        else if (word_count >= 4)
+                        {
+                            LOG_WARN("reflect spir-v: module has several entry points, only {} is reflected", reflection.entry_point);
+                        }
+                        break;
+                    }
 
+                    case (SpvOpExecutionMode):
+                    case (SpvOpExecutionModeId): {
+                        if (word_count >= 6 && data[word_index + 1] == entry_point_id)
+                        {
+                            const uint32_t mode = data[word_index + 2];
+                            for (uint32_t i = 0; i < 3; ++i)
+                            {
+                                if (op == SpvOpExecutionMode && mode == SpvExecutionModeLocalSize)
+                                {
+                                    reflection.workgroup_size[i] = data[word_index + 3 + i];
+                                }
+                                else if (op == SpvOpExecutionModeId && mode == SpvExecutionModeLocalSizeId)
+                                {
+                                    local_size_id[i] = data[word_index + 3 + i];
+                                }
+                            }
+                        }
                         break;
                     }
 
                     case (SpvOpDecorate): {
-                        ASSERT(word_count >= 3);
-
-                        uint32_t id_index = data[word_index + 1];
-                        ASSERT(id_index < id_bound);
-
-                        Id& id = ids[id_index];
+                        Id* id = id_at(1);
+                        if (id == nullptr || word_count < 3)
+                        {
+                            break;
+                        }
 
-                        SpvDecoration decoration = (SpvDecoration)data[word_index + 2];
-                        switch (decoration)
+                        const uint32_t operand = word_count > 3 ? data[word_index + 3] : 0;
+                        switch ((SpvDecoration)data[word_index + 2])
                         {
                             case (SpvDecorationBinding): {
-                                id.binding = data[word_index + 3];
+                                id->binding = operand;
                                 break;
                             }
-
                             case (SpvDecorationDescriptorSet): {
-                                id.set = data[word_index + 3];
+                                id->set = operand;
+                                break;
+                            }
+                            case (SpvDecorationLocation): {
+                                id->location = operand;
+                                break;
+                            }
+                            case (SpvDecorationSpecId): {
+                                id->spec_id = operand;
+                                break;
+                            }
+                            case (SpvDecorationBuiltIn): {
+                                id->built_in = operand;
+                                break;
+                            }
+                            case (SpvDecorationBufferBlock): {
+                                id->buffer_block = true;
+                                break;
+                            }
+                            case (SpvDecorationArrayStride): {
+                                id->array_stride = operand;
                                 break;
                             }
                         }
-
                         break;
                     }
 
                     case (SpvOpMemberDecorate): {
-                        ASSERT(word_count >= 4);
-
-                        uint32_t id_index = data[word_index + 1];
-                        ASSERT(id_index < id_bound);
-
-                        Id& id = ids[id_index];
-
-                        uint32_t member_index = data[word_index + 2];
-
-                        if (id.members.size() == 0)
+                        Id* id = id_at(1);
+                        if (id == nullptr || word_count < 5)
                         {
-                            id.members.resize(64);
+                            break;
                         }
 
-                        Member& member = id.members[member_index];
-
-                        SpvDecoration decoration = (SpvDecoration)data[word_index + 3];
-                        switch (decoration)
+                        Member& member = get_member(*id, data[word_index + 2]);
+                        switch ((SpvDecoration)data[word_index + 3])
                         {
                             case (SpvDecorationOffset): {
                                 member.offset = data[word_index + 4];
                                 break;
                             }
+                            case (SpvDecorationMatrixStride): {
+                                member.matrix_stride = data[word_index + 4];
+                                break;
+                            }
+                            case (SpvDecorationBuiltIn): {
+                                // members of gl_PerVertex, the block itself counts as built in
+                                id->built_in = data[word_index + 4];
+                                break;
+                            }
                         }
-
                         break;
                     }
 
                     case (SpvOpName): {
-                        ASSERT(word_count >= 3);
-
-                        uint32_t id_index = data[word_index + 1];
-                        ASSERT(id_index < id_bound);
-
-                        Id& id = ids[id_index];
-
-                        char* name      = (char*)(data.data() + (word_index + 2));
-                        auto  name_view = name_buffer + name;
-                        id.name         = name_view;
-
+                        if (Id* id = id_at(1))
+                        {
+                            id->name = read_string(data, word_index + 2, end_index);
+                        }
                         break;
                     }
 
                     case (SpvOpMemberName): {
-                        ASSERT(word_count >= 4);
-
-                        uint32_t id_index = data[word_index + 1];
-                        ASSERT(id_index < id_bound);
-
-                        Id& id = ids[id_index];
-
-                        uint32_t member_index = data[word_index + 2];
-
-                        if (id.members.size() == 0)
+                        Id* id = id_at(1);
+                        if (id != nullptr && word_count >= 4)
                         {
-                            id.members.resize(64);
+                            get_member(*id, data[word_index + 2]).name = read_string(data, word_index + 3, end_index);
                         }
-
-                        Member& member = id.members[member_index];
-
-                        char* name      = (char*)(data.data() + (word_index + 3));
-                        auto  name_view = name_buffer + name;
-                        member.name     = name_view;
-
                         break;
                     }
 
-                    case (SpvOpTypeInt): {
-                        ASSERT(word_count == 4);
-
-                        uint32_t id_index = data[word_index + 1];
-                        ASSERT(id_index < id_bound);
-
-                        Id& id   = ids[id_index];
-                        id.op    = op;
-                        id.width = (uint8_t)data[word_index + 2];
-                        id.sign  = (uint8_t)data[word_index + 3];
-
+                    case (SpvOpTypeBool):
+                    case (SpvOpTypeSampler):
+                    case (SpvOpTypeAccelerationStructureKHR): {
+                        if (Id* id = id_at(1))
+                        {
+                            id->op = op;
+                        }
                         break;
                     }
 
+                    case (SpvOpTypeInt):
                     case (SpvOpTypeFloat): {
-                        ASSERT(word_count == 3);
-
-                        uint32_t id_index = data[word_index + 1];
-                        ASSERT(id_index < id_bound);
-
-                        Id& id   = ids[id_index];
-                        id.op    = op;
-                        id.width = (uint8_t)data[word_index + 2];
-
-                        break;
-                    }
-
-                    case (SpvOpTypeVector): {
-                        ASSERT(word_count == 4);
-
-                        uint32_t id_index = data[word_index + 1];
-                        ASSERT(id_index < id_bound);
-
-                        Id& id        = ids[id_index];
-                        id.op         = op;
-                        id.type_index = data[word_index + 2];
-                        id.count      = data[word_index + 3];
-
+                        Id* id = id_at(1);
+                        if (id != nullptr && word_count >= 3)
+                        {
+                            id->op    = op;
+                            id->width = (uint8_t)data[word_index + 2];
+                            id->sign  = op == SpvOpTypeInt && word_count >= 4 ? (uint8_t)data[word_index + 3] : 1;
+                        }
                         break;
                     }
 
-                    case (SpvOpTypeMatrix): {
-                        ASSERT(word_count == 4);
-
-                        uint32_t id_index = data[word_index + 1];
-                        ASSERT(id_index < id_bound);
-
-                        Id& id        = ids[id_index];
-                        id.op         = op;
-                        id.type_index = data[word_index + 2];
-                        id.count      = data[word_index + 3];
-
+                    case (SpvOpTypeVector):
+                    case (SpvOpTypeMatrix):
+                    case (SpvOpTypeArray): {
+                        Id* id = id_at(1);
+                        if (id != nullptr && word_count == 4)
+                        {
+                            id->op         = op;
+                            id->type_index = data[word_index + 2];
+                            id->count      = data[word_index + 3];
+                        }
                         break;
                     }
 
                     case (SpvOpTypeImage): {
-                        // NOTE(marco): not sure we need this information just yet
-                        ASSERT(word_count >= 9);
-
+                        Id* id = id_at(1);
+                        if (id != nullptr && word_count >= 9)
+                        {
+                            id->op         = op;
+                            id->type_index = data[word_index + 2];
+                            id->dim        = data[word_index + 3];
+                            id->sampled    = data[word_index + 7];
+                        }
                         break;
                     }
 
-                    case (SpvOpTypeSampler): {
-                        ASSERT(word_count == 2);
-
-                        uint32_t id_index = data[word_index + 1];
-                        ASSERT(id_index < id_bound);
-
-                        Id& id = ids[id_index];
-                        id.op  = op;
-
+                    case (SpvOpTypeSampledImage):
+                    case (SpvOpTypeRuntimeArray): {
+                        Id* id = id_at(1);
+                        if (id != nullptr && word_count == 3)
+                        {
+                            id->op         = op;
+                            id->type_index = data[word_index + 2];
+                        }
                         break;
                     }
 
-                    case (SpvOpTypeSampledImage): {
-                        ASSERT(word_count == 3);
-
-                        uint32_t id_index = data[word_index + 1];
-                        ASSERT(id_index < id_bound);
-
-                        Id& id = ids[id_index];
-                        id.op  = op;
-
+                    case (SpvOpTypeStruct): {
+                        if (Id* id = id_at(1))
+                        {
+                            id->op = op;
+                            for (uint32_t member_index = 0; member_index + 2u < word_count; ++member_index)
+                            {
+                                get_member(*id, member_index).id_index = data[word_index + member_index + 2];
+                            }
+                        }
                         break;
                     }
 
-                    case (SpvOpTypeArray): {
-                        ASSERT(word_count == 4);
-
-                        uint32_t id_index = data[word_index + 1];
-                        ASSERT(id_index < id_bound);
-
-                        Id& id        = ids[id_index];
-                        id.op         = op;
-                        id.type_index = data[word_index + 2];
-                        id.count      = data[word_index + 3];
-
+                    case (SpvOpTypePointer): {
+                        Id* id = id_at(1);
+                        if (id != nullptr && word_count == 4)
+                        {
+                            id->op            = op;
+                            id->storage_class = (SpvStorageClass)data[word_index + 2];
+                            id->type_index    = data[word_index + 3];
+                        }
                         break;
                     }
 
-                    case (SpvOpTypeRuntimeArray): {
-                        ASSERT(word_count == 3);
-
-                        uint32_t id_index = data[word_index + 1];
-                        ASSERT(id_index < id_bound);
-
-                        Id& id        = ids[id_index];
-                        id.op         = op;
-                        id.type_index = data[word_index + 2];
-
+                    case (SpvOpConstant):
+                    case (SpvOpSpecConstant):
+                    case (SpvOpConstantTrue):
+                    case (SpvOpConstantFalse):
+                    case (SpvOpSpecConstantTrue):
+                    case (SpvOpSpecConstantFalse): {
+                        Id* id = id_at(2);
+                        if (id != nullptr)
+                        {
+                            id->op         = op;
+                            id->type_index = data[word_index + 1];
+                            if (op == SpvOpConstant || op == SpvOpSpecConstant)
+                            {
+                                // constants wider than 32 bit keep their low word, enough for lengths and sizes
+                                id->value = word_count >= 4 ? data[word_index + 3] : 0;
+                            }
+                            else
+                            {
+                                id->value = op == SpvOpConstantTrue || op == SpvOpSpecConstantTrue ? 1 : 0;
+                            }
+                        }
                         break;
                     }
 
-                    case (SpvOpTypeStruct): {
-                        ASSERT(word_count >= 2);
-
-                        uint32_t id_index = data[word_index + 1];
-                        ASSERT(id_index < id_bound);
-
-                        Id& id = ids[id_index];
-                        id.op  = op;
-
-                        if (word_count > 2)
+                    case (SpvOpConstantComposite):
+                    case (SpvOpSpecConstantComposite): {
+                        Id* id = id_at(2);
+                        if (id != nullptr)
                         {
-                            for (uint16_t member_index = 0; member_index < word_count - 2; ++member_index)
+                            id->op         = op;
+                            id->type_index = data[word_index + 1];
+                            for (uint32_t member_index = 0; member_index + 3u < word_count; ++member_index)
                             {
-                                id.members[member_index].id_index = data[word_index + member_index + 2];
+                                get_member(*id, member_index).id_index = data[word_index + member_index + 3];
                             }
                         }
+                        break;
+                    }
 
+                    case (SpvOpVariable): {
+                        Id* id = id_at(2);
+                        if (id != nullptr && word_count >= 4)
+                        {
+                            id->op            = op;
+                            id->type_index    = data[word_index + 1];
+                            id->storage_class = (SpvStorageClass)data[word_index + 3];
+                        }
                         break;
                     }
+                }
 
-                    case (SpvOpTypePointer): {
-                        ASSERT(word_count == 4);
+                word_index += word_count;
+            }
 
-                        uint32_t id_index = data[word_index + 1];
-                        ASSERT(id_index < id_bound);
+            if (reflection.stage == VK_SHADER_STAGE_FLAG_BITS_MAX_ENUM || reflection.stage == 0)
+            {
+                LOG_ERROR("reflect spir-v: no supported entry point");
+                reflection = {};
+                return false;
+            }
 
-                        Id& id        = ids[id_index];
-                        id.op         = op;
-                        id.type_index = data[word_index + 3];
+            auto constant_value = [&](uint32_t id_index) { return id_index < id_bound ? ids[id_index].value : 0; };
 
-                        break;
+            for (uint32_t i = 0; i < 3; ++i)
+            {
+                if (local_size_id[i] != k_no_value)
+                {
+                    reflection.workgroup_size[i] = constant_value(local_size_id[i]);
+                }
+            }
+
+            for (uint32_t id_index = 0; id_index < id_bound; ++id_index)
+            {
+                const Id& id = ids[id_index];
+
+                // a WorkgroupSize constant wins over the execution mode
+                if ((id.op == SpvOpConstantComposite || id.op == SpvOpSpecConstantComposite) && id.built_in == SpvBuiltInWorkgroupSize && id.members.size() == 3)
+                {
+                    for (uint32_t i = 0; i < 3; ++i)
+                    {
+                        reflection.workgroup_size[i] = constant_value(id.members[i].id_index);
                     }
+                    continue;
+                }
 
-                    case (SpvOpConstant): {
-                        ASSERT(word_count >= 4);
+                if ((id.op == SpvOpSpecConstant || id.op == SpvOpSpecConstantTrue || id.op == SpvOpSpecConstantFalse) && id.spec_id != k_no_value)
+                {
+                    ShaderSpecializationReflection constant;
+                    constant.id            = id.spec_id;
+                    constant.default_value = id.value;
+                    constant.name          = id.name;
+                    if (id.op == SpvOpSpecConstant)
+                    {
+                        constant.size = std::max(4u, type_size(ids, id.type_index, 0));
+                    }
+                    reflection.specialization_constants.push_back(std::move(constant));
+                    continue;
+                }
 
-                        uint32_t id_index = data[word_index + 1];
-                        ASSERT(id_index < id_bound);
+                if (id.op != SpvOpVariable || id.type_index >= id_bound)
+                {
+                    continue;
+                }
 
-                        Id& id        = ids[id_index];
-                        id.op         = op;
-                        id.type_index = data[word_index + 2];
-                        id.value      = data[word_index + 3]; // NOTE(marco): we assume all constants to have maximum 32bit width
+                // variables are pointers, the pointee is the actual type
+                const uint32_t pointee_index = ids[id.type_index].type_index;
+                if (pointee_index >= id_bound)
+                {
+                    continue;
+                }
+                const Id& pointee = ids[pointee_index];
+
+                switch (id.storage_class)
+                {
+                    case (SpvStorageClassUniform):
+                    case (SpvStorageClassUniformConstant):
+                    case (SpvStorageClassStorageBuffer): {
+                        ShaderBindingReflection binding;
+                        binding.set     = id.set;
+                        binding.binding = id.binding;
+                        binding.stages  = reflection.stage;
+
+                        // arrays of resources are one binding with a descriptor count, a runtime array is bindless
+                        const Id* type = &pointee;
+                        if (type->op == SpvOpTypeArray)
+                        {
+                            binding.count = array_length(ids, *type);
+                            type          = type->type_index < id_bound ? &ids[type->type_index] : type;
+                        }
+                        else if (type->op == SpvOpTypeRuntimeArray)
+                        {
+                            binding.count = 0;
+                            type          = type->type_index < id_bound ? &ids[type->type_index] : type;
+                        }
 
+                        binding.type = descriptor_type(ids, id, *type);
+                        binding.name = type->op == SpvOpTypeStruct && !type->name.empty() ? type->name : id.name;
+                        if (binding.type == VK_DESCRIPTOR_TYPE_MAX_ENUM)
+                        {
+                            LOG_WARN("reflect spir-v: {} at set {} binding {} has no descriptor type", binding.name, binding.set, binding.binding);
+                            break;
+                        }
+                        reflection.bindings.push_back(std::move(binding));
                         break;
                     }
 
-                    case (SpvOpVariable): {
-                        ASSERT(word_count >= 4);
+                    case (SpvStorageClassPushConstant): {
+                        // one range from the first to the end of the last member, blocks may start at an offset
+                        // when another stage declares the members before them
+                        uint32_t offset = k_no_value;
+                        for (const auto& member : pointee.members)
+                        {
+                            offset = std::min(offset, member.offset);
+                        }
+                        const uint32_t size = type_size(ids, pointee_index, 0);
+                        if (offset != k_no_value && size > offset)
+                        {
+                            reflection.push_constants.push_back({offset, size - offset, static_cast<VkShaderStageFlags>(reflection.stage)});
+                        }
+                        break;
+                    }
 
-                        uint32_t id_index = data[word_index + 2];
-                        ASSERT(id_index < id_bound);
+                    case (SpvStorageClassInput): {
+                        if (reflection.stage != VK_SHADER_STAGE_VERTEX_BIT || id.built_in != k_no_value || pointee.built_in != k_no_value || id.location == k_no_value)
+                        {
+                            break;
+                        }
 
-                        Id& id           = ids[id_index];
-                        id.op            = op;
-                        id.type_index    = data[word_index + 1];
-                        id.storage_class = (SpvStorageClass)data[word_index + 3];
+                        // a matrix input takes one location per column
+                        uint32_t  columns = 1;
+                        const Id* vector  = &pointee;
+                        if (pointee.op == SpvOpTypeMatrix && pointee.type_index < id_bound)
+                        {
+                            columns = pointee.count;
+                            vector  = &ids[pointee.type_index];
+                        }
 
+                        const bool      is_vector = vector->op == SpvOpTypeVector && vector->type_index < id_bound;
+                        const Id&       component = is_vector ? ids[vector->type_index] : *vector;
+                        const VkFormat  format    = input_format(component, is_vector ? vector->count : 1);
+                        for (uint32_t column = 0; column < columns; ++column)
+                        {
+                            reflection.inputs.push_back({id.location + column, format, id.name});
+                        }
                         break;
                     }
                 }
+            }
 
-                word_index += word_count;
+            std::sort(reflection.bindings.begin(), reflection.bindings.end(), [](const ShaderBindingReflection& a, const ShaderBindingReflection& b) {
+                return a.set != b.set ? a.set < b.set : a.binding < b.binding;
+            });
+            std::sort(reflection.inputs.begin(), reflection.inputs.end(), [](const ShaderInputReflection& a, const ShaderInputReflection& b) { return a.location < b.location; });
+            std::sort(reflection.specialization_constants.begin(), reflection.specialization_constants.end(), [](const ShaderSpecializationReflection& a, const ShaderSpecializationReflection& b) {
+                return a.id < b.id;
+            });
+            return true;
+        }
+
+        void parse_binary(const std::vector<uint32_t>& data, std::string& name_buffer, ParseResult& parse_result)
+        {
+            ShaderReflection reflection;
+            if (!reflect(data, reflection))
+            {
+                return;
             }
 
             LOG_DEBUG("");
             LOG_DEBUG("SPRIV parse result: ");
 
-            for (uint32_t id_index = 0; id_index < ids.size(); ++id_index)
+            for (const auto& binding : reflection.bindings)
             {
-                Id& id = ids[id_index];
-
-                if (id.op == SpvOpVariable)
+                if (binding.set == 1 && binding.binding >= k_bindless_texture_binding && binding.binding < k_bindless_texture_binding + k_bindless_binding_count)
                 {
-                    switch (id.storage_class)
-                    {
-                        case (SpvStorageClassUniform):
-                        case (SpvStorageClassUniformConstant): {
-                            if (id.set == 1 && (id.binding == k_bindless_texture_binding || id.binding == (k_bindless_texture_binding + 1)))
-                            {
-                                // NOTE(marco): these are managed by the GPU device
-                                continue;
-                            }
-
-                            // NOTE(marco): get actual type
-                            Id& uniform_type = ids[ids[id.type_index].type_index];
-
-                            DescriptorSetLayoutCreation& setLayout = parse_result.sets[id.set];
-                            setLayout.setSetIndex(id.set);
-
-                            DescriptorSetLayoutCreation::Binding binding {};
-                            binding.start = id.binding;
-                            binding.count = 1;
+                    // NOTE(marco): these are managed by the GPU device
+                    continue;
+                }
 
-                            switch (uniform_type.op)
-                            {
-                                case (SpvOpTypeStruct): {
-                                    binding.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-                                    binding.name = uniform_type.name.c_str();
-                                    break;
-                                }
+                if (binding.set >= MAX_SET_COUNT || binding.binding >= k_max_descriptors_per_set)
+                {
+                    LOG_WARN("SPRIV parse: set {} binding {} does not fit a DescriptorSetLayoutCreation, use SPIRV::reflect", binding.set, binding.binding);
+                    continue;
+                }
 
-                                case (SpvOpTypeSampledImage): {
-                                    binding.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-                                    binding.name = id.name.c_str();
-                                    break;
-                                }
-                            }
+                DescriptorSetLayoutCreation& setLayout = parse_result.sets[binding.set];
+                setLayout.setSetIndex(binding.set);
 
-                            setLayout.addBindingAtIndex(binding, id.binding);
+                DescriptorSetLayoutCreation::Binding layout_binding {};
+                layout_binding.type  = binding.type;
+                layout_binding.start = (uint16_t)binding.binding;
+                layout_binding.count = (uint16_t)std::max(binding.count, 1u);
+                layout_binding.name  = binding.name;
 
-                            parse_result.set_count = std::max(parse_result.set_count, (id.set + 1));
+                setLayout.addBindingAtIndex(layout_binding, binding.binding);
 
-                            LOG_DEBUG("\t binding: name: {}, start: {}, count: {}", binding.name, binding.start, binding.count);
+                parse_result.set_count = std::max(parse_result.set_count, (binding.set + 1));
 
-                            break;
-                        }
-                    }
-                }
-                id.members.clear();
+                LOG_DEBUG("\t binding: name: {}, start: {}, count: {}", layout_binding.name, layout_binding.start, layout_binding.count);
             }
-            ids.clear();
 
             LOG_DEBUG("SPRIV parse finish");
         }
@@ -1,6 +1,7 @@
 // https://github.com/KhronosGroup/SPIRV-Reflect
 #pragma once
 #include "runtime/function/render/rhi/gpu_resources.h"
+#include "runtime/function/render/rhi/shader_reflection.h"
 
 #include <volk.h>
 
@@ -24,6 +25,11 @@ namespace ArchViz
 
         VkShaderStageFlags parse_execution_model(SpvExecutionModel model);
 
+        // stage, entry point, descriptor bindings of every set, vertex inputs, push constants, specialization constants
+        // and workgroup size; false when the module is malformed or has no entry point
+        bool reflect(const std::vector<uint32_t>& data, ShaderReflection& reflection);
+
+        // descriptor sets only, kept for callers of the old parser; the bindless set 1 bindings 10 to 13 are skipped
         void parse_binary(const std::vector<uint32_t>& data, std::string& name_buffer, ParseResult& parse_result);
     } // namespace SPIRV
 } // namespace ArchViz
@@ -0,0 +1,82 @@
+#include "runtime/function/render/rhi/staging_ring.h"
+
+#include "runtime/core/base/macro.h"
+
+#include <algorithm>
+
+namespace ArchViz
+{
+    void StagingRing::initialize(uint64_t capacity)
+    {
+        ASSERT(capacity > 0);
+        clear();
+        m_capacity = capacity;
+    }
+
+    void StagingRing::clear()
+    {
+        m_capacity     = 0;
+        m_head         = 0;
+        m_tail         = 0;
+        m_retired_head = 0;
+        m_retired.clear();
+        m_statistics = {};
+    }
+
+    uint64_t StagingRing::allocate(uint64_t size, uint64_t alignment)
+    {
+        ASSERT(alignment > 0);
+        if (size == 0 || size > m_capacity)
+        {
+            return k_invalid_offset;
+        }
+
+        const uint64_t offset  = m_head % m_capacity;
+        const uint64_t aligned = (offset + alignment - 1) / alignment * alignment;
+
+        // a range never wraps around the end, the rest of the ring is skipped and the range starts at offset 0
+        uint64_t start = m_head + (aligned - offset);
+        if (aligned + size > m_capacity)
+        {
+            start = m_head + (m_capacity - offset);
+        }
+
+        if (start + size - m_tail > m_capacity)
+        {
+            m_statistics.full += 1;
+            return k_invalid_offset;
+        }
+
+        m_statistics.allocations += 1;
+        m_statistics.bytes += size;
+        if (aligned + size > m_capacity)
+        {
+            m_statistics.wrapped_bytes += m_capacity - offset;
+        }
+
+        m_head                 = start + size;
+        m_statistics.peak_used = std::max(m_statistics.peak_used, used());
+        return start % m_capacity;
+    }
+
+    void StagingRing::retire(uint64_t token)
+    {
+        if (idle())
+        {
+            return;
+        }
+
+        ASSERT(m_retired.empty() || m_retired.back().token <= token);
+        m_retired.push_back({token, m_head});
+        m_retired_head = m_head;
+    }
+
+    void StagingRing::reclaim(uint64_t completed)
+    {
+        while (!m_retired.empty() && m_retired.front().token <= completed)
+        {
+            m_tail = m_retired.front().head;
+            m_retired.pop_front();
+        }
+    }
+} // namespace ArchViz
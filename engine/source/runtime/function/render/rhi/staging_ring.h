@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+
+namespace ArchViz
+{
+    struct StagingRingStatistics
+    {
+        uint64_t allocations {0};
+        uint64_t bytes {0};
+        uint64_t wrapped_bytes {0}; // left unused at the end of the ring when an allocation did not fit there
+        uint64_t full {0};          // allocations refused until older batches complete
+        uint64_t peak_used {0};
+    };
+
+    // the byte ranges of a persistently mapped staging buffer, handed out in order and given back a whole batch at a time.
+    // Positions only grow, the offset in the buffer is the position modulo the capacity. Everything allocated before
+    // retire(token) is reused once reclaim sees a completed token at least that large, so a batch is never overwritten
+    // while the gpu still copies from it.
+    class StagingRing
+    {
+    public:
+        static constexpr uint64_t k_invalid_offset = ~0ull;
+
+        void initialize(uint64_t capacity);
+        void clear();
+
+        // the offset in the buffer, k_invalid_offset when the ring has no room until older batches complete
+        uint64_t allocate(uint64_t size, uint64_t alignment);
+
+        // closes the ranges allocated since the last retire, they belong to the batch that signals token
+        void retire(uint64_t token);
+        // gives back every retired batch with a token up to completed
+        void reclaim(uint64_t completed);
+
+        uint64_t capacity() const { return m_capacity; }
+        uint64_t used() const { return m_head - m_tail; }
+        // nothing allocated since the last retire
+        bool idle() const { return m_head == m_retired_head; }
+
+        const StagingRingStatistics& getStatistics() const { return m_statistics; }
+
+    private:
+        struct Retired
+        {
+            uint64_t token {0};
+            uint64_t head {0}; // the position everything up to is free once token completes
+        };
+
+        uint64_t m_capacity {0};
+        uint64_t m_head {0}; // next free position
+        uint64_t m_tail {0}; // oldest position still in use
+        uint64_t m_retired_head {0};
+
+        std::deque<Retired> m_retired;
+
+        StagingRingStatistics m_statistics;
+    };
+} // namespace ArchViz
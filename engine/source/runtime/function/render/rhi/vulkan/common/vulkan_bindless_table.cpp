@@ -0,0 +1,246 @@
+#include "runtime/function/render/rhi/vulkan/common/vulkan_bindless_table.h"
+#include "runtime/function/render/rhi/vulkan/common/vulkan_device.h"
+#include "runtime/function/render/rhi/vulkan/common/vulkan_layout_cache.h"
+
+#include "runtime/core/base/macro.h"
+
+#include <algorithm>
+
+namespace ArchViz
+{
+    namespace
+    {
+        struct BindlessBinding
+        {
+            uint32_t         binding;
+            VkDescriptorType type;
+        };
+
+        // indexed by BindlessResourceType
+        constexpr std::array<BindlessBinding, 4> k_bindless_bindings = {{
+            {VulkanConstants::k_bindless_texture_binding, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER},
+            {VulkanConstants::k_bindless_storage_image_binding, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE},
+            {VulkanConstants::k_bindless_buffer_binding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER},
+            {VulkanConstants::k_bindless_sampler_binding, VK_DESCRIPTOR_TYPE_SAMPLER},
+        }};
+
+        const char* bindless_type_name(size_t type)
+        {
+            static const char* names[] = {"textures", "storage images", "buffers", "samplers"};
+            return names[type];
+        }
+    } // namespace
+
+    void VulkanBindlessTable::initialize()
+    {
+        ASSERT(m_device && m_layout_cache);
+        ASSERT(m_device->m_bindless_support);
+
+        m_layout_desc.bindings.clear();
+        for (const BindlessBinding& bindless : k_bindless_bindings)
+        {
+            ShaderBindingReflection binding;
+            binding.binding = bindless.binding;
+            binding.type    = bindless.type;
+            binding.count   = 0;
+            binding.stages  = VK_SHADER_STAGE_ALL;
+            m_layout_desc.bindings.push_back(binding);
+        }
+
+        // pipelines declaring any of these arrays get this layout from the cache, so the set is compatible with all of them
+        m_layout_cache->setBindlessLayout(m_layout_desc);
+        m_set_layout = m_layout_cache->getDescriptorSetLayout(m_layout_desc);
+        if (m_set_layout == VK_NULL_HANDLE)
+        {
+            LOG_FATAL("failed to create bindless descriptor set layout!");
+        }
+
+        std::array<VkDescriptorPoolSize, k_type_count> pool_sizes {};
+        for (size_t type = 0; type < k_type_count; ++type)
+        {
+            pool_sizes[type].type            = k_bindless_bindings[type].type;
+            pool_sizes[type].descriptorCount = VulkanConstants::k_max_bindless_resources;
+        }
+
+        VkDescriptorPoolCreateInfo pool_info {};
+        pool_info.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        pool_info.flags         = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+        pool_info.poolSizeCount = static_cast<uint32_t>(pool_sizes.size());
+        pool_info.pPoolSizes    = pool_sizes.data();
+        pool_info.maxSets       = 1;
+
+        if (vkCreateDescriptorPool(m_device->m_device, &pool_info, nullptr, &m_pool) != VK_SUCCESS)
+        {
+            LOG_FATAL("failed to create bindless descriptor pool!");
+        }
+
+        VkDescriptorSetAllocateInfo alloc_info {};
+        alloc_info.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        alloc_info.descriptorPool     = m_pool;
+        alloc_info.descriptorSetCount = 1;
+        alloc_info.pSetLayouts        = &m_set_layout;
+
+        if (vkAllocateDescriptorSets(m_device->m_device, &alloc_info, &m_set) != VK_SUCCESS)
+        {
+            LOG_FATAL("failed to allocate bindless descriptor set!");
+        }
+
+        for (BindlessIndexAllocator& allocator : m_allocators)
+        {
+            allocator.initialize(VulkanConstants::k_max_bindless_resources, VulkanConstants::k_max_frames_in_flight);
+        }
+        m_writes.clear();
+        m_statistics = {};
+    }
+
+    void VulkanBindlessTable::clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // the set goes with its pool, the layout belongs to the layout cache
+        vkDestroyDescriptorPool(m_device->m_device, m_pool, nullptr);
+        m_pool       = VK_NULL_HANDLE;
+        m_set        = VK_NULL_HANDLE;
+        m_set_layout = VK_NULL_HANDLE;
+
+        for (BindlessIndexAllocator& allocator : m_allocators)
+        {
+            allocator.clear();
+        }
+        m_writes.clear();
+    }
+
+    uint32_t VulkanBindlessTable::addTexture(VkImageView view, VkSampler sampler, VkImageLayout layout)
+    {
+        Write write;
+        write.image.imageView   = view;
+        write.image.sampler     = sampler;
+        write.image.imageLayout = layout;
+        return add(BindlessResourceType::Texture, write);
+    }
+
+    uint32_t VulkanBindlessTable::addStorageImage(VkImageView view)
+    {
+        Write write;
+        write.image.imageView   = view;
+        write.image.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        return add(BindlessResourceType::StorageImage, write);
+    }
+
+    uint32_t VulkanBindlessTable::addBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range)
+    {
+        Write write;
+        write.buffer.buffer = buffer;
+        write.buffer.offset = offset;
+        write.buffer.range  = range;
+        return add(BindlessResourceType::Buffer, write);
+    }
+
+    uint32_t VulkanBindlessTable::addSampler(VkSampler sampler)
+    {
+        Write write;
+        write.image.sampler = sampler;
+        return add(BindlessResourceType::Sampler, write);
+    }
+
+    uint32_t VulkanBindlessTable::add(BindlessResourceType type, const Write& write)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        const size_t   slot  = static_cast<size_t>(type);
+        const uint32_t index = m_allocators[slot].allocate();
+        if (index == k_invalid_index)
+        {
+            LOG_ERROR("[vulkan] bindless table: all {} {} indices are in use", VulkanConstants::k_max_bindless_resources, bindless_type_name(slot));
+            return k_invalid_index;
+        }
+
+        m_writes.push_back(write);
+        m_writes.back().type  = type;
+        m_writes.back().index = index;
+        return index;
+    }
+
+    void VulkanBindlessTable::release(BindlessResourceType type, uint32_t index)
+    {
+        if (index == k_invalid_index)
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_allocators[static_cast<size_t>(type)].free(index);
+
+        // a write still queued would point the descriptor at a resource that is about to be destroyed
+        const size_t queued = m_writes.size();
+        m_writes.erase(std::remove_if(m_writes.begin(), m_writes.end(), [type, index](const Write& write) { return write.type == type && write.index == index; }), m_writes.end());
+        m_statistics.dropped += queued - m_writes.size();
+    }
+
+    void VulkanBindlessTable::beginFrame()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        for (BindlessIndexAllocator& allocator : m_allocators)
+        {
+            allocator.advance();
+        }
+    }
+
+    void VulkanBindlessTable::flush()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (m_writes.empty())
+        {
+            return;
+        }
+
+        std::vector<VkWriteDescriptorSet> descriptor_writes(m_writes.size());
+        for (size_t i = 0; i < m_writes.size(); ++i)
+        {
+            const Write&           write    = m_writes[i];
+            const BindlessBinding& bindless = k_bindless_bindings[static_cast<size_t>(write.type)];
+
+            VkWriteDescriptorSet& descriptor_write = descriptor_writes[i];
+            descriptor_write.sType                 = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptor_write.dstSet                = m_set;
+            descriptor_write.dstBinding            = bindless.binding;
+            descriptor_write.dstArrayElement       = write.index;
+            descriptor_write.descriptorCount       = 1;
+            descriptor_write.descriptorType        = bindless.type;
+            if (write.type == BindlessResourceType::Buffer)
+            {
+                descriptor_write.pBufferInfo = &write.buffer;
+            }
+            else
+            {
+                descriptor_write.pImageInfo = &write.image;
+            }
+        }
+
+        vkUpdateDescriptorSets(m_device->m_device, static_cast<uint32_t>(descriptor_writes.size()), descriptor_writes.data(), 0, nullptr);
+
+        m_statistics.writes += m_writes.size();
+        m_statistics.updates += 1;
+        m_writes.clear();
+    }
+
+    void VulkanBindlessTable::bind(VkCommandBuffer command_buffer, VkPipelineBindPoint bind_point, VkPipelineLayout layout, uint32_t set) const
+    {
+        vkCmdBindDescriptorSets(command_buffer, bind_point, layout, set, 1, &m_set, 0, nullptr);
+    }
+
+    void VulkanBindlessTable::logStatistics() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        LOG_INFO("[vulkan] bindless table: {} descriptors written in {} updates, {} writes dropped", m_statistics.writes, m_statistics.updates, m_statistics.dropped);
+        for (size_t type = 0; type < k_type_count; ++type)
+        {
+            const BindlessIndexAllocator& allocator = m_allocators[type];
+            LOG_INFO("[vulkan]     {}: {} in use, peak {} of {}, {} waiting for their frame", bindless_type_name(type), allocator.allocated(), allocator.getStatistics().peak, allocator.capacity(), allocator.pending());
+        }
+    }
+} // namespace ArchViz
@@ -0,0 +1,109 @@
+#pragma once
+#include "runtime/function/render/rhi/bindless_index_allocator.h"
+#include "runtime/function/render/rhi/shader_reflection.h"
+#include "runtime/function/render/rhi/vulkan/vulkan_struct.h"
+
+#include <volk.h>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ArchViz
+{
+    class VulkanDevice;
+    class VulkanLayoutCache;
+
+    enum class BindlessResourceType : uint8_t
+    {
+        Texture,      // combined image sampler, binding k_bindless_texture_binding
+        StorageImage, // binding k_bindless_storage_image_binding
+        Buffer,       // storage buffer, binding k_bindless_buffer_binding
+        Sampler,      // binding k_bindless_sampler_binding
+        Count,
+    };
+
+    // what a draw pushes instead of binding a material descriptor set, the bindless texture index of each MaterialData slot
+    struct BindlessMaterial
+    {
+        uint32_t base_colour {BindlessIndexAllocator::k_invalid_index};
+        uint32_t metallic_roughness {BindlessIndexAllocator::k_invalid_index};
+        uint32_t normal {BindlessIndexAllocator::k_invalid_index};
+        uint32_t occlusion {BindlessIndexAllocator::k_invalid_index};
+        uint32_t emissive {BindlessIndexAllocator::k_invalid_index};
+    };
+
+    struct BindlessTableStatistics
+    {
+        uint64_t writes {0};  // descriptors written
+        uint64_t updates {0}; // vkUpdateDescriptorSets calls, at most one a frame
+        uint64_t dropped {0}; // writes of indices released before they were flushed
+    };
+
+    // one update after bind descriptor set holding every texture, storage image, buffer and sampler of the renderer in
+    // runtime arrays of k_max_bindless_resources. A resource keeps the index it was added with until it is released,
+    // shaders find it through that index and nothing is bound per draw. Adding is thread safe, the writes are queued and
+    // go out with a single vkUpdateDescriptorSets in flush. Released indices are reused after k_max_frames_in_flight frames.
+    class VulkanBindlessTable
+    {
+    public:
+        static constexpr uint32_t k_invalid_index = BindlessIndexAllocator::k_invalid_index;
+
+        void initialize();
+        void clear();
+
+        // k_invalid_index when the array is full
+        uint32_t addTexture(VkImageView view, VkSampler sampler, VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        uint32_t addStorageImage(VkImageView view);
+        uint32_t addBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+        uint32_t addSampler(VkSampler sampler);
+
+        // the resource may be destroyed once the frames recorded so far completed
+        void release(BindlessResourceType type, uint32_t index);
+
+        // once a frame after the frame fence wait, hands out again what was released k_max_frames_in_flight frames ago
+        void beginFrame();
+        // writes everything queued since the last flush, before the command buffers of the frame are recorded
+        void flush();
+
+        void bind(VkCommandBuffer command_buffer, VkPipelineBindPoint bind_point, VkPipelineLayout layout, uint32_t set) const;
+
+        // the bindings of m_set_layout, runtime sized arrays visible to every stage
+        const DescriptorSetLayoutDesc& getLayoutDesc() const { return m_layout_desc; }
+
+        const BindlessTableStatistics& getStatistics() const { return m_statistics; }
+        void                           logStatistics() const;
+
+    public:
+        std::shared_ptr<VulkanDevice>      m_device;
+        std::shared_ptr<VulkanLayoutCache> m_layout_cache; // owns m_set_layout
+
+        VkDescriptorPool      m_pool {VK_NULL_HANDLE};
+        VkDescriptorSetLayout m_set_layout {VK_NULL_HANDLE};
+        VkDescriptorSet       m_set {VK_NULL_HANDLE};
+
+    private:
+        struct Write
+        {
+            BindlessResourceType   type {BindlessResourceType::Texture};
+            uint32_t               index {0};
+            VkDescriptorImageInfo  image {};
+            VkDescriptorBufferInfo buffer {};
+        };
+
+        uint32_t add(BindlessResourceType type, const Write& write);
+
+        static constexpr size_t k_type_count = static_cast<size_t>(BindlessResourceType::Count);
+
+        mutable std::mutex m_mutex;
+
+        DescriptorSetLayoutDesc m_layout_desc;
+
+        std::array<BindlessIndexAllocator, k_type_count> m_allocators;
+        std::vector<Write>                               m_writes;
+
+        BindlessTableStatistics m_statistics;
+    };
+} // namespace ArchViz
@@ -1,22 +1,32 @@
 #include "runtime/function/render/rhi/vulkan/common/vulkan_buffer.h"
 #include "runtime/function/render/rhi/vulkan/common/vulkan_device.h"
+#include "runtime/function/render/rhi/vulkan/common/vulkan_memory_allocator.h"
 
 #include "runtime/core/base/macro.h"
 
 namespace ArchViz
 {
-    VkResult VulkanBuffer::map(VkDeviceSize size, VkDeviceSize offset) { return vkMapMemory(device->m_device, memory, offset, size, 0, &mapped); }
+    VkResult VulkanBuffer::map(VkDeviceSize size, VkDeviceSize offset)
+    {
+        // vma maps the whole block once and counts, the pointer is offset into this allocation
+        VkResult result = vmaMapMemory(device->m_allocator->m_allocator, allocation, &mapped);
+        if (result == VK_SUCCESS)
+        {
+            mapped = static_cast<char*>(mapped) + offset;
+        }
+        return result;
+    }
 
     void VulkanBuffer::unmap()
     {
         if (mapped)
         {
-            vkUnmapMemory(device->m_device, memory);
+            vmaUnmapMemory(device->m_allocator->m_allocator, allocation);
             mapped = nullptr;
         }
     }
 
-    VkResult VulkanBuffer::bind(VkDeviceSize offset) { return vkBindBufferMemory(device->m_device, buffer, memory, offset); }
+    VkResult VulkanBuffer::bind(VkDeviceSize offset) { return vmaBindBufferMemory2(device->m_allocator->m_allocator, allocation, offset, buffer, nullptr); }
 
     void VulkanBuffer::setupDescriptor(VkDeviceSize size, VkDeviceSize offset)
     {
@@ -31,25 +41,9 @@ namespace ArchViz
         memcpy(mapped, data, size);
     }
 
-    VkResult VulkanBuffer::flush(VkDeviceSize size, VkDeviceSize offset)
-    {
-        VkMappedMemoryRange mapped_range = {};
-        mapped_range.sType               = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-        mapped_range.memory              = memory;
-        mapped_range.offset              = offset;
-        mapped_range.size                = size;
-        return vkFlushMappedMemoryRanges(device->m_device, 1, &mapped_range);
-    }
+    VkResult VulkanBuffer::flush(VkDeviceSize size, VkDeviceSize offset) { return vmaFlushAllocation(device->m_allocator->m_allocator, allocation, offset, size); }
 
-    VkResult VulkanBuffer::invalidate(VkDeviceSize size, VkDeviceSize offset)
-    {
-        VkMappedMemoryRange mapped_range = {};
-        mapped_range.sType               = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-        mapped_range.memory              = memory;
-        mapped_range.offset              = offset;
-        mapped_range.size                = size;
-        return vkInvalidateMappedMemoryRanges(device->m_device, 1, &mapped_range);
-    }
+    VkResult VulkanBuffer::invalidate(VkDeviceSize size, VkDeviceSize offset) { return vmaInvalidateAllocation(device->m_allocator->m_allocator, allocation, offset, size); }
 
     void VulkanBuffer::destroy()
     {
@@ -57,13 +51,30 @@ namespace ArchViz
         {
             unmap();
         }
-        if (buffer)
+        if (buffer || allocation)
         {
-            vkDestroyBuffer(device->m_device, buffer, nullptr);
-        }
-        if (memory)
-        {
-            vkFreeMemory(device->m_device, memory, nullptr);
+            device->m_allocator->destroyBuffer(buffer, allocation);
         }
     }
+
+    void VulkanBuffer::allowDefragmentation()
+    {
+        ASSERT(buffer && allocation);
+
+        // the allocation may be rounded up, a buffer of the requested size always fits in its new place
+        VkBufferCreateInfo buffer_info {};
+        buffer_info.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        buffer_info.size        = size;
+        buffer_info.usage       = usage;
+        buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        device->m_allocator->setMovable(allocation, buffer, buffer_info, [this](VkBuffer moved, void* moved_mapped) {
+            buffer            = moved;
+            descriptor.buffer = moved;
+            if (mapped)
+            {
+                mapped = moved_mapped;
+            }
+        });
+    }
 } // namespace ArchViz
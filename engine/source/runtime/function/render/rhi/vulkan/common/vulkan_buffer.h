@@ -15,10 +15,10 @@ namespace ArchViz
     public:
         std::shared_ptr<VulkanDevice> device;
 
-        VkBuffer       buffer {VK_NULL_HANDLE};
-        VkDeviceMemory memory {VK_NULL_HANDLE};
-        void*          mapped {nullptr};
-        VkDeviceSize   size {0};
+        VkBuffer      buffer {VK_NULL_HANDLE};
+        VmaAllocation allocation {VK_NULL_HANDLE};
+        void*         mapped {nullptr};
+        VkDeviceSize  size {0};
 
         VkDescriptorBufferInfo descriptor;
 
@@ -34,12 +34,9 @@ namespace ArchViz
         VkResult flush(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
         VkResult invalidate(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
         void     destroy();
-    };
 
-    class VulkanBufferVMA : public VulkanBuffer
-    {
-    public:
-        VmaAllocator  m_allocator {};
-        VmaAllocation m_allocation {};
+        // lets the allocator defragment move the buffer, buffer, mapped and descriptor follow it. Only for buffers bound
+        // by handle every frame and created with both transfer usages, never for one written into a descriptor set.
+        void allowDefragmentation();
     };
 } // namespace ArchViz
@@ -15,7 +15,7 @@ namespace ArchViz
     {
         VkCommandPoolCreateInfo pool_info {};
         pool_info.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-        pool_info.flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        pool_info.flags            = m_flags;
         pool_info.queueFamilyIndex = m_device->m_indices.m_graphics_family.value();
 
         if (vkCreateCommandPool(m_device->m_device, &pool_info, nullptr, &m_command_pool) != VK_SUCCESS)
@@ -25,4 +25,12 @@ namespace ArchViz
     }
 
     void VulkanCommandPool::clear() { vkDestroyCommandPool(m_device->m_device, m_command_pool, nullptr); }
+
+    void VulkanCommandPool::reset()
+    {
+        if (vkResetCommandPool(m_device->m_device, m_command_pool, 0) != VK_SUCCESS)
+        {
+            LOG_FATAL("failed to reset command pool!");
+        }
+    }
 } // namespace ArchViz
\ No newline at end of file
@@ -15,9 +15,15 @@ namespace ArchViz
         void initialize();
         void clear();
 
+        // recycles every command buffer allocated from the pool, none of them may still be pending
+        void reset();
+
     public:
         std::shared_ptr<VulkanDevice> m_device;
 
+        // pools reset as a whole each frame are better off transient without per buffer resets
+        VkCommandPoolCreateFlags m_flags {VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT};
+
         VkCommandPool m_command_pool;
     };
 } // namespace ArchViz
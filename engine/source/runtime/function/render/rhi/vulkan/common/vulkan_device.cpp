@@ -1,5 +1,6 @@
 #include "runtime/function/render/rhi/vulkan/common/vulkan_device.h"
 #include "runtime/function/render/rhi/vulkan/common/vulkan_instance.h"
+#include "runtime/function/render/rhi/vulkan/common/vulkan_memory_allocator.h"
 #include "runtime/function/render/rhi/vulkan/utils/vulkan_utils.h"
 
 #include "runtime/core/base/macro.h"
@@ -24,7 +25,11 @@ namespace ArchViz
 
     void VulkanDevice::clear()
     {
-        vmaDestroyAllocator(m_vma_allocator);
+        if (m_allocator)
+        {
+            m_allocator->clear();
+            m_allocator.reset();
+        }
 
         if (m_command_pool != VK_NULL_HANDLE)
         {
@@ -108,7 +113,7 @@ namespace ArchViz
         m_indices = VulkanUtils::findQueueFamilies(m_physical_device, m_instance->m_surface);
 
         std::vector<VkDeviceQueueCreateInfo> queue_create_infos;
-        std::set<uint32_t>                   unique_queue_families = {m_indices.m_graphics_family.value(), m_indices.m_compute_family.value(), m_indices.m_present_family.value()};
+        std::set<uint32_t>                   unique_queue_families = {m_indices.m_graphics_family.value(), m_indices.m_compute_family.value(), m_indices.m_present_family.value(), m_indices.m_transfer_family.value()};
 
         float queue_priority = 1.0f;
         for (uint32_t queue_family : unique_queue_families)
@@ -148,17 +153,33 @@ namespace ArchViz
         }
 
         // Query bindless extension, called Descriptor Indexing (https://www.khronos.org/registry/vulkan/specs/1.3-extensions/man/html/VK_EXT_descriptor_indexing.html)
-        VkPhysicalDeviceDescriptorIndexingFeatures indexing_features {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES, nullptr};
+        // Timeline semaphores (core in 1.2) hand out the completion tokens of the staging uploads
+        VkPhysicalDeviceTimelineSemaphoreFeatures  timeline_features {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES, nullptr};
+        VkPhysicalDeviceDescriptorIndexingFeatures indexing_features {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES, &timeline_features};
         VkPhysicalDeviceFeatures2                  device_features_2 {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2, &indexing_features};
 
         vkGetPhysicalDeviceFeatures2(m_physical_device, &device_features_2);
 
-        m_bindless_support = indexing_features.descriptorBindingPartiallyBound && indexing_features.runtimeDescriptorArray;
+        m_bindless_support           = VulkanUtils::checkBindlessSupport(m_physical_device);
+        m_timeline_semaphore_support = timeline_features.timelineSemaphore;
+
+        if (m_timeline_semaphore_support)
+        {
+            physical_features2.pNext = &timeline_features;
+        }
+        else
+        {
+            LOG_FATAL("timeline semaphores are not supported!");
+        }
 
         if (m_bindless_support)
         {
-            indexing_features.descriptorBindingPartiallyBound = VK_TRUE;
-            indexing_features.runtimeDescriptorArray          = VK_TRUE;
+            indexing_features.descriptorBindingPartiallyBound               = VK_TRUE;
+            indexing_features.runtimeDescriptorArray                        = VK_TRUE;
+            indexing_features.descriptorBindingSampledImageUpdateAfterBind  = VK_TRUE;
+            indexing_features.descriptorBindingStorageImageUpdateAfterBind  = VK_TRUE;
+            indexing_features.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+            indexing_features.descriptorBindingUpdateUnusedWhilePending     = VK_TRUE;
 
             physical_features2.pNext = &indexing_features;
         }
@@ -191,17 +212,11 @@ namespace ArchViz
 
     void VulkanDevice::createAssetAllocator()
     {
-        VmaVulkanFunctions vulkan_functions    = {};
-        vulkan_functions.vkGetInstanceProcAddr = vkGetInstanceProcAddr;
-        vulkan_functions.vkGetDeviceProcAddr   = vkGetDeviceProcAddr;
-
-        VmaAllocatorCreateInfo allocator_create_info = {};
-        allocator_create_info.vulkanApiVersion       = m_instance->m_vulkan_api_version;
-        allocator_create_info.instance               = m_instance->m_instance;
-        allocator_create_info.physicalDevice         = m_physical_device;
-        allocator_create_info.device                 = m_device;
-        allocator_create_info.pVulkanFunctions       = &vulkan_functions;
-
-        vmaCreateAllocator(&allocator_create_info, &m_vma_allocator);
+        m_allocator                       = std::make_shared<VulkanMemoryAllocator>();
+        m_allocator->m_instance           = m_instance->m_instance;
+        m_allocator->m_physical_device    = m_physical_device;
+        m_allocator->m_device             = m_device;
+        m_allocator->m_vulkan_api_version = m_instance->m_vulkan_api_version;
+        m_allocator->initialize();
     }
 } // namespace ArchViz
@@ -13,6 +13,7 @@
 namespace ArchViz
 {
     class VulkanInstance;
+    class VulkanMemoryAllocator;
 
     REFLECTION_TYPE(VulkanDeviceCreateInfo)
     CLASS(VulkanDeviceCreateInfo, Fields)
@@ -54,6 +55,7 @@ namespace ArchViz
         std::vector<const char*> m_device_extensions_cstring;
 
         bool m_bindless_support {false};
+        bool m_timeline_semaphore_support {false};
 
         std::shared_ptr<VulkanInstance> m_instance {nullptr};
 
@@ -75,7 +77,7 @@ namespace ArchViz
         VkQueue m_present_queue {VK_NULL_HANDLE};
         VkQueue m_transfer_queue {VK_NULL_HANDLE};
 
-        // asset allocator use VMA library
-        VmaAllocator m_vma_allocator {nullptr};
+        // every buffer and image is allocated from here
+        std::shared_ptr<VulkanMemoryAllocator> m_allocator {nullptr};
     };
 } // namespace ArchViz
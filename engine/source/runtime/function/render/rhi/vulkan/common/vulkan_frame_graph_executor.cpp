@@ -0,0 +1,305 @@
+#include "runtime/function/render/rhi/vulkan/common/vulkan_frame_graph_executor.h"
+#include "runtime/function/render/rhi/vulkan/common/vulkan_device.h"
+
+#include "runtime/core/base/macro.h"
+
+#include <algorithm>
+
+namespace ArchViz
+{
+    void VulkanFrameGraphExecutor::initialize()
+    {
+        ASSERT(m_device);
+        m_frames_in_flight = std::max(m_frames_in_flight, 1u);
+        m_frame_index      = 0;
+    }
+
+    void VulkanFrameGraphExecutor::clear()
+    {
+        destroyEvents();
+        destroySemaphores();
+
+        m_plan     = {};
+        m_schedule = {};
+        m_images.clear();
+        m_buffers.clear();
+    }
+
+    void VulkanFrameGraphExecutor::prepare(const FrameGraphBarrierPlan& plan, const FrameGraphSchedule& schedule)
+    {
+        m_plan     = plan;
+        m_schedule = schedule;
+
+        uint32_t resource_count = 0;
+        for (const auto& event : m_plan.events)
+        {
+            for (const auto& barrier : event.barriers)
+            {
+                resource_count = std::max(resource_count, barrier.resource.index + 1);
+            }
+        }
+        for (const auto& pass : m_plan.passes)
+        {
+            for (const auto& barrier : pass.barriers)
+            {
+                resource_count = std::max(resource_count, barrier.resource.index + 1);
+            }
+        }
+        m_images.resize(std::max<size_t>(m_images.size(), resource_count), VK_NULL_HANDLE);
+        m_buffers.resize(std::max<size_t>(m_buffers.size(), resource_count), VK_NULL_HANDLE);
+
+        if (m_events.empty() || m_events[0].size() < m_plan.events.size())
+        {
+            createEvents(static_cast<uint32_t>(m_plan.events.size()));
+        }
+        if (m_semaphores.empty() || m_semaphores[0].size() < m_schedule.semaphores.size())
+        {
+            createSemaphores(static_cast<uint32_t>(m_schedule.semaphores.size()));
+        }
+    }
+
+    void VulkanFrameGraphExecutor::setImage(FrameGraphResourceHandle resource, VkImage image)
+    {
+        if (resource.index >= m_images.size())
+        {
+            m_images.resize(resource.index + 1, VK_NULL_HANDLE);
+        }
+        m_images[resource.index] = image;
+    }
+
+    void VulkanFrameGraphExecutor::setBuffer(FrameGraphResourceHandle resource, VkBuffer buffer)
+    {
+        if (resource.index >= m_buffers.size())
+        {
+            m_buffers.resize(resource.index + 1, VK_NULL_HANDLE);
+        }
+        m_buffers[resource.index] = buffer;
+    }
+
+    void VulkanFrameGraphExecutor::beginFrame(uint32_t frame_index) { m_frame_index = frame_index % m_frames_in_flight; }
+
+    void VulkanFrameGraphExecutor::beginPass(VkCommandBuffer command_buffer, uint32_t pass)
+    {
+        if (pass >= m_plan.passes.size())
+        {
+            return;
+        }
+        const FrameGraphPassBarriers& pass_barriers = m_plan.passes[pass];
+
+        // one wait per event, the events of a pass come from different producers
+        for (uint32_t index : pass_barriers.wait_events)
+        {
+            const FrameGraphEvent& event  = m_plan.events[index];
+            VkEvent                handle = m_events[m_frame_index][index];
+
+            fillBarriers(event.barriers);
+            vkCmdWaitEvents(command_buffer,
+                            1,
+                            &handle,
+                            event.src_stages,
+                            event.dst_stages,
+                            0,
+                            nullptr,
+                            static_cast<uint32_t>(m_buffer_barriers.size()),
+                            m_buffer_barriers.data(),
+                            static_cast<uint32_t>(m_image_barriers.size()),
+                            m_image_barriers.data());
+            // nothing waits on it again this frame, ready for the next set
+            vkCmdResetEvent(command_buffer, handle, event.dst_stages);
+        }
+
+        if (!pass_barriers.barriers.empty())
+        {
+            fillBarriers(pass_barriers.barriers);
+            vkCmdPipelineBarrier(command_buffer,
+                                 pass_barriers.src_stages,
+                                 pass_barriers.dst_stages,
+                                 0,
+                                 0,
+                                 nullptr,
+                                 static_cast<uint32_t>(m_buffer_barriers.size()),
+                                 m_buffer_barriers.data(),
+                                 static_cast<uint32_t>(m_image_barriers.size()),
+                                 m_image_barriers.data());
+        }
+    }
+
+    void VulkanFrameGraphExecutor::endPass(VkCommandBuffer command_buffer, uint32_t pass)
+    {
+        if (pass >= m_plan.passes.size())
+        {
+            return;
+        }
+
+        for (uint32_t index : m_plan.passes[pass].signal_events)
+        {
+            vkCmdSetEvent(command_buffer, m_events[m_frame_index][index], m_plan.events[index].src_stages);
+        }
+    }
+
+    void VulkanFrameGraphExecutor::submit(uint32_t                                 batch,
+                                          VkCommandBuffer                          command_buffer,
+                                          const std::vector<VkSemaphore>&          wait_semaphores,
+                                          const std::vector<VkPipelineStageFlags>& wait_stages,
+                                          const std::vector<VkSemaphore>&          signal_semaphores,
+                                          VkFence                                  fence)
+    {
+        ASSERT(batch < m_schedule.batches.size() && wait_semaphores.size() == wait_stages.size());
+        const FrameGraphSubmitBatch& submit = m_schedule.batches[batch];
+
+        std::vector<VkSemaphore>          waits   = wait_semaphores;
+        std::vector<VkPipelineStageFlags> stages  = wait_stages;
+        std::vector<VkSemaphore>          signals = signal_semaphores;
+        for (uint32_t index : submit.wait_semaphores)
+        {
+            waits.push_back(m_semaphores[m_frame_index][index]);
+            stages.push_back(m_schedule.semaphores[index].wait_stages);
+        }
+        for (uint32_t index : submit.signal_semaphores)
+        {
+            signals.push_back(m_semaphores[m_frame_index][index]);
+        }
+
+        VkSubmitInfo submit_info {};
+        submit_info.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit_info.waitSemaphoreCount   = static_cast<uint32_t>(waits.size());
+        submit_info.pWaitSemaphores      = waits.data();
+        submit_info.pWaitDstStageMask    = stages.data();
+        submit_info.commandBufferCount   = 1;
+        submit_info.pCommandBuffers      = &command_buffer;
+        submit_info.signalSemaphoreCount = static_cast<uint32_t>(signals.size());
+        submit_info.pSignalSemaphores    = signals.data();
+
+        VkQueue queue = submit.queue == FrameGraphQueueType::Compute ? m_device->m_compute_queue : m_device->m_graphics_queue;
+        if (vkQueueSubmit(queue, 1, &submit_info, fence) != VK_SUCCESS)
+        {
+            LOG_FATAL("failed to submit frame graph batch {}!", batch);
+        }
+    }
+
+    void VulkanFrameGraphExecutor::createEvents(uint32_t count)
+    {
+        destroyEvents();
+
+        VkEventCreateInfo event_info {};
+        event_info.sType = VK_STRUCTURE_TYPE_EVENT_CREATE_INFO;
+
+        m_events.resize(m_frames_in_flight);
+        for (auto& events : m_events)
+        {
+            events.resize(count, VK_NULL_HANDLE);
+            for (auto& event : events)
+            {
+                if (vkCreateEvent(m_device->m_device, &event_info, nullptr, &event) != VK_SUCCESS)
+                {
+                    LOG_FATAL("failed to create frame graph event!");
+                }
+            }
+        }
+    }
+
+    void VulkanFrameGraphExecutor::destroyEvents()
+    {
+        for (auto& events : m_events)
+        {
+            for (auto event : events)
+            {
+                vkDestroyEvent(m_device->m_device, event, nullptr);
+            }
+        }
+        m_events.clear();
+    }
+
+    void VulkanFrameGraphExecutor::createSemaphores(uint32_t count)
+    {
+        destroySemaphores();
+
+        VkSemaphoreCreateInfo semaphore_info {};
+        semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+        m_semaphores.resize(m_frames_in_flight);
+        for (auto& semaphores : m_semaphores)
+        {
+            semaphores.resize(count, VK_NULL_HANDLE);
+            for (auto& semaphore : semaphores)
+            {
+                if (vkCreateSemaphore(m_device->m_device, &semaphore_info, nullptr, &semaphore) != VK_SUCCESS)
+                {
+                    LOG_FATAL("failed to create frame graph semaphore!");
+                }
+            }
+        }
+    }
+
+    void VulkanFrameGraphExecutor::destroySemaphores()
+    {
+        for (auto& semaphores : m_semaphores)
+        {
+            for (auto semaphore : semaphores)
+            {
+                vkDestroySemaphore(m_device->m_device, semaphore, nullptr);
+            }
+        }
+        m_semaphores.clear();
+    }
+
+    void VulkanFrameGraphExecutor::fillBarriers(const std::vector<FrameGraphBarrier>& barriers)
+    {
+        m_image_barriers.clear();
+        m_buffer_barriers.clear();
+
+        for (const auto& barrier : barriers)
+        {
+            // waiting for readers before a write needs the stages only
+            const bool execution_only = barrier.src.access == 0 && (!barrier.image || barrier.src.layout == barrier.dst.layout);
+            if (execution_only)
+            {
+                continue;
+            }
+
+            if (barrier.image)
+            {
+                VkImage image = barrier.resource.index < m_images.size() ? m_images[barrier.resource.index] : VK_NULL_HANDLE;
+                if (image == VK_NULL_HANDLE)
+                {
+                    continue;
+                }
+
+                VkImageMemoryBarrier image_barrier {};
+                image_barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+                image_barrier.srcAccessMask                   = barrier.src.access;
+                image_barrier.dstAccessMask                   = barrier.dst.access;
+                image_barrier.oldLayout                       = barrier.src.layout;
+                image_barrier.newLayout                       = barrier.dst.layout;
+                image_barrier.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+                image_barrier.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+                image_barrier.image                           = image;
+                image_barrier.subresourceRange.aspectMask     = barrier.aspect;
+                image_barrier.subresourceRange.baseMipLevel   = 0;
+                image_barrier.subresourceRange.levelCount     = VK_REMAINING_MIP_LEVELS;
+                image_barrier.subresourceRange.baseArrayLayer = 0;
+                image_barrier.subresourceRange.layerCount     = VK_REMAINING_ARRAY_LAYERS;
+                m_image_barriers.push_back(image_barrier);
+            }
+            else
+            {
+                VkBuffer buffer = barrier.resource.index < m_buffers.size() ? m_buffers[barrier.resource.index] : VK_NULL_HANDLE;
+                if (buffer == VK_NULL_HANDLE)
+                {
+                    continue;
+                }
+
+                VkBufferMemoryBarrier buffer_barrier {};
+                buffer_barrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+                buffer_barrier.srcAccessMask       = barrier.src.access;
+                buffer_barrier.dstAccessMask       = barrier.dst.access;
+                buffer_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                buffer_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                buffer_barrier.buffer              = buffer;
+                buffer_barrier.offset              = 0;
+                buffer_barrier.size                = VK_WHOLE_SIZE;
+                m_buffer_barriers.push_back(buffer_barrier);
+            }
+        }
+    }
+} // namespace ArchViz
@@ -0,0 +1,71 @@
+#pragma once
+#include "runtime/function/render/rhi/frame_graph/frame_graph_barrier.h"
+#include "runtime/function/render/rhi/vulkan/vulkan_struct.h"
+
+#include <volk.h>
+
+#include <memory>
+#include <vector>
+
+namespace ArchViz
+{
+    class VulkanDevice;
+
+    // records the barrier plan of a compiled frame graph around its passes and submits its batches to the graphics and compute queues
+    // images and buffers are looked up by resource index, events and semaphores are kept per frame in flight, events reset right after their wait
+    class VulkanFrameGraphExecutor
+    {
+    public:
+        void initialize();
+        void clear();
+
+        // call after every compile of the graph, creates the events and the semaphores between the queues the plans need
+        void prepare(const FrameGraphBarrierPlan& plan, const FrameGraphSchedule& schedule);
+
+        void setImage(FrameGraphResourceHandle resource, VkImage image);
+        void setBuffer(FrameGraphResourceHandle resource, VkBuffer buffer);
+
+        // picks the events of this frame slot, its previous submission must have finished
+        void beginFrame(uint32_t frame_index);
+        // event waits and the merged pipeline barrier before the pass at this sorted position
+        void beginPass(VkCommandBuffer command_buffer, uint32_t pass);
+        // sets the events later passes wait on
+        void endPass(VkCommandBuffer command_buffer, uint32_t pass);
+
+        // submits the passes of one batch recorded into command_buffer, on top of the semaphores between the queues it waits and signals
+        // the ones given, like the swap chain image. Batches go out in schedule order, nothing on the cpu waits in between.
+        void submit(uint32_t                                 batch,
+                    VkCommandBuffer                          command_buffer,
+                    const std::vector<VkSemaphore>&          wait_semaphores,
+                    const std::vector<VkPipelineStageFlags>& wait_stages,
+                    const std::vector<VkSemaphore>&          signal_semaphores,
+                    VkFence                                  fence);
+
+    public:
+        std::shared_ptr<VulkanDevice> m_device;
+
+        uint32_t m_frames_in_flight {VulkanConstants::k_max_frames_in_flight};
+
+    private:
+        void createEvents(uint32_t count);
+        void destroyEvents();
+        void createSemaphores(uint32_t count);
+        void destroySemaphores();
+
+        void fillBarriers(const std::vector<FrameGraphBarrier>& barriers);
+
+    private:
+        FrameGraphBarrierPlan m_plan;
+        FrameGraphSchedule    m_schedule;
+
+        std::vector<VkImage>  m_images;
+        std::vector<VkBuffer> m_buffers;
+
+        std::vector<std::vector<VkEvent>>     m_events;     // [frame][event]
+        std::vector<std::vector<VkSemaphore>> m_semaphores; // [frame][semaphore]
+        uint32_t                              m_frame_index {0};
+
+        std::vector<VkImageMemoryBarrier>  m_image_barriers;
+        std::vector<VkBufferMemoryBarrier> m_buffer_barriers;
+    };
+} // namespace ArchViz
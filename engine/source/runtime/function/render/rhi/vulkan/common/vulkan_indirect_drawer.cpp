@@ -0,0 +1,118 @@
+#include "runtime/function/render/rhi/vulkan/common/vulkan_indirect_drawer.h"
+#include "runtime/function/render/rhi/vulkan/common/vulkan_device.h"
+#include "runtime/function/render/rhi/vulkan/utils/vulkan_buffer_utils.h"
+#include "runtime/function/render/rhi/vulkan/vulkan_struct.h"
+
+#include "runtime/core/base/macro.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ArchViz
+{
+    static_assert(sizeof(DrawIndexedCommand) == sizeof(VkDrawIndexedIndirectCommand), "DrawIndexedCommand has to match VkDrawIndexedIndirectCommand");
+
+    void VulkanIndirectDrawer::initialize()
+    {
+        ASSERT(m_device && m_max_commands > 0);
+
+        const VkDeviceSize size = static_cast<VkDeviceSize>(m_max_commands) * sizeof(DrawIndexedCommand) * VulkanConstants::k_max_frames_in_flight;
+
+        void* mapped = nullptr;
+        auto  usage  = VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+        auto  flag   = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        VulkanBufferUtils::createBuffer(m_device, size, usage, flag, m_buffer, m_allocation, &mapped);
+        m_mapped = static_cast<DrawIndexedCommand*>(mapped);
+
+        m_multi_draw     = m_device->m_features.multiDrawIndirect == VK_TRUE;
+        m_max_draw_count = m_multi_draw ? std::max(m_device->m_properties.limits.maxDrawIndirectCount, 1u) : 1u;
+        if (!m_multi_draw)
+        {
+            LOG_WARN("[vulkan] indirect drawer: no multiDrawIndirect, every command is drawn by its own call");
+        }
+
+        m_first_instance = m_device->m_features.drawIndirectFirstInstance == VK_TRUE;
+        if (!m_first_instance)
+        {
+            LOG_WARN("[vulkan] indirect drawer: no drawIndirectFirstInstance, only commands starting at instance 0 are drawn");
+        }
+    }
+
+    void VulkanIndirectDrawer::clear()
+    {
+        VulkanBufferUtils::destroyBuffer(m_device, m_buffer, m_allocation);
+        m_mapped = nullptr;
+        m_count  = 0;
+        m_buckets.clear();
+    }
+
+    void VulkanIndirectDrawer::beginFrame(uint32_t frame)
+    {
+        ASSERT(frame < VulkanConstants::k_max_frames_in_flight);
+        m_frame = frame;
+        m_count = 0;
+        m_buckets.clear();
+        m_statistics.frames += 1;
+    }
+
+    void VulkanIndirectDrawer::push(const DrawIndexedCommand* commands, uint32_t count, const std::vector<DrawBucket>& buckets)
+    {
+        if (m_count + count > m_max_commands)
+        {
+            LOG_ERROR("[vulkan] indirect drawer: frame {} has no room left for {} commands of its {}", m_frame, count, m_max_commands);
+            m_statistics.refused += count;
+            return;
+        }
+
+        auto offset_instance = [](const DrawIndexedCommand& command) { return command.first_instance != 0; };
+        if (!m_first_instance && std::any_of(commands, commands + count, offset_instance))
+        {
+            LOG_ERROR("[vulkan] indirect drawer: {} commands need drawIndirectFirstInstance", count);
+            m_statistics.refused += count;
+            return;
+        }
+
+        std::memcpy(m_mapped + static_cast<size_t>(m_frame) * m_max_commands + m_count, commands, sizeof(DrawIndexedCommand) * count);
+        for (DrawBucket bucket : buckets)
+        {
+            bucket.first_command += m_count;
+            m_buckets.push_back(bucket);
+
+            m_statistics.draw_calls += (bucket.command_count + m_max_draw_count - 1) / m_max_draw_count;
+        }
+        m_count += count;
+
+        m_statistics.commands += count;
+    }
+
+    void VulkanIndirectDrawer::record(VkCommandBuffer command_buffer, const BindFunc& bind) const
+    {
+        const VkDeviceSize stride      = sizeof(DrawIndexedCommand);
+        const VkDeviceSize frame_start = static_cast<VkDeviceSize>(m_frame) * m_max_commands * stride;
+
+        for (const DrawBucket& bucket : m_buckets)
+        {
+            if (bucket.command_count == 0 || !bind(command_buffer, bucket))
+            {
+                continue;
+            }
+
+            // a bucket longer than the device allows is split, without multi draw that is one call per command
+            for (uint32_t first = 0; first < bucket.command_count; first += m_max_draw_count)
+            {
+                const uint32_t draw_count = std::min(m_max_draw_count, bucket.command_count - first);
+                vkCmdDrawIndexedIndirect(command_buffer, m_buffer, frame_start + (bucket.first_command + first) * stride, draw_count, static_cast<uint32_t>(stride));
+            }
+        }
+    }
+
+    void VulkanIndirectDrawer::logStatistics() const
+    {
+        LOG_INFO("[vulkan] indirect draws: {} commands in {} calls over {} frames, {} refused, multi draw {}",
+                 m_statistics.commands,
+                 m_statistics.draw_calls,
+                 m_statistics.frames,
+                 m_statistics.refused,
+                 m_multi_draw);
+    }
+} // namespace ArchViz
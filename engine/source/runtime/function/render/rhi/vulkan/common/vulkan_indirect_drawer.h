@@ -0,0 +1,74 @@
+#pragma once
+#include "runtime/function/render/queue/indirect_command_builder.h"
+
+#include <vk_mem_alloc.h>
+#include <volk.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace ArchViz
+{
+    class VulkanDevice;
+
+    struct IndirectDrawStatistics
+    {
+        uint64_t frames {0};
+        uint64_t commands {0};
+        uint64_t draw_calls {0}; // vkCmdDrawIndexedIndirect calls the pushed buckets take
+        uint64_t refused {0};    // commands that did not fit in their frame or need drawIndirectFirstInstance
+    };
+
+    // the indirect commands of every frame in flight in one persistently mapped buffer, m_max_commands per frame. The
+    // commands of a frame are pushed after its fence wait, each push brings its buckets along, and record draws every bucket
+    // with one vkCmdDrawIndexedIndirect. Without multiDrawIndirect a bucket falls back to one indirect call per command,
+    // which still reads the commands from the buffer. Without drawIndirectFirstInstance the device reads first_instance as
+    // zero, pushes with any other first instance are refused.
+    class VulkanIndirectDrawer
+    {
+    public:
+        // binds what a bucket needs, false to skip it
+        using BindFunc = std::function<bool(VkCommandBuffer, const DrawBucket&)>;
+
+        void initialize();
+        void clear();
+
+        // the frame slot whose fence was just waited for, drops what it held
+        void beginFrame(uint32_t frame);
+
+        // appends commands and the buckets over them, bucket offsets are into commands
+        void push(const DrawIndexedCommand* commands, uint32_t count, const std::vector<DrawBucket>& buckets);
+        void push(const IndirectCommandBuilder& builder) { push(builder.getCommands().data(), static_cast<uint32_t>(builder.getCommands().size()), builder.getBuckets()); }
+
+        // every bucket of the frame, safe from any recording thread once the pushes are done
+        void record(VkCommandBuffer command_buffer, const BindFunc& bind) const;
+
+        uint32_t commandCount() const { return m_count; }
+
+        const IndirectDrawStatistics& getStatistics() const { return m_statistics; }
+        void                          logStatistics() const;
+
+    public:
+        std::shared_ptr<VulkanDevice> m_device;
+
+        uint32_t m_max_commands {64 * 1024};
+
+        VkBuffer      m_buffer {VK_NULL_HANDLE};
+        VmaAllocation m_allocation {VK_NULL_HANDLE};
+
+    private:
+        DrawIndexedCommand* m_mapped {nullptr};
+
+        bool     m_multi_draw {false};
+        bool     m_first_instance {false};
+        uint32_t m_max_draw_count {1};
+
+        uint32_t                m_frame {0};
+        uint32_t                m_count {0};
+        std::vector<DrawBucket> m_buckets;
+
+        IndirectDrawStatistics m_statistics;
+    };
+} // namespace ArchViz
@@ -0,0 +1,194 @@
+#include "runtime/function/render/rhi/vulkan/common/vulkan_layout_cache.h"
+#include "runtime/function/render/rhi/vulkan/common/vulkan_device.h"
+#include "runtime/function/render/rhi/vulkan/vulkan_struct.h"
+
+#include "runtime/core/base/macro.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace ArchViz
+{
+    void VulkanLayoutCache::initialize()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_statistics = {};
+    }
+
+    void VulkanLayoutCache::clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // pipeline layouts refer to set layouts, destroy them first
+        for (auto& [hash, layout] : m_pipeline_layouts)
+        {
+            vkDestroyPipelineLayout(m_device->m_device, layout, nullptr);
+        }
+        for (auto& [hash, layout] : m_set_layouts)
+        {
+            vkDestroyDescriptorSetLayout(m_device->m_device, layout, nullptr);
+        }
+        m_pipeline_layouts.clear();
+        m_set_layouts.clear();
+    }
+
+    void VulkanLayoutCache::setBindlessLayout(const DescriptorSetLayoutDesc& desc)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bindless_desc = desc;
+    }
+
+    VkDescriptorSetLayout VulkanLayoutCache::getDescriptorSetLayout(const DescriptorSetLayoutDesc& desc)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        const DescriptorSetLayoutDesc& resolved = isBindless(desc) ? m_bindless_desc : desc;
+        const uint64_t                 hash     = resolved.hash();
+
+        auto iter = m_set_layouts.find(hash);
+        if (iter != m_set_layouts.end())
+        {
+            m_statistics.set_layouts_reused += 1;
+            return iter->second;
+        }
+
+        VkDescriptorSetLayout layout = createDescriptorSetLayout(resolved);
+        if (layout != VK_NULL_HANDLE)
+        {
+            m_set_layouts[hash] = layout;
+            m_statistics.set_layouts_created += 1;
+        }
+        return layout;
+    }
+
+    VkPipelineLayout VulkanLayoutCache::getPipelineLayout(const PipelineLayoutDesc& desc)
+    {
+        const uint64_t hash = desc.hash();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            auto iter = m_pipeline_layouts.find(hash);
+            if (iter != m_pipeline_layouts.end())
+            {
+                m_statistics.pipeline_layouts_reused += 1;
+                return iter->second;
+            }
+        }
+
+        // sets between the used ones still need a layout, an empty one is shared by all of them
+        std::vector<VkDescriptorSetLayout> set_layouts;
+        for (const auto& set : desc.sets)
+        {
+            VkDescriptorSetLayout set_layout = getDescriptorSetLayout(set);
+            if (set_layout == VK_NULL_HANDLE)
+            {
+                return VK_NULL_HANDLE;
+            }
+            set_layouts.push_back(set_layout);
+        }
+
+        std::vector<VkPushConstantRange> push_constants;
+        for (const auto& range : desc.push_constants)
+        {
+            push_constants.push_back({range.stages, range.offset, range.size});
+        }
+
+        VkPipelineLayoutCreateInfo pipeline_layout_info {};
+        pipeline_layout_info.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipeline_layout_info.setLayoutCount         = static_cast<uint32_t>(set_layouts.size());
+        pipeline_layout_info.pSetLayouts            = set_layouts.data();
+        pipeline_layout_info.pushConstantRangeCount = static_cast<uint32_t>(push_constants.size());
+        pipeline_layout_info.pPushConstantRanges    = push_constants.data();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // another thread may have created it meanwhile
+        auto iter = m_pipeline_layouts.find(hash);
+        if (iter != m_pipeline_layouts.end())
+        {
+            m_statistics.pipeline_layouts_reused += 1;
+            return iter->second;
+        }
+
+        VkPipelineLayout layout = VK_NULL_HANDLE;
+        if (vkCreatePipelineLayout(m_device->m_device, &pipeline_layout_info, nullptr, &layout) != VK_SUCCESS)
+        {
+            LOG_ERROR("failed to create pipeline layout!");
+            return VK_NULL_HANDLE;
+        }
+        m_pipeline_layouts[hash] = layout;
+        m_statistics.pipeline_layouts_created += 1;
+        return layout;
+    }
+
+    LayoutCacheStatistics VulkanLayoutCache::getStatistics() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_statistics;
+    }
+
+    VkDescriptorSetLayout VulkanLayoutCache::createDescriptorSetLayout(const DescriptorSetLayoutDesc& desc)
+    {
+        std::vector<VkDescriptorSetLayoutBinding> bindings;
+        std::vector<VkDescriptorBindingFlags>     binding_flags;
+        bool                                      bindless = false;
+
+        for (const auto& binding : desc.bindings)
+        {
+            VkDescriptorSetLayoutBinding layout_binding {};
+            layout_binding.binding            = binding.binding;
+            layout_binding.descriptorType     = binding.type;
+            layout_binding.descriptorCount    = binding.count == 0 ? VulkanConstants::k_max_bindless_resources : binding.count;
+            layout_binding.stageFlags         = binding.stages;
+            layout_binding.pImmutableSamplers = nullptr;
+            bindings.push_back(layout_binding);
+
+            // new indices are written while frames using the old ones are still in flight
+            const VkDescriptorBindingFlags bindless_flags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+            binding_flags.push_back(binding.count == 0 ? bindless_flags : 0);
+            bindless |= binding.count == 0;
+        }
+
+        VkDescriptorSetLayoutBindingFlagsCreateInfoEXT extended_info {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT, nullptr};
+        extended_info.bindingCount  = static_cast<uint32_t>(binding_flags.size());
+        extended_info.pBindingFlags = binding_flags.data();
+
+        VkDescriptorSetLayoutCreateInfo layout_info {};
+        layout_info.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layout_info.bindingCount = static_cast<uint32_t>(bindings.size());
+        layout_info.pBindings    = bindings.data();
+        if (bindless)
+        {
+            layout_info.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+            layout_info.pNext = &extended_info;
+        }
+
+        VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+        if (vkCreateDescriptorSetLayout(m_device->m_device, &layout_info, nullptr, &layout) != VK_SUCCESS)
+        {
+            LOG_ERROR("failed to create descriptor set layout!");
+            return VK_NULL_HANDLE;
+        }
+        return layout;
+    }
+
+    bool VulkanLayoutCache::isBindless(const DescriptorSetLayoutDesc& desc) const
+    {
+        if (desc.empty() || m_bindless_desc.empty())
+        {
+            return false;
+        }
+
+        for (const auto& binding : desc.bindings)
+        {
+            auto iter = std::find_if(m_bindless_desc.bindings.begin(), m_bindless_desc.bindings.end(), [&binding](const ShaderBindingReflection& bindless) {
+                return bindless.binding == binding.binding;
+            });
+            if (binding.count != 0 || iter == m_bindless_desc.bindings.end() || iter->type != binding.type)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+} // namespace ArchViz
@@ -0,0 +1,60 @@
+#pragma once
+#include "runtime/function/render/rhi/shader_reflection.h"
+
+#include <volk.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace ArchViz
+{
+    class VulkanDevice;
+
+    struct LayoutCacheStatistics
+    {
+        uint32_t set_layouts_created {0};
+        uint32_t set_layouts_reused {0};
+        uint32_t pipeline_layouts_created {0};
+        uint32_t pipeline_layouts_reused {0};
+    };
+
+    // one VkDescriptorSetLayout / VkPipelineLayout per distinct reflected layout, keyed by the desc hash
+    // pipelines with the same bindings share the objects, which stay alive until clear()
+    class VulkanLayoutCache
+    {
+    public:
+        void initialize();
+        void clear();
+
+        // a set of nothing but runtime arrays declared by the bindless table gets the table's layout instead, shaders only
+        // declare the arrays they use but have to be bound with the set the table was allocated from. Called before any
+        // layout is requested.
+        void setBindlessLayout(const DescriptorSetLayoutDesc& desc);
+
+        // a runtime sized array (count 0) becomes a partially bound, update after bind binding of k_max_bindless_resources
+        VkDescriptorSetLayout getDescriptorSetLayout(const DescriptorSetLayoutDesc& desc);
+        VkPipelineLayout      getPipelineLayout(const PipelineLayoutDesc& desc);
+
+        LayoutCacheStatistics getStatistics() const;
+
+    public:
+        std::shared_ptr<VulkanDevice> m_device;
+
+    private:
+        VkDescriptorSetLayout createDescriptorSetLayout(const DescriptorSetLayoutDesc& desc);
+
+        bool isBindless(const DescriptorSetLayoutDesc& desc) const;
+
+    private:
+        mutable std::mutex m_mutex;
+
+        std::unordered_map<uint64_t, VkDescriptorSetLayout> m_set_layouts;
+        std::unordered_map<uint64_t, VkPipelineLayout>      m_pipeline_layouts;
+
+        DescriptorSetLayoutDesc m_bindless_desc;
+
+        LayoutCacheStatistics m_statistics;
+    };
+} // namespace ArchViz
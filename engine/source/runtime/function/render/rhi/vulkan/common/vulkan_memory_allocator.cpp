@@ -0,0 +1,422 @@
+#include "runtime/function/render/rhi/vulkan/common/vulkan_memory_allocator.h"
+
+#include "runtime/core/base/macro.h"
+
+#include <fstream>
+#include <vector>
+
+namespace ArchViz
+{
+    namespace
+    {
+        constexpr VkImageUsageFlags k_attachment_usage =
+            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+
+        constexpr VkBufferUsageFlags k_copy_usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+        VmaAllocationCreateInfo allocation_info(VkMemoryPropertyFlags properties)
+        {
+            // the properties are what the old vkAllocateMemory path asked for, VMA picks a type that has all of them
+            VmaAllocationCreateInfo alloc_info {};
+            alloc_info.usage         = VMA_MEMORY_USAGE_UNKNOWN;
+            alloc_info.requiredFlags = properties;
+            if (properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+            {
+                alloc_info.flags |= VMA_ALLOCATION_CREATE_MAPPED_BIT;
+            }
+            return alloc_info;
+        }
+    } // namespace
+
+    void VKAPI_PTR VulkanMemoryAllocator::onDeviceMemoryAllocate(VmaAllocator allocator, uint32_t memory_type, VkDeviceMemory memory, VkDeviceSize size, void* user_data)
+    {
+        auto* self = static_cast<VulkanMemoryAllocator*>(user_data);
+
+        const uint32_t count = self->m_device_memory_count.fetch_add(1) + 1;
+        uint32_t       peak  = self->m_device_memory_peak.load();
+        while (count > peak && !self->m_device_memory_peak.compare_exchange_weak(peak, count))
+        {
+        }
+
+        // the spec only guarantees 4096, some drivers give exactly that
+        if (count >= self->m_device_memory_limit / 4 * 3 && !self->m_limit_warned.exchange(true))
+        {
+            LOG_WARN("[vulkan] {} device memory allocations of at most {}, the last one {} bytes of type {}", count, self->m_device_memory_limit, size, memory_type);
+        }
+    }
+
+    void VKAPI_PTR VulkanMemoryAllocator::onDeviceMemoryFree(VmaAllocator allocator, uint32_t memory_type, VkDeviceMemory memory, VkDeviceSize size, void* user_data)
+    {
+        auto* self = static_cast<VulkanMemoryAllocator*>(user_data);
+        self->m_device_memory_count.fetch_sub(1);
+    }
+
+    void VulkanMemoryAllocator::initialize()
+    {
+        ASSERT(m_device);
+
+        VkPhysicalDeviceProperties properties {};
+        vkGetPhysicalDeviceProperties(m_physical_device, &properties);
+        m_device_memory_limit = properties.limits.maxMemoryAllocationCount;
+
+        VmaVulkanFunctions vulkan_functions    = {};
+        vulkan_functions.vkGetInstanceProcAddr = vkGetInstanceProcAddr;
+        vulkan_functions.vkGetDeviceProcAddr   = vkGetDeviceProcAddr;
+
+        VmaDeviceMemoryCallbacks memory_callbacks = {};
+        memory_callbacks.pfnAllocate              = onDeviceMemoryAllocate;
+        memory_callbacks.pfnFree                  = onDeviceMemoryFree;
+        memory_callbacks.pUserData                = this;
+
+        VmaAllocatorCreateInfo allocator_create_info      = {};
+        allocator_create_info.vulkanApiVersion            = m_vulkan_api_version;
+        allocator_create_info.instance                    = m_instance;
+        allocator_create_info.physicalDevice              = m_physical_device;
+        allocator_create_info.device                      = m_device;
+        allocator_create_info.pVulkanFunctions            = &vulkan_functions;
+        allocator_create_info.pDeviceMemoryCallbacks      = &memory_callbacks;
+        allocator_create_info.preferredLargeHeapBlockSize = m_block_size;
+
+        if (vmaCreateAllocator(&allocator_create_info, &m_allocator) != VK_SUCCESS)
+        {
+            LOG_FATAL("failed to create memory allocator!");
+        }
+    }
+
+    void VulkanMemoryAllocator::clear()
+    {
+        if (m_allocator == VK_NULL_HANDLE)
+        {
+            return;
+        }
+
+        // anything left here leaks a block, VMA asserts on it in debug
+        VmaTotalStatistics statistics {};
+        vmaCalculateStatistics(m_allocator, &statistics);
+        if (statistics.total.statistics.allocationCount > 0)
+        {
+            LOG_WARN("[vulkan] {} allocations still alive when the allocator is destroyed", statistics.total.statistics.allocationCount);
+        }
+
+        vmaDestroyAllocator(m_allocator);
+        m_allocator = VK_NULL_HANDLE;
+
+        m_movables.clear();
+        m_dedicated.clear();
+    }
+
+    void VulkanMemoryAllocator::createBuffer(const VkBufferCreateInfo& buffer_info, VkMemoryPropertyFlags properties, VkBuffer& buffer, VmaAllocation& allocation, void** mapped)
+    {
+        VmaAllocationCreateInfo alloc_info = allocation_info(properties);
+
+        VmaAllocationInfo info {};
+        if (vmaCreateBuffer(m_allocator, &buffer_info, &alloc_info, &buffer, &allocation, &info) != VK_SUCCESS)
+        {
+            LOG_FATAL("failed to create buffer of {} bytes!", buffer_info.size);
+        }
+
+        if (mapped != nullptr)
+        {
+            *mapped = info.pMappedData;
+        }
+    }
+
+    void VulkanMemoryAllocator::destroyBuffer(VkBuffer& buffer, VmaAllocation& allocation)
+    {
+        if (allocation != VK_NULL_HANDLE)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_movables.erase(allocation);
+        }
+
+        vmaDestroyBuffer(m_allocator, buffer, allocation);
+        buffer     = VK_NULL_HANDLE;
+        allocation = VK_NULL_HANDLE;
+    }
+
+    void VulkanMemoryAllocator::createImage(const VkImageCreateInfo& image_info, VkMemoryPropertyFlags properties, VkImage& image, VmaAllocation& allocation)
+    {
+        if (vkCreateImage(m_device, &image_info, nullptr, &image) != VK_SUCCESS)
+        {
+            LOG_FATAL("failed to create image!");
+        }
+
+        VkMemoryRequirements requirements;
+        vkGetImageMemoryRequirements(m_device, image, &requirements);
+
+        // big render targets get their own memory, drivers can do better with them and they would pin a whole block
+        VmaAllocationCreateInfo alloc_info = allocation_info(properties);
+        const bool              dedicated  = (image_info.usage & k_attachment_usage) != 0 && requirements.size >= m_dedicated_threshold;
+        if (dedicated)
+        {
+            alloc_info.flags |= VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+        }
+
+        if (vmaAllocateMemoryForImage(m_allocator, image, &alloc_info, &allocation, nullptr) != VK_SUCCESS)
+        {
+            LOG_FATAL("failed to allocate image memory!");
+        }
+
+        if (vmaBindImageMemory(m_allocator, allocation, image) != VK_SUCCESS)
+        {
+            LOG_FATAL("failed to bind image memory!");
+        }
+
+        if (dedicated)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_dedicated.insert(allocation);
+        }
+    }
+
+    void VulkanMemoryAllocator::destroyImage(VkImage& image, VmaAllocation& allocation)
+    {
+        if (allocation != VK_NULL_HANDLE)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_dedicated.erase(allocation);
+        }
+
+        vmaDestroyImage(m_allocator, image, allocation);
+        image      = VK_NULL_HANDLE;
+        allocation = VK_NULL_HANDLE;
+    }
+
+    void* VulkanMemoryAllocator::map(VmaAllocation allocation)
+    {
+        void* mapped = nullptr;
+        if (vmaMapMemory(m_allocator, allocation, &mapped) != VK_SUCCESS)
+        {
+            LOG_ERROR("failed to map memory!");
+            return nullptr;
+        }
+        return mapped;
+    }
+
+    void VulkanMemoryAllocator::unmap(VmaAllocation allocation) { vmaUnmapMemory(m_allocator, allocation); }
+
+    void VulkanMemoryAllocator::flush(VmaAllocation allocation, VkDeviceSize offset, VkDeviceSize size) { vmaFlushAllocation(m_allocator, allocation, offset, size); }
+
+    void VulkanMemoryAllocator::invalidate(VmaAllocation allocation, VkDeviceSize offset, VkDeviceSize size) { vmaInvalidateAllocation(m_allocator, allocation, offset, size); }
+
+    void VulkanMemoryAllocator::setMovable(VmaAllocation allocation, VkBuffer buffer, const VkBufferCreateInfo& buffer_info, RelocateFunc relocate)
+    {
+        // the move is a copy on the queue, without both transfer usages the buffer can never take part
+        if ((buffer_info.usage & k_copy_usage) != k_copy_usage)
+        {
+            LOG_WARN("[vulkan] buffer without transfer usage can not be moved");
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        Movable& movable    = m_movables[allocation];
+        movable.buffer      = buffer;
+        movable.buffer_info = buffer_info;
+        movable.relocate    = std::move(relocate);
+    }
+
+    VulkanDefragmentationStatistics VulkanMemoryAllocator::defragment(VkCommandPool command_pool, VkQueue queue)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        VulkanDefragmentationStatistics result {};
+
+        VmaDefragmentationInfo defrag_info {};
+        defrag_info.flags = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_FAST_BIT;
+
+        VmaDefragmentationContext context = VK_NULL_HANDLE;
+        if (vmaBeginDefragmentation(m_allocator, &defrag_info, &context) != VK_SUCCESS)
+        {
+            LOG_ERROR("failed to begin defragmentation!");
+            return result;
+        }
+
+        VkCommandBufferAllocateInfo alloc_info {};
+        alloc_info.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        alloc_info.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        alloc_info.commandPool        = command_pool;
+        alloc_info.commandBufferCount = 1;
+
+        while (true)
+        {
+            VmaDefragmentationPassMoveInfo pass {};
+            if (vmaBeginDefragmentationPass(m_allocator, context, &pass) == VK_SUCCESS)
+            {
+                break;
+            }
+            result.passes += 1;
+
+            struct Copy
+            {
+                VmaAllocation allocation;
+                VkBuffer      old_buffer;
+                VkBuffer      new_buffer;
+            };
+            std::vector<Copy> copies;
+
+            VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+            vkAllocateCommandBuffers(m_device, &alloc_info, &command_buffer);
+
+            VkCommandBufferBeginInfo begin_info {};
+            begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+            vkBeginCommandBuffer(command_buffer, &begin_info);
+
+            for (uint32_t i = 0; i < pass.moveCount; ++i)
+            {
+                VmaDefragmentationMove& move = pass.pMoves[i];
+
+                // images and pinned buffers stay where they are, VMA then keeps their block alive
+                auto iter = m_movables.find(move.srcAllocation);
+                if (iter == m_movables.end())
+                {
+                    move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+                    result.ignored += 1;
+                    continue;
+                }
+
+                Copy copy {move.srcAllocation, iter->second.buffer, VK_NULL_HANDLE};
+                if (vkCreateBuffer(m_device, &iter->second.buffer_info, nullptr, &copy.new_buffer) != VK_SUCCESS ||
+                    vmaBindBufferMemory(m_allocator, move.dstTmpAllocation, copy.new_buffer) != VK_SUCCESS)
+                {
+                    vkDestroyBuffer(m_device, copy.new_buffer, nullptr);
+                    move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+                    result.ignored += 1;
+                    continue;
+                }
+
+                VkBufferCopy region {};
+                region.size = iter->second.buffer_info.size;
+                vkCmdCopyBuffer(command_buffer, copy.old_buffer, copy.new_buffer, 1, &region);
+
+                copies.push_back(copy);
+            }
+
+            // the next frame reads the moved data as whatever it was before
+            VkMemoryBarrier barrier {};
+            barrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_HOST_READ_BIT;
+            vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT | VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+            vkEndCommandBuffer(command_buffer);
+
+            VkSubmitInfo submit_info {};
+            submit_info.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submit_info.commandBufferCount = 1;
+            submit_info.pCommandBuffers    = &command_buffer;
+            vkQueueSubmit(queue, 1, &submit_info, VK_NULL_HANDLE);
+            vkQueueWaitIdle(queue);
+
+            vkFreeCommandBuffers(m_device, command_pool, 1, &command_buffer);
+
+            // from here on the source allocations point at the new place
+            const VkResult end_result = vmaEndDefragmentationPass(m_allocator, context, &pass);
+
+            for (const Copy& copy : copies)
+            {
+                vkDestroyBuffer(m_device, copy.old_buffer, nullptr);
+
+                VmaAllocationInfo info {};
+                vmaGetAllocationInfo(m_allocator, copy.allocation, &info);
+
+                Movable& movable = m_movables[copy.allocation];
+                movable.buffer   = copy.new_buffer;
+                if (movable.relocate)
+                {
+                    movable.relocate(copy.new_buffer, info.pMappedData);
+                }
+            }
+            result.moved += static_cast<uint32_t>(copies.size());
+
+            if (end_result == VK_SUCCESS)
+            {
+                break;
+            }
+        }
+
+        VmaDefragmentationStats stats {};
+        vmaEndDefragmentation(m_allocator, context, &stats);
+
+        result.blocks_freed = stats.deviceMemoryBlocksFreed;
+        result.bytes_moved  = stats.bytesMoved;
+        result.bytes_freed  = stats.bytesFreed;
+
+        LOG_INFO("[vulkan] defragmentation: {} passes, {} buffers moved, {} ignored, {} bytes moved, {} blocks and {} bytes freed",
+                 result.passes,
+                 result.moved,
+                 result.ignored,
+                 result.bytes_moved,
+                 result.blocks_freed,
+                 result.bytes_freed);
+        return result;
+    }
+
+    VulkanMemoryStatistics VulkanMemoryAllocator::getStatistics() const
+    {
+        VmaTotalStatistics total {};
+        vmaCalculateStatistics(m_allocator, &total);
+
+        VulkanMemoryStatistics statistics {};
+        statistics.device_memory_count = m_device_memory_count.load();
+        statistics.device_memory_peak  = m_device_memory_peak.load();
+        statistics.device_memory_limit = m_device_memory_limit;
+        statistics.allocation_count    = total.total.statistics.allocationCount;
+        statistics.block_bytes         = total.total.statistics.blockBytes;
+        statistics.allocation_bytes    = total.total.statistics.allocationBytes;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        statistics.dedicated_count = static_cast<uint32_t>(m_dedicated.size());
+        return statistics;
+    }
+
+    void VulkanMemoryAllocator::logStatistics() const
+    {
+        const VulkanMemoryStatistics statistics = getStatistics();
+
+        LOG_INFO("[vulkan] memory: {} allocations ({} dedicated) in {} device memory objects, peak {} of at most {}",
+                 statistics.allocation_count,
+                 statistics.dedicated_count,
+                 statistics.device_memory_count,
+                 statistics.device_memory_peak,
+                 statistics.device_memory_limit);
+        LOG_INFO("[vulkan]     {} bytes used of {} bytes allocated", statistics.allocation_bytes, statistics.block_bytes);
+
+        const VkPhysicalDeviceMemoryProperties* memory_properties = nullptr;
+        vmaGetMemoryProperties(m_allocator, &memory_properties);
+
+        std::vector<VmaBudget> budgets(memory_properties->memoryHeapCount);
+        vmaGetHeapBudgets(m_allocator, budgets.data());
+        for (uint32_t heap = 0; heap < memory_properties->memoryHeapCount; ++heap)
+        {
+            LOG_INFO("[vulkan]     heap {}: {} bytes in {} blocks, {} bytes of {} budget used",
+                     heap,
+                     budgets[heap].statistics.blockBytes,
+                     budgets[heap].statistics.blockCount,
+                     budgets[heap].usage,
+                     budgets[heap].budget);
+        }
+    }
+
+    bool VulkanMemoryAllocator::dumpStatistics(const std::filesystem::path& path) const
+    {
+        char* stats_string = nullptr;
+        vmaBuildStatsString(m_allocator, &stats_string, VK_TRUE);
+
+        std::ofstream file(path, std::ios::trunc);
+        if (file)
+        {
+            file << stats_string;
+        }
+        vmaFreeStatsString(m_allocator, stats_string);
+
+        if (!file)
+        {
+            LOG_ERROR("failed to write memory statistics to {}", path.generic_string());
+            return false;
+        }
+        LOG_INFO("[vulkan] memory statistics written to {}", path.generic_string());
+        return true;
+    }
+} // namespace ArchViz
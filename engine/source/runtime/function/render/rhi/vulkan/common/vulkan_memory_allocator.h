@@ -0,0 +1,106 @@
+#pragma once
+
+#include <vk_mem_alloc.h>
+#include <volk.h>
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace ArchViz
+{
+    struct VulkanMemoryStatistics
+    {
+        uint32_t device_memory_count {0}; // live VkDeviceMemory objects, blocks and dedicated allocations
+        uint32_t device_memory_peak {0};
+        uint32_t device_memory_limit {0}; // maxMemoryAllocationCount of the device
+        uint32_t allocation_count {0};    // buffers and images placed in the blocks or dedicated
+        uint32_t dedicated_count {0};
+
+        VkDeviceSize block_bytes {0};
+        VkDeviceSize allocation_bytes {0};
+    };
+
+    struct VulkanDefragmentationStatistics
+    {
+        uint32_t     passes {0};
+        uint32_t     moved {0};   // buffers copied to a new place
+        uint32_t     ignored {0}; // moves VMA asked for on memory nothing can relocate
+        uint32_t     blocks_freed {0};
+        VkDeviceSize bytes_moved {0};
+        VkDeviceSize bytes_freed {0};
+    };
+
+    // every buffer and image of the device goes through here. They are placed in large VMA blocks per memory type,
+    // only render targets of at least m_dedicated_threshold bytes get a VkDeviceMemory of their own, so thousands of
+    // resources stay far below maxMemoryAllocationCount. Host visible memory is persistently mapped.
+    class VulkanMemoryAllocator
+    {
+    public:
+        // the buffer of a movable allocation after defragment copied it, mapped is its new pointer when host visible
+        using RelocateFunc = std::function<void(VkBuffer buffer, void* mapped)>;
+
+        void initialize();
+        void clear();
+
+        void createBuffer(const VkBufferCreateInfo& buffer_info, VkMemoryPropertyFlags properties, VkBuffer& buffer, VmaAllocation& allocation, void** mapped = nullptr);
+        void destroyBuffer(VkBuffer& buffer, VmaAllocation& allocation);
+
+        void createImage(const VkImageCreateInfo& image_info, VkMemoryPropertyFlags properties, VkImage& image, VmaAllocation& allocation);
+        void destroyImage(VkImage& image, VmaAllocation& allocation);
+
+        void* map(VmaAllocation allocation);
+        void  unmap(VmaAllocation allocation);
+        void  flush(VmaAllocation allocation, VkDeviceSize offset, VkDeviceSize size);
+        void  invalidate(VmaAllocation allocation, VkDeviceSize offset, VkDeviceSize size);
+
+        // lets defragment move the buffer, its owner gets the new one through relocate. Buffers are pinned by default,
+        // anything that keeps the handle where it cannot be updated, like a written descriptor set, has to stay that way.
+        void setMovable(VmaAllocation allocation, VkBuffer buffer, const VkBufferCreateInfo& buffer_info, RelocateFunc relocate);
+
+        // packs the movable buffers into fewer blocks and releases the emptied ones, the copies run on queue from
+        // command_pool and are waited for. Nothing may use the movable buffers while it runs.
+        VulkanDefragmentationStatistics defragment(VkCommandPool command_pool, VkQueue queue);
+
+        VulkanMemoryStatistics getStatistics() const;
+        void                   logStatistics() const;
+        // the full VMA json dump, every heap, block and allocation
+        bool dumpStatistics(const std::filesystem::path& path) const;
+
+    public:
+        VkInstance       m_instance {VK_NULL_HANDLE};
+        VkPhysicalDevice m_physical_device {VK_NULL_HANDLE};
+        VkDevice         m_device {VK_NULL_HANDLE};
+        uint32_t         m_vulkan_api_version {VK_API_VERSION_1_0};
+
+        VkDeviceSize m_block_size {64ull * 1024 * 1024};
+        VkDeviceSize m_dedicated_threshold {16ull * 1024 * 1024};
+
+        VmaAllocator m_allocator {VK_NULL_HANDLE};
+
+    private:
+        static void VKAPI_PTR onDeviceMemoryAllocate(VmaAllocator allocator, uint32_t memory_type, VkDeviceMemory memory, VkDeviceSize size, void* user_data);
+        static void VKAPI_PTR onDeviceMemoryFree(VmaAllocator allocator, uint32_t memory_type, VkDeviceMemory memory, VkDeviceSize size, void* user_data);
+
+    private:
+        struct Movable
+        {
+            VkBuffer           buffer {VK_NULL_HANDLE};
+            VkBufferCreateInfo buffer_info {};
+            RelocateFunc       relocate;
+        };
+
+        mutable std::mutex                         m_mutex;
+        std::unordered_map<VmaAllocation, Movable> m_movables;
+        std::unordered_set<VmaAllocation>          m_dedicated;
+
+        std::atomic<uint32_t> m_device_memory_count {0};
+        std::atomic<uint32_t> m_device_memory_peak {0};
+        uint32_t              m_device_memory_limit {0};
+        std::atomic<bool>     m_limit_warned {false};
+    };
+} // namespace ArchViz
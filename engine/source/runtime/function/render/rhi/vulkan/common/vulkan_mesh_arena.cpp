@@ -0,0 +1,106 @@
+#include "runtime/function/render/rhi/vulkan/common/vulkan_mesh_arena.h"
+#include "runtime/function/render/rhi/vulkan/common/vulkan_device.h"
+#include "runtime/function/render/rhi/vulkan/common/vulkan_memory_allocator.h"
+#include "runtime/function/render/rhi/vulkan/common/vulkan_staging_uploader.h"
+#include "runtime/function/render/rhi/vulkan/utils/vulkan_buffer_utils.h"
+#include "runtime/function/render/rhi/vulkan/vulkan_struct.h"
+
+#include "runtime/core/base/macro.h"
+
+#include <algorithm>
+
+namespace ArchViz
+{
+    void VulkanMeshArena::initialize()
+    {
+        ASSERT(m_device && m_uploader && m_vertex_stride > 0);
+
+        const VkDeviceSize       vertex_size  = static_cast<VkDeviceSize>(m_vertex_capacity) * m_vertex_stride;
+        const VkDeviceSize       index_size   = static_cast<VkDeviceSize>(m_index_capacity) * sizeof(uint32_t);
+        const VkBufferUsageFlags vertex_usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        const VkBufferUsageFlags index_usage  = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+        VulkanBufferUtils::createBuffer(m_device, vertex_size, vertex_usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_vertex_buffer, m_vertex_allocation);
+        VulkanBufferUtils::createBuffer(m_device, index_size, index_usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_index_buffer, m_index_allocation);
+
+        // only bound by handle while recording, so defragment may move them
+        setMovable(m_vertex_buffer, m_vertex_allocation, vertex_size, vertex_usage);
+        setMovable(m_index_buffer, m_index_allocation, index_size, index_usage);
+
+        m_arena.initialize(m_vertex_capacity, m_index_capacity, VulkanConstants::k_max_frames_in_flight);
+    }
+
+    void VulkanMeshArena::clear()
+    {
+        VulkanBufferUtils::destroyBuffer(m_device, m_vertex_buffer, m_vertex_allocation);
+        VulkanBufferUtils::destroyBuffer(m_device, m_index_buffer, m_index_allocation);
+        m_arena.clear();
+    }
+
+    uint64_t VulkanMeshArena::upload(uint32_t mesh, const void* vertices, uint32_t vertex_count, const uint32_t* indices, uint32_t index_count)
+    {
+        if (!m_arena.allocate(mesh, vertex_count, index_count))
+        {
+            LOG_ERROR("[vulkan] mesh arena: no room for mesh {} with {} vertices and {} indices, {} of {} vertices and {} of {} indices in use",
+                      mesh,
+                      vertex_count,
+                      index_count,
+                      m_arena.usedVertices(),
+                      m_arena.vertexCapacity(),
+                      m_arena.usedIndices(),
+                      m_arena.indexCapacity());
+            return 0;
+        }
+
+        const MeshRange& range = m_arena.getRange(mesh);
+
+        const uint64_t vertex_token = m_uploader->uploadBuffer(m_vertex_buffer,
+                                                               static_cast<VkDeviceSize>(range.vertex_offset) * m_vertex_stride,
+                                                               vertices,
+                                                               static_cast<VkDeviceSize>(vertex_count) * m_vertex_stride);
+        const uint64_t index_token  = m_uploader->uploadBuffer(m_index_buffer,
+                                                              static_cast<VkDeviceSize>(range.first_index) * sizeof(uint32_t),
+                                                              indices,
+                                                              static_cast<VkDeviceSize>(index_count) * sizeof(uint32_t));
+        return std::max(vertex_token, index_token);
+    }
+
+    void VulkanMeshArena::free(uint32_t mesh) { m_arena.free(mesh); }
+
+    void VulkanMeshArena::beginFrame() { m_arena.advance(); }
+
+    void VulkanMeshArena::bind(VkCommandBuffer command_buffer) const
+    {
+        // the vertex offsets of the draws pick the mesh, the buffer is bound from its start
+        VkDeviceSize offset = 0;
+        vkCmdBindVertexBuffers(command_buffer, 0, 1, &m_vertex_buffer, &offset);
+        vkCmdBindIndexBuffer(command_buffer, m_index_buffer, 0, VK_INDEX_TYPE_UINT32);
+    }
+
+    void VulkanMeshArena::setMovable(VkBuffer& buffer, VmaAllocation allocation, VkDeviceSize size, VkBufferUsageFlags usage)
+    {
+        // the allocation may be rounded up, a buffer of the requested size always fits in its new place
+        VkBufferCreateInfo buffer_info {};
+        buffer_info.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        buffer_info.size        = size;
+        buffer_info.usage       = usage;
+        buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        // the ranges are offsets into the buffer, they stay valid wherever its memory is
+        m_device->m_allocator->setMovable(allocation, buffer, buffer_info, [&buffer](VkBuffer moved, void* /*mapped*/) { buffer = moved; });
+    }
+
+    void VulkanMeshArena::logStatistics() const
+    {
+        const MeshArenaStatistics& statistics = m_arena.getStatistics();
+        LOG_INFO("[vulkan] mesh arena: {} meshes loaded, {} freed, {} refused, peak {} of {} vertices and {} of {} indices, {} free vertex blocks",
+                 statistics.allocations,
+                 statistics.frees,
+                 statistics.refused,
+                 statistics.peak_vertices,
+                 m_arena.vertexCapacity(),
+                 statistics.peak_indices,
+                 m_arena.indexCapacity(),
+                 m_arena.vertexBlocks());
+    }
+} // namespace ArchViz
@@ -0,0 +1,59 @@
+#pragma once
+#include "runtime/function/render/rhi/mesh_arena.h"
+
+#include <vk_mem_alloc.h>
+#include <volk.h>
+
+#include <cstdint>
+#include <memory>
+
+namespace ArchViz
+{
+    class VulkanDevice;
+    class VulkanStagingUploader;
+
+    // one device local vertex buffer and one index buffer shared by every mesh, with a MeshArena handing out their ranges.
+    // Meshes are uploaded through the staging uploader, so bind once per command buffer and draw any resident mesh by its
+    // offsets. The ranges of a freed mesh are reused once the frames in flight are done with them. Both buffers are movable,
+    // defragment may give them new handles while the device is idle.
+    class VulkanMeshArena
+    {
+    public:
+        void initialize();
+        void clear();
+
+        // the upload token of the mesh, 0 when it did not fit and is not resident. The vertices are m_vertex_stride bytes each
+        uint64_t upload(uint32_t mesh, const void* vertices, uint32_t vertex_count, const uint32_t* indices, uint32_t index_count);
+        void     free(uint32_t mesh);
+
+        // once a frame after the frame fence wait
+        void beginFrame();
+
+        // binding 0 and the uint32 index buffer
+        void bind(VkCommandBuffer command_buffer) const;
+
+        const MeshArena& getArena() const { return m_arena; }
+
+        void logStatistics() const;
+
+    public:
+        std::shared_ptr<VulkanDevice>          m_device;
+        std::shared_ptr<VulkanStagingUploader> m_uploader;
+
+        uint32_t m_vertex_stride {0};
+        uint32_t m_vertex_capacity {1024 * 1024};
+        uint32_t m_index_capacity {4 * 1024 * 1024};
+
+        VkBuffer      m_vertex_buffer {VK_NULL_HANDLE};
+        VmaAllocation m_vertex_allocation {VK_NULL_HANDLE};
+        VkBuffer      m_index_buffer {VK_NULL_HANDLE};
+        VmaAllocation m_index_allocation {VK_NULL_HANDLE};
+
+    private:
+        // registers the buffer with the allocator, defragment hands the moved handle back through it
+        void setMovable(VkBuffer& buffer, VmaAllocation allocation, VkDeviceSize size, VkBufferUsageFlags usage);
+
+    private:
+        MeshArena m_arena;
+    };
+} // namespace ArchViz
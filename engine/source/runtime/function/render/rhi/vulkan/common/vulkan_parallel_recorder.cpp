@@ -0,0 +1,121 @@
+#include "runtime/function/render/rhi/vulkan/common/vulkan_parallel_recorder.h"
+#include "runtime/function/render/rhi/vulkan/common/vulkan_device.h"
+
+#include "runtime/core/base/macro.h"
+
+#include <algorithm>
+
+namespace ArchViz
+{
+    void VulkanParallelRecorder::initialize()
+    {
+        ASSERT(m_device);
+        m_frames_in_flight = std::max(m_frames_in_flight, 1u);
+        m_thread_count     = std::max(m_thread_count, 1u);
+
+        // the whole pool is reset every frame, no buffer is reset on its own
+        m_pools.resize(m_frames_in_flight * m_thread_count);
+        for (auto& pool : m_pools)
+        {
+            pool.connect(m_device);
+            pool.m_flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+            pool.initialize();
+        }
+
+        auto allocate = [this](uint32_t frame, uint32_t thread) {
+            VkCommandBufferAllocateInfo alloc_info {};
+            alloc_info.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            alloc_info.commandPool        = m_pools[frame * m_thread_count + thread].m_command_pool;
+            alloc_info.level              = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+            alloc_info.commandBufferCount = 1;
+
+            VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+            if (vkAllocateCommandBuffers(m_device->m_device, &alloc_info, &command_buffer) != VK_SUCCESS)
+            {
+                LOG_FATAL("failed to allocate secondary command buffer!");
+            }
+            return command_buffer;
+        };
+
+        auto reset = [this](uint32_t frame, uint32_t thread) { m_pools[frame * m_thread_count + thread].reset(); };
+
+        m_recorder.m_min_chunk_draws = m_min_chunk_draws;
+        m_recorder.initialize(m_frames_in_flight, m_thread_count, allocate, reset, m_executor);
+    }
+
+    void VulkanParallelRecorder::clear()
+    {
+        // destroying a pool frees its buffers
+        m_recorder.clear();
+        for (auto& pool : m_pools)
+        {
+            pool.clear();
+        }
+        m_pools.clear();
+    }
+
+    void VulkanParallelRecorder::beginFrame(uint32_t frame_index) { m_recorder.beginFrame(frame_index); }
+
+    void VulkanParallelRecorder::record(VkCommandBuffer primary, VkRenderPass render_pass, uint32_t subpass, VkFramebuffer framebuffer, uint32_t draw_count, const RecordFunc& record)
+    {
+        VkCommandBufferInheritanceInfo inheritance_info {};
+        inheritance_info.sType       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        inheritance_info.renderPass  = render_pass;
+        inheritance_info.subpass     = subpass;
+        inheritance_info.framebuffer = framebuffer;
+
+        auto record_secondary = [&](VkCommandBuffer command_buffer, uint32_t thread, uint32_t begin, uint32_t end) {
+            VkCommandBufferBeginInfo begin_info {};
+            begin_info.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            begin_info.flags            = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+            begin_info.pInheritanceInfo = &inheritance_info;
+
+            if (vkBeginCommandBuffer(command_buffer, &begin_info) != VK_SUCCESS)
+            {
+                LOG_FATAL("failed to begin recording secondary command buffer!");
+            }
+
+            record(command_buffer, thread, begin, end);
+
+            if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS)
+            {
+                LOG_FATAL("failed to record secondary command buffer!");
+            }
+        };
+
+        const std::vector<VkCommandBuffer>& secondaries = m_recorder.record(draw_count, record_secondary);
+        if (!secondaries.empty())
+        {
+            vkCmdExecuteCommands(primary, static_cast<uint32_t>(secondaries.size()), secondaries.data());
+        }
+    }
+
+    const ParallelRecordStatistics& VulkanParallelRecorder::getStatistics() const { return m_recorder.getStatistics(); }
+
+    void VulkanParallelRecorder::resetStatistics() { m_recorder.resetStatistics(); }
+
+    void VulkanParallelRecorder::logStatistics() const
+    {
+        const ParallelRecordStatistics& statistics = m_recorder.getStatistics();
+        if (statistics.records == 0)
+        {
+            return;
+        }
+
+        LOG_INFO("[vulkan] parallel recording: {} frames, {} records, {} secondary buffers, {:.3f} ms waited per record",
+                 statistics.frames,
+                 statistics.records,
+                 statistics.allocated,
+                 statistics.wall_ms / statistics.records);
+        for (uint32_t thread = 0; thread < statistics.threads.size(); ++thread)
+        {
+            const ParallelRecordThreadStatistics& stats = statistics.threads[thread];
+            LOG_INFO("[vulkan]     thread {}: {} chunks, {} draws, {:.3f} ms cpu, {:.3f} ms per chunk",
+                     thread,
+                     stats.chunks,
+                     stats.draws,
+                     stats.record_ms,
+                     stats.chunks == 0 ? 0.0f : stats.record_ms / stats.chunks);
+        }
+    }
+} // namespace ArchViz
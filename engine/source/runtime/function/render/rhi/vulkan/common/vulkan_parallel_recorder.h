@@ -0,0 +1,51 @@
+#pragma once
+#include "runtime/function/render/rhi/parallel_command_recorder.h"
+#include "runtime/function/render/rhi/vulkan/common/vulkan_command_pool.h"
+#include "runtime/function/render/rhi/vulkan/vulkan_struct.h"
+
+#include <volk.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace ArchViz
+{
+    class VulkanDevice;
+    class WorkExecutor;
+
+    // records the draws of a subpass into secondary command buffers on m_executor and executes them in draw order in the primary
+    // the command pools are per frame in flight and per thread slot, they are reset in beginFrame instead of freeing the buffers
+    class VulkanParallelRecorder
+    {
+    public:
+        // binds everything the draws in [begin, end) need and records them, the secondary inherits nothing but the render pass
+        using RecordFunc = std::function<void(VkCommandBuffer command_buffer, uint32_t thread, uint32_t begin, uint32_t end)>;
+
+        void initialize();
+        void clear();
+
+        // resets the pools of this frame slot, its previous submission must have finished
+        void beginFrame(uint32_t frame_index);
+
+        // the subpass must have been begun in primary with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+        void record(VkCommandBuffer primary, VkRenderPass render_pass, uint32_t subpass, VkFramebuffer framebuffer, uint32_t draw_count, const RecordFunc& record);
+
+        const ParallelRecordStatistics& getStatistics() const;
+        void                            resetStatistics();
+        // cpu time, chunks and draws of every thread slot since the last reset
+        void logStatistics() const;
+
+    public:
+        std::shared_ptr<VulkanDevice> m_device;
+        std::shared_ptr<WorkExecutor> m_executor; // records inline when null
+
+        uint32_t m_frames_in_flight {VulkanConstants::k_max_frames_in_flight};
+        uint32_t m_thread_count {1};
+        uint32_t m_min_chunk_draws {64};
+
+    private:
+        std::vector<VulkanCommandPool>           m_pools; // [frame * threads + thread]
+        ParallelCommandRecorder<VkCommandBuffer> m_recorder;
+    };
+} // namespace ArchViz
@@ -1,5 +1,6 @@
 #include "runtime/function/render/rhi/vulkan/common/vulkan_pipeline.h"
 #include "runtime/function/render/rhi/vulkan/common/vulkan_device.h"
+#include "runtime/function/render/rhi/vulkan/common/vulkan_layout_cache.h"
 #include "runtime/function/render/rhi/vulkan/common/vulkan_shader.h"
 #include "runtime/function/render/rhi/vulkan/utils/vulkan_utils.h"
 
@@ -16,45 +17,41 @@ namespace ArchViz
     {
         m_shader->initialize();
 
-        createDescriptorSetLayout();
+        createPipelineLayout();
         createPipeline();
 
         m_shader->clear();
     }
 
-    void VulkanPipeline::createDescriptorSetLayout()
+    void VulkanPipeline::createPipelineLayout()
     {
-        VkDescriptorSetLayoutBinding ubo_layout_binding {};
-        ubo_layout_binding.binding            = 0;
-        ubo_layout_binding.descriptorCount    = 1;
-        ubo_layout_binding.descriptorType     = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        ubo_layout_binding.pImmutableSamplers = nullptr;
-        ubo_layout_binding.stageFlags         = VK_SHADER_STAGE_VERTEX_BIT;
-
-        VkDescriptorSetLayoutBinding sampler_layout_binding {};
-        sampler_layout_binding.binding            = 1;
-        sampler_layout_binding.descriptorCount    = 1;
-        sampler_layout_binding.descriptorType     = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        sampler_layout_binding.pImmutableSamplers = nullptr;
-        sampler_layout_binding.stageFlags         = VK_SHADER_STAGE_FRAGMENT_BIT;
-
-        VkDescriptorSetLayoutBinding light_layout_binding {};
-        light_layout_binding.binding            = 2;
-        light_layout_binding.descriptorCount    = 1;
-        light_layout_binding.descriptorType     = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-        light_layout_binding.pImmutableSamplers = nullptr;
-        light_layout_binding.stageFlags         = VK_SHADER_STAGE_FRAGMENT_BIT;
-
-        std::array<VkDescriptorSetLayoutBinding, 3> bindings = {ubo_layout_binding, sampler_layout_binding, light_layout_binding};
-
-        VkDescriptorSetLayoutCreateInfo layout_info {};
-        layout_info.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-        layout_info.bindingCount = static_cast<uint32_t>(bindings.size());
-        layout_info.pBindings    = bindings.data();
-
-        if (vkCreateDescriptorSetLayout(m_device->m_device, &layout_info, nullptr, &m_descriptor_set_layout) != VK_SUCCESS)
+        // the layout follows the shaders, stages declaring the same bindings share them
+        std::vector<const ShaderReflection*> stages;
+        for (const auto& reflection : m_shader->m_reflections)
         {
-            LOG_FATAL("failed to create descriptor set layout!");
+            stages.push_back(&reflection);
+        }
+        if (!PipelineLayoutDesc::merge(stages, m_layout_desc) || m_layout_desc.sets.empty())
+        {
+            LOG_FATAL("failed to reflect the pipeline layout!");
+        }
+
+        if (m_dynamic_uniforms)
+        {
+            for (auto& binding : m_layout_desc.sets[0].bindings)
+            {
+                if (binding.type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER)
+                {
+                    binding.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+                }
+            }
+        }
+
+        m_descriptor_set_layout = m_layout_cache->getDescriptorSetLayout(m_layout_desc.sets[0]);
+        m_pipeline_layout       = m_layout_cache->getPipelineLayout(m_layout_desc);
+        if (m_descriptor_set_layout == VK_NULL_HANDLE || m_pipeline_layout == VK_NULL_HANDLE)
+        {
+            LOG_FATAL("failed to create pipeline layout!");
         }
     }
 
@@ -129,16 +126,6 @@ namespace ArchViz
         dynamic_state.dynamicStateCount = static_cast<uint32_t>(dynamic_states.size());
         dynamic_state.pDynamicStates    = dynamic_states.data();
 
-        VkPipelineLayoutCreateInfo pipeline_layout_info {};
-        pipeline_layout_info.sType          = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-        pipeline_layout_info.setLayoutCount = 1;
-        pipeline_layout_info.pSetLayouts    = &m_descriptor_set_layout;
-
-        if (vkCreatePipelineLayout(m_device->m_device, &pipeline_layout_info, nullptr, &m_pipeline_layout) != VK_SUCCESS)
-        {
-            LOG_FATAL("failed to create pipeline layout!")
-        }
-
         VkGraphicsPipelineCreateInfo pipeline_info {};
         pipeline_info.sType               = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
         pipeline_info.stageCount          = static_cast<uint32_t>(m_shader->m_stage_info.size());
@@ -164,8 +151,7 @@ namespace ArchViz
 
     void VulkanPipeline::clear()
     {
+        // the layouts belong to the layout cache, other pipelines may share them
         vkDestroyPipeline(m_device->m_device, m_pipeline, nullptr);
-        vkDestroyPipelineLayout(m_device->m_device, m_pipeline_layout, nullptr);
-        vkDestroyDescriptorSetLayout(m_device->m_device, m_descriptor_set_layout, nullptr);
     }
 } // namespace ArchViz
\ No newline at end of file
@@ -12,6 +12,7 @@ namespace ArchViz
     class AssetManager;
     class ConfigManager;
     class VulkanDevice;
+    class VulkanLayoutCache;
     class VulkanShader;
 
     class DescriptorSetLayoutCreateInfo
@@ -36,19 +37,23 @@ namespace ArchViz
         void clear();
 
     private:
-        void createDescriptorSetLayout();
+        void createPipelineLayout();
         void createPipeline();
 
     public:
-        std::shared_ptr<VulkanDevice> m_device;
-        std::shared_ptr<VulkanShader> m_shader;
+        std::shared_ptr<VulkanDevice>      m_device;
+        std::shared_ptr<VulkanShader>      m_shader;
+        std::shared_ptr<VulkanLayoutCache> m_layout_cache; // owns the layouts below
 
         VkPipelineCache m_pipeline_cache;
         VkRenderPass    m_render_pass;
 
+        bool m_dynamic_uniforms {false}; // the uniform buffers of set 0 are bound with dynamic offsets
+
         VkPipelineLayout m_pipeline_layout;
         VkPipeline       m_pipeline;
 
-        VkDescriptorSetLayout m_descriptor_set_layout;
+        PipelineLayoutDesc    m_layout_desc; // merged reflection of the shader stages
+        VkDescriptorSetLayout m_descriptor_set_layout; // of set 0
     };
 } // namespace ArchViz
\ No newline at end of file
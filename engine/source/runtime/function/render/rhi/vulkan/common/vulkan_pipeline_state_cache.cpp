@@ -0,0 +1,404 @@
+#include "runtime/function/render/rhi/vulkan/common/vulkan_pipeline_state_cache.h"
+#include "runtime/function/render/rhi/vulkan/common/vulkan_device.h"
+#include "runtime/function/render/rhi/vulkan/common/vulkan_layout_cache.h"
+#include "runtime/function/render/rhi/vulkan/utils/vulkan_shader_utils.h"
+
+#include "runtime/function/render/rhi/shader_reflection.h"
+#include "runtime/function/render/rhi/spirv_parser.h"
+
+#include "runtime/function/global/global_context.h"
+
+#include "runtime/resource/asset_manager/asset_manager.h"
+
+#include "runtime/core/base/macro.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace ArchViz
+{
+    namespace
+    {
+        VkFormat to_vk_vertex_format(VertexComponentFormat::Enum format)
+        {
+            switch (format)
+            {
+                case VertexComponentFormat::Float:
+                    return VK_FORMAT_R32_SFLOAT;
+                case VertexComponentFormat::Float2:
+                    return VK_FORMAT_R32G32_SFLOAT;
+                case VertexComponentFormat::Float3:
+                    return VK_FORMAT_R32G32B32_SFLOAT;
+                case VertexComponentFormat::Float4:
+                case VertexComponentFormat::Mat4:
+                    return VK_FORMAT_R32G32B32A32_SFLOAT;
+                case VertexComponentFormat::Byte:
+                    return VK_FORMAT_R8_SINT;
+                case VertexComponentFormat::Byte4N:
+                    return VK_FORMAT_R8G8B8A8_SNORM;
+                case VertexComponentFormat::UByte:
+                    return VK_FORMAT_R8_UINT;
+                case VertexComponentFormat::UByte4N:
+                    return VK_FORMAT_R8G8B8A8_UNORM;
+                case VertexComponentFormat::Short2:
+                    return VK_FORMAT_R16G16_SINT;
+                case VertexComponentFormat::Short2N:
+                    return VK_FORMAT_R16G16_SNORM;
+                case VertexComponentFormat::Short4:
+                    return VK_FORMAT_R16G16B16A16_SINT;
+                case VertexComponentFormat::Short4N:
+                    return VK_FORMAT_R16G16B16A16_SNORM;
+                case VertexComponentFormat::Uint:
+                    return VK_FORMAT_R32_UINT;
+                case VertexComponentFormat::Uint2:
+                    return VK_FORMAT_R32G32_UINT;
+                case VertexComponentFormat::Uint4:
+                    return VK_FORMAT_R32G32B32A32_UINT;
+                default:
+                    return VK_FORMAT_UNDEFINED;
+            }
+        }
+
+        VkPolygonMode to_vk_polygon_mode(FillMode::Enum fill)
+        {
+            switch (fill)
+            {
+                case FillMode::Wireframe:
+                    return VK_POLYGON_MODE_LINE;
+                case FillMode::Point:
+                    return VK_POLYGON_MODE_POINT;
+                default:
+                    return VK_POLYGON_MODE_FILL;
+            }
+        }
+
+        // glslang picks the stage from the extension
+        const char* stage_file_name(VkShaderStageFlagBits stage)
+        {
+            switch (stage)
+            {
+                case VK_SHADER_STAGE_VERTEX_BIT:
+                    return "pipeline.vert";
+                case VK_SHADER_STAGE_FRAGMENT_BIT:
+                    return "pipeline.frag";
+                case VK_SHADER_STAGE_GEOMETRY_BIT:
+                    return "pipeline.geom";
+                case VK_SHADER_STAGE_COMPUTE_BIT:
+                    return "pipeline.comp";
+                case VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT:
+                    return "pipeline.tesc";
+                case VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT:
+                    return "pipeline.tese";
+                default:
+                    return nullptr;
+            }
+        }
+
+        VkStencilOpState to_vk_stencil(const StencilOperationState& state)
+        {
+            VkStencilOpState stencil {};
+            stencil.failOp      = state.fail;
+            stencil.passOp      = state.pass;
+            stencil.depthFailOp = state.depth_fail;
+            stencil.compareOp   = state.compare;
+            stencil.compareMask = state.compare_mask;
+            stencil.writeMask   = state.write_mask;
+            stencil.reference   = state.reference;
+            return stencil;
+        }
+
+        // the stage as spir-v plus its reflection, compiled from glsl unless the creation already holds spir-v
+        bool load_stage(const ShaderStage& stage, bool spv_input, std::vector<uint32_t>& spirv, ShaderReflection& reflection)
+        {
+            if (spv_input)
+            {
+                const size_t size = std::min<size_t>(stage.code_size, stage.code.size());
+                if (size == 0 || size % sizeof(uint32_t) != 0)
+                {
+                    return false;
+                }
+                spirv.resize(size / sizeof(uint32_t));
+                std::memcpy(spirv.data(), stage.code.data(), size);
+                return SPIRV::reflect(spirv, reflection);
+            }
+
+            const char* file_name = stage_file_name(stage.type);
+            if (file_name == nullptr)
+            {
+                return false;
+            }
+            spirv = VulkanShaderUtils::createShaderModuleFromCode(stage.code, file_name, {}, &reflection);
+            return !spirv.empty();
+        }
+    } // namespace
+
+    void VulkanPipelineStateCache::initialize()
+    {
+        loadPipelineCache();
+
+        m_cache.initialize([this](const PipelineCreation& creation, VulkanPipelineState& state) { return compile(creation, state); },
+                           [this](VulkanPipelineState& state) { vkDestroyPipeline(m_device->m_device, state.pipeline, nullptr); },
+                           m_executor);
+    }
+
+    void VulkanPipelineStateCache::clear()
+    {
+        // the layouts belong to the layout cache
+        m_cache.clear();
+
+        savePipelineCache();
+
+        vkDestroyPipelineCache(m_device->m_device, m_pipeline_cache, nullptr);
+        m_pipeline_cache = VK_NULL_HANDLE;
+    }
+
+    VulkanPipelineState VulkanPipelineStateCache::request(const PipelineCreation& creation, const VulkanPipelineState& fallback) { return m_cache.request(creation, fallback); }
+
+    bool VulkanPipelineStateCache::get(const PipelineCreation& creation, VulkanPipelineState& state) { return m_cache.get(creation, state); }
+
+    PipelineState::Enum VulkanPipelineStateCache::state(const PipelineCreation& creation) const { return m_cache.state(creation.hash()); }
+
+    PipelineStateStatistics VulkanPipelineStateCache::getStatistics() const { return m_cache.getStatistics(); }
+
+    void VulkanPipelineStateCache::loadPipelineCache()
+    {
+        VkPipelineCacheCreateInfo create_info {};
+        create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+
+        std::vector<std::byte> cache;
+        if (!m_cache_path.empty() && std::filesystem::exists(m_cache_path))
+        {
+            g_runtime_global_context.m_asset_manager->readBinaryFile(m_cache_path, cache);
+        }
+        if (validate_pipeline_cache(cache.data(), cache.size(), m_device->m_properties))
+        {
+            create_info.initialDataSize = cache.size();
+            create_info.pInitialData    = cache.data();
+        }
+
+        if (vkCreatePipelineCache(m_device->m_device, &create_info, nullptr, &m_pipeline_cache) != VK_SUCCESS)
+        {
+            LOG_FATAL("failed to create pipeline cache");
+        }
+    }
+
+    void VulkanPipelineStateCache::savePipelineCache()
+    {
+        if (m_cache_path.empty() || m_pipeline_cache == VK_NULL_HANDLE)
+        {
+            return;
+        }
+
+        size_t cache_size = 0;
+        vkGetPipelineCacheData(m_device->m_device, m_pipeline_cache, &cache_size, nullptr);
+        std::vector<std::byte> cache(cache_size);
+        if (cache_size == 0 || vkGetPipelineCacheData(m_device->m_device, m_pipeline_cache, &cache_size, cache.data()) != VK_SUCCESS)
+        {
+            LOG_WARN("failed to read pipeline cache data");
+            return;
+        }
+        cache.resize(cache_size);
+
+        g_runtime_global_context.m_asset_manager->writeBinaryFile(m_cache_path, cache);
+    }
+
+    bool VulkanPipelineStateCache::compile(const PipelineCreation& creation, VulkanPipelineState& state)
+    {
+        const ShaderStateCreation& shaders = creation.shaders;
+
+        std::vector<ShaderReflection>                reflections(shaders.stages_count);
+        std::vector<VkPipelineShaderStageCreateInfo> stage_infos;
+
+        auto destroy_modules = [&]() {
+            for (auto& stage_info : stage_infos)
+            {
+                vkDestroyShaderModule(m_device->m_device, stage_info.module, nullptr);
+            }
+        };
+
+        for (uint32_t i = 0; i < shaders.stages_count; ++i)
+        {
+            std::vector<uint32_t> spirv;
+            VkShaderModule        module = VK_NULL_HANDLE;
+            if (load_stage(shaders.stages[i], shaders.spv_input, spirv, reflections[i]))
+            {
+                module = VulkanShaderUtils::createShaderModule(m_device->m_device, spirv);
+            }
+            if (module == VK_NULL_HANDLE)
+            {
+                LOG_ERROR("failed to create shader stage {} of {}", i, creation.name);
+                destroy_modules();
+                return false;
+            }
+
+            VkPipelineShaderStageCreateInfo stage_info {};
+            stage_info.sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+            stage_info.stage  = shaders.stages[i].type;
+            stage_info.module = module;
+            stage_info.pName  = "main";
+            stage_infos.push_back(stage_info);
+        }
+
+        // the reflected layout wins over creation.descriptor_set_layout, the layout cache shares it between pipelines
+        std::vector<const ShaderReflection*> stages;
+        for (const auto& reflection : reflections)
+        {
+            stages.push_back(&reflection);
+        }
+        PipelineLayoutDesc layout_desc;
+        if (stage_infos.empty() || !PipelineLayoutDesc::merge(stages, layout_desc))
+        {
+            LOG_ERROR("failed to reflect the pipeline layout of {}", creation.name);
+            destroy_modules();
+            return false;
+        }
+        state.layout = m_layout_cache->getPipelineLayout(layout_desc);
+        if (state.layout == VK_NULL_HANDLE)
+        {
+            destroy_modules();
+            return false;
+        }
+
+        VkResult result = VK_SUCCESS;
+        if (stage_infos.size() == 1 && stage_infos[0].stage == VK_SHADER_STAGE_COMPUTE_BIT)
+        {
+            VkComputePipelineCreateInfo pipeline_info {};
+            pipeline_info.sType  = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+            pipeline_info.stage  = stage_infos[0];
+            pipeline_info.layout = state.layout;
+
+            state.bind_point = VK_PIPELINE_BIND_POINT_COMPUTE;
+            result           = vkCreateComputePipelines(m_device->m_device, m_pipeline_cache, 1, &pipeline_info, nullptr, &state.pipeline);
+        }
+        else
+        {
+            const VertexInputCreation& vertex_input = creation.vertex_input;
+
+            std::vector<VkVertexInputBindingDescription>   vertex_bindings;
+            std::vector<VkVertexInputAttributeDescription> vertex_attributes;
+            for (uint32_t i = 0; i < vertex_input.num_vertex_streams; ++i)
+            {
+                const VertexStream& stream = vertex_input.vertex_streams[i];
+                vertex_bindings.push_back({stream.binding, stream.stride, stream.input_rate == VertexInputRate::PerInstance ? VK_VERTEX_INPUT_RATE_INSTANCE : VK_VERTEX_INPUT_RATE_VERTEX});
+            }
+            for (uint32_t i = 0; i < vertex_input.num_vertex_attributes; ++i)
+            {
+                const VertexAttribute& attribute = vertex_input.vertex_attributes[i];
+                vertex_attributes.push_back({attribute.location, attribute.binding, to_vk_vertex_format(attribute.format), attribute.offset});
+            }
+
+            VkPipelineVertexInputStateCreateInfo vertex_input_info {};
+            vertex_input_info.sType                           = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+            vertex_input_info.vertexBindingDescriptionCount   = static_cast<uint32_t>(vertex_bindings.size());
+            vertex_input_info.pVertexBindingDescriptions      = vertex_bindings.data();
+            vertex_input_info.vertexAttributeDescriptionCount = static_cast<uint32_t>(vertex_attributes.size());
+            vertex_input_info.pVertexAttributeDescriptions    = vertex_attributes.data();
+
+            VkPipelineInputAssemblyStateCreateInfo input_assembly {};
+            input_assembly.sType                  = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+            input_assembly.topology               = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+            input_assembly.primitiveRestartEnable = VK_FALSE;
+
+            VkPipelineViewportStateCreateInfo viewport_state {};
+            viewport_state.sType         = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+            viewport_state.viewportCount = 1;
+            viewport_state.scissorCount  = 1;
+
+            VkPipelineRasterizationStateCreateInfo rasterizer {};
+            rasterizer.sType                   = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+            rasterizer.depthClampEnable        = VK_FALSE;
+            rasterizer.rasterizerDiscardEnable = VK_FALSE;
+            rasterizer.polygonMode             = to_vk_polygon_mode(creation.rasterization.fill);
+            rasterizer.lineWidth               = 1.0f;
+            rasterizer.cullMode                = creation.rasterization.cull_mode;
+            rasterizer.frontFace               = creation.rasterization.front;
+            rasterizer.depthBiasEnable         = VK_FALSE;
+
+            VkPipelineMultisampleStateCreateInfo multisampling {};
+            multisampling.sType                = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+            multisampling.sampleShadingEnable  = VK_FALSE;
+            multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+            const DepthStencilCreation&           depth_stencil_creation = creation.depth_stencil;
+            VkPipelineDepthStencilStateCreateInfo depth_stencil {};
+            depth_stencil.sType                 = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+            depth_stencil.depthTestEnable       = depth_stencil_creation.depth_enable ? VK_TRUE : VK_FALSE;
+            depth_stencil.depthWriteEnable      = depth_stencil_creation.depth_write_enable ? VK_TRUE : VK_FALSE;
+            depth_stencil.depthCompareOp        = depth_stencil_creation.depth_comparison;
+            depth_stencil.depthBoundsTestEnable = VK_FALSE;
+            depth_stencil.stencilTestEnable     = depth_stencil_creation.stencil_enable ? VK_TRUE : VK_FALSE;
+            depth_stencil.front                 = to_vk_stencil(depth_stencil_creation.front);
+            depth_stencil.back                  = to_vk_stencil(depth_stencil_creation.back);
+            depth_stencil.minDepthBounds        = 0.0f;
+            depth_stencil.maxDepthBounds        = 1.0f;
+
+            // one attachment state per color output, outputs without a blend state just write all channels
+            std::vector<VkPipelineColorBlendAttachmentState> blend_attachments(std::max<uint32_t>(creation.render_pass.num_color_formats, 1));
+            for (uint32_t i = 0; i < blend_attachments.size(); ++i)
+            {
+                VkPipelineColorBlendAttachmentState& attachment = blend_attachments[i];
+                attachment.colorWriteMask                       = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+                attachment.blendEnable                          = VK_FALSE;
+                if (i >= creation.blend_state.active_states)
+                {
+                    continue;
+                }
+
+                const BlendState& blend = creation.blend_state.blend_states[i];
+
+                attachment.colorWriteMask      = static_cast<VkColorComponentFlags>(blend.color_write_mask);
+                attachment.blendEnable         = blend.blend_enabled ? VK_TRUE : VK_FALSE;
+                attachment.srcColorBlendFactor = blend.source_color;
+                attachment.dstColorBlendFactor = blend.destination_color;
+                attachment.colorBlendOp        = blend.color_operation;
+                attachment.srcAlphaBlendFactor = blend.separate_blend ? blend.source_alpha : blend.source_color;
+                attachment.dstAlphaBlendFactor = blend.separate_blend ? blend.destination_alpha : blend.destination_color;
+                attachment.alphaBlendOp        = blend.separate_blend ? blend.alpha_operation : blend.color_operation;
+            }
+
+            VkPipelineColorBlendStateCreateInfo color_blending {};
+            color_blending.sType           = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+            color_blending.logicOpEnable   = VK_FALSE;
+            color_blending.logicOp         = VK_LOGIC_OP_COPY;
+            color_blending.attachmentCount = static_cast<uint32_t>(blend_attachments.size());
+            color_blending.pAttachments    = blend_attachments.data();
+
+            std::vector<VkDynamicState>      dynamic_states = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+            VkPipelineDynamicStateCreateInfo dynamic_state {};
+            dynamic_state.sType             = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+            dynamic_state.dynamicStateCount = static_cast<uint32_t>(dynamic_states.size());
+            dynamic_state.pDynamicStates    = dynamic_states.data();
+
+            VkGraphicsPipelineCreateInfo pipeline_info {};
+            pipeline_info.sType               = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+            pipeline_info.stageCount          = static_cast<uint32_t>(stage_infos.size());
+            pipeline_info.pStages             = stage_infos.data();
+            pipeline_info.pVertexInputState   = &vertex_input_info;
+            pipeline_info.pInputAssemblyState = &input_assembly;
+            pipeline_info.pViewportState      = &viewport_state;
+            pipeline_info.pRasterizationState = &rasterizer;
+            pipeline_info.pMultisampleState   = &multisampling;
+            pipeline_info.pColorBlendState    = &color_blending;
+            pipeline_info.pDepthStencilState  = &depth_stencil;
+            pipeline_info.pDynamicState       = &dynamic_state;
+            pipeline_info.layout              = state.layout;
+            pipeline_info.renderPass          = m_render_pass;
+            pipeline_info.subpass             = 0;
+            pipeline_info.basePipelineHandle  = VK_NULL_HANDLE;
+
+            state.bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS;
+            result           = vkCreateGraphicsPipelines(m_device->m_device, m_pipeline_cache, 1, &pipeline_info, nullptr, &state.pipeline);
+        }
+
+        // the pipeline keeps its own copy of the code
+        destroy_modules();
+
+        if (result != VK_SUCCESS)
+        {
+            state.pipeline = VK_NULL_HANDLE;
+            return false;
+        }
+        return true;
+    }
+} // namespace ArchViz
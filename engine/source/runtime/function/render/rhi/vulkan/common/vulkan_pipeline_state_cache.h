@@ -0,0 +1,58 @@
+#pragma once
+#include "runtime/function/render/rhi/pipeline_state_cache.h"
+
+#include <volk.h>
+
+#include <filesystem>
+#include <memory>
+
+namespace ArchViz
+{
+    class VulkanDevice;
+    class VulkanLayoutCache;
+    class WorkExecutor;
+
+    struct VulkanPipelineState
+    {
+        VkPipeline          pipeline {VK_NULL_HANDLE};
+        VkPipelineLayout    layout {VK_NULL_HANDLE};
+        VkPipelineBindPoint bind_point {VK_PIPELINE_BIND_POINT_GRAPHICS};
+    };
+
+    // PipelineCreation -> VkPipeline, compiled on m_executor and shared by every request with the same key
+    // the VkPipelineCache behind it is loaded from and saved to m_cache_path, a blob from another device or driver is dropped
+    class VulkanPipelineStateCache
+    {
+    public:
+        void initialize();
+        void clear();
+
+        // returns fallback until the pipeline of the creation is compiled
+        VulkanPipelineState request(const PipelineCreation& creation, const VulkanPipelineState& fallback);
+        // compiles or waits for the pipeline of the creation
+        bool get(const PipelineCreation& creation, VulkanPipelineState& state);
+
+        PipelineState::Enum     state(const PipelineCreation& creation) const;
+        PipelineStateStatistics getStatistics() const;
+
+    public:
+        std::shared_ptr<VulkanDevice>      m_device;
+        std::shared_ptr<VulkanLayoutCache> m_layout_cache; // the pipeline layouts come from the reflected shaders
+        std::shared_ptr<WorkExecutor>      m_executor;     // compiles inline when null
+
+        // graphics pipelines are built against this pass, the RenderPassOutput of a creation must be compatible with it
+        VkRenderPass m_render_pass {VK_NULL_HANDLE};
+
+        std::filesystem::path m_cache_path;
+        VkPipelineCache       m_pipeline_cache {VK_NULL_HANDLE};
+
+    private:
+        void loadPipelineCache();
+        void savePipelineCache();
+
+        bool compile(const PipelineCreation& creation, VulkanPipelineState& state);
+
+    private:
+        PipelineStateCache<VulkanPipelineState> m_cache;
+    };
+} // namespace ArchViz
@@ -13,6 +13,8 @@ namespace ArchViz
 
     void VulkanShader::initialize()
     {
+        m_reflections.clear();
+
         createShaderModule(m_config.m_vert_shader, m_vert_shader);
         createShaderModule(m_config.m_frag_shader, m_frag_shader);
         createShaderModule(m_config.m_geom_shader, m_geom_shader);
@@ -78,8 +80,13 @@ namespace ArchViz
     {
         if (file.size() > 0)
         {
-            auto spv = VulkanShaderUtils::createShaderModuleFromVFS(file);
-            shader   = VulkanShaderUtils::createShaderModule(m_device->m_device, spv);
+            ShaderReflection reflection;
+            auto             spv = VulkanShaderUtils::createShaderModuleFromVFS(file, m_config.m_defines, &reflection);
+            shader               = VulkanShaderUtils::createShaderModule(m_device->m_device, spv);
+            if (shader != VK_NULL_HANDLE)
+            {
+                m_reflections.push_back(std::move(reflection));
+            }
         }
     }
 
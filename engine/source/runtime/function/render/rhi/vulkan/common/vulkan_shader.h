@@ -1,5 +1,6 @@
 #pragma once
 #include "runtime/core/meta/reflection/reflection.h"
+#include "runtime/function/render/rhi/shader_reflection.h"
 
 #include <volk.h>
 
@@ -24,6 +25,9 @@ namespace ArchViz
         std::string m_comp_shader;
         std::string m_tesc_shader;
         std::string m_tese_shader;
+
+        // permutation of every stage, "NAME" or "NAME=VALUE"
+        std::vector<std::string> m_defines;
     };
 
     class VulkanShader
@@ -56,5 +60,8 @@ namespace ArchViz
         VkShaderModule m_tese_shader = VK_NULL_HANDLE;
 
         std::vector<VkPipelineShaderStageCreateInfo> m_stage_info;
+
+        // of every stage that has a module, from the shader cache or manifest, kept after clear() for the pipeline layout
+        std::vector<ShaderReflection> m_reflections;
     };
 } // namespace ArchViz
@@ -0,0 +1,557 @@
+#include "runtime/function/render/rhi/vulkan/common/vulkan_staging_uploader.h"
+#include "runtime/function/render/rhi/vulkan/common/vulkan_device.h"
+#include "runtime/function/render/rhi/vulkan/utils/vulkan_buffer_utils.h"
+#include "runtime/function/render/rhi/vulkan/utils/vulkan_texture_utils.h"
+
+#include "runtime/function/global/global_context.h"
+
+#include "runtime/resource/resource_manager/resource_manager.h"
+
+#include "runtime/core/base/macro.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ArchViz
+{
+    void VulkanStagingUploader::initialize()
+    {
+        ASSERT(m_device);
+        ASSERT(m_device->m_timeline_semaphore_support);
+
+        m_transfer_family = m_device->m_indices.m_transfer_family.value();
+        m_graphics_family = m_device->m_indices.m_graphics_family.value();
+
+        // recordAcquire blits the mip chains in the family the uploads are released to
+        ASSERT(m_device->m_queue_family_properties[m_graphics_family].queueFlags & VK_QUEUE_GRAPHICS_BIT);
+
+        // 16 covers the texel blocks of every format uploaded, buffer to image copies need a multiple of it
+        m_alignment = std::max<VkDeviceSize>(16, m_device->m_properties.limits.optimalBufferCopyOffsetAlignment);
+
+        void* mapped = nullptr;
+        auto  usage  = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        auto  flag   = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        VulkanBufferUtils::createBuffer(m_device, m_capacity, usage, flag, m_ring_buffer, m_ring_allocation, &mapped);
+        m_ring_mapped = static_cast<uint8_t*>(mapped);
+        m_ring.initialize(m_capacity);
+
+        VkCommandPoolCreateInfo pool_info {};
+        pool_info.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        pool_info.flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        pool_info.queueFamilyIndex = m_transfer_family;
+
+        if (vkCreateCommandPool(m_device->m_device, &pool_info, nullptr, &m_command_pool) != VK_SUCCESS)
+        {
+            LOG_FATAL("failed to create staging command pool!");
+        }
+
+        VkSemaphoreTypeCreateInfo type_info {};
+        type_info.sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+        type_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        type_info.initialValue  = 0;
+
+        VkSemaphoreCreateInfo semaphore_info {};
+        semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        semaphore_info.pNext = &type_info;
+
+        if (vkCreateSemaphore(m_device->m_device, &semaphore_info, nullptr, &m_timeline) != VK_SUCCESS)
+        {
+            LOG_FATAL("failed to create staging timeline semaphore!");
+        }
+    }
+
+    void VulkanStagingUploader::clear()
+    {
+        if (m_timeline != VK_NULL_HANDLE && m_submitted > 0)
+        {
+            VkSemaphoreWaitInfo wait_info {};
+            wait_info.sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+            wait_info.semaphoreCount = 1;
+            wait_info.pSemaphores    = &m_timeline;
+            wait_info.pValues        = &m_submitted;
+            vkWaitSemaphores(m_device->m_device, &wait_info, UINT64_MAX);
+        }
+
+        for (auto& batch : m_in_flight)
+        {
+            for (size_t i = 0; i < batch.fallback_buffers.size(); ++i)
+            {
+                VulkanBufferUtils::destroyBuffer(m_device, batch.fallback_buffers[i], batch.fallback_allocations[i]);
+            }
+        }
+        for (auto& request : m_queued)
+        {
+            if (request.fallback != VK_NULL_HANDLE)
+            {
+                VulkanBufferUtils::destroyBuffer(m_device, request.staging_buffer, request.fallback);
+            }
+        }
+        m_in_flight.clear();
+        m_queued.clear();
+        m_acquires.clear();
+        m_free_command_buffers.clear();
+
+        if (m_command_pool != VK_NULL_HANDLE)
+        {
+            vkDestroyCommandPool(m_device->m_device, m_command_pool, nullptr);
+            m_command_pool = VK_NULL_HANDLE;
+        }
+        if (m_timeline != VK_NULL_HANDLE)
+        {
+            vkDestroySemaphore(m_device->m_device, m_timeline, nullptr);
+            m_timeline = VK_NULL_HANDLE;
+        }
+        if (m_ring_buffer != VK_NULL_HANDLE)
+        {
+            VulkanBufferUtils::destroyBuffer(m_device, m_ring_buffer, m_ring_allocation);
+            m_ring_mapped = nullptr;
+        }
+        m_ring.clear();
+    }
+
+    void VulkanStagingUploader::stage(const void* data, VkDeviceSize size, GpuUploadRequest& request)
+    {
+        // the copy stays under the lock, a flush in between would retire the range before its bytes are there
+        const uint64_t offset = m_ring.allocate(size, m_alignment);
+        if (offset != StagingRing::k_invalid_offset)
+        {
+            memcpy(m_ring_mapped + offset, data, static_cast<size_t>(size));
+            request.staging_buffer = m_ring_buffer;
+            request.staging_offset = offset;
+            return;
+        }
+
+        // larger than the ring or the gpu is behind, a buffer of its own keeps the caller from waiting
+        void* mapped = nullptr;
+        auto  usage  = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        auto  flag   = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        VulkanBufferUtils::createBuffer(m_device, size, usage, flag, request.staging_buffer, request.fallback, &mapped);
+
+        memcpy(mapped, data, static_cast<size_t>(size));
+        request.staging_offset = 0;
+        m_statistics.fallback_uploads += 1;
+    }
+
+    uint64_t VulkanStagingUploader::uploadBuffer(VkBuffer dst_buffer, VkDeviceSize dst_offset, const void* data, VkDeviceSize size, const ResourceHandle& resource)
+    {
+        ASSERT(data && size > 0);
+
+        GpuUploadRequest request;
+        request.size       = size;
+        request.dst_buffer = dst_buffer;
+        request.dst_offset = dst_offset;
+        request.resource   = resource;
+
+        uint64_t token = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            stage(data, size, request);
+
+            token = request.token = m_submitted + 1;
+            m_queued.push_back(std::move(request));
+
+            m_statistics.buffer_uploads += 1;
+            m_statistics.bytes += size;
+        }
+
+        if (is_valid_handle(resource))
+        {
+            g_runtime_global_context.m_resource_manager->setUploadToken(resource, token);
+        }
+        return token;
+    }
+
+    uint64_t VulkanStagingUploader::uploadImage(VkImage                               dst_image,
+                                                uint32_t                              width,
+                                                uint32_t                              height,
+                                                uint32_t                              mip_levels,
+                                                const std::vector<VkBufferImageCopy>& regions,
+                                                const void*                           data,
+                                                VkDeviceSize                          size,
+                                                bool                                  generate_mips,
+                                                VkImageLayout                         final_layout,
+                                                const ResourceHandle&                 resource)
+    {
+        ASSERT(data && size > 0 && !regions.empty());
+        ASSERT(!generate_mips || final_layout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+        GpuUploadRequest request;
+        request.size          = size;
+        request.dst_image     = dst_image;
+        request.regions       = regions;
+        request.width         = width;
+        request.height        = height;
+        request.mip_levels    = mip_levels;
+        request.generate_mips = generate_mips && mip_levels > 1;
+        request.final_layout  = final_layout;
+        request.resource      = resource;
+
+        uint64_t token = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            stage(data, size, request);
+
+            token = request.token = m_submitted + 1;
+            m_queued.push_back(std::move(request));
+
+            m_statistics.image_uploads += 1;
+            m_statistics.bytes += size;
+        }
+
+        if (is_valid_handle(resource))
+        {
+            g_runtime_global_context.m_resource_manager->setUploadToken(resource, token);
+        }
+        return token;
+    }
+
+    void VulkanStagingUploader::update()
+    {
+        uint64_t completed = 0;
+        if (vkGetSemaphoreCounterValue(m_device->m_device, m_timeline, &completed) != VK_SUCCESS)
+        {
+            LOG_FATAL("failed to read staging timeline semaphore!");
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_completed = completed;
+            m_ring.reclaim(completed);
+
+            while (!m_in_flight.empty() && m_in_flight.front().value <= completed)
+            {
+                Batch& batch = m_in_flight.front();
+                for (size_t i = 0; i < batch.fallback_buffers.size(); ++i)
+                {
+                    VulkanBufferUtils::destroyBuffer(m_device, batch.fallback_buffers[i], batch.fallback_allocations[i]);
+                }
+                m_free_command_buffers.push_back(batch.command_buffer);
+                m_in_flight.pop_front();
+            }
+        }
+
+        g_runtime_global_context.m_resource_manager->setCompletedUploadToken(completed);
+    }
+
+    void VulkanStagingUploader::flush()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_queued.empty())
+        {
+            return;
+        }
+
+        VkCommandBuffer command_buffer = acquireCommandBuffer();
+
+        VkCommandBufferBeginInfo begin_info {};
+        begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        if (vkBeginCommandBuffer(command_buffer, &begin_info) != VK_SUCCESS)
+        {
+            LOG_FATAL("failed to begin recording staging command buffer!");
+        }
+        recordCopies(command_buffer, m_queued);
+        if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS)
+        {
+            LOG_FATAL("failed to record staging command buffer!");
+        }
+
+        const uint64_t value = m_submitted + 1;
+
+        VkTimelineSemaphoreSubmitInfo timeline_info {};
+        timeline_info.sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        timeline_info.signalSemaphoreValueCount = 1;
+        timeline_info.pSignalSemaphoreValues    = &value;
+
+        VkSubmitInfo submit_info {};
+        submit_info.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit_info.pNext                = &timeline_info;
+        submit_info.commandBufferCount   = 1;
+        submit_info.pCommandBuffers      = &command_buffer;
+        submit_info.signalSemaphoreCount = 1;
+        submit_info.pSignalSemaphores    = &m_timeline;
+
+        if (vkQueueSubmit(m_device->m_transfer_queue, 1, &submit_info, VK_NULL_HANDLE) != VK_SUCCESS)
+        {
+            LOG_FATAL("failed to submit staging command buffer!");
+        }
+
+        m_submitted = value;
+        m_ring.retire(value);
+
+        Batch batch;
+        batch.value          = value;
+        batch.command_buffer = command_buffer;
+        for (auto& request : m_queued)
+        {
+            if (request.fallback != VK_NULL_HANDLE)
+            {
+                batch.fallback_buffers.push_back(request.staging_buffer);
+                batch.fallback_allocations.push_back(request.fallback);
+            }
+
+            // buffers in the same family are ready as soon as the timeline is waited for
+            if (request.dst_image != VK_NULL_HANDLE || ownershipTransfer())
+            {
+                m_acquires.push_back(std::move(request));
+            }
+        }
+        m_in_flight.push_back(std::move(batch));
+        m_queued.clear();
+
+        m_statistics.batches += 1;
+    }
+
+    void VulkanStagingUploader::recordCopies(VkCommandBuffer command_buffer, const std::vector<GpuUploadRequest>& requests)
+    {
+        std::vector<VkImageMemoryBarrier> to_transfer;
+        for (const auto& request : requests)
+        {
+            if (request.dst_image == VK_NULL_HANDLE)
+            {
+                continue;
+            }
+
+            VkImageMemoryBarrier barrier {};
+            barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.oldLayout                       = VK_IMAGE_LAYOUT_UNDEFINED;
+            barrier.newLayout                       = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            barrier.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+            barrier.image                           = request.dst_image;
+            barrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+            barrier.subresourceRange.baseMipLevel   = 0;
+            barrier.subresourceRange.levelCount     = request.mip_levels;
+            barrier.subresourceRange.baseArrayLayer = 0;
+            barrier.subresourceRange.layerCount     = 1;
+            barrier.srcAccessMask                   = 0;
+            barrier.dstAccessMask                   = VK_ACCESS_TRANSFER_WRITE_BIT;
+            to_transfer.push_back(barrier);
+        }
+        if (!to_transfer.empty())
+        {
+            vkCmdPipelineBarrier(
+                command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(to_transfer.size()), to_transfer.data());
+        }
+
+        std::vector<VkBufferImageCopy> regions;
+        for (const auto& request : requests)
+        {
+            if (request.dst_image == VK_NULL_HANDLE)
+            {
+                VkBufferCopy copy_region {};
+                copy_region.srcOffset = request.staging_offset;
+                copy_region.dstOffset = request.dst_offset;
+                copy_region.size      = request.size;
+                vkCmdCopyBuffer(command_buffer, request.staging_buffer, request.dst_buffer, 1, &copy_region);
+                continue;
+            }
+
+            regions = request.regions;
+            for (auto& region : regions)
+            {
+                region.bufferOffset += request.staging_offset;
+            }
+            vkCmdCopyBufferToImage(command_buffer, request.staging_buffer, request.dst_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(regions.size()), regions.data());
+        }
+
+        if (!ownershipTransfer())
+        {
+            return;
+        }
+
+        // release to the graphics family, recordAcquire records the matching acquire there
+        std::vector<VkBufferMemoryBarrier> buffer_releases;
+        std::vector<VkImageMemoryBarrier>  image_releases;
+        for (const auto& request : requests)
+        {
+            if (request.dst_image == VK_NULL_HANDLE)
+            {
+                VkBufferMemoryBarrier barrier {};
+                barrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+                barrier.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+                barrier.dstAccessMask       = 0;
+                barrier.srcQueueFamilyIndex = m_transfer_family;
+                barrier.dstQueueFamilyIndex = m_graphics_family;
+                barrier.buffer              = request.dst_buffer;
+                barrier.offset              = request.dst_offset;
+                barrier.size                = request.size;
+                buffer_releases.push_back(barrier);
+                continue;
+            }
+
+            VkImageMemoryBarrier barrier {};
+            barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.oldLayout                       = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            barrier.newLayout                       = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            barrier.srcQueueFamilyIndex             = m_transfer_family;
+            barrier.dstQueueFamilyIndex             = m_graphics_family;
+            barrier.image                           = request.dst_image;
+            barrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+            barrier.subresourceRange.baseMipLevel   = 0;
+            barrier.subresourceRange.levelCount     = request.mip_levels;
+            barrier.subresourceRange.baseArrayLayer = 0;
+            barrier.subresourceRange.layerCount     = 1;
+            barrier.srcAccessMask                   = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask                   = 0;
+            image_releases.push_back(barrier);
+        }
+
+        vkCmdPipelineBarrier(command_buffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                             0,
+                             0,
+                             nullptr,
+                             static_cast<uint32_t>(buffer_releases.size()),
+                             buffer_releases.data(),
+                             static_cast<uint32_t>(image_releases.size()),
+                             image_releases.data());
+    }
+
+    uint64_t VulkanStagingUploader::recordAcquire(VkCommandBuffer command_buffer, uint64_t required)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // waiting for a value that was never submitted would hang the queue
+        required             = std::min(required, m_submitted);
+        const uint64_t limit = std::max(required, m_completed);
+
+        std::vector<VkBufferMemoryBarrier> buffer_acquires;
+        std::vector<VkImageMemoryBarrier>  image_acquires;
+        std::vector<GpuUploadRequest>      mips;
+
+        const uint32_t src_family = ownershipTransfer() ? m_transfer_family : VK_QUEUE_FAMILY_IGNORED;
+        const uint32_t dst_family = ownershipTransfer() ? m_graphics_family : VK_QUEUE_FAMILY_IGNORED;
+
+        uint64_t wait = required;
+        while (!m_acquires.empty() && m_acquires.front().token <= limit)
+        {
+            GpuUploadRequest& request = m_acquires.front();
+            wait                      = std::max(wait, request.token);
+
+            if (request.dst_image == VK_NULL_HANDLE)
+            {
+                VkBufferMemoryBarrier barrier {};
+                barrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+                barrier.srcAccessMask       = 0;
+                barrier.dstAccessMask       = VK_ACCESS_MEMORY_READ_BIT;
+                barrier.srcQueueFamilyIndex = src_family;
+                barrier.dstQueueFamilyIndex = dst_family;
+                barrier.buffer              = request.dst_buffer;
+                barrier.offset              = request.dst_offset;
+                barrier.size                = request.size;
+                buffer_acquires.push_back(barrier);
+            }
+            else if (!request.generate_mips || ownershipTransfer())
+            {
+                // the mip chain is blitted after the acquire and leaves the image in its final layout itself
+                VkImageMemoryBarrier barrier {};
+                barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+                barrier.oldLayout                       = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+                barrier.newLayout                       = request.generate_mips ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL : request.final_layout;
+                barrier.srcQueueFamilyIndex             = src_family;
+                barrier.dstQueueFamilyIndex             = dst_family;
+                barrier.image                           = request.dst_image;
+                barrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+                barrier.subresourceRange.baseMipLevel   = 0;
+                barrier.subresourceRange.levelCount     = request.mip_levels;
+                barrier.subresourceRange.baseArrayLayer = 0;
+                barrier.subresourceRange.layerCount     = 1;
+                barrier.srcAccessMask                   = 0;
+                barrier.dstAccessMask                   = request.generate_mips ? VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT : VK_ACCESS_SHADER_READ_BIT;
+                image_acquires.push_back(barrier);
+            }
+
+            if (request.generate_mips)
+            {
+                mips.push_back(std::move(request));
+            }
+            m_acquires.pop_front();
+        }
+
+        // the writes of the copies are made visible by waiting for the timeline, the barriers only order the layouts
+        if (!buffer_acquires.empty() || !image_acquires.empty())
+        {
+            vkCmdPipelineBarrier(command_buffer,
+                                 VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                 VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                                 0,
+                                 0,
+                                 nullptr,
+                                 static_cast<uint32_t>(buffer_acquires.size()),
+                                 buffer_acquires.data(),
+                                 static_cast<uint32_t>(image_acquires.size()),
+                                 image_acquires.data());
+        }
+
+        for (const auto& request : mips)
+        {
+            VulkanTextureUtils::recordGenerateMipmaps(command_buffer, request.dst_image, request.width, request.height, request.mip_levels);
+        }
+
+        return wait;
+    }
+
+    VkCommandBuffer VulkanStagingUploader::acquireCommandBuffer()
+    {
+        if (!m_free_command_buffers.empty())
+        {
+            VkCommandBuffer command_buffer = m_free_command_buffers.back();
+            m_free_command_buffers.pop_back();
+            return command_buffer;
+        }
+
+        VkCommandBufferAllocateInfo alloc_info {};
+        alloc_info.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        alloc_info.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        alloc_info.commandPool        = m_command_pool;
+        alloc_info.commandBufferCount = 1;
+
+        VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+        if (vkAllocateCommandBuffers(m_device->m_device, &alloc_info, &command_buffer) != VK_SUCCESS)
+        {
+            LOG_FATAL("failed to allocate staging command buffer!");
+        }
+        return command_buffer;
+    }
+
+    bool VulkanStagingUploader::isComplete(uint64_t token) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return token <= m_completed;
+    }
+
+    uint64_t VulkanStagingUploader::completedValue() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_completed;
+    }
+
+    uint64_t VulkanStagingUploader::submittedValue() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_submitted;
+    }
+
+    bool VulkanStagingUploader::isIdle() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_queued.empty() && m_acquires.empty();
+    }
+
+    void VulkanStagingUploader::logStatistics() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        const StagingRingStatistics& ring = m_ring.getStatistics();
+        LOG_INFO("[vulkan] staging: {} batches, {} buffer and {} image uploads, {} bytes, {} through buffers of their own",
+                 m_statistics.batches,
+                 m_statistics.buffer_uploads,
+                 m_statistics.image_uploads,
+                 m_statistics.bytes,
+                 m_statistics.fallback_uploads);
+        LOG_INFO("[vulkan]     ring peak {} of {} bytes, {} allocations refused while full", ring.peak_used, m_ring.capacity(), ring.full);
+    }
+} // namespace ArchViz
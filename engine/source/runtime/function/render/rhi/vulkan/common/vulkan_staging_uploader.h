@@ -0,0 +1,123 @@
+#pragma once
+#include "runtime/function/render/rhi/staging_ring.h"
+#include "runtime/function/render/rhi/vulkan/utils/vulkan_async_utils.h"
+
+#include "runtime/resource/resource_manager/resource_handle.h"
+
+#include <vk_mem_alloc.h>
+#include <volk.h>
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ArchViz
+{
+    class VulkanDevice;
+
+    struct StagingUploadStatistics
+    {
+        uint64_t batches {0};
+        uint64_t buffer_uploads {0};
+        uint64_t image_uploads {0};
+        uint64_t fallback_uploads {0}; // went through a staging buffer of their own because the ring was full
+        uint64_t bytes {0};
+    };
+
+    // copies data into device local buffers and images without waiting for it. The bytes are staged in a persistently mapped
+    // ring, flush submits everything queued since the last flush as one batch on the transfer queue that signals the next
+    // value of m_timeline, and that value is the token handed back for each upload. update reclaims the ring once a batch
+    // completed and reports the completed value to the ResourceManager. Uploading is thread safe, flush, update and
+    // recordAcquire belong to the render thread.
+    class VulkanStagingUploader
+    {
+    public:
+        void initialize();
+        void clear();
+
+        // the tokens returned are those of the next flush
+        uint64_t uploadBuffer(VkBuffer dst_buffer, VkDeviceSize dst_offset, const void* data, VkDeviceSize size, const ResourceHandle& resource = k_invalid_res_handle);
+        // the image ends up in final_layout, with generate_mips only level 0 has to be in regions
+        uint64_t uploadImage(VkImage                               dst_image,
+                             uint32_t                              width,
+                             uint32_t                              height,
+                             uint32_t                              mip_levels,
+                             const std::vector<VkBufferImageCopy>& regions,
+                             const void*                           data,
+                             VkDeviceSize                          size,
+                             bool                                  generate_mips,
+                             VkImageLayout                         final_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                             const ResourceHandle&                 resource     = k_invalid_res_handle);
+
+        // reclaims the batches the gpu finished, once a frame before anything is uploaded
+        void update();
+        // submits the queued copies, once a frame before the command buffers using them are submitted
+        void flush();
+
+        // records what the graphics family has to do before the uploads are used: taking ownership from the transfer family,
+        // the mip blits and the final layouts. command_buffer has to be a graphics command buffer submitted on the graphics
+        // queue. It covers every completed batch and every batch up to required, the submit of command_buffer has to wait
+        // for the returned value of m_timeline.
+        uint64_t recordAcquire(VkCommandBuffer command_buffer, uint64_t required = 0);
+
+        bool     isComplete(uint64_t token) const;
+        uint64_t completedValue() const;
+        uint64_t submittedValue() const;
+        // nothing queued and nothing left to acquire, no copy or barrier still names a destination handle
+        bool isIdle() const;
+
+        const StagingUploadStatistics& getStatistics() const { return m_statistics; }
+        void                           logStatistics() const;
+
+    public:
+        std::shared_ptr<VulkanDevice> m_device;
+
+        VkDeviceSize m_capacity {32ull * 1024 * 1024};
+
+        VkSemaphore m_timeline {VK_NULL_HANDLE};
+
+    private:
+        // copies the bytes into the ring, or a buffer of their own when it is full
+        void stage(const void* data, VkDeviceSize size, GpuUploadRequest& request);
+
+        void recordCopies(VkCommandBuffer command_buffer, const std::vector<GpuUploadRequest>& requests);
+
+        VkCommandBuffer acquireCommandBuffer();
+
+        bool ownershipTransfer() const { return m_transfer_family != m_graphics_family; }
+
+    private:
+        struct Batch
+        {
+            uint64_t        value {0};
+            VkCommandBuffer command_buffer {VK_NULL_HANDLE};
+
+            std::vector<VkBuffer>      fallback_buffers;
+            std::vector<VmaAllocation> fallback_allocations;
+        };
+
+        mutable std::mutex m_mutex;
+
+        StagingRing   m_ring;
+        VkBuffer      m_ring_buffer {VK_NULL_HANDLE};
+        VmaAllocation m_ring_allocation {VK_NULL_HANDLE};
+        uint8_t*      m_ring_mapped {nullptr};
+        VkDeviceSize  m_alignment {16};
+
+        uint32_t      m_transfer_family {0};
+        uint32_t      m_graphics_family {0};
+        VkCommandPool m_command_pool {VK_NULL_HANDLE};
+
+        std::vector<VkCommandBuffer>  m_free_command_buffers;
+        std::vector<GpuUploadRequest> m_queued;
+        std::deque<Batch>             m_in_flight;
+        std::deque<GpuUploadRequest>  m_acquires; // submitted, waiting to be recorded by recordAcquire
+
+        uint64_t m_submitted {0};
+        uint64_t m_completed {0};
+
+        StagingUploadStatistics m_statistics;
+    };
+} // namespace ArchViz
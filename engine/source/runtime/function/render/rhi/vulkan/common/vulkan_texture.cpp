@@ -1,6 +1,7 @@
 #include "runtime/function/render/rhi/vulkan/common/vulkan_texture.h"
+#include "runtime/function/render/rhi/vulkan/common/vulkan_bindless_table.h"
 #include "runtime/function/render/rhi/vulkan/common/vulkan_device.h"
-#include "runtime/function/render/rhi/vulkan/utils/vulkan_buffer_utils.h"
+#include "runtime/function/render/rhi/vulkan/common/vulkan_staging_uploader.h"
 #include "runtime/function/render/rhi/vulkan/utils/vulkan_texture_utils.h"
 #include "runtime/function/render/rhi/vulkan/utils/vulkan_utils.h"
 
@@ -8,6 +9,7 @@
 
 #include "runtime/resource/asset_manager/asset_manager.h"
 #include "runtime/resource/config_manager/config_manager.h"
+#include "runtime/resource/res_type/data/material_data.h"
 
 #include "runtime/core/base/macro.h"
 
@@ -17,6 +19,28 @@
 
 namespace ArchViz
 {
+    namespace
+    {
+        VkFormat texture_vk_format(TextureFormat format, bool srgb)
+        {
+            switch (format)
+            {
+                case TextureFormat::BC1:
+                    return srgb ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+                case TextureFormat::BC3:
+                    return srgb ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK;
+                case TextureFormat::BC4:
+                    return VK_FORMAT_BC4_UNORM_BLOCK;
+                case TextureFormat::BC5:
+                    return VK_FORMAT_BC5_UNORM_BLOCK;
+                case TextureFormat::BC7:
+                    return srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+                default:
+                    return srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+            }
+        }
+    } // namespace
+
     void VulkanTexture::createTextureImageFromFile(const std::string& image_uri)
     {
         std::filesystem::path root       = g_runtime_global_context.m_config_manager->getRootFolder();
@@ -90,39 +114,82 @@ namespace ArchViz
 
     void VulkanTexture::createTextureImage(const uint8_t* pixels, const size_t image_size)
     {
-        VkBuffer       staging_buffer;
-        VkDeviceMemory staging_buffer_memory;
-        auto           usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-        auto           flag  = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-        VulkanBufferUtils::createBuffer(m_device, image_size, usage, flag, staging_buffer, staging_buffer_memory);
-
-        void* data;
-        vkMapMemory(m_device->m_device, staging_buffer_memory, 0, image_size, 0, &data);
+        m_tiling          = VK_IMAGE_TILING_OPTIMAL;
+        m_usage           = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        m_memory_property = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+        m_image_layout    = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        if (!VulkanTextureUtils::supportsLinearBlit(m_device, m_format))
         {
-            memcpy(data, pixels, static_cast<size_t>(image_size));
+            LOG_FATAL("texture image format does not support linear blitting!");
+        }
+
+        VulkanTextureUtils::createImage(m_device, m_width, m_height, m_mip_levels, m_format, m_tiling, m_usage, m_memory_property, m_image, m_allocation);
+
+        VkBufferImageCopy region {};
+        region.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel       = 0;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount     = 1;
+        region.imageExtent                     = {m_width, m_height, 1};
+
+        // level 0 is copied on the transfer queue, the rest of the chain is blitted when the graphics queue acquires it
+        m_upload_token = m_uploader->uploadImage(m_image, m_width, m_height, m_mip_levels, {region}, pixels, image_size, true, m_image_layout, m_resource);
+    }
+
+    void VulkanTexture::createTextureImageFromData(const TextureData& texture)
+    {
+        // rgba8 without cpu mips falls back to the blit path, block compressed formats cannot be blitted
+        if (texture.m_levels.size() <= 1 && !texture_format_compressed(texture.m_format))
+        {
+            createTextureImageFromMemory(texture.m_data.data(), texture.m_data.size(), texture_vk_format(texture.m_format, texture.m_srgb), texture.m_width, texture.m_height);
+            return;
+        }
+
+        m_width      = texture.m_width;
+        m_height     = texture.m_height;
+        m_channel    = 4;
+        m_mip_levels = texture.mipLevels();
+        m_format     = texture_vk_format(texture.m_format, texture.m_srgb);
+
+        std::vector<TextureLevel> levels = texture.m_levels;
+        if (levels.empty())
+        {
+            TextureLevel level;
+            level.width  = static_cast<uint32_t>(texture.m_width);
+            level.height = static_cast<uint32_t>(texture.m_height);
+            level.size   = texture.m_data.size();
+            levels.push_back(level);
         }
-        vkUnmapMemory(m_device->m_device, staging_buffer_memory);
 
         m_tiling          = VK_IMAGE_TILING_OPTIMAL;
-        m_usage           = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        m_usage           = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
         m_memory_property = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
         m_image_layout    = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
-        VulkanTextureUtils::createImage(m_device, m_width, m_height, m_mip_levels, m_format, m_tiling, m_usage, m_memory_property, m_image, m_device_memory);
-
-        VulkanTextureUtils::transitionImageLayout(m_device, m_command_pool, m_image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, m_mip_levels);
-        VulkanTextureUtils::copyBufferToImage(m_device, m_command_pool, staging_buffer, m_image, static_cast<uint32_t>(m_width), static_cast<uint32_t>(m_height));
-        // VulkanTextureUtils::transitionImageLayout(m_device, m_command_pool, m_image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, m_image_layout, m_mip_levels);
+        VulkanTextureUtils::createImage(m_device, m_width, m_height, m_mip_levels, m_format, m_tiling, m_usage, m_memory_property, m_image, m_allocation);
 
-        VulkanBufferUtils::destroyBuffer(m_device, staging_buffer, staging_buffer_memory);
+        std::vector<VkBufferImageCopy> regions(m_mip_levels);
+        for (uint32_t level = 0; level < m_mip_levels; ++level)
+        {
+            const TextureLevel& info = levels[level];
+
+            VkBufferImageCopy& region              = regions[level];
+            region.bufferOffset                    = info.offset;
+            region.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel       = level;
+            region.imageSubresource.baseArrayLayer = 0;
+            region.imageSubresource.layerCount     = 1;
+            region.imageExtent                     = {info.width, info.height, 1};
+        }
 
-        VulkanTextureUtils::generateMipmaps(m_device, m_command_pool, m_image, m_format, m_width, m_height, m_mip_levels);
+        m_upload_token = m_uploader->uploadImage(m_image, m_width, m_height, m_mip_levels, regions, texture.m_data.data(), texture.m_data.size(), false, m_image_layout, m_resource);
     }
 
     void VulkanTexture::createTextureImageView()
     {
         // create image view
-        m_view = VulkanTextureUtils::createImageView(m_device, m_image, m_format, VK_IMAGE_ASPECT_COLOR_BIT, 1);
+        m_view = VulkanTextureUtils::createImageView(m_device, m_image, m_format, VK_IMAGE_ASPECT_COLOR_BIT, m_mip_levels);
     }
 
     void VulkanTexture::createTextureSampler()
@@ -155,38 +222,12 @@ namespace ArchViz
         }
     }
 
-    void VulkanTexture::createDescriptorSet()
+    void VulkanTexture::createBindlessIndex()
     {
-        if (m_descriptor_pool == VK_NULL_HANDLE || m_descriptor_set_layout == VK_NULL_HANDLE)
+        if (m_bindless_table)
         {
-            return;
+            m_bindless_index = m_bindless_table->addTexture(m_view, m_sampler, m_image_layout);
         }
-
-        // create descriptor set
-        VkDescriptorSetAllocateInfo alloc_info = {};
-        alloc_info.sType                       = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-        alloc_info.descriptorPool              = m_descriptor_pool;
-        alloc_info.descriptorSetCount          = 1;
-        alloc_info.pSetLayouts                 = &m_descriptor_set_layout;
-        if (vkAllocateDescriptorSets(m_device->m_device, &alloc_info, &m_descriptor_set) != VK_SUCCESS)
-        {
-            LOG_FATAL("failed to create vulkan texture descriptor set");
-        }
-
-        // update descriptor set
-        VkDescriptorImageInfo desc_image[1] {};
-        desc_image[0].sampler     = m_sampler;
-        desc_image[0].imageView   = m_view;
-        desc_image[0].imageLayout = m_image_layout;
-
-        VkWriteDescriptorSet write_desc[1] {};
-        write_desc[0].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        write_desc[0].dstSet          = m_descriptor_set;
-        write_desc[0].descriptorCount = 1;
-        write_desc[0].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        write_desc[0].pImageInfo      = desc_image;
-
-        vkUpdateDescriptorSets(m_device->m_device, 1, write_desc, 0, nullptr);
     }
 
     void VulkanTexture::initizlize(const std::string& image_uri)
@@ -194,6 +235,7 @@ namespace ArchViz
         createTextureImageFromFile(image_uri);
         createTextureImageView();
         createTextureSampler();
+        createBindlessIndex();
     }
 
     void VulkanTexture::initialize(const uint8_t* pixels, const VkDeviceSize image_size, VkFormat format, uint32_t width, uint32_t height)
@@ -201,6 +243,15 @@ namespace ArchViz
         createTextureImageFromMemory(pixels, image_size, format, width, height);
         createTextureImageView();
         createTextureSampler();
+        createBindlessIndex();
+    }
+
+    void VulkanTexture::initialize(const TextureData& texture)
+    {
+        createTextureImageFromData(texture);
+        createTextureImageView();
+        createTextureSampler();
+        createBindlessIndex();
     }
 
     void VulkanTexture::initialize(const uint8_t* pixels, const VkDeviceSize image_size)
@@ -208,14 +259,20 @@ namespace ArchViz
         createTextureImageFromMemory(pixels, image_size);
         createTextureImageView();
         createTextureSampler();
+        createBindlessIndex();
     }
 
     void VulkanTexture::clear()
     {
+        if (m_bindless_table)
+        {
+            m_bindless_table->release(BindlessResourceType::Texture, m_bindless_index);
+            m_bindless_index = VulkanBindlessTable::k_invalid_index;
+        }
+
         vkDestroySampler(m_device->m_device, m_sampler, nullptr);
         vkDestroyImageView(m_device->m_device, m_view, nullptr);
-        vkFreeMemory(m_device->m_device, m_device_memory, nullptr);
-        vkDestroyImage(m_device->m_device, m_image, nullptr);
+        VulkanTextureUtils::destroyImage(m_device, m_image, m_allocation);
     }
 
 } // namespace ArchViz
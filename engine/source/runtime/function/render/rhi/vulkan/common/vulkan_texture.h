@@ -1,6 +1,9 @@
 #pragma once
 
+#include "runtime/resource/resource_manager/resource_handle.h"
+
 #include <volk.h>
+#include <vk_mem_alloc.h>
 
 #include <memory>
 #include <string>
@@ -9,7 +12,10 @@ namespace ArchViz
 {
     class AssetManager;
     class ConfigManager;
+    class VulkanBindlessTable;
     class VulkanDevice;
+    class VulkanStagingUploader;
+    class TextureData;
 
     class VulkanTexture
     {
@@ -17,35 +23,39 @@ namespace ArchViz
         void initizlize(const std::string& image_uri);                                                                           // from file
         void initialize(const uint8_t* image_data, const VkDeviceSize size);                                                     // no decode
         void initialize(const uint8_t* pixels, const VkDeviceSize image_size, VkFormat format, uint32_t width, uint32_t height); // after decode
-
-        // TODO : add initialize from TextureData
+        void initialize(const TextureData& texture);                                                                             // cooked, uses the cpu mips when present
 
         void clear();
 
-        void createDescriptorSet();
-
     private:
         void createTextureImageFromFile(const std::string& image_uri);
         void createTextureImageFromMemory(const uint8_t* image_data, const VkDeviceSize size);
         void createTextureImageFromMemory(const uint8_t* pixels, const VkDeviceSize image_size, VkFormat format, uint32_t width, uint32_t height);
         void createTextureImage(const uint8_t* pixels, const size_t image_size);
+        void createTextureImageFromData(const TextureData& texture);
         void createTextureImageView();
         void createTextureSampler();
+        void createBindlessIndex();
 
     public:
-        std::shared_ptr<VulkanDevice>  m_device;
+        std::shared_ptr<VulkanDevice>          m_device;
+        std::shared_ptr<VulkanStagingUploader> m_uploader;
+        std::shared_ptr<VulkanBindlessTable>   m_bindless_table;
 
         VkCommandPool m_command_pool;
 
-        VkDescriptorSetLayout m_descriptor_set_layout = VK_NULL_HANDLE;
-        VkDescriptorPool      m_descriptor_pool       = VK_NULL_HANDLE;
-        VkDescriptorSet       m_descriptor_set        = VK_NULL_HANDLE; // for imgui imgui show
+        // the pixels are copied and the mips generated asynchronously, the image is usable once the token completed
+        ResourceHandle m_resource {k_invalid_res_handle};
+        uint64_t       m_upload_token {0};
+
+        // where shaders and imgui find the texture in m_bindless_table
+        uint32_t m_bindless_index {~0u};
 
         VkImage               m_image;
         VkImageView           m_view;
         VkSampler             m_sampler;
         VkImageLayout         m_image_layout;
-        VkDeviceMemory        m_device_memory;
+        VmaAllocation         m_allocation {VK_NULL_HANDLE};
         VkDescriptorImageInfo m_descriptor;
 
         VkFormat              m_format;
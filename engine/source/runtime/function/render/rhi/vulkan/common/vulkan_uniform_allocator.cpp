@@ -0,0 +1,61 @@
+#include "runtime/function/render/rhi/vulkan/common/vulkan_uniform_allocator.h"
+#include "runtime/function/render/rhi/vulkan/common/vulkan_device.h"
+#include "runtime/function/render/rhi/vulkan/utils/vulkan_buffer_utils.h"
+#include "runtime/function/render/rhi/vulkan/vulkan_struct.h"
+
+#include "runtime/core/base/macro.h"
+
+#include <algorithm>
+
+namespace ArchViz
+{
+    void VulkanUniformAllocator::initialize()
+    {
+        ASSERT(m_device);
+
+        const VkDeviceSize alignment = std::max<VkDeviceSize>(1, m_device->m_properties.limits.minUniformBufferOffsetAlignment);
+        const VkDeviceSize size      = m_frame_size / alignment * alignment * VulkanConstants::k_max_frames_in_flight;
+
+        // dynamic offsets are 32 bit
+        ASSERT(size <= k_invalid_offset);
+
+        void* mapped = nullptr;
+        auto  usage  = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+        auto  flag   = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        VulkanBufferUtils::createBuffer(m_device, size, usage, flag, m_buffer, m_allocation, &mapped);
+
+        m_allocator.initialize(mapped, static_cast<size_t>(m_frame_size), VulkanConstants::k_max_frames_in_flight, static_cast<size_t>(alignment));
+    }
+
+    void VulkanUniformAllocator::clear()
+    {
+        VulkanBufferUtils::destroyBuffer(m_device, m_buffer, m_allocation);
+        m_allocator.clear();
+    }
+
+    void VulkanUniformAllocator::beginFrame(uint32_t frame) { m_allocator.beginFrame(frame); }
+
+    uint32_t VulkanUniformAllocator::allocate(VkDeviceSize size, void** mapped)
+    {
+        const size_t offset = m_allocator.allocate(static_cast<size_t>(size));
+        if (offset == FrameLinearAllocator::k_invalid_offset)
+        {
+            LOG_ERROR("[vulkan] uniform allocator: frame {} has no room left for {} bytes of its {}", m_allocator.frame(), size, m_allocator.frameSize());
+            return k_invalid_offset;
+        }
+
+        *mapped = m_allocator.data(offset);
+        return static_cast<uint32_t>(offset);
+    }
+
+    void VulkanUniformAllocator::logStatistics() const
+    {
+        const FrameLinearStatistics statistics = m_allocator.getStatistics();
+        LOG_INFO("[vulkan] uniforms: {} allocations, {} bytes, peak {} of {} bytes a frame, {} refused",
+                 statistics.allocations,
+                 statistics.bytes,
+                 statistics.peak,
+                 m_allocator.frameSize(),
+                 statistics.refused);
+    }
+} // namespace ArchViz
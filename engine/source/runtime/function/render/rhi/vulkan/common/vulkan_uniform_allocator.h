@@ -0,0 +1,62 @@
+#pragma once
+#include "runtime/core/memory/allocators/frame_linear_allocator.h"
+
+#include <vk_mem_alloc.h>
+#include <volk.h>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+namespace ArchViz
+{
+    class VulkanDevice;
+
+    // the uniform data of every frame in flight in one persistently mapped, host coherent buffer. A frame gets m_frame_size
+    // bytes of it, handed out by a FrameLinearAllocator at minUniformBufferOffsetAlignment and reset by beginFrame after the
+    // frame fence wait. Sets point their dynamic uniform buffers at offset 0 of m_buffer once, a draw passes the offsets of
+    // its data when binding them, so per draw data needs no descriptor of its own. Pushing is thread safe.
+    class VulkanUniformAllocator
+    {
+    public:
+        static constexpr uint32_t k_invalid_offset = ~0u;
+
+        void initialize();
+        void clear();
+
+        // the frame slot whose fence was just waited for
+        void beginFrame(uint32_t frame);
+
+        // the dynamic offset of size bytes in the current frame, mapped gets where to write them
+        uint32_t allocate(VkDeviceSize size, void** mapped);
+
+        template<typename T>
+        uint32_t push(const T& value)
+        {
+            void*          mapped = nullptr;
+            const uint32_t offset = allocate(sizeof(T), &mapped);
+            if (offset != k_invalid_offset)
+            {
+                std::memcpy(mapped, &value, sizeof(T));
+            }
+            return offset;
+        }
+
+        // for a dynamic uniform buffer binding of range bytes, written once
+        VkDescriptorBufferInfo getDescriptorInfo(VkDeviceSize range) const { return {m_buffer, 0, range}; }
+
+        FrameLinearStatistics getStatistics() const { return m_allocator.getStatistics(); }
+        void                  logStatistics() const;
+
+    public:
+        std::shared_ptr<VulkanDevice> m_device;
+
+        VkDeviceSize m_frame_size {1024 * 1024};
+
+        VkBuffer      m_buffer {VK_NULL_HANDLE};
+        VmaAllocation m_allocation {VK_NULL_HANDLE};
+
+    private:
+        FrameLinearAllocator m_allocator;
+    };
+} // namespace ArchViz
@@ -1,9 +1,13 @@
 #pragma once
 #include "runtime/function/render/rhi/gpu_resources.h"
 
+#include "runtime/resource/resource_manager/resource_handle.h"
+
+#include <vk_mem_alloc.h>
 #include <volk.h>
 
 #include <string>
+#include <vector>
 
 namespace ArchViz
 {
@@ -14,12 +18,27 @@ namespace ArchViz
         TextureHandle texture = k_invalid_texture;
     };
 
+    // one copy queued on the staging uploader, the source bytes already sit in staging memory
     struct GpuUploadRequest
     {
-        void*         data       = nullptr;
-        BufferHandle  cpu_buffer = k_invalid_buffer;
-        BufferHandle  gpu_buffer = k_invalid_buffer;
-        TextureHandle texture    = k_invalid_texture;
+        VkBuffer      staging_buffer = VK_NULL_HANDLE;
+        VkDeviceSize  staging_offset = 0;
+        VmaAllocation fallback       = VK_NULL_HANDLE; // a staging buffer of its own when the ring was full, freed with its batch
+        VkDeviceSize  size           = 0;
+
+        VkBuffer     dst_buffer = VK_NULL_HANDLE;
+        VkDeviceSize dst_offset = 0;
+
+        VkImage                        dst_image = VK_NULL_HANDLE;
+        std::vector<VkBufferImageCopy> regions; // buffer offsets relative to the start of the staged bytes
+        uint32_t                       width         = 0;
+        uint32_t                       height        = 0;
+        uint32_t                       mip_levels    = 1;
+        bool                           generate_mips = false; // levels after 0 are blitted from it on the consuming queue
+        VkImageLayout                  final_layout  = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        ResourceHandle resource = k_invalid_res_handle;
+        uint64_t       token    = 0; // the timeline value of the batch the copy was submitted in
     };
 
     class VulkanAsyncUtils
@@ -14,15 +14,16 @@ namespace ArchViz
     class VulkanBufferUtils
     {
     public:
-        static void createBufferVMA(std::shared_ptr<VulkanDevice> device, VkDeviceSize size, VkBufferUsageFlags usage, VkBuffer& buffer, VmaAllocation& allocation);
-
-        static void destroyBufferVMA(std::shared_ptr<VulkanDevice> device, VkBuffer& buffer, VmaAllocation& allocation);
-
-        static void createBuffer(std::shared_ptr<VulkanDevice> device, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& buffer_memory);
-
-        static void copyBuffer(std::shared_ptr<VulkanDevice> device, VkCommandPool command_pool, VkBuffer src_buffer, VkBuffer dst_buffer, VkDeviceSize size);
-
-        static void destroyBuffer(std::shared_ptr<VulkanDevice> device, VkBuffer& buffer, VkDeviceMemory& buffer_memory);
+        // host visible buffers are mapped for their whole life, mapped gets the pointer
+        static void createBuffer(std::shared_ptr<VulkanDevice> device,
+                                 VkDeviceSize                  size,
+                                 VkBufferUsageFlags            usage,
+                                 VkMemoryPropertyFlags         properties,
+                                 VkBuffer&                     buffer,
+                                 VmaAllocation&                buffer_allocation,
+                                 void**                        mapped = nullptr);
+
+        static void destroyBuffer(std::shared_ptr<VulkanDevice> device, VkBuffer& buffer, VmaAllocation& buffer_allocation);
 
         static VkCommandBuffer beginSingleTimeCommands(std::shared_ptr<VulkanDevice> device, VkCommandPool command_pool);
 
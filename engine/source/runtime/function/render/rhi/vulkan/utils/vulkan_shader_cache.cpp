@@ -0,0 +1,264 @@
+#include "runtime/function/render/rhi/vulkan/utils/vulkan_shader_cache.h"
+#include "runtime/function/render/rhi/shader_reflection.h"
+
+#include "runtime/core/base/hash.h"
+#include "runtime/core/base/macro.h"
+
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+namespace ArchViz
+{
+    namespace
+    {
+        constexpr uint32_t k_cache_magic    = 0x43535641; // "AVSC"
+        constexpr uint32_t k_cache_version  = 2;
+        constexpr uint32_t k_max_path       = 4096;
+        constexpr uint32_t k_max_reflection = 1 << 20;
+
+        struct CacheHeader
+        {
+            uint32_t magic {k_cache_magic};
+            uint32_t version {k_cache_version};
+            uint64_t key {0};
+            uint32_t dependency_count {0};
+            uint32_t word_count {0};
+            uint32_t reflection_size {0}; // serialized ShaderReflection after the words
+        };
+
+        template<typename T>
+        bool read_value(std::ifstream& file, T& value)
+        {
+            file.read(reinterpret_cast<char*>(&value), sizeof(T));
+            return static_cast<bool>(file);
+        }
+
+        template<typename T>
+        void write_value(std::ofstream& file, const T& value)
+        {
+            file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        double elapsed_ms(std::chrono::high_resolution_clock::time_point start)
+        {
+            return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        }
+    } // namespace
+
+    VulkanShaderCache::VulkanShaderCache(const std::filesystem::path& folder) : m_folder(folder) {}
+
+    void VulkanShaderCache::setFolder(const std::filesystem::path& folder)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_folder = folder;
+    }
+
+    uint64_t VulkanShaderCache::computeKey(const std::string& source, const std::string& name, const std::vector<std::string>& defines, uint64_t environment)
+    {
+        // hash_bytes mixes the length in, so neighbouring strings cannot shift into each other
+        uint64_t key = Hash::hash_bytes(source.data(), source.size(), environment);
+        key          = Hash::hash_bytes(name.data(), name.size(), key);
+        for (const auto& define : defines)
+        {
+            key = Hash::hash_bytes(define.data(), define.size(), key);
+        }
+        return key;
+    }
+
+    std::filesystem::path VulkanShaderCache::getEntryPath(uint64_t key) const
+    {
+        std::ostringstream name;
+        name << std::hex << std::setw(16) << std::setfill('0') << key << ".spv";
+        return m_folder / name.str();
+    }
+
+    bool VulkanShaderCache::load(uint64_t key, std::vector<uint32_t>& spirv, ShaderReflection& reflection, std::vector<std::string>* dependencies)
+    {
+        if (!enabled())
+        {
+            return false;
+        }
+
+        auto          start = std::chrono::high_resolution_clock::now();
+        std::ifstream file(getEntryPath(key), std::ios::binary);
+        if (!file)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_statistics.misses += 1;
+            return false;
+        }
+
+        CacheHeader header;
+        if (!read_value(file, header) || header.magic != k_cache_magic || header.version != k_cache_version || header.key != key || header.reflection_size > k_max_reflection)
+        {
+            LOG_WARN("invalid shader cache entry {}", getEntryPath(key).generic_string());
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_statistics.misses += 1;
+            return false;
+        }
+
+        std::vector<std::string> paths;
+        for (uint32_t i = 0; i < header.dependency_count; ++i)
+        {
+            uint32_t length = 0;
+            uint64_t stored = 0;
+            uint64_t current;
+            if (!read_value(file, length) || length > k_max_path)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_statistics.misses += 1;
+                return false;
+            }
+            std::string path(length, '\0');
+            file.read(path.data(), length);
+            if (!read_value(file, stored) || !dependencyHash(path, current) || current != stored)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_statistics.stale += 1;
+                return false;
+            }
+            paths.push_back(std::move(path));
+        }
+
+        spirv.resize(header.word_count);
+        file.read(reinterpret_cast<char*>(spirv.data()), static_cast<std::streamsize>(spirv.size() * sizeof(uint32_t)));
+
+        std::vector<uint8_t> reflection_data(header.reflection_size);
+        file.read(reinterpret_cast<char*>(reflection_data.data()), static_cast<std::streamsize>(reflection_data.size()));
+        if (!file || spirv.empty() || !reflection.deserialize(reflection_data.data(), reflection_data.size()))
+        {
+            spirv.clear();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_statistics.misses += 1;
+            return false;
+        }
+
+        if (dependencies != nullptr)
+        {
+            *dependencies = std::move(paths);
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_statistics.hits += 1;
+        m_statistics.load_ms += elapsed_ms(start);
+        return true;
+    }
+
+    void VulkanShaderCache::store(uint64_t key, const std::vector<uint32_t>& spirv, const ShaderReflection& reflection, const std::vector<std::string>& dependencies)
+    {
+        if (!enabled() || spirv.empty())
+        {
+            return;
+        }
+
+        std::vector<uint64_t> hashes(dependencies.size());
+        for (size_t i = 0; i < dependencies.size(); ++i)
+        {
+            if (dependencies[i].size() > k_max_path || !dependencyHash(dependencies[i], hashes[i]))
+            {
+                LOG_WARN("shader include {} cannot be tracked, not cached", dependencies[i]);
+                return;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::create_directories(m_folder, error);
+
+        // parallel compiles of the same key write identical bytes, the rename keeps readers from seeing a partial file
+        const std::filesystem::path path = getEntryPath(key);
+        std::filesystem::path       temp = path;
+        temp += "." + std::to_string(std::hash<std::thread::id> {}(std::this_thread::get_id())) + ".tmp";
+        {
+            std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+            if (!file)
+            {
+                LOG_WARN("cannot write shader cache {}", temp.generic_string());
+                return;
+            }
+
+            const std::vector<uint8_t> reflection_data = reflection.serialize();
+
+            CacheHeader header;
+            header.key              = key;
+            header.dependency_count = static_cast<uint32_t>(dependencies.size());
+            header.word_count       = static_cast<uint32_t>(spirv.size());
+            header.reflection_size  = static_cast<uint32_t>(reflection_data.size());
+            write_value(file, header);
+            for (size_t i = 0; i < dependencies.size(); ++i)
+            {
+                write_value(file, static_cast<uint32_t>(dependencies[i].size()));
+                file.write(dependencies[i].data(), static_cast<std::streamsize>(dependencies[i].size()));
+                write_value(file, hashes[i]);
+            }
+            file.write(reinterpret_cast<const char*>(spirv.data()), static_cast<std::streamsize>(spirv.size() * sizeof(uint32_t)));
+            file.write(reinterpret_cast<const char*>(reflection_data.data()), static_cast<std::streamsize>(reflection_data.size()));
+        }
+
+        std::filesystem::rename(temp, path, error);
+        if (error)
+        {
+            LOG_WARN("cannot write shader cache {}: {}", path.generic_string(), error.message());
+            std::filesystem::remove(temp, error);
+        }
+    }
+
+    void VulkanShaderCache::recordCompile(double milliseconds)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_statistics.compiles += 1;
+        m_statistics.compile_ms += milliseconds;
+    }
+
+    ShaderCacheStatistics VulkanShaderCache::getStatistics() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_statistics;
+    }
+
+    void VulkanShaderCache::resetStatistics()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_statistics = {};
+    }
+
+    bool VulkanShaderCache::dependencyHash(const std::string& path, uint64_t& hash)
+    {
+        std::error_code error;
+        auto            write_time = std::filesystem::last_write_time(path, error);
+        if (error)
+        {
+            return false;
+        }
+        auto size = std::filesystem::file_size(path, error);
+        if (error)
+        {
+            return false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto                        iter = m_dependencies.find(path);
+            if (iter != m_dependencies.end() && iter->second.write_time == write_time && iter->second.size == size)
+            {
+                hash = iter->second.hash;
+                return true;
+            }
+        }
+
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            return false;
+        }
+        std::string content {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+        hash = Hash::hash_bytes(content.data(), content.size());
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_dependencies[path] = {write_time, size, hash};
+        return true;
+    }
+} // namespace ArchViz
@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ArchViz
+{
+    struct ShaderReflection;
+
+    struct ShaderCacheStatistics
+    {
+        uint32_t hits {0};
+        uint32_t misses {0}; // no entry for the key
+        uint32_t stale {0};  // entry found, but one of its includes changed
+        uint32_t compiles {0};
+
+        double load_ms {0.0};
+        double compile_ms {0.0};
+    };
+
+    // spir-v of compiled glsl and its reflection on disk, one file per key under the cache folder
+    // the key covers the source text, its name (local includes resolve relative to it), the defines and the compiler
+    // environment (glslang version, targets, options, include directories); include files are not part of the key,
+    // every entry lists the files its includes resolved to with a hash of their content and turns stale once one changes,
+    // which invalidates like a key on the preprocessed source but needs no glslang to look up
+    class VulkanShaderCache
+    {
+    public:
+        VulkanShaderCache() = default;
+        explicit VulkanShaderCache(const std::filesystem::path& folder);
+
+        // empty disables the cache
+        void                         setFolder(const std::filesystem::path& folder);
+        const std::filesystem::path& getFolder() const { return m_folder; }
+        bool                         enabled() const { return !m_folder.empty(); }
+
+        static uint64_t computeKey(const std::string& source, const std::string& name, const std::vector<std::string>& defines, uint64_t environment);
+
+        // dependencies gets the includes the entry was checked against
+        bool load(uint64_t key, std::vector<uint32_t>& spirv, ShaderReflection& reflection, std::vector<std::string>* dependencies = nullptr);
+        void store(uint64_t key, const std::vector<uint32_t>& spirv, const ShaderReflection& reflection, const std::vector<std::string>& dependencies);
+
+        void recordCompile(double milliseconds);
+
+        ShaderCacheStatistics getStatistics() const;
+        void                  resetStatistics();
+
+        std::filesystem::path getEntryPath(uint64_t key) const;
+
+        // content hash of an include, recomputed when its size or write time changes
+        bool dependencyHash(const std::string& path, uint64_t& hash);
+
+    private:
+        struct DependencyStamp
+        {
+            std::filesystem::file_time_type write_time;
+            uintmax_t                       size {0};
+            uint64_t                        hash {0};
+        };
+
+        std::filesystem::path m_folder;
+
+        mutable std::mutex                               m_mutex;
+        ShaderCacheStatistics                            m_statistics;
+        std::unordered_map<std::string, DependencyStamp> m_dependencies;
+    };
+} // namespace ArchViz
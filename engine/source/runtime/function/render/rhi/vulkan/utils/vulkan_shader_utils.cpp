@@ -1,6 +1,10 @@
 #include "runtime/function/render/rhi/vulkan/utils/vulkan_shader_utils.h"
+#include "runtime/function/render/rhi/shader_permutation.h"
+#include "runtime/function/render/rhi/spirv_parser.h"
 #include "runtime/function/render/rhi/vulkan/utils/vulkan_header_includer.h"
+#include "runtime/function/render/rhi/vulkan/utils/vulkan_shader_cache.h"
 
+#include "runtime/core/base/hash.h"
 #include "runtime/core/base/macro.h"
 #include "runtime/core/string/string_utils.h"
 
@@ -23,10 +27,12 @@
 #include <glslang/Public/ShaderLang.h>
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <set>
 
 namespace ArchViz
 {
@@ -47,310 +53,259 @@ namespace ArchViz
         return EShLangVertex;
     }
 
-    std::vector<uint32_t> VulkanShaderUtils::createShaderModuleFromVFS(const std::string& shader_file)
+    namespace
     {
-        std::filesystem::path root_path        = g_runtime_global_context.m_config_manager->getRootFolder();
-        std::filesystem::path shader_file_path = root_path / "shader" / "glsl" / shader_file;
-        std::filesystem::path include_path     = root_path / "shader" / "include";
-        LOG_DEBUG("open shader: " + shader_file_path.generic_string());
+        // bump when the compile options below change, old cache entries stop matching
+        constexpr uint32_t k_compile_options_version = 1;
 
-        std::string shader_code = "";
-        // asset_manager->readTextFile(shader_file_path, shader_code);
-        g_runtime_global_context.m_asset_manager->readVFSTextFile(shader_file, shader_code);
-
-        EShLanguage stage = shaderLanguageStageFromFileName(shader_file.c_str());
-
-        VulkanHeaderIncluder includer;
-        includer.pushExternalLocalDirectory(include_path.generic_string());
-
-        auto client          = glslang::EShClientVulkan;
-        auto client_version  = glslang::EShTargetVulkan_1_0;
-        auto target_language = glslang::EShTargetSpv;
-        auto target_version  = glslang::EShTargetSpv_1_0;
-        auto messages        = EShMsgDefault;
-
-        glslang::InitializeProcess();
-
-        glslang::TProgram* program = new glslang::TProgram;
-        glslang::TShader*  shader  = new glslang::TShader(stage);
-
-        const char* file_names[]   = {shader_file.c_str()};
-        const char* shader_codes[] = {shader_code.c_str()};
-        shader->setStringsWithLengthsAndNames(shader_codes, NULL, file_names, 1);
-
-        std::string              preamble_str = "";
-        std::vector<std::string> processes    = {};
-
-        shader->setPreamble(preamble_str.c_str());
-        shader->addProcesses(processes);
+        // glslang keeps process wide tables, set them up once instead of around every compile
+        struct GlslangProcess
+        {
+            GlslangProcess() { glslang::InitializeProcess(); }
+            ~GlslangProcess() { glslang::FinalizeProcess(); }
+        };
 
-        shader->setEnvInput(glslang::EShSourceGlsl, stage, client, 100);
-        shader->setEnvClient(client, client_version);
-        shader->setEnvTarget(target_language, target_version);
+        void initialize_glslang() { static GlslangProcess process; }
 
-        const TBuiltInResource* resources      = GetDefaultResources();
-        const int               defaultVersion = 100;
-        std::string             str;
+        std::filesystem::path include_folder() { return g_runtime_global_context.m_config_manager->getRootFolder() / "shader" / "include"; }
 
-        if (!shader->preprocess(resources, defaultVersion, ENoProfile, false, false, messages, &str, includer))
+        // everything besides the source that changes the spir-v
+        uint64_t compile_environment(const std::string& include_path)
         {
-            LOG_ERROR(shader->getInfoLog());
-            LOG_FATAL(shader->getInfoDebugLog());
-        }
+            const glslang::Version version = glslang::GetVersion();
 
-        if (!shader->parse(resources, defaultVersion, false, messages, includer))
-        {
-            LOG_ERROR(shader->getInfoLog());
-            LOG_FATAL(shader->getInfoDebugLog());
+            std::string environment = std::to_string(version.major) + "." + std::to_string(version.minor) + "." + std::to_string(version.patch) + version.flavor;
+            environment += "|vulkan " + std::to_string(glslang::EShTargetVulkan_1_0) + "|spirv " + std::to_string(glslang::EShTargetSpv_1_0);
+            environment += "|options " + std::to_string(k_compile_options_version);
+            environment += "|" + include_path;
+            return Hash::hash_bytes(environment.data(), environment.size());
         }
 
-        program->addShader(shader);
-
-        if (!program->link(messages))
+        std::string make_preamble(const std::vector<std::string>& defines)
         {
-            LOG_ERROR(program->getInfoLog());
-            LOG_FATAL(program->getInfoDebugLog());
+            std::string preamble;
+            for (const auto& define : defines)
+            {
+                size_t equal = define.find('=');
+                preamble += "#define " + (equal == std::string::npos ? define : define.substr(0, equal) + " " + define.substr(equal + 1)) + "\n";
+            }
+            return preamble;
         }
 
-        if (!program->mapIO())
+        std::vector<uint32_t> compile_glsl(const std::string&              shader_code,
+                                           const std::string&              shader_name,
+                                           const std::vector<std::string>& defines,
+                                           const std::string&              include_path,
+                                           std::vector<std::string>&       dependencies)
         {
-            LOG_ERROR(program->getInfoLog());
-            LOG_FATAL(program->getInfoDebugLog());
+            initialize_glslang();
+
+            EShLanguage stage = shaderLanguageStageFromFileName(shader_name.c_str());
+
+            VulkanHeaderIncluder includer;
+            includer.pushExternalLocalDirectory(include_path);
+
+            auto client          = glslang::EShClientVulkan;
+            auto client_version  = glslang::EShTargetVulkan_1_0;
+            auto target_language = glslang::EShTargetSpv;
+            auto target_version  = glslang::EShTargetSpv_1_0;
+            auto messages        = EShMsgDefault;
+
+            // the program refers to the shader, it is declared last so it is destroyed first
+            glslang::TShader  shader(stage);
+            glslang::TProgram program;
+
+            const char* file_names[]   = {shader_name.c_str()};
+            const char* shader_codes[] = {shader_code.c_str()};
+            shader.setStringsWithLengthsAndNames(shader_codes, NULL, file_names, 1);
+
+            std::string              preamble_str = make_preamble(defines);
+            std::vector<std::string> processes;
+            for (const auto& define : defines)
+            {
+                processes.push_back("D" + define);
+            }
+
+            shader.setPreamble(preamble_str.c_str());
+            shader.addProcesses(processes);
+
+            shader.setEnvInput(glslang::EShSourceGlsl, stage, client, 100);
+            shader.setEnvClient(client, client_version);
+            shader.setEnvTarget(target_language, target_version);
+
+            const TBuiltInResource* resources      = GetDefaultResources();
+            const int               defaultVersion = 100;
+
+            // parse runs the preprocessor itself
+            if (!shader.parse(resources, defaultVersion, false, messages, includer))
+            {
+                LOG_ERROR(shader.getInfoLog());
+                LOG_FATAL(shader.getInfoDebugLog());
+                return {};
+            }
+
+            program.addShader(&shader);
+
+            if (!program.link(messages))
+            {
+                LOG_ERROR(program.getInfoLog());
+                LOG_FATAL(program.getInfoDebugLog());
+                return {};
+            }
+
+            if (!program.mapIO())
+            {
+                LOG_ERROR(program.getInfoLog());
+                LOG_FATAL(program.getInfoDebugLog());
+                return {};
+            }
+
+            std::vector<uint32_t> spirv;
+            if (program.getIntermediate(stage))
+            {
+                spv::SpvBuildLogger logger;
+                glslang::SpvOptions spvOptions;
+                spvOptions.stripDebugInfo   = true;
+                spvOptions.disableOptimizer = true;
+                spvOptions.optimizeSize     = true;
+                spvOptions.disassemble      = false;
+                spvOptions.validate         = false;
+                glslang::GlslangToSpv(*program.getIntermediate(stage), spirv, &logger, &spvOptions);
+            }
+            else
+            {
+                LOG_FATAL("cannot find target shader");
+            }
+
+            std::set<std::string> included = includer.getIncludedFiles();
+            dependencies.assign(included.begin(), included.end());
+            return spirv;
         }
 
-        bool SpvToolsDisassembler = false;
-        bool SpvToolsValidate     = false;
-
-        std::vector<uint32_t> spirv;
-        if (program->getIntermediate(stage))
+        std::vector<uint32_t> compile_cached(const std::string&              shader_code,
+                                             const std::string&              shader_name,
+                                             const std::vector<std::string>& defines,
+                                             ShaderReflection*               reflection,
+                                             std::vector<std::string>*       dependencies = nullptr)
         {
-            spv::SpvBuildLogger logger;
-            glslang::SpvOptions spvOptions;
-            spvOptions.stripDebugInfo   = true;
-            spvOptions.disableOptimizer = true;
-            spvOptions.optimizeSize     = true;
-            spvOptions.disassemble      = SpvToolsDisassembler;
-            spvOptions.validate         = SpvToolsValidate;
-            glslang::GlslangToSpv(*program->getIntermediate((EShLanguage)stage), spirv, &logger, &spvOptions);
+            const std::string  include_path = include_folder().generic_string();
+            VulkanShaderCache& cache        = VulkanShaderUtils::getShaderCache();
+            const uint64_t     key          = VulkanShaderCache::computeKey(shader_code, shader_name, defines, compile_environment(include_path));
+
+            std::vector<uint32_t> spirv;
+            ShaderReflection      shader_reflection;
+            if (cache.load(key, spirv, shader_reflection, dependencies))
+            {
+                if (reflection != nullptr)
+                {
+                    *reflection = std::move(shader_reflection);
+                }
+                return spirv;
+            }
+
+            auto                     start = std::chrono::high_resolution_clock::now();
+            std::vector<std::string> included;
+            spirv = compile_glsl(shader_code, shader_name, defines, include_path, included);
+            cache.recordCompile(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+
+            // reflected once here, cache hits and pipeline creation read the stored result
+            if (spirv.empty() || !SPIRV::reflect(spirv, shader_reflection))
+            {
+                return spirv;
+            }
+            cache.store(key, spirv, shader_reflection, included);
+
+            if (reflection != nullptr)
+            {
+                *reflection = std::move(shader_reflection);
+            }
+            if (dependencies != nullptr)
+            {
+                *dependencies = std::move(included);
+            }
+            return spirv;
         }
-        else
+
+        // the includes the manifest entry was built against are unchanged, paths are relative to the root folder
+        bool dependencies_match(const ShaderManifestEntry& entry)
         {
-            LOG_FATAL("cannot find target shader")
+            const std::filesystem::path& root_folder = g_runtime_global_context.m_config_manager->getRootFolder();
+            VulkanShaderCache&           cache       = VulkanShaderUtils::getShaderCache();
+            for (const auto& dependency : entry.dependencies)
+            {
+                uint64_t current;
+                if (!cache.dependencyHash((root_folder / dependency.file).generic_string(), current) || current != dependency.hash)
+                {
+                    return false;
+                }
+            }
+            return true;
         }
+    } // namespace
 
-        glslang::FinalizeProcess();
-
-        delete shader;
-        delete program;
-
-        // copy data to unsigned char;
-        // std::vector<unsigned char> spirv_char;
-        // spirv_char.resize(spirv.size() * sizeof(unsigned int));
-        // memcpy(spirv_char.data(), spirv.data(), spirv_char.size());
+    VulkanShaderCache& VulkanShaderUtils::getShaderCache()
+    {
+        static VulkanShaderCache cache = []() {
+            const std::filesystem::path& cache_folder = g_runtime_global_context.m_config_manager->getCacheFolder();
+            return VulkanShaderCache(cache_folder.empty() ? cache_folder : cache_folder / "shader");
+        }();
+        return cache;
+    }
 
-        return spirv;
+    const ShaderPermutationManifest& VulkanShaderUtils::getShaderManifest()
+    {
+        static ShaderPermutationManifest manifest = []() {
+            ShaderPermutationManifest result;
+            result.load(g_runtime_global_context.m_config_manager->getRootFolder() / "shader" / "spirv");
+            return result;
+        }();
+        return manifest;
     }
 
-    std::vector<uint32_t> VulkanShaderUtils::createShaderModuleFromFile(const std::string& shader_file)
+    std::vector<uint32_t> VulkanShaderUtils::createShaderModuleFromVFS(const std::string& shader_file, const std::vector<std::string>& defines, ShaderReflection* reflection)
     {
-        std::filesystem::path root_path        = g_runtime_global_context.m_config_manager->getRootFolder();
-        std::filesystem::path shader_file_path = root_path / "shader" / "glsl" / shader_file;
-        std::filesystem::path include_path     = root_path / "shader" / "include";
-        LOG_DEBUG("open shader: " + shader_file_path.generic_string());
+        LOG_DEBUG("open shader: " + shader_file);
 
         std::string shader_code = "";
-        // asset_manager->readTextFile(shader_file_path, shader_code);
-        g_runtime_global_context.m_asset_manager->readTextFile(shader_file, shader_code);
-
-        EShLanguage stage = shaderLanguageStageFromFileName(shader_file.c_str());
-
-        VulkanHeaderIncluder includer;
-        includer.pushExternalLocalDirectory(include_path.generic_string());
-
-        auto client          = glslang::EShClientVulkan;
-        auto client_version  = glslang::EShTargetVulkan_1_0;
-        auto target_language = glslang::EShTargetSpv;
-        auto target_version  = glslang::EShTargetSpv_1_0;
-        auto messages        = EShMsgDefault;
-
-        glslang::InitializeProcess();
-
-        glslang::TProgram* program = new glslang::TProgram;
-        glslang::TShader*  shader  = new glslang::TShader(stage);
-
-        const char* file_names[]   = {shader_file.c_str()};
-        const char* shader_codes[] = {shader_code.c_str()};
-        shader->setStringsWithLengthsAndNames(shader_codes, NULL, file_names, 1);
-
-        std::string              preamble_str = "";
-        std::vector<std::string> processes    = {};
-
-        shader->setPreamble(preamble_str.c_str());
-        shader->addProcesses(processes);
-
-        shader->setEnvInput(glslang::EShSourceGlsl, stage, client, 100);
-        shader->setEnvClient(client, client_version);
-        shader->setEnvTarget(target_language, target_version);
-
-        const TBuiltInResource* resources      = GetDefaultResources();
-        const int               defaultVersion = 100;
-        std::string             str;
-
-        if (!shader->preprocess(resources, defaultVersion, ENoProfile, false, false, messages, &str, includer))
-        {
-            LOG_ERROR(shader->getInfoLog());
-            LOG_FATAL(shader->getInfoDebugLog());
-        }
-
-        if (!shader->parse(resources, defaultVersion, false, messages, includer))
-        {
-            LOG_ERROR(shader->getInfoLog());
-            LOG_FATAL(shader->getInfoDebugLog());
-        }
-
-        program->addShader(shader);
-
-        if (!program->link(messages))
-        {
-            LOG_ERROR(program->getInfoLog());
-            LOG_FATAL(program->getInfoDebugLog());
-        }
-
-        if (!program->mapIO())
-        {
-            LOG_ERROR(program->getInfoLog());
-            LOG_FATAL(program->getInfoDebugLog());
-        }
-
-        bool SpvToolsDisassembler = false;
-        bool SpvToolsValidate     = false;
+        g_runtime_global_context.m_asset_manager->readVFSTextFile(shader_file, shader_code);
 
-        std::vector<uint32_t> spirv;
-        if (program->getIntermediate(stage))
-        {
-            spv::SpvBuildLogger logger;
-            glslang::SpvOptions spvOptions;
-            spvOptions.stripDebugInfo   = true;
-            spvOptions.disableOptimizer = true;
-            spvOptions.optimizeSize     = true;
-            spvOptions.disassemble      = SpvToolsDisassembler;
-            spvOptions.validate         = SpvToolsValidate;
-            glslang::GlslangToSpv(*program->getIntermediate((EShLanguage)stage), spirv, &logger, &spvOptions);
-        }
-        else
+        // the prebuilt variant is used unless the source or one of its includes was edited since the build
+        // (a shipped build may have no source)
+        const ShaderPermutationManifest& manifest = getShaderManifest();
+        if (const ShaderVariant* variant = manifest.findVariant(shader_file, defines))
         {
-            LOG_FATAL("cannot find target shader");
+            const ShaderManifestEntry* entry = manifest.findEntry(shader_file);
+            if (shader_code.empty() || (entry->source_hash == Hash::hash_bytes(shader_code.data(), shader_code.size()) && dependencies_match(*entry)))
+            {
+                if (reflection != nullptr)
+                {
+                    *reflection = manifest.getReflection(variant->blob);
+                }
+                return manifest.getBlob(variant->blob);
+            }
+            LOG_WARN("shader {} changed since the manifest was built, compiling it", shader_file);
         }
 
-        glslang::FinalizeProcess();
-
-        delete shader;
-        delete program;
-
-        // copy data to unsigned char;
-        // std::vector<unsigned char> spirv_char;
-        // spirv_char.resize(spirv.size() * sizeof(unsigned int));
-        // memcpy(spirv_char.data(), spirv.data(), spirv_char.size());
-
-        return spirv;
+        return compile_cached(shader_code, shader_file, defines, reflection);
     }
 
-    std::vector<uint32_t> VulkanShaderUtils::createShaderModuleFromCode(const std::string& shader_code, const std::string& shader_type)
+    std::vector<uint32_t> VulkanShaderUtils::createShaderModuleFromFile(const std::string& shader_file, const std::vector<std::string>& defines, ShaderReflection* reflection)
     {
-        std::filesystem::path root_path    = g_runtime_global_context.m_config_manager->getRootFolder();
-        std::filesystem::path include_path = root_path / "shader" / "include";
-
-        EShLanguage stage = shaderLanguageStageFromFileName(shader_type.c_str());
-
-        VulkanHeaderIncluder includer;
-        includer.pushExternalLocalDirectory(include_path.generic_string());
-
-        auto client          = glslang::EShClientVulkan;
-        auto client_version  = glslang::EShTargetVulkan_1_0;
-        auto target_language = glslang::EShTargetSpv;
-        auto target_version  = glslang::EShTargetSpv_1_0;
-        auto messages        = EShMsgDefault;
-
-        glslang::InitializeProcess();
-
-        glslang::TProgram* program = new glslang::TProgram;
-        glslang::TShader*  shader  = new glslang::TShader(stage);
-
-        const char* file_names[]   = {shader_type.c_str()};
-        const char* shader_codes[] = {shader_code.c_str()};
-        shader->setStringsWithLengthsAndNames(shader_codes, NULL, file_names, 1);
-
-        std::string              preamble_str = "";
-        std::vector<std::string> processes    = {};
-
-        shader->setPreamble(preamble_str.c_str());
-        shader->addProcesses(processes);
-
-        shader->setEnvInput(glslang::EShSourceGlsl, stage, client, 100);
-        shader->setEnvClient(client, client_version);
-        shader->setEnvTarget(target_language, target_version);
-
-        const TBuiltInResource* resources      = GetDefaultResources();
-        const int               defaultVersion = 100;
-        std::string             str;
-
-        if (!shader->preprocess(resources, defaultVersion, ENoProfile, false, false, messages, &str, includer))
-        {
-            LOG_ERROR(shader->getInfoLog());
-            LOG_FATAL(shader->getInfoDebugLog());
-        }
+        LOG_DEBUG("open shader: " + shader_file);
 
-        if (!shader->parse(resources, defaultVersion, false, messages, includer))
-        {
-            LOG_ERROR(shader->getInfoLog());
-            LOG_FATAL(shader->getInfoDebugLog());
-        }
-
-        program->addShader(shader);
-
-        if (!program->link(messages))
-        {
-            LOG_ERROR(program->getInfoLog());
-            LOG_FATAL(program->getInfoDebugLog());
-        }
-
-        if (!program->mapIO())
-        {
-            LOG_ERROR(program->getInfoLog());
-            LOG_FATAL(program->getInfoDebugLog());
-        }
-
-        bool SpvToolsDisassembler = false;
-        bool SpvToolsValidate     = false;
-
-        std::vector<uint32_t> spirv;
-        if (program->getIntermediate(stage))
-        {
-            spv::SpvBuildLogger logger;
-            glslang::SpvOptions spvOptions;
-            spvOptions.stripDebugInfo   = true;
-            spvOptions.disableOptimizer = true;
-            spvOptions.optimizeSize     = true;
-            spvOptions.disassemble      = SpvToolsDisassembler;
-            spvOptions.validate         = SpvToolsValidate;
-            glslang::GlslangToSpv(*program->getIntermediate((EShLanguage)stage), spirv, &logger, &spvOptions);
-        }
-        else
-        {
-            LOG_FATAL("cannot find target shader");
-        }
-
-        glslang::FinalizeProcess();
-
-        delete shader;
-        delete program;
+        std::string shader_code = "";
+        g_runtime_global_context.m_asset_manager->readTextFile(shader_file, shader_code);
 
-        // copy data to unsigned char;
-        // std::vector<unsigned char> spirv_char;
-        // spirv_char.resize(spirv.size() * sizeof(unsigned int));
-        // memcpy(spirv_char.data(), spirv.data(), spirv_char.size());
+        return compile_cached(shader_code, shader_file, defines, reflection);
+    }
 
-        return spirv;
+    std::vector<uint32_t> VulkanShaderUtils::createShaderModuleFromCode(const std::string&              shader_code,
+                                                                        const std::string&              shader_type,
+                                                                        const std::vector<std::string>& defines,
+                                                                        ShaderReflection*               reflection,
+                                                                        std::vector<std::string>*       dependencies)
+    {
+        return compile_cached(shader_code, shader_type, defines, reflection, dependencies);
     }
 
     VkShaderModule VulkanShaderUtils::createShaderModule(VkDevice device, const std::vector<uint32_t>& shader_code)
@@ -13,13 +13,31 @@ namespace ArchViz
 {
     class ConfigManager;
     class AssetManager;
+    class VulkanShaderCache;
+    class ShaderPermutationManifest;
+    struct ShaderReflection;
 
+    // glsl -> spir-v through glslang, results are cached on disk (see VulkanShaderCache)
+    // defines are "NAME" or "NAME=VALUE", vfs shaders come from the prebuilt manifest when it has the variant and
+    // neither the source nor its includes changed since;
+    // the reflection is stored next to the spir-v in both, pass one to get it without parsing the module again
     class VulkanShaderUtils
     {
     public:
-        static std::vector<uint32_t> createShaderModuleFromVFS(const std::string& shader_file);
-        static std::vector<uint32_t> createShaderModuleFromFile(const std::string& shader_file);
-        static std::vector<uint32_t> createShaderModuleFromCode(const std::string& shader_code, const std::string& shader_type);
+        static std::vector<uint32_t> createShaderModuleFromVFS(const std::string& shader_file, const std::vector<std::string>& defines = {}, ShaderReflection* reflection = nullptr);
+        static std::vector<uint32_t> createShaderModuleFromFile(const std::string& shader_file, const std::vector<std::string>& defines = {}, ShaderReflection* reflection = nullptr);
+        // dependencies gets the include files the code resolved to
+        static std::vector<uint32_t> createShaderModuleFromCode(const std::string&              shader_code,
+                                                                const std::string&              shader_type,
+                                                                const std::vector<std::string>& defines      = {},
+                                                                ShaderReflection*               reflection   = nullptr,
+                                                                std::vector<std::string>*       dependencies = nullptr);
         static VkShaderModule        createShaderModule(VkDevice device, const std::vector<uint32_t>& shader_code);
+
+        // <cache folder>/shader of the config, disabled when the config has no cache folder
+        static VulkanShaderCache& getShaderCache();
+
+        // <root>/shader/spirv, written by ArchVizShaderBuilder, empty when it was never built
+        static const ShaderPermutationManifest& getShaderManifest();
     };
 } // namespace ArchViz
@@ -1,5 +1,6 @@
 #include "runtime/function/render/rhi/vulkan/utils/vulkan_texture_utils.h"
 #include "runtime/function/render/rhi/vulkan/common/vulkan_device.h"
+#include "runtime/function/render/rhi/vulkan/common/vulkan_memory_allocator.h"
 #include "runtime/function/render/rhi/vulkan/utils/vulkan_buffer_utils.h"
 #include "runtime/function/render/rhi/vulkan/utils/vulkan_utils.h"
 
@@ -16,7 +17,7 @@ namespace ArchViz
                                          VkImageUsageFlags             usage,
                                          VkMemoryPropertyFlags         properties,
                                          VkImage&                      image,
-                                         VkDeviceMemory&               image_memory)
+                                         VmaAllocation&                image_allocation)
     {
         VkImageCreateInfo image_info {};
         image_info.sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -33,25 +34,12 @@ namespace ArchViz
         image_info.samples       = VK_SAMPLE_COUNT_1_BIT;
         image_info.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
 
-        if (vkCreateImage(device->m_device, &image_info, nullptr, &image) != VK_SUCCESS)
-        {
-            LOG_FATAL("failed to create image!");
-        }
-
-        VkMemoryRequirements mem_requirements;
-        vkGetImageMemoryRequirements(device->m_device, image, &mem_requirements);
-
-        VkMemoryAllocateInfo alloc_info {};
-        alloc_info.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        alloc_info.allocationSize  = mem_requirements.size;
-        alloc_info.memoryTypeIndex = VulkanUtils::findMemoryType(device->m_physical_device, mem_requirements.memoryTypeBits, properties);
-
-        if (vkAllocateMemory(device->m_device, &alloc_info, nullptr, &image_memory) != VK_SUCCESS)
-        {
-            LOG_FATAL("failed to allocate image memory!");
-        }
+        device->m_allocator->createImage(image_info, properties, image, image_allocation);
+    }
 
-        vkBindImageMemory(device->m_device, image, image_memory, 0);
+    void VulkanTextureUtils::destroyImage(std::shared_ptr<VulkanDevice> device, VkImage& image, VmaAllocation& image_allocation)
+    {
+        device->m_allocator->destroyImage(image, image_allocation);
     }
 
     VkImageView VulkanTextureUtils::createImageView(std::shared_ptr<VulkanDevice> device, VkImage image, VkFormat format, VkImageAspectFlags aspect_flags, uint32_t mip_level)
@@ -170,6 +158,15 @@ namespace ArchViz
         VulkanBufferUtils::endSingleTimeCommands(device, command_pool, command_buffer);
     }
 
+    void VulkanTextureUtils::copyBufferToImage(std::shared_ptr<VulkanDevice> device, VkCommandPool command_pool, VkBuffer buffer, VkImage image, const std::vector<VkBufferImageCopy>& regions)
+    {
+        VkCommandBuffer command_buffer = VulkanBufferUtils::beginSingleTimeCommands(device, command_pool);
+
+        vkCmdCopyBufferToImage(command_buffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(regions.size()), regions.data());
+
+        VulkanBufferUtils::endSingleTimeCommands(device, command_pool, command_buffer);
+    }
+
     void VulkanTextureUtils::generateMipmaps(std::shared_ptr<VulkanDevice> device,
                                              VkCommandPool                 command_pool,
                                              VkImage                       image,
@@ -178,17 +175,27 @@ namespace ArchViz
                                              int32_t                       tex_height,
                                              uint32_t                      mip_levels)
     {
-        // Check if image format supports linear blitting
-        VkFormatProperties formatProperties;
-        vkGetPhysicalDeviceFormatProperties(device->m_physical_device, image_format, &formatProperties);
-
-        if (!(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT))
+        if (!supportsLinearBlit(device, image_format))
         {
             LOG_FATAL("texture image format does not support linear blitting!");
         }
 
         VkCommandBuffer command_buffer = VulkanBufferUtils::beginSingleTimeCommands(device, command_pool);
+        recordGenerateMipmaps(command_buffer, image, tex_width, tex_height, mip_levels);
+        VulkanBufferUtils::endSingleTimeCommands(device, command_pool, command_buffer);
+    }
 
+    bool VulkanTextureUtils::supportsLinearBlit(std::shared_ptr<VulkanDevice> device, VkFormat format)
+    {
+        // Check if image format supports linear blitting
+        VkFormatProperties formatProperties;
+        vkGetPhysicalDeviceFormatProperties(device->m_physical_device, format, &formatProperties);
+
+        return formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    }
+
+    void VulkanTextureUtils::recordGenerateMipmaps(VkCommandBuffer command_buffer, VkImage image, int32_t tex_width, int32_t tex_height, uint32_t mip_levels)
+    {
         VkImageMemoryBarrier barrier {};
         barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
         barrier.image                           = image;
@@ -248,7 +255,5 @@ namespace ArchViz
         barrier.dstAccessMask                 = VK_ACCESS_SHADER_READ_BIT;
 
         vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-
-        VulkanBufferUtils::endSingleTimeCommands(device, command_pool, command_buffer);
     }
 } // namespace ArchViz
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <volk.h>
+#include <vk_mem_alloc.h>
 
 #include <memory>
+#include <vector>
 
 namespace ArchViz
 {
@@ -20,7 +22,9 @@ namespace ArchViz
                                 VkImageUsageFlags             usage,
                                 VkMemoryPropertyFlags         properties,
                                 VkImage&                      image,
-                                VkDeviceMemory&               image_memory);
+                                VmaAllocation&                image_allocation);
+
+        static void destroyImage(std::shared_ptr<VulkanDevice> device, VkImage& image, VmaAllocation& image_allocation);
 
         static VkImageView createImageView(std::shared_ptr<VulkanDevice> device, VkImage image, VkFormat format, VkImageAspectFlags aspect_flags, uint32_t mip_level);
 
@@ -28,7 +32,11 @@ namespace ArchViz
         transitionImageLayout(std::shared_ptr<VulkanDevice> device, VkCommandPool command_pool, VkImage image, VkFormat format, VkImageLayout old_layout, VkImageLayout new_layout, uint32_t mip_level);
 
         static void copyBufferToImage(std::shared_ptr<VulkanDevice> device, VkCommandPool command_pool, VkBuffer buffer, VkImage image, uint32_t width, uint32_t height);
+        static void copyBufferToImage(std::shared_ptr<VulkanDevice> device, VkCommandPool command_pool, VkBuffer buffer, VkImage image, const std::vector<VkBufferImageCopy>& regions);
 
         static void generateMipmaps(std::shared_ptr<VulkanDevice> device, VkCommandPool command_pool, VkImage image, VkFormat image_format, int32_t tex_width, int32_t tex_height, uint32_t mip_levels);
+        // every level must be in transfer dst layout with level 0 written, they all end up shader read only
+        static void recordGenerateMipmaps(VkCommandBuffer command_buffer, VkImage image, int32_t tex_width, int32_t tex_height, uint32_t mip_levels);
+        static bool supportsLinearBlit(std::shared_ptr<VulkanDevice> device, VkFormat format);
     };
 } // namespace ArchViz
@@ -121,7 +121,10 @@ namespace ArchViz
 
         vkGetPhysicalDeviceFeatures2(device, &device_features);
 
-        bool bindless_supported = indexing_features.descriptorBindingPartiallyBound && indexing_features.runtimeDescriptorArray;
+        // the bindless table is written while frames that do not sample the new indices are in flight
+        bool bindless_supported = indexing_features.descriptorBindingPartiallyBound && indexing_features.runtimeDescriptorArray &&
+                                  indexing_features.descriptorBindingSampledImageUpdateAfterBind && indexing_features.descriptorBindingStorageImageUpdateAfterBind &&
+                                  indexing_features.descriptorBindingStorageBufferUpdateAfterBind && indexing_features.descriptorBindingUpdateUnusedWhilePending;
         return bindless_supported;
     }
 
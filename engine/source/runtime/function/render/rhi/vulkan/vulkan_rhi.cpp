@@ -1,12 +1,20 @@
 #include "runtime/function/render/rhi/vulkan/vulkan_rhi.h"
 #include "runtime/function/render/rhi/vulkan/common/vulkan_buffer.h"
 #include "runtime/function/render/rhi/vulkan/common/vulkan_device.h"
+#include "runtime/function/render/rhi/vulkan/common/vulkan_indirect_drawer.h"
 #include "runtime/function/render/rhi/vulkan/common/vulkan_instance.h"
+#include "runtime/function/render/rhi/vulkan/common/vulkan_layout_cache.h"
+#include "runtime/function/render/rhi/vulkan/common/vulkan_memory_allocator.h"
+#include "runtime/function/render/rhi/vulkan/common/vulkan_mesh_arena.h"
+#include "runtime/function/render/rhi/vulkan/common/vulkan_parallel_recorder.h"
 #include "runtime/function/render/rhi/vulkan/common/vulkan_pipeline.h"
+#include "runtime/function/render/rhi/vulkan/common/vulkan_pipeline_state_cache.h"
 #include "runtime/function/render/rhi/vulkan/common/vulkan_render_pass.h"
 #include "runtime/function/render/rhi/vulkan/common/vulkan_shader.h"
+#include "runtime/function/render/rhi/vulkan/common/vulkan_staging_uploader.h"
 #include "runtime/function/render/rhi/vulkan/common/vulkan_swap_chain.h"
 #include "runtime/function/render/rhi/vulkan/common/vulkan_texture.h"
+#include "runtime/function/render/rhi/vulkan/common/vulkan_uniform_allocator.h"
 #include "runtime/function/render/rhi/vulkan/utils/vulkan_buffer_utils.h"
 #include "runtime/function/render/rhi/vulkan/utils/vulkan_debug_utils.h"
 #include "runtime/function/render/rhi/vulkan/utils/vulkan_texture_utils.h"
@@ -15,6 +23,7 @@
 
 #include "runtime/function/render/geometry/particle.h"
 #include "runtime/function/render/geometry/vertex.h"
+#include "runtime/function/render/queue/render_queue.h"
 
 #include "runtime/resource/asset_manager/asset_manager.h"
 #include "runtime/resource/config_manager/config_manager.h"
@@ -23,10 +32,12 @@
 
 #include "runtime/core/base/macro.h"
 #include "runtime/core/math/math.h"
+#include "runtime/core/thread/work_executor.h"
 
 // TODO : move this to asset loader part
 #include <tiny_obj_loader.h>
 
+#include <algorithm>
 #include <random>
 #include <stdio.h>
 #include <stdlib.h>
@@ -130,9 +141,15 @@ namespace ArchViz
 
         m_vulkan_device->wait();
 
+        // the device is idle anyway, a good moment to give emptied blocks back. Not while uploads still name the mesh arena
+        // buffers, the queued copies and the pending ownership acquires would keep the old handles
+        if (m_vulkan_uploader->isIdle())
+        {
+            m_vulkan_device->m_allocator->defragment(m_command_pool, m_vulkan_device->m_graphics_queue);
+        }
+
         vkDestroyImageView(m_vulkan_device->m_device, m_depth_image_view, nullptr);
-        vkDestroyImage(m_vulkan_device->m_device, m_depth_image, nullptr);
-        vkFreeMemory(m_vulkan_device->m_device, m_depth_image_memory, nullptr);
+        VulkanTextureUtils::destroyImage(m_vulkan_device, m_depth_image, m_depth_image_allocation);
 
         for (auto framebuffer : m_swap_chain_framebuffers)
         {
@@ -188,80 +205,6 @@ namespace ArchViz
         }
     }
 
-    void VulkanRHI::createBindlessDescriptorPool()
-    {
-        if (!m_bindless_supported)
-            return;
-
-        // Since DescriptorSet should be treated as asset in Vulkan, DescriptorPool
-        // should be big enough, and thus we can sub-allocate DescriptorSet from
-        // DescriptorPool merely as we sub-allocate Buffer/Image from DeviceMemory.
-        std::array<VkDescriptorPoolSize, 2> pool_sizes_bindless {};
-        pool_sizes_bindless[0].type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        pool_sizes_bindless[0].descriptorCount = VulkanConstants::k_max_bindless_resources;
-        pool_sizes_bindless[1].type            = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-        pool_sizes_bindless[1].descriptorCount = VulkanConstants::k_max_bindless_resources;
-
-        VkDescriptorPoolCreateInfo bindless_pool_info {};
-        bindless_pool_info.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-        bindless_pool_info.flags         = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT | VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
-        bindless_pool_info.poolSizeCount = static_cast<uint32_t>(pool_sizes_bindless.size());
-        bindless_pool_info.pPoolSizes    = pool_sizes_bindless.data();
-        bindless_pool_info.maxSets       = static_cast<uint32_t>(pool_sizes_bindless.size() * VulkanConstants::k_max_bindless_resources);
-
-        m_bindless_pool_size = pool_sizes_bindless.size();
-
-        if (vkCreateDescriptorPool(m_vulkan_device->m_device, &bindless_pool_info, nullptr, &m_bindless_pool) != VK_SUCCESS)
-        {
-            LOG_FATAL("failed to create bindless discriptor pool");
-        }
-
-        m_bindless_pool_size = pool_sizes_bindless.size();
-    }
-
-    void VulkanRHI::createBindlessDescriptorSetLayout()
-    {
-        if (!m_bindless_supported)
-            return;
-
-        VkDescriptorSetLayoutBinding vk_binding[4];
-
-        VkDescriptorSetLayoutBinding& image_sampler_binding {vk_binding[0]};
-        image_sampler_binding.descriptorType     = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        image_sampler_binding.descriptorCount    = VulkanConstants::k_max_bindless_resources;
-        image_sampler_binding.binding            = VulkanConstants::k_bindless_texture_binding;
-        image_sampler_binding.stageFlags         = VK_SHADER_STAGE_ALL;
-        image_sampler_binding.pImmutableSamplers = nullptr;
-
-        VkDescriptorSetLayoutBinding& storage_image_binding {vk_binding[1]};
-        storage_image_binding.descriptorType     = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-        storage_image_binding.descriptorCount    = VulkanConstants::k_max_bindless_resources;
-        storage_image_binding.binding            = VulkanConstants::k_bindless_texture_binding + 1;
-        storage_image_binding.stageFlags         = VK_SHADER_STAGE_ALL;
-        storage_image_binding.pImmutableSamplers = nullptr;
-
-        VkDescriptorBindingFlags bindless_flags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT;
-        VkDescriptorBindingFlags binding_flags[4];
-        binding_flags[0] = bindless_flags;
-        binding_flags[1] = bindless_flags;
-
-        VkDescriptorSetLayoutBindingFlagsCreateInfoEXT extended_info {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT, nullptr};
-        extended_info.bindingCount  = m_bindless_pool_size;
-        extended_info.pBindingFlags = binding_flags;
-
-        VkDescriptorSetLayoutCreateInfo layout_info {};
-        layout_info.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-        layout_info.bindingCount = m_bindless_pool_size;
-        layout_info.pBindings    = vk_binding;
-        layout_info.flags        = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
-        layout_info.pNext        = &extended_info;
-
-        if (vkCreateDescriptorSetLayout(m_vulkan_device->m_device, &layout_info, nullptr, &m_bindless_set_layout) != VK_SUCCESS)
-        {
-            LOG_FATAL("failed to create bindless descriptor set layout!");
-        }
-    }
-
     void VulkanRHI::createRenderPass()
     {
         m_vulkan_render_pass                 = std::make_shared<VulkanRenderPass>();
@@ -272,29 +215,28 @@ namespace ArchViz
 
     void VulkanRHI::createGraphicsPipelineCache()
     {
-        VkPipelineCacheCreateInfo create_info {};
-        create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
-
-        // read pipeline cache
-        std::vector<std::byte> cache;
-
-        auto cache_path = g_runtime_global_context.m_config_manager->getRootFolder() / "pipeline.cache";
-        g_runtime_global_context.m_asset_manager->readBinaryFile(cache_path.generic_string(), cache);
-        if (cache.size() != 0)
-        {
-            VkPipelineCacheHeaderVersionOne* cache_header = (VkPipelineCacheHeaderVersionOne*)cache.data();
-            // TODO : add memcmp(cache_header->pipelineCacheUUID, m_vulkan_device->m_properties.pipelineCacheUUID, VK_UUID_SIZE)
-            if (cache_header->deviceID == m_vulkan_device->m_properties.deviceID && cache_header->vendorID == m_vulkan_device->m_properties.vendorID)
-            {
-                create_info.initialDataSize = cache.size();
-                create_info.pInitialData    = cache.data();
-            }
-        }
+        m_vulkan_layout_cache           = std::make_shared<VulkanLayoutCache>();
+        m_vulkan_layout_cache->m_device = m_vulkan_device;
+        m_vulkan_layout_cache->initialize();
+
+        // pipelines requested at runtime compile in the background on the runtime executor
+        m_vulkan_pipeline_state_cache                 = std::make_shared<VulkanPipelineStateCache>();
+        m_vulkan_pipeline_state_cache->m_device       = m_vulkan_device;
+        m_vulkan_pipeline_state_cache->m_layout_cache = m_vulkan_layout_cache;
+        m_vulkan_pipeline_state_cache->m_executor     = m_initialize_info.executor;
+        m_vulkan_pipeline_state_cache->m_render_pass  = m_vulkan_render_pass->m_render_pass;
+        m_vulkan_pipeline_state_cache->m_cache_path   = g_runtime_global_context.m_config_manager->getRootFolder() / "pipeline.cache";
+        m_vulkan_pipeline_state_cache->initialize();
+
+        m_pipeline_cache = m_vulkan_pipeline_state_cache->m_pipeline_cache;
+    }
 
-        if (vkCreatePipelineCache(m_vulkan_device->m_device, &create_info, nullptr, &m_pipeline_cache) != VK_SUCCESS)
-        {
-            LOG_FATAL("failed to create pipeline cache");
-        }
+    void VulkanRHI::createBindlessTable()
+    {
+        m_vulkan_bindless_table                 = std::make_shared<VulkanBindlessTable>();
+        m_vulkan_bindless_table->m_device       = m_vulkan_device;
+        m_vulkan_bindless_table->m_layout_cache = m_vulkan_layout_cache;
+        m_vulkan_bindless_table->initialize();
     }
 
     void VulkanRHI::createGraphicsPipeline()
@@ -309,10 +251,12 @@ namespace ArchViz
 
         m_vulkan_pipeline = std::make_shared<VulkanPipeline>();
 
-        m_vulkan_pipeline->m_device         = m_vulkan_device;
-        m_vulkan_pipeline->m_shader         = shader;
-        m_vulkan_pipeline->m_render_pass    = m_vulkan_render_pass->m_render_pass;
-        m_vulkan_pipeline->m_pipeline_cache = m_pipeline_cache;
+        m_vulkan_pipeline->m_device           = m_vulkan_device;
+        m_vulkan_pipeline->m_shader           = shader;
+        m_vulkan_pipeline->m_layout_cache     = m_vulkan_layout_cache;
+        m_vulkan_pipeline->m_render_pass      = m_vulkan_render_pass->m_render_pass;
+        m_vulkan_pipeline->m_pipeline_cache   = m_pipeline_cache;
+        m_vulkan_pipeline->m_dynamic_uniforms = true;
 
         m_vulkan_pipeline->initialize();
     }
@@ -343,7 +287,7 @@ namespace ArchViz
                                         VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
                                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
                                         m_depth_image,
-                                        m_depth_image_memory);
+                                        m_depth_image_allocation);
         m_depth_image_view = VulkanTextureUtils::createImageView(m_vulkan_device, m_depth_image, m_depth_format, VK_IMAGE_ASPECT_DEPTH_BIT, 1);
 
         VulkanTextureUtils::transitionImageLayout(m_vulkan_device, m_command_pool, m_depth_image, m_depth_format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, 1);
@@ -399,6 +343,29 @@ namespace ArchViz
         }
     }
 
+    void VulkanRHI::createParallelRecorder()
+    {
+        // the scene draws are recorded on the runtime executor, one secondary buffer per worker
+        const std::shared_ptr<WorkExecutor>& executor       = m_initialize_info.executor;
+        const uint32_t                       record_threads = executor ? static_cast<uint32_t>(executor->size()) : 1;
+
+        m_vulkan_parallel_recorder                     = std::make_shared<VulkanParallelRecorder>();
+        m_vulkan_parallel_recorder->m_device           = m_vulkan_device;
+        m_vulkan_parallel_recorder->m_executor         = executor;
+        m_vulkan_parallel_recorder->m_thread_count     = record_threads;
+        m_vulkan_parallel_recorder->m_frames_in_flight = VulkanConstants::k_max_frames_in_flight;
+        m_vulkan_parallel_recorder->initialize();
+
+        m_scene_draw_count = g_runtime_global_context.m_config_manager->getSceneDrawCount();
+    }
+
+    void VulkanRHI::createStagingUploader()
+    {
+        m_vulkan_uploader           = std::make_shared<VulkanStagingUploader>();
+        m_vulkan_uploader->m_device = m_vulkan_device;
+        m_vulkan_uploader->initialize();
+    }
+
     // ---------------------------------------------------------------------------
     // ---------------------------------------------------------------------------
     // ---------------------------------------------------------------------------
@@ -407,25 +374,34 @@ namespace ArchViz
 
     void VulkanRHI::createTextureImage()
     {
-        m_vulkan_texture                 = std::make_shared<VulkanTexture>();
-        m_vulkan_texture->m_device       = m_vulkan_device;
-        m_vulkan_texture->m_command_pool = m_command_pool;
-        m_vulkan_texture->m_address_mode = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        m_vulkan_texture                   = std::make_shared<VulkanTexture>();
+        m_vulkan_texture->m_device         = m_vulkan_device;
+        m_vulkan_texture->m_uploader       = m_vulkan_uploader;
+        m_vulkan_texture->m_bindless_table = m_vulkan_bindless_table;
+        m_vulkan_texture->m_command_pool   = m_command_pool;
+        m_vulkan_texture->m_address_mode   = VK_SAMPLER_ADDRESS_MODE_REPEAT;
         // m_vulkan_texture->initizlize("asset-test/data/model/viking_room/viking_room.png");
         m_vulkan_texture->initizlize("asset-test/data/texture/object/container/container2.png");
 
-        m_vulkan_texture_ui                 = std::make_shared<VulkanTexture>();
-        m_vulkan_texture_ui->m_device       = m_vulkan_device;
-        m_vulkan_texture_ui->m_command_pool = m_command_pool;
-        m_vulkan_texture_ui->m_address_mode = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        m_vulkan_texture_ui                   = std::make_shared<VulkanTexture>();
+        m_vulkan_texture_ui->m_device         = m_vulkan_device;
+        m_vulkan_texture_ui->m_uploader       = m_vulkan_uploader;
+        m_vulkan_texture_ui->m_bindless_table = m_vulkan_bindless_table;
+        m_vulkan_texture_ui->m_command_pool   = m_command_pool;
+        m_vulkan_texture_ui->m_address_mode   = VK_SAMPLER_ADDRESS_MODE_REPEAT;
         m_vulkan_texture_ui->initizlize("asset-test/data/texture/object/texture.jpg");
+
+        // TODO : one per MaterialData once the scene brings its own
+        m_material.base_colour = m_vulkan_texture->m_bindless_index;
+
+        m_upload_required = std::max({m_upload_required, m_vulkan_texture->m_upload_token, m_vulkan_texture_ui->m_upload_token});
     }
 
     // TODO : move this to scene management
     void VulkanRHI::loadModel()
     {
         // std::filesystem::path model_uri = m_config_manager->getRootFolder() / "asset-test/data/model/viking_room/viking_room.obj";
-        std::filesystem::path model_uri = g_runtime_global_context.m_config_manager->getRootFolder() / "asset-test/data/model/nanosuit/nanosuit.obj";
+        std::filesystem::path model_uri = g_runtime_global_context.m_config_manager->getRootFolder() / m_scene_model_url;
         // std::filesystem::path mtl_path  = m_config_manager->getRootFolder() / "asset-test/data/model/nanosuit/";
         // std::filesystem::path model_uri = m_config_manager->getRootFolder() / "asset-test/data/model/basic/cube.obj";
         // TODO : make this with world load
@@ -474,157 +450,99 @@ namespace ArchViz
         }
     }
 
-    void VulkanRHI::createVertexBuffer()
-    {
-        VkDeviceSize buffer_size = sizeof(m_vertices[0]) * m_vertices.size();
-
-        m_vulkan_vertex_buffer           = std::make_shared<VulkanBuffer>();
-        m_vulkan_vertex_buffer->size     = buffer_size;
-        m_vulkan_vertex_buffer->usage    = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
-        m_vulkan_vertex_buffer->property = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-        m_vulkan_vertex_buffer->device   = m_vulkan_device;
-
-        VulkanBufferUtils::createBuffer(
-            m_vulkan_device, m_vulkan_vertex_buffer->size, m_vulkan_vertex_buffer->usage, m_vulkan_vertex_buffer->property, m_vulkan_vertex_buffer->buffer, m_vulkan_vertex_buffer->memory);
-
-        m_vulkan_vertex_buffer->setupDescriptor();
-        m_vulkan_vertex_buffer->map();
-        memcpy(m_vulkan_vertex_buffer->mapped, m_vertices.data(), (size_t)buffer_size);
-        m_vulkan_vertex_buffer->flush();
-        m_vulkan_vertex_buffer->unmap();
-    }
-
-    void VulkanRHI::createIndexBuffer()
+    void VulkanRHI::createMeshArena()
     {
-        VkDeviceSize buffer_size = sizeof(m_indices[0]) * m_indices.size();
-
-        m_vulkan_index_buffer           = std::make_shared<VulkanBuffer>();
-        m_vulkan_index_buffer->size     = buffer_size;
-        m_vulkan_index_buffer->usage    = VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
-        m_vulkan_index_buffer->property = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-        m_vulkan_index_buffer->device   = m_vulkan_device;
-
-        VulkanBufferUtils::createBuffer(
-            m_vulkan_device, m_vulkan_index_buffer->size, m_vulkan_index_buffer->usage, m_vulkan_index_buffer->property, m_vulkan_index_buffer->buffer, m_vulkan_index_buffer->memory);
-
-        m_vulkan_index_buffer->setupDescriptor();
-        m_vulkan_index_buffer->map();
-        memcpy(m_vulkan_index_buffer->mapped, m_indices.data(), (size_t)buffer_size);
-        m_vulkan_index_buffer->flush();
-        m_vulkan_index_buffer->unmap();
-    }
-
-    void VulkanRHI::createUniformBuffers()
-    {
-        VkDeviceSize buffer_size = sizeof(UBO);
-
-        m_uniform_buffers.resize(VulkanConstants::k_max_frames_in_flight);
-        m_uniform_buffers_memory.resize(VulkanConstants::k_max_frames_in_flight);
-        m_uniform_buffers_mapped.resize(VulkanConstants::k_max_frames_in_flight);
-
-        m_uniform_light_buffers.resize(VulkanConstants::k_max_frames_in_flight);
-        m_uniform_light_buffers_memory.resize(VulkanConstants::k_max_frames_in_flight);
-        m_uniform_light_buffers_mapped.resize(VulkanConstants::k_max_frames_in_flight);
-
-        for (size_t i = 0; i < VulkanConstants::k_max_frames_in_flight; i++)
+        m_vulkan_mesh_arena                    = std::make_shared<VulkanMeshArena>();
+        m_vulkan_mesh_arena->m_device          = m_vulkan_device;
+        m_vulkan_mesh_arena->m_uploader        = m_vulkan_uploader;
+        m_vulkan_mesh_arena->m_vertex_stride   = sizeof(Vertex);
+        m_vulkan_mesh_arena->m_vertex_capacity = std::max(m_vulkan_mesh_arena->m_vertex_capacity, static_cast<uint32_t>(m_vertices.size()));
+        m_vulkan_mesh_arena->m_index_capacity  = std::max(m_vulkan_mesh_arena->m_index_capacity, static_cast<uint32_t>(m_indices.size()));
+        m_vulkan_mesh_arena->initialize();
+
+        // under the id the render queue gives the model, so packets of mesh components drawing it use the same range
+        if (m_initialize_info.render_queue)
         {
-            auto usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-            auto flag  = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-
-            VulkanBufferUtils::createBuffer(m_vulkan_device, buffer_size, usage, flag, m_uniform_buffers[i], m_uniform_buffers_memory[i]);
-            vkMapMemory(m_vulkan_device->m_device, m_uniform_buffers_memory[i], 0, buffer_size, 0, &m_uniform_buffers_mapped[i]);
-
-            VulkanBufferUtils::createBuffer(m_vulkan_device, buffer_size, usage, flag, m_uniform_light_buffers[i], m_uniform_light_buffers_memory[i]);
-            vkMapMemory(m_vulkan_device->m_device, m_uniform_light_buffers_memory[i], 0, buffer_size, 0, &m_uniform_light_buffers_mapped[i]);
+            m_scene_mesh = m_initialize_info.render_queue->getMeshId(m_scene_model_url);
         }
+
+        const uint64_t token = m_vulkan_mesh_arena->upload(m_scene_mesh, m_vertices.data(), static_cast<uint32_t>(m_vertices.size()), m_indices.data(), static_cast<uint32_t>(m_indices.size()));
+        m_upload_required    = std::max(m_upload_required, token);
     }
 
-    void VulkanRHI::createDescriptorSets()
+    void VulkanRHI::createIndirectDrawer()
     {
-        std::vector<VkDescriptorSetLayout> layouts(VulkanConstants::k_max_frames_in_flight, m_vulkan_pipeline->m_descriptor_set_layout);
+        m_vulkan_indirect_drawer           = std::make_shared<VulkanIndirectDrawer>();
+        m_vulkan_indirect_drawer->m_device = m_vulkan_device;
+        m_vulkan_indirect_drawer->initialize();
 
-        VkDescriptorSetAllocateInfo alloc_info {};
-        alloc_info.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-        alloc_info.descriptorPool     = m_descriptor_pool;
-        alloc_info.descriptorSetCount = VulkanConstants::k_max_frames_in_flight;
-        alloc_info.pSetLayouts        = layouts.data();
+        m_scene_indirect_draw = g_runtime_global_context.m_config_manager->getSceneIndirectDraw();
 
-        m_descriptor_sets.resize(VulkanConstants::k_max_frames_in_flight);
-        if (vkAllocateDescriptorSets(m_vulkan_device->m_device, &alloc_info, m_descriptor_sets.data()) != VK_SUCCESS)
+        // the same split as the per draw path, the commands never change so they are made once and copied every frame
+        const MeshArena& arena = m_vulkan_mesh_arena->getArena();
+        if (!arena.isResident(m_scene_mesh))
         {
-            LOG_FATAL("failed to allocate descriptor sets!");
+            return;
         }
 
-        for (uint32_t i = 0; i < VulkanConstants::k_max_frames_in_flight; i++)
+        const MeshRange& range          = arena.getRange(m_scene_mesh);
+        const uint32_t   triangle_count = range.index_count / 3;
+        const uint32_t   draw_count     = std::max(m_scene_draw_count, 1u);
+        for (uint32_t draw = 0; draw < draw_count && triangle_count > 0; ++draw)
         {
-            VkDescriptorBufferInfo buffer_info {};
-            buffer_info.buffer = m_uniform_buffers[i];
-            buffer_info.offset = 0;
-            buffer_info.range  = sizeof(UBO);
-
-            VkDescriptorImageInfo image_info {};
-            image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            image_info.imageView   = m_vulkan_texture->m_view;
-            image_info.sampler     = m_vulkan_texture->m_sampler;
-
-            VkDescriptorBufferInfo light_info {};
-            light_info.buffer = m_uniform_light_buffers[i];
-            light_info.offset = 0;
-            light_info.range  = sizeof(Light);
-
-            std::array<VkWriteDescriptorSet, 3> descriptor_writes {};
-
-            descriptor_writes[0].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            descriptor_writes[0].dstSet          = m_descriptor_sets[i];
-            descriptor_writes[0].dstBinding      = 0;
-            descriptor_writes[0].dstArrayElement = 0;
-            descriptor_writes[0].descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            descriptor_writes[0].descriptorCount = 1;
-            descriptor_writes[0].pBufferInfo     = &buffer_info;
-
-            descriptor_writes[1].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            descriptor_writes[1].dstSet          = m_descriptor_sets[i];
-            descriptor_writes[1].dstBinding      = 1;
-            descriptor_writes[1].dstArrayElement = 0;
-            descriptor_writes[1].descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-            descriptor_writes[1].descriptorCount = 1;
-            descriptor_writes[1].pImageInfo      = &image_info;
-
-            descriptor_writes[2].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            descriptor_writes[2].dstSet          = m_descriptor_sets[i];
-            descriptor_writes[2].dstBinding      = 2;
-            descriptor_writes[2].dstArrayElement = 0;
-            descriptor_writes[2].descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            descriptor_writes[2].descriptorCount = 1;
-            descriptor_writes[2].pBufferInfo     = &light_info;
-
-            vkUpdateDescriptorSets(m_vulkan_device->m_device, static_cast<uint32_t>(descriptor_writes.size()), descriptor_writes.data(), 0, nullptr);
+            const uint32_t first = static_cast<uint32_t>(static_cast<uint64_t>(triangle_count) * draw / draw_count);
+            const uint32_t last  = static_cast<uint32_t>(static_cast<uint64_t>(triangle_count) * (draw + 1) / draw_count);
+            const uint32_t count = std::max(last - first, 1u);
+
+            m_scene_commands.push_back({count * 3, 1, range.first_index + first * 3, static_cast<int32_t>(range.vertex_offset), 0});
         }
+        m_scene_buckets = {{0, 0, 0, static_cast<uint32_t>(m_scene_commands.size())}};
     }
 
-    void VulkanRHI::createBindlessDescriptorSets()
+    void VulkanRHI::createUniformBuffers()
     {
-        if (!m_bindless_supported)
-            return;
-
-        uint32_t max_binding = VulkanConstants::k_max_bindless_resources - 1;
-
-        VkDescriptorSetVariableDescriptorCountAllocateInfoEXT count_info {};
-        count_info.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO_EXT;
-        count_info.descriptorSetCount = 1;
-        count_info.pDescriptorCounts  = &max_binding; // This number is the max allocatable count
+        m_vulkan_uniform_allocator           = std::make_shared<VulkanUniformAllocator>();
+        m_vulkan_uniform_allocator->m_device = m_vulkan_device;
+        m_vulkan_uniform_allocator->initialize();
+    }
 
+    void VulkanRHI::createDescriptorSets()
+    {
         VkDescriptorSetAllocateInfo alloc_info {};
         alloc_info.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-        alloc_info.descriptorPool     = m_bindless_pool;
+        alloc_info.descriptorPool     = m_descriptor_pool;
         alloc_info.descriptorSetCount = 1;
-        alloc_info.pSetLayouts        = &m_bindless_set_layout;
-        // alloc_info.pNext = &count_info;
+        alloc_info.pSetLayouts        = &m_vulkan_pipeline->m_descriptor_set_layout;
 
-        if (vkAllocateDescriptorSets(m_vulkan_device->m_device, &alloc_info, &m_bindless_set) != VK_SUCCESS)
+        if (vkAllocateDescriptorSets(m_vulkan_device->m_device, &alloc_info, &m_descriptor_set) != VK_SUCCESS)
         {
-            LOG_FATAL("failed to allocate bindless descriptor sets!");
+            LOG_FATAL("failed to allocate descriptor sets!");
         }
+
+        // written once, every frame and draw picks its data with the dynamic offsets
+        VkDescriptorBufferInfo buffer_info = m_vulkan_uniform_allocator->getDescriptorInfo(sizeof(UBO));
+        VkDescriptorBufferInfo light_info  = m_vulkan_uniform_allocator->getDescriptorInfo(sizeof(Light));
+
+        // the texture is read from the bindless table
+        std::array<VkWriteDescriptorSet, 2> descriptor_writes {};
+
+        descriptor_writes[0].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptor_writes[0].dstSet          = m_descriptor_set;
+        descriptor_writes[0].dstBinding      = 0;
+        descriptor_writes[0].dstArrayElement = 0;
+        descriptor_writes[0].descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        descriptor_writes[0].descriptorCount = 1;
+        descriptor_writes[0].pBufferInfo     = &buffer_info;
+
+        descriptor_writes[1].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptor_writes[1].dstSet          = m_descriptor_set;
+        descriptor_writes[1].dstBinding      = 2;
+        descriptor_writes[1].dstArrayElement = 0;
+        descriptor_writes[1].descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        descriptor_writes[1].descriptorCount = 1;
+        descriptor_writes[1].pBufferInfo     = &light_info;
+
+        vkUpdateDescriptorSets(m_vulkan_device->m_device, static_cast<uint32_t>(descriptor_writes.size()), descriptor_writes.data(), 0, nullptr);
     }
 
     void VulkanRHI::createSyncObjects()
@@ -749,19 +667,8 @@ namespace ArchViz
 
         VkDeviceSize buffer_size = sizeof(Particle) * VulkanConstants::k_particle_count;
 
-        // Create a staging buffer used to upload data to the gpu
-        VkBuffer       stagingBuffer;
-        VkDeviceMemory stagingBufferMemory;
-        VulkanBufferUtils::createBuffer(
-            m_vulkan_device, buffer_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
-
-        void* data;
-        vkMapMemory(m_vulkan_device->m_device, stagingBufferMemory, 0, buffer_size, 0, &data);
-        memcpy(data, particles.data(), (size_t)buffer_size);
-        vkUnmapMemory(m_vulkan_device->m_device, stagingBufferMemory);
-
         m_shader_storage_buffers.resize(VulkanConstants::k_max_frames_in_flight);
-        m_shader_storage_buffers_memory.resize(VulkanConstants::k_max_frames_in_flight);
+        m_shader_storage_buffers_allocation.resize(VulkanConstants::k_max_frames_in_flight);
 
         // Copy initial particle data to all storage buffers
         for (uint32_t i = 0; i < VulkanConstants::k_max_frames_in_flight; i++)
@@ -771,12 +678,10 @@ namespace ArchViz
                                             VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
                                             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
                                             m_shader_storage_buffers[i],
-                                            m_shader_storage_buffers_memory[i]);
-            VulkanBufferUtils::copyBuffer(m_vulkan_device, m_command_pool, stagingBuffer, m_shader_storage_buffers[i], buffer_size);
+                                            m_shader_storage_buffers_allocation[i]);
+            const uint64_t token = m_vulkan_uploader->uploadBuffer(m_shader_storage_buffers[i], 0, particles.data(), buffer_size);
+            m_upload_required    = std::max(m_upload_required, token);
         }
-
-        vkDestroyBuffer(m_vulkan_device->m_device, stagingBuffer, nullptr);
-        vkFreeMemory(m_vulkan_device->m_device, stagingBufferMemory, nullptr);
     }
 
     void VulkanRHI::createComputeUniformBuffers()
@@ -784,16 +689,14 @@ namespace ArchViz
         VkDeviceSize buffer_size = sizeof(float);
 
         m_particle_uniform_buffers.resize(VulkanConstants::k_max_frames_in_flight);
-        m_particle_uniform_buffers_memory.resize(VulkanConstants::k_max_frames_in_flight);
+        m_particle_uniform_buffers_allocation.resize(VulkanConstants::k_max_frames_in_flight);
         m_particle_uniform_buffers_mapped.resize(VulkanConstants::k_max_frames_in_flight);
 
         for (uint32_t i = 0; i < VulkanConstants::k_max_frames_in_flight; i++)
         {
             auto usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
             auto flag  = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-            VulkanBufferUtils::createBuffer(m_vulkan_device, buffer_size, usage, flag, m_particle_uniform_buffers[i], m_particle_uniform_buffers_memory[i]);
-
-            vkMapMemory(m_vulkan_device->m_device, m_particle_uniform_buffers_memory[i], 0, buffer_size, 0, &m_particle_uniform_buffers_mapped[i]);
+            VulkanBufferUtils::createBuffer(m_vulkan_device, buffer_size, usage, flag, m_particle_uniform_buffers[i], m_particle_uniform_buffers_allocation[i], &m_particle_uniform_buffers_mapped[i]);
         }
     }
 
@@ -914,19 +817,14 @@ namespace ArchViz
         m_vulkan_ui->m_image_count     = static_cast<uint32_t>(m_vulkan_swap_chain->m_images.size());
         m_vulkan_ui->m_image_format    = m_vulkan_swap_chain->m_surface_format.format;
         m_vulkan_ui->m_command_pool    = m_command_pool;
-        m_vulkan_ui->m_descriptor_pool = m_descriptor_pool;
+        m_vulkan_ui->m_uploader        = m_vulkan_uploader;
+        m_vulkan_ui->m_bindless_table  = m_vulkan_bindless_table;
         m_vulkan_ui->m_pipeline_cache  = m_pipeline_cache;
         m_vulkan_ui->m_ui_pass         = m_vulkan_render_pass->m_render_pass;
 
         m_vulkan_ui->initialize();
 
-        m_vulkan_texture->m_descriptor_set_layout = m_vulkan_ui->m_descriptor_set_layout;
-        m_vulkan_texture->m_descriptor_pool       = m_vulkan_ui->m_descriptor_pool;
-        m_vulkan_texture->createDescriptorSet();
-
-        m_vulkan_texture_ui->m_descriptor_set_layout = m_vulkan_ui->m_descriptor_set_layout;
-        m_vulkan_texture_ui->m_descriptor_pool       = m_vulkan_ui->m_descriptor_pool;
-        m_vulkan_texture_ui->createDescriptorSet();
+        m_upload_required = std::max(m_upload_required, m_vulkan_ui->m_font_texture->m_upload_token);
     }
 
     // ---------------------------------------------------------------------------
@@ -946,12 +844,10 @@ namespace ArchViz
         createSwapChain();
 
         createDescriptorPool();
-        createBindlessDescriptorPool();
-
-        createBindlessDescriptorSetLayout();
 
         createRenderPass();
         createGraphicsPipelineCache();
+        createBindlessTable();
         createGraphicsPipeline();
 
         createCommandPool();
@@ -960,18 +856,18 @@ namespace ArchViz
         createFramebuffers();
 
         createCommandBuffer();
+        createParallelRecorder();
+        createStagingUploader();
 
         createTextureImage();
 
         loadModel();
 
-        createVertexBuffer();
-        createIndexBuffer();
+        createMeshArena();
+        createIndirectDrawer();
         createUniformBuffers();
         createDescriptorSets();
 
-        createBindlessDescriptorSets();
-
         createSyncObjects();
 
         createComputeDescriptorSetLayout();
@@ -1017,6 +913,71 @@ namespace ArchViz
         }
     }
 
+    void VulkanRHI::recordSceneDraws(VkCommandBuffer command_buffer, uint32_t begin, uint32_t end)
+    {
+        if (!m_scene_uniforms_valid)
+        {
+            return;
+        }
+
+        VulkanDebugUtils::cmdBeginLabel(command_buffer, "subpass 1: color pass", {0.0f, 0.5f, 1.0f, 1.0f});
+
+        // a secondary buffer inherits no state, every chunk binds its own
+        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_vulkan_pipeline->m_pipeline);
+
+        // https://www.saschawillems.de/blog/2019/03/29/flipping-the-vulkan-viewport/
+        VkViewport viewport {};
+        viewport.x        = 0.0f;
+        viewport.y        = (float)m_vulkan_swap_chain->m_swap_chain_extent.height;
+        viewport.width    = (float)m_vulkan_swap_chain->m_swap_chain_extent.width;
+        viewport.height   = -(float)m_vulkan_swap_chain->m_swap_chain_extent.height;
+        viewport.minDepth = 0.0f;
+        viewport.maxDepth = 1.0f;
+        vkCmdSetViewport(command_buffer, 0, 1, &viewport);
+
+        VkRect2D scissor {};
+        scissor.offset = {0, 0};
+        scissor.extent = m_vulkan_swap_chain->m_swap_chain_extent;
+        vkCmdSetScissor(command_buffer, 0, 1, &scissor);
+
+        // every mesh is in these two buffers, the draws only differ in their offsets
+        m_vulkan_mesh_arena->bind(command_buffer);
+
+        // the offsets pick this frame's uniforms out of the allocator
+        vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_vulkan_pipeline->m_pipeline_layout, 0, 1, &m_descriptor_set, static_cast<uint32_t>(m_scene_dynamic_offsets.size()), m_scene_dynamic_offsets.data());
+        m_vulkan_bindless_table->bind(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_vulkan_pipeline->m_pipeline_layout, 1);
+
+        // the material is a handful of indices into the table, the draws bind nothing
+        const ShaderPushConstantReflection& material_range = m_vulkan_pipeline->m_layout_desc.push_constants[0];
+        vkCmdPushConstants(command_buffer, m_vulkan_pipeline->m_pipeline_layout, material_range.stages, 0, sizeof(BindlessMaterial), &m_material);
+
+        // draw i covers its share of the triangles, past one draw per triangle the extra draws repeat one and fail the depth test
+        const MeshArena& arena = m_vulkan_mesh_arena->getArena();
+        if (!m_scene_indirect_draw && arena.isResident(m_scene_mesh))
+        {
+            const MeshRange& range          = arena.getRange(m_scene_mesh);
+            const uint32_t   triangle_count = range.index_count / 3;
+            const uint32_t   draw_count     = std::max(m_scene_draw_count, 1u);
+            for (uint32_t draw = begin; draw < end && triangle_count > 0; ++draw)
+            {
+                const uint32_t first = static_cast<uint32_t>(static_cast<uint64_t>(triangle_count) * draw / draw_count);
+                const uint32_t last  = static_cast<uint32_t>(static_cast<uint64_t>(triangle_count) * (draw + 1) / draw_count);
+                const uint32_t count = std::max(last - first, 1u);
+
+                vkCmdDrawIndexed(command_buffer, count * 3, 1, range.first_index + first * 3, static_cast<int32_t>(range.vertex_offset), 0);
+            }
+        }
+
+        // the indirect buckets go with the first chunk, with indirect scene draws it is the only one. Only pass 0 and
+        // pipeline 0 match what is bound above
+        if (begin == 0)
+        {
+            m_vulkan_indirect_drawer->record(command_buffer, [](VkCommandBuffer, const DrawBucket& bucket) { return bucket.pass == 0 && bucket.pipeline == 0; });
+        }
+
+        VulkanDebugUtils::cmdEndLabel(command_buffer);
+    }
+
     void VulkanRHI::recordCommandBuffer(VkCommandBuffer command_buffer, uint32_t image_index)
     {
         VkCommandBufferBeginInfo begin_info {};
@@ -1027,6 +988,9 @@ namespace ArchViz
             LOG_FATAL("failed to begin recording command buffer!");
         }
 
+        // the uploads are acquired by the graphics family they were released to, the mip blits need it as well
+        m_upload_wait = m_vulkan_uploader->recordAcquire(command_buffer, m_upload_required);
+
         {
             VkRenderPassBeginInfo render_pass_info {};
             render_pass_info.sType             = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -1042,59 +1006,22 @@ namespace ArchViz
             render_pass_info.clearValueCount = static_cast<uint32_t>(clear_color.size());
             render_pass_info.pClearValues    = clear_color.data();
 
-            vkCmdBeginRenderPass(command_buffer, &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
-
-            {
-                VulkanDebugUtils::cmdBeginLabel(command_buffer, "subpass 1: color pass", {0.0f, 0.5f, 1.0f, 1.0f});
-
-                vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_vulkan_pipeline->m_pipeline);
-
-                // https://www.saschawillems.de/blog/2019/03/29/flipping-the-vulkan-viewport/
-                VkViewport viewport {};
-                viewport.x        = 0.0f;
-                viewport.y        = (float)m_vulkan_swap_chain->m_swap_chain_extent.height;
-                viewport.width    = (float)m_vulkan_swap_chain->m_swap_chain_extent.width;
-                viewport.height   = -(float)m_vulkan_swap_chain->m_swap_chain_extent.height;
-                viewport.minDepth = 0.0f;
-                viewport.maxDepth = 1.0f;
-                vkCmdSetViewport(command_buffer, 0, 1, &viewport);
+            // the scene draws come from secondary command buffers recorded in parallel, the ui stays inline
+            vkCmdBeginRenderPass(command_buffer, &render_pass_info, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
 
-                VkRect2D scissor {};
-                scissor.offset = {0, 0};
-                scissor.extent = m_vulkan_swap_chain->m_swap_chain_extent;
-                vkCmdSetScissor(command_buffer, 0, 1, &scissor);
-
-                VkBuffer     vertex_buffers[] = {m_vulkan_vertex_buffer->buffer};
-                VkDeviceSize offsets[]        = {0};
-                vkCmdBindVertexBuffers(command_buffer, 0, 1, vertex_buffers, offsets);
-
-                vkCmdBindIndexBuffer(command_buffer, m_vulkan_index_buffer->buffer, 0, VK_INDEX_TYPE_UINT32);
-
-                vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_vulkan_pipeline->m_pipeline_layout, 0, 1, &m_descriptor_sets[m_current_frame], 0, nullptr);
-
-                vkCmdDrawIndexed(command_buffer, static_cast<uint32_t>(m_indices.size()), 1, 0, 0, 0);
-
-                VulkanDebugUtils::cmdEndLabel(command_buffer);
-            }
+            m_vulkan_parallel_recorder->record(command_buffer,
+                                               m_vulkan_render_pass->m_render_pass,
+                                               0,
+                                               m_swap_chain_framebuffers[image_index],
+                                               m_scene_indirect_draw ? 1 : m_scene_draw_count,
+                                               [this](VkCommandBuffer secondary, uint32_t, uint32_t begin, uint32_t end) { recordSceneDraws(secondary, begin, end); });
 
             {
-                // VulkanDebugUtils::cmdBeginLabel(command_buffer, "subpass 1.1: color pass", {0.0f, 0.5f, 1.0f, 1.0f});
-
-                // VkBuffer     vertex_buffers[] = {m_vulkan_vertex_buffer->buffer};
-                // VkDeviceSize offsets[]        = {0};
-                // vkCmdBindVertexBuffers(command_buffer, 0, 1, vertex_buffers, offsets);
-                // vkCmdBindIndexBuffer(command_buffer, m_vulkan_index_buffer->buffer, 0, VK_INDEX_TYPE_UINT32);
-                // vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_vulkan_pipeline->m_pipeline_layout, 0, 1, &m_descriptor_sets[m_current_frame], 0, nullptr);
-                // vkCmdDrawIndexed(command_buffer, static_cast<uint32_t>(m_indices.size()), 1, 0, 0, 0);
-
-                // VulkanDebugUtils::cmdEndLabel(command_buffer);
-            }
+                // nothing but vkCmdExecuteCommands is recorded in the primary before the next subpass
+                vkCmdNextSubpass(command_buffer, VK_SUBPASS_CONTENTS_INLINE);
 
-            {
                 VulkanDebugUtils::cmdBeginLabel(command_buffer, "subpass 2: ui pass", {0.5f, 0.76f, 0.34f, 1.0f});
 
-                vkCmdNextSubpass(command_buffer, VK_SUBPASS_CONTENTS_INLINE);
-
                 m_vulkan_ui->recordCommandBuffer(command_buffer, m_swap_chain_framebuffers[image_index]);
 
                 VulkanDebugUtils::cmdEndLabel(command_buffer);
@@ -1115,47 +1042,55 @@ namespace ArchViz
 
         // update particle ubo
         memcpy(m_particle_uniform_buffers_mapped[current_image], &m_dt_ubo, sizeof(float));
-        // update required data
-        memcpy(m_uniform_buffers_mapped[current_image], &m_ubo, sizeof(m_ubo));
-        // update light info
-        memcpy(m_uniform_light_buffers_mapped[current_image], &m_light_ubo, sizeof(m_light_ubo));
-    }
-
-    void VulkanRHI::prepareContext()
-    {
-        // wait compute fence (first render pass)
-        // Compute submission
-        vkWaitForFences(m_vulkan_device->m_device, 1, &m_compute_in_flight_fences[m_current_frame], VK_TRUE, UINT64_MAX);
-        vkResetFences(m_vulkan_device->m_device, 1, &m_compute_in_flight_fences[m_current_frame]);
+        // the frame's range of the uniform allocator was reset in prepareContext
+        const uint32_t ubo_offset   = m_vulkan_uniform_allocator->push(m_ubo);
+        const uint32_t light_offset = m_vulkan_uniform_allocator->push(m_light_ubo);
 
-        updateUniformBuffer(m_current_frame);
+        // offsets kept from an earlier frame point into the range of another frame slot, the scene is skipped instead
+        m_scene_uniforms_valid = ubo_offset != VulkanUniformAllocator::k_invalid_offset && light_offset != VulkanUniformAllocator::k_invalid_offset;
+        if (m_scene_uniforms_valid)
+        {
+            m_scene_dynamic_offsets = {ubo_offset, light_offset};
+        }
+        else
+        {
+            LOG_WARN("[vulkan] scene uniforms do not fit in the frame range of {} bytes, scene not drawn", m_vulkan_uniform_allocator->m_frame_size);
+        }
     }
 
-    void VulkanRHI::drawFrame()
+    void VulkanRHI::prepareContext()
     {
-        VkSubmitInfo submitInfo {};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        // the only cpu wait of the frame: both submissions of this frame slot have to be done before its buffers are touched again,
+        // the fences are reset right before their submits so an early return on a stale swap chain leaves them signaled
+        std::array<VkFence, 2> fences = {m_compute_in_flight_fences[m_current_frame], m_in_flight_fences[m_current_frame]};
+        vkWaitForFences(m_vulkan_device->m_device, static_cast<uint32_t>(fences.size()), fences.data(), VK_TRUE, UINT64_MAX);
 
-        vkResetCommandBuffer(m_compute_command_buffers[m_current_frame], /*VkCommandBufferResetFlagBits*/ 0);
-        recordComputeCommandBuffer(m_compute_command_buffers[m_current_frame]);
+        // polled, never waited for
+        m_vulkan_uploader->update();
 
-        submitInfo.commandBufferCount   = 1;
-        submitInfo.pCommandBuffers      = &m_compute_command_buffers[m_current_frame];
-        submitInfo.signalSemaphoreCount = 1;
-        submitInfo.pSignalSemaphores    = &m_compute_finished_semaphores[m_current_frame];
+        // the frame that last used this slot completed, so did everything released back then
+        m_vulkan_bindless_table->beginFrame();
+        m_vulkan_uniform_allocator->beginFrame(m_current_frame);
+        m_vulkan_mesh_arena->beginFrame();
+        m_vulkan_indirect_drawer->beginFrame(m_current_frame);
 
-        if (vkQueueSubmit(m_vulkan_device->m_compute_queue, 1, &submitInfo, m_compute_in_flight_fences[m_current_frame]) != VK_SUCCESS)
+        if (m_scene_indirect_draw)
         {
-            LOG_FATAL("failed to submit compute command buffer!");
-        };
+            m_vulkan_indirect_drawer->push(m_scene_commands.data(), static_cast<uint32_t>(m_scene_commands.size()), m_scene_buckets);
+        }
 
-        vkWaitForFences(m_vulkan_device->m_device, 1, &m_in_flight_fences[m_current_frame], VK_TRUE, UINT64_MAX);
-        vkResetFences(m_vulkan_device->m_device, 1, &m_in_flight_fences[m_current_frame]);
+        // TODO : push the render queue batches through an IndirectCommandBuilder once the shaders read its instance stream,
+        // until then each of them would be drawn as the scene model with its material
+
+        updateUniformBuffer(m_current_frame);
+    }
 
+    void VulkanRHI::drawFrame()
+    {
         // TODO : Although many drivers and platforms trigger VK_ERROR_OUT_OF_DATE_KHR automatically after a window resize, it is not guaranteed to happen.
         // That's why we'll add some extra code to also handle resizes explicitly.
 
-        // handle swap chain recreation
+        // handle swap chain recreation, before anything is submitted so no semaphore is left signaled without a wait
         uint32_t image_index;
 
         VkResult result = m_vulkan_swap_chain->acquireNextImage(m_image_available_semaphores[m_current_frame], &image_index);
@@ -1169,17 +1104,63 @@ namespace ArchViz
             LOG_FATAL("failed to acquire swap chain image!");
         }
 
+        // everything uploaded since the last frame goes out as one transfer batch
+        m_vulkan_uploader->flush();
+
+        // and every descriptor added since then as one vkUpdateDescriptorSets
+        m_vulkan_bindless_table->flush();
+
+        // compute and graphics go out back to back, the graphics submit waits on the compute semaphore on the gpu only
+        vkResetFences(m_vulkan_device->m_device, 1, &m_compute_in_flight_fences[m_current_frame]);
+
+        vkResetCommandBuffer(m_compute_command_buffers[m_current_frame], /*VkCommandBufferResetFlagBits*/ 0);
+        recordComputeCommandBuffer(m_compute_command_buffers[m_current_frame]);
+
+        // compute only reads the particles uploaded at initialize, the graphics submit waits for everything it acquires
+        const uint64_t       compute_upload_wait = std::min(m_upload_required, m_vulkan_uploader->submittedValue());
+        VkPipelineStageFlags upload_wait_stage   = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+        VkTimelineSemaphoreSubmitInfo timeline_info {};
+        timeline_info.sType                   = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        timeline_info.waitSemaphoreValueCount = 1;
+        timeline_info.pWaitSemaphoreValues    = &compute_upload_wait;
+
+        VkSubmitInfo submitInfo {};
+        submitInfo.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.pNext                = &timeline_info;
+        submitInfo.waitSemaphoreCount   = 1;
+        submitInfo.pWaitSemaphores      = &m_vulkan_uploader->m_timeline;
+        submitInfo.pWaitDstStageMask    = &upload_wait_stage;
+        submitInfo.commandBufferCount   = 1;
+        submitInfo.pCommandBuffers      = &m_compute_command_buffers[m_current_frame];
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores    = &m_compute_finished_semaphores[m_current_frame];
+
+        if (vkQueueSubmit(m_vulkan_device->m_compute_queue, 1, &submitInfo, m_compute_in_flight_fences[m_current_frame]) != VK_SUCCESS)
+        {
+            LOG_FATAL("failed to submit compute command buffer!");
+        };
+
         vkResetFences(m_vulkan_device->m_device, 1, &m_in_flight_fences[m_current_frame]);
 
         vkResetCommandBuffer(m_command_buffers[m_current_frame], /*VkCommandBufferResetFlagBits*/ 0);
+        m_vulkan_parallel_recorder->beginFrame(m_current_frame);
         recordCommandBuffer(m_command_buffers[m_current_frame], image_index);
 
-        std::array<VkSemaphore, 2>          wait_semaphores   = {m_compute_finished_semaphores[m_current_frame], m_image_available_semaphores[m_current_frame]};
-        std::array<VkPipelineStageFlags, 2> wait_stages       = {VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
+        // the binary semaphores ignore their wait values, the upload timeline waits for what recordAcquire returned
+        std::array<VkSemaphore, 3>          wait_semaphores   = {m_compute_finished_semaphores[m_current_frame], m_image_available_semaphores[m_current_frame], m_vulkan_uploader->m_timeline};
+        std::array<VkPipelineStageFlags, 3> wait_stages       = {VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT};
+        std::array<uint64_t, 3>             wait_values       = {0, 0, m_upload_wait};
         std::array<VkSemaphore, 1>          signal_semaphores = {m_render_finished_semaphores[m_current_frame]};
 
+        VkTimelineSemaphoreSubmitInfo graphics_timeline_info {};
+        graphics_timeline_info.sType                   = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        graphics_timeline_info.waitSemaphoreValueCount = static_cast<uint32_t>(wait_values.size());
+        graphics_timeline_info.pWaitSemaphoreValues    = wait_values.data();
+
         VkSubmitInfo submit_info {};
         submit_info.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit_info.pNext                = &graphics_timeline_info;
         submit_info.waitSemaphoreCount   = static_cast<uint32_t>(wait_semaphores.size());
         submit_info.pWaitSemaphores      = wait_semaphores.data();
         submit_info.pWaitDstStageMask    = wait_stages.data();
@@ -1227,6 +1208,13 @@ namespace ArchViz
     {
         m_vulkan_device->wait();
 
+        // what the scene used at its peak, before anything is released
+        m_vulkan_device->m_allocator->logStatistics();
+        m_vulkan_device->m_allocator->dumpStatistics(g_runtime_global_context.m_config_manager->getRootFolder() / "memory_statistics.json");
+
+        m_vulkan_uploader->logStatistics();
+        m_vulkan_bindless_table->logStatistics();
+
         m_vulkan_texture_ui->clear();
         m_vulkan_texture_ui.reset();
 
@@ -1236,14 +1224,35 @@ namespace ArchViz
         m_vulkan_ui->clear();
         m_vulkan_ui.reset();
 
+        // after the textures gave back their indices, before the layout cache destroys the set layout
+        m_vulkan_bindless_table->clear();
+        m_vulkan_bindless_table.reset();
+
         m_vulkan_pipeline->clear();
         m_vulkan_pipeline.reset();
 
+        m_vulkan_parallel_recorder->logStatistics();
+        m_vulkan_parallel_recorder->clear();
+        m_vulkan_parallel_recorder.reset();
+
+        // saves the pipeline cache blob for the next run
+        m_vulkan_pipeline_state_cache->clear();
+        m_vulkan_pipeline_state_cache.reset();
+        m_pipeline_cache = VK_NULL_HANDLE;
+
+        m_vulkan_layout_cache->clear();
+        m_vulkan_layout_cache.reset();
+
         m_vulkan_render_pass->clear();
         m_vulkan_render_pass.reset();
 
-        m_vulkan_vertex_buffer->destroy();
-        m_vulkan_index_buffer->destroy();
+        m_vulkan_indirect_drawer->logStatistics();
+        m_vulkan_indirect_drawer->clear();
+        m_vulkan_indirect_drawer.reset();
+
+        m_vulkan_mesh_arena->logStatistics();
+        m_vulkan_mesh_arena->clear();
+        m_vulkan_mesh_arena.reset();
 
         for (uint32_t i = 0; i < VulkanConstants::k_max_frames_in_flight; i++)
         {
@@ -1260,25 +1269,24 @@ namespace ArchViz
 
         for (uint32_t i = 0; i < VulkanConstants::k_max_frames_in_flight; i++)
         {
-            VulkanBufferUtils::destroyBuffer(m_vulkan_device, m_particle_uniform_buffers[i], m_particle_uniform_buffers_memory[i]);
+            VulkanBufferUtils::destroyBuffer(m_vulkan_device, m_particle_uniform_buffers[i], m_particle_uniform_buffers_allocation[i]);
+            VulkanBufferUtils::destroyBuffer(m_vulkan_device, m_shader_storage_buffers[i], m_shader_storage_buffers_allocation[i]);
         }
 
-        for (uint32_t i = 0; i < VulkanConstants::k_max_frames_in_flight; i++)
-        {
-            VulkanBufferUtils::destroyBuffer(m_vulkan_device, m_particle_uniform_buffers[i], m_particle_uniform_buffers_memory[i]);
-            VulkanBufferUtils::destroyBuffer(m_vulkan_device, m_uniform_light_buffers[i], m_uniform_light_buffers_memory[i]);
-            VulkanBufferUtils::destroyBuffer(m_vulkan_device, m_uniform_buffers[i], m_uniform_buffers_memory[i]);
-            VulkanBufferUtils::destroyBuffer(m_vulkan_device, m_shader_storage_buffers[i], m_shader_storage_buffers_memory[i]);
-        }
+        m_vulkan_uniform_allocator->logStatistics();
+        m_vulkan_uniform_allocator->clear();
+        m_vulkan_uniform_allocator.reset();
 
         vkDestroyCommandPool(m_vulkan_device->m_device, m_command_pool, nullptr);
 
+        m_vulkan_uploader->clear();
+        m_vulkan_uploader.reset();
+
         // VulkanBufferUtils::destroyBuffer(m_vulkan_device, m_index_buffer, m_index_buffer_memory);
         // VulkanBufferUtils::destroyBuffer(m_vulkan_device, m_vertex_buffer, m_vertex_buffer_memory);
 
         vkDestroyImageView(m_vulkan_device->m_device, m_depth_image_view, nullptr);
-        vkDestroyImage(m_vulkan_device->m_device, m_depth_image, nullptr);
-        vkFreeMemory(m_vulkan_device->m_device, m_depth_image_memory, nullptr);
+        VulkanTextureUtils::destroyImage(m_vulkan_device, m_depth_image, m_depth_image_allocation);
 
         for (auto framebuffer : m_swap_chain_framebuffers)
         {
@@ -1288,33 +1296,11 @@ namespace ArchViz
         vkDestroyPipeline(m_vulkan_device->m_device, m_compute_pipeline, nullptr);
         vkDestroyPipelineLayout(m_vulkan_device->m_device, m_compute_pipeline_layout, nullptr);
 
-        if (m_bindless_supported)
-        {
-            vkDestroyDescriptorSetLayout(m_vulkan_device->m_device, m_bindless_set_layout, nullptr);
-            vkDestroyDescriptorPool(m_vulkan_device->m_device, m_bindless_pool, nullptr);
-        }
-
         vkDestroyDescriptorSetLayout(m_vulkan_device->m_device, m_compute_descriptor_set_layout, nullptr);
         // vkDestroyDescriptorSetLayout(m_vulkan_device->m_device, m_descriptor_set_layout, nullptr);
 
         vkDestroyDescriptorPool(m_vulkan_device->m_device, m_descriptor_pool, nullptr);
 
-        // store pipeline cache
-        {
-            size_t cache_size = 0;
-            vkGetPipelineCacheData(m_vulkan_device->m_device, m_pipeline_cache, &cache_size, nullptr);
-            std::vector<std::byte> cache;
-            cache.resize(cache_size);
-            vkGetPipelineCacheData(m_vulkan_device->m_device, m_pipeline_cache, &cache_size, cache.data());
-
-            VkPipelineCacheHeaderVersionOne* cache_header = (VkPipelineCacheHeaderVersionOne*)cache.data();
-
-            auto cache_path = g_runtime_global_context.m_config_manager->getRootFolder() / "pipeline.cache";
-            g_runtime_global_context.m_asset_manager->writeBinaryFile(cache_path.generic_string(), cache);
-        }
-
-        vkDestroyPipelineCache(m_vulkan_device->m_device, m_pipeline_cache, nullptr);
-
         m_vulkan_swap_chain->clear();
         m_vulkan_swap_chain.reset();
 
@@ -1,5 +1,7 @@
 #pragma once
+#include "runtime/function/render/queue/indirect_command_builder.h"
 #include "runtime/function/render/rhi/rhi.h"
+#include "runtime/function/render/rhi/vulkan/common/vulkan_bindless_table.h"
 #include "runtime/function/render/rhi/vulkan/vulkan_struct.h"
 
 #include "runtime/function/global/global_context.h"
@@ -16,6 +18,7 @@
 #include <array>
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace ArchViz
@@ -25,9 +28,16 @@ namespace ArchViz
     class VulkanDevice;
     class VulkanSwapChain;
     class VulkanPipeline;
+    class VulkanPipelineStateCache;
+    class VulkanLayoutCache;
     class VulkanRenderPass;
     class VulkanInstance;
     class VulkanUI;
+    class VulkanParallelRecorder;
+    class VulkanStagingUploader;
+    class VulkanUniformAllocator;
+    class VulkanMeshArena;
+    class VulkanIndirectDrawer;
     class VulkanTexture;
     class VulkanBuffer;
     class Vertex;
@@ -69,13 +79,13 @@ namespace ArchViz
         void createVulkanDevice();
 
         void createDescriptorPool();
-        void createBindlessDescriptorPool();
 
         // void createDescriptorSetLayout();
-        void createBindlessDescriptorSetLayout();
 
         void createRenderPass();
         void createGraphicsPipelineCache();
+        // before any pipeline, their layouts use the table's set layout
+        void createBindlessTable();
         void createGraphicsPipeline();
 
         void createCommandPool();
@@ -84,19 +94,20 @@ namespace ArchViz
         void createFramebuffers();
 
         void createCommandBuffer();
+        void createParallelRecorder();
+        void createStagingUploader();
 
         // TODO : move to scene part
         void createTextureImage();
         // TODO : move to scene part
         void loadModel();
 
-        void createVertexBuffer();
-        void createIndexBuffer();
+        // the model goes into the mesh arena, its scene draws become indirect commands
+        void createMeshArena();
+        void createIndirectDrawer();
         void createUniformBuffers();
         void createDescriptorSets();
 
-        void createBindlessDescriptorSets();
-
         void createSyncObjects();
 
         // ---------------------------------------------------------------------------
@@ -124,21 +135,23 @@ namespace ArchViz
     private:
         void recordComputeCommandBuffer(VkCommandBuffer commandBuffer);
         void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t image_index);
+        // the scene draws in [begin, end), called from the recording threads
+        void recordSceneDraws(VkCommandBuffer command_buffer, uint32_t begin, uint32_t end);
         void updateUniformBuffer(uint32_t current_image);
         void drawFrame();
 
     public:
-        bool m_bindless_supported = true;
-
         uint32_t m_fps;
 
         RHIInitInfo m_initialize_info;
 
-        std::shared_ptr<VulkanInstance>   m_vulkan_instance;
-        std::shared_ptr<VulkanDevice>     m_vulkan_device;
-        std::shared_ptr<VulkanSwapChain>  m_vulkan_swap_chain;
-        std::shared_ptr<VulkanPipeline>   m_vulkan_pipeline;
-        std::shared_ptr<VulkanRenderPass> m_vulkan_render_pass;
+        std::shared_ptr<VulkanInstance>    m_vulkan_instance;
+        std::shared_ptr<VulkanDevice>      m_vulkan_device;
+        std::shared_ptr<VulkanSwapChain>   m_vulkan_swap_chain;
+        std::shared_ptr<VulkanPipeline>           m_vulkan_pipeline;
+        std::shared_ptr<VulkanPipelineStateCache> m_vulkan_pipeline_state_cache;
+        std::shared_ptr<VulkanLayoutCache>        m_vulkan_layout_cache;
+        std::shared_ptr<VulkanRenderPass>         m_vulkan_render_pass;
 
         std::shared_ptr<VulkanTexture> m_vulkan_texture;
         std::shared_ptr<VulkanTexture> m_vulkan_texture_ui;
@@ -151,13 +164,13 @@ namespace ArchViz
         // ---------------------------------------------------------------------------
         // ---------------------------------------------------------------------------
 
-        // add pipeline cache storage to increase creation speed
+        // owned by m_vulkan_pipeline_state_cache, which keeps it on disk between runs
         VkPipelineCache m_pipeline_cache;
 
-        VkFormat       m_depth_format;
-        VkImage        m_depth_image;
-        VkDeviceMemory m_depth_image_memory;
-        VkImageView    m_depth_image_view;
+        VkFormat      m_depth_format;
+        VkImage       m_depth_image;
+        VmaAllocation m_depth_image_allocation;
+        VkImageView   m_depth_image_view;
 
         std::vector<VkFramebuffer> m_swap_chain_framebuffers;
 
@@ -172,25 +185,33 @@ namespace ArchViz
         // ---------------------------------------------------------------------------
         // ---------------------------------------------------------------------------
 
-        uint32_t              m_bindless_pool_size;
-        VkDescriptorPool      m_bindless_pool;
-        VkDescriptorSetLayout m_bindless_set_layout;
-        VkDescriptorSet       m_bindless_set;
+        // every texture, storage image, buffer and sampler by index, bound once per command buffer as set 1 of the scene
+        std::shared_ptr<VulkanBindlessTable> m_vulkan_bindless_table;
+
+        // pushed by the scene draws instead of binding a material set
+        BindlessMaterial m_material;
 
         VkDescriptorPool m_descriptor_pool;
 
-        std::vector<VkDescriptorSet> m_descriptor_sets;
+        // set 0 of the scene, its uniform buffers are dynamic and point into m_vulkan_uniform_allocator for every frame
+        VkDescriptorSet m_descriptor_set;
 
-        std::vector<VkBuffer>       m_uniform_buffers;
-        std::vector<VkDeviceMemory> m_uniform_buffers_memory;
-        std::vector<void*>          m_uniform_buffers_mapped;
+        // the uniform data of the frames in flight, reset when the frame fence signaled
+        std::shared_ptr<VulkanUniformAllocator> m_vulkan_uniform_allocator;
 
-        std::vector<VkBuffer>       m_uniform_light_buffers;
-        std::vector<VkDeviceMemory> m_uniform_light_buffers_memory;
-        std::vector<void*>          m_uniform_light_buffers_mapped;
+        // of m_ubo (binding 0) and m_light_ubo (binding 2) in the current frame, in binding order, only valid when the
+        // pushes of this frame succeeded
+        std::array<uint32_t, 2> m_scene_dynamic_offsets {0, 0};
+        bool                    m_scene_uniforms_valid {false};
 
-        std::shared_ptr<VulkanBuffer> m_vulkan_vertex_buffer;
-        std::shared_ptr<VulkanBuffer> m_vulkan_index_buffer;
+        // every mesh in one vertex and one index buffer, the model is m_scene_mesh in it
+        std::shared_ptr<VulkanMeshArena> m_vulkan_mesh_arena;
+        uint32_t                         m_scene_mesh {0};
+
+        // the scene draws as indirect commands, one call per pipeline bucket
+        std::shared_ptr<VulkanIndirectDrawer> m_vulkan_indirect_drawer;
+        std::vector<DrawIndexedCommand>       m_scene_commands;
+        std::vector<DrawBucket>               m_scene_buckets;
 
         // VkBuffer       m_vertex_buffer;
         // VkDeviceMemory m_vertex_buffer_memory;
@@ -201,8 +222,17 @@ namespace ArchViz
         VkCommandPool                m_command_pool;
         std::vector<VkCommandBuffer> m_command_buffers;
 
+        // the scene subpass is recorded into secondary buffers from per frame, per thread pools
+        std::shared_ptr<VulkanParallelRecorder> m_vulkan_parallel_recorder;
+
         VkCommandBuffer m_transfer_buffer;
 
+        // buffers and images are filled through the transfer queue, the frame waits for their timeline value on the gpu only
+        std::shared_ptr<VulkanStagingUploader> m_vulkan_uploader;
+
+        uint64_t m_upload_required {0}; // what the first frame uses, the textures and particles of initialize
+        uint64_t m_upload_wait {0};     // what the graphics submit of this frame waits for
+
         // ---------------------------------------------------------------------------
         // ---------------------------------------------------------------------------
         // ---------------------------------------------------------------------------
@@ -218,13 +248,13 @@ namespace ArchViz
 
         std::vector<VkCommandBuffer> m_compute_command_buffers;
 
-        std::vector<VkBuffer>       m_shader_storage_buffers;
-        std::vector<VkDeviceMemory> m_shader_storage_buffers_memory;
+        std::vector<VkBuffer>      m_shader_storage_buffers;
+        std::vector<VmaAllocation> m_shader_storage_buffers_allocation;
 
         // TODO : add particle ubo
-        std::vector<VkBuffer>       m_particle_uniform_buffers;
-        std::vector<VkDeviceMemory> m_particle_uniform_buffers_memory;
-        std::vector<void*>          m_particle_uniform_buffers_mapped;
+        std::vector<VkBuffer>      m_particle_uniform_buffers;
+        std::vector<VmaAllocation> m_particle_uniform_buffers_allocation;
+        std::vector<void*>         m_particle_uniform_buffers_mapped;
 
         std::vector<VkSemaphore> m_compute_finished_semaphores;
         std::vector<VkFence>     m_compute_in_flight_fences;
@@ -244,5 +274,16 @@ namespace ArchViz
         float m_dt_ubo;
 
         bool m_minimize {false};
+
+        // the model is drawn in this many draws, a draw heavy scene for the parallel recording, the image stays the same
+        // SceneDrawCount in the config
+        uint32_t m_scene_draw_count {1};
+
+        // the scene draws go through m_vulkan_indirect_drawer, one vkCmdDrawIndexed each when off
+        // SceneIndirectDraw in the config
+        bool m_scene_indirect_draw {true};
+
+        // relative to the root folder, the name the render queue knows the model by
+        std::string m_scene_model_url {"asset-test/data/model/nanosuit/nanosuit.obj"};
     };
 } // namespace ArchViz
@@ -16,9 +16,12 @@ namespace ArchViz
 
         static constexpr uint32_t k_particle_count = 8192;
 
-        static constexpr uint32_t k_global_pool_elements     = 128;
-        static constexpr uint32_t k_bindless_texture_binding = 10;
-        static constexpr uint32_t k_max_bindless_resources   = 1024;
+        static constexpr uint32_t k_global_pool_elements           = 128;
+        static constexpr uint32_t k_bindless_texture_binding       = 10;
+        static constexpr uint32_t k_bindless_storage_image_binding = 11;
+        static constexpr uint32_t k_bindless_buffer_binding        = 12;
+        static constexpr uint32_t k_bindless_sampler_binding       = 13;
+        static constexpr uint32_t k_max_bindless_resources         = 1024;
     };
 
     struct QueueFamilyIndices
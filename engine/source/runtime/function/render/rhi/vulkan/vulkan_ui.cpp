@@ -1,4 +1,5 @@
 #include "runtime/function/render/rhi/vulkan/vulkan_ui.h"
+#include "runtime/function/render/rhi/vulkan/common/vulkan_bindless_table.h"
 #include "runtime/function/render/rhi/vulkan/common/vulkan_buffer.h"
 #include "runtime/function/render/rhi/vulkan/common/vulkan_device.h"
 #include "runtime/function/render/rhi/vulkan/common/vulkan_instance.h"
@@ -22,11 +23,22 @@
 // #include "backends/imgui_impl_vulkan.h"
 #include "imgui.h"
 
+#include <cstddef>
+#include <cstdint>
 #include <stdio.h>
 #include <stdlib.h>
 
 namespace ArchViz
 {
+    namespace
+    {
+        constexpr VkShaderStageFlags k_push_constant_stages = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+        // imgui takes a null texture id for the font, the bindless index is stored plus one so index 0 stays usable
+        ImTextureID to_texture_id(uint32_t index) { return reinterpret_cast<ImTextureID>(static_cast<uintptr_t>(index) + 1); }
+        uint32_t    from_texture_id(ImTextureID id) { return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(id) - 1); }
+    } // namespace
+
     void VulkanUI::setFPS(uint32_t fps) { m_fps = fps; }
 
     void VulkanUI::initialize()
@@ -82,10 +94,12 @@ namespace ArchViz
         VkDeviceSize imageSize = tex_width * tex_height * 4;
 
         // Upload Fonts
-        m_font_texture                 = std::make_shared<VulkanTexture>();
-        m_font_texture->m_device       = m_device;
-        m_font_texture->m_command_pool = m_command_pool;
-        m_font_texture->m_address_mode = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        m_font_texture                   = std::make_shared<VulkanTexture>();
+        m_font_texture->m_device         = m_device;
+        m_font_texture->m_uploader       = m_uploader;
+        m_font_texture->m_bindless_table = m_bindless_table;
+        m_font_texture->m_command_pool   = m_command_pool;
+        m_font_texture->m_address_mode   = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
         m_font_texture->initialize(font_data, imageSize, VK_FORMAT_R8G8B8A8_UNORM, tex_width, tex_height);
 
         m_vertex_buffer = std::make_shared<VulkanBuffer>();
@@ -95,8 +109,6 @@ namespace ArchViz
         m_index_buffer->device  = m_device;
 
         // createRenderPass();
-        createDescriptorSetLayout();
-        createDescriptorSets();
         createPipelineLayout();
         createPipeline();
     }
@@ -145,58 +157,6 @@ namespace ArchViz
         }
     }
 
-    void VulkanUI::createDescriptorSetLayout()
-    {
-        VkDescriptorSetLayoutBinding sampler_layout_binding {};
-        sampler_layout_binding.binding            = 0;
-        sampler_layout_binding.descriptorCount    = 1;
-        sampler_layout_binding.descriptorType     = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        sampler_layout_binding.pImmutableSamplers = nullptr;
-        sampler_layout_binding.stageFlags         = VK_SHADER_STAGE_FRAGMENT_BIT;
-
-        std::array<VkDescriptorSetLayoutBinding, 1> bindings = {sampler_layout_binding};
-
-        VkDescriptorSetLayoutCreateInfo layout_info {};
-        layout_info.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-        layout_info.bindingCount = static_cast<uint32_t>(bindings.size());
-        layout_info.pBindings    = bindings.data();
-
-        if (vkCreateDescriptorSetLayout(m_device->m_device, &layout_info, nullptr, &m_descriptor_set_layout) != VK_SUCCESS)
-        {
-            LOG_FATAL("failed to create descriptor set layout!");
-        }
-    }
-
-    void VulkanUI::createDescriptorSets()
-    {
-        VkDescriptorSetAllocateInfo alloc_info {};
-        alloc_info.sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-        alloc_info.descriptorPool     = m_descriptor_pool;
-        alloc_info.descriptorSetCount = 1;
-        alloc_info.pSetLayouts        = &m_descriptor_set_layout;
-
-        if (vkAllocateDescriptorSets(m_device->m_device, &alloc_info, &m_descriptor_set) != VK_SUCCESS)
-        {
-            LOG_FATAL("failed to allocate descriptor sets!");
-        }
-
-        VkDescriptorImageInfo image_info {};
-        image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        image_info.imageView   = m_font_texture->m_view;
-        image_info.sampler     = m_font_texture->m_sampler;
-
-        VkWriteDescriptorSet descriptor_write {};
-
-        descriptor_write.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        descriptor_write.descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        descriptor_write.dstSet          = m_descriptor_set;
-        descriptor_write.dstBinding      = 0;
-        descriptor_write.descriptorCount = 1;
-        descriptor_write.pImageInfo      = &image_info;
-
-        vkUpdateDescriptorSets(m_device->m_device, 1, &descriptor_write, 0, nullptr);
-    }
-
     void VulkanUI::createPipelineLayout()
     {
         ShaderModuleCreateInfo config;
@@ -207,15 +167,17 @@ namespace ArchViz
         m_shader->m_device = m_device;
         m_shader->initialize();
 
+        // one range for both stages, the texture index after the transform is pushed per draw
         VkPushConstantRange push_constant_range {};
-        push_constant_range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        push_constant_range.stageFlags = k_push_constant_stages;
         push_constant_range.size       = sizeof(PushConstantBlock);
         push_constant_range.offset     = 0;
 
+        // the textures are read from the bindless table as set 0
         VkPipelineLayoutCreateInfo pipeline_layout_create_info {};
         pipeline_layout_create_info.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
         pipeline_layout_create_info.setLayoutCount         = 1;
-        pipeline_layout_create_info.pSetLayouts            = &m_descriptor_set_layout;
+        pipeline_layout_create_info.pSetLayouts            = &m_bindless_table->m_set_layout;
         pipeline_layout_create_info.pushConstantRangeCount = 1;
         pipeline_layout_create_info.pPushConstantRanges    = &push_constant_range;
 
@@ -483,9 +445,9 @@ namespace ArchViz
     {
         ImGui::Begin(name.c_str());
         {
-            ImGui::Text("pointer = %p", image->m_descriptor_set);
+            ImGui::Text("bindless index = %u", image->m_bindless_index);
             ImGui::Text("size = %d x %d", image->m_width, image->m_height);
-            ImGui::Image((ImTextureID)image->m_descriptor_set, ImVec2(image->m_width, image->m_height));
+            ImGui::Image(to_texture_id(image->m_bindless_index), ImVec2(image->m_width, image->m_height));
         }
         ImGui::End();
     }
@@ -533,7 +495,7 @@ namespace ArchViz
             m_vertex_buffer->usage    = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
             m_vertex_buffer->property = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
 
-            VulkanBufferUtils::createBuffer(m_device, m_vertex_buffer->size, m_vertex_buffer->usage, m_vertex_buffer->property, m_vertex_buffer->buffer, m_vertex_buffer->memory);
+            VulkanBufferUtils::createBuffer(m_device, m_vertex_buffer->size, m_vertex_buffer->usage, m_vertex_buffer->property, m_vertex_buffer->buffer, m_vertex_buffer->allocation);
 
             // TODO : add alignment support
             m_vertex_buffer->setupDescriptor();
@@ -556,7 +518,7 @@ namespace ArchViz
             m_index_buffer->usage    = VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
             m_index_buffer->property = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
 
-            VulkanBufferUtils::createBuffer(m_device, m_index_buffer->size, m_index_buffer->usage, m_index_buffer->property, m_index_buffer->buffer, m_index_buffer->memory);
+            VulkanBufferUtils::createBuffer(m_device, m_index_buffer->size, m_index_buffer->usage, m_index_buffer->property, m_index_buffer->buffer, m_index_buffer->allocation);
 
             // TODO : add alignment support
             m_index_buffer->setupDescriptor();
@@ -616,9 +578,13 @@ namespace ArchViz
             vkCmdSetViewport(command_buffer, 0, 1, &viewport);
 
             // UI scale and translate via push constants
-            m_push_const.scale     = {2.0f / io.DisplaySize.x, 2.0f / io.DisplaySize.y};
-            m_push_const.translate = {-1.0f, -1.0f};
-            vkCmdPushConstants(command_buffer, m_pipeline_layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(PushConstantBlock), &m_push_const);
+            m_push_const.scale         = {2.0f / io.DisplaySize.x, 2.0f / io.DisplaySize.y};
+            m_push_const.translate     = {-1.0f, -1.0f};
+            m_push_const.texture_index = m_font_texture->m_bindless_index;
+            vkCmdPushConstants(command_buffer, m_pipeline_layout, k_push_constant_stages, 0, sizeof(PushConstantBlock), &m_push_const);
+
+            // every texture is in the table, it is bound once and the draws only push their index
+            m_bindless_table->bind(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline_layout, 0);
 
             // Render commands
             ImDrawData* main_draw_data = ImGui::GetDrawData();
@@ -639,18 +605,9 @@ namespace ArchViz
                         const ImDrawCmd* pcmd = &cmd_list->CmdBuffer[j];
                         VkRect2D         scissorRect;
 
-                        VkDescriptorSet desc_set = (VkDescriptorSet)pcmd->TextureId;
-                        if (sizeof(ImTextureID) < sizeof(ImU64))
-                        {
-                            // We don't support texture switches if ImTextureID hasn't been redefined to be 64-bit.
-                            // Do a flaky check that other textures haven't been used.
-                            desc_set = m_descriptor_set;
-                        }
-                        if (desc_set == VK_NULL_HANDLE)
-                        {
-                            desc_set = m_descriptor_set;
-                        }
-                        vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline_layout, 0, 1, &desc_set, 0, nullptr);
+                        // the font atlas has no texture id
+                        const uint32_t texture_index = pcmd->TextureId == nullptr ? m_font_texture->m_bindless_index : from_texture_id(pcmd->TextureId);
+                        vkCmdPushConstants(command_buffer, m_pipeline_layout, k_push_constant_stages, offsetof(PushConstantBlock, texture_index), sizeof(uint32_t), &texture_index);
 
                         scissorRect.offset.x      = std::max((int32_t)(pcmd->ClipRect.x), 0);
                         scissorRect.offset.y      = std::max((int32_t)(pcmd->ClipRect.y), 0);
@@ -676,8 +633,6 @@ namespace ArchViz
         vkDestroyPipeline(m_device->m_device, m_pipeline, nullptr);
         vkDestroyPipelineLayout(m_device->m_device, m_pipeline_layout, nullptr);
 
-        vkDestroyDescriptorSetLayout(m_device->m_device, m_descriptor_set_layout, nullptr);
-
         // vkDestroyRenderPass(m_device->m_device, m_ui_pass, nullptr);
 
         m_index_buffer->destroy();
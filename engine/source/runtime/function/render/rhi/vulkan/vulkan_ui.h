@@ -12,11 +12,13 @@ namespace ArchViz
     class AssetManager;
     class ConfigManager;
 
+    class VulkanBindlessTable;
     class VulkanInstance;
     class VulkanDevice;
     class VulkanTexture;
     class VulkanShader;
     class VulkanBuffer;
+    class VulkanStagingUploader;
 
     class VulkanUI
     {
@@ -35,8 +37,6 @@ namespace ArchViz
 
     private:
         void createRenderPass();
-        void createDescriptorSetLayout();
-        void createDescriptorSets();
         void createPipelineLayout();
         void createPipeline();
 
@@ -45,6 +45,7 @@ namespace ArchViz
         {
             FVector2 scale;
             FVector2 translate;
+            uint32_t texture_index; // fragment stage, the bindless index of the texture of the draw
         };
 
     public:
@@ -60,6 +61,9 @@ namespace ArchViz
         std::shared_ptr<VulkanTexture>  m_font_texture;
         std::shared_ptr<VulkanShader>   m_shader;
 
+        std::shared_ptr<VulkanStagingUploader> m_uploader;
+        std::shared_ptr<VulkanBindlessTable>   m_bindless_table; // the font and every image shown come from it
+
         std::shared_ptr<VulkanBuffer> m_vertex_buffer;
         std::shared_ptr<VulkanBuffer> m_index_buffer;
 
@@ -68,10 +72,6 @@ namespace ArchViz
 
         VkPipelineCache m_pipeline_cache;
 
-        VkDescriptorPool      m_descriptor_pool;
-        VkDescriptorSetLayout m_descriptor_set_layout;
-        VkDescriptorSet       m_descriptor_set;
-
         VkPipelineLayout m_pipeline_layout;
         VkPipeline       m_pipeline;
 
@@ -0,0 +1,330 @@
+#include "runtime/function/render/streaming/texture_streaming.h"
+#include "runtime/function/render/render_camera.h"
+
+#include <cfloat>
+#include <cmath>
+
+namespace ArchViz
+{
+    StreamingView StreamingView::fromCamera(const RenderCamera& camera)
+    {
+        StreamingView view;
+
+        // m_view_projection is not refreshed by RenderCamera::update, build it here
+        view.frustum.update(camera.m_projction * camera.m_view);
+
+        // eye position from the inverse view, independent of how the camera composes its view matrix
+        const FMatrix3 rotation    = camera.m_view.topLeftCorner<3, 3>();
+        const FVector3 translation = camera.m_view.topRightCorner<3, 1>();
+        view.position              = -(rotation.inverse() * translation);
+
+        // perspective only, m_projction(1, 1) is 1 / tan(fov / 2)
+        view.pixels_per_unit = camera.m_height * 0.5f * camera.m_projction(1, 1);
+        return view;
+    }
+
+    TextureStreamingPlanner::TextureStreamingPlanner(const TextureStreamingConfig& config) : m_config {config} {}
+
+    uint32_t TextureStreamingPlanner::addTexture(const StreamingTextureDesc& desc)
+    {
+        TextureState state;
+        state.desc            = desc;
+        state.desc.mip_levels = std::max(desc.mip_levels, 1u);
+
+        uint32_t tail = 0;
+        while (tail + 1 < state.desc.mip_levels && std::max(desc.width >> tail, desc.height >> tail) > m_config.tail_size)
+        {
+            ++tail;
+        }
+
+        state.tail_mip     = tail;
+        state.resident_mip = tail;
+        state.pending_mip  = tail;
+        state.target_mip   = tail;
+        state.estimate_mip = static_cast<float>(tail);
+        state.wanted_mip   = static_cast<float>(tail);
+
+        m_committed_bytes += committedBytes(state);
+        m_textures.push_back(state);
+        return static_cast<uint32_t>(m_textures.size() - 1);
+    }
+
+    void TextureStreamingPlanner::clear()
+    {
+        m_textures.clear();
+        m_requests.clear();
+        m_evictions.clear();
+        m_statistics      = {};
+        m_committed_bytes = 0;
+        m_frame           = 0;
+    }
+
+    void TextureStreamingPlanner::update(const StreamingView& view, const std::vector<StreamingInstance>& instances)
+    {
+        ++m_frame;
+        m_requests.clear();
+        m_evictions.clear();
+        m_statistics = {};
+
+        m_committed_bytes = 0;
+        for (const auto& state : m_textures)
+        {
+            m_committed_bytes += committedBytes(state);
+        }
+
+        computeWanted(view, instances);
+        fitTargets();
+        issueRequests();
+        evict();
+
+        m_statistics.committed_bytes = m_committed_bytes;
+        for (const auto& state : m_textures)
+        {
+            m_statistics.target_bytes += chainBytes(state.desc, state.target_mip);
+            m_statistics.visible_texture_count += state.last_visible_frame == m_frame ? 1 : 0;
+            m_statistics.budget_limited_count += state.target_mip > static_cast<uint32_t>(state.wanted_mip) ? 1 : 0;
+            m_statistics.resident_at_target_count += state.resident_mip <= state.target_mip ? 1 : 0;
+        }
+    }
+
+    void TextureStreamingPlanner::computeWanted(const StreamingView& view, const std::vector<StreamingInstance>& instances)
+    {
+        for (auto& state : m_textures)
+        {
+            state.estimate_mip = FLT_MAX;
+        }
+
+        for (const auto& instance : instances)
+        {
+            if (instance.texture >= m_textures.size())
+            {
+                continue;
+            }
+            TextureState& state = m_textures[instance.texture];
+
+            // a camera inside the bounds can get arbitrarily close to the surface
+            float distance = (instance.center - view.position).norm() - instance.radius;
+            float mip      = 0.0f;
+            if (distance > 1e-3f)
+            {
+                float projected = 2.0f * instance.radius * view.pixels_per_unit / distance;
+                float texels    = static_cast<float>(std::max(state.desc.width, state.desc.height)) * instance.uv_scale;
+                mip             = projected > 0.0f ? std::log2(texels / projected) : FLT_MAX;
+            }
+            if (!view.frustum.checkSphere(instance.center, instance.radius))
+            {
+                mip += m_config.offscreen_mip_bias;
+            }
+
+            state.estimate_mip       = std::min(state.estimate_mip, std::max(mip, 0.0f));
+            state.last_visible_frame = m_frame;
+        }
+
+        for (auto& state : m_textures)
+        {
+            const float tail = static_cast<float>(state.tail_mip);
+            if (state.last_visible_frame != m_frame)
+            {
+                state.estimate_mip = tail;
+                state.wanted_mip   = tail;
+                continue;
+            }
+            state.estimate_mip = std::min(state.estimate_mip, tail);
+            state.wanted_mip   = std::clamp(state.estimate_mip + state.feedback_bias + m_config.lod_bias, 0.0f, tail);
+        }
+    }
+
+    void TextureStreamingPlanner::fitTargets()
+    {
+        uint64_t total = 0;
+        for (auto& state : m_textures)
+        {
+            state.target_mip = std::min(static_cast<uint32_t>(state.wanted_mip), state.tail_mip);
+            total += chainBytes(state.desc, state.target_mip);
+        }
+
+        if (total <= m_config.memory_budget)
+        {
+            return;
+        }
+
+        // drop one level at a time from the texture that ends up least blurry relative to what it wants
+        using Candidate = std::pair<float, uint32_t>;
+        std::vector<Candidate> heap;
+        for (uint32_t i = 0; i < m_textures.size(); ++i)
+        {
+            const TextureState& state = m_textures[i];
+            if (state.target_mip < state.tail_mip)
+            {
+                heap.emplace_back(static_cast<float>(state.target_mip + 1) - state.wanted_mip, i);
+            }
+        }
+
+        auto greater = [](const Candidate& lhs, const Candidate& rhs) { return lhs.first > rhs.first; };
+        std::make_heap(heap.begin(), heap.end(), greater);
+
+        while (total > m_config.memory_budget && !heap.empty())
+        {
+            std::pop_heap(heap.begin(), heap.end(), greater);
+            uint32_t      index = heap.back().second;
+            TextureState& state = m_textures[index];
+            heap.pop_back();
+
+            total -= levelBytes(state.desc, state.target_mip);
+            ++state.target_mip;
+
+            if (state.target_mip < state.tail_mip)
+            {
+                heap.emplace_back(static_cast<float>(state.target_mip + 1) - state.wanted_mip, index);
+                std::push_heap(heap.begin(), heap.end(), greater);
+            }
+        }
+    }
+
+    void TextureStreamingPlanner::issueRequests()
+    {
+        std::vector<TextureMipRequest> candidates;
+        for (uint32_t i = 0; i < m_textures.size(); ++i)
+        {
+            const TextureState& state = m_textures[i];
+            for (uint32_t mip = state.pending_mip; mip-- > state.target_mip;)
+            {
+                TextureMipRequest request;
+                request.texture  = i;
+                request.mip      = mip;
+                request.bytes    = levelBytes(state.desc, mip);
+                request.priority = static_cast<float>(mip + 1) - state.wanted_mip;
+                candidates.push_back(request);
+            }
+        }
+
+        // within a texture priority falls with every finer mip, so the coarse to fine order survives the sort
+        std::stable_sort(candidates.begin(), candidates.end(), [](const TextureMipRequest& lhs, const TextureMipRequest& rhs) { return lhs.priority > rhs.priority; });
+
+        uint64_t issued = 0;
+        for (const auto& request : candidates)
+        {
+            TextureState& state = m_textures[request.texture];
+            if (request.mip + 1 != state.pending_mip)
+            {
+                continue; // a coarser mip of this texture did not fit
+            }
+            // the first request always goes out, a single mip may be larger than the upload budget
+            if (issued + request.bytes > m_config.upload_budget && !m_requests.empty())
+            {
+                continue;
+            }
+
+            state.pending_mip = request.mip;
+            issued += request.bytes;
+            m_committed_bytes += request.bytes;
+            m_requests.push_back(request);
+        }
+        m_statistics.requested_bytes = issued;
+    }
+
+    void TextureStreamingPlanner::evict()
+    {
+        if (m_committed_bytes <= m_config.memory_budget)
+        {
+            return;
+        }
+
+        // surplus mips beyond the target, the largest surplus and the longest unseen go first
+        std::vector<uint32_t> candidates;
+        for (uint32_t i = 0; i < m_textures.size(); ++i)
+        {
+            const TextureState& state = m_textures[i];
+            if (std::min(state.resident_mip, state.pending_mip) < state.target_mip)
+            {
+                candidates.push_back(i);
+            }
+        }
+
+        std::sort(candidates.begin(), candidates.end(), [this](uint32_t lhs, uint32_t rhs) {
+            const TextureState& a         = m_textures[lhs];
+            const TextureState& b         = m_textures[rhs];
+            uint32_t            surplus_a = a.target_mip - std::min(a.resident_mip, a.pending_mip);
+            uint32_t            surplus_b = b.target_mip - std::min(b.resident_mip, b.pending_mip);
+            if (surplus_a != surplus_b)
+            {
+                return surplus_a > surplus_b;
+            }
+            return a.last_visible_frame < b.last_visible_frame;
+        });
+
+        for (uint32_t index : candidates)
+        {
+            if (m_committed_bytes <= m_config.memory_budget)
+            {
+                break;
+            }
+
+            TextureState& state  = m_textures[index];
+            uint64_t      before = committedBytes(state);
+
+            // only what is resident finer than the target goes, a coarser residency waits for its loads. In flight
+            // loads finer than the target are cancelled, onMipLoaded drops them, the ones up to the target still land
+            state.resident_mip = std::max(state.resident_mip, state.target_mip);
+            state.pending_mip  = std::max(state.pending_mip, state.target_mip);
+
+            uint64_t freed = before - committedBytes(state);
+            m_committed_bytes -= freed;
+            m_statistics.evicted_bytes += freed;
+
+            TextureMipEviction eviction;
+            eviction.texture      = index;
+            eviction.resident_mip = state.resident_mip;
+            eviction.bytes        = static_cast<size_t>(freed);
+            m_evictions.push_back(eviction);
+        }
+    }
+
+    void TextureStreamingPlanner::onMipLoaded(uint32_t texture, uint32_t mip)
+    {
+        if (texture >= m_textures.size())
+        {
+            return;
+        }
+
+        TextureState& state = m_textures[texture];
+        if (mip < state.pending_mip || mip >= state.resident_mip)
+        {
+            return; // cancelled by an eviction or already resident
+        }
+        state.resident_mip = mip;
+    }
+
+    void TextureStreamingPlanner::reportFeedback(uint32_t texture, float sampled_mip)
+    {
+        if (texture >= m_textures.size() || m_config.feedback_rate <= 0.0f)
+        {
+            return;
+        }
+
+        TextureState& state = m_textures[texture];
+        if (state.last_visible_frame != m_frame)
+        {
+            return; // no estimate to compare against this frame
+        }
+
+        float error         = sampled_mip - state.estimate_mip;
+        state.feedback_bias = state.feedback_bias + m_config.feedback_rate * (error - state.feedback_bias);
+        state.feedback_bias = std::clamp(state.feedback_bias, -m_config.max_feedback_bias, m_config.max_feedback_bias);
+    }
+
+    size_t TextureStreamingPlanner::levelBytes(const StreamingTextureDesc& desc, uint32_t mip)
+    {
+        return texture_level_size(desc.format, std::max(desc.width >> mip, 1u), std::max(desc.height >> mip, 1u));
+    }
+
+    size_t TextureStreamingPlanner::chainBytes(const StreamingTextureDesc& desc, uint32_t mip)
+    {
+        size_t total = 0;
+        for (uint32_t level = mip; level < desc.mip_levels; ++level)
+        {
+            total += levelBytes(desc, level);
+        }
+        return total;
+    }
+} // namespace ArchViz
@@ -0,0 +1,153 @@
+#pragma once
+#include "runtime/core/math/geometry/frustum.h"
+#include "runtime/core/math/math_type.h"
+
+#include "runtime/resource/res_type/data/material_data.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace ArchViz
+{
+    class RenderCamera;
+
+    struct TextureStreamingConfig
+    {
+        uint64_t memory_budget {512ull << 20}; // bytes of texture memory, mip tails included
+        uint64_t upload_budget {32ull << 20};  // bytes of mip requests issued per update
+        uint32_t tail_size {128};              // levels up to this size load up front and are never evicted
+        float    lod_bias {0.0f};              // added to every wanted mip
+        float    offscreen_mip_bias {2.0f};    // instances outside the frustum want this many mips less
+        float    feedback_rate {0.1f};         // smoothing of the gpu feedback, 0 disables the loop
+        float    max_feedback_bias {4.0f};
+    };
+
+    struct StreamingTextureDesc
+    {
+        uint32_t      width {0};
+        uint32_t      height {0};
+        uint32_t      mip_levels {1};
+        TextureFormat format {TextureFormat::RGBA8};
+    };
+
+    // a bounding sphere drawn with a texture, uv_scale is how often the texture repeats across the sphere
+    struct StreamingInstance
+    {
+        uint32_t texture {0};
+        FVector3 center {FVector3::Zero()};
+        float    radius {0.0f};
+        float    uv_scale {1.0f};
+    };
+
+    struct StreamingView
+    {
+        FVector3 position {FVector3::Zero()};
+        Frustum  frustum;
+        float    pixels_per_unit {1.0f}; // projected size in pixels of 1 unit at distance 1
+
+        static StreamingView fromCamera(const RenderCamera& camera);
+    };
+
+    // load mip of texture, requests of one texture are issued coarse to fine
+    struct TextureMipRequest
+    {
+        uint32_t texture {0};
+        uint32_t mip {0};
+        size_t   bytes {0};
+        float    priority {0.0f}; // mips of blur removed by the load
+    };
+
+    // drop every level finer than resident_mip
+    struct TextureMipEviction
+    {
+        uint32_t texture {0};
+        uint32_t resident_mip {0};
+        size_t   bytes {0};
+    };
+
+    struct TextureStreamingStatistics
+    {
+        uint64_t committed_bytes {0}; // resident and in flight
+        uint64_t target_bytes {0};
+        uint64_t requested_bytes {0};
+        uint64_t evicted_bytes {0};
+
+        uint32_t visible_texture_count {0};
+        uint32_t budget_limited_count {0}; // textures whose target is coarser than wanted to fit the budget
+        uint32_t resident_at_target_count {0};
+    };
+
+    // cpu side mip residency planning: every texture starts with its mip tail resident, finer mips are
+    // requested from the projected screen size of the instances using it, the memory budget lowers the
+    // targets of the least visible textures first and evicts surplus mips only when room is needed
+    // gpu feedback (the mip actually sampled) corrects the estimate per texture through a smoothed bias
+    class TextureStreamingPlanner
+    {
+    public:
+        TextureStreamingPlanner() = default;
+        explicit TextureStreamingPlanner(const TextureStreamingConfig& config);
+
+        uint32_t addTexture(const StreamingTextureDesc& desc);
+        void     clear();
+
+        void update(const StreamingView& view, const std::vector<StreamingInstance>& instances);
+
+        // the streamer finished mip of texture, loads must arrive coarse to fine
+        void onMipLoaded(uint32_t texture, uint32_t mip);
+        // finest mip the gpu wanted for texture this frame, unclamped by residency (e.g. from textureQueryLod)
+        void reportFeedback(uint32_t texture, float sampled_mip);
+
+        const std::vector<TextureMipRequest>&  requests() const { return m_requests; }
+        const std::vector<TextureMipEviction>& evictions() const { return m_evictions; }
+        const TextureStreamingStatistics&      statistics() const { return m_statistics; }
+
+        uint32_t textureCount() const { return static_cast<uint32_t>(m_textures.size()); }
+        uint32_t residentMip(uint32_t texture) const { return m_textures[texture].resident_mip; }
+        uint32_t targetMip(uint32_t texture) const { return m_textures[texture].target_mip; }
+        float    wantedMip(uint32_t texture) const { return m_textures[texture].wanted_mip; }
+        float    feedbackBias(uint32_t texture) const { return m_textures[texture].feedback_bias; }
+        uint32_t tailMip(uint32_t texture) const { return m_textures[texture].tail_mip; }
+
+        static size_t levelBytes(const StreamingTextureDesc& desc, uint32_t mip);
+        // bytes of mip and every coarser level
+        static size_t chainBytes(const StreamingTextureDesc& desc, uint32_t mip);
+
+    public:
+        TextureStreamingConfig m_config;
+
+    private:
+        struct TextureState
+        {
+            StreamingTextureDesc desc;
+
+            uint32_t tail_mip {0};
+            uint32_t resident_mip {0};
+            uint32_t pending_mip {0}; // finest mip requested, equal to resident_mip when nothing is in flight
+            uint32_t target_mip {0};
+
+            float estimate_mip {0.0f}; // from the bounds, before any bias
+            float wanted_mip {0.0f};
+            float feedback_bias {0.0f};
+
+            uint64_t last_visible_frame {0};
+        };
+
+        void computeWanted(const StreamingView& view, const std::vector<StreamingInstance>& instances);
+        void fitTargets();
+        void issueRequests();
+        void evict();
+
+        uint64_t committedBytes(const TextureState& state) const { return chainBytes(state.desc, std::min(state.resident_mip, state.pending_mip)); }
+
+    private:
+        std::vector<TextureState> m_textures;
+
+        std::vector<TextureMipRequest>  m_requests;
+        std::vector<TextureMipEviction> m_evictions;
+        TextureStreamingStatistics      m_statistics;
+
+        uint64_t m_committed_bytes {0};
+        uint64_t m_frame {0};
+    };
+} // namespace ArchViz
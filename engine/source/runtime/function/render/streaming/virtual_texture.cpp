@@ -0,0 +1,533 @@
+#include "runtime/function/render/streaming/virtual_texture.h"
+
+#include "runtime/core/base/macro.h"
+#include "runtime/core/thread/work_executor.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ArchViz
+{
+    namespace
+    {
+        uint32_t level_pages(uint32_t size, uint32_t mip, uint32_t page_size) { return (std::max(size >> mip, 1u) + page_size - 1) / page_size; }
+
+        int32_t border_texel(int32_t coord, int32_t size, bool wrap)
+        {
+            if (wrap)
+            {
+                return (coord % size + size) % size;
+            }
+            return std::clamp(coord, 0, size - 1);
+        }
+    } // namespace
+
+    VirtualTextureCache::VirtualTextureCache(uint32_t slot_count) : m_slots(slot_count)
+    {
+        m_free.reserve(slot_count);
+        for (uint32_t slot = slot_count; slot > 0; --slot)
+        {
+            m_free.push_back(slot - 1);
+        }
+    }
+
+    uint32_t VirtualTextureCache::acquire(uint64_t key, uint64_t frame, bool pinned, uint64_t& evicted_key)
+    {
+        evicted_key = k_no_key;
+
+        uint32_t slot;
+        if (!m_free.empty())
+        {
+            slot = m_free.back();
+            m_free.pop_back();
+        }
+        else
+        {
+            // the head is the least recently used, if it was used this frame so was everything else
+            if (m_head == k_no_slot || m_slots[m_head].last_used >= frame)
+            {
+                return k_no_slot;
+            }
+            slot        = m_head;
+            evicted_key = m_slots[slot].key;
+            unlink(slot);
+        }
+
+        m_slots[slot].key       = key;
+        m_slots[slot].last_used = frame;
+        m_slots[slot].pinned    = pinned;
+        if (!pinned)
+        {
+            link(slot);
+        }
+        return slot;
+    }
+
+    void VirtualTextureCache::release(uint32_t slot)
+    {
+        if (!m_slots[slot].pinned)
+        {
+            unlink(slot);
+        }
+        m_slots[slot] = {};
+        m_free.push_back(slot);
+    }
+
+    void VirtualTextureCache::touch(uint32_t slot, uint64_t frame)
+    {
+        m_slots[slot].last_used = frame;
+        if (!m_slots[slot].pinned)
+        {
+            unlink(slot);
+            link(slot);
+        }
+    }
+
+    void VirtualTextureCache::setPinned(uint32_t slot, bool pinned)
+    {
+        if (m_slots[slot].pinned == pinned)
+        {
+            return;
+        }
+        m_slots[slot].pinned = pinned;
+        if (pinned)
+        {
+            unlink(slot);
+        }
+        else
+        {
+            link(slot);
+        }
+    }
+
+    void VirtualTextureCache::link(uint32_t slot)
+    {
+        m_slots[slot].prev = m_tail;
+        m_slots[slot].next = k_no_slot;
+        if (m_tail != k_no_slot)
+        {
+            m_slots[m_tail].next = slot;
+        }
+        else
+        {
+            m_head = slot;
+        }
+        m_tail = slot;
+    }
+
+    void VirtualTextureCache::unlink(uint32_t slot)
+    {
+        Slot& entry = m_slots[slot];
+        if (entry.prev != k_no_slot)
+        {
+            m_slots[entry.prev].next = entry.next;
+        }
+        else
+        {
+            m_head = entry.next;
+        }
+        if (entry.next != k_no_slot)
+        {
+            m_slots[entry.next].prev = entry.prev;
+        }
+        else
+        {
+            m_tail = entry.prev;
+        }
+        entry.prev = k_no_slot;
+        entry.next = k_no_slot;
+    }
+
+    VirtualTexturePageTable::VirtualTexturePageTable(const VirtualTextureConfig& config) : m_config {config}, m_cache {config.physical_pages_x * config.physical_pages_y} {}
+
+    uint32_t VirtualTexturePageTable::tailMip(const VirtualTextureDesc& desc, const VirtualTextureConfig& config)
+    {
+        uint32_t mip = 0;
+        while (mip + 1 < std::max(desc.mip_levels, 1u) && (level_pages(desc.width, mip, config.page_size) > 1 || level_pages(desc.height, mip, config.page_size) > 1))
+        {
+            ++mip;
+        }
+        return mip;
+    }
+
+    uint32_t VirtualTexturePageTable::pageIndex(const VirtualTextureDesc& desc, const VirtualTextureConfig& config, const VirtualPage& page)
+    {
+        uint32_t index = 0;
+        for (uint32_t mip = 0; mip < page.mip; ++mip)
+        {
+            index += level_pages(desc.width, mip, config.page_size) * level_pages(desc.height, mip, config.page_size);
+        }
+        return index + page.y * level_pages(desc.width, page.mip, config.page_size) + page.x;
+    }
+
+    uint32_t VirtualTexturePageTable::pageCount(const VirtualTextureDesc& desc, const VirtualTextureConfig& config)
+    {
+        const uint32_t tail = tailMip(desc, config);
+        return pageIndex(desc, config, {0, tail, 0, 0}) + 1;
+    }
+
+    VirtualPage VirtualTexturePageTable::pageFromKey(uint64_t key)
+    {
+        VirtualPage page;
+        page.texture = static_cast<uint32_t>(key >> 40);
+        page.mip     = static_cast<uint32_t>(key >> 32 & 0xff);
+        page.x       = static_cast<uint32_t>(key >> 16 & 0xffff);
+        page.y       = static_cast<uint32_t>(key & 0xffff);
+        return page;
+    }
+
+    uint32_t VirtualTexturePageTable::addTexture(const VirtualTextureDesc& desc)
+    {
+        TextureState state;
+        state.desc            = desc;
+        state.desc.mip_levels = std::max(desc.mip_levels, 1u);
+        state.tail_mip        = tailMip(state.desc, m_config);
+
+        uint32_t count = 0;
+        for (uint32_t mip = 0; mip <= state.tail_mip; ++mip)
+        {
+            state.pages_x.push_back(level_pages(desc.width, mip, m_config.page_size));
+            state.pages_y.push_back(level_pages(desc.height, mip, m_config.page_size));
+            state.level_offsets.push_back(count);
+            count += state.pages_x.back() * state.pages_y.back();
+        }
+        state.slots.assign(count, VirtualTextureCache::k_no_slot);
+        state.loaded.assign(count, 0);
+        state.entries.assign(count, 0);
+        state.visited.assign(count, 0);
+        state.wanted.assign(count, 0);
+
+        if (count > 0 && state.pages_x.back() * state.pages_y.back() > 1)
+        {
+            LOG_WARN("virtual texture {}x{} with {} mips has no level that fits one page, its tail is not pinned", desc.width, desc.height, state.desc.mip_levels);
+        }
+
+        m_textures.push_back(std::move(state));
+
+        // the tail backs every fallback, it is requested first on the next update
+        uint32_t texture = static_cast<uint32_t>(m_textures.size() - 1);
+        m_unmapped_tails.push_back(texture);
+        return texture;
+    }
+
+    void VirtualTexturePageTable::clear()
+    {
+        m_textures.clear();
+        m_cache = VirtualTextureCache(m_config.physical_pages_x * m_config.physical_pages_y);
+        m_unmapped_tails.clear();
+        m_wanted.clear();
+        m_requests.clear();
+        m_evictions.clear();
+        m_dirty_tables.clear();
+        m_statistics    = {};
+        m_pending_pages = 0;
+        m_frame         = 0;
+    }
+
+    bool VirtualTexturePageTable::validPage(const VirtualPage& page) const
+    {
+        if (page.texture >= m_textures.size())
+        {
+            return false;
+        }
+        const TextureState& state = m_textures[page.texture];
+        return page.mip <= state.tail_mip && page.x < state.pages_x[page.mip] && page.y < state.pages_y[page.mip];
+    }
+
+    uint32_t VirtualTexturePageTable::tableIndex(const VirtualPage& page) const
+    {
+        const TextureState& state = m_textures[page.texture];
+        return state.level_offsets[page.mip] + page.y * state.pages_x[page.mip] + page.x;
+    }
+
+    uint32_t VirtualTexturePageTable::entry(const VirtualPage& page) const { return validPage(page) ? m_textures[page.texture].entries[tableIndex(page)] : 0; }
+
+    bool VirtualTexturePageTable::resident(const VirtualPage& page) const { return validPage(page) && m_textures[page.texture].loaded[tableIndex(page)] != 0; }
+
+    void VirtualTexturePageTable::update(const std::vector<VirtualPage>& feedback)
+    {
+        ++m_frame;
+        m_requests.clear();
+        m_evictions.clear();
+        m_dirty_tables.clear();
+        m_statistics = {};
+
+        for (size_t i = 0; i < m_unmapped_tails.size();)
+        {
+            const uint32_t texture = m_unmapped_tails[i];
+            if (!requestPage({texture, m_textures[texture].tail_mip, 0, 0}))
+            {
+                ++i;
+                continue;
+            }
+            m_unmapped_tails[i] = m_unmapped_tails.back();
+            m_unmapped_tails.pop_back();
+        }
+
+        // walk up from every sampled page: touch the resident page that serves it, want every missing one on the way
+        const uint32_t frame = static_cast<uint32_t>(m_frame);
+        m_wanted.clear();
+        for (VirtualPage page : feedback)
+        {
+            if (page.texture >= m_textures.size())
+            {
+                continue;
+            }
+            TextureState& state = m_textures[page.texture];
+            if (page.mip > state.tail_mip)
+            {
+                page = {page.texture, state.tail_mip, 0, 0};
+            }
+            if (!validPage(page))
+            {
+                continue;
+            }
+
+            m_statistics.feedback_pages += 1;
+            if (state.loaded[tableIndex(page)] == 0)
+            {
+                m_statistics.missing_pages += 1;
+            }
+
+            while (true)
+            {
+                const uint32_t index = tableIndex(page);
+                const uint32_t slot  = state.slots[index];
+                if (state.visited[index] == frame)
+                {
+                    // the rest of the way up was walked already
+                    if (slot == VirtualTextureCache::k_no_slot)
+                    {
+                        m_wanted[state.wanted[index]].hits += 1;
+                    }
+                    break;
+                }
+                state.visited[index] = frame;
+
+                if (slot != VirtualTextureCache::k_no_slot)
+                {
+                    if (state.loaded[index] != 0)
+                    {
+                        m_cache.touch(slot, m_frame);
+                    }
+                    // a load in flight already has its ancestors resident or requested
+                    break;
+                }
+
+                state.wanted[index] = static_cast<uint32_t>(m_wanted.size());
+                m_wanted.push_back({page, 1});
+                if (page.mip == state.tail_mip)
+                {
+                    break;
+                }
+                page = {page.texture, page.mip + 1, page.x / 2, page.y / 2};
+            }
+        }
+
+        // coarse first so the fallback improves a mip at a time, then the most sampled
+        const size_t issued = std::min<size_t>(m_wanted.size(), m_config.max_requests);
+        std::partial_sort(m_wanted.begin(), m_wanted.begin() + issued, m_wanted.end(), [](const WantedPage& lhs, const WantedPage& rhs) {
+            if (lhs.page.mip != rhs.page.mip)
+            {
+                return lhs.page.mip > rhs.page.mip;
+            }
+            if (lhs.hits != rhs.hits)
+            {
+                return lhs.hits > rhs.hits;
+            }
+            return lhs.page.key() < rhs.page.key();
+        });
+
+        for (size_t i = 0; i < issued; ++i)
+        {
+            if (!requestPage(m_wanted[i].page))
+            {
+                m_statistics.dropped_requests = static_cast<uint32_t>(m_wanted.size() - i);
+                break;
+            }
+        }
+
+        for (uint32_t texture = 0; texture < m_textures.size(); ++texture)
+        {
+            if (m_textures[texture].dirty)
+            {
+                m_textures[texture].dirty = false;
+                m_dirty_tables.push_back(texture);
+            }
+        }
+
+        m_statistics.pending_pages  = m_pending_pages;
+        m_statistics.resident_pages = m_cache.usedCount() - m_pending_pages;
+    }
+
+    bool VirtualTexturePageTable::requestPage(const VirtualPage& page)
+    {
+        // every load is pinned until it lands, a slot must not be handed out twice
+        uint64_t       evicted_key;
+        const uint32_t slot = m_cache.acquire(page.key(), m_frame, true, evicted_key);
+        if (slot == VirtualTextureCache::k_no_slot)
+        {
+            return false;
+        }
+        if (evicted_key != VirtualTextureCache::k_no_key)
+        {
+            unmapPage(evicted_key);
+            m_evictions.push_back({pageFromKey(evicted_key), slot});
+            m_statistics.evicted_pages += 1;
+        }
+
+        TextureState&  state = m_textures[page.texture];
+        const uint32_t index = tableIndex(page);
+        state.slots[index]   = slot;
+        state.loaded[index]  = 0;
+
+        m_requests.push_back({page, slot});
+        m_statistics.requested_pages += 1;
+        m_pending_pages += 1;
+        return true;
+    }
+
+    void VirtualTexturePageTable::unmapPage(uint64_t key)
+    {
+        const VirtualPage page  = pageFromKey(key);
+        TextureState&     state = m_textures[page.texture];
+        const uint32_t    index = tableIndex(page);
+        state.slots[index]      = VirtualTextureCache::k_no_slot;
+        state.loaded[index]     = 0;
+        updateEntries(state, page);
+    }
+
+    void VirtualTexturePageTable::onPageLoaded(const VirtualPage& page)
+    {
+        if (!validPage(page))
+        {
+            LOG_ERROR("virtual page {} {} {} of texture {} does not exist", page.mip, page.x, page.y, page.texture);
+            return;
+        }
+
+        TextureState&  state = m_textures[page.texture];
+        const uint32_t index = tableIndex(page);
+        const uint32_t slot  = state.slots[index];
+        if (slot == VirtualTextureCache::k_no_slot || state.loaded[index] != 0)
+        {
+            LOG_WARN("virtual page {} {} {} of texture {} was not requested", page.mip, page.x, page.y, page.texture);
+            return;
+        }
+
+        state.loaded[index] = 1;
+        m_pending_pages -= 1;
+        updateEntries(state, page);
+
+        // a tail of one page covers the whole texture and stays pinned for its lifetime. When the chain stops above that
+        // level its tail has several pages, pinning them all would take more slots than the one fallback page
+        m_cache.setPinned(slot, page.mip == state.tail_mip && state.pages_x[page.mip] == 1 && state.pages_y[page.mip] == 1);
+        m_cache.touch(slot, m_frame);
+    }
+
+    void VirtualTexturePageTable::updateEntries(TextureState& state, const VirtualPage& page)
+    {
+        // the page and everything below it, coarse to fine, a page without data inherits the entry of its parent
+        for (uint32_t mip = page.mip + 1; mip-- > 0;)
+        {
+            const uint32_t shift   = page.mip - mip;
+            const uint32_t pages_x = state.pages_x[mip];
+            const uint32_t x_end   = std::min((page.x + 1) << shift, pages_x);
+            const uint32_t y_end   = std::min((page.y + 1) << shift, state.pages_y[mip]);
+            for (uint32_t y = page.y << shift; y < y_end; ++y)
+            {
+                for (uint32_t x = page.x << shift; x < x_end; ++x)
+                {
+                    const uint32_t index = state.level_offsets[mip] + y * pages_x + x;
+                    const uint32_t slot  = state.slots[index];
+                    if (slot != VirtualTextureCache::k_no_slot && state.loaded[index] != 0)
+                    {
+                        state.entries[index] = virtual_page_entry(slot % m_config.physical_pages_x, slot / m_config.physical_pages_x, mip);
+                    }
+                    else if (mip == state.tail_mip)
+                    {
+                        state.entries[index] = 0;
+                    }
+                    else
+                    {
+                        state.entries[index] = state.entries[state.level_offsets[mip + 1] + (y / 2) * state.pages_x[mip + 1] + x / 2];
+                    }
+                }
+            }
+        }
+        state.dirty = true;
+    }
+
+    std::vector<uint8_t> VirtualTexturePageTable::buildPages(const TextureData& texture, const VirtualTextureConfig& config, bool wrap, std::shared_ptr<WorkExecutor> executor)
+    {
+        if (texture.m_format != TextureFormat::RGBA8 || texture.m_width <= 0 || texture.m_height <= 0)
+        {
+            LOG_ERROR("virtual texture {} must be rgba8", texture.m_uri);
+            return {};
+        }
+
+        VirtualTextureDesc desc;
+        desc.width      = static_cast<uint32_t>(texture.m_width);
+        desc.height     = static_cast<uint32_t>(texture.m_height);
+        desc.mip_levels = texture.mipLevels();
+
+        const uint32_t tail = tailMip(desc, config);
+
+        std::vector<VirtualPage> pages;
+        for (uint32_t mip = 0; mip <= tail; ++mip)
+        {
+            for (uint32_t y = 0; y < level_pages(desc.height, mip, config.page_size); ++y)
+            {
+                for (uint32_t x = 0; x < level_pages(desc.width, mip, config.page_size); ++x)
+                {
+                    pages.push_back({0, mip, x, y});
+                }
+            }
+        }
+
+        const uint32_t physical   = config.physicalPageSize();
+        const size_t   page_bytes = static_cast<size_t>(physical) * physical * 4;
+        const int32_t  border     = static_cast<int32_t>(config.page_border);
+
+        std::vector<uint8_t> data(pages.size() * page_bytes);
+        parallel_for(executor, static_cast<uint32_t>(pages.size()), 16, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                const VirtualPage& page   = pages[i];
+                const uint8_t*     src    = texture.m_data.data();
+                int32_t            width  = texture.m_width;
+                int32_t            height = texture.m_height;
+                if (!texture.m_levels.empty())
+                {
+                    src += texture.m_levels[page.mip].offset;
+                    width  = static_cast<int32_t>(texture.m_levels[page.mip].width);
+                    height = static_cast<int32_t>(texture.m_levels[page.mip].height);
+                }
+
+                const int32_t origin_x = static_cast<int32_t>(page.x * config.page_size) - border;
+                const int32_t origin_y = static_cast<int32_t>(page.y * config.page_size) - border;
+                const bool    inside_x = origin_x >= 0 && origin_x + static_cast<int32_t>(physical) <= width;
+
+                uint8_t* dst = data.data() + i * page_bytes;
+                for (uint32_t y = 0; y < physical; ++y)
+                {
+                    const int32_t  sy  = border_texel(origin_y + static_cast<int32_t>(y), height, wrap);
+                    const uint8_t* row = src + static_cast<size_t>(sy) * width * 4;
+                    if (inside_x)
+                    {
+                        std::memcpy(dst, row + static_cast<size_t>(origin_x) * 4, static_cast<size_t>(physical) * 4);
+                    }
+                    else
+                    {
+                        for (uint32_t x = 0; x < physical; ++x)
+                        {
+                            const int32_t sx = border_texel(origin_x + static_cast<int32_t>(x), width, wrap);
+                            std::memcpy(dst + x * 4, row + static_cast<size_t>(sx) * 4, 4);
+                        }
+                    }
+                    dst += static_cast<size_t>(physical) * 4;
+                }
+            }
+        });
+        return data;
+    }
+} // namespace ArchViz
@@ -0,0 +1,218 @@
+#pragma once
+#include "runtime/resource/res_type/data/material_data.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ArchViz
+{
+    class WorkExecutor;
+
+    struct VirtualTextureConfig
+    {
+        uint32_t page_size {128};       // payload texels per page side
+        uint32_t page_border {4};       // texels of the neighbouring pages around the payload, for filtering
+        uint32_t physical_pages_x {32}; // the physical cache texture holds physical_pages_x * physical_pages_y pages
+        uint32_t physical_pages_y {32};
+        uint32_t max_requests {64};     // page loads issued per update
+
+        uint32_t physicalPageSize() const { return page_size + 2 * page_border; }
+    };
+
+    struct VirtualTextureDesc
+    {
+        uint32_t width {0};
+        uint32_t height {0};
+        uint32_t mip_levels {1};
+    };
+
+    struct VirtualPage
+    {
+        uint32_t texture {0};
+        uint32_t mip {0};
+        uint32_t x {0}; // in pages of the mip
+        uint32_t y {0};
+
+        uint64_t key() const { return static_cast<uint64_t>(texture) << 40 | static_cast<uint64_t>(mip) << 32 | static_cast<uint64_t>(x) << 16 | y; }
+    };
+
+    // page table entry as the shader reads it: physical page, the mip it holds and a valid bit
+    // a page that is not resident points at its closest resident ancestor, so sampling falls back to a coarser mip
+    inline uint32_t virtual_page_entry(uint32_t physical_x, uint32_t physical_y, uint32_t mip) { return physical_x | physical_y << 12 | mip << 24 | 1u << 31; }
+    inline bool     virtual_page_entry_valid(uint32_t entry) { return (entry >> 31) != 0; }
+    inline uint32_t virtual_page_entry_x(uint32_t entry) { return entry & 0xfff; }
+    inline uint32_t virtual_page_entry_y(uint32_t entry) { return entry >> 12 & 0xfff; }
+    inline uint32_t virtual_page_entry_mip(uint32_t entry) { return entry >> 24 & 0x1f; }
+
+    // load page into the physical slot, then report it with onPageLoaded
+    struct VirtualPageRequest
+    {
+        VirtualPage page;
+        uint32_t    slot {0};
+    };
+
+    // page lost its slot, the slot now belongs to a request of the same update
+    struct VirtualPageEviction
+    {
+        VirtualPage page;
+        uint32_t    slot {0};
+    };
+
+    struct VirtualTextureStatistics
+    {
+        uint32_t resident_pages {0};
+        uint32_t pending_pages {0};
+        uint32_t requested_pages {0};
+        uint32_t evicted_pages {0};
+        uint32_t feedback_pages {0};
+        uint32_t missing_pages {0};    // feedback pages sampled from a coarser fallback
+        uint32_t dropped_requests {0}; // no free slot, every page in the cache was used this frame
+    };
+
+    // fixed pool of physical pages with least recently used replacement
+    // pinned slots (mip tails, loads in flight) are never evicted
+    class VirtualTextureCache
+    {
+    public:
+        static constexpr uint32_t k_no_slot = UINT32_MAX;
+        static constexpr uint64_t k_no_key  = UINT64_MAX;
+
+        VirtualTextureCache() = default;
+        explicit VirtualTextureCache(uint32_t slot_count);
+
+        // a free slot, else the least recently used unpinned one not used in frame, k_no_slot when there is none
+        uint32_t acquire(uint64_t key, uint64_t frame, bool pinned, uint64_t& evicted_key);
+        void     release(uint32_t slot);
+
+        void touch(uint32_t slot, uint64_t frame);
+        void setPinned(uint32_t slot, bool pinned);
+
+        uint64_t key(uint32_t slot) const { return m_slots[slot].key; }
+        uint64_t lastUsed(uint32_t slot) const { return m_slots[slot].last_used; }
+        bool     pinned(uint32_t slot) const { return m_slots[slot].pinned; }
+
+        uint32_t slotCount() const { return static_cast<uint32_t>(m_slots.size()); }
+        uint32_t usedCount() const { return slotCount() - static_cast<uint32_t>(m_free.size()); }
+
+    private:
+        struct Slot
+        {
+            uint64_t key {k_no_key};
+            uint64_t last_used {0};
+            uint32_t prev {k_no_slot};
+            uint32_t next {k_no_slot};
+            bool     pinned {false};
+        };
+
+        void link(uint32_t slot);
+        void unlink(uint32_t slot);
+
+    private:
+        std::vector<Slot>     m_slots;
+        std::vector<uint32_t> m_free;
+
+        // unpinned used slots, least recently used first
+        uint32_t m_head {k_no_slot};
+        uint32_t m_tail {k_no_slot};
+    };
+
+    // virtual texturing on the cpu side: big textures are split into page_size pages per mip, a page table per
+    // texture maps every page to a slot of the physical cache, feedback (pages the gpu wanted) drives the loads
+    // the mip tail (first mip that fits in one page) is pinned, coarser mips are not paged and lod is clamped to it. A chain
+    // that stops before such a mip keeps its last level as the tail, but those pages are evicted like any other
+    // shader side: entry = table[mip][uv * pages], physical uv = (entry.xy * physical page + border + fract(uv * pages of entry.mip) * page_size) / cache size
+    class VirtualTexturePageTable
+    {
+    public:
+        VirtualTexturePageTable() = default;
+        explicit VirtualTexturePageTable(const VirtualTextureConfig& config);
+
+        uint32_t addTexture(const VirtualTextureDesc& desc);
+        void     clear();
+
+        // feedback: pages sampled this frame at the mip the gpu wanted, resident or not
+        void update(const std::vector<VirtualPage>& feedback);
+        void onPageLoaded(const VirtualPage& page);
+
+        const std::vector<VirtualPageRequest>&  requests() const { return m_requests; }
+        const std::vector<VirtualPageEviction>& evictions() const { return m_evictions; }
+        const VirtualTextureStatistics&         statistics() const { return m_statistics; }
+        const VirtualTextureCache&              cache() const { return m_cache; }
+
+        // textures whose table changed in the last update and need an upload
+        const std::vector<uint32_t>& dirtyTables() const { return m_dirty_tables; }
+
+        uint32_t textureCount() const { return static_cast<uint32_t>(m_textures.size()); }
+        uint32_t tailMip(uint32_t texture) const { return m_textures[texture].tail_mip; }
+        uint32_t pagesX(uint32_t texture, uint32_t mip) const { return m_textures[texture].pages_x[mip]; }
+        uint32_t pagesY(uint32_t texture, uint32_t mip) const { return m_textures[texture].pages_y[mip]; }
+
+        // every mip of the table, mip 0 first, row major, tail mip last
+        const std::vector<uint32_t>& tableEntries(uint32_t texture) const { return m_textures[texture].entries; }
+        uint32_t                     entry(const VirtualPage& page) const;
+        bool                         resident(const VirtualPage& page) const;
+
+        // index of page in the order of buildPages: mip 0 first, row major
+        static uint32_t pageIndex(const VirtualTextureDesc& desc, const VirtualTextureConfig& config, const VirtualPage& page);
+        static uint32_t pageCount(const VirtualTextureDesc& desc, const VirtualTextureConfig& config);
+
+        // splits the rgba8 chain of texture (up to the tail mip) into bordered pages of physicalPageSize squared,
+        // borders copy the neighbouring texels, clamped or wrapped at the texture edges
+        static std::vector<uint8_t> buildPages(const TextureData& texture, const VirtualTextureConfig& config, bool wrap, std::shared_ptr<WorkExecutor> executor);
+
+    public:
+        VirtualTextureConfig m_config;
+
+    private:
+        struct TextureState
+        {
+            VirtualTextureDesc desc;
+
+            uint32_t tail_mip {0};
+
+            std::vector<uint32_t> pages_x;
+            std::vector<uint32_t> pages_y;
+            std::vector<uint32_t> level_offsets; // first page of every mip
+
+            std::vector<uint32_t> slots;   // physical slot per page, k_no_slot when not resident
+            std::vector<uint8_t>  loaded;  // the slot holds the data, otherwise the load is in flight
+            std::vector<uint32_t> entries; // page table
+            std::vector<uint32_t> visited; // last frame a feedback walk passed the page
+            std::vector<uint32_t> wanted;  // index into m_wanted, valid in the visited frame
+
+            bool dirty {false};
+        };
+
+        struct WantedPage
+        {
+            VirtualPage page;
+            uint32_t    hits {0};
+        };
+
+        uint32_t tableIndex(const VirtualPage& page) const;
+        bool     validPage(const VirtualPage& page) const;
+
+        bool requestPage(const VirtualPage& page);
+        void unmapPage(uint64_t key);
+        void updateEntries(TextureState& state, const VirtualPage& page);
+
+        static uint32_t   tailMip(const VirtualTextureDesc& desc, const VirtualTextureConfig& config);
+        static VirtualPage pageFromKey(uint64_t key);
+
+    private:
+        std::vector<TextureState> m_textures;
+        VirtualTextureCache       m_cache;
+
+        std::vector<uint32_t>   m_unmapped_tails; // textures whose tail page found no slot yet
+        std::vector<WantedPage> m_wanted;
+
+        std::vector<VirtualPageRequest>  m_requests;
+        std::vector<VirtualPageEviction> m_evictions;
+        std::vector<uint32_t>            m_dirty_tables;
+        VirtualTextureStatistics         m_statistics;
+
+        uint32_t m_pending_pages {0};
+        uint64_t m_frame {0};
+    };
+} // namespace ArchViz
@@ -0,0 +1,166 @@
+#include "runtime/platform/file_system/basic/mapped_file.h"
+
+#include "runtime/core/base/macro.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ArchViz
+{
+    MappedFile::~MappedFile() { close(); }
+
+    void MappedFile::assign(std::vector<std::byte>&& buffer)
+    {
+        close();
+
+        m_buffer = std::move(buffer);
+        m_data   = reinterpret_cast<const char*>(m_buffer.data());
+        m_size   = m_buffer.size();
+        m_opened = true;
+    }
+
+#if defined(_WIN32)
+    bool MappedFile::open(const std::string& path)
+    {
+        close();
+
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            LOG_ERROR("failed to open file: {}", path);
+            return false;
+        }
+
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file, &file_size))
+        {
+            LOG_ERROR("failed to get file size: {}", path);
+            CloseHandle(file);
+            return false;
+        }
+
+        m_file   = file;
+        m_size   = static_cast<size_t>(file_size.QuadPart);
+        m_opened = true;
+
+        // empty file can not be mapped
+        if (m_size == 0)
+        {
+            return true;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr)
+        {
+            LOG_ERROR("failed to map file: {}", path);
+            close();
+            return false;
+        }
+        m_mapping = mapping;
+
+        m_data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (m_data == nullptr)
+        {
+            LOG_ERROR("failed to map view of file: {}", path);
+            close();
+            return false;
+        }
+
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if (m_data && m_buffer.empty())
+        {
+            UnmapViewOfFile(m_data);
+        }
+        if (m_mapping)
+        {
+            CloseHandle(static_cast<HANDLE>(m_mapping));
+        }
+        if (m_file)
+        {
+            CloseHandle(static_cast<HANDLE>(m_file));
+        }
+
+        m_data    = nullptr;
+        m_mapping = nullptr;
+        m_file    = nullptr;
+        m_size    = 0;
+        m_opened  = false;
+
+        std::vector<std::byte>().swap(m_buffer);
+    }
+#else
+    bool MappedFile::open(const std::string& path)
+    {
+        close();
+
+        int file = ::open(path.c_str(), O_RDONLY);
+        if (file < 0)
+        {
+            LOG_ERROR("failed to open file: {}", path);
+            return false;
+        }
+
+        struct stat file_stat;
+        if (fstat(file, &file_stat) != 0)
+        {
+            LOG_ERROR("failed to get file size: {}", path);
+            ::close(file);
+            return false;
+        }
+
+        m_file   = file;
+        m_size   = static_cast<size_t>(file_stat.st_size);
+        m_opened = true;
+
+        // empty file can not be mapped
+        if (m_size == 0)
+        {
+            return true;
+        }
+
+        void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file, 0);
+        if (data == MAP_FAILED)
+        {
+            LOG_ERROR("failed to map file: {}", path);
+            close();
+            return false;
+        }
+        madvise(data, m_size, MADV_SEQUENTIAL);
+
+        m_data = static_cast<const char*>(data);
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if (m_data && m_buffer.empty())
+        {
+            munmap(const_cast<char*>(m_data), m_size);
+        }
+        if (m_file >= 0)
+        {
+            ::close(m_file);
+        }
+
+        m_data   = nullptr;
+        m_file   = -1;
+        m_size   = 0;
+        m_opened = false;
+
+        std::vector<std::byte>().swap(m_buffer);
+    }
+#endif
+} // namespace ArchViz
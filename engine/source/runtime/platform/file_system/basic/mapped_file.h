@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ArchViz
+{
+    // read-only memory mapped view of a whole native file
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(const MappedFile&)            = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool open(const std::string& path);
+        void close();
+
+        // take over an already read buffer, for files which can not be mapped (zip, memory)
+        void assign(std::vector<std::byte>&& buffer);
+
+        bool isOpened() const { return m_opened; }
+
+        const char* data() const { return m_data; }
+        size_t      size() const { return m_size; }
+
+    private:
+        const char* m_data {nullptr};
+        size_t      m_size {0};
+        bool        m_opened {false};
+
+        std::vector<std::byte> m_buffer;
+
+#if defined(_WIN32)
+        void* m_file {nullptr};
+        void* m_mapping {nullptr};
+#else
+        int m_file {-1};
+#endif
+    };
+} // namespace ArchViz
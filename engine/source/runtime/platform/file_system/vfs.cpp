@@ -92,6 +92,39 @@ namespace ArchViz
 
     bool VFS::close(FilePtr file) { return file->close(); }
 
+    std::shared_ptr<MappedFile> VFS::map(const std::string& vpath)
+    {
+        auto fs = m_file_cache.find(vpath);
+        if (fs == m_file_cache.end())
+        {
+            return nullptr;
+        }
+
+        FilePtr file = fs->second->open(vpath, File::read_bin);
+        if (file == nullptr)
+        {
+            return nullptr;
+        }
+
+        std::shared_ptr<MappedFile> mapped = std::make_shared<MappedFile>();
+        if (fs->second->m_config.m_type == "native")
+        {
+            file->close();
+            if (!mapped->open(file->m_rpath))
+            {
+                return nullptr;
+            }
+        }
+        else
+        {
+            std::vector<std::byte> buffer;
+            file->read(buffer);
+            file->close();
+            mapped->assign(std::move(buffer));
+        }
+        return mapped;
+    }
+
     size_t VFS::read(FilePtr file, std::vector<std::byte>& buffer) { return file->read(buffer); }
 
     size_t VFS::write(FilePtr file, const std::vector<std::byte>& buffer) { return file->write(buffer); }
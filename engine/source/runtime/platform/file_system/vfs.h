@@ -1,6 +1,7 @@
 #pragma once
 #include "runtime/platform/file_system/basic/file.h"
 #include "runtime/platform/file_system/basic/file_system.h"
+#include "runtime/platform/file_system/basic/mapped_file.h"
 #include "runtime/platform/file_system/vfs_config.h"
 
 #include <unordered_map>
@@ -16,6 +17,9 @@ namespace ArchViz
         FilePtr open(const std::string& vpath, uint32_t mode);
         bool    close(FilePtr file);
 
+        // read only view of a whole file, native files are mapped without copy
+        std::shared_ptr<MappedFile> map(const std::string& vpath);
+
         size_t read(FilePtr file, std::vector<std::byte>& buffer);
         size_t write(FilePtr file, const std::vector<std::byte>& buffer);
 
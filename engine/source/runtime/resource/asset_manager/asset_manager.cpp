@@ -112,4 +112,14 @@ namespace ArchViz
             file->close();
         }
     }
+
+    std::shared_ptr<MappedFile> AssetManager::mapVFSFile(const std::filesystem::path& file_path) const
+    {
+        auto file = m_vfs->map(file_path.generic_string());
+        if (file == nullptr)
+        {
+            LOG_ERROR("map file: {} failed!", file_path.generic_string());
+        }
+        return file;
+    }
 } // namespace ArchViz
\ No newline at end of file
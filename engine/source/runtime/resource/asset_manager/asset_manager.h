@@ -16,6 +16,7 @@
 namespace ArchViz
 {
     class ConfigManager;
+    class MappedFile;
     class VFS;
 
     class AssetManager
@@ -104,6 +105,8 @@ namespace ArchViz
         void writeVFSTextFile(const std::filesystem::path& file_path, const std::string& content) const;
         void writeVFSBinaryFile(const std::filesystem::path& file_path, const std::vector<std::byte>& content) const;
 
+        std::shared_ptr<MappedFile> mapVFSFile(const std::filesystem::path& file_path) const;
+
         std::filesystem::path getFullPath(const std::string& relative_path) const;
 
     public:
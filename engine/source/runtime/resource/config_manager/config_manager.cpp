@@ -2,6 +2,8 @@
 
 // #include "runtime/engine.h"
 
+#include <algorithm>
+#include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <string>
@@ -56,11 +58,15 @@ namespace ArchViz
         m_root_folder.clear();
         m_asset_folder.clear();
         m_template_folder.clear();
+        m_cache_folder.clear();
 
         m_default_world_url.clear();
         m_global_rendering_res_url.clear();
         m_global_particle_res_url.clear();
 
+        m_scene_draw_count    = 1;
+        m_scene_indirect_draw = true;
+
         m_editor_big_icon_path.clear();
         m_editor_small_icon_path.clear();
         m_editor_font_path.clear();
@@ -87,6 +93,10 @@ namespace ArchViz
         {
             m_template_folder = m_root_folder / value;
         }
+        else if (name == "CacheFolder")
+        {
+            m_cache_folder = m_root_folder / value;
+        }
         else if (name == "DefaultWorld")
         {
             m_default_world_url = value;
@@ -111,6 +121,14 @@ namespace ArchViz
         {
             m_global_particle_res_url = value;
         }
+        else if (name == "SceneDrawCount")
+        {
+            m_scene_draw_count = std::max(1ul, std::strtoul(value.c_str(), nullptr, 10));
+        }
+        else if (name == "SceneIndirectDraw")
+        {
+            m_scene_indirect_draw = std::strtoul(value.c_str(), nullptr, 10) != 0;
+        }
     }
 
     void ConfigManager::setKeyConfig(const std::string& name, const std::string& value) { m_key_binding.emplace(name, value); }
@@ -121,6 +139,8 @@ namespace ArchViz
 
     const std::filesystem::path& ConfigManager::getTemplateFolder() const { return m_template_folder; }
 
+    const std::filesystem::path& ConfigManager::getCacheFolder() const { return m_cache_folder; }
+
     const std::filesystem::path& ConfigManager::getEditorBigIconPath() const { return m_editor_big_icon_path; }
 
     const std::filesystem::path& ConfigManager::getEditorSmallIconPath() const { return m_editor_small_icon_path; }
@@ -133,4 +153,8 @@ namespace ArchViz
 
     const std::string& ConfigManager::getGlobalParticleResUrl() const { return m_global_particle_res_url; }
 
+    uint32_t ConfigManager::getSceneDrawCount() const { return m_scene_draw_count; }
+
+    bool ConfigManager::getSceneIndirectDraw() const { return m_scene_indirect_draw; }
+
 } // namespace ArchViz
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
 #include <unordered_map>
 
@@ -17,6 +18,7 @@ namespace ArchViz
         const std::filesystem::path& getRootFolder() const;
         const std::filesystem::path& getAssetFolder() const;
         const std::filesystem::path& getTemplateFolder() const;
+        const std::filesystem::path& getCacheFolder() const; // empty when caching is disabled
         const std::filesystem::path& getEditorBigIconPath() const;
         const std::filesystem::path& getEditorSmallIconPath() const;
         const std::filesystem::path& getEditorFontPath() const;
@@ -25,6 +27,11 @@ namespace ArchViz
         const std::string& getGlobalRenderingResUrl() const;
         const std::string& getGlobalParticleResUrl() const;
 
+        // draws the scene model is split into, raise it for a draw heavy frame
+        uint32_t getSceneDrawCount() const;
+        // the scene draws as indirect commands, off for the per draw path
+        bool getSceneIndirectDraw() const;
+
     private:
         void setAssetConfig(const std::string& name, const std::string& value);
         void setKeyConfig(const std::string& name, const std::string& value);
@@ -39,6 +46,7 @@ namespace ArchViz
         std::filesystem::path m_root_folder;
         std::filesystem::path m_asset_folder;
         std::filesystem::path m_template_folder;
+        std::filesystem::path m_cache_folder;
         std::filesystem::path m_editor_big_icon_path;
         std::filesystem::path m_editor_small_icon_path;
         std::filesystem::path m_editor_font_path;
@@ -47,6 +55,9 @@ namespace ArchViz
         std::string m_global_rendering_res_url;
         std::string m_global_particle_res_url;
 
+        uint32_t m_scene_draw_count {1};
+        bool     m_scene_indirect_draw {true};
+
         std::unordered_map<std::string, std::string> m_key_binding;
     };
 } // namespace ArchViz
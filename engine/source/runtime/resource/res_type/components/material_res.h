@@ -30,6 +30,7 @@ namespace ArchViz
 
     public:
         std::string m_texture_uri;
+        std::string m_role; // albedo (default), normal, mask, data
     };
 
     REFLECTION_TYPE(MaterialRes)
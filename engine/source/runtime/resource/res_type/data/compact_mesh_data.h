@@ -0,0 +1,54 @@
+#pragma once
+#include "runtime/core/math/vector/vector3.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace ArchViz
+{
+    enum class MeshIndexType : uint8_t
+    {
+        Uint16,
+        Uint32,
+    };
+
+    enum class MeshUVFormat : uint8_t
+    {
+        Unorm16, // all uvs in [0, 1]
+        Half,
+    };
+
+    // Quantized mesh with one stream per attribute, 16 bytes per vertex:
+    //  positions : unorm16 x, y, z relative to the aabb + 1 padding (R16G16B16A16_UNORM)
+    //  frames    : snorm8 octahedral normal u, v and tangent u, v (R8G8B8A8_SNORM)
+    //  uvs       : unorm16 or half u, v (R16G16_UNORM / R16G16_SFLOAT)
+    // Skeleton bindings are not kept, this is meant for static geometry.
+    struct CompactMeshData
+    {
+        Vector3 aabb_min {};
+        Vector3 aabb_max {};
+
+        uint32_t vertex_count {0};
+
+        std::vector<uint16_t> positions;
+        std::vector<int8_t>   frames;
+        std::vector<uint16_t> uvs;
+
+        MeshUVFormat  uv_format {MeshUVFormat::Unorm16};
+        MeshIndexType index_type {MeshIndexType::Uint16};
+
+        // only one of them is filled, depending on index_type
+        std::vector<uint16_t> index_buffer_16;
+        std::vector<uint32_t> index_buffer_32;
+
+        static constexpr size_t k_position_stride = 4 * sizeof(uint16_t);
+        static constexpr size_t k_frame_stride    = 4 * sizeof(int8_t);
+        static constexpr size_t k_uv_stride       = 2 * sizeof(uint16_t);
+        static constexpr size_t k_vertex_size     = k_position_stride + k_frame_stride + k_uv_stride;
+
+        size_t indexCount() const { return index_type == MeshIndexType::Uint16 ? index_buffer_16.size() : index_buffer_32.size(); }
+
+        size_t vertexBytes() const { return vertex_count * k_vertex_size; }
+        size_t indexBytes() const { return index_buffer_16.size() * sizeof(uint16_t) + index_buffer_32.size() * sizeof(uint32_t); }
+    };
+} // namespace ArchViz
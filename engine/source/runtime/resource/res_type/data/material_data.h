@@ -1,22 +1,89 @@
 #pragma once
 #include "runtime/resource/resource_manager/resource_handle.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
 
 namespace ArchViz
 {
+    enum class TextureFormat : uint8_t
+    {
+        RGBA8,
+        BC1, // rgb, 4 bpp
+        BC3, // rgba, bc1 color + bc4 alpha, 8 bpp
+        BC4, // r, 4 bpp
+        BC5, // rg, 8 bpp
+        BC7, // rgba, 8 bpp
+    };
+
+    // how a texture is sampled, decides the color space and the compressed format
+    enum class TextureRole : uint8_t
+    {
+        Albedo, // srgb color, also emissive
+        Normal, // tangent space xy, z is rebuilt in the shader
+        Mask,   // single linear channel in r, e.g. occlusion
+        Data,   // linear multi channel, e.g. metallic roughness
+    };
+
+    inline bool texture_format_compressed(TextureFormat format) { return format != TextureFormat::RGBA8; }
+
+    // bytes per 4x4 block for compressed formats, per texel otherwise
+    inline uint32_t texture_format_block_bytes(TextureFormat format)
+    {
+        switch (format)
+        {
+            case TextureFormat::BC1:
+            case TextureFormat::BC4:
+                return 8;
+            case TextureFormat::BC3:
+            case TextureFormat::BC5:
+            case TextureFormat::BC7:
+                return 16;
+            default:
+                return 4;
+        }
+    }
+
+    inline size_t texture_level_size(TextureFormat format, uint32_t width, uint32_t height)
+    {
+        if (texture_format_compressed(format))
+        {
+            return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * texture_format_block_bytes(format);
+        }
+        return static_cast<size_t>(width) * height * texture_format_block_bytes(format);
+    }
+
+    struct TextureLevel
+    {
+        size_t   offset {0}; // in bytes into TextureData::m_data
+        size_t   size {0};
+        uint32_t width {0};
+        uint32_t height {0};
+    };
+
     class TextureData
     {
     public:
+        // all mip levels packed one after another, level 0 first
         std::vector<uint8_t> m_data;
 
         int32_t m_width;
         int32_t m_height;
         int32_t m_channel;
 
+        TextureFormat m_format {TextureFormat::RGBA8};
+
+        // rgb stored with the srgb transfer function
+        bool m_srgb {true};
+
+        // empty for a single level texture (level 0 is the whole m_data)
+        std::vector<TextureLevel> m_levels;
+
         std::string m_uri;
+
+        uint32_t mipLevels() const { return m_levels.empty() ? 1 : static_cast<uint32_t>(m_levels.size()); }
     };
 
     class MaterialData
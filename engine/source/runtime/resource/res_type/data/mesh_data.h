@@ -7,6 +7,7 @@
 
 #include "runtime/core/math/math_type.h"
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -47,6 +48,43 @@ namespace ArchViz
         std::vector<SkeletonBinding> bind;
     };
 
+    // simplified index buffer, shares the vertex buffer of its mesh
+    struct MeshLodData
+    {
+        std::vector<uint32_t> index_buffer;
+        // object space geometric error of this lod against the full mesh
+        float error {0.0f};
+    };
+
+    // cluster of the full mesh, vertices and triangles index into the meshlet arrays of CookedMeshData
+    struct MeshletData
+    {
+        uint32_t vertex_offset {0};
+        uint32_t triangle_offset {0}; // in bytes, 3 local indices per triangle
+        uint32_t vertex_count {0};
+        uint32_t triangle_count {0};
+
+        // object space bounding sphere
+        Vector3 center {};
+        float   radius {0.0f};
+
+        // back facing when dot(normalize(cone_apex - camera), cone_axis) >= cone_cutoff
+        Vector3 cone_apex {};
+        Vector3 cone_axis {};
+        float   cone_cutoff {1.0f};
+    };
+
+    // mesh after the offline processing stages, lods are ordered from fine to coarse
+    struct CookedMeshData
+    {
+        MeshData                 mesh;
+        std::vector<MeshLodData> lods;
+
+        std::vector<MeshletData> meshlets;
+        std::vector<uint32_t>    meshlet_vertices;  // mesh vertex index
+        std::vector<uint8_t>     meshlet_triangles; // meshlet local vertex index
+    };
+
     // TODO : use same structure in gltf to build data
     struct ModelData
     {
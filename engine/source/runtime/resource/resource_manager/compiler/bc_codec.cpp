@@ -0,0 +1,802 @@
+#include "runtime/resource/resource_manager/compiler/bc_codec.h"
+
+#include "runtime/core/thread/work_executor.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64)
+#include <xmmintrin.h>
+#define ARCHVIZ_BC_SSE
+#endif
+
+namespace ArchViz
+{
+    namespace
+    {
+        constexpr uint32_t k_block_rows_per_job = 8;
+
+        constexpr int k_bc7_weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+        struct BitWriter
+        {
+            uint8_t* data;
+            uint32_t position {0};
+
+            void write(uint32_t value, uint32_t bits)
+            {
+                for (uint32_t i = 0; i < bits; ++i, ++position)
+                {
+                    data[position >> 3] |= static_cast<uint8_t>(((value >> i) & 1u) << (position & 7));
+                }
+            }
+        };
+
+        struct BitReader
+        {
+            const uint8_t* data;
+            uint32_t       position {0};
+
+            uint32_t read(uint32_t bits)
+            {
+                uint32_t value = 0;
+                for (uint32_t i = 0; i < bits; ++i, ++position)
+                {
+                    value |= static_cast<uint32_t>((data[position >> 3] >> (position & 7)) & 1u) << i;
+                }
+                return value;
+            }
+        };
+
+        // squared distance of every pixel to its nearest palette entry, four palette entries per sse lane group
+        float select_indices(const float pixels[16][4], const float palette[][4], uint32_t palette_size, uint8_t indices[16])
+        {
+            float total = 0.0f;
+#ifdef ARCHVIZ_BC_SSE
+            const uint32_t group_count = (palette_size + 3) / 4;
+
+            __m128 groups[4][4]; // [group][channel], padded with the last entry
+            for (uint32_t g = 0; g < group_count; ++g)
+            {
+                uint32_t e[4];
+                for (uint32_t k = 0; k < 4; ++k)
+                {
+                    e[k] = std::min(g * 4 + k, palette_size - 1);
+                }
+                for (uint32_t c = 0; c < 4; ++c)
+                {
+                    groups[g][c] = _mm_setr_ps(palette[e[0]][c], palette[e[1]][c], palette[e[2]][c], palette[e[3]][c]);
+                }
+            }
+
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                float   best       = FLT_MAX;
+                uint8_t best_index = 0;
+                for (uint32_t g = 0; g < group_count; ++g)
+                {
+                    __m128 distance = _mm_setzero_ps();
+                    for (uint32_t c = 0; c < 4; ++c)
+                    {
+                        __m128 diff = _mm_sub_ps(_mm_set1_ps(pixels[i][c]), groups[g][c]);
+                        distance    = _mm_add_ps(distance, _mm_mul_ps(diff, diff));
+                    }
+
+                    alignas(16) float lanes[4];
+                    _mm_store_ps(lanes, distance);
+                    for (uint32_t k = 0; k < 4; ++k)
+                    {
+                        if (lanes[k] < best)
+                        {
+                            best       = lanes[k];
+                            best_index = static_cast<uint8_t>(std::min(g * 4 + k, palette_size - 1));
+                        }
+                    }
+                }
+                indices[i] = best_index;
+                total += best;
+            }
+#else
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                float   best       = FLT_MAX;
+                uint8_t best_index = 0;
+                for (uint32_t e = 0; e < palette_size; ++e)
+                {
+                    float distance = 0.0f;
+                    for (uint32_t c = 0; c < 4; ++c)
+                    {
+                        float diff = pixels[i][c] - palette[e][c];
+                        distance += diff * diff;
+                    }
+                    if (distance < best)
+                    {
+                        best       = distance;
+                        best_index = static_cast<uint8_t>(e);
+                    }
+                }
+                indices[i] = best_index;
+                total += best;
+            }
+#endif
+            return total;
+        }
+
+        // principal axis of the block by power iteration, channels beyond channel_count are ignored
+        void principal_axis(const float pixels[16][4], uint32_t channel_count, float mean[4], float axis[4])
+        {
+            for (uint32_t c = 0; c < 4; ++c)
+            {
+                mean[c] = 0.0f;
+                axis[c] = 0.0f;
+            }
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                for (uint32_t c = 0; c < channel_count; ++c)
+                {
+                    mean[c] += pixels[i][c] / 16.0f;
+                }
+            }
+
+            float covariance[4][4] = {};
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                for (uint32_t r = 0; r < channel_count; ++r)
+                {
+                    for (uint32_t c = 0; c < channel_count; ++c)
+                    {
+                        covariance[r][c] += (pixels[i][r] - mean[r]) * (pixels[i][c] - mean[c]);
+                    }
+                }
+            }
+
+            float vector[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+            for (int iteration = 0; iteration < 8; ++iteration)
+            {
+                float next[4] = {};
+                float length  = 0.0f;
+                for (uint32_t r = 0; r < channel_count; ++r)
+                {
+                    for (uint32_t c = 0; c < channel_count; ++c)
+                    {
+                        next[r] += covariance[r][c] * vector[c];
+                    }
+                    length = std::max(length, std::fabs(next[r]));
+                }
+                if (length < 1e-6f)
+                {
+                    return; // flat block, zero axis
+                }
+                for (uint32_t c = 0; c < channel_count; ++c)
+                {
+                    vector[c] = next[c] / length;
+                }
+            }
+
+            float norm = 0.0f;
+            for (uint32_t c = 0; c < channel_count; ++c)
+            {
+                norm += vector[c] * vector[c];
+            }
+            norm = std::sqrt(norm);
+            for (uint32_t c = 0; c < channel_count; ++c)
+            {
+                axis[c] = vector[c] / norm;
+            }
+        }
+
+        // endpoints at the extremes of the projection on the principal axis
+        void axis_endpoints(const float pixels[16][4], uint32_t channel_count, float e0[4], float e1[4])
+        {
+            float mean[4], axis[4];
+            principal_axis(pixels, channel_count, mean, axis);
+
+            float t_min = FLT_MAX;
+            float t_max = -FLT_MAX;
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                float t = 0.0f;
+                for (uint32_t c = 0; c < channel_count; ++c)
+                {
+                    t += (pixels[i][c] - mean[c]) * axis[c];
+                }
+                t_min = std::min(t_min, t);
+                t_max = std::max(t_max, t);
+            }
+
+            for (uint32_t c = 0; c < 4; ++c)
+            {
+                e0[c] = std::clamp(mean[c] + axis[c] * t_max, 0.0f, 255.0f);
+                e1[c] = std::clamp(mean[c] + axis[c] * t_min, 0.0f, 255.0f);
+            }
+        }
+
+        // least squares endpoints for fixed indices, weights[i] is the weight of e0 for pixel i
+        bool refine_endpoints(const float pixels[16][4], const float weights[16], uint32_t channel_count, float e0[4], float e1[4])
+        {
+            float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+            float ax[4] = {}, bx[4] = {};
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                float a = weights[i];
+                float b = 1.0f - a;
+                aa += a * a;
+                ab += a * b;
+                bb += b * b;
+                for (uint32_t c = 0; c < channel_count; ++c)
+                {
+                    ax[c] += a * pixels[i][c];
+                    bx[c] += b * pixels[i][c];
+                }
+            }
+
+            float determinant = aa * bb - ab * ab;
+            if (std::fabs(determinant) < 1e-6f)
+            {
+                return false;
+            }
+
+            for (uint32_t c = 0; c < channel_count; ++c)
+            {
+                e0[c] = std::clamp((bb * ax[c] - ab * bx[c]) / determinant, 0.0f, 255.0f);
+                e1[c] = std::clamp((aa * bx[c] - ab * ax[c]) / determinant, 0.0f, 255.0f);
+            }
+            return true;
+        }
+
+        void load_pixels(const uint8_t rgba[64], float pixels[16][4], uint32_t channel_count)
+        {
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                for (uint32_t c = 0; c < 4; ++c)
+                {
+                    pixels[i][c] = c < channel_count ? static_cast<float>(rgba[i * 4 + c]) : 0.0f;
+                }
+            }
+        }
+
+        // ---- bc1 ----
+
+        uint16_t pack_565(const float color[4])
+        {
+            uint32_t r = static_cast<uint32_t>(std::clamp(color[0] * 31.0f / 255.0f + 0.5f, 0.0f, 31.0f));
+            uint32_t g = static_cast<uint32_t>(std::clamp(color[1] * 63.0f / 255.0f + 0.5f, 0.0f, 63.0f));
+            uint32_t b = static_cast<uint32_t>(std::clamp(color[2] * 31.0f / 255.0f + 0.5f, 0.0f, 31.0f));
+            return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+        }
+
+        void unpack_565(uint16_t value, int color[3])
+        {
+            int r    = (value >> 11) & 31;
+            int g    = (value >> 5) & 63;
+            int b    = value & 31;
+            color[0] = (r << 3) | (r >> 2);
+            color[1] = (g << 2) | (g >> 4);
+            color[2] = (b << 3) | (b >> 2);
+        }
+
+        // four color mode when c0 > c1, otherwise three colors and black
+        void bc1_palette(uint16_t c0, uint16_t c1, bool force_four, int palette[4][3])
+        {
+            unpack_565(c0, palette[0]);
+            unpack_565(c1, palette[1]);
+            for (int c = 0; c < 3; ++c)
+            {
+                if (c0 > c1 || force_four)
+                {
+                    palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                    palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+                }
+                else
+                {
+                    palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                    palette[3][c] = 0;
+                }
+            }
+        }
+
+        void encode_bc1(const uint8_t rgba[64], uint8_t* block)
+        {
+            float pixels[16][4];
+            load_pixels(rgba, pixels, 3);
+
+            float e0[4], e1[4];
+            axis_endpoints(pixels, 3, e0, e1);
+
+            const float k_weights[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+
+            float    best_error = FLT_MAX;
+            uint16_t best_c0    = 0;
+            uint16_t best_c1    = 0;
+            uint8_t  best_indices[16] {};
+
+            for (int iteration = 0; iteration < 3; ++iteration)
+            {
+                uint16_t c0 = pack_565(e0);
+                uint16_t c1 = pack_565(e1);
+                if (c0 < c1)
+                {
+                    std::swap(c0, c1);
+                }
+
+                // always four color mode, equal endpoints only ever use index 0
+                int palette_int[4][3];
+                bc1_palette(c0, c1, true, palette_int);
+
+                float palette[4][4] = {};
+                for (int e = 0; e < 4; ++e)
+                {
+                    for (int c = 0; c < 3; ++c)
+                    {
+                        palette[e][c] = static_cast<float>(palette_int[e][c]);
+                    }
+                }
+
+                uint8_t indices[16];
+                float   error = select_indices(pixels, palette, 4, indices);
+                if (c0 == c1)
+                {
+                    std::memset(indices, 0, sizeof(indices));
+                }
+                if (error < best_error)
+                {
+                    best_error = error;
+                    best_c0    = c0;
+                    best_c1    = c1;
+                    std::memcpy(best_indices, indices, sizeof(indices));
+                }
+
+                if (c0 == c1 || error == 0.0f)
+                {
+                    break;
+                }
+
+                float weights[16];
+                for (int i = 0; i < 16; ++i)
+                {
+                    weights[i] = k_weights[indices[i]];
+                }
+                if (!refine_endpoints(pixels, weights, 3, e0, e1))
+                {
+                    break;
+                }
+            }
+
+            uint32_t bits = 0;
+            for (int i = 0; i < 16; ++i)
+            {
+                bits |= static_cast<uint32_t>(best_indices[i]) << (2 * i);
+            }
+            std::memcpy(block, &best_c0, 2);
+            std::memcpy(block + 2, &best_c1, 2);
+            std::memcpy(block + 4, &bits, 4);
+        }
+
+        void decode_bc1(const uint8_t* block, uint8_t rgba[64], bool force_four)
+        {
+            uint16_t c0, c1;
+            uint32_t bits;
+            std::memcpy(&c0, block, 2);
+            std::memcpy(&c1, block + 2, 2);
+            std::memcpy(&bits, block + 4, 4);
+
+            int palette[4][3];
+            bc1_palette(c0, c1, force_four, palette);
+
+            for (int i = 0; i < 16; ++i)
+            {
+                uint32_t index = (bits >> (2 * i)) & 3u;
+                for (int c = 0; c < 3; ++c)
+                {
+                    rgba[i * 4 + c] = static_cast<uint8_t>(palette[index][c]);
+                }
+                rgba[i * 4 + 3] = (!force_four && c0 <= c1 && index == 3) ? 0 : 255;
+            }
+        }
+
+        // ---- bc4 ----
+
+        void bc4_palette(int e0, int e1, int palette[8])
+        {
+            palette[0] = e0;
+            palette[1] = e1;
+            if (e0 > e1)
+            {
+                for (int i = 1; i < 7; ++i)
+                {
+                    palette[i + 1] = ((7 - i) * e0 + i * e1) / 7;
+                }
+            }
+            else
+            {
+                for (int i = 1; i < 5; ++i)
+                {
+                    palette[i + 1] = ((5 - i) * e0 + i * e1) / 5;
+                }
+                palette[6] = 0;
+                palette[7] = 255;
+            }
+        }
+
+        int bc4_indices(const int values[16], int e0, int e1, uint8_t indices[16])
+        {
+            int palette[8];
+            bc4_palette(e0, e1, palette);
+
+            int total = 0;
+            for (int i = 0; i < 16; ++i)
+            {
+                int best = std::numeric_limits<int>::max();
+                for (int e = 0; e < 8; ++e)
+                {
+                    int diff = values[i] - palette[e];
+                    if (diff * diff < best)
+                    {
+                        best       = diff * diff;
+                        indices[i] = static_cast<uint8_t>(e);
+                    }
+                }
+                total += best;
+            }
+            return total;
+        }
+
+        void encode_bc4(const uint8_t rgba[64], uint32_t channel, uint8_t* block)
+        {
+            int values[16];
+            int low = 255, high = 0;
+            int inner_low = 255, inner_high = 0; // without the explicit 0 and 255 of the six value mode
+            for (int i = 0; i < 16; ++i)
+            {
+                values[i] = rgba[i * 4 + channel];
+                low       = std::min(low, values[i]);
+                high      = std::max(high, values[i]);
+                if (values[i] != 0 && values[i] != 255)
+                {
+                    inner_low  = std::min(inner_low, values[i]);
+                    inner_high = std::max(inner_high, values[i]);
+                }
+            }
+
+            uint8_t indices[16];
+            int     e0 = high, e1 = low;
+            int     error = bc4_indices(values, e0, e1, indices);
+
+            if (inner_low <= inner_high && (low == 0 || high == 255))
+            {
+                uint8_t six_indices[16];
+                int     six_error = bc4_indices(values, inner_low, inner_high, six_indices);
+                if (six_error < error)
+                {
+                    e0    = inner_low;
+                    e1    = inner_high;
+                    error = six_error;
+                    std::memcpy(indices, six_indices, sizeof(indices));
+                }
+            }
+
+            uint64_t bits = 0;
+            for (int i = 0; i < 16; ++i)
+            {
+                bits |= static_cast<uint64_t>(indices[i]) << (3 * i);
+            }
+            block[0] = static_cast<uint8_t>(e0);
+            block[1] = static_cast<uint8_t>(e1);
+            for (int i = 0; i < 6; ++i)
+            {
+                block[2 + i] = static_cast<uint8_t>(bits >> (8 * i));
+            }
+        }
+
+        void decode_bc4(const uint8_t* block, uint32_t channel, uint8_t rgba[64])
+        {
+            int palette[8];
+            bc4_palette(block[0], block[1], palette);
+
+            uint64_t bits = 0;
+            for (int i = 0; i < 6; ++i)
+            {
+                bits |= static_cast<uint64_t>(block[2 + i]) << (8 * i);
+            }
+            for (int i = 0; i < 16; ++i)
+            {
+                rgba[i * 4 + channel] = static_cast<uint8_t>(palette[(bits >> (3 * i)) & 7u]);
+            }
+        }
+
+        // ---- bc7 mode 6 ----
+
+        // 7 bit endpoint plus a shared p bit, the p bit with the smaller error wins
+        void quantize_bc7_endpoint(const float endpoint[4], int quantized[4], int& p_bit)
+        {
+            float best_error = FLT_MAX;
+            for (int p = 0; p < 2; ++p)
+            {
+                int   candidate[4];
+                float error = 0.0f;
+                for (int c = 0; c < 4; ++c)
+                {
+                    candidate[c] = std::clamp(static_cast<int>(std::lround((endpoint[c] - p) / 2.0f)), 0, 127);
+                    float diff   = static_cast<float>(candidate[c] * 2 + p) - endpoint[c];
+                    error += diff * diff;
+                }
+                if (error < best_error)
+                {
+                    best_error = error;
+                    p_bit      = p;
+                    std::memcpy(quantized, candidate, sizeof(candidate));
+                }
+            }
+        }
+
+        void bc7_palette(const int q0[4], int p0, const int q1[4], int p1, float palette[16][4])
+        {
+            for (int e = 0; e < 16; ++e)
+            {
+                for (int c = 0; c < 4; ++c)
+                {
+                    int a         = q0[c] * 2 + p0;
+                    int b         = q1[c] * 2 + p1;
+                    palette[e][c] = static_cast<float>(((64 - k_bc7_weights[e]) * a + k_bc7_weights[e] * b + 32) >> 6);
+                }
+            }
+        }
+
+        void encode_bc7(const uint8_t rgba[64], uint8_t* block)
+        {
+            float pixels[16][4];
+            load_pixels(rgba, pixels, 4);
+
+            float e0[4], e1[4];
+            axis_endpoints(pixels, 4, e0, e1);
+
+            float   best_error = FLT_MAX;
+            int     best_q0[4] {}, best_q1[4] {};
+            int     best_p0 = 0, best_p1 = 0;
+            uint8_t best_indices[16] {};
+
+            for (int iteration = 0; iteration < 3; ++iteration)
+            {
+                int q0[4], q1[4], p0, p1;
+                quantize_bc7_endpoint(e0, q0, p0);
+                quantize_bc7_endpoint(e1, q1, p1);
+
+                float palette[16][4];
+                bc7_palette(q0, p0, q1, p1, palette);
+
+                uint8_t indices[16];
+                float   error = select_indices(pixels, palette, 16, indices);
+                if (error < best_error)
+                {
+                    best_error = error;
+                    std::memcpy(best_q0, q0, sizeof(q0));
+                    std::memcpy(best_q1, q1, sizeof(q1));
+                    best_p0 = p0;
+                    best_p1 = p1;
+                    std::memcpy(best_indices, indices, sizeof(indices));
+                }
+
+                if (error == 0.0f)
+                {
+                    break;
+                }
+
+                float weights[16];
+                for (int i = 0; i < 16; ++i)
+                {
+                    weights[i] = 1.0f - k_bc7_weights[indices[i]] / 64.0f;
+                }
+                if (!refine_endpoints(pixels, weights, 4, e0, e1))
+                {
+                    break;
+                }
+            }
+
+            // the anchor index drops its top bit, swap the endpoints so it is below 8
+            if (best_indices[0] >= 8)
+            {
+                std::swap(best_q0, best_q1);
+                std::swap(best_p0, best_p1);
+                for (auto& index : best_indices)
+                {
+                    index = static_cast<uint8_t>(15 - index);
+                }
+            }
+
+            std::memset(block, 0, 16);
+            BitWriter writer {block};
+            writer.write(1u << 6, 7);
+            for (int c = 0; c < 4; ++c)
+            {
+                writer.write(best_q0[c], 7);
+                writer.write(best_q1[c], 7);
+            }
+            writer.write(best_p0, 1);
+            writer.write(best_p1, 1);
+            writer.write(best_indices[0], 3);
+            for (int i = 1; i < 16; ++i)
+            {
+                writer.write(best_indices[i], 4);
+            }
+        }
+
+        void decode_bc7(const uint8_t* block, uint8_t rgba[64])
+        {
+            if ((block[0] & 0x7F) != 0x40)
+            {
+                // not mode 6, decode as opaque magenta so it shows up
+                for (int i = 0; i < 16; ++i)
+                {
+                    rgba[i * 4 + 0] = 255;
+                    rgba[i * 4 + 1] = 0;
+                    rgba[i * 4 + 2] = 255;
+                    rgba[i * 4 + 3] = 255;
+                }
+                return;
+            }
+
+            BitReader reader {block};
+            reader.read(7);
+
+            int q0[4], q1[4];
+            for (int c = 0; c < 4; ++c)
+            {
+                q0[c] = static_cast<int>(reader.read(7));
+                q1[c] = static_cast<int>(reader.read(7));
+            }
+            int p0 = static_cast<int>(reader.read(1));
+            int p1 = static_cast<int>(reader.read(1));
+
+            float palette[16][4];
+            bc7_palette(q0, p0, q1, p1, palette);
+
+            for (int i = 0; i < 16; ++i)
+            {
+                uint32_t index = reader.read(i == 0 ? 3 : 4);
+                for (int c = 0; c < 4; ++c)
+                {
+                    rgba[i * 4 + c] = static_cast<uint8_t>(palette[index][c]);
+                }
+            }
+        }
+
+        void load_block(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t block_x, uint32_t block_y, uint8_t block[64])
+        {
+            for (uint32_t y = 0; y < 4; ++y)
+            {
+                uint32_t sy = std::min(block_y * 4 + y, height - 1);
+                for (uint32_t x = 0; x < 4; ++x)
+                {
+                    uint32_t sx = std::min(block_x * 4 + x, width - 1);
+                    std::memcpy(block + (y * 4 + x) * 4, rgba + (static_cast<size_t>(sy) * width + sx) * 4, 4);
+                }
+            }
+        }
+    } // namespace
+
+    void BCCodec::encodeBlock(TextureFormat format, const uint8_t rgba[64], uint8_t* block)
+    {
+        switch (format)
+        {
+            case TextureFormat::BC1:
+                encode_bc1(rgba, block);
+                break;
+            case TextureFormat::BC3:
+                encode_bc4(rgba, 3, block);
+                encode_bc1(rgba, block + 8);
+                break;
+            case TextureFormat::BC4:
+                encode_bc4(rgba, 0, block);
+                break;
+            case TextureFormat::BC5:
+                encode_bc4(rgba, 0, block);
+                encode_bc4(rgba, 1, block + 8);
+                break;
+            case TextureFormat::BC7:
+                encode_bc7(rgba, block);
+                break;
+            default:
+                break;
+        }
+    }
+
+    void BCCodec::decodeBlock(TextureFormat format, const uint8_t* block, uint8_t rgba[64])
+    {
+        // channels a format does not store decode as 0, alpha as opaque
+        for (int i = 0; i < 16; ++i)
+        {
+            rgba[i * 4 + 0] = 0;
+            rgba[i * 4 + 1] = 0;
+            rgba[i * 4 + 2] = 0;
+            rgba[i * 4 + 3] = 255;
+        }
+
+        switch (format)
+        {
+            case TextureFormat::BC1:
+                decode_bc1(block, rgba, false);
+                break;
+            case TextureFormat::BC3:
+                decode_bc1(block + 8, rgba, true);
+                decode_bc4(block, 3, rgba);
+                break;
+            case TextureFormat::BC4:
+                decode_bc4(block, 0, rgba);
+                break;
+            case TextureFormat::BC5:
+                decode_bc4(block, 0, rgba);
+                decode_bc4(block + 8, 1, rgba);
+                break;
+            case TextureFormat::BC7:
+                decode_bc7(block, rgba);
+                break;
+            default:
+                break;
+        }
+    }
+
+    void BCCodec::encodeImage(TextureFormat format, const uint8_t* rgba, uint32_t width, uint32_t height, uint8_t* output, std::shared_ptr<WorkExecutor> executor)
+    {
+        const uint32_t block_width  = (width + 3) / 4;
+        const uint32_t block_height = (height + 3) / 4;
+        const uint32_t block_bytes  = texture_format_block_bytes(format);
+
+        parallel_for(executor, block_height, k_block_rows_per_job, [&](uint32_t begin, uint32_t end) {
+            uint8_t pixels[64];
+            for (uint32_t by = begin; by < end; ++by)
+            {
+                for (uint32_t bx = 0; bx < block_width; ++bx)
+                {
+                    load_block(rgba, width, height, bx, by, pixels);
+                    encodeBlock(format, pixels, output + (static_cast<size_t>(by) * block_width + bx) * block_bytes);
+                }
+            }
+        });
+    }
+
+    void BCCodec::decodeImage(TextureFormat format, const uint8_t* blocks, uint32_t width, uint32_t height, uint8_t* rgba)
+    {
+        const uint32_t block_width  = (width + 3) / 4;
+        const uint32_t block_height = (height + 3) / 4;
+        const uint32_t block_bytes  = texture_format_block_bytes(format);
+
+        uint8_t pixels[64];
+        for (uint32_t by = 0; by < block_height; ++by)
+        {
+            for (uint32_t bx = 0; bx < block_width; ++bx)
+            {
+                decodeBlock(format, blocks + (static_cast<size_t>(by) * block_width + bx) * block_bytes, pixels);
+                for (uint32_t y = 0; y < 4 && by * 4 + y < height; ++y)
+                {
+                    for (uint32_t x = 0; x < 4 && bx * 4 + x < width; ++x)
+                    {
+                        std::memcpy(rgba + ((static_cast<size_t>(by) * 4 + y) * width + bx * 4 + x) * 4, pixels + (y * 4 + x) * 4, 4);
+                    }
+                }
+            }
+        }
+    }
+
+    double BCCodec::computePSNR(const uint8_t* lhs, const uint8_t* rhs, size_t pixel_count, uint32_t channel_count)
+    {
+        double sum = 0.0;
+        for (size_t i = 0; i < pixel_count; ++i)
+        {
+            for (uint32_t c = 0; c < channel_count; ++c)
+            {
+                double diff = static_cast<double>(lhs[i * 4 + c]) - static_cast<double>(rhs[i * 4 + c]);
+                sum += diff * diff;
+            }
+        }
+
+        double mse = sum / (static_cast<double>(pixel_count) * channel_count);
+        if (mse <= 0.0)
+        {
+            return std::numeric_limits<double>::infinity();
+        }
+        return 10.0 * std::log10(255.0 * 255.0 / mse);
+    }
+} // namespace ArchViz
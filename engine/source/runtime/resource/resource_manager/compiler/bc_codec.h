@@ -0,0 +1,29 @@
+#pragma once
+#include "runtime/resource/res_type/data/material_data.h"
+
+#include <cstdint>
+#include <memory>
+
+namespace ArchViz
+{
+    class WorkExecutor;
+
+    // block compression for cooked textures
+    // bc1 / bc3 / bc4 / bc5 use pca endpoints with a least squares refinement,
+    // bc7 always writes mode 6 (single subset rgba 7.7.7.7 + p bit, 4 bit indices)
+    class BCCodec
+    {
+    public:
+        // rgba is a 4x4 rgba8 block, row major
+        static void encodeBlock(TextureFormat format, const uint8_t rgba[64], uint8_t* block);
+        // bc7 decoding only covers mode 6, the only mode encodeBlock writes
+        static void decodeBlock(TextureFormat format, const uint8_t* block, uint8_t rgba[64]);
+
+        // one rgba8 level, edge blocks repeat the last row / column, block rows run in parallel on the executor
+        static void encodeImage(TextureFormat format, const uint8_t* rgba, uint32_t width, uint32_t height, uint8_t* output, std::shared_ptr<WorkExecutor> executor);
+        static void decodeImage(TextureFormat format, const uint8_t* blocks, uint32_t width, uint32_t height, uint8_t* rgba);
+
+        // peak signal to noise ratio in db over the first channel_count channels of two rgba8 images
+        static double computePSNR(const uint8_t* lhs, const uint8_t* rhs, size_t pixel_count, uint32_t channel_count);
+    };
+} // namespace ArchViz
@@ -0,0 +1,315 @@
+#include "runtime/resource/resource_manager/compiler/mesh_optimizer.h"
+
+#include "runtime/core/base/macro.h"
+#include "runtime/core/thread/work_executor.h"
+
+#include <meshoptimizer.h>
+
+#include <algorithm>
+#include <future>
+#include <limits>
+
+namespace ArchViz
+{
+    namespace
+    {
+        // cache size used for analysis, matches common post transform caches
+        constexpr unsigned int k_analyze_cache_size = 16;
+
+        void analyze(const std::vector<uint32_t>& indices, const std::vector<MeshVertex>& vertices, float& acmr, float& atvr, float& overdraw, float& overfetch)
+        {
+            if (indices.empty() || vertices.empty())
+            {
+                return;
+            }
+
+            meshopt_VertexCacheStatistics cache = meshopt_analyzeVertexCache(indices.data(), indices.size(), vertices.size(), k_analyze_cache_size, 0, 0);
+            meshopt_OverdrawStatistics    draw  = meshopt_analyzeOverdraw(indices.data(), indices.size(), &vertices[0].postion.x, vertices.size(), sizeof(MeshVertex));
+            meshopt_VertexFetchStatistics fetch = meshopt_analyzeVertexFetch(indices.data(), indices.size(), vertices.size(), sizeof(MeshVertex));
+
+            acmr      = cache.acmr;
+            atvr      = cache.atvr;
+            overdraw  = draw.overdraw;
+            overfetch = fetch.overfetch;
+        }
+    } // namespace
+
+    std::pair<std::shared_ptr<CookedMeshData>, size_t> MeshOptimizer::compileResource(std::shared_ptr<MeshData> from)
+    {
+        if (from == nullptr)
+        {
+            return {nullptr, 0};
+        }
+
+        std::shared_ptr<CookedMeshData> cooked = optimize(*from);
+
+        size_t size = cooked->mesh.vertex_buffer.size() * sizeof(MeshVertex) + cooked->mesh.index_buffer.size() * sizeof(int) + cooked->mesh.bind.size() * sizeof(SkeletonBinding);
+        for (const auto& lod : cooked->lods)
+        {
+            size += lod.index_buffer.size() * sizeof(uint32_t);
+        }
+        size += cooked->meshlets.size() * sizeof(MeshletData) + cooked->meshlet_vertices.size() * sizeof(uint32_t) + cooked->meshlet_triangles.size();
+        return {cooked, size};
+    }
+
+    std::vector<std::shared_ptr<CookedMeshData>> MeshOptimizer::compileResources(const std::vector<std::shared_ptr<MeshData>>& meshes,
+                                                                                 std::shared_ptr<WorkExecutor>                 executor,
+                                                                                 std::vector<MeshOptimizeStatistics>*          statistics)
+    {
+        std::vector<std::shared_ptr<CookedMeshData>> results(meshes.size());
+        if (statistics)
+        {
+            statistics->assign(meshes.size(), {});
+        }
+
+        std::vector<std::future<void>> futures;
+        futures.reserve(meshes.size());
+        for (size_t i = 0; i < meshes.size(); ++i)
+        {
+            if (meshes[i] == nullptr)
+            {
+                continue;
+            }
+
+            MeshOptimizeStatistics* stats = statistics ? &(*statistics)[i] : nullptr;
+            auto                    work  = [this, &mesh = *meshes[i], &result = results[i], stats]() { result = optimize(mesh, stats); };
+            if (executor)
+            {
+                futures.push_back(executor->enqueue_task(std::move(work)));
+            }
+            else
+            {
+                work();
+            }
+        }
+
+        for (auto& future : futures)
+        {
+            future.wait();
+        }
+        return results;
+    }
+
+    std::shared_ptr<CookedMeshData> MeshOptimizer::optimize(const MeshData& mesh, MeshOptimizeStatistics* statistics) const
+    {
+        std::shared_ptr<CookedMeshData> cooked = std::make_shared<CookedMeshData>();
+
+        size_t index_count  = mesh.index_buffer.size();
+        size_t vertex_count = mesh.vertex_buffer.size();
+        if (index_count == 0 || vertex_count == 0)
+        {
+            cooked->mesh = mesh;
+            return cooked;
+        }
+
+        const bool has_bind = mesh.bind.size() == vertex_count;
+
+        std::vector<uint32_t> indices(mesh.index_buffer.begin(), mesh.index_buffer.end());
+
+        MeshOptimizeStatistics stats;
+        stats.vertex_count_before = static_cast<uint32_t>(vertex_count);
+        analyze(indices, mesh.vertex_buffer, stats.acmr_before, stats.atvr_before, stats.overdraw_before, stats.overfetch_before);
+
+        // 1. remove duplicated vertices, skeleton binding is part of the vertex
+        std::vector<uint32_t> remap(vertex_count);
+
+        std::vector<meshopt_Stream> streams;
+        streams.push_back({mesh.vertex_buffer.data(), sizeof(MeshVertex), sizeof(MeshVertex)});
+        if (has_bind)
+        {
+            streams.push_back({mesh.bind.data(), sizeof(SkeletonBinding), sizeof(SkeletonBinding)});
+        }
+
+        size_t unique_count = meshopt_generateVertexRemapMulti(remap.data(), indices.data(), index_count, vertex_count, streams.data(), streams.size());
+
+        std::vector<MeshVertex>      vertices(unique_count);
+        std::vector<SkeletonBinding> bind(has_bind ? unique_count : 0);
+
+        meshopt_remapIndexBuffer(indices.data(), indices.data(), index_count, remap.data());
+        meshopt_remapVertexBuffer(vertices.data(), mesh.vertex_buffer.data(), vertex_count, sizeof(MeshVertex), remap.data());
+        if (has_bind)
+        {
+            meshopt_remapVertexBuffer(bind.data(), mesh.bind.data(), vertex_count, sizeof(SkeletonBinding), remap.data());
+        }
+        vertex_count = unique_count;
+
+        const float* positions = &vertices[0].postion.x;
+
+        // 2. post transform cache
+        if (m_config.vertex_cache)
+        {
+            meshopt_optimizeVertexCache(indices.data(), indices.data(), index_count, vertex_count);
+        }
+
+        // 3. overdraw, may slightly hurt the cache within threshold
+        if (m_config.overdraw)
+        {
+            meshopt_optimizeOverdraw(indices.data(), indices.data(), index_count, positions, vertex_count, sizeof(MeshVertex), m_config.overdraw_threshold);
+        }
+
+        // 4. vertex fetch, reorder vertices by first use
+        if (m_config.vertex_fetch)
+        {
+            vertex_count = meshopt_optimizeVertexFetchRemap(remap.data(), indices.data(), index_count, vertex_count);
+
+            std::vector<MeshVertex> fetch_vertices(vertex_count);
+            meshopt_remapIndexBuffer(indices.data(), indices.data(), index_count, remap.data());
+            meshopt_remapVertexBuffer(fetch_vertices.data(), vertices.data(), vertices.size(), sizeof(MeshVertex), remap.data());
+            if (has_bind)
+            {
+                std::vector<SkeletonBinding> fetch_bind(vertex_count);
+                meshopt_remapVertexBuffer(fetch_bind.data(), bind.data(), bind.size(), sizeof(SkeletonBinding), remap.data());
+                bind.swap(fetch_bind);
+            }
+            vertices.swap(fetch_vertices);
+            positions = &vertices[0].postion.x;
+        }
+
+        stats.vertex_count_after = static_cast<uint32_t>(vertex_count);
+        analyze(indices, vertices, stats.acmr_after, stats.atvr_after, stats.overdraw_after, stats.overfetch_after);
+
+        // 5. lod chain, every lod is simplified from the previous one and the errors accumulate
+        float scale = meshopt_simplifyScale(positions, vertex_count, sizeof(MeshVertex));
+
+        // reserved so the previous lod stays in place while the next one is built
+        cooked->lods.reserve(m_config.max_lod_count);
+
+        const std::vector<uint32_t>* source       = &indices;
+        float                        source_error = 0.0f;
+        for (uint32_t lod = 0; lod < m_config.max_lod_count; ++lod)
+        {
+            size_t target_count = static_cast<size_t>(source->size() * m_config.lod_ratio) / 3 * 3;
+            if (target_count < m_config.lod_min_index_count)
+            {
+                break;
+            }
+
+            MeshLodData lod_data;
+            lod_data.index_buffer.resize(source->size());
+
+            float  result_error = 0.0f;
+            size_t result_count = meshopt_simplify(lod_data.index_buffer.data(),
+                                                   source->data(),
+                                                   source->size(),
+                                                   positions,
+                                                   vertex_count,
+                                                   sizeof(MeshVertex),
+                                                   target_count,
+                                                   m_config.lod_target_error,
+                                                   0,
+                                                   &result_error);
+
+            // stop once the simplifier can not make progress within the error bound
+            if (result_count == 0 || result_count > source->size() * 0.95f)
+            {
+                break;
+            }
+
+            lod_data.index_buffer.resize(result_count);
+            meshopt_optimizeVertexCache(lod_data.index_buffer.data(), lod_data.index_buffer.data(), result_count, vertex_count);
+
+            source_error += result_error * scale;
+            lod_data.error = source_error;
+
+            cooked->lods.push_back(std::move(lod_data));
+            source = &cooked->lods.back().index_buffer;
+        }
+
+        cooked->mesh.vertex_buffer = std::move(vertices);
+        cooked->mesh.bind          = std::move(bind);
+        cooked->mesh.index_buffer.assign(indices.begin(), indices.end());
+
+        // 6. meshlets of the full mesh for cluster culling
+        if (m_config.meshlets)
+        {
+            buildMeshlets(*cooked);
+        }
+
+        LOG_DEBUG("mesh optimized, acmr {} -> {}, atvr {} -> {}, lods {}, meshlets {}",
+                  stats.acmr_before,
+                  stats.acmr_after,
+                  stats.atvr_before,
+                  stats.atvr_after,
+                  cooked->lods.size(),
+                  cooked->meshlets.size());
+
+        if (statistics)
+        {
+            *statistics = stats;
+        }
+        return cooked;
+    }
+
+    void MeshOptimizer::buildMeshlets(CookedMeshData& cooked) const
+    {
+        cooked.meshlets.clear();
+        cooked.meshlet_vertices.clear();
+        cooked.meshlet_triangles.clear();
+
+        const auto& vertices = cooked.mesh.vertex_buffer;
+        if (cooked.mesh.index_buffer.empty() || vertices.empty())
+        {
+            return;
+        }
+
+        std::vector<uint32_t> indices(cooked.mesh.index_buffer.begin(), cooked.mesh.index_buffer.end());
+
+        const float* positions    = &vertices[0].postion.x;
+        const size_t max_vertices = m_config.meshlet_max_vertices;
+        const size_t max_count    = meshopt_buildMeshletsBound(indices.size(), max_vertices, m_config.meshlet_max_triangles);
+
+        std::vector<meshopt_Meshlet> meshlets(max_count);
+        cooked.meshlet_vertices.resize(max_count * max_vertices);
+        cooked.meshlet_triangles.resize(max_count * m_config.meshlet_max_triangles * 3);
+
+        size_t meshlet_count = meshopt_buildMeshlets(meshlets.data(),
+                                                     cooked.meshlet_vertices.data(),
+                                                     cooked.meshlet_triangles.data(),
+                                                     indices.data(),
+                                                     indices.size(),
+                                                     positions,
+                                                     vertices.size(),
+                                                     sizeof(MeshVertex),
+                                                     max_vertices,
+                                                     m_config.meshlet_max_triangles,
+                                                     m_config.meshlet_cone_weight);
+
+        // trim the worst case allocation, triangle offsets are kept 4 byte aligned for gpu loads
+        const meshopt_Meshlet& last = meshlets[meshlet_count - 1];
+        cooked.meshlet_vertices.resize(last.vertex_offset + last.vertex_count);
+        cooked.meshlet_triangles.resize(last.triangle_offset + ((last.triangle_count * 3 + 3) & ~3u));
+
+        cooked.meshlets.resize(meshlet_count);
+        for (size_t i = 0; i < meshlet_count; ++i)
+        {
+            const meshopt_Meshlet& meshlet = meshlets[i];
+
+            meshopt_Bounds bounds = meshopt_computeMeshletBounds(&cooked.meshlet_vertices[meshlet.vertex_offset],
+                                                                 &cooked.meshlet_triangles[meshlet.triangle_offset],
+                                                                 meshlet.triangle_count,
+                                                                 positions,
+                                                                 vertices.size(),
+                                                                 sizeof(MeshVertex));
+
+            MeshletData& data    = cooked.meshlets[i];
+            data.vertex_offset   = meshlet.vertex_offset;
+            data.triangle_offset = meshlet.triangle_offset;
+            data.vertex_count    = meshlet.vertex_count;
+            data.triangle_count  = meshlet.triangle_count;
+            data.center          = Vector3(bounds.center);
+            data.radius          = bounds.radius;
+            data.cone_apex       = Vector3(bounds.cone_apex);
+            data.cone_axis       = Vector3(bounds.cone_axis);
+            data.cone_cutoff     = bounds.cone_cutoff;
+        }
+    }
+
+    float MeshOptimizer::computeScreenError(float error, float distance, float proj_scale, float viewport_height)
+    {
+        if (distance <= 0.0f)
+        {
+            return std::numeric_limits<float>::max();
+        }
+        return error / distance * proj_scale * viewport_height * 0.5f;
+    }
+} // namespace ArchViz
@@ -0,0 +1,78 @@
+#pragma once
+#include "runtime/resource/resource_manager/compiler/compiler.h"
+
+#include "runtime/resource/res_type/data/mesh_data.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ArchViz
+{
+    class WorkExecutor;
+
+    struct MeshOptimizeConfig
+    {
+        bool  vertex_cache {true};
+        bool  overdraw {true};
+        float overdraw_threshold {1.05f}; // allowed acmr degradation for overdraw reorder
+        bool  vertex_fetch {true};
+
+        uint32_t max_lod_count {4};
+        float    lod_ratio {0.5f};         // index count ratio between two lods
+        float    lod_target_error {0.05f}; // relative to mesh extent
+        uint32_t lod_min_index_count {384};
+
+        bool     meshlets {true};
+        uint32_t meshlet_max_vertices {64};
+        uint32_t meshlet_max_triangles {124}; // multiple of 4
+        float    meshlet_cone_weight {0.25f}; // favor tight normal cones over tight spheres
+    };
+
+    struct MeshOptimizeStatistics
+    {
+        // average cache miss ratio, transformed vertices per triangle
+        float acmr_before {0.0f};
+        float acmr_after {0.0f};
+        // average transformed vertices ratio, transformed vertices per vertex
+        float atvr_before {0.0f};
+        float atvr_after {0.0f};
+        // shaded pixels per covered pixel
+        float overdraw_before {0.0f};
+        float overdraw_after {0.0f};
+        // fetched bytes per vertex buffer byte
+        float overfetch_before {0.0f};
+        float overfetch_after {0.0f};
+
+        uint32_t vertex_count_before {0};
+        uint32_t vertex_count_after {0};
+    };
+
+    // offline mesh processing stage on top of meshoptimizer:
+    // duplicate removal, vertex cache, overdraw, vertex fetch reorder, a simplified lod chain and meshlets
+    class MeshOptimizer : public Compiler<MeshData, CookedMeshData>
+    {
+    public:
+        MeshOptimizer() = default;
+        explicit MeshOptimizer(const MeshOptimizeConfig& config) : m_config {config} {}
+        virtual ~MeshOptimizer() = default;
+
+        std::pair<std::shared_ptr<CookedMeshData>, size_t> compileResource(std::shared_ptr<MeshData> from) override;
+
+        // sub meshes are processed in parallel, statistics are optional
+        std::vector<std::shared_ptr<CookedMeshData>> compileResources(const std::vector<std::shared_ptr<MeshData>>& meshes,
+                                                                      std::shared_ptr<WorkExecutor>                 executor,
+                                                                      std::vector<MeshOptimizeStatistics>*          statistics = nullptr);
+
+        std::shared_ptr<CookedMeshData> optimize(const MeshData& mesh, MeshOptimizeStatistics* statistics = nullptr) const;
+
+        // split the full mesh into meshlets with bounds, replaces the existing ones
+        void buildMeshlets(CookedMeshData& cooked) const;
+
+        // projected size in pixels of a lod error at distance, proj_scale is projection(1, 1)
+        static float computeScreenError(float error, float distance, float proj_scale, float viewport_height);
+
+    public:
+        MeshOptimizeConfig m_config;
+    };
+} // namespace ArchViz
@@ -0,0 +1,204 @@
+#include "runtime/resource/resource_manager/compiler/mesh_quantizer.h"
+
+#include "runtime/core/base/macro.h"
+#include "runtime/core/math/pack.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace ArchViz
+{
+    namespace
+    {
+        constexpr int k_position_bits = 16;
+        constexpr int k_uv_bits       = 16;
+
+        float angle_degree(const Vector3& lhs, const float rhs[3])
+        {
+            float length = std::sqrt(lhs.x * lhs.x + lhs.y * lhs.y + lhs.z * lhs.z);
+            // zero vectors (missing attribute) have no direction to keep
+            if (length <= std::numeric_limits<float>::epsilon())
+            {
+                return 0.0f;
+            }
+
+            float dot = (lhs.x * rhs[0] + lhs.y * rhs[1] + lhs.z * rhs[2]) / length;
+            return std::acos(std::clamp(dot, -1.0f, 1.0f)) * 57.29577951f;
+        }
+    } // namespace
+
+    std::pair<std::shared_ptr<CompactMeshData>, size_t> MeshQuantizer::compileResource(std::shared_ptr<MeshData> from)
+    {
+        if (from == nullptr)
+        {
+            return {nullptr, 0};
+        }
+
+        if (!from->bind.empty())
+        {
+            LOG_WARN("compact mesh drops {} skeleton bindings", from->bind.size());
+        }
+
+        std::shared_ptr<CompactMeshData> compact = std::make_shared<CompactMeshData>();
+        quantize(*from, *compact);
+
+        return {compact, compact->vertexBytes() + compact->indexBytes()};
+    }
+
+    void MeshQuantizer::quantize(const MeshData& mesh, CompactMeshData& compact)
+    {
+        const size_t vertex_count = mesh.vertex_buffer.size();
+
+        compact.vertex_count = static_cast<uint32_t>(vertex_count);
+        compact.aabb_min     = Vector3(0.0f, 0.0f, 0.0f);
+        compact.aabb_max     = Vector3(0.0f, 0.0f, 0.0f);
+
+        bool uv_in_unit = true;
+        if (vertex_count > 0)
+        {
+            compact.aabb_min = mesh.vertex_buffer[0].postion;
+            compact.aabb_max = mesh.vertex_buffer[0].postion;
+        }
+        for (const auto& vertex : mesh.vertex_buffer)
+        {
+            for (size_t axis = 0; axis < 3; ++axis)
+            {
+                compact.aabb_min[axis] = std::min(compact.aabb_min[axis], vertex.postion[axis]);
+                compact.aabb_max[axis] = std::max(compact.aabb_max[axis], vertex.postion[axis]);
+            }
+            uv_in_unit = uv_in_unit && vertex.uv.x >= 0.0f && vertex.uv.x <= 1.0f && vertex.uv.y >= 0.0f && vertex.uv.y <= 1.0f;
+        }
+        compact.uv_format = uv_in_unit ? MeshUVFormat::Unorm16 : MeshUVFormat::Half;
+
+        float inv_extent[3];
+        for (size_t axis = 0; axis < 3; ++axis)
+        {
+            float extent     = compact.aabb_max[axis] - compact.aabb_min[axis];
+            inv_extent[axis] = extent > 0.0f ? 1.0f / extent : 0.0f;
+        }
+
+        compact.positions.resize(vertex_count * 4);
+        compact.frames.resize(vertex_count * 4);
+        compact.uvs.resize(vertex_count * 2);
+
+        for (size_t i = 0; i < vertex_count; ++i)
+        {
+            const MeshVertex& vertex = mesh.vertex_buffer[i];
+
+            uint16_t* position = &compact.positions[i * 4];
+            for (size_t axis = 0; axis < 3; ++axis)
+            {
+                float normalized = (vertex.postion[axis] - compact.aabb_min[axis]) * inv_extent[axis];
+                position[axis]   = static_cast<uint16_t>(quantize_unorm(normalized, k_position_bits));
+            }
+            position[3] = 0;
+
+            int8_t* frame = &compact.frames[i * 4];
+            octahedral_encode_snorm8(vertex.normal.ptr(), frame[0], frame[1]);
+            octahedral_encode_snorm8(vertex.tangent.ptr(), frame[2], frame[3]);
+
+            uint16_t* uv = &compact.uvs[i * 2];
+            if (compact.uv_format == MeshUVFormat::Unorm16)
+            {
+                uv[0] = static_cast<uint16_t>(quantize_unorm(vertex.uv.x, k_uv_bits));
+                uv[1] = static_cast<uint16_t>(quantize_unorm(vertex.uv.y, k_uv_bits));
+            }
+            else
+            {
+                uv[0] = float_to_half(vertex.uv.x);
+                uv[1] = float_to_half(vertex.uv.y);
+            }
+        }
+
+        compact.index_buffer_16.clear();
+        compact.index_buffer_32.clear();
+        if (vertex_count <= std::numeric_limits<uint16_t>::max() + size_t(1))
+        {
+            compact.index_type = MeshIndexType::Uint16;
+            compact.index_buffer_16.assign(mesh.index_buffer.begin(), mesh.index_buffer.end());
+        }
+        else
+        {
+            compact.index_type = MeshIndexType::Uint32;
+            compact.index_buffer_32.assign(mesh.index_buffer.begin(), mesh.index_buffer.end());
+        }
+    }
+
+    void MeshQuantizer::dequantize(const CompactMeshData& compact, MeshData& mesh)
+    {
+        const size_t vertex_count = compact.vertex_count;
+
+        const Vector3 extent = compact.aabb_max - compact.aabb_min;
+
+        mesh.vertex_buffer.resize(vertex_count);
+        for (size_t i = 0; i < vertex_count; ++i)
+        {
+            MeshVertex& vertex = mesh.vertex_buffer[i];
+
+            const uint16_t* position = &compact.positions[i * 4];
+            for (size_t axis = 0; axis < 3; ++axis)
+            {
+                vertex.postion[axis] = compact.aabb_min[axis] + dequantize_unorm(position[axis], k_position_bits) * extent[axis];
+            }
+
+            const int8_t* frame = &compact.frames[i * 4];
+            octahedral_decode_snorm8(frame[0], frame[1], vertex.normal.ptr());
+            octahedral_decode_snorm8(frame[2], frame[3], vertex.tangent.ptr());
+
+            const uint16_t* uv = &compact.uvs[i * 2];
+            if (compact.uv_format == MeshUVFormat::Unorm16)
+            {
+                vertex.uv = Vector2(dequantize_unorm(uv[0], k_uv_bits), dequantize_unorm(uv[1], k_uv_bits));
+            }
+            else
+            {
+                vertex.uv = Vector2(half_to_float(uv[0]), half_to_float(uv[1]));
+            }
+        }
+
+        if (compact.index_type == MeshIndexType::Uint16)
+        {
+            mesh.index_buffer.assign(compact.index_buffer_16.begin(), compact.index_buffer_16.end());
+        }
+        else
+        {
+            mesh.index_buffer.assign(compact.index_buffer_32.begin(), compact.index_buffer_32.end());
+        }
+        mesh.bind.clear();
+    }
+
+    MeshQuantizeError MeshQuantizer::measureError(const MeshData& mesh, const CompactMeshData& compact)
+    {
+        MeshQuantizeError error;
+
+        MeshData decoded;
+        dequantize(compact, decoded);
+
+        if (decoded.vertex_buffer.size() != mesh.vertex_buffer.size())
+        {
+            LOG_ERROR("compact mesh vertex count mismatch: {} vs {}", decoded.vertex_buffer.size(), mesh.vertex_buffer.size());
+            error.position = std::numeric_limits<float>::infinity();
+            return error;
+        }
+
+        for (size_t i = 0; i < mesh.vertex_buffer.size(); ++i)
+        {
+            const MeshVertex& source = mesh.vertex_buffer[i];
+            const MeshVertex& result = decoded.vertex_buffer[i];
+
+            for (size_t axis = 0; axis < 3; ++axis)
+            {
+                error.position = std::max(error.position, std::fabs(source.postion[axis] - result.postion[axis]));
+            }
+
+            error.normal_degree  = std::max(error.normal_degree, angle_degree(source.normal, result.normal.ptr()));
+            error.tangent_degree = std::max(error.tangent_degree, angle_degree(source.tangent, result.tangent.ptr()));
+
+            error.uv = std::max(error.uv, std::fabs(source.uv.x - result.uv.x));
+            error.uv = std::max(error.uv, std::fabs(source.uv.y - result.uv.y));
+        }
+
+        return error;
+    }
+} // namespace ArchViz
@@ -0,0 +1,39 @@
+#pragma once
+#include "runtime/resource/resource_manager/compiler/compiler.h"
+
+#include "runtime/resource/res_type/data/compact_mesh_data.h"
+#include "runtime/resource/res_type/data/mesh_data.h"
+
+#include <memory>
+
+namespace ArchViz
+{
+    struct MeshQuantizeError
+    {
+        float position {0.0f};      // max per axis, object space
+        float normal_degree {0.0f}; // max angle
+        float tangent_degree {0.0f};
+        float uv {0.0f}; // max per component
+    };
+
+    // MeshData <-> CompactMeshData
+    class MeshQuantizer : public Compiler<MeshData, CompactMeshData>
+    {
+    public:
+        virtual ~MeshQuantizer() = default;
+
+        std::pair<std::shared_ptr<CompactMeshData>, size_t> compileResource(std::shared_ptr<MeshData> from) override;
+
+        static void quantize(const MeshData& mesh, CompactMeshData& compact);
+        static void dequantize(const CompactMeshData& compact, MeshData& mesh);
+
+        // worst case error of the compact mesh against its source
+        static MeshQuantizeError measureError(const MeshData& mesh, const CompactMeshData& compact);
+
+        // theoretical bound of the position error for an aabb extent
+        static float positionErrorBound(float extent) { return extent / 65535.0f * 0.5f; }
+
+        // 8 bit octahedral encoding with neighbour search
+        static constexpr float k_frame_error_bound_degree = 0.7f;
+    };
+} // namespace ArchViz
@@ -0,0 +1,380 @@
+#include "runtime/resource/resource_manager/compiler/texture_atlas.h"
+#include "runtime/resource/resource_manager/compiler/texture_cooker.h"
+
+#include "runtime/core/base/macro.h"
+#include "runtime/core/thread/work_executor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+namespace ArchViz
+{
+    namespace
+    {
+        struct SkylineNode
+        {
+            uint32_t x {0};
+            uint32_t y {0};
+            uint32_t width {0};
+        };
+
+        struct AtlasPage
+        {
+            std::vector<SkylineNode> skyline;
+        };
+
+        uint32_t align_up(uint32_t value, uint32_t alignment) { return (value + alignment - 1) / alignment * alignment; }
+
+        uint32_t next_power_of_two(uint32_t value)
+        {
+            uint32_t result = 1;
+            while (result < value)
+            {
+                result <<= 1;
+            }
+            return result;
+        }
+
+        // lowest y at which a width x height rect starting at node index rests on the skyline
+        bool skyline_fit(const std::vector<SkylineNode>& skyline, size_t index, uint32_t width, uint32_t height, uint32_t page_size, uint32_t& y)
+        {
+            if (skyline[index].x + width > page_size)
+            {
+                return false;
+            }
+
+            uint32_t remaining = width;
+            y                  = 0;
+            for (size_t i = index; remaining > 0; ++i)
+            {
+                y = std::max(y, skyline[i].y);
+                if (y + height > page_size)
+                {
+                    return false;
+                }
+                remaining -= std::min(remaining, skyline[i].width);
+            }
+            return true;
+        }
+
+        void skyline_insert(std::vector<SkylineNode>& skyline, size_t index, uint32_t y, uint32_t width, uint32_t height)
+        {
+            SkylineNode node {skyline[index].x, y + height, width};
+            skyline.insert(skyline.begin() + index, node);
+
+            // the new node covers the start of the following ones
+            const uint32_t end = node.x + node.width;
+            for (size_t i = index + 1; i < skyline.size();)
+            {
+                if (skyline[i].x >= end)
+                {
+                    break;
+                }
+                uint32_t shrink = end - skyline[i].x;
+                if (skyline[i].width <= shrink)
+                {
+                    skyline.erase(skyline.begin() + i);
+                    continue;
+                }
+                skyline[i].x += shrink;
+                skyline[i].width -= shrink;
+                break;
+            }
+
+            for (size_t i = 0; i + 1 < skyline.size();)
+            {
+                if (skyline[i].y == skyline[i + 1].y)
+                {
+                    skyline[i].width += skyline[i + 1].width;
+                    skyline.erase(skyline.begin() + i + 1);
+                }
+                else
+                {
+                    ++i;
+                }
+            }
+        }
+
+        // bottom left: the position with the lowest top edge, then the leftmost
+        bool skyline_place(std::vector<SkylineNode>& skyline, uint32_t width, uint32_t height, uint32_t page_size, uint32_t& x, uint32_t& y)
+        {
+            size_t   best_index = skyline.size();
+            uint32_t best_top   = UINT32_MAX;
+            uint32_t best_y     = 0;
+            for (size_t i = 0; i < skyline.size(); ++i)
+            {
+                uint32_t fit_y;
+                if (skyline_fit(skyline, i, width, height, page_size, fit_y) && fit_y + height < best_top)
+                {
+                    best_index = i;
+                    best_top   = fit_y + height;
+                    best_y     = fit_y;
+                }
+            }
+            if (best_index == skyline.size())
+            {
+                return false;
+            }
+
+            x = skyline[best_index].x;
+            y = best_y;
+            skyline_insert(skyline, best_index, best_y, width, height);
+            return true;
+        }
+
+        uint32_t border_texel(int32_t coord, uint32_t size, bool wrap)
+        {
+            int32_t extent = static_cast<int32_t>(size);
+            if (wrap)
+            {
+                return static_cast<uint32_t>((coord % extent + extent) % extent);
+            }
+            return static_cast<uint32_t>(std::clamp(coord, 0, extent - 1));
+        }
+    } // namespace
+
+    TextureAtlasPacker::TextureAtlasPacker(const TextureAtlasConfig& config) : m_config(config) {}
+
+    uint32_t TextureAtlasPacker::alignment() const
+    {
+        // 4 keeps block compression of a page from mixing entries
+        uint32_t levels = std::max(m_config.mip_levels, 1u);
+        return std::max(1u << (levels - 1), 4u);
+    }
+
+    uint32_t TextureAtlasPacker::padding() const { return align_up(m_config.padding, alignment()); }
+
+    std::vector<AtlasPlacement> TextureAtlasPacker::pack(const std::vector<std::pair<uint32_t, uint32_t>>& sizes)
+    {
+        const uint32_t page_size = m_config.atlas_size;
+        const uint32_t align     = alignment();
+        const uint32_t pad       = padding();
+
+        std::vector<AtlasPlacement> placements(sizes.size());
+        m_pages.clear();
+
+        std::vector<uint32_t> order(sizes.size());
+        std::iota(order.begin(), order.end(), 0u);
+        std::stable_sort(order.begin(), order.end(), [&sizes](uint32_t lhs, uint32_t rhs) {
+            if (sizes[lhs].second != sizes[rhs].second)
+            {
+                return sizes[lhs].second > sizes[rhs].second;
+            }
+            return sizes[lhs].first > sizes[rhs].first;
+        });
+
+        std::vector<AtlasPage> pages;
+        for (uint32_t index : order)
+        {
+            const uint32_t width  = sizes[index].first;
+            const uint32_t height = sizes[index].second;
+            if (width == 0 || height == 0 || std::max(width, height) > m_config.max_entry_size)
+            {
+                continue;
+            }
+
+            const uint32_t slot_width  = align_up(width, align) + 2 * pad;
+            const uint32_t slot_height = align_up(height, align) + 2 * pad;
+            if (slot_width > page_size || slot_height > page_size)
+            {
+                continue;
+            }
+
+            uint32_t x, y;
+            uint32_t page = 0;
+            for (; page < pages.size(); ++page)
+            {
+                if (skyline_place(pages[page].skyline, slot_width, slot_height, page_size, x, y))
+                {
+                    break;
+                }
+            }
+            if (page == pages.size())
+            {
+                AtlasPage& created = pages.emplace_back();
+                created.skyline.push_back({0, 0, page_size});
+                m_pages.emplace_back();
+                skyline_place(created.skyline, slot_width, slot_height, page_size, x, y);
+            }
+
+            AtlasPlacement& placement = placements[index];
+            placement.atlas           = page;
+            placement.x               = x + pad;
+            placement.y               = y + pad;
+            placement.width           = width;
+            placement.height          = height;
+
+            AtlasPageInfo& info = m_pages[page];
+            info.width          = page_size;
+            info.height         = std::max(info.height, y + slot_height);
+            info.entry_count += 1;
+            info.used_texels += static_cast<uint64_t>(width) * height;
+        }
+
+        for (auto& info : m_pages)
+        {
+            info.height = std::min(next_power_of_two(info.height), page_size);
+        }
+
+        for (auto& placement : placements)
+        {
+            if (!placement.placed())
+            {
+                continue;
+            }
+            const AtlasPageInfo& info = m_pages[placement.atlas];
+            const float          w    = static_cast<float>(info.width);
+            const float          h    = static_cast<float>(info.height);
+            placement.uv_scale_bias   = FVector4(placement.width / w, placement.height / h, placement.x / w, placement.y / h);
+        }
+
+        return placements;
+    }
+
+    std::vector<std::shared_ptr<TextureData>> TextureAtlasPacker::build(const std::vector<std::shared_ptr<TextureData>>& textures, const std::vector<AtlasPlacement>& placements,
+                                                                        std::shared_ptr<WorkExecutor> executor) const
+    {
+        std::vector<std::shared_ptr<TextureData>> atlases;
+        if (textures.size() != placements.size())
+        {
+            LOG_ERROR("atlas build got {} textures for {} placements", textures.size(), placements.size());
+            return atlases;
+        }
+
+        const uint32_t align = alignment();
+        const uint32_t pad   = padding();
+
+        for (size_t page = 0; page < m_pages.size(); ++page)
+        {
+            const AtlasPageInfo& info  = m_pages[page];
+            auto                 atlas = std::make_shared<TextureData>();
+            atlas->m_width             = static_cast<int32_t>(info.width);
+            atlas->m_height            = static_cast<int32_t>(info.height);
+            atlas->m_channel           = 4;
+            atlas->m_format            = TextureFormat::RGBA8;
+            atlas->m_uri               = "atlas_" + std::to_string(page);
+
+            const uint32_t max_levels = static_cast<uint32_t>(std::log2(std::max(info.width, info.height))) + 1;
+            const uint32_t levels     = std::min(std::max(m_config.mip_levels, 1u), max_levels);
+            size_t         offset     = 0;
+            for (uint32_t level = 0; level < levels; ++level)
+            {
+                TextureLevel level_info;
+                level_info.offset = offset;
+                level_info.width  = std::max(info.width >> level, 1u);
+                level_info.height = std::max(info.height >> level, 1u);
+                level_info.size   = static_cast<size_t>(level_info.width) * level_info.height * 4;
+                offset += level_info.size;
+                atlas->m_levels.push_back(level_info);
+            }
+            atlas->m_data.assign(offset, 0);
+            atlases.push_back(atlas);
+        }
+
+        // an atlas is either all srgb or all linear, pack colour and data textures separately
+        std::vector<bool> page_srgb_set(atlases.size(), false);
+        for (size_t i = 0; i < placements.size(); ++i)
+        {
+            if (!placements[i].placed() || textures[i] == nullptr)
+            {
+                continue;
+            }
+            auto& atlas = atlases[placements[i].atlas];
+            if (!page_srgb_set[placements[i].atlas])
+            {
+                atlas->m_srgb                      = textures[i]->m_srgb;
+                page_srgb_set[placements[i].atlas] = true;
+            }
+            else if (atlas->m_srgb != textures[i]->m_srgb)
+            {
+                LOG_WARN("atlas {} mixes srgb and linear textures, {} is sampled as {}", placements[i].atlas, textures[i]->m_uri, atlas->m_srgb ? "srgb" : "linear");
+            }
+        }
+
+        TextureCookConfig mip_config;
+        mip_config.wrap = m_config.wrap;
+
+        // every entry writes only its own slot, borders included
+        parallel_for(executor, static_cast<uint32_t>(placements.size()), 16, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                const AtlasPlacement& placement = placements[i];
+                if (!placement.placed() || textures[i] == nullptr)
+                {
+                    continue;
+                }
+
+                const TextureData* source = textures[i].get();
+                if (source->m_format != TextureFormat::RGBA8 || source->m_width != static_cast<int32_t>(placement.width) ||
+                    source->m_height != static_cast<int32_t>(placement.height))
+                {
+                    LOG_ERROR("texture {} does not match its atlas placement or is not rgba8", source->m_uri);
+                    continue;
+                }
+
+                TextureData& atlas = *atlases[placement.atlas];
+
+                // levels are copied from the entry's own chain, never filtered across the atlas
+                TextureData with_mips;
+                if (source->mipLevels() < atlas.mipLevels() && std::max(source->m_width, source->m_height) > 1)
+                {
+                    with_mips = *source;
+                    if (!source->m_levels.empty())
+                    {
+                        with_mips.m_data.resize(source->m_levels[0].size);
+                    }
+                    TextureCooker::generateMips(with_mips, mip_config, nullptr);
+                    source = &with_mips;
+                }
+
+                for (uint32_t level = 0; level < atlas.mipLevels(); ++level)
+                {
+                    const uint32_t     source_level = std::min(level, source->mipLevels() - 1);
+                    const uint8_t*     src          = source->m_data.data();
+                    uint32_t           src_width    = static_cast<uint32_t>(source->m_width);
+                    uint32_t           src_height   = static_cast<uint32_t>(source->m_height);
+                    const TextureLevel dst_level    = atlas.m_levels[level];
+                    if (!source->m_levels.empty())
+                    {
+                        src += source->m_levels[source_level].offset;
+                        src_width  = source->m_levels[source_level].width;
+                        src_height = source->m_levels[source_level].height;
+                    }
+
+                    // the slot at this level: aligned content plus the border, all shifts are exact
+                    const int32_t border      = static_cast<int32_t>(pad >> level);
+                    const int32_t origin_x    = static_cast<int32_t>(placement.x >> level);
+                    const int32_t origin_y    = static_cast<int32_t>(placement.y >> level);
+                    const int32_t slot_width  = static_cast<int32_t>(align_up(placement.width, align) >> level);
+                    const int32_t slot_height = static_cast<int32_t>(align_up(placement.height, align) >> level);
+
+                    uint8_t* dst = atlas.m_data.data() + dst_level.offset;
+                    for (int32_t y = -border; y < slot_height + border; ++y)
+                    {
+                        const uint32_t sy      = border_texel(y, src_height, m_config.wrap);
+                        uint8_t*       row     = dst + (static_cast<size_t>(origin_y + y) * dst_level.width + origin_x) * 4;
+                        const uint8_t* src_row = src + static_cast<size_t>(sy) * src_width * 4;
+                        if (y >= 0 && y < static_cast<int32_t>(src_height))
+                        {
+                            std::memcpy(row, src_row, static_cast<size_t>(src_width) * 4);
+                        }
+                        for (int32_t x = -border; x < slot_width + border; ++x)
+                        {
+                            if (x >= 0 && x < static_cast<int32_t>(src_width) && y >= 0 && y < static_cast<int32_t>(src_height))
+                            {
+                                x = static_cast<int32_t>(src_width) - 1;
+                                continue;
+                            }
+                            const uint32_t sx = border_texel(x, src_width, m_config.wrap);
+                            std::memcpy(row + static_cast<ptrdiff_t>(x) * 4, src_row + sx * 4, 4);
+                        }
+                    }
+                }
+            }
+        });
+
+        return atlases;
+    }
+} // namespace ArchViz
@@ -0,0 +1,75 @@
+#pragma once
+#include "runtime/core/math/math_type.h"
+
+#include "runtime/resource/res_type/data/material_data.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ArchViz
+{
+    class WorkExecutor;
+
+    struct TextureAtlasConfig
+    {
+        uint32_t atlas_size {4096};    // width of a page, pages are trimmed in height to the next power of two
+        uint32_t max_entry_size {512}; // larger textures stay standalone (or go to virtual texturing)
+        uint32_t padding {8};          // border texels around every entry at level 0, rounded up to the alignment
+        uint32_t mip_levels {4};       // levels of every page, entries are aligned to 1 << (mip_levels - 1) texels
+        bool     wrap {true};          // borders repeat the opposite edge for tiling textures, clamp otherwise
+    };
+
+    struct AtlasPlacement
+    {
+        static constexpr uint32_t k_unplaced = UINT32_MAX;
+
+        uint32_t atlas {k_unplaced};
+        uint32_t x {0}; // of the texture at level 0, the border starts padding texels before
+        uint32_t y {0};
+        uint32_t width {0};
+        uint32_t height {0};
+
+        // uv in the atlas = uv * scale + bias, tiling textures wrap uv with fract() first
+        FVector4 uv_scale_bias {FVector4::Zero()};
+
+        bool placed() const { return atlas != k_unplaced; }
+    };
+
+    struct AtlasPageInfo
+    {
+        uint32_t width {0};
+        uint32_t height {0};
+        uint32_t entry_count {0};
+        uint64_t used_texels {0}; // texels of the entries, borders excluded
+    };
+
+    // packs many small textures into a few rgba8 atlas pages so they share one texture and descriptor
+    // skyline bottom left, tallest first; every entry is surrounded by a border of its own edge texels and
+    // its mips are copied from its own chain, so filtering and mipmapping never pick up a neighbour
+    class TextureAtlasPacker
+    {
+    public:
+        TextureAtlasPacker() = default;
+        explicit TextureAtlasPacker(const TextureAtlasConfig& config);
+
+        // placements follow the order of sizes, entries too large for max_entry_size stay unplaced
+        std::vector<AtlasPlacement> pack(const std::vector<std::pair<uint32_t, uint32_t>>& sizes);
+
+        // copies every placed texture into its page, textures must be rgba8, missing mips are generated
+        std::vector<std::shared_ptr<TextureData>> build(const std::vector<std::shared_ptr<TextureData>>& textures, const std::vector<AtlasPlacement>& placements,
+                                                        std::shared_ptr<WorkExecutor> executor) const;
+
+        const std::vector<AtlasPageInfo>& pages() const { return m_pages; }
+
+        // border texels at level 0 and the alignment of every entry
+        uint32_t padding() const;
+        uint32_t alignment() const;
+
+    public:
+        TextureAtlasConfig m_config;
+
+    private:
+        std::vector<AtlasPageInfo> m_pages;
+    };
+} // namespace ArchViz
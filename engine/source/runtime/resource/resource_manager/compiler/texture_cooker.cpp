@@ -0,0 +1,494 @@
+#include "runtime/resource/resource_manager/compiler/texture_cooker.h"
+#include "runtime/resource/resource_manager/compiler/bc_codec.h"
+
+#include "runtime/core/base/hash.h"
+#include "runtime/core/base/macro.h"
+#include "runtime/core/thread/work_executor.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64)
+#include <xmmintrin.h>
+#define ARCHVIZ_TEXTURE_SSE
+#endif
+
+namespace ArchViz
+{
+    namespace
+    {
+        constexpr float k_kaiser_alpha   = 4.0f;
+        constexpr float k_kaiser_support = 3.0f; // in destination pixels
+
+        struct LinearImage
+        {
+            uint32_t           width {0};
+            uint32_t           height {0};
+            std::vector<float> pixels; // rgba
+        };
+
+        // sparse filter weights of one axis, taps of destination i are [offsets[i], offsets[i + 1])
+        struct FilterTaps
+        {
+            std::vector<uint32_t> offsets;
+            std::vector<uint32_t> indices;
+            std::vector<float>    weights;
+        };
+
+        const std::array<float, 256>& srgb_to_linear_table()
+        {
+            static const std::array<float, 256> table = []() {
+                std::array<float, 256> result;
+                for (size_t i = 0; i < result.size(); ++i)
+                {
+                    float c   = static_cast<float>(i) / 255.0f;
+                    result[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+                }
+                return result;
+            }();
+            return table;
+        }
+
+        // 16 bit linear input keeps the dark end of the srgb curve exact at 8 bit
+        const std::vector<uint8_t>& linear_to_srgb_table()
+        {
+            static const std::vector<uint8_t> table = []() {
+                std::vector<uint8_t> result(65536);
+                for (size_t i = 0; i < result.size(); ++i)
+                {
+                    float c   = static_cast<float>(i) / 65535.0f;
+                    float s   = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+                    result[i] = static_cast<uint8_t>(std::clamp(s, 0.0f, 1.0f) * 255.0f + 0.5f);
+                }
+                return result;
+            }();
+            return table;
+        }
+
+        float bessel_i0(float x)
+        {
+            float sum  = 1.0f;
+            float term = 1.0f;
+            for (int k = 1; k < 32; ++k)
+            {
+                float t = x / (2.0f * static_cast<float>(k));
+                term *= t * t;
+                sum += term;
+                if (term < sum * 1e-8f)
+                {
+                    break;
+                }
+            }
+            return sum;
+        }
+
+        float evaluate_filter(TextureMipFilter filter, float x)
+        {
+            x = std::fabs(x);
+            if (filter == TextureMipFilter::Box)
+            {
+                return x <= 0.5f ? 1.0f : 0.0f;
+            }
+
+            if (x >= k_kaiser_support)
+            {
+                return 0.0f;
+            }
+
+            float px     = 3.14159265f * x;
+            float sinc   = x < 1e-4f ? 1.0f : std::sin(px) / px;
+            float ratio  = x / k_kaiser_support;
+            float window = bessel_i0(k_kaiser_alpha * std::sqrt(1.0f - ratio * ratio)) / bessel_i0(k_kaiser_alpha);
+            return sinc * window;
+        }
+
+        FilterTaps build_taps(uint32_t source_size, uint32_t target_size, TextureMipFilter filter, bool wrap)
+        {
+            const float scale   = static_cast<float>(source_size) / static_cast<float>(target_size);
+            const float support = (filter == TextureMipFilter::Box ? 0.5f : k_kaiser_support) * scale;
+
+            FilterTaps taps;
+            taps.offsets.reserve(target_size + 1);
+            taps.offsets.push_back(0);
+
+            for (uint32_t i = 0; i < target_size; ++i)
+            {
+                float center = (static_cast<float>(i) + 0.5f) * scale;
+
+                int32_t first = static_cast<int32_t>(std::floor(center - support));
+                int32_t last  = static_cast<int32_t>(std::ceil(center + support));
+
+                size_t begin = taps.weights.size();
+                float  total = 0.0f;
+                for (int32_t s = first; s <= last; ++s)
+                {
+                    float weight = evaluate_filter(filter, (static_cast<float>(s) + 0.5f - center) / scale);
+                    if (weight == 0.0f)
+                    {
+                        continue;
+                    }
+
+                    int32_t index = s;
+                    if (wrap)
+                    {
+                        index %= static_cast<int32_t>(source_size);
+                        index += index < 0 ? static_cast<int32_t>(source_size) : 0;
+                    }
+                    else
+                    {
+                        index = std::clamp(index, 0, static_cast<int32_t>(source_size) - 1);
+                    }
+
+                    taps.indices.push_back(static_cast<uint32_t>(index));
+                    taps.weights.push_back(weight);
+                    total += weight;
+                }
+
+                // never leave a destination pixel without source, fall back to the nearest texel
+                if (total == 0.0f)
+                {
+                    taps.indices.push_back(std::min(static_cast<uint32_t>(center), source_size - 1));
+                    taps.weights.push_back(1.0f);
+                    total = 1.0f;
+                }
+
+                for (size_t t = begin; t < taps.weights.size(); ++t)
+                {
+                    taps.weights[t] /= total;
+                }
+                taps.offsets.push_back(static_cast<uint32_t>(taps.weights.size()));
+            }
+            return taps;
+        }
+
+        // dst (4 floats) = sum of weight * src pixel
+        inline void accumulate_pixel(float* dst, const float* src, const uint32_t* indices, const float* weights, uint32_t count, size_t stride)
+        {
+#ifdef ARCHVIZ_TEXTURE_SSE
+            __m128 sum = _mm_setzero_ps();
+            for (uint32_t t = 0; t < count; ++t)
+            {
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[t]), _mm_loadu_ps(src + indices[t] * stride)));
+            }
+            _mm_storeu_ps(dst, sum);
+#else
+            float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            for (uint32_t t = 0; t < count; ++t)
+            {
+                const float* pixel = src + indices[t] * stride;
+                for (int c = 0; c < 4; ++c)
+                {
+                    sum[c] += weights[t] * pixel[c];
+                }
+            }
+            std::memcpy(dst, sum, sizeof(sum));
+#endif
+        }
+
+        // dst row += weight * src row, count floats
+        inline void accumulate_row(float* dst, const float* src, float weight, size_t count)
+        {
+            size_t i = 0;
+#ifdef ARCHVIZ_TEXTURE_SSE
+            __m128 w = _mm_set1_ps(weight);
+            for (; i + 4 <= count; i += 4)
+            {
+                _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(w, _mm_loadu_ps(src + i))));
+            }
+#endif
+            for (; i < count; ++i)
+            {
+                dst[i] += weight * src[i];
+            }
+        }
+
+        // filtered normals are shorter than unit length, renormalize before encoding
+        inline void normalize_pixel(float* pixel)
+        {
+            float x      = pixel[0] * 2.0f - 1.0f;
+            float y      = pixel[1] * 2.0f - 1.0f;
+            float z      = pixel[2] * 2.0f - 1.0f;
+            float length = std::sqrt(x * x + y * y + z * z);
+            if (length > 1e-6f)
+            {
+                pixel[0] = x / length * 0.5f + 0.5f;
+                pixel[1] = y / length * 0.5f + 0.5f;
+                pixel[2] = z / length * 0.5f + 0.5f;
+            }
+        }
+
+        void encode_row(float* src, uint8_t* dst, uint32_t width, bool srgb, bool normal)
+        {
+            const std::vector<uint8_t>& table = linear_to_srgb_table();
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                if (normal)
+                {
+                    normalize_pixel(src + x * 4);
+                }
+                for (int c = 0; c < 4; ++c)
+                {
+                    float value = std::clamp(src[x * 4 + c], 0.0f, 1.0f);
+                    if (srgb && c < 3)
+                    {
+                        dst[x * 4 + c] = table[static_cast<size_t>(value * 65535.0f + 0.5f)];
+                    }
+                    else
+                    {
+                        dst[x * 4 + c] = static_cast<uint8_t>(value * 255.0f + 0.5f);
+                    }
+                }
+            }
+        }
+
+        void decode_image(const uint8_t* src, LinearImage& image, bool srgb, uint32_t tile_rows, const std::shared_ptr<WorkExecutor>& executor)
+        {
+            const std::array<float, 256>& table = srgb_to_linear_table();
+
+            image.pixels.resize(static_cast<size_t>(image.width) * image.height * 4);
+            parallel_for(executor, image.height, tile_rows, [&](uint32_t begin, uint32_t end) {
+                size_t first = static_cast<size_t>(begin) * image.width * 4;
+                size_t last  = static_cast<size_t>(end) * image.width * 4;
+                for (size_t i = first; i < last; ++i)
+                {
+                    bool color      = srgb && (i & 3) != 3;
+                    image.pixels[i] = color ? table[src[i]] : static_cast<float>(src[i]) / 255.0f;
+                }
+            });
+        }
+
+        // separable resample of source into target, the rgba8 encoding of target is written to encoded
+        void downsample(const LinearImage&                   source,
+                        LinearImage&                         target,
+                        uint8_t*                             encoded,
+                        bool                                 srgb,
+                        const TextureCookConfig&             config,
+                        const std::shared_ptr<WorkExecutor>& executor)
+        {
+            FilterTaps taps_x = build_taps(source.width, target.width, config.mip_filter, config.wrap);
+            FilterTaps taps_y = build_taps(source.height, target.height, config.mip_filter, config.wrap);
+
+            // horizontal pass, target width x source height
+            std::vector<float> horizontal(static_cast<size_t>(target.width) * source.height * 4);
+            parallel_for(executor, source.height, config.tile_rows, [&](uint32_t begin, uint32_t end) {
+                for (uint32_t y = begin; y < end; ++y)
+                {
+                    const float* src_row = &source.pixels[static_cast<size_t>(y) * source.width * 4];
+                    float*       dst_row = &horizontal[static_cast<size_t>(y) * target.width * 4];
+                    for (uint32_t x = 0; x < target.width; ++x)
+                    {
+                        uint32_t offset = taps_x.offsets[x];
+                        accumulate_pixel(dst_row + x * 4, src_row, &taps_x.indices[offset], &taps_x.weights[offset], taps_x.offsets[x + 1] - offset, 4);
+                    }
+                }
+            });
+
+            // vertical pass, whole rows at once
+            const size_t row_floats = static_cast<size_t>(target.width) * 4;
+            target.pixels.assign(row_floats * target.height, 0.0f);
+            parallel_for(executor, target.height, config.tile_rows, [&](uint32_t begin, uint32_t end) {
+                for (uint32_t y = begin; y < end; ++y)
+                {
+                    float* dst_row = &target.pixels[y * row_floats];
+                    for (uint32_t t = taps_y.offsets[y]; t < taps_y.offsets[y + 1]; ++t)
+                    {
+                        accumulate_row(dst_row, &horizontal[taps_y.indices[t] * row_floats], taps_y.weights[t], row_floats);
+                    }
+                    encode_row(dst_row, encoded + y * row_floats, target.width, srgb, config.role == TextureRole::Normal);
+                }
+            });
+        }
+    } // namespace
+
+    TextureCooker::TextureCooker(std::shared_ptr<WorkExecutor> executor) : m_executor {std::move(executor)} {}
+
+    TextureCooker::TextureCooker(const TextureCookConfig& config, std::shared_ptr<WorkExecutor> executor) : m_config {config}, m_executor {std::move(executor)} {}
+
+    std::pair<std::shared_ptr<TextureData>, size_t> TextureCooker::compileResource(std::shared_ptr<TextureData> from)
+    {
+        if (from == nullptr)
+        {
+            return {nullptr, 0};
+        }
+
+        std::shared_ptr<TextureData> cooked = cook(*from, m_executor);
+        return {cooked, cooked->m_data.size()};
+    }
+
+    std::shared_ptr<TextureData> TextureCooker::cook(const TextureData& texture, std::shared_ptr<WorkExecutor> executor) const
+    {
+        std::shared_ptr<TextureData> cooked = std::make_shared<TextureData>(texture);
+        if (cooked->m_format != TextureFormat::RGBA8)
+        {
+            return cooked; // already cooked
+        }
+
+        cooked->m_srgb = m_config.role == TextureRole::Albedo;
+        if (m_config.generate_mips)
+        {
+            generateMips(*cooked, m_config, executor);
+        }
+        if (m_config.compress)
+        {
+            compress(*cooked, selectFormat(m_config.role, hasAlpha(*cooked), m_config), executor);
+        }
+        return cooked;
+    }
+
+    void TextureCooker::generateMips(TextureData& texture, const TextureCookConfig& config, std::shared_ptr<WorkExecutor> executor)
+    {
+        if (texture.m_width <= 0 || texture.m_height <= 0)
+        {
+            return;
+        }
+        if (texture.m_format != TextureFormat::RGBA8)
+        {
+            LOG_ERROR("texture {} is already compressed, mips are built from rgba8", texture.m_uri);
+            return;
+        }
+
+        const size_t base_size = static_cast<size_t>(texture.m_width) * texture.m_height * 4;
+        if (texture.m_data.size() < base_size)
+        {
+            LOG_ERROR("texture {} data is smaller than rgba8 {}x{}", texture.m_uri, texture.m_width, texture.m_height);
+            return;
+        }
+
+        uint32_t width       = static_cast<uint32_t>(texture.m_width);
+        uint32_t height      = static_cast<uint32_t>(texture.m_height);
+        uint32_t level_count = static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1;
+
+        texture.m_levels.clear();
+        texture.m_levels.reserve(level_count);
+
+        size_t total_size = 0;
+        for (uint32_t level = 0; level < level_count; ++level)
+        {
+            TextureLevel info;
+            info.offset = total_size;
+            info.width  = std::max(width >> level, 1u);
+            info.height = std::max(height >> level, 1u);
+            info.size   = static_cast<size_t>(info.width) * info.height * 4;
+            total_size += info.size;
+            texture.m_levels.push_back(info);
+        }
+
+        // level 0 keeps the source bytes untouched
+        texture.m_data.resize(total_size);
+
+        LinearImage source;
+        source.width  = width;
+        source.height = height;
+        decode_image(texture.m_data.data(), source, texture.m_srgb, config.tile_rows, executor);
+
+        for (uint32_t level = 1; level < level_count; ++level)
+        {
+            const TextureLevel& info = texture.m_levels[level];
+
+            LinearImage target;
+            target.width  = info.width;
+            target.height = info.height;
+            downsample(source, target, texture.m_data.data() + info.offset, texture.m_srgb, config, executor);
+
+            source = std::move(target);
+        }
+    }
+
+    TextureFormat TextureCooker::selectFormat(TextureRole role, bool has_alpha, const TextureCookConfig& config)
+    {
+        switch (role)
+        {
+            case TextureRole::Albedo:
+                if (config.albedo_bc7)
+                {
+                    return TextureFormat::BC7;
+                }
+                return has_alpha ? TextureFormat::BC3 : TextureFormat::BC1;
+            case TextureRole::Normal:
+                return TextureFormat::BC5;
+            case TextureRole::Mask:
+                return TextureFormat::BC4;
+            default:
+                return TextureFormat::BC7;
+        }
+    }
+
+    size_t TextureCooker::configHash(const TextureCookConfig& config)
+    {
+        size_t seed = 0;
+        hash_combine(seed,
+                     config.generate_mips,
+                     static_cast<uint32_t>(config.mip_filter),
+                     config.wrap,
+                     static_cast<uint32_t>(config.role),
+                     config.compress,
+                     config.albedo_bc7);
+        return seed;
+    }
+
+    void TextureCooker::compress(TextureData& texture, TextureFormat format, std::shared_ptr<WorkExecutor> executor)
+    {
+        if (texture.m_format != TextureFormat::RGBA8 || !texture_format_compressed(format) || texture.m_width <= 0 || texture.m_height <= 0)
+        {
+            return;
+        }
+
+        std::vector<TextureLevel> levels = texture.m_levels;
+        if (levels.empty())
+        {
+            TextureLevel level;
+            level.width  = static_cast<uint32_t>(texture.m_width);
+            level.height = static_cast<uint32_t>(texture.m_height);
+            level.size   = static_cast<size_t>(level.width) * level.height * 4;
+            levels.push_back(level);
+        }
+
+        std::vector<TextureLevel> compressed_levels;
+        compressed_levels.reserve(levels.size());
+
+        size_t total_size = 0;
+        for (const auto& level : levels)
+        {
+            TextureLevel info = level;
+            info.offset       = total_size;
+            info.size         = texture_level_size(format, level.width, level.height);
+            total_size += info.size;
+            compressed_levels.push_back(info);
+        }
+
+        std::vector<uint8_t> compressed(total_size);
+        for (size_t i = 0; i < levels.size(); ++i)
+        {
+            BCCodec::encodeImage(format, texture.m_data.data() + levels[i].offset, levels[i].width, levels[i].height, compressed.data() + compressed_levels[i].offset, executor);
+        }
+
+        texture.m_data   = std::move(compressed);
+        texture.m_format = format;
+        if (texture.m_levels.empty())
+        {
+            compressed_levels.clear();
+        }
+        texture.m_levels = std::move(compressed_levels);
+    }
+
+    bool TextureCooker::hasAlpha(const TextureData& texture)
+    {
+        if (texture.m_format != TextureFormat::RGBA8)
+        {
+            return false;
+        }
+
+        const size_t base_size = std::min(texture.m_data.size(), static_cast<size_t>(std::max(texture.m_width, 0)) * std::max(texture.m_height, 0) * 4);
+        for (size_t i = 3; i < base_size; i += 4)
+        {
+            if (texture.m_data[i] != 255)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+} // namespace ArchViz
@@ -0,0 +1,66 @@
+#pragma once
+#include "runtime/resource/resource_manager/compiler/compiler.h"
+
+#include "runtime/resource/res_type/data/material_data.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace ArchViz
+{
+    class WorkExecutor;
+
+    enum class TextureMipFilter : uint8_t
+    {
+        Box,    // 2x2 average, fastest
+        Kaiser, // kaiser windowed sinc, keeps more detail in the small mips
+    };
+
+    struct TextureCookConfig
+    {
+        bool             generate_mips {true};
+        TextureMipFilter mip_filter {TextureMipFilter::Kaiser};
+        bool             wrap {true};    // filter across the edges for tiling textures, clamp otherwise
+        uint32_t         tile_rows {32}; // rows per job
+
+        TextureRole role {TextureRole::Albedo};
+        bool        compress {true};   // block compress every level, the format follows the role
+        bool        albedo_bc7 {true}; // bc7 for albedo, bc1 / bc3 otherwise (smaller and faster to encode, lower quality)
+    };
+
+    // cpu texture processing on rgba8 data:
+    // the mip chain is filtered in linear space (srgb decoded when TextureData::m_srgb) and written back as rgba8,
+    // then every level is block compressed in the format picked by the texture role
+    class TextureCooker : public Compiler<TextureData, TextureData>
+    {
+    public:
+        explicit TextureCooker(std::shared_ptr<WorkExecutor> executor = nullptr);
+        explicit TextureCooker(const TextureCookConfig& config, std::shared_ptr<WorkExecutor> executor = nullptr);
+        virtual ~TextureCooker() = default;
+
+        std::pair<std::shared_ptr<TextureData>, size_t> compileResource(std::shared_ptr<TextureData> from) override;
+
+        std::shared_ptr<TextureData> cook(const TextureData& texture, std::shared_ptr<WorkExecutor> executor) const;
+
+        // replaces the levels of texture with a full mip chain built from level 0, executor is optional
+        static void generateMips(TextureData& texture, const TextureCookConfig& config, std::shared_ptr<WorkExecutor> executor);
+
+        // albedo -> bc7 (bc1 / bc3 without albedo_bc7), normal -> bc5, mask -> bc4, data -> bc7
+        static TextureFormat selectFormat(TextureRole role, bool has_alpha, const TextureCookConfig& config);
+
+        // encodes every rgba8 level of texture into format, the level layout is rebuilt for the block sizes
+        static void compress(TextureData& texture, TextureFormat format, std::shared_ptr<WorkExecutor> executor);
+
+        static bool hasAlpha(const TextureData& texture);
+
+        // covers every setting that changes the cooked output, tile_rows only changes how the work is split
+        static size_t configHash(const TextureCookConfig& config);
+
+    public:
+        TextureCookConfig m_config;
+
+    private:
+        std::shared_ptr<WorkExecutor> m_executor;
+    };
+} // namespace ArchViz
@@ -1,6 +1,1062 @@
 #include "runtime/resource/resource_manager/loader/gltf_loader.h"
+#include "runtime/resource/resource_manager/loader/texture_loader.h"
 
-#include <tiny_gltf.h>
+#include "runtime/function/global/global_context.h"
+
+#include "runtime/platform/file_system/basic/mapped_file.h"
+#include "runtime/resource/asset_manager/asset_manager.h"
+
+#include "runtime/core/base/macro.h"
+#include "runtime/core/math/math_type.h"
+#include "runtime/core/meta/json.h"
+#include "runtime/core/thread/work_executor.h"
+
+#include <meshoptimizer.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
 
 namespace ArchViz
-{}
+{
+    namespace
+    {
+        constexpr uint32_t k_glb_magic      = 0x46546C67; // "glTF"
+        constexpr uint32_t k_glb_chunk_json = 0x4E4F534A; // "JSON"
+        constexpr uint32_t k_glb_chunk_bin  = 0x004E4942; // "BIN\0"
+
+        enum glTFComponentType : int
+        {
+            k_byte           = 5120,
+            k_unsigned_byte  = 5121,
+            k_short          = 5122,
+            k_unsigned_short = 5123,
+            k_unsigned_int   = 5125,
+            k_float          = 5126,
+        };
+
+        enum glTFPrimitiveMode : int
+        {
+            k_triangles      = 4,
+            k_triangle_strip = 5,
+            k_triangle_fan   = 6,
+        };
+
+        struct glTFView
+        {
+            const uint8_t* data {nullptr};
+            size_t         size {0};
+            size_t         stride {0};
+        };
+
+        struct glTFDocument
+        {
+            Json        json;
+            std::string uri;
+            std::string base_path;
+
+            // keep mapped and decoded memory alive while views point into it
+            std::vector<std::shared_ptr<MappedFile>> files;
+            std::vector<std::vector<uint8_t>>        owned;
+            std::vector<glTFView>                    buffers;
+            std::vector<glTFView>                    views;
+        };
+
+        struct glTFAccessor
+        {
+            const glTFView* view {nullptr};
+
+            size_t offset {0};
+            size_t count {0};
+            size_t stride {0};
+
+            int  component_type {0};
+            int  component_count {0};
+            bool normalized {false};
+
+            const Json* sparse {nullptr};
+        };
+
+        size_t component_size(int component_type)
+        {
+            switch (component_type)
+            {
+                case k_byte:
+                case k_unsigned_byte:
+                    return 1;
+                case k_short:
+                case k_unsigned_short:
+                    return 2;
+                case k_unsigned_int:
+                case k_float:
+                    return 4;
+                default:
+                    return 0;
+            }
+        }
+
+        int component_count(const std::string& type)
+        {
+            if (type == "SCALAR")
+                return 1;
+            if (type == "VEC2")
+                return 2;
+            if (type == "VEC3")
+                return 3;
+            if (type == "VEC4" || type == "MAT2")
+                return 4;
+            if (type == "MAT3")
+                return 9;
+            if (type == "MAT4")
+                return 16;
+            return 0;
+        }
+
+        template<typename T>
+        inline T read_unaligned(const uint8_t* ptr)
+        {
+            T value;
+            std::memcpy(&value, ptr, sizeof(T));
+            return value;
+        }
+
+        // normalized integers follow the glTF 2.0 spec, signed ones are clamped to -1
+        inline float read_float(const uint8_t* ptr, int component_type, bool normalized)
+        {
+            switch (component_type)
+            {
+                case k_byte: {
+                    float value = static_cast<float>(read_unaligned<int8_t>(ptr));
+                    return normalized ? std::max(value / 127.0f, -1.0f) : value;
+                }
+                case k_unsigned_byte: {
+                    float value = static_cast<float>(read_unaligned<uint8_t>(ptr));
+                    return normalized ? value / 255.0f : value;
+                }
+                case k_short: {
+                    float value = static_cast<float>(read_unaligned<int16_t>(ptr));
+                    return normalized ? std::max(value / 32767.0f, -1.0f) : value;
+                }
+                case k_unsigned_short: {
+                    float value = static_cast<float>(read_unaligned<uint16_t>(ptr));
+                    return normalized ? value / 65535.0f : value;
+                }
+                case k_unsigned_int:
+                    return static_cast<float>(read_unaligned<uint32_t>(ptr));
+                case k_float:
+                    return read_unaligned<float>(ptr);
+                default:
+                    return 0.0f;
+            }
+        }
+
+        inline uint32_t read_uint(const uint8_t* ptr, int component_type)
+        {
+            switch (component_type)
+            {
+                case k_unsigned_byte:
+                    return read_unaligned<uint8_t>(ptr);
+                case k_unsigned_short:
+                    return read_unaligned<uint16_t>(ptr);
+                case k_unsigned_int:
+                    return read_unaligned<uint32_t>(ptr);
+                default:
+                    return 0;
+            }
+        }
+
+        std::string decode_uri(const std::string& uri)
+        {
+            std::string result;
+            result.reserve(uri.size());
+            for (size_t i = 0; i < uri.size(); ++i)
+            {
+                if (uri[i] == '%' && i + 2 < uri.size() && std::isxdigit(uri[i + 1]) && std::isxdigit(uri[i + 2]))
+                {
+                    result.push_back(static_cast<char>(std::stoi(uri.substr(i + 1, 2), nullptr, 16)));
+                    i += 2;
+                }
+                else
+                {
+                    result.push_back(uri[i]);
+                }
+            }
+            return result;
+        }
+
+        bool decode_base64(const std::string& uri, std::vector<uint8_t>& out)
+        {
+            size_t comma = uri.find(";base64,");
+            if (comma == std::string::npos)
+            {
+                return false;
+            }
+
+            auto decode_char = [](char c) -> int {
+                if (c >= 'A' && c <= 'Z')
+                    return c - 'A';
+                if (c >= 'a' && c <= 'z')
+                    return c - 'a' + 26;
+                if (c >= '0' && c <= '9')
+                    return c - '0' + 52;
+                if (c == '+')
+                    return 62;
+                if (c == '/')
+                    return 63;
+                return -1;
+            };
+
+            out.clear();
+            out.reserve((uri.size() - comma) / 4 * 3);
+
+            uint32_t bits  = 0;
+            int      count = 0;
+            for (size_t i = comma + 8; i < uri.size(); ++i)
+            {
+                int value = decode_char(uri[i]);
+                if (value < 0)
+                {
+                    break;
+                }
+                bits = (bits << 6) | static_cast<uint32_t>(value);
+                count += 6;
+                if (count >= 8)
+                {
+                    count -= 8;
+                    out.push_back(static_cast<uint8_t>((bits >> count) & 0xFF));
+                }
+            }
+            return true;
+        }
+
+        bool parse_document(const std::string& uri, glTFDocument& doc)
+        {
+            std::shared_ptr<MappedFile> file = g_runtime_global_context.m_asset_manager->mapVFSFile(uri);
+            if (file == nullptr)
+            {
+                return false;
+            }
+
+            doc.uri       = uri;
+            doc.base_path = std::filesystem::path(uri).parent_path().generic_string();
+            doc.files.push_back(file);
+
+            const uint8_t* data = reinterpret_cast<const uint8_t*>(file->data());
+            size_t         size = file->size();
+
+            std::string json_text;
+            glTFView    bin_chunk;
+
+            if (size >= 12 && read_unaligned<uint32_t>(data) == k_glb_magic)
+            {
+                uint32_t version = read_unaligned<uint32_t>(data + 4);
+                uint32_t length  = read_unaligned<uint32_t>(data + 8);
+                if (version != 2 || length > size)
+                {
+                    LOG_ERROR("invalid glb header: {}", uri);
+                    return false;
+                }
+
+                size_t offset = 12;
+                while (offset + 8 <= length)
+                {
+                    uint32_t chunk_length = read_unaligned<uint32_t>(data + offset);
+                    uint32_t chunk_type   = read_unaligned<uint32_t>(data + offset + 4);
+                    offset += 8;
+                    if (offset + chunk_length > length)
+                    {
+                        LOG_ERROR("invalid glb chunk: {}", uri);
+                        return false;
+                    }
+
+                    if (chunk_type == k_glb_chunk_json && json_text.empty())
+                    {
+                        json_text.assign(reinterpret_cast<const char*>(data + offset), chunk_length);
+                    }
+                    else if (chunk_type == k_glb_chunk_bin && bin_chunk.data == nullptr)
+                    {
+                        bin_chunk.data = data + offset;
+                        bin_chunk.size = chunk_length;
+                    }
+                    offset += chunk_length;
+                }
+            }
+            else
+            {
+                json_text.assign(reinterpret_cast<const char*>(data), size);
+            }
+
+            std::string error;
+            doc.json = Json::parse(json_text, error);
+            if (!error.empty())
+            {
+                LOG_ERROR("parse gltf json {} failed: {}", uri, error);
+                return false;
+            }
+
+            for (const auto& extension : doc.json["extensionsRequired"].array_items())
+            {
+                const std::string& name = extension.string_value();
+                if (name == "KHR_draco_mesh_compression")
+                {
+                    LOG_ERROR("gltf {} requires unsupported extension {}", uri, name);
+                    return false;
+                }
+                if (name != "KHR_mesh_quantization" && name != "EXT_meshopt_compression")
+                {
+                    LOG_WARN("gltf {} requires extension {}, ignored", uri, name);
+                }
+            }
+
+            // buffers, the first buffer without uri of a glb is the binary chunk
+            const auto& buffers = doc.json["buffers"].array_items();
+            doc.buffers.resize(buffers.size());
+            for (size_t i = 0; i < buffers.size(); ++i)
+            {
+                const Json& buffer = buffers[i];
+                if (buffer["uri"].is_null())
+                {
+                    if (i == 0)
+                    {
+                        doc.buffers[i] = bin_chunk;
+                    }
+                    // otherwise a meshopt fallback buffer, never read
+                    continue;
+                }
+
+                const std::string& buffer_uri = buffer["uri"].string_value();
+                if (buffer_uri.rfind("data:", 0) == 0)
+                {
+                    std::vector<uint8_t> decoded;
+                    if (!decode_base64(buffer_uri, decoded))
+                    {
+                        LOG_ERROR("invalid data uri in gltf {}", uri);
+                        return false;
+                    }
+                    doc.owned.push_back(std::move(decoded));
+                    doc.buffers[i] = {doc.owned.back().data(), doc.owned.back().size(), 0};
+                }
+                else
+                {
+                    std::string                 buffer_path = doc.base_path + "/" + decode_uri(buffer_uri);
+                    std::shared_ptr<MappedFile> buffer_file = g_runtime_global_context.m_asset_manager->mapVFSFile(buffer_path);
+                    if (buffer_file == nullptr)
+                    {
+                        return false;
+                    }
+                    doc.files.push_back(buffer_file);
+                    doc.buffers[i] = {reinterpret_cast<const uint8_t*>(buffer_file->data()), buffer_file->size(), 0};
+                }
+
+                size_t byte_length = static_cast<size_t>(buffer["byteLength"].number_value());
+                if (doc.buffers[i].size < byte_length)
+                {
+                    LOG_ERROR("gltf {} buffer {} is truncated", uri, i);
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        bool decode_meshopt_view(const glTFDocument& doc, const Json& extension, std::vector<uint8_t>& out)
+        {
+            size_t buffer_index = static_cast<size_t>(extension["buffer"].int_value());
+            if (buffer_index >= doc.buffers.size())
+            {
+                return false;
+            }
+
+            const glTFView& buffer = doc.buffers[buffer_index];
+
+            size_t byte_offset = static_cast<size_t>(extension["byteOffset"].number_value());
+            size_t byte_length = static_cast<size_t>(extension["byteLength"].number_value());
+            size_t byte_stride = static_cast<size_t>(extension["byteStride"].number_value());
+            size_t count       = static_cast<size_t>(extension["count"].number_value());
+            if (byte_offset + byte_length > buffer.size || byte_stride == 0)
+            {
+                return false;
+            }
+
+            const uint8_t* source = buffer.data + byte_offset;
+            out.resize(count * byte_stride);
+
+            const std::string& mode = extension["mode"].string_value();
+
+            int result = -1;
+            if (mode == "ATTRIBUTES")
+            {
+                result = meshopt_decodeVertexBuffer(out.data(), count, byte_stride, source, byte_length);
+            }
+            else if (mode == "TRIANGLES")
+            {
+                result = meshopt_decodeIndexBuffer(out.data(), count, byte_stride, source, byte_length);
+            }
+            else if (mode == "INDICES")
+            {
+                result = meshopt_decodeIndexSequence(out.data(), count, byte_stride, source, byte_length);
+            }
+            if (result != 0)
+            {
+                return false;
+            }
+
+            const std::string& filter = extension["filter"].string_value();
+            if (filter == "OCTAHEDRAL")
+            {
+                meshopt_decodeFilterOct(out.data(), count, byte_stride);
+            }
+            else if (filter == "QUATERNION")
+            {
+                meshopt_decodeFilterQuat(out.data(), count, byte_stride);
+            }
+            else if (filter == "EXPONENTIAL")
+            {
+                meshopt_decodeFilterExp(out.data(), count, byte_stride);
+            }
+
+            return true;
+        }
+
+        bool build_views(glTFDocument& doc, std::shared_ptr<WorkExecutor> executor)
+        {
+            const auto& views = doc.json["bufferViews"].array_items();
+            doc.views.resize(views.size());
+
+            // compressed views are decoded in parallel into owned memory
+            std::vector<size_t>               compressed;
+            std::vector<std::vector<uint8_t>> decoded;
+            std::vector<std::future<bool>>    futures;
+            for (size_t i = 0; i < views.size(); ++i)
+            {
+                const Json& view = views[i];
+                if (view["extensions"]["EXT_meshopt_compression"].is_object())
+                {
+                    compressed.push_back(i);
+                    continue;
+                }
+
+                size_t buffer_index = static_cast<size_t>(view["buffer"].int_value());
+                size_t byte_offset  = static_cast<size_t>(view["byteOffset"].number_value());
+                size_t byte_length  = static_cast<size_t>(view["byteLength"].number_value());
+                if (buffer_index >= doc.buffers.size() || byte_offset + byte_length > doc.buffers[buffer_index].size)
+                {
+                    LOG_ERROR("gltf {} buffer view {} out of range", doc.uri, i);
+                    return false;
+                }
+
+                doc.views[i] = {doc.buffers[buffer_index].data + byte_offset, byte_length, static_cast<size_t>(view["byteStride"].number_value())};
+            }
+
+            decoded.resize(compressed.size());
+            for (size_t i = 0; i < compressed.size(); ++i)
+            {
+                const Json& extension = views[compressed[i]]["extensions"]["EXT_meshopt_compression"];
+                futures.push_back(executor->enqueue_task([&doc, &extension, &output = decoded[i]]() { return decode_meshopt_view(doc, extension, output); }));
+            }
+
+            bool success = true;
+            for (size_t i = 0; i < compressed.size(); ++i)
+            {
+                if (!futures[i].get())
+                {
+                    LOG_ERROR("gltf {} failed to decode meshopt buffer view {}", doc.uri, compressed[i]);
+                    success = false;
+                }
+            }
+            if (!success)
+            {
+                return false;
+            }
+
+            for (size_t i = 0; i < compressed.size(); ++i)
+            {
+                const Json& extension = views[compressed[i]]["extensions"]["EXT_meshopt_compression"];
+                doc.owned.push_back(std::move(decoded[i]));
+                doc.views[compressed[i]] = {doc.owned.back().data(), doc.owned.back().size(), static_cast<size_t>(extension["byteStride"].number_value())};
+            }
+
+            return true;
+        }
+
+        bool get_accessor(const glTFDocument& doc, size_t index, glTFAccessor& accessor)
+        {
+            const auto& accessors = doc.json["accessors"].array_items();
+            if (index >= accessors.size())
+            {
+                return false;
+            }
+
+            const Json& json = accessors[index];
+
+            accessor.count           = static_cast<size_t>(json["count"].number_value());
+            accessor.offset          = static_cast<size_t>(json["byteOffset"].number_value());
+            accessor.component_type  = json["componentType"].int_value();
+            accessor.component_count = component_count(json["type"].string_value());
+            accessor.normalized      = json["normalized"].bool_value();
+            accessor.sparse          = json["sparse"].is_object() ? &json["sparse"] : nullptr;
+
+            size_t element_size = component_size(accessor.component_type) * accessor.component_count;
+            if (element_size == 0)
+            {
+                return false;
+            }
+
+            if (!json["bufferView"].is_null())
+            {
+                size_t view_index = static_cast<size_t>(json["bufferView"].int_value());
+                if (view_index >= doc.views.size())
+                {
+                    return false;
+                }
+
+                accessor.view   = &doc.views[view_index];
+                accessor.stride = accessor.view->stride ? accessor.view->stride : element_size;
+
+                if (accessor.count > 0 && accessor.offset + accessor.stride * (accessor.count - 1) + element_size > accessor.view->size)
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        // calls func(element, ptr) for every element, elements without buffer view are skipped unless sparse
+        template<typename F>
+        bool visit_accessor(const glTFDocument& doc, const glTFAccessor& accessor, F&& func)
+        {
+            if (accessor.view)
+            {
+                const uint8_t* data = accessor.view->data + accessor.offset;
+                for (size_t i = 0; i < accessor.count; ++i)
+                {
+                    func(i, data + i * accessor.stride);
+                }
+            }
+
+            if (accessor.sparse == nullptr)
+            {
+                return true;
+            }
+
+            const Json& sparse  = *accessor.sparse;
+            const Json& indices = sparse["indices"];
+            const Json& values  = sparse["values"];
+
+            size_t count               = static_cast<size_t>(sparse["count"].number_value());
+            size_t indices_view_index  = static_cast<size_t>(indices["bufferView"].int_value());
+            size_t values_view_index   = static_cast<size_t>(values["bufferView"].int_value());
+            int    index_component     = indices["componentType"].int_value();
+            size_t index_size          = component_size(index_component);
+            size_t element_size        = component_size(accessor.component_type) * accessor.component_count;
+            size_t indices_byte_offset = static_cast<size_t>(indices["byteOffset"].number_value());
+            size_t values_byte_offset  = static_cast<size_t>(values["byteOffset"].number_value());
+
+            if (indices_view_index >= doc.views.size() || values_view_index >= doc.views.size() || index_size == 0)
+            {
+                return false;
+            }
+
+            const glTFView& indices_view = doc.views[indices_view_index];
+            const glTFView& values_view  = doc.views[values_view_index];
+            if (indices_byte_offset + count * index_size > indices_view.size || values_byte_offset + count * element_size > values_view.size)
+            {
+                return false;
+            }
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                size_t element = read_uint(indices_view.data + indices_byte_offset + i * index_size, index_component);
+                if (element >= accessor.count)
+                {
+                    return false;
+                }
+                func(element, values_view.data + values_byte_offset + i * element_size);
+            }
+
+            return true;
+        }
+
+        bool read_floats(const glTFDocument& doc, size_t index, int components, std::vector<float>& out)
+        {
+            glTFAccessor accessor;
+            if (!get_accessor(doc, index, accessor))
+            {
+                return false;
+            }
+
+            out.assign(accessor.count * components, 0.0f);
+
+            int    count          = std::min(components, accessor.component_count);
+            size_t component_step = component_size(accessor.component_type);
+            return visit_accessor(doc, accessor, [&](size_t element, const uint8_t* ptr) {
+                float* dst = out.data() + element * components;
+                for (int c = 0; c < count; ++c)
+                {
+                    dst[c] = read_float(ptr + c * component_step, accessor.component_type, accessor.normalized);
+                }
+            });
+        }
+
+        bool read_indices(const glTFDocument& doc, size_t index, std::vector<uint32_t>& out)
+        {
+            glTFAccessor accessor;
+            if (!get_accessor(doc, index, accessor) || accessor.component_count != 1)
+            {
+                return false;
+            }
+
+            out.assign(accessor.count, 0);
+            return visit_accessor(doc, accessor, [&](size_t element, const uint8_t* ptr) { out[element] = read_uint(ptr, accessor.component_type); });
+        }
+
+        bool decode_primitive(const glTFDocument& doc, const Json& primitive, MeshData& mesh)
+        {
+            const Json& attributes = primitive["attributes"];
+            if (!attributes["POSITION"].is_number())
+            {
+                return false;
+            }
+
+            std::vector<float> positions, normals, tangents, uvs, joints, weights;
+            if (!read_floats(doc, attributes["POSITION"].int_value(), 3, positions))
+            {
+                return false;
+            }
+            if (attributes["NORMAL"].is_number() && !read_floats(doc, attributes["NORMAL"].int_value(), 3, normals))
+            {
+                return false;
+            }
+            if (attributes["TANGENT"].is_number() && !read_floats(doc, attributes["TANGENT"].int_value(), 4, tangents))
+            {
+                return false;
+            }
+            if (attributes["TEXCOORD_0"].is_number() && !read_floats(doc, attributes["TEXCOORD_0"].int_value(), 2, uvs))
+            {
+                return false;
+            }
+            if (attributes["JOINTS_0"].is_number() && attributes["WEIGHTS_0"].is_number())
+            {
+                if (!read_floats(doc, attributes["JOINTS_0"].int_value(), 4, joints) || !read_floats(doc, attributes["WEIGHTS_0"].int_value(), 4, weights))
+                {
+                    return false;
+                }
+            }
+
+            size_t vertex_count = positions.size() / 3;
+            if ((!normals.empty() && normals.size() / 3 != vertex_count) || (!tangents.empty() && tangents.size() / 4 != vertex_count) || (!uvs.empty() && uvs.size() / 2 != vertex_count) ||
+                (!joints.empty() && joints.size() / 4 != vertex_count) || joints.size() != weights.size())
+            {
+                return false;
+            }
+
+            mesh.vertex_buffer.resize(vertex_count);
+            for (size_t i = 0; i < vertex_count; ++i)
+            {
+                MeshVertex& vertex = mesh.vertex_buffer[i];
+                vertex.postion     = Vector3(&positions[i * 3]);
+                if (!normals.empty())
+                {
+                    vertex.normal = Vector3(&normals[i * 3]);
+                }
+                if (!tangents.empty())
+                {
+                    vertex.tangent = Vector3(&tangents[i * 4]);
+                }
+                if (!uvs.empty())
+                {
+                    vertex.uv = Vector2(uvs[i * 2 + 0], uvs[i * 2 + 1]);
+                }
+            }
+
+            if (!joints.empty())
+            {
+                mesh.bind.resize(vertex_count);
+                for (size_t i = 0; i < vertex_count; ++i)
+                {
+                    mesh.bind[i].index  = Vector4(joints[i * 4 + 0], joints[i * 4 + 1], joints[i * 4 + 2], joints[i * 4 + 3]);
+                    mesh.bind[i].weight = Vector4(weights[i * 4 + 0], weights[i * 4 + 1], weights[i * 4 + 2], weights[i * 4 + 3]);
+                }
+            }
+
+            std::vector<uint32_t> indices;
+            if (primitive["indices"].is_number())
+            {
+                if (!read_indices(doc, primitive["indices"].int_value(), indices))
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                indices.resize(vertex_count);
+                for (uint32_t i = 0; i < vertex_count; ++i)
+                    indices[i] = i;
+            }
+
+            // everything becomes a triangle list
+            int mode = primitive["mode"].is_number() ? primitive["mode"].int_value() : k_triangles;
+            mesh.index_buffer.clear();
+            if (mode == k_triangles)
+            {
+                mesh.index_buffer.assign(indices.begin(), indices.end());
+            }
+            else if (mode == k_triangle_strip)
+            {
+                for (size_t i = 2; i < indices.size(); ++i)
+                {
+                    bool even = (i % 2) == 0;
+                    mesh.index_buffer.push_back(indices[i - 2]);
+                    mesh.index_buffer.push_back(even ? indices[i - 1] : indices[i]);
+                    mesh.index_buffer.push_back(even ? indices[i] : indices[i - 1]);
+                }
+            }
+            else if (mode == k_triangle_fan)
+            {
+                for (size_t i = 2; i < indices.size(); ++i)
+                {
+                    mesh.index_buffer.push_back(indices[0]);
+                    mesh.index_buffer.push_back(indices[i - 1]);
+                    mesh.index_buffer.push_back(indices[i]);
+                }
+            }
+            else
+            {
+                LOG_WARN("gltf {} primitive mode {} is not supported, skipped", doc.uri, mode);
+                mesh.vertex_buffer.clear();
+                mesh.bind.clear();
+                return true;
+            }
+
+            for (int index : mesh.index_buffer)
+            {
+                if (index < 0 || static_cast<size_t>(index) >= vertex_count)
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        FMatrix4 node_local_matrix(const Json& node)
+        {
+            FMatrix4 matrix = FMatrix4::Identity();
+
+            const auto& values = node["matrix"].array_items();
+            if (values.size() == 16)
+            {
+                // column major
+                for (int i = 0; i < 16; ++i)
+                    matrix(i % 4, i / 4) = static_cast<float>(values[i].number_value());
+                return matrix;
+            }
+
+            const auto& t = node["translation"].array_items();
+            const auto& r = node["rotation"].array_items();
+            const auto& s = node["scale"].array_items();
+
+            FAffine transform = FAffine::Identity();
+            if (t.size() == 3)
+            {
+                transform.translate(FVector3(t[0].number_value(), t[1].number_value(), t[2].number_value()));
+            }
+            if (r.size() == 4)
+            {
+                // glTF stores xyzw, eigen takes wxyz
+                transform.rotate(FQuaternion(r[3].number_value(), r[0].number_value(), r[1].number_value(), r[2].number_value()).normalized());
+            }
+            if (s.size() == 3)
+            {
+                transform.scale(FVector3(s[0].number_value(), s[1].number_value(), s[2].number_value()));
+            }
+            return transform.matrix();
+        }
+
+        struct glTFInstance
+        {
+            size_t   mesh {0};
+            FMatrix4 transform {FMatrix4::Identity()};
+        };
+
+        void collect_instances(const Json& json, std::vector<glTFInstance>& instances)
+        {
+            const auto& nodes = json["nodes"].array_items();
+
+            std::vector<std::pair<size_t, FMatrix4>> stack;
+            std::vector<bool>                        visited(nodes.size(), false);
+
+            auto push_roots = [&](const std::vector<Json>& roots) {
+                for (const auto& root : roots)
+                {
+                    size_t index = static_cast<size_t>(root.int_value());
+                    if (index < nodes.size())
+                        stack.emplace_back(index, FMatrix4::Identity());
+                }
+            };
+
+            const auto& scenes = json["scenes"].array_items();
+            if (!scenes.empty())
+            {
+                size_t scene = json["scene"].is_number() ? static_cast<size_t>(json["scene"].int_value()) : 0;
+                push_roots(scenes[std::min(scene, scenes.size() - 1)]["nodes"].array_items());
+            }
+            else
+            {
+                // no scene, every mesh once without transform
+                for (size_t i = 0; i < json["meshes"].array_items().size(); ++i)
+                    instances.push_back({i, FMatrix4::Identity()});
+                return;
+            }
+
+            while (!stack.empty())
+            {
+                auto [index, parent] = stack.back();
+                stack.pop_back();
+
+                // guard against cycles in broken files
+                if (visited[index])
+                    continue;
+                visited[index] = true;
+
+                const Json& node  = nodes[index];
+                FMatrix4    world = parent * node_local_matrix(node);
+
+                if (node["mesh"].is_number())
+                {
+                    instances.push_back({static_cast<size_t>(node["mesh"].int_value()), world});
+                }
+
+                for (const auto& child : node["children"].array_items())
+                {
+                    size_t child_index = static_cast<size_t>(child.int_value());
+                    if (child_index < nodes.size())
+                        stack.emplace_back(child_index, world);
+                }
+            }
+        }
+    } // namespace
+
+    glTFLoader::glTFLoader(std::shared_ptr<WorkExecutor> executor) : m_executor {std::move(executor)}
+    {
+        // images decode in the background, there is no inline path
+        ASSERT(m_executor);
+    }
+
+    std::pair<std::shared_ptr<MeshData>, size_t> glTFLoader::createResource(const SubMeshRes& create_info) { return createResource(create_info.m_obj_file_ref); }
+
+    std::pair<std::shared_ptr<MeshData>, size_t> glTFLoader::createResource(const std::string& uri)
+    {
+        std::shared_ptr<glTFDocument> doc = std::make_shared<glTFDocument>();
+        if (!parse_document(uri, *doc) || !build_views(*doc, m_executor))
+        {
+            LOG_ERROR("failed to load gltf: {}", uri);
+            return {nullptr, 0};
+        }
+
+        const Json& json = doc->json;
+
+        // images are decoded in background, the document is kept alive until they are done
+        {
+            std::scoped_lock lock(m_image_mutex);
+
+            std::vector<std::string>& model_images = m_model_images[uri];
+            model_images.clear();
+
+            const auto& images = json["images"].array_items();
+            for (size_t i = 0; i < images.size(); ++i)
+            {
+                const Json& image = images[i];
+
+                std::string image_uri = image["uri"].is_string() && image["uri"].string_value().rfind("data:", 0) != 0 ? doc->base_path + "/" + decode_uri(image["uri"].string_value()) :
+                                                                                                                          uri + "#image" + std::to_string(i);
+                model_images.push_back(image_uri);
+
+                if (m_images.count(image_uri) != 0)
+                {
+                    continue;
+                }
+
+                auto task = [doc, image_uri, i]() -> std::shared_ptr<TextureData> {
+                    const Json& image = doc->json["images"][i];
+                    if (image["bufferView"].is_number())
+                    {
+                        size_t view_index = static_cast<size_t>(image["bufferView"].int_value());
+                        if (view_index >= doc->views.size())
+                        {
+                            return nullptr;
+                        }
+                        const glTFView& view = doc->views[view_index];
+                        return TextureLoader::loadFromMemory(view.data, view.size, image_uri);
+                    }
+
+                    const std::string& source = image["uri"].string_value();
+                    if (source.rfind("data:", 0) == 0)
+                    {
+                        std::vector<uint8_t> decoded;
+                        if (!decode_base64(source, decoded))
+                        {
+                            return nullptr;
+                        }
+                        return TextureLoader::loadFromMemory(decoded.data(), decoded.size(), image_uri);
+                    }
+
+                    std::shared_ptr<MappedFile> file = g_runtime_global_context.m_asset_manager->mapVFSFile(image_uri);
+                    if (file == nullptr)
+                    {
+                        return nullptr;
+                    }
+                    return TextureLoader::loadFromMemory(reinterpret_cast<const uint8_t*>(file->data()), file->size(), image_uri);
+                };
+
+                m_images[image_uri] = m_executor->enqueue_task(std::move(task)).share();
+            }
+        }
+
+        // decode every primitive of every mesh in parallel
+        const auto& meshes = json["meshes"].array_items();
+
+        std::vector<size_t> primitive_offsets(meshes.size() + 1, 0);
+        for (size_t i = 0; i < meshes.size(); ++i)
+        {
+            primitive_offsets[i + 1] = primitive_offsets[i] + meshes[i]["primitives"].array_items().size();
+        }
+
+        std::vector<MeshData>          primitives(primitive_offsets.back());
+        std::vector<std::future<bool>> futures;
+        futures.reserve(primitives.size());
+        for (size_t i = 0; i < meshes.size(); ++i)
+        {
+            const auto& mesh_primitives = meshes[i]["primitives"].array_items();
+            for (size_t j = 0; j < mesh_primitives.size(); ++j)
+            {
+                futures.push_back(m_executor->enqueue_task([&doc, &primitive = mesh_primitives[j], &output = primitives[primitive_offsets[i] + j]]() { return decode_primitive(*doc, primitive, output); }));
+            }
+        }
+
+        bool success = true;
+        for (auto& future : futures)
+        {
+            success = future.get() && success;
+        }
+        if (!success)
+        {
+            LOG_ERROR("failed to decode gltf primitives: {}", uri);
+            return {nullptr, 0};
+        }
+
+        // bake node transforms and merge into one mesh
+        std::vector<glTFInstance> instances;
+        collect_instances(json, instances);
+
+        struct MergeTask
+        {
+            const MeshData* source {nullptr};
+            const FMatrix4* transform {nullptr};
+            size_t          vertex_offset {0};
+            size_t          index_offset {0};
+        };
+
+        std::vector<MergeTask> merge_tasks;
+        size_t                 vertex_count = 0;
+        size_t                 index_count  = 0;
+        bool                   has_skin     = false;
+        for (const auto& instance : instances)
+        {
+            if (instance.mesh >= meshes.size())
+            {
+                continue;
+            }
+            for (size_t p = primitive_offsets[instance.mesh]; p < primitive_offsets[instance.mesh + 1]; ++p)
+            {
+                merge_tasks.push_back({&primitives[p], &instance.transform, vertex_count, index_count});
+                vertex_count += primitives[p].vertex_buffer.size();
+                index_count += primitives[p].index_buffer.size();
+                has_skin = has_skin || !primitives[p].bind.empty();
+            }
+        }
+
+        std::shared_ptr<MeshData> mesh = std::make_shared<MeshData>();
+        mesh->vertex_buffer.resize(vertex_count);
+        mesh->index_buffer.resize(index_count);
+        if (has_skin)
+        {
+            mesh->bind.resize(vertex_count);
+        }
+
+        std::vector<std::future<void>> merge_futures;
+        merge_futures.reserve(merge_tasks.size());
+        for (const auto& task : merge_tasks)
+        {
+            merge_futures.push_back(m_executor->enqueue_task([&mesh, task]() {
+                const FMatrix4& matrix = *task.transform;
+                FMatrix3        linear = matrix.topLeftCorner<3, 3>();
+                FMatrix3        normal = linear.inverse().transpose();
+
+                for (size_t i = 0; i < task.source->vertex_buffer.size(); ++i)
+                {
+                    const MeshVertex& src = task.source->vertex_buffer[i];
+                    MeshVertex&       dst = mesh->vertex_buffer[task.vertex_offset + i];
+
+                    FVector3 position = linear * FVector3(src.postion.x, src.postion.y, src.postion.z) + matrix.topRightCorner<3, 1>();
+                    FVector3 n        = (normal * FVector3(src.normal.x, src.normal.y, src.normal.z)).normalized();
+                    FVector3 t        = (linear * FVector3(src.tangent.x, src.tangent.y, src.tangent.z)).normalized();
+
+                    dst.postion = Vector3(position.x(), position.y(), position.z());
+                    dst.normal  = src.normal == Vector3() ? src.normal : Vector3(n.x(), n.y(), n.z());
+                    dst.tangent = src.tangent == Vector3() ? src.tangent : Vector3(t.x(), t.y(), t.z());
+                    dst.uv      = src.uv;
+                }
+
+                if (!task.source->bind.empty())
+                {
+                    std::copy(task.source->bind.begin(), task.source->bind.end(), mesh->bind.begin() + task.vertex_offset);
+                }
+
+                for (size_t i = 0; i < task.source->index_buffer.size(); ++i)
+                {
+                    mesh->index_buffer[task.index_offset + i] = task.source->index_buffer[i] + static_cast<int>(task.vertex_offset);
+                }
+            }));
+        }
+        for (auto& future : merge_futures)
+        {
+            future.wait();
+        }
+
+        size_t vertex_size = mesh->vertex_buffer.size() * sizeof(mesh->vertex_buffer[0]);
+        size_t index_size  = mesh->index_buffer.size() * sizeof(mesh->index_buffer[0]);
+        return {mesh, vertex_size + index_size};
+    }
+
+    std::vector<std::string> glTFLoader::getModelImages(const std::string& uri)
+    {
+        std::scoped_lock lock(m_image_mutex);
+
+        auto iter = m_model_images.find(uri);
+        if (iter == m_model_images.end())
+        {
+            return {};
+        }
+        return iter->second;
+    }
+
+    std::shared_future<std::shared_ptr<TextureData>> glTFLoader::getImage(const std::string& image_uri)
+    {
+        std::scoped_lock lock(m_image_mutex);
+
+        auto iter = m_images.find(image_uri);
+        if (iter == m_images.end())
+        {
+            LOG_WARN("gltf image {} is not loaded", image_uri);
+
+            // ready with nothing, so get() on it is always safe
+            std::promise<std::shared_ptr<TextureData>> missing;
+            missing.set_value(nullptr);
+            return missing.get_future().share();
+        }
+        return iter->second;
+    }
+} // namespace ArchViz
@@ -2,19 +2,46 @@
 #include "runtime/resource/resource_manager/loader/loader.h"
 
 #include "runtime/resource/res_type/components/mesh_res.h"
+#include "runtime/resource/res_type/data/material_data.h"
 #include "runtime/resource/res_type/data/mesh_data.h"
 
-#include <tiny_gltf.h>
-
+#include <future>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace ArchViz
 {
+    class WorkExecutor;
+
+    // glTF 2.0 (.gltf / .glb) loader, uri is a vfs path.
+    // Buffers are mapped through the vfs and accessors are decoded straight from the mapped memory,
+    // only data uris and EXT_meshopt_compression views are decoded into owned memory.
+    // Primitives are decoded in parallel, node transforms are baked and all primitives are merged into one MeshData.
+    // Supports sparse accessors, normalized integers, KHR_mesh_quantization and EXT_meshopt_compression.
     class glTFLoader : public Loader<MeshData, SubMeshRes>
     {
     public:
+        explicit glTFLoader(std::shared_ptr<WorkExecutor> executor);
         virtual ~glTFLoader() = default;
+
+        std::pair<std::shared_ptr<MeshData>, size_t> createResource(const SubMeshRes& create_info) override;
+        std::pair<std::shared_ptr<MeshData>, size_t> createResource(const std::string& uri) override;
+
+        // image uris referenced by a loaded model, in glTF image order
+        std::vector<std::string> getModelImages(const std::string& uri);
+
+        // images are decoded in background once the model referencing them is loaded, an unknown uri gives a ready nullptr
+        std::shared_future<std::shared_ptr<TextureData>> getImage(const std::string& image_uri);
+
+    private:
+        std::shared_ptr<WorkExecutor> m_executor;
+
+        std::mutex m_image_mutex;
+
+        std::unordered_map<std::string, std::shared_future<std::shared_ptr<TextureData>>> m_images;
+        std::unordered_map<std::string, std::vector<std::string>>                         m_model_images;
     };
 } // namespace ArchViz
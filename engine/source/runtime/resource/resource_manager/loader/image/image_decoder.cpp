@@ -0,0 +1,82 @@
+#include "runtime/resource/resource_manager/loader/image/image_decoder.h"
+#include "runtime/resource/resource_manager/loader/image/jpeg_decoder.h"
+#include "runtime/resource/resource_manager/loader/image/png_decoder.h"
+
+#include "runtime/core/base/macro.h"
+
+#include <stb_image.h>
+
+#include <climits>
+#include <cstring>
+
+namespace ArchViz
+{
+    bool ImageDecoder::probe(const uint8_t* data, size_t size, ImageInfo& info)
+    {
+        info = {};
+        if (data == nullptr || size == 0)
+        {
+            return false;
+        }
+        if (PngDecoder::isPng(data, size))
+        {
+            return PngDecoder::probe(data, size, info);
+        }
+        if (JpegDecoder::isJpeg(data, size))
+        {
+            return JpegDecoder::probe(data, size, info);
+        }
+
+        // bmp, tga, hdr, ... only through stb_image
+        int width, height, channels;
+        if (size > INT_MAX || !stbi_info_from_memory(data, static_cast<int>(size), &width, &height, &channels))
+        {
+            return false;
+        }
+        info.width    = static_cast<uint32_t>(width);
+        info.height   = static_cast<uint32_t>(height);
+        info.channels = static_cast<uint32_t>(channels);
+        return true;
+    }
+
+    bool ImageDecoder::decode(const uint8_t* data, size_t size, uint8_t* output, size_t output_size, std::shared_ptr<WorkExecutor> executor)
+    {
+        ImageInfo info;
+        if (!probe(data, size, info) || output_size < decodedSize(info))
+        {
+            return false;
+        }
+
+        if (info.native)
+        {
+            bool decoded = info.format == ImageFileFormat::PNG ? PngDecoder::decode(data, size, output, output_size) : JpegDecoder::decode(data, size, output, output_size, executor);
+            if (decoded)
+            {
+                return true;
+            }
+            // stb_image is more forgiving with damaged files
+            LOG_WARN("native image decode failed, retry with stb_image");
+        }
+
+        if (size > INT_MAX)
+        {
+            return false;
+        }
+
+        int      width, height, channels;
+        stbi_uc* pixels = stbi_load_from_memory(data, static_cast<int>(size), &width, &height, &channels, STBI_rgb_alpha);
+        if (pixels == nullptr)
+        {
+            return false;
+        }
+        if (static_cast<uint32_t>(width) != info.width || static_cast<uint32_t>(height) != info.height)
+        {
+            stbi_image_free(pixels);
+            return false;
+        }
+
+        std::memcpy(output, pixels, decodedSize(info));
+        stbi_image_free(pixels);
+        return true;
+    }
+} // namespace ArchViz
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace ArchViz
+{
+    class WorkExecutor;
+
+    enum class ImageFileFormat : uint8_t
+    {
+        Unknown,
+        PNG,
+        JPEG,
+    };
+
+    struct ImageInfo
+    {
+        ImageFileFormat format {ImageFileFormat::Unknown};
+        uint32_t        width {0};
+        uint32_t        height {0};
+        uint32_t        channels {0};  // stored in the file, the decoded image is always rgba8
+        bool            native {false}; // handled by the fast decoders, otherwise decode goes through stb_image
+    };
+
+    // image decoding into caller provided rgba8 memory
+    // baseline jpeg and non interlaced png use the native decoders (simd unfiltering / idct / colour conversion,
+    // jpeg restart intervals and mcu rows in parallel on the executor), everything else falls back to stb_image
+    class ImageDecoder
+    {
+    public:
+        // headers only, no pixel data is touched
+        static bool probe(const uint8_t* data, size_t size, ImageInfo& info);
+
+        static size_t decodedSize(const ImageInfo& info) { return static_cast<size_t>(info.width) * info.height * 4; }
+
+        // output receives decodedSize(info) bytes, tightly packed rgba8 rows
+        static bool decode(const uint8_t* data, size_t size, uint8_t* output, size_t output_size, std::shared_ptr<WorkExecutor> executor = nullptr);
+    };
+} // namespace ArchViz
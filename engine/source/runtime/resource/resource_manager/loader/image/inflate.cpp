@@ -0,0 +1,555 @@
+#include "runtime/resource/resource_manager/loader/image/inflate.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace ArchViz
+{
+    namespace
+    {
+        constexpr uint32_t k_litlen_table_bits  = 11;
+        constexpr uint32_t k_offset_table_bits  = 8;
+        constexpr uint32_t k_precode_table_bits = 7;
+        constexpr uint32_t k_max_codeword_bits  = 15;
+
+        constexpr uint32_t k_litlen_symbols  = 288;
+        constexpr uint32_t k_offset_symbols  = 32;
+        constexpr uint32_t k_precode_symbols = 19;
+
+        // the fast loop needs room for a whole match plus the overshoot of the 8 byte copies
+        constexpr size_t k_fast_input_margin  = 16;
+        constexpr size_t k_fast_output_margin = 258 + 16;
+
+        // decode table entry
+        // [0, 4)   codeword bits, subtable entries hold the full length
+        // [8, 13)  extra bits, or the index bits of a subtable
+        // [13, 16) kind
+        // [16, 32) literal, base value or subtable offset
+        enum EntryKind : uint32_t
+        {
+            k_entry_literal  = 0,
+            k_entry_base     = 1,
+            k_entry_end      = 2,
+            k_entry_subtable = 3,
+            k_entry_invalid  = 4,
+        };
+
+        constexpr uint32_t make_entry(uint32_t kind, uint32_t value, uint32_t extra, uint32_t length) { return (value << 16) | (kind << 13) | (extra << 8) | length; }
+
+        inline uint32_t entry_length(uint32_t entry) { return entry & 0xF; }
+        inline uint32_t entry_extra(uint32_t entry) { return (entry >> 8) & 0x1F; }
+        inline uint32_t entry_kind(uint32_t entry) { return (entry >> 13) & 0x7; }
+        inline uint32_t entry_value(uint32_t entry) { return entry >> 16; }
+
+        constexpr uint16_t k_length_base[29]  = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        constexpr uint8_t  k_length_extra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+
+        constexpr uint16_t k_offset_base[30]  = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+        constexpr uint8_t  k_offset_extra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+        constexpr uint8_t k_precode_order[k_precode_symbols] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+        uint32_t litlen_symbol_entry(uint32_t symbol)
+        {
+            if (symbol < 256)
+            {
+                return make_entry(k_entry_literal, symbol, 0, 0);
+            }
+            if (symbol == 256)
+            {
+                return make_entry(k_entry_end, 0, 0, 0);
+            }
+            if (symbol < 286)
+            {
+                return make_entry(k_entry_base, k_length_base[symbol - 257], k_length_extra[symbol - 257], 0);
+            }
+            return make_entry(k_entry_invalid, 0, 0, 0);
+        }
+
+        uint32_t offset_symbol_entry(uint32_t symbol)
+        {
+            if (symbol < 30)
+            {
+                return make_entry(k_entry_base, k_offset_base[symbol], k_offset_extra[symbol], 0);
+            }
+            return make_entry(k_entry_invalid, 0, 0, 0);
+        }
+
+        uint32_t precode_symbol_entry(uint32_t symbol) { return make_entry(k_entry_literal, symbol, 0, 0); }
+
+        inline uint32_t reverse_bits(uint32_t code, uint32_t length)
+        {
+            uint32_t result = 0;
+            for (uint32_t i = 0; i < length; ++i)
+            {
+                result = (result << 1) | ((code >> i) & 1u);
+            }
+            return result;
+        }
+
+        // canonical huffman decode table, codewords longer than table_bits go to per prefix subtables
+        template<typename SymbolEntry>
+        bool build_table(const uint8_t* lengths, uint32_t symbol_count, uint32_t table_bits, SymbolEntry symbol_entry, std::vector<uint32_t>& table)
+        {
+            uint32_t count[k_max_codeword_bits + 1] = {};
+            for (uint32_t symbol = 0; symbol < symbol_count; ++symbol)
+            {
+                ++count[lengths[symbol]];
+            }
+            count[0] = 0;
+
+            // over subscribed codes are corrupt, incomplete ones just leave invalid entries
+            int32_t left = 1;
+            for (uint32_t length = 1; length <= k_max_codeword_bits; ++length)
+            {
+                left = (left << 1) - static_cast<int32_t>(count[length]);
+                if (left < 0)
+                {
+                    return false;
+                }
+            }
+
+            uint32_t next_code[k_max_codeword_bits + 2] = {};
+            for (uint32_t length = 1; length <= k_max_codeword_bits; ++length)
+            {
+                next_code[length + 1] = (next_code[length] + count[length]) << 1;
+            }
+
+            uint16_t codes[k_litlen_symbols];
+            for (uint32_t symbol = 0; symbol < symbol_count; ++symbol)
+            {
+                uint32_t length = lengths[symbol];
+                codes[symbol]   = length == 0 ? 0 : static_cast<uint16_t>(reverse_bits(next_code[length]++, length));
+            }
+
+            // subtable sizes from the longest codeword behind every prefix
+            const uint32_t main_size = 1u << table_bits;
+            const uint32_t main_mask = main_size - 1;
+
+            uint8_t  sub_bits[1u << k_litlen_table_bits]   = {};
+            uint32_t sub_offset[1u << k_litlen_table_bits] = {};
+            for (uint32_t symbol = 0; symbol < symbol_count; ++symbol)
+            {
+                if (lengths[symbol] > table_bits)
+                {
+                    uint32_t prefix  = codes[symbol] & main_mask;
+                    sub_bits[prefix] = std::max<uint8_t>(sub_bits[prefix], static_cast<uint8_t>(lengths[symbol] - table_bits));
+                }
+            }
+
+            uint32_t table_size = main_size;
+            for (uint32_t prefix = 0; prefix < main_size; ++prefix)
+            {
+                if (sub_bits[prefix] != 0)
+                {
+                    sub_offset[prefix] = table_size;
+                    table_size += 1u << sub_bits[prefix];
+                }
+            }
+
+            table.assign(table_size, make_entry(k_entry_invalid, 0, 0, 1));
+            for (uint32_t prefix = 0; prefix < main_size; ++prefix)
+            {
+                if (sub_bits[prefix] != 0)
+                {
+                    table[prefix] = make_entry(k_entry_subtable, sub_offset[prefix], sub_bits[prefix], table_bits);
+                }
+            }
+
+            for (uint32_t symbol = 0; symbol < symbol_count; ++symbol)
+            {
+                uint32_t length = lengths[symbol];
+                if (length == 0)
+                {
+                    continue;
+                }
+
+                uint32_t entry = symbol_entry(symbol) | length;
+                uint32_t code  = codes[symbol];
+                if (length <= table_bits)
+                {
+                    for (uint32_t i = code; i < main_size; i += 1u << length)
+                    {
+                        table[i] = entry;
+                    }
+                }
+                else
+                {
+                    uint32_t prefix = code & main_mask;
+                    uint32_t size   = 1u << sub_bits[prefix];
+                    for (uint32_t i = code >> table_bits; i < size; i += 1u << (length - table_bits))
+                    {
+                        table[sub_offset[prefix] + i] = entry;
+                    }
+                }
+            }
+            return true;
+        }
+
+        struct BitReader
+        {
+            const uint8_t* in;
+            const uint8_t* end;
+            uint64_t       bits {0};
+            uint32_t       count {0};
+            uint32_t       overrun {0}; // zero bytes fed past the end of the input
+
+            // at least 56 bits afterwards
+            inline void refillFast()
+            {
+                uint64_t word;
+                std::memcpy(&word, in, sizeof(word)); // little endian hosts only
+                bits |= word << count;
+                in += (63 - count) >> 3;
+                count |= 56;
+            }
+
+            inline void refill()
+            {
+                if (static_cast<size_t>(end - in) >= 8)
+                {
+                    refillFast();
+                    return;
+                }
+                while (count <= 56)
+                {
+                    if (in < end)
+                    {
+                        bits |= static_cast<uint64_t>(*in++) << count;
+                    }
+                    else
+                    {
+                        ++overrun;
+                    }
+                    count += 8;
+                }
+            }
+
+            inline uint32_t peek(uint32_t n) const { return static_cast<uint32_t>(bits & ((uint64_t(1) << n) - 1)); }
+
+            inline void consume(uint32_t n)
+            {
+                bits >>= n;
+                count -= n;
+            }
+
+            inline uint32_t read(uint32_t n)
+            {
+                uint32_t value = peek(n);
+                consume(n);
+                return value;
+            }
+
+            // the padding is fine as long as it was never consumed
+            bool valid() const { return overrun * 8 <= count; }
+
+            // first byte not held in the bit buffer, the buffer must be byte aligned
+            const uint8_t* position() const { return in - ((count >> 3) - overrun); }
+
+            void reset(const uint8_t* position)
+            {
+                in      = position;
+                bits    = 0;
+                count   = 0;
+                overrun = 0;
+            }
+        };
+
+        inline uint32_t lookup(const std::vector<uint32_t>& table, uint32_t table_bits, uint64_t bits)
+        {
+            uint32_t entry = table[bits & ((1u << table_bits) - 1)];
+            if (entry_kind(entry) == k_entry_subtable)
+            {
+                entry = table[entry_value(entry) + ((bits >> table_bits) & ((1u << entry_extra(entry)) - 1))];
+            }
+            return entry;
+        }
+
+        struct DecodeTables
+        {
+            std::vector<uint32_t> litlen;
+            std::vector<uint32_t> offset;
+        };
+
+        const DecodeTables& fixed_tables()
+        {
+            static const DecodeTables tables = []() {
+                DecodeTables result;
+
+                uint8_t lengths[k_litlen_symbols];
+                std::memset(lengths, 8, 144);
+                std::memset(lengths + 144, 9, 112);
+                std::memset(lengths + 256, 7, 24);
+                std::memset(lengths + 280, 8, 8);
+                build_table(lengths, k_litlen_symbols, k_litlen_table_bits, litlen_symbol_entry, result.litlen);
+
+                std::memset(lengths, 5, k_offset_symbols);
+                build_table(lengths, k_offset_symbols, k_offset_table_bits, offset_symbol_entry, result.offset);
+                return result;
+            }();
+            return tables;
+        }
+
+        bool read_dynamic_tables(BitReader& reader, DecodeTables& tables)
+        {
+            reader.refill();
+            uint32_t litlen_count  = reader.read(5) + 257;
+            uint32_t offset_count  = reader.read(5) + 1;
+            uint32_t precode_count = reader.read(4) + 4;
+
+            uint8_t precode_lengths[k_precode_symbols] = {};
+            for (uint32_t i = 0; i < precode_count; ++i)
+            {
+                reader.refill();
+                precode_lengths[k_precode_order[i]] = static_cast<uint8_t>(reader.read(3));
+            }
+
+            std::vector<uint32_t> precode;
+            if (!build_table(precode_lengths, k_precode_symbols, k_precode_table_bits, precode_symbol_entry, precode))
+            {
+                return false;
+            }
+
+            // litlen and offset lengths form one sequence, repeats may cross between them
+            uint8_t        lengths[k_litlen_symbols + k_offset_symbols] = {};
+            const uint32_t total                                        = litlen_count + offset_count;
+            for (uint32_t i = 0; i < total;)
+            {
+                reader.refill();
+                uint32_t entry = lookup(precode, k_precode_table_bits, reader.bits);
+                if (entry_kind(entry) != k_entry_literal)
+                {
+                    return false;
+                }
+                reader.consume(entry_length(entry));
+
+                uint32_t symbol = entry_value(entry);
+                if (symbol < 16)
+                {
+                    lengths[i++] = static_cast<uint8_t>(symbol);
+                    continue;
+                }
+
+                uint8_t  value  = 0;
+                uint32_t repeat = 0;
+                if (symbol == 16)
+                {
+                    if (i == 0)
+                    {
+                        return false;
+                    }
+                    value  = lengths[i - 1];
+                    repeat = 3 + reader.read(2);
+                }
+                else if (symbol == 17)
+                {
+                    repeat = 3 + reader.read(3);
+                }
+                else
+                {
+                    repeat = 11 + reader.read(7);
+                }
+
+                if (i + repeat > total)
+                {
+                    return false;
+                }
+                std::memset(lengths + i, value, repeat);
+                i += repeat;
+            }
+
+            if (lengths[256] == 0)
+            {
+                return false; // no end of block code
+            }
+
+            return build_table(lengths, litlen_count, k_litlen_table_bits, litlen_symbol_entry, tables.litlen) &&
+                   build_table(lengths + litlen_count, offset_count, k_offset_table_bits, offset_symbol_entry, tables.offset) && reader.valid();
+        }
+
+        bool decode_block(BitReader& reader, const DecodeTables& tables, uint8_t* begin, uint8_t*& out, uint8_t* out_end)
+        {
+            for (;;)
+            {
+                const bool fast = static_cast<size_t>(reader.end - reader.in) >= k_fast_input_margin && static_cast<size_t>(out_end - out) >= k_fast_output_margin;
+                if (fast)
+                {
+                    reader.refillFast();
+                }
+                else
+                {
+                    reader.refill();
+                }
+
+                uint32_t entry = lookup(tables.litlen, k_litlen_table_bits, reader.bits);
+                uint32_t kind  = entry_kind(entry);
+
+                if (kind == k_entry_literal)
+                {
+                    if (out == out_end)
+                    {
+                        return false;
+                    }
+                    reader.consume(entry_length(entry));
+                    *out++ = static_cast<uint8_t>(entry_value(entry));
+
+                    // up to two more literals from the same refill
+                    if (fast)
+                    {
+                        entry = lookup(tables.litlen, k_litlen_table_bits, reader.bits);
+                        if (entry_kind(entry) == k_entry_literal)
+                        {
+                            reader.consume(entry_length(entry));
+                            *out++ = static_cast<uint8_t>(entry_value(entry));
+
+                            entry = lookup(tables.litlen, k_litlen_table_bits, reader.bits);
+                            if (entry_kind(entry) == k_entry_literal)
+                            {
+                                reader.consume(entry_length(entry));
+                                *out++ = static_cast<uint8_t>(entry_value(entry));
+                            }
+                        }
+                    }
+                    continue;
+                }
+
+                if (kind == k_entry_end)
+                {
+                    reader.consume(entry_length(entry));
+                    return reader.valid();
+                }
+                if (kind != k_entry_base)
+                {
+                    return false;
+                }
+
+                // a full refill covers litlen (15) + length extra (5) + offset (15) + offset extra (13) bits
+                reader.consume(entry_length(entry));
+                uint32_t length = entry_value(entry) + reader.read(entry_extra(entry));
+
+                entry = lookup(tables.offset, k_offset_table_bits, reader.bits);
+                if (entry_kind(entry) != k_entry_base)
+                {
+                    return false;
+                }
+                reader.consume(entry_length(entry));
+                uint32_t offset = entry_value(entry) + reader.read(entry_extra(entry));
+
+                if (offset > static_cast<size_t>(out - begin) || length > static_cast<size_t>(out_end - out))
+                {
+                    return false;
+                }
+
+                const uint8_t* src = out - offset;
+                uint8_t*       end = out + length;
+                if (fast && offset >= 8)
+                {
+                    // word copies may run up to 7 bytes past the match, the output margin covers it
+                    do
+                    {
+                        std::memcpy(out, src, 8);
+                        out += 8;
+                        src += 8;
+                    } while (out < end);
+                    out = end;
+                }
+                else if (offset == 1)
+                {
+                    std::memset(out, *src, length);
+                    out = end;
+                }
+                else
+                {
+                    while (out < end)
+                    {
+                        *out++ = *src++;
+                    }
+                }
+            }
+        }
+    } // namespace
+
+    bool inflate_raw(const uint8_t* input, size_t input_size, uint8_t* output, size_t output_size, size_t* decoded)
+    {
+        BitReader reader;
+        reader.in  = input;
+        reader.end = input + input_size;
+
+        uint8_t* out     = output;
+        uint8_t* out_end = output + output_size;
+
+        DecodeTables dynamic_tables;
+
+        bool final_block = false;
+        while (!final_block)
+        {
+            reader.refill();
+            final_block    = reader.read(1) != 0;
+            uint32_t btype = reader.read(2);
+
+            if (btype == 0)
+            {
+                // stored block, byte aligned LEN and NLEN
+                reader.consume(reader.count & 7);
+                const uint8_t* position = reader.position();
+                if (!reader.valid() || static_cast<size_t>(reader.end - position) < 4)
+                {
+                    return false;
+                }
+
+                uint32_t length  = position[0] | (position[1] << 8);
+                uint32_t nlength = position[2] | (position[3] << 8);
+                position += 4;
+                if ((length ^ 0xFFFF) != nlength || length > static_cast<size_t>(reader.end - position) || length > static_cast<size_t>(out_end - out))
+                {
+                    return false;
+                }
+
+                std::memcpy(out, position, length);
+                out += length;
+                reader.reset(position + length);
+            }
+            else if (btype == 1)
+            {
+                if (!decode_block(reader, fixed_tables(), output, out, out_end))
+                {
+                    return false;
+                }
+            }
+            else if (btype == 2)
+            {
+                if (!read_dynamic_tables(reader, dynamic_tables) || !decode_block(reader, dynamic_tables, output, out, out_end))
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        if (decoded)
+        {
+            *decoded = static_cast<size_t>(out - output);
+        }
+        return reader.valid();
+    }
+
+    bool inflate_zlib(const uint8_t* input, size_t input_size, uint8_t* output, size_t output_size, size_t* decoded)
+    {
+        if (input_size < 2)
+        {
+            return false;
+        }
+
+        uint32_t cmf = input[0];
+        uint32_t flg = input[1];
+        if ((cmf & 0x0F) != 8 || (cmf >> 4) > 7 || ((cmf << 8) | flg) % 31 != 0 || (flg & 0x20) != 0)
+        {
+            return false; // not deflate, bad check bits or a preset dictionary
+        }
+        return inflate_raw(input + 2, input_size - 2, output, output_size, decoded);
+    }
+} // namespace ArchViz
@@ -0,0 +1,14 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace ArchViz
+{
+    // deflate (rfc 1951) decoding into a caller buffer of known size, no streaming
+    // table driven with a 64 bit bit buffer, several literals per refill and word sized match copies
+    // returns false on corrupt data or when the output does not fit, decoded receives the bytes written
+    bool inflate_raw(const uint8_t* input, size_t input_size, uint8_t* output, size_t output_size, size_t* decoded = nullptr);
+
+    // zlib (rfc 1950) wrapper around inflate_raw, the adler32 trailer is not verified
+    bool inflate_zlib(const uint8_t* input, size_t input_size, uint8_t* output, size_t output_size, size_t* decoded = nullptr);
+} // namespace ArchViz
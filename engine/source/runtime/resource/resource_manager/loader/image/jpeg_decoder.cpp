@@ -0,0 +1,1282 @@
+#include "runtime/resource/resource_manager/loader/image/jpeg_decoder.h"
+
+#include "runtime/core/thread/work_executor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define ARCHVIZ_IMAGE_SSE2
+#endif
+
+#if defined(_MSC_VER)
+#include <stdlib.h>
+#endif
+
+namespace ArchViz
+{
+    namespace
+    {
+        constexpr uint32_t k_max_components   = 3;
+        constexpr uint32_t k_max_size         = 1u << 24; // same limit as stb_image
+        constexpr uint32_t k_fast_bits        = 9;
+        constexpr uint32_t k_units_per_job    = 512; // mcus (or blocks) of entropy data per parallel job
+        constexpr uint32_t k_mcu_rows_per_job = 4;
+        constexpr uint32_t k_rows_per_job     = 32;
+
+        constexpr uint8_t k_marker_sof0  = 0xC0;
+        constexpr uint8_t k_marker_sof1  = 0xC1;
+        constexpr uint8_t k_marker_dht   = 0xC4;
+        constexpr uint8_t k_marker_dac   = 0xCC;
+        constexpr uint8_t k_marker_soi   = 0xD8;
+        constexpr uint8_t k_marker_eoi   = 0xD9;
+        constexpr uint8_t k_marker_sos   = 0xDA;
+        constexpr uint8_t k_marker_dqt   = 0xDB;
+        constexpr uint8_t k_marker_dri   = 0xDD;
+        constexpr uint8_t k_marker_app0  = 0xE0;
+        constexpr uint8_t k_marker_app14 = 0xEE;
+
+        // natural order index of the k-th coefficient in the bitstream
+        constexpr uint8_t k_zigzag[64] = {0,  1,  8,  16, 9,  2,  3,  10, 17, 24, 32, 25, 18, 11, 4,  5,  12, 19, 26, 33, 40, 48,
+                                          41, 34, 27, 20, 13, 6,  7,  14, 21, 28, 35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23,
+                                          30, 37, 44, 51, 58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63};
+
+        // block flags
+        constexpr uint8_t k_block_full    = 0;
+        constexpr uint8_t k_block_dc_only = 1;
+        constexpr uint8_t k_block_missing = 2; // not covered by any scan
+
+        inline uint16_t read_be16(const uint8_t* p) { return static_cast<uint16_t>((p[0] << 8) | p[1]); }
+
+        inline uint64_t byte_swap(uint64_t value)
+        {
+#if defined(_MSC_VER)
+            return _byteswap_uint64(value);
+#else
+            return __builtin_bswap64(value);
+#endif
+        }
+
+        inline uint8_t clamp_byte(int32_t value) { return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value)); }
+
+        struct HuffmanTable
+        {
+            uint16_t fast[1u << k_fast_bits]; // (length << 8) | symbol, 0 when the code is longer than k_fast_bits
+            uint32_t maxcode[18] {};           // first code past each length, left aligned to 16 bits
+            int32_t  delta[17];                // symbol index = code + delta[length]
+            uint8_t  symbols[256];
+            uint32_t symbol_count {0};
+        };
+
+        struct JpegComponent
+        {
+            uint8_t  id {0};
+            uint32_t h {1};
+            uint32_t v {1};
+            uint32_t quant {0};
+            uint32_t dc_table {0};
+            uint32_t ac_table {0};
+
+            uint32_t width {0}; // samples actually covered by the image
+            uint32_t height {0};
+            uint32_t blocks_w {0}; // allocated blocks, whole mcus
+            uint32_t blocks_h {0};
+
+            int16_t* coefficients {nullptr}; // dequantized, natural order, 64 per block
+            uint8_t* flags {nullptr};
+            uint8_t* plane {nullptr}; // blocks_w * 8 wide
+        };
+
+        struct JpegFrame
+        {
+            bool     has_frame {false};
+            bool     native {false};
+            uint32_t width {0};
+            uint32_t height {0};
+            uint32_t component_count {0};
+
+            JpegComponent components[k_max_components];
+
+            uint32_t hmax {1};
+            uint32_t vmax {1};
+            uint32_t mcus_x {0};
+            uint32_t mcus_y {0};
+            uint32_t restart_interval {0};
+
+            uint16_t     quant[4][64] {}; // natural order
+            HuffmanTable dc[4];
+            HuffmanTable ac[4];
+
+            bool    jfif {false};
+            int32_t adobe_transform {-1};
+        };
+
+        struct JpegScan
+        {
+            uint32_t count {0};
+            uint32_t components[k_max_components] {};
+        };
+
+        struct EntropySegment
+        {
+            const uint8_t* begin;
+            const uint8_t* end;
+        };
+
+        // msb first bit buffer over entropy coded data, byte stuffing removed on the fly,
+        // a marker or the end of the segment feeds zeros like stb_image does
+        struct JpegBitReader
+        {
+            const uint8_t* p;
+            const uint8_t* end;
+            uint64_t       bits {0};
+            int32_t        count {0};
+
+            inline void refill()
+            {
+                if (end - p >= 8)
+                {
+                    uint64_t word;
+                    std::memcpy(&word, p, sizeof(word));
+                    uint64_t inverted = ~word;
+                    if (((inverted - 0x0101010101010101ull) & ~inverted & 0x8080808080808080ull) == 0)
+                    {
+                        // no 0xff in the next 8 bytes, the partial byte below count is rewritten with the same bits later
+                        bits |= byte_swap(word) >> count;
+                        int32_t bytes = (63 - count) >> 3;
+                        p += bytes;
+                        count += bytes * 8;
+                        return;
+                    }
+                }
+
+                while (count <= 56)
+                {
+                    uint64_t byte = 0;
+                    if (p < end)
+                    {
+                        byte = *p;
+                        if (byte != 0xFF)
+                        {
+                            ++p;
+                        }
+                        else if (p + 1 < end && p[1] == 0x00)
+                        {
+                            p += 2;
+                        }
+                        else
+                        {
+                            byte = 0;
+                            p    = end;
+                        }
+                    }
+                    bits |= byte << (56 - count);
+                    count += 8;
+                }
+            }
+
+            inline void consume(uint32_t n)
+            {
+                bits <<= n;
+                count -= static_cast<int32_t>(n);
+            }
+
+            // n in [1, 16]
+            inline uint32_t read(uint32_t n)
+            {
+                uint32_t value = static_cast<uint32_t>(bits >> (64 - n));
+                consume(n);
+                return value;
+            }
+        };
+
+        bool build_huffman(HuffmanTable& table, const uint8_t* counts, const uint8_t* symbols)
+        {
+            uint32_t total = 0;
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                total += counts[i];
+            }
+            if (total > 256)
+            {
+                return false;
+            }
+            table.symbol_count = total;
+            std::memcpy(table.symbols, symbols, total);
+            std::memset(table.fast, 0, sizeof(table.fast));
+
+            uint32_t code  = 0;
+            uint32_t index = 0;
+            for (uint32_t length = 1; length <= 16; ++length)
+            {
+                table.delta[length] = static_cast<int32_t>(index) - static_cast<int32_t>(code);
+                for (uint32_t i = 0; i < counts[length - 1]; ++i, ++index, ++code)
+                {
+                    if (length <= k_fast_bits)
+                    {
+                        uint32_t first = code << (k_fast_bits - length);
+                        uint32_t fill  = 1u << (k_fast_bits - length);
+                        for (uint32_t j = 0; j < fill; ++j)
+                        {
+                            table.fast[first + j] = static_cast<uint16_t>((length << 8) | symbols[index]);
+                        }
+                    }
+                }
+                if (counts[length - 1] != 0 && code - 1 >= (1u << length))
+                {
+                    return false; // more codes than the length allows
+                }
+                table.maxcode[length] = code << (16 - length);
+                code <<= 1;
+            }
+            table.maxcode[17] = 0xFFFFFFFF;
+            return true;
+        }
+
+        inline int32_t decode_symbol(JpegBitReader& reader, const HuffmanTable& table)
+        {
+            uint16_t entry = table.fast[reader.bits >> (64 - k_fast_bits)];
+            if (entry != 0)
+            {
+                reader.consume(entry >> 8);
+                return entry & 0xFF;
+            }
+
+            uint32_t code   = static_cast<uint32_t>(reader.bits >> 48);
+            uint32_t length = k_fast_bits + 1;
+            while (length <= 16 && code >= table.maxcode[length])
+            {
+                ++length;
+            }
+            if (length > 16)
+            {
+                return -1;
+            }
+
+            int32_t index = static_cast<int32_t>(code >> (16 - length)) + table.delta[length];
+            if (index < 0 || static_cast<uint32_t>(index) >= table.symbol_count)
+            {
+                return -1;
+            }
+            reader.consume(length);
+            return table.symbols[index];
+        }
+
+        inline int32_t extend(uint32_t value, uint32_t size) { return value < (1u << (size - 1)) ? static_cast<int32_t>(value) - (1 << size) + 1 : static_cast<int32_t>(value); }
+
+        bool decode_block(JpegBitReader& reader, const HuffmanTable& dc, const HuffmanTable& ac, const uint16_t* quant, int32_t& dc_pred, int16_t* block, uint8_t& flag)
+        {
+            std::memset(block, 0, 64 * sizeof(int16_t));
+
+            if (reader.count < 32)
+            {
+                reader.refill();
+            }
+            int32_t size = decode_symbol(reader, dc);
+            if (size < 0 || size > 11)
+            {
+                return false;
+            }
+            dc_pred += size != 0 ? extend(reader.read(size), size) : 0;
+            block[0] = static_cast<int16_t>(dc_pred * quant[0]);
+
+            flag = k_block_dc_only;
+            for (uint32_t k = 1; k < 64;)
+            {
+                if (reader.count < 32)
+                {
+                    reader.refill();
+                }
+                int32_t symbol = decode_symbol(reader, ac);
+                if (symbol < 0)
+                {
+                    return false;
+                }
+
+                uint32_t run  = static_cast<uint32_t>(symbol) >> 4;
+                uint32_t bits = static_cast<uint32_t>(symbol) & 15;
+                if (bits == 0)
+                {
+                    if (run != 15)
+                    {
+                        break; // end of block
+                    }
+                    k += 16;
+                    continue;
+                }
+
+                k += run;
+                if (k > 63)
+                {
+                    return false;
+                }
+                uint32_t position = k_zigzag[k++];
+                block[position]   = static_cast<int16_t>(extend(reader.read(bits), bits) * quant[position]);
+                flag              = k_block_full;
+            }
+            return true;
+        }
+
+        // fixed point islow idct (jidctint), 12 bit constants, 2 extra bits between the passes
+        constexpr int32_t fix(float x) { return static_cast<int32_t>(x * 4096.0f + 0.5f); }
+
+        constexpr int32_t k_c0  = fix(0.5411961f);
+        constexpr int32_t k_c1  = fix(-1.847759065f);
+        constexpr int32_t k_c2  = fix(0.765366865f);
+        constexpr int32_t k_c3  = fix(1.175875602f);
+        constexpr int32_t k_c4  = fix(0.298631336f);
+        constexpr int32_t k_c5  = fix(2.053119869f);
+        constexpr int32_t k_c6  = fix(3.072711026f);
+        constexpr int32_t k_c7  = fix(1.501321110f);
+        constexpr int32_t k_c8  = fix(-0.899976223f);
+        constexpr int32_t k_c9  = fix(-2.562915447f);
+        constexpr int32_t k_c10 = fix(-1.961570560f);
+        constexpr int32_t k_c11 = fix(-0.390180644f);
+
+        // even results x0..x3 and odd results t0..t3 of one 8 point pass, scaled by 4096
+        struct Idct1D
+        {
+            int32_t x0, x1, x2, x3;
+            int32_t t0, t1, t2, t3;
+
+            Idct1D(int32_t s0, int32_t s1, int32_t s2, int32_t s3, int32_t s4, int32_t s5, int32_t s6, int32_t s7)
+            {
+                int32_t p1 = (s2 + s6) * k_c0;
+                int32_t e2 = p1 + s6 * k_c1;
+                int32_t e3 = p1 + s2 * k_c2;
+                int32_t e0 = (s0 + s4) * 4096;
+                int32_t e1 = (s0 - s4) * 4096;
+                x0         = e0 + e3;
+                x3         = e0 - e3;
+                x1         = e1 + e2;
+                x2         = e1 - e2;
+
+                int32_t p3 = s7 + s3;
+                int32_t p4 = s5 + s1;
+                int32_t q1 = s7 + s1;
+                int32_t q2 = s5 + s3;
+                int32_t p5 = (p3 + p4) * k_c3;
+                t0         = s7 * k_c4;
+                t1         = s5 * k_c5;
+                t2         = s3 * k_c6;
+                t3         = s1 * k_c7;
+                q1         = p5 + q1 * k_c8;
+                q2         = p5 + q2 * k_c9;
+                p3         = p3 * k_c10;
+                p4         = p4 * k_c11;
+                t3 += q1 + p4;
+                t2 += q2 + p3;
+                t1 += q2 + p4;
+                t0 += q1 + p3;
+            }
+        };
+
+        void idct_block_scalar(const int16_t* in, uint8_t* out, size_t stride)
+        {
+            int32_t values[64];
+            for (uint32_t i = 0; i < 8; ++i)
+            {
+                const int16_t* d = in + i;
+                int32_t*       v = values + i;
+                if (d[8] == 0 && d[16] == 0 && d[24] == 0 && d[32] == 0 && d[40] == 0 && d[48] == 0 && d[56] == 0)
+                {
+                    int32_t dc = d[0] * 4;
+                    v[0] = v[8] = v[16] = v[24] = v[32] = v[40] = v[48] = v[56] = dc;
+                    continue;
+                }
+
+                Idct1D idct(d[0], d[8], d[16], d[24], d[32], d[40], d[48], d[56]);
+                idct.x0 += 512;
+                idct.x1 += 512;
+                idct.x2 += 512;
+                idct.x3 += 512;
+                v[0]  = (idct.x0 + idct.t3) >> 10;
+                v[56] = (idct.x0 - idct.t3) >> 10;
+                v[8]  = (idct.x1 + idct.t2) >> 10;
+                v[48] = (idct.x1 - idct.t2) >> 10;
+                v[16] = (idct.x2 + idct.t1) >> 10;
+                v[40] = (idct.x2 - idct.t1) >> 10;
+                v[24] = (idct.x3 + idct.t0) >> 10;
+                v[32] = (idct.x3 - idct.t0) >> 10;
+            }
+
+            // 12 bit constants twice, the 2 bits above and 3 bits of dct scale: shift by 17, with rounding and the +128 level shift
+            constexpr int32_t bias = 65536 + (128 << 17);
+            for (uint32_t i = 0; i < 8; ++i, out += stride)
+            {
+                const int32_t* v = values + i * 8;
+                Idct1D         idct(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7]);
+                idct.x0 += bias;
+                idct.x1 += bias;
+                idct.x2 += bias;
+                idct.x3 += bias;
+                out[0] = clamp_byte((idct.x0 + idct.t3) >> 17);
+                out[7] = clamp_byte((idct.x0 - idct.t3) >> 17);
+                out[1] = clamp_byte((idct.x1 + idct.t2) >> 17);
+                out[6] = clamp_byte((idct.x1 - idct.t2) >> 17);
+                out[2] = clamp_byte((idct.x2 + idct.t1) >> 17);
+                out[5] = clamp_byte((idct.x2 - idct.t1) >> 17);
+                out[3] = clamp_byte((idct.x3 + idct.t0) >> 17);
+                out[4] = clamp_byte((idct.x3 - idct.t0) >> 17);
+            }
+        }
+
+#ifdef ARCHVIZ_IMAGE_SSE2
+        // the same idct on 8 columns at once, products through pmaddwd on interleaved 16 bit pairs
+        struct Wide
+        {
+            __m128i lo;
+            __m128i hi;
+        };
+
+        inline __m128i pair_constant(int32_t x, int32_t y) { return _mm_setr_epi16(x, y, x, y, x, y, x, y); }
+
+        // a * c[even] + b * c[odd] per lane
+        inline Wide rotate(__m128i a, __m128i b, __m128i c)
+        {
+            return {_mm_madd_epi16(_mm_unpacklo_epi16(a, b), c), _mm_madd_epi16(_mm_unpackhi_epi16(a, b), c)};
+        }
+
+        // x << 12
+        inline Wide widen(__m128i x)
+        {
+            return {_mm_srai_epi32(_mm_unpacklo_epi16(_mm_setzero_si128(), x), 4), _mm_srai_epi32(_mm_unpackhi_epi16(_mm_setzero_si128(), x), 4)};
+        }
+
+        inline Wide add(const Wide& a, const Wide& b) { return {_mm_add_epi32(a.lo, b.lo), _mm_add_epi32(a.hi, b.hi)}; }
+        inline Wide sub(const Wide& a, const Wide& b) { return {_mm_sub_epi32(a.lo, b.lo), _mm_sub_epi32(a.hi, b.hi)}; }
+
+        template<int shift>
+        inline void butterfly(const Wide& a, const Wide& b, __m128i bias, __m128i& sum, __m128i& difference)
+        {
+            Wide biased = {_mm_add_epi32(a.lo, bias), _mm_add_epi32(a.hi, bias)};
+            Wide s      = add(biased, b);
+            Wide d      = sub(biased, b);
+            sum         = _mm_packs_epi32(_mm_srai_epi32(s.lo, shift), _mm_srai_epi32(s.hi, shift));
+            difference  = _mm_packs_epi32(_mm_srai_epi32(d.lo, shift), _mm_srai_epi32(d.hi, shift));
+        }
+
+        template<int shift>
+        inline void idct_pass(__m128i row[8], __m128i bias)
+        {
+            static const __m128i rot0_0 = pair_constant(k_c0, k_c0 + k_c1);
+            static const __m128i rot0_1 = pair_constant(k_c0 + k_c2, k_c0);
+            static const __m128i rot1_0 = pair_constant(k_c3 + k_c8, k_c3);
+            static const __m128i rot1_1 = pair_constant(k_c3, k_c3 + k_c9);
+            static const __m128i rot2_0 = pair_constant(k_c10 + k_c4, k_c10);
+            static const __m128i rot2_1 = pair_constant(k_c10, k_c10 + k_c6);
+            static const __m128i rot3_0 = pair_constant(k_c11 + k_c5, k_c11);
+            static const __m128i rot3_1 = pair_constant(k_c11, k_c11 + k_c7);
+
+            // even part
+            Wide t2 = rotate(row[2], row[6], rot0_0);
+            Wide t3 = rotate(row[2], row[6], rot0_1);
+            Wide t0 = widen(_mm_add_epi16(row[0], row[4]));
+            Wide t1 = widen(_mm_sub_epi16(row[0], row[4]));
+            Wide x0 = add(t0, t3);
+            Wide x3 = sub(t0, t3);
+            Wide x1 = add(t1, t2);
+            Wide x2 = sub(t1, t2);
+
+            // odd part
+            Wide    y0  = rotate(row[7], row[3], rot2_0);
+            Wide    y2  = rotate(row[7], row[3], rot2_1);
+            Wide    y1  = rotate(row[5], row[1], rot3_0);
+            Wide    y3  = rotate(row[5], row[1], rot3_1);
+            __m128i s17 = _mm_add_epi16(row[1], row[7]);
+            __m128i s35 = _mm_add_epi16(row[3], row[5]);
+            Wide    y4  = rotate(s17, s35, rot1_0);
+            Wide    y5  = rotate(s17, s35, rot1_1);
+            Wide    x4  = add(y0, y4);
+            Wide    x5  = add(y1, y5);
+            Wide    x6  = add(y2, y5);
+            Wide    x7  = add(y3, y4);
+
+            butterfly<shift>(x0, x7, bias, row[0], row[7]);
+            butterfly<shift>(x1, x6, bias, row[1], row[6]);
+            butterfly<shift>(x2, x5, bias, row[2], row[5]);
+            butterfly<shift>(x3, x4, bias, row[3], row[4]);
+        }
+
+        inline void interleave16(__m128i& a, __m128i& b)
+        {
+            __m128i t = a;
+            a         = _mm_unpacklo_epi16(a, b);
+            b         = _mm_unpackhi_epi16(t, b);
+        }
+
+        inline void interleave8(__m128i& a, __m128i& b)
+        {
+            __m128i t = a;
+            a         = _mm_unpacklo_epi8(a, b);
+            b         = _mm_unpackhi_epi8(t, b);
+        }
+
+        void idct_block_sse2(const int16_t* in, uint8_t* out, size_t stride)
+        {
+            __m128i row[8];
+            for (uint32_t i = 0; i < 8; ++i)
+            {
+                row[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * 8));
+            }
+
+            idct_pass<10>(row, _mm_set1_epi32(512));
+
+            // 8x8 16 bit transpose
+            interleave16(row[0], row[4]);
+            interleave16(row[1], row[5]);
+            interleave16(row[2], row[6]);
+            interleave16(row[3], row[7]);
+            interleave16(row[0], row[2]);
+            interleave16(row[1], row[3]);
+            interleave16(row[4], row[6]);
+            interleave16(row[5], row[7]);
+            interleave16(row[0], row[1]);
+            interleave16(row[2], row[3]);
+            interleave16(row[4], row[5]);
+            interleave16(row[6], row[7]);
+
+            idct_pass<17>(row, _mm_set1_epi32(65536 + (128 << 17)));
+
+            // saturate to bytes and transpose back, rows come out in the order 0 1 4 5 2 3 6 7
+            __m128i p0 = _mm_packus_epi16(row[0], row[1]);
+            __m128i p1 = _mm_packus_epi16(row[2], row[3]);
+            __m128i p2 = _mm_packus_epi16(row[4], row[5]);
+            __m128i p3 = _mm_packus_epi16(row[6], row[7]);
+            interleave8(p0, p2);
+            interleave8(p1, p3);
+            interleave8(p0, p1);
+            interleave8(p2, p3);
+            interleave8(p0, p2);
+            interleave8(p1, p3);
+
+            const __m128i rows[4] = {p0, p2, p1, p3};
+            for (uint32_t i = 0; i < 4; ++i)
+            {
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(out + stride * (i * 2)), rows[i]);
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(out + stride * (i * 2 + 1)), _mm_shuffle_epi32(rows[i], 0x4E));
+            }
+        }
+#endif
+
+        inline void idct_block(const int16_t* in, uint8_t* out, size_t stride)
+        {
+#ifdef ARCHVIZ_IMAGE_SSE2
+            idct_block_sse2(in, out, stride);
+#else
+            idct_block_scalar(in, out, stride);
+#endif
+        }
+
+        void fill_block(uint8_t value, uint8_t* out, size_t stride)
+        {
+            for (uint32_t i = 0; i < 8; ++i, out += stride)
+            {
+                std::memset(out, value, 8);
+            }
+        }
+
+        // markers and segments
+
+        bool parse_frame(uint8_t marker, const uint8_t* payload, uint32_t length, JpegFrame& frame)
+        {
+            if (frame.has_frame || length < 6)
+            {
+                return false;
+            }
+
+            frame.has_frame       = true;
+            frame.height          = read_be16(payload + 1);
+            frame.width           = read_be16(payload + 3);
+            frame.component_count = payload[5];
+            if (length < 6 + frame.component_count * 3)
+            {
+                return false;
+            }
+
+            // progressive, arithmetic, lossless, 12 bit, cmyk and dnl heights are left to stb_image
+            frame.native = (marker == k_marker_sof0 || marker == k_marker_sof1) && payload[0] == 8 && (frame.component_count == 1 || frame.component_count == 3) &&
+                           frame.width != 0 && frame.height != 0 && frame.width <= k_max_size && frame.height <= k_max_size;
+            if (!frame.native)
+            {
+                return true;
+            }
+
+            for (uint32_t i = 0; i < frame.component_count; ++i)
+            {
+                JpegComponent& component = frame.components[i];
+                const uint8_t* p         = payload + 6 + i * 3;
+                component.id             = p[0];
+                component.h              = p[1] >> 4;
+                component.v              = p[1] & 15;
+                component.quant          = p[2];
+                if (component.h == 0 || component.h > 4 || component.v == 0 || component.v > 4 || component.quant > 3)
+                {
+                    return false;
+                }
+                // a single component is never interleaved, its mcu is one block whatever the sampling factors say
+                if (frame.component_count == 1)
+                {
+                    component.h = 1;
+                    component.v = 1;
+                }
+                frame.hmax = std::max(frame.hmax, component.h);
+                frame.vmax = std::max(frame.vmax, component.v);
+            }
+
+            frame.mcus_x = (frame.width + frame.hmax * 8 - 1) / (frame.hmax * 8);
+            frame.mcus_y = (frame.height + frame.vmax * 8 - 1) / (frame.vmax * 8);
+            for (uint32_t i = 0; i < frame.component_count; ++i)
+            {
+                JpegComponent& component = frame.components[i];
+                // only integer upsampling ratios are handled natively
+                if (frame.hmax % component.h != 0 || frame.vmax % component.v != 0)
+                {
+                    frame.native = false;
+                }
+                component.width    = (frame.width * component.h + frame.hmax - 1) / frame.hmax;
+                component.height   = (frame.height * component.v + frame.vmax - 1) / frame.vmax;
+                component.blocks_w = frame.mcus_x * component.h;
+                component.blocks_h = frame.mcus_y * component.v;
+            }
+            return true;
+        }
+
+        bool parse_quant(const uint8_t* payload, uint32_t length, JpegFrame& frame)
+        {
+            while (length > 0)
+            {
+                uint32_t precision = payload[0] >> 4;
+                uint32_t id        = payload[0] & 15;
+                uint32_t size      = precision == 0 ? 64 : 128;
+                if (precision > 1 || id > 3 || length < 1 + size)
+                {
+                    return false;
+                }
+                for (uint32_t k = 0; k < 64; ++k)
+                {
+                    frame.quant[id][k_zigzag[k]] = precision == 0 ? payload[1 + k] : read_be16(payload + 1 + k * 2);
+                }
+                payload += 1 + size;
+                length -= 1 + size;
+            }
+            return true;
+        }
+
+        bool parse_huffman(const uint8_t* payload, uint32_t length, JpegFrame& frame)
+        {
+            while (length > 0)
+            {
+                if (length < 17)
+                {
+                    return false;
+                }
+                uint32_t table_class = payload[0] >> 4;
+                uint32_t id          = payload[0] & 15;
+                uint32_t total       = 0;
+                for (uint32_t i = 0; i < 16; ++i)
+                {
+                    total += payload[1 + i];
+                }
+                if (table_class > 1 || id > 3 || length < 17 + total)
+                {
+                    return false;
+                }
+                HuffmanTable& table = table_class == 0 ? frame.dc[id] : frame.ac[id];
+                if (!build_huffman(table, payload + 1, payload + 17))
+                {
+                    return false;
+                }
+                payload += 17 + total;
+                length -= 17 + total;
+            }
+            return true;
+        }
+
+        bool parse_scan(const uint8_t* payload, uint32_t length, JpegFrame& frame, JpegScan& scan)
+        {
+            if (length < 1)
+            {
+                return false;
+            }
+            scan.count = payload[0];
+            if (scan.count == 0 || scan.count > frame.component_count || length != 4 + scan.count * 2)
+            {
+                return false;
+            }
+
+            for (uint32_t i = 0; i < scan.count; ++i)
+            {
+                const uint8_t* p     = payload + 1 + i * 2;
+                uint32_t       index = 0;
+                while (index < frame.component_count && frame.components[index].id != p[0])
+                {
+                    ++index;
+                }
+                if (index == frame.component_count || p[1] >> 4 > 3 || (p[1] & 15) > 3)
+                {
+                    return false;
+                }
+                frame.components[index].dc_table = p[1] >> 4;
+                frame.components[index].ac_table = p[1] & 15;
+                scan.components[i]               = index;
+            }
+
+            // baseline scans always cover the whole spectrum without successive approximation
+            const uint8_t* spectral = payload + 1 + scan.count * 2;
+            return spectral[0] == 0 && spectral[1] == 63 && spectral[2] == 0;
+        }
+
+        // splits the entropy coded data at restart markers, returns the first byte after the scan
+        const uint8_t* find_segments(const uint8_t* p, const uint8_t* end, std::vector<EntropySegment>& segments)
+        {
+            segments.clear();
+            const uint8_t* begin = p;
+            while (p < end)
+            {
+                p = static_cast<const uint8_t*>(std::memchr(p, 0xFF, end - p));
+                if (p == nullptr || p + 1 >= end)
+                {
+                    p = end;
+                    break;
+                }
+
+                uint8_t next = p[1];
+                if (next == 0x00)
+                {
+                    p += 2;
+                }
+                else if (next == 0xFF)
+                {
+                    ++p; // fill byte
+                }
+                else if (next >= 0xD0 && next <= 0xD7)
+                {
+                    segments.push_back({begin, p});
+                    p += 2;
+                    begin = p;
+                }
+                else
+                {
+                    break;
+                }
+            }
+            segments.push_back({begin, p});
+            return p;
+        }
+
+        bool decode_units(const JpegFrame& frame, const JpegScan& scan, const EntropySegment& segment, uint32_t first, uint32_t count)
+        {
+            JpegBitReader reader;
+            reader.p   = segment.begin;
+            reader.end = segment.end;
+
+            int32_t dc_pred[k_max_components] = {};
+
+            if (scan.count == 1)
+            {
+                // non interleaved: blocks of one component in raster order over its own size
+                const JpegComponent& component = frame.components[scan.components[0]];
+                const uint32_t       blocks_x  = (component.width + 7) / 8;
+                for (uint32_t unit = first; unit < first + count; ++unit)
+                {
+                    uint32_t block = (unit / blocks_x) * component.blocks_w + unit % blocks_x;
+                    if (!decode_block(reader,
+                                      frame.dc[component.dc_table],
+                                      frame.ac[component.ac_table],
+                                      frame.quant[component.quant],
+                                      dc_pred[0],
+                                      component.coefficients + block * 64,
+                                      component.flags[block]))
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            for (uint32_t unit = first; unit < first + count; ++unit)
+            {
+                uint32_t mcu_x = unit % frame.mcus_x;
+                uint32_t mcu_y = unit / frame.mcus_x;
+                for (uint32_t i = 0; i < scan.count; ++i)
+                {
+                    const JpegComponent& component = frame.components[scan.components[i]];
+                    for (uint32_t y = 0; y < component.v; ++y)
+                    {
+                        for (uint32_t x = 0; x < component.h; ++x)
+                        {
+                            uint32_t block = (mcu_y * component.v + y) * component.blocks_w + mcu_x * component.h + x;
+                            if (!decode_block(reader,
+                                              frame.dc[component.dc_table],
+                                              frame.ac[component.ac_table],
+                                              frame.quant[component.quant],
+                                              dc_pred[i],
+                                              component.coefficients + block * 64,
+                                              component.flags[block]))
+                            {
+                                return false;
+                            }
+                        }
+                    }
+                }
+            }
+            return true;
+        }
+
+        bool decode_scan(const JpegFrame& frame, const JpegScan& scan, const std::vector<EntropySegment>& segments, const std::shared_ptr<WorkExecutor>& executor)
+        {
+            uint32_t total = frame.mcus_x * frame.mcus_y;
+            if (scan.count == 1)
+            {
+                const JpegComponent& component = frame.components[scan.components[0]];
+                total                          = ((component.width + 7) / 8) * ((component.height + 7) / 8);
+            }
+
+            const uint32_t interval = frame.restart_interval != 0 ? frame.restart_interval : total;
+            const uint32_t expected = (total + interval - 1) / interval;
+            if (segments.size() < expected)
+            {
+                return false; // damaged restart markers, stb_image resynchronizes on its own
+            }
+
+            // every restart interval starts with fresh predictors and a byte aligned bit stream
+            std::atomic<bool> failed {false};
+            parallel_for(executor, expected, std::max(1u, k_units_per_job / interval), [&](uint32_t begin, uint32_t end) {
+                for (uint32_t i = begin; i < end && !failed; ++i)
+                {
+                    uint32_t first = i * interval;
+                    if (!decode_units(frame, scan, segments[i], first, std::min(interval, total - first)))
+                    {
+                        failed = true;
+                    }
+                }
+            });
+            return !failed;
+        }
+
+        // walks the markers up to the frame header, or through the whole file decoding every scan
+        bool read_markers(const uint8_t* data, size_t size, JpegFrame& frame, bool decode_scans, const std::shared_ptr<WorkExecutor>& executor)
+        {
+            if (!JpegDecoder::isJpeg(data, size))
+            {
+                return false;
+            }
+
+            std::vector<EntropySegment> segments;
+
+            const uint8_t* p        = data + 2;
+            const uint8_t* end      = data + size;
+            bool           has_scan = false;
+            for (;;)
+            {
+                // markers may be padded with any number of 0xff
+                while (p < end && *p != 0xFF)
+                {
+                    ++p;
+                }
+                while (p < end && *p == 0xFF)
+                {
+                    ++p;
+                }
+                if (p >= end)
+                {
+                    return has_scan; // a missing eoi is tolerated
+                }
+
+                uint8_t marker = *p++;
+                if (marker == k_marker_eoi)
+                {
+                    return has_scan;
+                }
+                if (marker == k_marker_soi || (marker >= 0xD0 && marker <= 0xD7) || marker == 0x01)
+                {
+                    continue; // no payload
+                }
+
+                if (end - p < 2)
+                {
+                    return false;
+                }
+                uint32_t length = read_be16(p);
+                if (length < 2 || length > static_cast<size_t>(end - p))
+                {
+                    return false;
+                }
+                const uint8_t* payload = p + 2;
+                length -= 2;
+                p = payload + length;
+
+                bool is_frame = marker >= 0xC0 && marker <= 0xCF && marker != k_marker_dht && marker != 0xC8 && marker != k_marker_dac;
+                if (is_frame)
+                {
+                    if (!parse_frame(marker, payload, length, frame))
+                    {
+                        return false;
+                    }
+                    if (!decode_scans || !frame.native)
+                    {
+                        return true;
+                    }
+                    continue;
+                }
+
+                if (!decode_scans)
+                {
+                    continue;
+                }
+
+                switch (marker)
+                {
+                    case k_marker_dqt:
+                        if (!parse_quant(payload, length, frame))
+                        {
+                            return false;
+                        }
+                        break;
+                    case k_marker_dht:
+                        if (!parse_huffman(payload, length, frame))
+                        {
+                            return false;
+                        }
+                        break;
+                    case k_marker_dri:
+                        if (length != 2)
+                        {
+                            return false;
+                        }
+                        frame.restart_interval = read_be16(payload);
+                        break;
+                    case k_marker_app0:
+                        frame.jfif = frame.jfif || (length >= 5 && std::memcmp(payload, "JFIF\0", 5) == 0);
+                        break;
+                    case k_marker_app14:
+                        if (length >= 12 && std::memcmp(payload, "Adobe", 5) == 0)
+                        {
+                            frame.adobe_transform = payload[11];
+                        }
+                        break;
+                    case k_marker_sos: {
+                        JpegScan scan;
+                        if (!frame.has_frame || !parse_scan(payload, length, frame, scan))
+                        {
+                            return false;
+                        }
+                        p = find_segments(p, end, segments);
+                        if (!decode_scan(frame, scan, segments, executor))
+                        {
+                            return false;
+                        }
+                        has_scan = true;
+                        break;
+                    }
+                    default:
+                        break; // other app segments, comments
+                }
+            }
+        }
+
+        void reconstruct_planes(const JpegFrame& frame, const std::shared_ptr<WorkExecutor>& executor)
+        {
+            parallel_for(executor, frame.mcus_y, k_mcu_rows_per_job, [&frame](uint32_t begin, uint32_t end) {
+                for (uint32_t i = 0; i < frame.component_count; ++i)
+                {
+                    const JpegComponent& component = frame.components[i];
+                    const size_t         stride    = static_cast<size_t>(component.blocks_w) * 8;
+                    for (uint32_t by = begin * component.v; by < end * component.v; ++by)
+                    {
+                        for (uint32_t bx = 0; bx < component.blocks_w; ++bx)
+                        {
+                            const size_t   block = static_cast<size_t>(by) * component.blocks_w + bx;
+                            const int16_t* in    = component.coefficients + block * 64;
+                            uint8_t*       out   = component.plane + by * 8 * stride + bx * 8;
+                            switch (component.flags[block])
+                            {
+                                case k_block_full:
+                                    idct_block(in, out, stride);
+                                    break;
+                                case k_block_dc_only:
+                                    fill_block(clamp_byte(((in[0] + 4) >> 3) + 128), out, stride);
+                                    break;
+                                default:
+                                    fill_block(128, out, stride);
+                                    break;
+                            }
+                        }
+                    }
+                }
+            });
+        }
+
+        // upsampling to the full width, the 2x cases use the triangle filter of libjpeg / stb_image
+
+        void upsample_h2v2(const uint8_t* near, const uint8_t* far, uint32_t width, uint8_t* out)
+        {
+            if (width == 1)
+            {
+                out[0] = out[1] = static_cast<uint8_t>((3 * near[0] + far[0] + 2) >> 2);
+                return;
+            }
+            uint32_t t1 = 3 * near[0] + far[0];
+            out[0]      = static_cast<uint8_t>((t1 + 2) >> 2);
+            for (uint32_t i = 1; i < width; ++i)
+            {
+                uint32_t t0    = t1;
+                t1             = 3 * near[i] + far[i];
+                out[i * 2 - 1] = static_cast<uint8_t>((3 * t0 + t1 + 8) >> 4);
+                out[i * 2]     = static_cast<uint8_t>((3 * t1 + t0 + 8) >> 4);
+            }
+            out[width * 2 - 1] = static_cast<uint8_t>((t1 + 2) >> 2);
+        }
+
+        void upsample_h2v1(const uint8_t* in, uint32_t width, uint8_t* out)
+        {
+            if (width == 1)
+            {
+                out[0] = out[1] = in[0];
+                return;
+            }
+            out[0] = in[0];
+            out[1] = static_cast<uint8_t>((in[0] * 3 + in[1] + 2) >> 2);
+            uint32_t i = 1;
+            for (; i < width - 1; ++i)
+            {
+                uint32_t n     = 3 * in[i] + 2;
+                out[i * 2]     = static_cast<uint8_t>((n + in[i - 1]) >> 2);
+                out[i * 2 + 1] = static_cast<uint8_t>((n + in[i + 1]) >> 2);
+            }
+            out[i * 2]     = static_cast<uint8_t>((in[width - 2] * 3 + in[width - 1] + 2) >> 2);
+            out[i * 2 + 1] = in[width - 1];
+        }
+
+        void upsample_h1v2(const uint8_t* near, const uint8_t* far, uint32_t width, uint8_t* out)
+        {
+            for (uint32_t i = 0; i < width; ++i)
+            {
+                out[i] = static_cast<uint8_t>((3 * near[i] + far[i] + 2) >> 2);
+            }
+        }
+
+        void upsample_nearest(const uint8_t* in, uint32_t width, uint32_t factor, uint8_t* out)
+        {
+            for (uint32_t i = 0; i < width; ++i)
+            {
+                std::memset(out + i * factor, in[i], factor);
+            }
+        }
+
+        // row y of a component at full resolution, either straight from the plane or upsampled into scratch
+        const uint8_t* component_row(const JpegFrame& frame, const JpegComponent& component, uint32_t y, uint8_t* scratch)
+        {
+            const size_t   stride = static_cast<size_t>(component.blocks_w) * 8;
+            const uint32_t hs     = frame.hmax / component.h;
+            const uint32_t vs     = frame.vmax / component.v;
+            if (hs == 1 && vs == 1)
+            {
+                return component.plane + y * stride;
+            }
+
+            const uint32_t row  = y / vs;
+            const uint8_t* near = component.plane + row * stride;
+            if (vs == 2)
+            {
+                // odd rows blend with the row below, even rows with the row above, clamped at the edges
+                uint32_t       far_row = (y & 1) ? std::min(row + 1, component.height - 1) : (row == 0 ? 0 : row - 1);
+                const uint8_t* far     = component.plane + far_row * stride;
+                if (hs == 2)
+                {
+                    upsample_h2v2(near, far, component.width, scratch);
+                    return scratch;
+                }
+                if (hs == 1)
+                {
+                    upsample_h1v2(near, far, component.width, scratch);
+                    return scratch;
+                }
+            }
+            else if (vs == 1 && hs == 2)
+            {
+                upsample_h2v1(near, component.width, scratch);
+                return scratch;
+            }
+
+            upsample_nearest(near, component.width, hs, scratch);
+            return scratch;
+        }
+
+        // 14 bit fixed point ycbcr to rgb
+        constexpr int32_t k_cr_r = 22970;  // 1.402
+        constexpr int32_t k_cr_g = -11700; // -0.71414
+        constexpr int32_t k_cb_g = -5638;  // -0.34414
+        constexpr int32_t k_cb_b = 29032;  // 1.772
+
+        void ycbcr_to_rgba(const uint8_t* y, const uint8_t* cb, const uint8_t* cr, uint32_t width, uint8_t* out)
+        {
+            uint32_t i = 0;
+#ifdef ARCHVIZ_IMAGE_SSE2
+            const __m128i zero     = _mm_setzero_si128();
+            const __m128i offset   = _mm_set1_epi16(128);
+            const __m128i rounding = _mm_set1_epi32(8192);
+            const __m128i r_coeff  = pair_constant(k_cr_r, 1);
+            const __m128i g_coeff  = pair_constant(k_cr_g, k_cb_g);
+            const __m128i b_coeff  = pair_constant(k_cb_b, 1);
+            const __m128i alpha    = _mm_set1_epi8(static_cast<char>(0xFF));
+            const __m128i round16  = _mm_set1_epi16(8192);
+
+            for (; i + 8 <= width; i += 8)
+            {
+                __m128i y16  = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(y + i)), zero);
+                __m128i cb16 = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(cb + i)), zero), offset);
+                __m128i cr16 = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(cr + i)), zero), offset);
+
+                // the rounding term rides along as the second product of the r and b pairs
+                Wide r = rotate(cr16, round16, r_coeff);
+                Wide g = rotate(cr16, cb16, g_coeff);
+                Wide b = rotate(cb16, round16, b_coeff);
+                g      = {_mm_add_epi32(g.lo, rounding), _mm_add_epi32(g.hi, rounding)};
+
+                __m128i r16 = _mm_add_epi16(y16, _mm_packs_epi32(_mm_srai_epi32(r.lo, 14), _mm_srai_epi32(r.hi, 14)));
+                __m128i g16 = _mm_add_epi16(y16, _mm_packs_epi32(_mm_srai_epi32(g.lo, 14), _mm_srai_epi32(g.hi, 14)));
+                __m128i b16 = _mm_add_epi16(y16, _mm_packs_epi32(_mm_srai_epi32(b.lo, 14), _mm_srai_epi32(b.hi, 14)));
+
+                __m128i r8 = _mm_packus_epi16(r16, r16);
+                __m128i g8 = _mm_packus_epi16(g16, g16);
+                __m128i b8 = _mm_packus_epi16(b16, b16);
+
+                __m128i rg = _mm_unpacklo_epi8(r8, g8);
+                __m128i ba = _mm_unpacklo_epi8(b8, alpha);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 4), _mm_unpacklo_epi16(rg, ba));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 4 + 16), _mm_unpackhi_epi16(rg, ba));
+            }
+#endif
+            for (; i < width; ++i)
+            {
+                int32_t luma      = y[i];
+                int32_t blue_diff = cb[i] - 128;
+                int32_t red_diff  = cr[i] - 128;
+                out[i * 4 + 0]    = clamp_byte(luma + ((red_diff * k_cr_r + 8192) >> 14));
+                out[i * 4 + 1]    = clamp_byte(luma + ((red_diff * k_cr_g + blue_diff * k_cb_g + 8192) >> 14));
+                out[i * 4 + 2]    = clamp_byte(luma + ((blue_diff * k_cb_b + 8192) >> 14));
+                out[i * 4 + 3]    = 255;
+            }
+        }
+
+        void convert_rows(const JpegFrame& frame, uint8_t* output, const std::shared_ptr<WorkExecutor>& executor)
+        {
+            // components labelled r g b, or an adobe marker without jfif saying no transform, are stored as rgb
+            const JpegComponent* components = frame.components;
+            const bool           is_rgb     = frame.component_count == 3 &&
+                                ((components[0].id == 'R' && components[1].id == 'G' && components[2].id == 'B') || (frame.adobe_transform == 0 && !frame.jfif));
+
+            const size_t scratch_width = static_cast<size_t>(frame.mcus_x) * frame.hmax * 8 + 16;
+            parallel_for(executor, frame.height, k_rows_per_job, [&](uint32_t begin, uint32_t end) {
+                std::vector<uint8_t> scratch(scratch_width * k_max_components);
+                for (uint32_t y = begin; y < end; ++y)
+                {
+                    uint8_t* out = output + static_cast<size_t>(y) * frame.width * 4;
+                    if (frame.component_count == 1)
+                    {
+                        const uint8_t* gray = components[0].plane + static_cast<size_t>(y) * components[0].blocks_w * 8;
+                        for (uint32_t x = 0; x < frame.width; ++x)
+                        {
+                            out[x * 4 + 0] = gray[x];
+                            out[x * 4 + 1] = gray[x];
+                            out[x * 4 + 2] = gray[x];
+                            out[x * 4 + 3] = 255;
+                        }
+                        continue;
+                    }
+
+                    const uint8_t* c0 = component_row(frame, components[0], y, scratch.data());
+                    const uint8_t* c1 = component_row(frame, components[1], y, scratch.data() + scratch_width);
+                    const uint8_t* c2 = component_row(frame, components[2], y, scratch.data() + scratch_width * 2);
+                    if (is_rgb)
+                    {
+                        for (uint32_t x = 0; x < frame.width; ++x)
+                        {
+                            out[x * 4 + 0] = c0[x];
+                            out[x * 4 + 1] = c1[x];
+                            out[x * 4 + 2] = c2[x];
+                            out[x * 4 + 3] = 255;
+                        }
+                    }
+                    else
+                    {
+                        ycbcr_to_rgba(c0, c1, c2, frame.width, out);
+                    }
+                }
+            });
+        }
+    } // namespace
+
+    bool JpegDecoder::isJpeg(const uint8_t* data, size_t size) { return size >= 3 && data[0] == 0xFF && data[1] == k_marker_soi && data[2] == 0xFF; }
+
+    bool JpegDecoder::probe(const uint8_t* data, size_t size, ImageInfo& info)
+    {
+        JpegFrame frame;
+        if (!read_markers(data, size, frame, false, nullptr) || !frame.has_frame || frame.width == 0 || frame.height == 0)
+        {
+            return false;
+        }
+
+        info.format   = ImageFileFormat::JPEG;
+        info.width    = frame.width;
+        info.height   = frame.height;
+        info.channels = frame.component_count;
+        info.native   = frame.native;
+        return true;
+    }
+
+    bool JpegDecoder::decode(const uint8_t* data, size_t size, uint8_t* output, size_t output_size, std::shared_ptr<WorkExecutor> executor)
+    {
+        std::unique_ptr<JpegFrame> frame = std::make_unique<JpegFrame>();
+
+        // the frame header comes first, the buffers for every block are laid out before any scan is decoded
+        if (!read_markers(data, size, *frame, false, nullptr) || !frame->native ||
+            output_size < static_cast<size_t>(frame->width) * frame->height * 4)
+        {
+            return false;
+        }
+
+        size_t block_count = 0;
+        for (uint32_t i = 0; i < frame->component_count; ++i)
+        {
+            block_count += static_cast<size_t>(frame->components[i].blocks_w) * frame->components[i].blocks_h;
+        }
+
+        // scratch only grows, decoding many textures on one thread reuses it
+        thread_local std::vector<int16_t> s_coefficients;
+        thread_local std::vector<uint8_t> s_planes;
+        thread_local std::vector<uint8_t> s_flags;
+        if (s_coefficients.size() < block_count * 64)
+        {
+            s_coefficients.resize(block_count * 64);
+            s_planes.resize(block_count * 64);
+        }
+        s_flags.assign(block_count, k_block_missing);
+
+        size_t offset = 0;
+        for (uint32_t i = 0; i < frame->component_count; ++i)
+        {
+            JpegComponent& component = frame->components[i];
+            component.coefficients   = s_coefficients.data() + offset * 64;
+            component.plane          = s_planes.data() + offset * 64;
+            component.flags          = s_flags.data() + offset;
+            offset += static_cast<size_t>(component.blocks_w) * component.blocks_h;
+        }
+
+        // second pass over the whole file, the frame header parses to the same layout and keeps the buffers
+        frame->has_frame = false;
+        if (!read_markers(data, size, *frame, true, executor) || !frame->native)
+        {
+            return false;
+        }
+
+        reconstruct_planes(*frame, executor);
+        convert_rows(*frame, output, executor);
+        return true;
+    }
+} // namespace ArchViz
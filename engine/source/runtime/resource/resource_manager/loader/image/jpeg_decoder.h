@@ -0,0 +1,17 @@
+#pragma once
+#include "runtime/resource/resource_manager/loader/image/image_decoder.h"
+
+namespace ArchViz
+{
+    // baseline huffman jpeg, 8 bit, grayscale or three components with any integer chroma subsampling
+    // restart intervals are entropy decoded in parallel, idct and colour conversion run per mcu row / row band
+    // upsampling and colour conversion follow stb_image (triangle filter for 2x, 14 bit fixed point ycbcr)
+    class JpegDecoder
+    {
+    public:
+        static bool isJpeg(const uint8_t* data, size_t size);
+
+        static bool probe(const uint8_t* data, size_t size, ImageInfo& info);
+        static bool decode(const uint8_t* data, size_t size, uint8_t* output, size_t output_size, std::shared_ptr<WorkExecutor> executor);
+    };
+} // namespace ArchViz
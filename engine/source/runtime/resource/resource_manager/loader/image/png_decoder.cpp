@@ -0,0 +1,578 @@
+#include "runtime/resource/resource_manager/loader/image/png_decoder.h"
+#include "runtime/resource/resource_manager/loader/image/inflate.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define ARCHVIZ_IMAGE_SSE2
+#endif
+
+namespace ArchViz
+{
+    namespace
+    {
+        constexpr uint8_t  k_signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        constexpr uint32_t k_max_size     = 1u << 24; // same limit as stb_image
+
+        enum ColourType : uint8_t
+        {
+            k_gray       = 0,
+            k_rgb        = 2,
+            k_palette    = 3,
+            k_gray_alpha = 4,
+            k_rgba       = 6,
+        };
+
+        enum Filter : uint8_t
+        {
+            k_filter_none  = 0,
+            k_filter_sub   = 1,
+            k_filter_up    = 2,
+            k_filter_avg   = 3,
+            k_filter_paeth = 4,
+        };
+
+        constexpr uint32_t make_chunk_type(char a, char b, char c, char d)
+        {
+            return (static_cast<uint32_t>(a) << 24) | (static_cast<uint32_t>(b) << 16) | (static_cast<uint32_t>(c) << 8) | static_cast<uint32_t>(d);
+        }
+
+        constexpr uint32_t k_chunk_ihdr = make_chunk_type('I', 'H', 'D', 'R');
+        constexpr uint32_t k_chunk_plte = make_chunk_type('P', 'L', 'T', 'E');
+        constexpr uint32_t k_chunk_trns = make_chunk_type('t', 'R', 'N', 'S');
+        constexpr uint32_t k_chunk_idat = make_chunk_type('I', 'D', 'A', 'T');
+        constexpr uint32_t k_chunk_iend = make_chunk_type('I', 'E', 'N', 'D');
+
+        inline uint32_t read_be32(const uint8_t* p) { return (static_cast<uint32_t>(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3]; }
+        inline uint16_t read_be16(const uint8_t* p) { return static_cast<uint16_t>((p[0] << 8) | p[1]); }
+
+        struct PngHeader
+        {
+            uint32_t width {0};
+            uint32_t height {0};
+            uint8_t  depth {0};
+            uint8_t  colour_type {0};
+            uint8_t  interlace {0};
+            uint32_t channels {0}; // samples per pixel in the file
+
+            uint8_t  palette[256 * 4] {};
+            uint32_t palette_size {0};
+            bool     palette_alpha {false};
+
+            bool     has_key {false}; // trns colour key of gray / rgb images
+            uint16_t key[3] {};
+
+            const uint8_t* idat {nullptr};
+            size_t         idat_size {0};
+        };
+
+        bool valid_depth(uint8_t colour_type, uint8_t depth)
+        {
+            switch (colour_type)
+            {
+                case k_gray:
+                    return depth == 1 || depth == 2 || depth == 4 || depth == 8 || depth == 16;
+                case k_palette:
+                    return depth == 1 || depth == 2 || depth == 4 || depth == 8;
+                case k_rgb:
+                case k_gray_alpha:
+                case k_rgba:
+                    return depth == 8 || depth == 16;
+                default:
+                    return false;
+            }
+        }
+
+        uint32_t colour_channels(uint8_t colour_type)
+        {
+            switch (colour_type)
+            {
+                case k_gray:
+                case k_palette:
+                    return 1;
+                case k_gray_alpha:
+                    return 2;
+                case k_rgb:
+                    return 3;
+                default:
+                    return 4;
+            }
+        }
+
+        // walks the chunks up to the first idat, or through all of them when gathering the image data
+        bool parse(const uint8_t* data, size_t size, PngHeader& header, bool gather_idat)
+        {
+            if (!PngDecoder::isPng(data, size))
+            {
+                return false;
+            }
+
+            thread_local std::vector<uint8_t> s_idat;
+            s_idat.clear();
+            uint32_t idat_count = 0;
+
+            bool           has_header = false;
+            const uint8_t* p          = data + sizeof(k_signature);
+            const uint8_t* end        = data + size;
+            while (static_cast<size_t>(end - p) >= 12)
+            {
+                const uint32_t length = read_be32(p);
+                const uint32_t type   = read_be32(p + 4);
+                const uint8_t* chunk  = p + 8;
+                if (length > static_cast<size_t>(end - chunk) - 4)
+                {
+                    return false;
+                }
+                p = chunk + length + 4; // crc is not checked
+
+                if (!has_header && type != k_chunk_ihdr)
+                {
+                    return false;
+                }
+
+                if (type == k_chunk_ihdr)
+                {
+                    if (has_header || length != 13)
+                    {
+                        return false;
+                    }
+                    header.width       = read_be32(chunk);
+                    header.height      = read_be32(chunk + 4);
+                    header.depth       = chunk[8];
+                    header.colour_type = chunk[9];
+                    header.interlace   = chunk[12];
+                    header.channels    = colour_channels(header.colour_type);
+                    if (header.width == 0 || header.height == 0 || header.width > k_max_size || header.height > k_max_size ||
+                        !valid_depth(header.colour_type, header.depth) || chunk[10] != 0 || chunk[11] != 0 || header.interlace > 1)
+                    {
+                        return false;
+                    }
+                    has_header = true;
+                }
+                else if (type == k_chunk_plte)
+                {
+                    if (length % 3 != 0 || length / 3 > 256)
+                    {
+                        return false;
+                    }
+                    header.palette_size = length / 3;
+                    for (uint32_t i = 0; i < header.palette_size; ++i)
+                    {
+                        header.palette[i * 4 + 0] = chunk[i * 3 + 0];
+                        header.palette[i * 4 + 1] = chunk[i * 3 + 1];
+                        header.palette[i * 4 + 2] = chunk[i * 3 + 2];
+                        header.palette[i * 4 + 3] = 255;
+                    }
+                }
+                else if (type == k_chunk_trns)
+                {
+                    if (header.colour_type == k_palette)
+                    {
+                        if (length > header.palette_size)
+                        {
+                            return false;
+                        }
+                        for (uint32_t i = 0; i < length; ++i)
+                        {
+                            header.palette[i * 4 + 3] = chunk[i];
+                        }
+                        header.palette_alpha = true;
+                    }
+                    else if (header.colour_type == k_gray || header.colour_type == k_rgb)
+                    {
+                        if (length != header.channels * 2)
+                        {
+                            return false;
+                        }
+                        for (uint32_t i = 0; i < header.channels; ++i)
+                        {
+                            header.key[i] = read_be16(chunk + i * 2);
+                        }
+                        header.has_key = true;
+                    }
+                    else
+                    {
+                        return false; // alpha channel and trns at once
+                    }
+                }
+                else if (type == k_chunk_idat)
+                {
+                    if (header.colour_type == k_palette && header.palette_size == 0)
+                    {
+                        return false;
+                    }
+                    if (!gather_idat)
+                    {
+                        return true;
+                    }
+
+                    // a single idat is used in place, several are concatenated
+                    if (idat_count == 1)
+                    {
+                        s_idat.assign(header.idat, header.idat + header.idat_size);
+                    }
+                    if (idat_count >= 1)
+                    {
+                        s_idat.insert(s_idat.end(), chunk, chunk + length);
+                        header.idat      = s_idat.data();
+                        header.idat_size = s_idat.size();
+                    }
+                    else
+                    {
+                        header.idat      = chunk;
+                        header.idat_size = length;
+                    }
+                    ++idat_count;
+                }
+                else if (type == k_chunk_iend)
+                {
+                    break;
+                }
+            }
+            return idat_count > 0;
+        }
+
+        bool is_native(const PngHeader& header)
+        {
+            // adam7 and 16 bit colour keys go through stb_image
+            return header.interlace == 0 && !(header.has_key && header.depth == 16);
+        }
+
+        inline uint8_t paeth(uint8_t a, uint8_t b, uint8_t c)
+        {
+            int p  = a + b - c;
+            int pa = std::abs(p - a);
+            int pb = std::abs(p - b);
+            int pc = std::abs(p - c);
+            if (pa <= pb && pa <= pc)
+            {
+                return a;
+            }
+            return pb <= pc ? b : c;
+        }
+
+        void unfilter_scalar(uint8_t filter, const uint8_t* src, const uint8_t* prev, uint8_t* dst, size_t stride, uint32_t bpp)
+        {
+            switch (filter)
+            {
+                case k_filter_sub:
+                    std::memcpy(dst, src, bpp);
+                    for (size_t i = bpp; i < stride; ++i)
+                    {
+                        dst[i] = static_cast<uint8_t>(src[i] + dst[i - bpp]);
+                    }
+                    break;
+                case k_filter_avg:
+                    for (size_t i = 0; i < bpp; ++i)
+                    {
+                        dst[i] = static_cast<uint8_t>(src[i] + (prev[i] >> 1));
+                    }
+                    for (size_t i = bpp; i < stride; ++i)
+                    {
+                        dst[i] = static_cast<uint8_t>(src[i] + ((dst[i - bpp] + prev[i]) >> 1));
+                    }
+                    break;
+                case k_filter_paeth:
+                    for (size_t i = 0; i < bpp; ++i)
+                    {
+                        dst[i] = static_cast<uint8_t>(src[i] + prev[i]);
+                    }
+                    for (size_t i = bpp; i < stride; ++i)
+                    {
+                        dst[i] = static_cast<uint8_t>(src[i] + paeth(dst[i - bpp], prev[i], prev[i - bpp]));
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+
+#ifdef ARCHVIZ_IMAGE_SSE2
+        // 3 and 4 byte pixels carry a dependency from pixel to pixel, one pixel per iteration in the low lanes
+        template<uint32_t bpp>
+        inline __m128i load_pixel(const uint8_t* p)
+        {
+            int32_t value = 0;
+            std::memcpy(&value, p, bpp);
+            return _mm_cvtsi32_si128(value);
+        }
+
+        template<uint32_t bpp>
+        inline void store_pixel(uint8_t* p, __m128i v)
+        {
+            int32_t value = _mm_cvtsi128_si32(v);
+            std::memcpy(p, &value, bpp);
+        }
+
+        inline __m128i abs_epi16(__m128i v) { return _mm_max_epi16(v, _mm_sub_epi16(_mm_setzero_si128(), v)); }
+
+        inline __m128i select(__m128i mask, __m128i a, __m128i b) { return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)); }
+
+        template<uint32_t bpp>
+        void unfilter_sse2(uint8_t filter, const uint8_t* src, const uint8_t* prev, uint8_t* dst, size_t stride)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            __m128i       a    = zero;
+
+            if (filter == k_filter_sub)
+            {
+                for (size_t i = 0; i < stride; i += bpp)
+                {
+                    a = _mm_add_epi8(load_pixel<bpp>(src + i), a);
+                    store_pixel<bpp>(dst + i, a);
+                }
+            }
+            else if (filter == k_filter_avg)
+            {
+                // pavgb rounds up, the png average rounds down
+                const __m128i one = _mm_set1_epi8(1);
+                for (size_t i = 0; i < stride; i += bpp)
+                {
+                    __m128i b   = load_pixel<bpp>(prev + i);
+                    __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+                    a           = _mm_add_epi8(load_pixel<bpp>(src + i), avg);
+                    store_pixel<bpp>(dst + i, a);
+                }
+            }
+            else if (filter == k_filter_paeth)
+            {
+                // 16 bit lanes, p - a = b - c and p - b = a - c
+                __m128i c = zero;
+                for (size_t i = 0; i < stride; i += bpp)
+                {
+                    __m128i b = _mm_unpacklo_epi8(load_pixel<bpp>(prev + i), zero);
+                    __m128i d = _mm_unpacklo_epi8(load_pixel<bpp>(src + i), zero);
+
+                    __m128i pa = _mm_sub_epi16(b, c);
+                    __m128i pb = _mm_sub_epi16(a, c);
+                    __m128i pc = abs_epi16(_mm_add_epi16(pa, pb));
+                    pa         = abs_epi16(pa);
+                    pb         = abs_epi16(pb);
+
+                    __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+                    __m128i nearest  = select(_mm_cmpeq_epi16(smallest, pb), b, c);
+                    nearest          = select(_mm_cmpeq_epi16(smallest, pa), a, nearest);
+
+                    // both high bytes are zero, the byte add wraps like the scalar filter
+                    a = _mm_add_epi8(d, nearest);
+                    a = _mm_and_si128(a, _mm_set1_epi16(0xFF));
+                    store_pixel<bpp>(dst + i, _mm_packus_epi16(a, a));
+                    c = b;
+                }
+            }
+        }
+#endif
+
+        bool unfilter_row(uint8_t filter, const uint8_t* src, const uint8_t* prev, uint8_t* dst, size_t stride, uint32_t bpp)
+        {
+            switch (filter)
+            {
+                case k_filter_none:
+                    std::memcpy(dst, src, stride);
+                    return true;
+                case k_filter_up: {
+                    size_t i = 0;
+#ifdef ARCHVIZ_IMAGE_SSE2
+                    for (; i + 16 <= stride; i += 16)
+                    {
+                        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                        __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev + i));
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_add_epi8(s, p));
+                    }
+#endif
+                    for (; i < stride; ++i)
+                    {
+                        dst[i] = static_cast<uint8_t>(src[i] + prev[i]);
+                    }
+                    return true;
+                }
+                case k_filter_sub:
+                case k_filter_avg:
+                case k_filter_paeth:
+#ifdef ARCHVIZ_IMAGE_SSE2
+                    if (bpp == 4)
+                    {
+                        unfilter_sse2<4>(filter, src, prev, dst, stride);
+                        return true;
+                    }
+                    if (bpp == 3)
+                    {
+                        unfilter_sse2<3>(filter, src, prev, dst, stride);
+                        return true;
+                    }
+#endif
+                    unfilter_scalar(filter, src, prev, dst, stride, bpp);
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        inline uint32_t packed_sample(const uint8_t* row, uint32_t index, uint32_t depth)
+        {
+            uint32_t bit = index * depth;
+            return (row[bit >> 3] >> (8 - depth - (bit & 7))) & ((1u << depth) - 1);
+        }
+
+        // one unfiltered row to rgba8, 16 bit samples keep the high byte like stb_image
+        void expand_row(const PngHeader& header, const uint8_t* row, uint8_t* out)
+        {
+            const uint32_t width = header.width;
+
+            if (header.colour_type == k_palette)
+            {
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    uint32_t index = header.depth == 8 ? row[x] : packed_sample(row, x, header.depth);
+                    std::memcpy(out + x * 4, header.palette + index * 4, 4);
+                }
+                return;
+            }
+
+            if (header.depth < 8)
+            {
+                const uint32_t scale = 255 / ((1u << header.depth) - 1);
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    uint32_t sample = packed_sample(row, x, header.depth);
+                    uint8_t  value  = static_cast<uint8_t>(sample * scale);
+                    out[x * 4 + 0]  = value;
+                    out[x * 4 + 1]  = value;
+                    out[x * 4 + 2]  = value;
+                    out[x * 4 + 3]  = header.has_key && sample == header.key[0] ? 0 : 255;
+                }
+                return;
+            }
+
+            const uint32_t step = header.depth / 8;
+            const uint32_t bpp  = header.channels * step;
+            switch (header.colour_type)
+            {
+                case k_gray:
+                    for (uint32_t x = 0; x < width; ++x)
+                    {
+                        uint8_t value  = row[x * bpp];
+                        out[x * 4 + 0] = value;
+                        out[x * 4 + 1] = value;
+                        out[x * 4 + 2] = value;
+                        out[x * 4 + 3] = header.has_key && value == (header.key[0] & 0xFF) ? 0 : 255;
+                    }
+                    break;
+                case k_gray_alpha:
+                    for (uint32_t x = 0; x < width; ++x)
+                    {
+                        uint8_t value  = row[x * bpp];
+                        out[x * 4 + 0] = value;
+                        out[x * 4 + 1] = value;
+                        out[x * 4 + 2] = value;
+                        out[x * 4 + 3] = row[x * bpp + step];
+                    }
+                    break;
+                case k_rgb:
+                    for (uint32_t x = 0; x < width; ++x)
+                    {
+                        const uint8_t* pixel = row + x * bpp;
+                        out[x * 4 + 0]       = pixel[0];
+                        out[x * 4 + 1]       = pixel[step];
+                        out[x * 4 + 2]       = pixel[step * 2];
+                        out[x * 4 + 3]       = 255;
+                    }
+                    if (header.has_key)
+                    {
+                        for (uint32_t x = 0; x < width; ++x)
+                        {
+                            const uint8_t* pixel = row + x * bpp;
+                            if (pixel[0] == (header.key[0] & 0xFF) && pixel[1] == (header.key[1] & 0xFF) && pixel[2] == (header.key[2] & 0xFF))
+                            {
+                                out[x * 4 + 3] = 0;
+                            }
+                        }
+                    }
+                    break;
+                default:
+                    for (uint32_t x = 0; x < width * 4; ++x)
+                    {
+                        out[x] = row[x * step];
+                    }
+                    break;
+            }
+        }
+    } // namespace
+
+    bool PngDecoder::isPng(const uint8_t* data, size_t size) { return size >= sizeof(k_signature) && std::memcmp(data, k_signature, sizeof(k_signature)) == 0; }
+
+    bool PngDecoder::probe(const uint8_t* data, size_t size, ImageInfo& info)
+    {
+        PngHeader header;
+        if (!parse(data, size, header, false))
+        {
+            return false;
+        }
+
+        info.format = ImageFileFormat::PNG;
+        info.width  = header.width;
+        info.height = header.height;
+        // the channel count stb_image reports, palettes expand to rgb or rgba
+        info.channels = header.colour_type == k_palette ? (header.palette_alpha ? 4 : 3) : header.channels;
+        info.native   = is_native(header);
+        return true;
+    }
+
+    bool PngDecoder::decode(const uint8_t* data, size_t size, uint8_t* output, size_t output_size)
+    {
+        PngHeader header;
+        if (!parse(data, size, header, true) || !is_native(header))
+        {
+            return false;
+        }
+
+        const size_t width  = header.width;
+        const size_t height = header.height;
+        if (output_size < width * height * 4)
+        {
+            return false;
+        }
+
+        const size_t   stride   = (width * header.channels * header.depth + 7) / 8;
+        const uint32_t bpp      = std::max<uint32_t>(1, header.channels * header.depth / 8);
+        const size_t   raw_size = (stride + 1) * height;
+
+        // the scratch buffers only grow, decoding many textures on one thread reuses them
+        thread_local std::vector<uint8_t> s_filtered;
+        thread_local std::vector<uint8_t> s_rows;
+        if (s_filtered.size() < raw_size)
+        {
+            s_filtered.resize(raw_size);
+        }
+
+        size_t decoded = 0;
+        if (!inflate_zlib(header.idat, header.idat_size, s_filtered.data(), raw_size, &decoded) || decoded != raw_size)
+        {
+            return false;
+        }
+
+        // rgba8 rows are final once unfiltered, the previous output row is the filter's prior row
+        const bool direct = header.colour_type == k_rgba && header.depth == 8;
+
+        s_rows.assign(stride * 3, 0);
+        const uint8_t* prev = s_rows.data();
+        for (size_t y = 0; y < height; ++y)
+        {
+            const uint8_t* line = s_filtered.data() + y * (stride + 1);
+            uint8_t*       dst  = direct ? output + y * stride : s_rows.data() + stride * (1 + (y & 1));
+            if (!unfilter_row(line[0], line + 1, prev, dst, stride, bpp))
+            {
+                return false;
+            }
+            if (!direct)
+            {
+                expand_row(header, dst, output + y * width * 4);
+            }
+            prev = dst;
+        }
+        return true;
+    }
+} // namespace ArchViz
@@ -0,0 +1,16 @@
+#pragma once
+#include "runtime/resource/resource_manager/loader/image/image_decoder.h"
+
+namespace ArchViz
+{
+    // non interlaced png of any colour type and bit depth, 16 bit samples keep their high byte
+    // idat is inflated in one go and every row is unfiltered straight into the output when the file is rgba8
+    class PngDecoder
+    {
+    public:
+        static bool isPng(const uint8_t* data, size_t size);
+
+        static bool probe(const uint8_t* data, size_t size, ImageInfo& info);
+        static bool decode(const uint8_t* data, size_t size, uint8_t* output, size_t output_size);
+    };
+} // namespace ArchViz
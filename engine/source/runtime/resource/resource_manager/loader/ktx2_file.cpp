@@ -0,0 +1,330 @@
+#include "runtime/resource/resource_manager/loader/ktx2_file.h"
+
+#include "runtime/platform/file_system/basic/mapped_file.h"
+
+#include "runtime/core/base/macro.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace ArchViz
+{
+    namespace
+    {
+        constexpr uint8_t k_identifier[12] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+
+        // data format descriptor values
+        constexpr uint32_t k_dfd_model_rgbsda      = 1;
+        constexpr uint32_t k_dfd_model_bc1a        = 128;
+        constexpr uint32_t k_dfd_model_bc3         = 130;
+        constexpr uint32_t k_dfd_model_bc4         = 131;
+        constexpr uint32_t k_dfd_model_bc5         = 132;
+        constexpr uint32_t k_dfd_model_bc7         = 133;
+        constexpr uint32_t k_dfd_primaries_bt709   = 1;
+        constexpr uint32_t k_dfd_transfer_linear   = 1;
+        constexpr uint32_t k_dfd_transfer_srgb     = 2;
+        constexpr uint32_t k_dfd_qualifier_linear  = 0x10;
+        constexpr uint32_t k_dfd_channel_alpha     = 15;
+        constexpr uint32_t k_dfd_basic_header_size = 24;
+        constexpr uint32_t k_dfd_sample_size       = 16;
+
+#pragma pack(push, 1)
+        struct Ktx2Header
+        {
+            uint32_t vk_format;
+            uint32_t type_size;
+            uint32_t pixel_width;
+            uint32_t pixel_height;
+            uint32_t pixel_depth;
+            uint32_t layer_count;
+            uint32_t face_count;
+            uint32_t level_count;
+            uint32_t supercompression_scheme;
+
+            uint32_t dfd_byte_offset;
+            uint32_t dfd_byte_length;
+            uint32_t kvd_byte_offset;
+            uint32_t kvd_byte_length;
+            uint64_t sgd_byte_offset;
+            uint64_t sgd_byte_length;
+        };
+#pragma pack(pop)
+        static_assert(sizeof(Ktx2Header) == 68, "ktx2 header must be packed");
+
+        struct Ktx2Level
+        {
+            uint64_t byte_offset;
+            uint64_t byte_length;
+            uint64_t uncompressed_byte_length;
+        };
+
+        template<typename T>
+        void append(std::vector<uint8_t>& buffer, const T& value)
+        {
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+            buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+        }
+
+        struct Ktx2Format
+        {
+            TextureFormat format;
+            uint32_t      vk_format_unorm;
+            uint32_t      vk_format_srgb; // 0 when the format has no srgb variant
+        };
+
+        // VkFormat values, bc1 is the rgb variant (alpha is never cut out)
+        constexpr Ktx2Format k_formats[] = {
+            {TextureFormat::RGBA8, 37, 43},
+            {TextureFormat::BC1, 131, 132},
+            {TextureFormat::BC3, 137, 138},
+            {TextureFormat::BC4, 139, 0},
+            {TextureFormat::BC5, 141, 0},
+            {TextureFormat::BC7, 145, 146},
+        };
+
+        uint32_t to_vk_format(TextureFormat format, bool srgb)
+        {
+            for (const auto& entry : k_formats)
+            {
+                if (entry.format == format)
+                {
+                    return srgb && entry.vk_format_srgb != 0 ? entry.vk_format_srgb : entry.vk_format_unorm;
+                }
+            }
+            return 0;
+        }
+
+        bool from_vk_format(uint32_t vk_format, TextureFormat& format, bool& srgb)
+        {
+            for (const auto& entry : k_formats)
+            {
+                if (entry.vk_format_unorm == vk_format || (entry.vk_format_srgb != 0 && entry.vk_format_srgb == vk_format))
+                {
+                    format = entry.format;
+                    srgb   = entry.vk_format_srgb == vk_format;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        struct DfdSample
+        {
+            uint32_t bit_offset;
+            uint32_t bit_length;
+            uint32_t channel;
+        };
+
+        std::vector<uint32_t> build_dfd(TextureFormat format, bool srgb)
+        {
+            std::vector<DfdSample> samples;
+            uint32_t               model = k_dfd_model_rgbsda;
+            switch (format)
+            {
+                case TextureFormat::BC1:
+                    model   = k_dfd_model_bc1a;
+                    samples = {{0, 64, 0}};
+                    break;
+                case TextureFormat::BC3:
+                    model   = k_dfd_model_bc3;
+                    samples = {{0, 64, k_dfd_channel_alpha}, {64, 64, 0}};
+                    break;
+                case TextureFormat::BC4:
+                    model   = k_dfd_model_bc4;
+                    samples = {{0, 64, 0}};
+                    break;
+                case TextureFormat::BC5:
+                    model   = k_dfd_model_bc5;
+                    samples = {{0, 64, 0}, {64, 64, 1}};
+                    break;
+                case TextureFormat::BC7:
+                    model   = k_dfd_model_bc7;
+                    samples = {{0, 128, 0}};
+                    break;
+                default:
+                    samples = {{0, 8, 0}, {8, 8, 1}, {16, 8, 2}, {24, 8, k_dfd_channel_alpha}};
+                    break;
+            }
+
+            const bool     compressed = texture_format_compressed(format);
+            const uint32_t block_size = k_dfd_basic_header_size + static_cast<uint32_t>(samples.size()) * k_dfd_sample_size;
+
+            std::vector<uint32_t> words;
+            words.push_back(4 + block_size);         // total size
+            words.push_back(0);                      // vendor khronos, basic descriptor
+            words.push_back(2 | (block_size << 16)); // version 2
+            words.push_back(model | (k_dfd_primaries_bt709 << 8) | ((srgb ? k_dfd_transfer_srgb : k_dfd_transfer_linear) << 16));
+            words.push_back(compressed ? (3 | (3 << 8)) : 0); // texel block dimensions - 1, 4x4 for bc
+            words.push_back(texture_format_block_bytes(format)); // bytes in plane 0
+            words.push_back(0);
+
+            for (const auto& sample : samples)
+            {
+                uint32_t channel = sample.channel;
+                if (srgb && channel == k_dfd_channel_alpha)
+                {
+                    channel |= k_dfd_qualifier_linear;
+                }
+                words.push_back(sample.bit_offset | ((sample.bit_length - 1) << 16) | (channel << 24)); // bit offset, bit length - 1, channel
+                words.push_back(0);                                                                   // sample position
+                words.push_back(0);                                                                   // lower
+                words.push_back(compressed ? 0xFFFFFFFFu : 255);                                      // upper
+            }
+            return words;
+        }
+    } // namespace
+
+    bool Ktx2File::save(const std::filesystem::path& path, const TextureData& texture)
+    {
+        const uint32_t level_count = texture.mipLevels();
+        const uint32_t vk_format   = to_vk_format(texture.m_format, texture.m_srgb);
+
+        std::vector<TextureLevel> levels = texture.m_levels;
+        if (levels.empty())
+        {
+            TextureLevel level;
+            level.width  = static_cast<uint32_t>(texture.m_width);
+            level.height = static_cast<uint32_t>(texture.m_height);
+            level.size   = texture.m_data.size();
+            levels.push_back(level);
+        }
+
+        std::vector<uint32_t> dfd = build_dfd(texture.m_format, texture.m_srgb);
+
+        Ktx2Header header {};
+        header.vk_format       = vk_format;
+        header.type_size       = 1;
+        header.pixel_width     = static_cast<uint32_t>(texture.m_width);
+        header.pixel_height    = static_cast<uint32_t>(texture.m_height);
+        header.face_count      = 1;
+        header.level_count     = level_count;
+        header.dfd_byte_offset = static_cast<uint32_t>(sizeof(k_identifier) + sizeof(Ktx2Header) + level_count * sizeof(Ktx2Level));
+        header.dfd_byte_length = static_cast<uint32_t>(dfd.size() * sizeof(uint32_t));
+
+        // level data follows the dfd, smallest level first, aligned to lcm(texel block size, 4)
+        const uint64_t         alignment = std::max<uint64_t>(texture_format_block_bytes(texture.m_format), 4);
+        std::vector<Ktx2Level> level_index(level_count);
+
+        uint64_t offset = header.dfd_byte_offset + header.dfd_byte_length;
+        for (uint32_t i = level_count; i-- > 0;)
+        {
+            offset                                  = (offset + alignment - 1) / alignment * alignment;
+            level_index[i].byte_offset              = offset;
+            level_index[i].byte_length              = levels[i].size;
+            level_index[i].uncompressed_byte_length = levels[i].size;
+            offset += levels[i].size;
+        }
+
+        std::vector<uint8_t> buffer;
+        buffer.reserve(offset);
+        buffer.insert(buffer.end(), std::begin(k_identifier), std::end(k_identifier));
+        append(buffer, header);
+        for (const auto& level : level_index)
+        {
+            append(buffer, level);
+        }
+        for (uint32_t word : dfd)
+        {
+            append(buffer, word);
+        }
+        for (uint32_t i = level_count; i-- > 0;)
+        {
+            buffer.resize(level_index[i].byte_offset, 0);
+            buffer.insert(buffer.end(), texture.m_data.begin() + levels[i].offset, texture.m_data.begin() + levels[i].offset + levels[i].size);
+        }
+
+        std::error_code error;
+        std::filesystem::create_directories(path.parent_path(), error);
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            LOG_WARN("failed to write ktx2 file: {}", path.generic_string());
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+        return file.good();
+    }
+
+    std::shared_ptr<TextureData> Ktx2File::load(const std::filesystem::path& path, const std::string& uri)
+    {
+        MappedFile file;
+        if (!file.open(path.generic_string()))
+        {
+            return nullptr;
+        }
+        return load(reinterpret_cast<const uint8_t*>(file.data()), file.size(), uri);
+    }
+
+    std::shared_ptr<TextureData> Ktx2File::load(const uint8_t* data, size_t size, const std::string& uri)
+    {
+        if (data == nullptr || size < sizeof(k_identifier) + sizeof(Ktx2Header) || std::memcmp(data, k_identifier, sizeof(k_identifier)) != 0)
+        {
+            LOG_ERROR("not a ktx2 file: {}", uri);
+            return nullptr;
+        }
+
+        Ktx2Header header;
+        std::memcpy(&header, data + sizeof(k_identifier), sizeof(header));
+
+        TextureFormat format;
+        bool          srgb;
+        if (!from_vk_format(header.vk_format, format, srgb))
+        {
+            LOG_ERROR("unsupported ktx2 format {}: {}", header.vk_format, uri);
+            return nullptr;
+        }
+        if (header.pixel_depth > 1 || header.layer_count > 1 || header.face_count != 1 || header.supercompression_scheme != 0)
+        {
+            LOG_ERROR("only single 2d ktx2 images without supercompression are supported: {}", uri);
+            return nullptr;
+        }
+
+        const uint32_t level_count = std::max(header.level_count, 1u);
+        const size_t   index_begin = sizeof(k_identifier) + sizeof(Ktx2Header);
+        if (index_begin + level_count * sizeof(Ktx2Level) > size)
+        {
+            LOG_ERROR("truncated ktx2 file: {}", uri);
+            return nullptr;
+        }
+
+        std::shared_ptr<TextureData> texture = std::make_shared<TextureData>();
+        texture->m_width   = static_cast<int32_t>(header.pixel_width);
+        texture->m_height  = static_cast<int32_t>(header.pixel_height);
+        texture->m_channel = 4;
+        texture->m_format  = format;
+        texture->m_srgb    = srgb;
+        texture->m_uri     = uri;
+
+        size_t total_size = 0;
+        for (uint32_t i = 0; i < level_count; ++i)
+        {
+            Ktx2Level level;
+            std::memcpy(&level, data + index_begin + i * sizeof(Ktx2Level), sizeof(level));
+
+            TextureLevel info;
+            info.offset = total_size;
+            info.size   = static_cast<size_t>(level.byte_length);
+            info.width  = std::max(header.pixel_width >> i, 1u);
+            info.height = std::max(header.pixel_height >> i, 1u);
+
+            if (level.byte_offset + level.byte_length > size || info.size != texture_level_size(format, info.width, info.height))
+            {
+                LOG_ERROR("invalid ktx2 level {}: {}", i, uri);
+                return nullptr;
+            }
+
+            texture->m_data.insert(texture->m_data.end(), data + level.byte_offset, data + level.byte_offset + level.byte_length);
+            texture->m_levels.push_back(info);
+            total_size += info.size;
+        }
+
+        if (level_count == 1)
+        {
+            texture->m_levels.clear();
+        }
+        return texture;
+    }
+} // namespace ArchViz
@@ -0,0 +1,21 @@
+#pragma once
+#include "runtime/resource/res_type/data/material_data.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+namespace ArchViz
+{
+    // minimal khronos ktx2 container for cooked textures: single layer 2d, no supercompression, rgba8 or bc1 / 3 / 4 / 5 / 7
+    // https://registry.khronos.org/KTX/specs/2.0/ktxspec.v2.html
+    class Ktx2File
+    {
+    public:
+        static bool save(const std::filesystem::path& path, const TextureData& texture);
+
+        static std::shared_ptr<TextureData> load(const std::filesystem::path& path, const std::string& uri);
+        static std::shared_ptr<TextureData> load(const uint8_t* data, size_t size, const std::string& uri);
+    };
+} // namespace ArchViz
@@ -8,29 +8,41 @@
 
 namespace ArchViz
 {
+    namespace
+    {
+        // the role decides color space and block format of the cooked texture
+        ResourceHandle load_texture(const std::string& uri, const char* role)
+        {
+            TextureRes res;
+            res.m_texture_uri = uri;
+            res.m_role        = role;
+            return g_runtime_global_context.m_resource_manager->loadResource<TextureData, TextureRes>(uri, res);
+        }
+    } // namespace
+
     std::pair<std::shared_ptr<MaterialData>, size_t> MaterialLoader::createResource(const MaterialRes& create_info)
     {
         std::shared_ptr<MaterialData> material = std::make_shared<MaterialData>();
 
         if (!create_info.m_base_colour_texture_file.empty())
         {
-            material->m_base_colour = g_runtime_global_context.m_resource_manager->loadResource<TextureData, TextureRes>(create_info.m_base_colour_texture_file);
+            material->m_base_colour = load_texture(create_info.m_base_colour_texture_file, "albedo");
         }
         if (!create_info.m_metallic_roughness_texture_file.empty())
         {
-            material->m_metallic_roughness = g_runtime_global_context.m_resource_manager->loadResource<TextureData, TextureRes>(create_info.m_metallic_roughness_texture_file);
+            material->m_metallic_roughness = load_texture(create_info.m_metallic_roughness_texture_file, "data");
         }
         if (!create_info.m_normal_texture_file.empty())
         {
-            material->m_normal = g_runtime_global_context.m_resource_manager->loadResource<TextureData, TextureRes>(create_info.m_normal_texture_file);
+            material->m_normal = load_texture(create_info.m_normal_texture_file, "normal");
         }
         if (!create_info.m_occlusion_texture_file.empty())
         {
-            material->m_occlusion = g_runtime_global_context.m_resource_manager->loadResource<TextureData, TextureRes>(create_info.m_occlusion_texture_file);
+            material->m_occlusion = load_texture(create_info.m_occlusion_texture_file, "mask");
         }
         if (!create_info.m_emissive_texture_file.empty())
         {
-            material->m_emissive = g_runtime_global_context.m_resource_manager->loadResource<TextureData, TextureRes>(create_info.m_emissive_texture_file);
+            material->m_emissive = load_texture(create_info.m_emissive_texture_file, "albedo");
         }
 
         return {material, sizeof(MaterialData)};
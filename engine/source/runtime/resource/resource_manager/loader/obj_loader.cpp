@@ -10,92 +10,58 @@
 #include "runtime/resource/res_type/data/mesh_data.h"
 
 #include "runtime/core/base/macro.h"
+#include "runtime/core/thread/work_executor.h"
 
 #include <filesystem>
 
 namespace ArchViz
 {
+    ObjLoader::ObjLoader(std::shared_ptr<WorkExecutor> executor) : m_executor {std::move(executor)} {}
+
     std::pair<std::shared_ptr<MeshData>, size_t> ObjLoader::createResource(const std::string& uri)
     {
         std::filesystem::path model_uri = g_runtime_global_context.m_config_manager->getRootFolder() / uri;
 
-        tinyobj::attrib_t                attrib;
-        std::vector<tinyobj::shape_t>    shapes;
-        std::vector<tinyobj::material_t> materials;
-        std::string                      warn, err;
-
-        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, model_uri.generic_string().c_str(), model_uri.parent_path().generic_string().c_str()))
-        {
-            LOG_WARN(warn);
-            LOG_FATAL(err);
-        }
-
-        if (!warn.empty())
+        ObjParseResult result;
+        if (!ObjParser::parseFile(model_uri.generic_string(), result, m_executor))
         {
-            LOG_WARN(warn);
+            LOG_ERROR("failed to load obj file: {}", model_uri.generic_string());
+            return {nullptr, 0};
         }
 
-        std::shared_ptr<MeshData> mesh = convertMeshData(attrib, shapes, materials);
+        std::shared_ptr<MeshData> mesh = convertMeshData(result);
 
         size_t vertex_size = mesh->vertex_buffer.size() * sizeof(mesh->vertex_buffer[0]);
         size_t index_size  = mesh->index_buffer.size() * sizeof(mesh->index_buffer[0]);
         return {mesh, vertex_size + index_size};
     }
 
-    std::pair<std::shared_ptr<MeshData>, size_t> ObjLoader::createResource(const SubMeshRes& create_info)
-    {
-        std::filesystem::path model_uri = g_runtime_global_context.m_config_manager->getRootFolder() / create_info.m_obj_file_ref;
-
-        tinyobj::attrib_t                attrib;
-        std::vector<tinyobj::shape_t>    shapes;
-        std::vector<tinyobj::material_t> materials;
-        std::string                      warn, err;
+    std::pair<std::shared_ptr<MeshData>, size_t> ObjLoader::createResource(const SubMeshRes& create_info) { return createResource(create_info.m_obj_file_ref); }
 
-        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, model_uri.generic_string().c_str(), model_uri.parent_path().generic_string().c_str()))
-        {
-            LOG_WARN(warn);
-            LOG_FATAL(err);
-        }
+    std::shared_ptr<MeshData> ObjLoader::convertMeshData(const ObjParseResult& result)
+    {
+        std::shared_ptr<MeshData> mesh = std::make_shared<MeshData>();
 
-        if (!warn.empty())
+        mesh->vertex_buffer.resize(result.vertices.size());
+        for (size_t i = 0; i < result.vertices.size(); ++i)
         {
-            LOG_WARN(warn);
+            const ObjIndex& index  = result.vertices[i];
+            MeshVertex&     vertex = mesh->vertex_buffer[i];
+
+            vertex.postion = Vector3(&result.positions[3 * index.position]);
+            if (index.normal != ObjIndex::k_invalid_index)
+            {
+                vertex.normal = Vector3(&result.normals[3 * index.normal]);
+            }
+            if (index.texcoord != ObjIndex::k_invalid_index)
+            {
+                // invert tex y axis
+                vertex.uv = Vector2(result.texcoords[2 * index.texcoord + 0], 1.0f - result.texcoords[2 * index.texcoord + 1]);
+            }
         }
 
-        std::shared_ptr<MeshData> mesh = convertMeshData(attrib, shapes, materials);
-
-        size_t vertex_size = mesh->vertex_buffer.size() * sizeof(mesh->vertex_buffer[0]);
-        size_t index_size  = mesh->index_buffer.size() * sizeof(mesh->index_buffer[0]);
-        return {mesh, vertex_size + index_size};
-    }
+        mesh->index_buffer.assign(result.indices.begin(), result.indices.end());
 
-    std::shared_ptr<MeshData> ObjLoader::convertMeshData(const tinyobj::attrib_t& attrib, const std::vector<tinyobj::shape_t>& shapes, const std::vector<tinyobj::material_t>& materials)
-    {
-        // std::unordered_map<Vertex, uint32_t> unique_vertices {};
-
-        // for (const auto& shape : shapes)
-        //{
-        //     for (const auto& index : shape.mesh.indices)
-        //     {
-        //         Vertex vertex {};
-
-        //        vertex.pos = {attrib.vertices[3 * index.vertex_index + 0], attrib.vertices[3 * index.vertex_index + 1], attrib.vertices[3 * index.vertex_index + 2]};
-        //        // vertex.color = {attrib.colors[3 * index.vertex_index + 0], attrib.colors[3 * index.vertex_index + 1], attrib.colors[3 * index.vertex_index + 2]};
-        //        vertex.color = {1.0f, 1.0f, 1.0f};
-        //        vertex.normal = {attrib.normals[3 * index.normal_index + 0], attrib.normals[3 * index.normal_index + 1], attrib.normals[3 * index.normal_index + 2]};
-        //        vertex.tex_coord = {attrib.texcoords[2 * index.texcoord_index + 0], 1.0f - attrib.texcoords[2 * index.texcoord_index + 1]}; // invert tex y axis
-        //        // vertex.tex_coord = {attrib.texcoords[2 * index.texcoord_index + 0], attrib.texcoords[2 * index.texcoord_index + 1]};
-
-        //        if (unique_vertices.count(vertex) == 0)
-        //        {
-        //            unique_vertices[vertex] = static_cast<uint32_t>(m_vertices.size());
-        //            m_vertices.push_back(vertex);
-        //        }
-
-        //        m_indices.push_back(unique_vertices[vertex]);
-        //    }
-        //}
-
-        return {};
+        return mesh;
     }
 } // namespace ArchViz
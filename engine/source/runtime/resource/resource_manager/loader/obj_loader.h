@@ -1,26 +1,31 @@
 #pragma once
 #include "runtime/resource/resource_manager/loader/loader.h"
+#include "runtime/resource/resource_manager/loader/obj_parser.h"
 
 #include "runtime/resource/res_type/components/mesh_res.h"
 #include "runtime/resource/res_type/data/mesh_data.h"
 
-#include <tiny_obj_loader.h>
-
 #include <memory>
 #include <string>
 #include <vector>
 
 namespace ArchViz
 {
+    class WorkExecutor;
+
     class ObjLoader : public Loader<MeshData, SubMeshRes>
     {
     public:
+        explicit ObjLoader(std::shared_ptr<WorkExecutor> executor = nullptr);
         virtual ~ObjLoader() = default;
 
         std::pair<std::shared_ptr<MeshData>, size_t> createResource(const SubMeshRes& create_info) override;
         std::pair<std::shared_ptr<MeshData>, size_t> createResource(const std::string& uri) override;
 
     private:
-        std::shared_ptr<MeshData> convertMeshData(const tinyobj::attrib_t& attrib, const std::vector<tinyobj::shape_t>& shapes, const std::vector<tinyobj::material_t>& materials);
+        std::shared_ptr<MeshData> convertMeshData(const ObjParseResult& result);
+
+    private:
+        std::shared_ptr<WorkExecutor> m_executor;
     };
 } // namespace ArchViz
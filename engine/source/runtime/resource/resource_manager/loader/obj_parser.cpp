@@ -0,0 +1,540 @@
+#include "runtime/resource/resource_manager/loader/obj_parser.h"
+
+#include "runtime/platform/file_system/basic/mapped_file.h"
+
+#include "runtime/core/base/macro.h"
+#include "runtime/core/thread/work_executor.h"
+
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <thread>
+
+namespace ArchViz
+{
+    namespace
+    {
+        enum class ObjLineType : uint8_t
+        {
+            Unknown,
+            Position,
+            Texcoord,
+            Normal,
+            Face,
+        };
+
+        struct ObjChunk
+        {
+            const char* begin {nullptr};
+            const char* end {nullptr};
+
+            // attribute counts of this chunk
+            size_t position_count {0};
+            size_t texcoord_count {0};
+            size_t normal_count {0};
+
+            // global attribute base of this chunk
+            size_t position_base {0};
+            size_t texcoord_base {0};
+            size_t normal_base {0};
+
+            // fan triangulated face corners
+            std::vector<ObjIndex> corners;
+
+            bool valid {true};
+        };
+
+        const double k_pow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+        inline bool is_blank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+        inline bool is_digit(char c) { return static_cast<unsigned>(c - '0') < 10u; }
+
+        inline const char* skip_blank(const char* ptr, const char* end)
+        {
+            while (ptr < end && is_blank(*ptr))
+                ++ptr;
+            return ptr;
+        }
+
+        inline const char* find_line_end(const char* ptr, const char* end)
+        {
+            const char* line_end = static_cast<const char*>(std::memchr(ptr, '\n', end - ptr));
+            return line_end ? line_end : end;
+        }
+
+        inline ObjLineType classify_line(const char*& ptr, const char* end)
+        {
+            ptr = skip_blank(ptr, end);
+            if (end - ptr < 2)
+            {
+                return ObjLineType::Unknown;
+            }
+
+            if (ptr[0] == 'v')
+            {
+                if (is_blank(ptr[1]))
+                {
+                    ptr += 2;
+                    return ObjLineType::Position;
+                }
+                if (end - ptr > 2 && is_blank(ptr[2]))
+                {
+                    if (ptr[1] == 't')
+                    {
+                        ptr += 3;
+                        return ObjLineType::Texcoord;
+                    }
+                    if (ptr[1] == 'n')
+                    {
+                        ptr += 3;
+                        return ObjLineType::Normal;
+                    }
+                }
+            }
+            else if (ptr[0] == 'f' && is_blank(ptr[1]))
+            {
+                ptr += 2;
+                return ObjLineType::Face;
+            }
+
+            return ObjLineType::Unknown;
+        }
+
+        inline const char* parse_int(const char* ptr, const char* end, int64_t& value)
+        {
+            bool negative = false;
+            if (ptr < end && (*ptr == '-' || *ptr == '+'))
+            {
+                negative = *ptr == '-';
+                ++ptr;
+            }
+
+            int64_t result = 0;
+            while (ptr < end && is_digit(*ptr))
+            {
+                result = result * 10 + (*ptr - '0');
+                ++ptr;
+            }
+
+            value = negative ? -result : result;
+            return ptr;
+        }
+
+        // obj indices are 1 based, negative ones are relative to the current end of the attribute list
+        inline uint32_t resolve_index(int64_t index, size_t current_count)
+        {
+            if (index > 0)
+            {
+                return static_cast<uint32_t>(index - 1);
+            }
+            if (index < 0 && static_cast<size_t>(-index) <= current_count)
+            {
+                return static_cast<uint32_t>(static_cast<int64_t>(current_count) + index);
+            }
+            return ObjIndex::k_invalid_index;
+        }
+
+        void count_chunk(ObjChunk& chunk)
+        {
+            const char* ptr = chunk.begin;
+            while (ptr < chunk.end)
+            {
+                const char* line_end = find_line_end(ptr, chunk.end);
+                switch (classify_line(ptr, line_end))
+                {
+                    case ObjLineType::Position:
+                        ++chunk.position_count;
+                        break;
+                    case ObjLineType::Texcoord:
+                        ++chunk.texcoord_count;
+                        break;
+                    case ObjLineType::Normal:
+                        ++chunk.normal_count;
+                        break;
+                    default:
+                        break;
+                }
+                ptr = line_end + 1;
+            }
+        }
+
+        void parse_chunk(ObjChunk& chunk, ObjParseResult& result)
+        {
+            float* positions = result.positions.data() + chunk.position_base * 3;
+            float* texcoords = result.texcoords.data() + chunk.texcoord_base * 2;
+            float* normals   = result.normals.data() + chunk.normal_base * 3;
+
+            size_t position_count = chunk.position_base;
+            size_t texcoord_count = chunk.texcoord_base;
+            size_t normal_count   = chunk.normal_base;
+
+            // a rough guess, a triangle line is usually longer than 32 bytes
+            chunk.corners.reserve((chunk.end - chunk.begin) / 32);
+
+            std::vector<ObjIndex> polygon;
+            polygon.reserve(8);
+
+            const char* ptr = chunk.begin;
+            while (ptr < chunk.end)
+            {
+                const char* line_end = find_line_end(ptr, chunk.end);
+                switch (classify_line(ptr, line_end))
+                {
+                    case ObjLineType::Position:
+                        ptr = parse_float(ptr, line_end, positions[0]);
+                        ptr = parse_float(ptr, line_end, positions[1]);
+                        ptr = parse_float(ptr, line_end, positions[2]);
+                        positions += 3;
+                        ++position_count;
+                        break;
+                    case ObjLineType::Texcoord:
+                        ptr = parse_float(ptr, line_end, texcoords[0]);
+                        ptr = parse_float(ptr, line_end, texcoords[1]);
+                        texcoords += 2;
+                        ++texcoord_count;
+                        break;
+                    case ObjLineType::Normal:
+                        ptr = parse_float(ptr, line_end, normals[0]);
+                        ptr = parse_float(ptr, line_end, normals[1]);
+                        ptr = parse_float(ptr, line_end, normals[2]);
+                        normals += 3;
+                        ++normal_count;
+                        break;
+                    case ObjLineType::Face: {
+                        polygon.clear();
+                        while (true)
+                        {
+                            ptr = skip_blank(ptr, line_end);
+                            if (ptr >= line_end || !(is_digit(*ptr) || *ptr == '-' || *ptr == '+'))
+                            {
+                                break;
+                            }
+
+                            ObjIndex index {};
+                            int64_t  value = 0;
+
+                            ptr            = parse_int(ptr, line_end, value);
+                            index.position = resolve_index(value, position_count);
+                            if (index.position == ObjIndex::k_invalid_index)
+                            {
+                                chunk.valid = false;
+                            }
+
+                            if (ptr < line_end && *ptr == '/')
+                            {
+                                ++ptr;
+                                if (ptr < line_end && *ptr != '/')
+                                {
+                                    ptr            = parse_int(ptr, line_end, value);
+                                    index.texcoord = resolve_index(value, texcoord_count);
+                                }
+                                if (ptr < line_end && *ptr == '/')
+                                {
+                                    ++ptr;
+                                    ptr          = parse_int(ptr, line_end, value);
+                                    index.normal = resolve_index(value, normal_count);
+                                }
+                            }
+
+                            polygon.push_back(index);
+                        }
+
+                        // fan triangulation
+                        for (size_t i = 2; i < polygon.size(); ++i)
+                        {
+                            chunk.corners.push_back(polygon[0]);
+                            chunk.corners.push_back(polygon[i - 1]);
+                            chunk.corners.push_back(polygon[i]);
+                        }
+                        break;
+                    }
+                    default:
+                        break;
+                }
+                ptr = line_end + 1;
+            }
+        }
+
+        inline uint32_t hash_index(const ObjIndex& index)
+        {
+            uint64_t h = (static_cast<uint64_t>(index.position) * 0x9E3779B97F4A7C15ull) ^ (static_cast<uint64_t>(index.texcoord) * 0xC2B2AE3D27D4EB4Full) ^ (static_cast<uint64_t>(index.normal) * 0x165667B19E3779F9ull);
+            h ^= h >> 32;
+            return static_cast<uint32_t>(h);
+        }
+
+        // open addressing table with linear probing, slots only store the vertex id,
+        // the key is compared against the vertex it points to
+        class ObjVertexTable
+        {
+        public:
+            ObjVertexTable(std::vector<ObjIndex>& vertices, size_t expected) : m_vertices {vertices}
+            {
+                size_t capacity = 64;
+                while (capacity < expected * 2)
+                    capacity <<= 1;
+                m_slots.assign(capacity, k_empty);
+                m_mask = capacity - 1;
+            }
+
+            uint32_t findOrInsert(const ObjIndex& index)
+            {
+                size_t slot = hash_index(index) & m_mask;
+                while (true)
+                {
+                    uint32_t vertex = m_slots[slot];
+                    if (vertex == k_empty)
+                    {
+                        vertex        = static_cast<uint32_t>(m_vertices.size());
+                        m_slots[slot] = vertex;
+                        m_vertices.push_back(index);
+                        if (m_vertices.size() * 2 > m_slots.size())
+                        {
+                            grow();
+                        }
+                        return vertex;
+                    }
+                    if (m_vertices[vertex] == index)
+                    {
+                        return vertex;
+                    }
+                    slot = (slot + 1) & m_mask;
+                }
+            }
+
+        private:
+            void grow()
+            {
+                m_slots.assign(m_slots.size() * 2, k_empty);
+                m_mask = m_slots.size() - 1;
+                for (uint32_t vertex = 0; vertex < m_vertices.size(); ++vertex)
+                {
+                    size_t slot = hash_index(m_vertices[vertex]) & m_mask;
+                    while (m_slots[slot] != k_empty)
+                        slot = (slot + 1) & m_mask;
+                    m_slots[slot] = vertex;
+                }
+            }
+
+        private:
+            static constexpr uint32_t k_empty = std::numeric_limits<uint32_t>::max();
+
+            std::vector<ObjIndex>& m_vertices;
+            std::vector<uint32_t>  m_slots;
+            size_t                 m_mask {0};
+        };
+
+        template<typename F>
+        void run_chunks(std::vector<ObjChunk>& chunks, std::shared_ptr<WorkExecutor> executor, F&& func)
+        {
+            if (executor == nullptr || chunks.size() == 1)
+            {
+                for (auto& chunk : chunks)
+                    func(chunk);
+                return;
+            }
+
+            std::vector<std::future<void>> futures;
+            futures.reserve(chunks.size());
+            for (auto& chunk : chunks)
+            {
+                futures.push_back(executor->enqueue_task([&func, &chunk]() { func(chunk); }));
+            }
+            for (auto& future : futures)
+            {
+                future.wait();
+            }
+        }
+    } // namespace
+
+    const char* parse_float(const char* ptr, const char* end, float& value)
+    {
+        ptr = skip_blank(ptr, end);
+
+        bool negative = false;
+        if (ptr < end && (*ptr == '-' || *ptr == '+'))
+        {
+            negative = *ptr == '-';
+            ++ptr;
+        }
+
+        // keep 19 significant digits in the mantissa, the rest only moves the exponent
+        uint64_t mantissa = 0;
+        int      exponent = 0;
+        int      digits   = 0;
+
+        while (ptr < end && is_digit(*ptr))
+        {
+            if (digits < 19)
+            {
+                mantissa = mantissa * 10 + (*ptr - '0');
+                digits += mantissa != 0;
+            }
+            else
+            {
+                ++exponent;
+            }
+            ++ptr;
+        }
+
+        if (ptr < end && *ptr == '.')
+        {
+            ++ptr;
+            while (ptr < end && is_digit(*ptr))
+            {
+                if (digits < 19)
+                {
+                    mantissa = mantissa * 10 + (*ptr - '0');
+                    digits += mantissa != 0;
+                    --exponent;
+                }
+                ++ptr;
+            }
+        }
+
+        if (ptr < end && (*ptr == 'e' || *ptr == 'E'))
+        {
+            int64_t exp_value = 0;
+            ptr               = parse_int(ptr + 1, end, exp_value);
+            exponent += static_cast<int>(std::clamp<int64_t>(exp_value, -1000, 1000));
+        }
+
+        double result = static_cast<double>(mantissa);
+        if (mantissa != 0)
+        {
+            while (exponent > 22)
+            {
+                result *= k_pow10[22];
+                exponent -= 22;
+            }
+            while (exponent < -22)
+            {
+                result /= k_pow10[22];
+                exponent += 22;
+            }
+            result = exponent >= 0 ? result * k_pow10[exponent] : result / k_pow10[-exponent];
+        }
+
+        value = static_cast<float>(negative ? -result : result);
+        return ptr;
+    }
+
+    bool ObjParser::parse(const char* data, size_t size, ObjParseResult& result, std::shared_ptr<WorkExecutor> executor)
+    {
+        result = {};
+        if (data == nullptr || size == 0)
+        {
+            return true;
+        }
+
+        // split into line aligned chunks
+        size_t chunk_count = 1;
+        if (executor)
+        {
+            size_t max_chunk_count = std::max<size_t>(std::thread::hardware_concurrency(), 1) * 4;
+            chunk_count            = std::clamp<size_t>(size / k_min_chunk_size, 1, max_chunk_count);
+        }
+
+        std::vector<ObjChunk> chunks(chunk_count);
+
+        const char* end   = data + size;
+        const char* begin = data;
+        for (size_t i = 0; i < chunk_count; ++i)
+        {
+            const char* chunk_end = i + 1 == chunk_count ? end : data + size / chunk_count * (i + 1);
+            if (chunk_end < begin)
+            {
+                chunk_end = begin;
+            }
+            if (chunk_end < end)
+            {
+                chunk_end = find_line_end(chunk_end, end);
+                chunk_end = chunk_end < end ? chunk_end + 1 : end;
+            }
+
+            chunks[i].begin = begin;
+            chunks[i].end   = chunk_end;
+            begin           = chunk_end;
+        }
+
+        // 1. count attributes
+        run_chunks(chunks, executor, [](ObjChunk& chunk) { count_chunk(chunk); });
+
+        size_t position_count = 0;
+        size_t texcoord_count = 0;
+        size_t normal_count   = 0;
+        for (auto& chunk : chunks)
+        {
+            chunk.position_base = position_count;
+            chunk.texcoord_base = texcoord_count;
+            chunk.normal_base   = normal_count;
+
+            position_count += chunk.position_count;
+            texcoord_count += chunk.texcoord_count;
+            normal_count += chunk.normal_count;
+        }
+
+        if (position_count >= ObjIndex::k_invalid_index || texcoord_count >= ObjIndex::k_invalid_index || normal_count >= ObjIndex::k_invalid_index)
+        {
+            LOG_ERROR("obj attribute count out of range");
+            return false;
+        }
+
+        result.positions.resize(position_count * 3);
+        result.texcoords.resize(texcoord_count * 2);
+        result.normals.resize(normal_count * 3);
+
+        // 2. parse attributes in place and faces into chunk lists
+        run_chunks(chunks, executor, [&result](ObjChunk& chunk) { parse_chunk(chunk, result); });
+
+        // 3. merge faces and deduplicate vertices
+        size_t corner_count = 0;
+        for (auto& chunk : chunks)
+        {
+            if (!chunk.valid)
+            {
+                LOG_ERROR("obj face references an undefined vertex");
+                return false;
+            }
+            corner_count += chunk.corners.size();
+        }
+
+        if (corner_count >= ObjIndex::k_invalid_index)
+        {
+            LOG_ERROR("obj face count out of range");
+            return false;
+        }
+
+        result.indices.reserve(corner_count);
+
+        ObjVertexTable table(result.vertices, corner_count / 4);
+        for (auto& chunk : chunks)
+        {
+            for (const auto& corner : chunk.corners)
+            {
+                // indices pointing past the end of the file
+                if (corner.position >= position_count || (corner.texcoord != ObjIndex::k_invalid_index && corner.texcoord >= texcoord_count) ||
+                    (corner.normal != ObjIndex::k_invalid_index && corner.normal >= normal_count))
+                {
+                    LOG_ERROR("obj face references an undefined vertex");
+                    return false;
+                }
+                result.indices.push_back(table.findOrInsert(corner));
+            }
+            std::vector<ObjIndex>().swap(chunk.corners);
+        }
+
+        result.vertices.shrink_to_fit();
+        return true;
+    }
+
+    bool ObjParser::parseFile(const std::string& path, ObjParseResult& result, std::shared_ptr<WorkExecutor> executor)
+    {
+        MappedFile file;
+        if (!file.open(path))
+        {
+            return false;
+        }
+        return parse(file.data(), file.size(), result, executor);
+    }
+} // namespace ArchViz
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ArchViz
+{
+    class WorkExecutor;
+
+    // zero based attribute indices of one unique obj vertex
+    struct ObjIndex
+    {
+        static constexpr uint32_t k_invalid_index = std::numeric_limits<uint32_t>::max();
+
+        uint32_t position {k_invalid_index};
+        uint32_t texcoord {k_invalid_index};
+        uint32_t normal {k_invalid_index};
+
+        bool operator==(const ObjIndex& other) const { return position == other.position && texcoord == other.texcoord && normal == other.normal; }
+    };
+
+    struct ObjParseResult
+    {
+        std::vector<float> positions; // xyz
+        std::vector<float> texcoords; // uv
+        std::vector<float> normals;   // xyz
+
+        std::vector<ObjIndex> vertices; // unique vertices, in first use order
+        std::vector<uint32_t> indices;  // triangle list into vertices
+    };
+
+    // Native obj parser, works on a read only memory block (usually a mapped file).
+    // The block is split into line aligned chunks which are parsed in parallel:
+    //  1. count v / vt / vn lines of every chunk, prefix sum gives each chunk its global attribute base
+    //  2. parse every chunk, attributes are written in place, faces are fan triangulated into chunk lists
+    //  3. merge the chunk face lists in file order and deduplicate vertices with an open addressing table
+    // Groups, objects and materials are ignored, the whole file becomes a single mesh.
+    class ObjParser
+    {
+    public:
+        static bool parse(const char* data, size_t size, ObjParseResult& result, std::shared_ptr<WorkExecutor> executor = nullptr);
+        static bool parseFile(const std::string& path, ObjParseResult& result, std::shared_ptr<WorkExecutor> executor = nullptr);
+
+    public:
+        // chunks smaller than this are not worth a task
+        static constexpr size_t k_min_chunk_size = 1 << 20;
+    };
+
+    // parse a float in [ptr, end), leading blanks are skipped, returns the position after the number
+    const char* parse_float(const char* ptr, const char* end, float& value);
+} // namespace ArchViz
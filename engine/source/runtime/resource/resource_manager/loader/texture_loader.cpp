@@ -1,4 +1,6 @@
 #include "runtime/resource/resource_manager/loader/texture_loader.h"
+#include "runtime/resource/resource_manager/loader/image/image_decoder.h"
+#include "runtime/resource/resource_manager/loader/ktx2_file.h"
 
 #include "runtime/function/global/global_context.h"
 
@@ -6,16 +8,67 @@
 #include "runtime/resource/config_manager/config_manager.h"
 
 #include "runtime/core/base/macro.h"
+#include "runtime/core/thread/work_executor.h"
 
-#include <stb_image.h>
+#include "runtime/platform/file_system/basic/mapped_file.h"
 
+#include <algorithm>
 #include <filesystem>
+#include <iomanip>
+#include <sstream>
 
 namespace ArchViz
 {
+    namespace
+    {
+        size_t mip_chain_size(uint32_t width, uint32_t height)
+        {
+            size_t total = 0;
+            for (;;)
+            {
+                total += static_cast<size_t>(width) * height * 4;
+                if (width == 1 && height == 1)
+                {
+                    return total;
+                }
+                width  = std::max(width >> 1, 1u);
+                height = std::max(height >> 1, 1u);
+            }
+        }
+
+        // decodes straight into m_data, reserved for the whole mip chain when mips are built afterwards
+        std::shared_ptr<TextureData> decode_texture(const uint8_t* data, size_t size, const std::string& uri, bool reserve_mips, std::shared_ptr<WorkExecutor> executor)
+        {
+            ImageInfo info;
+            if (!ImageDecoder::probe(data, size, info))
+            {
+                LOG_ERROR("unknown image format: {}", uri);
+                return nullptr;
+            }
+
+            std::shared_ptr<TextureData> texture = std::make_shared<TextureData>();
+            texture->m_data.reserve(reserve_mips ? mip_chain_size(info.width, info.height) : ImageDecoder::decodedSize(info));
+            texture->m_data.resize(ImageDecoder::decodedSize(info));
+
+            if (!ImageDecoder::decode(data, size, texture->m_data.data(), texture->m_data.size(), executor))
+            {
+                LOG_ERROR("failed to load texture image: {}", uri);
+                return nullptr;
+            }
+
+            texture->m_width   = static_cast<int32_t>(info.width);
+            texture->m_height  = static_cast<int32_t>(info.height);
+            texture->m_channel = static_cast<int32_t>(info.channels);
+            texture->m_uri     = uri;
+            return texture;
+        }
+    } // namespace
+
+    TextureLoader::TextureLoader(std::shared_ptr<WorkExecutor> executor) : m_executor {std::move(executor)} {}
+
     std::pair<std::shared_ptr<TextureData>, size_t> TextureLoader::createResource(const TextureRes& create_info)
     {
-        std::shared_ptr<TextureData> texture = loadFromFile(create_info.m_texture_uri);
+        std::shared_ptr<TextureData> texture = loadFromFile(create_info.m_texture_uri, parseRole(create_info.m_role));
         if (texture != nullptr)
         {
             return {texture, texture->m_data.size()};
@@ -25,7 +78,7 @@ namespace ArchViz
 
     std::pair<std::shared_ptr<TextureData>, size_t> TextureLoader::createResource(const std::string& uri)
     {
-        std::shared_ptr<TextureData> texture = loadFromFile(uri);
+        std::shared_ptr<TextureData> texture = loadFromFile(uri, TextureRole::Albedo);
         if (texture != nullptr)
         {
             return {texture, texture->m_data.size()};
@@ -33,26 +86,115 @@ namespace ArchViz
         return {nullptr, 0};
     }
 
-    std::shared_ptr<TextureData> TextureLoader::loadFromFile(const std::string& uri)
+    std::shared_ptr<TextureData> TextureLoader::loadFromFile(const std::string& uri, TextureRole role)
     {
         std::filesystem::path root       = g_runtime_global_context.m_config_manager->getRootFolder();
         std::filesystem::path image_path = root / uri;
 
-        std::shared_ptr<TextureData> texture = std::make_shared<TextureData>();
+        TextureCookConfig config = m_cook_config;
+        config.role              = role;
+
+        // a cached ktx2 is valid as long as it is newer than the source image, its name carries the cook settings. When
+        // either time can not be read it is a miss, a missing source is then reported by the open below
+        std::filesystem::path cache_path = getCachePath(uri, config);
+        if (!cache_path.empty())
+        {
+            std::error_code source_error;
+            std::error_code cache_error;
+            const auto      source_time = std::filesystem::last_write_time(image_path, source_error);
+            const auto      cache_time  = std::filesystem::last_write_time(cache_path, cache_error);
+            if (!source_error && !cache_error && cache_time >= source_time)
+            {
+                std::shared_ptr<TextureData> cached = Ktx2File::load(cache_path, uri);
+                if (cached != nullptr)
+                {
+                    return cached;
+                }
+                LOG_WARN("invalid texture cache {}, cook again", cache_path.generic_string());
+            }
+        }
 
-        // int          tex_width, tex_height, tex_channels;
-        stbi_uc* pixels     = stbi_load(image_path.generic_string().c_str(), &texture->m_width, &texture->m_height, &texture->m_channel, STBI_rgb_alpha);
-        size_t   image_size = texture->m_width * texture->m_height * 4;
+        MappedFile file;
+        if (!file.open(image_path.generic_string()))
+        {
+            return nullptr;
+        }
 
-        if (!pixels)
+        std::shared_ptr<TextureData> texture = decode_texture(reinterpret_cast<const uint8_t*>(file.data()), file.size(), uri, config.generate_mips, m_executor);
+        if (texture == nullptr)
         {
-            LOG_ERROR("failed to load texture image!");
             return nullptr;
         }
+        texture->m_srgb = role == TextureRole::Albedo;
+
+        if (config.generate_mips)
+        {
+            TextureCooker::generateMips(*texture, config, m_executor);
+        }
+        if (config.compress)
+        {
+            TextureCooker::compress(*texture, TextureCooker::selectFormat(role, TextureCooker::hasAlpha(*texture), config), m_executor);
+        }
 
-        texture->m_data.resize(image_size);
-        memcpy(texture->m_data.data(), pixels, image_size);
+        if (!cache_path.empty())
+        {
+            Ktx2File::save(cache_path, *texture);
+        }
 
         return texture;
     }
+
+    std::filesystem::path TextureLoader::getCachePath(const std::string& uri, const TextureCookConfig& config) const
+    {
+        const std::filesystem::path& cache_folder = g_runtime_global_context.m_config_manager->getCacheFolder();
+        if (cache_folder.empty())
+        {
+            return {};
+        }
+        // the same image cooks differently per role and per cook settings, a config change never reads an old output
+        std::ostringstream name;
+        name << uri << "." << roleName(config.role) << "." << std::hex << std::setw(16) << std::setfill('0') << TextureCooker::configHash(config) << ".ktx2";
+        return cache_folder / "texture" / name.str();
+    }
+
+    TextureRole TextureLoader::parseRole(const std::string& role)
+    {
+        if (role == "normal")
+        {
+            return TextureRole::Normal;
+        }
+        if (role == "mask")
+        {
+            return TextureRole::Mask;
+        }
+        if (role == "data")
+        {
+            return TextureRole::Data;
+        }
+        if (!role.empty() && role != "albedo")
+        {
+            LOG_WARN("unknown texture role {}, use albedo", role);
+        }
+        return TextureRole::Albedo;
+    }
+
+    const char* TextureLoader::roleName(TextureRole role)
+    {
+        switch (role)
+        {
+            case TextureRole::Normal:
+                return "normal";
+            case TextureRole::Mask:
+                return "mask";
+            case TextureRole::Data:
+                return "data";
+            default:
+                return "albedo";
+        }
+    }
+
+    std::shared_ptr<TextureData> TextureLoader::loadFromMemory(const uint8_t* data, size_t size, const std::string& uri, std::shared_ptr<WorkExecutor> executor)
+    {
+        return decode_texture(data, size, uri, false, executor);
+    }
 } // namespace ArchViz
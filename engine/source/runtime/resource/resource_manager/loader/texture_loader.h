@@ -3,22 +3,44 @@
 
 #include "runtime/resource/res_type/components/material_res.h"
 #include "runtime/resource/res_type/data/material_data.h"
+#include "runtime/resource/resource_manager/compiler/texture_cooker.h"
 
+#include <filesystem>
 #include <memory>
 
 namespace ArchViz
 {
     class ResourceManager;
+    class WorkExecutor;
 
+    // decodes rgba8 (see ImageDecoder), builds the mip chain and block compresses it on the cpu,
+    // cooked textures are cached as ktx2 under the configured cache folder
     class TextureLoader : public Loader<TextureData, TextureRes>
     {
     public:
+        explicit TextureLoader(std::shared_ptr<WorkExecutor> executor = nullptr);
         virtual ~TextureLoader() = default;
 
         std::pair<std::shared_ptr<TextureData>, size_t> createResource(const TextureRes& create_info) override;
         std::pair<std::shared_ptr<TextureData>, size_t> createResource(const std::string& uri) override;
 
+        // decode an encoded image (png, jpg, ...) already in memory, e.g. embedded in a glb
+        // without an executor the decode stays on the calling thread, e.g. when it already runs as a task
+        static std::shared_ptr<TextureData> loadFromMemory(const uint8_t* data, size_t size, const std::string& uri, std::shared_ptr<WorkExecutor> executor = nullptr);
+
+        // TextureRes::m_role, empty or unknown is albedo
+        static TextureRole parseRole(const std::string& role);
+        static const char* roleName(TextureRole role);
+
+    private:
+        std::shared_ptr<TextureData> loadFromFile(const std::string& uri, TextureRole role);
+
+        std::filesystem::path getCachePath(const std::string& uri, const TextureCookConfig& config) const;
+
+    public:
+        TextureCookConfig m_cook_config;
+
     private:
-        std::shared_ptr<TextureData> loadFromFile(const std::string& uri);
+        std::shared_ptr<WorkExecutor> m_executor;
     };
 } // namespace ArchViz
@@ -1,5 +1,6 @@
 #include "runtime/resource/resource_manager/resource_manager.h"
 
+#include "runtime/resource/resource_manager/compiler/mesh_optimizer.h"
 #include "runtime/resource/resource_manager/loader/audio_loader.h"
 #include "runtime/resource/resource_manager/loader/material_loader.h"
 #include "runtime/resource/resource_manager/loader/obj_loader.h"
@@ -18,10 +19,12 @@ namespace ArchViz
         registerResourceType<MaterialData>();
         registerResourceType<AudioData>();
 
-        registerResourceLoader<MeshData, ObjLoader>();
-        registerResourceLoader<TextureData, TextureLoader>();
+        registerResourceLoader<MeshData, ObjLoader>(m_executor);
+        registerResourceLoader<TextureData, TextureLoader>(m_executor);
         registerResourceLoader<MaterialData, MaterialLoader>();
         registerResourceLoader<AudioData, AudioLoader>();
+
+        registerResourceCompiler<MeshData, MeshOptimizer>();
     }
 
     void ResourceManager::clear()
@@ -33,7 +36,11 @@ namespace ArchViz
         m_resource_arrays.clear();
         m_resource_id_arrays.clear();
         m_resource_loaders.clear();
+        m_resource_compilers.clear();
         m_resource_handles.clear();
+
+        std::lock_guard<std::mutex> lock(m_upload_mutex);
+        m_upload_tokens.clear();
     }
 
     const char* ResourceManager::getResourceTypeName(ResourceTypeId type) const
@@ -51,4 +58,32 @@ namespace ArchViz
             return it->second;
         }
     }
+
+    void ResourceManager::setUploadToken(const ResourceHandle& handle, uint64_t token)
+    {
+        std::lock_guard<std::mutex> lock(m_upload_mutex);
+        m_upload_tokens[handle] = token;
+    }
+
+    void ResourceManager::setCompletedUploadToken(uint64_t token)
+    {
+        m_completed_upload_token.store(token, std::memory_order_release);
+
+        // completed entries are dropped so the map only holds uploads in flight
+        std::lock_guard<std::mutex> lock(m_upload_mutex);
+        for (auto it = m_upload_tokens.begin(); it != m_upload_tokens.end();)
+        {
+            it = it->second <= token ? m_upload_tokens.erase(it) : std::next(it);
+        }
+    }
+
+    uint64_t ResourceManager::getCompletedUploadToken() const { return m_completed_upload_token.load(std::memory_order_acquire); }
+
+    bool ResourceManager::isUploaded(const ResourceHandle& handle) const
+    {
+        std::lock_guard<std::mutex> lock(m_upload_mutex);
+
+        auto it = m_upload_tokens.find(handle);
+        return it == m_upload_tokens.end() || it->second <= getCompletedUploadToken();
+    }
 } // namespace ArchViz
@@ -10,11 +10,15 @@
 #include "runtime/resource/resource_manager/resource_array.h"
 #include "runtime/resource/resource_manager/resource_handle.h"
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <type_traits>
 #include <typeinfo>
 #include <unordered_map>
+#include <utility>
 
 namespace ArchViz
 {
@@ -24,10 +28,15 @@ namespace ArchViz
         std::unordered_map<const char*, size_t> resource_max_sizes;
     };
 
+    class WorkExecutor;
+
     // a handle based simple resource manager
     class ResourceManager
     {
     public:
+        // the loaders share the executor, they load inline without one
+        explicit ResourceManager(std::shared_ptr<WorkExecutor> executor = nullptr) : m_executor {std::move(executor)} {}
+
         void initialize();
         void clear();
 
@@ -39,8 +48,8 @@ namespace ArchViz
 
         const char* getResourceTypeName(ResourceTypeId type) const;
 
-        template<typename T, typename L>
-        void registerResourceLoader();
+        template<typename T, typename L, typename... Args>
+        void registerResourceLoader(Args&&... args);
 
         template<typename T, typename C>
         void registerResourceCompiler();
@@ -64,6 +73,13 @@ namespace ArchViz
         template<typename T>
         std::weak_ptr<T> getResource(const std::string& uri);
 
+        // the gpu copy of a resource is usable once the staging uploader completed its token, these may be called
+        // from any thread. A resource that was never uploaded counts as uploaded.
+        void     setUploadToken(const ResourceHandle& handle, uint64_t token);
+        void     setCompletedUploadToken(uint64_t token);
+        uint64_t getCompletedUploadToken() const;
+        bool     isUploaded(const ResourceHandle& handle) const;
+
     private:
         template<typename T>
         ResourceHandle createHandle();
@@ -84,6 +100,8 @@ namespace ArchViz
         std::shared_ptr<ResourceArray<T>> getResourceArray(ResourceTypeId type);
 
     private:
+        std::shared_ptr<WorkExecutor> m_executor;
+
         std::unordered_map<const char*, size_t> m_resource_max_counts; // software constraints
         std::unordered_map<const char*, size_t> m_resource_max_sizes;  // hardware constraints
 
@@ -98,6 +116,10 @@ namespace ArchViz
 
         std::unordered_map<const char*, std::shared_ptr<ILoader>>   m_resource_loaders;   // typeid -> loader
         std::unordered_map<const char*, std::shared_ptr<ICompiler>> m_resource_compilers; // typeid -> compiler
+
+        mutable std::mutex                           m_upload_mutex;
+        std::unordered_map<ResourceHandle, uint64_t> m_upload_tokens; // handle -> token of its last upload
+        std::atomic<uint64_t>                        m_completed_upload_token {0};
     };
 
     template<typename T>
@@ -137,15 +159,15 @@ namespace ArchViz
         }
     }
 
-    template<typename T, typename L>
-    void ResourceManager::registerResourceLoader()
+    template<typename T, typename L, typename... Args>
+    void ResourceManager::registerResourceLoader(Args&&... args)
     {
         // one resource type can only have one loader now
         const std::type_info& type = typeid(T);
 
         if (m_resource_loaders.count(type.name()) == 0)
         {
-            std::shared_ptr<L> loader = std::make_shared<L>();
+            std::shared_ptr<L> loader = std::make_shared<L>(std::forward<Args>(args)...);
 
             // must be a ILoader class
             bool is_loader = std::is_base_of<ILoader, L>::value;
@@ -0,0 +1,122 @@
+// offline build of every shader permutation into a manifest the runtime loads instead of compiling
+// usage: ArchVizShaderBuilder [--config ArchVizEditor.ini] [--output folder] [--threads count]
+// shaders come from <root>/shader/glsl, axes from <root>/shader/permutations.json, a shader without axes is one variant;
+// the default output is <root>/shader/spirv, run it after the editor build copied the shader folder
+
+#include "runtime/core/thread/work_executor.h"
+
+#include "runtime/function/global/global_context.h"
+#include "runtime/function/render/rhi/shader_permutation.h"
+#include "runtime/function/render/rhi/vulkan/utils/vulkan_shader_cache.h"
+#include "runtime/function/render/rhi/vulkan/utils/vulkan_shader_utils.h"
+
+#include "runtime/resource/asset_manager/asset_manager.h"
+#include "runtime/resource/config_manager/config_manager.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace ArchViz;
+using namespace std;
+
+namespace
+{
+    bool is_shader(const std::filesystem::path& path)
+    {
+        const std::string extension = path.extension().generic_string();
+        return extension == ".vert" || extension == ".frag" || extension == ".comp" || extension == ".geom" || extension == ".tesc" || extension == ".tese";
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::filesystem::path executable_path(argv[0]);
+    std::filesystem::path config_file_path = executable_path.parent_path() / "ArchVizEditor.ini";
+    std::filesystem::path output_folder;
+    uint32_t              thread_count = std::thread::hardware_concurrency();
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const std::string option = argv[i];
+        if (option == "--config")
+        {
+            config_file_path = argv[i + 1];
+        }
+        else if (option == "--output")
+        {
+            output_folder = argv[i + 1];
+        }
+        else if (option == "--threads")
+        {
+            thread_count = static_cast<uint32_t>(std::strtoul(argv[i + 1], nullptr, 10));
+        }
+        else
+        {
+            cout << "unknown option " << option << endl;
+            return 1;
+        }
+    }
+
+    g_runtime_global_context.startSystems(config_file_path.generic_string());
+
+    const std::filesystem::path root_folder = g_runtime_global_context.m_config_manager->getRootFolder();
+    if (output_folder.empty())
+    {
+        output_folder = root_folder / "shader" / "spirv";
+    }
+
+    std::vector<ShaderPermutationDesc> descs;
+    if (std::filesystem::exists(root_folder / "shader" / "permutations.json"))
+    {
+        std::string json_text;
+        g_runtime_global_context.m_asset_manager->readTextFile(root_folder / "shader" / "permutations.json", json_text);
+        if (!ShaderPermutationBuilder::parseDescs(json_text, descs))
+        {
+            g_runtime_global_context.shutdownSystems();
+            return 1;
+        }
+    }
+
+    std::set<std::string> declared;
+    for (const auto& desc : descs)
+    {
+        declared.insert(desc.file);
+    }
+
+    std::error_code error;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(root_folder / "shader" / "glsl", error))
+    {
+        if (!entry.is_regular_file() || !is_shader(entry.path()))
+        {
+            continue;
+        }
+        std::string file = "shader/glsl/" + std::filesystem::relative(entry.path(), root_folder / "shader" / "glsl").generic_string();
+        if (declared.count(file) == 0)
+        {
+            descs.push_back({file, {}});
+        }
+    }
+    std::sort(descs.begin(), descs.end(), [](const ShaderPermutationDesc& a, const ShaderPermutationDesc& b) { return a.file < b.file; });
+
+    std::shared_ptr<WorkExecutor> executor = thread_count > 1 ? std::make_shared<WorkExecutor>(thread_count) : nullptr;
+
+    ShaderPermutationBuilder  builder;
+    ShaderPermutationManifest manifest;
+    bool                      built = builder.build(descs, executor, manifest);
+    bool                      saved = manifest.save(output_folder);
+
+    const ShaderBuildStatistics& statistics = builder.getStatistics();
+    const ShaderCacheStatistics  cache      = VulkanShaderUtils::getShaderCache().getStatistics();
+    cout << statistics.shaders << " shaders, " << statistics.variants << " variants, " << statistics.blobs << " distinct spir-v, " << statistics.failed << " failed" << endl;
+    cout << "built in " << statistics.build_ms << " ms on " << thread_count << " threads, " << cache.compiles << " compiled, " << cache.hits << " from the shader cache" << endl;
+    cout << "manifest written to " << output_folder.generic_string() << endl;
+
+    executor.reset();
+    g_runtime_global_context.shutdownSystems();
+    return built && saved ? 0 : 1;
+}
@@ -0,0 +1,153 @@
+#include "runtime/function/render/rhi/bindless_index_allocator.h"
+
+#include "unit_test/test_utils.h"
+
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace ArchViz;
+using namespace std;
+
+namespace
+{
+    bool test_allocate()
+    {
+        BindlessIndexAllocator allocator;
+        allocator.initialize(4, 2);
+
+        const uint32_t a = allocator.allocate();
+        const uint32_t b = allocator.allocate();
+        const uint32_t c = allocator.allocate();
+        const uint32_t d = allocator.allocate();
+
+        bool passed = true;
+        passed &= check("indices handed out from 0", a == 0 && b == 1 && c == 2 && d == 3);
+        passed &= check("full allocator refuses", allocator.allocate() == BindlessIndexAllocator::k_invalid_index);
+        passed &= check("refusal counted", allocator.getStatistics().refused == 1 && allocator.getStatistics().peak == 4);
+        passed &= check("allocated indices tracked", allocator.allocated() == 4 && allocator.isAllocated(2) && !allocator.isAllocated(4));
+        return passed;
+    }
+
+    bool test_deferred_free()
+    {
+        BindlessIndexAllocator allocator;
+        allocator.initialize(2, 2);
+
+        const uint32_t a = allocator.allocate();
+        const uint32_t b = allocator.allocate();
+        allocator.free(a);
+
+        bool passed = true;
+        passed &= check("freed index not allocated", !allocator.isAllocated(a) && allocator.allocated() == 1 && allocator.pending() == 1);
+        passed &= check("freed index not reused in its frame", allocator.allocate() == BindlessIndexAllocator::k_invalid_index);
+
+        allocator.advance();
+        passed &= check("freed index not reused while a frame may use it", allocator.allocate() == BindlessIndexAllocator::k_invalid_index);
+
+        allocator.advance();
+        passed &= check("freed index reused once its frame completed", allocator.allocate() == a && allocator.pending() == 0);
+
+        // the other index never moved
+        passed &= check("live index stable", allocator.isAllocated(b));
+        return passed;
+    }
+
+    bool test_reuse_before_growth()
+    {
+        BindlessIndexAllocator allocator;
+        allocator.initialize(16, 1);
+
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            allocator.allocate();
+        }
+        allocator.free(1);
+        allocator.free(3);
+        allocator.advance();
+
+        const uint32_t first  = allocator.allocate();
+        const uint32_t second = allocator.allocate();
+        const uint32_t third  = allocator.allocate();
+
+        bool passed = true;
+        passed &= check("freed indices reused last in first out", first == 3 && second == 1);
+        passed &= check("array grows once the free list is empty", third == 4);
+        return passed;
+    }
+
+    // random allocations and frees over many frames, a freed index must never come back within the latency
+    bool test_latency()
+    {
+        const uint32_t capacity = 256;
+        const uint32_t latency  = 3;
+
+        BindlessIndexAllocator allocator;
+        allocator.initialize(capacity, latency);
+
+        std::mt19937                            rng(11);
+        std::uniform_int_distribution<uint32_t> count_dist(0, 24);
+
+        std::vector<uint32_t> live;
+        std::vector<int64_t>  freed_frame(capacity, -1);
+        bool                  unique    = true;
+        bool                  too_early = false;
+        bool                  in_bounds = true;
+
+        for (uint32_t frame = 0; frame < 2000; ++frame)
+        {
+            const uint32_t allocations = count_dist(rng);
+            for (uint32_t i = 0; i < allocations; ++i)
+            {
+                const uint32_t index = allocator.allocate();
+                if (index == BindlessIndexAllocator::k_invalid_index)
+                {
+                    break;
+                }
+
+                in_bounds &= index < capacity;
+                for (uint32_t other : live)
+                {
+                    unique &= other != index;
+                }
+                too_early |= freed_frame[index] >= 0 && frame < freed_frame[index] + latency;
+                live.push_back(index);
+            }
+
+            const uint32_t frees = std::min<uint32_t>(count_dist(rng), static_cast<uint32_t>(live.size()));
+            for (uint32_t i = 0; i < frees; ++i)
+            {
+                const size_t   slot  = rng() % live.size();
+                const uint32_t index = live[slot];
+                live[slot]           = live.back();
+                live.pop_back();
+
+                allocator.free(index);
+                freed_frame[index] = frame;
+            }
+
+            allocator.advance();
+        }
+
+        cout << "    " << allocator.getStatistics().allocations << " allocations, " << allocator.getStatistics().refused << " refused, peak " << allocator.getStatistics().peak << " of " << capacity << endl;
+
+        bool passed = true;
+        passed &= check("live indices unique", unique && in_bounds);
+        passed &= check("no index reused within the frame latency", !too_early);
+        passed &= check("allocated count matches", allocator.allocated() == live.size());
+        return passed;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    bool passed = true;
+    passed &= test_allocate();
+    passed &= test_deferred_free();
+    passed &= test_reuse_before_growth();
+    passed &= test_latency();
+
+    cout << (passed ? "all passed" : "some failed") << endl;
+    return passed ? 0 : 1;
+}
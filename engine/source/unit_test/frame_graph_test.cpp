@@ -4,13 +4,713 @@
 
 #include "runtime/function/render/rhi/frame_graph/frame_graph.h"
 
+#include "unit_test/test_utils.h"
+
+#include <chrono>
 #include <filesystem>
 #include <iostream>
 #include <memory>
+#include <random>
+#include <string>
+#include <vector>
 
 using namespace ArchViz;
 using namespace std;
 
+namespace
+{
+    double to_mb(uint64_t bytes) { return static_cast<double>(bytes) / (1024.0 * 1024.0); }
+
+    uint32_t position_of(const FrameGraph& graph, const std::string& name)
+    {
+        for (uint32_t i = 0; i < graph.nodes.size(); ++i)
+        {
+            if (graph.builder.node_cache.nodes[graph.nodes[i].index].name == name)
+            {
+                return i;
+            }
+        }
+        return k_invalid_index;
+    }
+
+    // every input is produced earlier in the sorted list
+    bool sorted(FrameGraph& graph)
+    {
+        for (uint32_t i = 0; i < graph.nodes.size(); ++i)
+        {
+            for (auto& input : graph.builder.accessNode(graph.nodes[i])->inputs)
+            {
+                FrameGraphResource* resource = graph.builder.accessResource(input);
+                if (resource->producer.index == k_invalid_index)
+                {
+                    continue;
+                }
+                const uint32_t producer = position_of(graph, graph.builder.accessNode(resource->producer)->name);
+                if (producer == k_invalid_index || producer >= i)
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // resources alive at the same time never share bytes, and the heaps hold every allocation
+    bool plan_valid(const FrameGraphMemoryPlan& plan)
+    {
+        for (uint32_t i = 0; i < plan.allocations.size(); ++i)
+        {
+            const FrameGraphAllocation& a = plan.allocations[i];
+            if (a.heap >= plan.heaps.size() || a.offset + a.size > plan.heaps[a.heap].size)
+            {
+                return false;
+            }
+            for (uint32_t j = i + 1; j < plan.allocations.size(); ++j)
+            {
+                const FrameGraphAllocation& b = plan.allocations[j];
+
+                const bool same_time  = a.first_use <= b.last_use && b.first_use <= a.last_use;
+                const bool same_bytes = a.offset < b.offset + b.size && b.offset < a.offset + a.size;
+                if (a.heap == b.heap && same_time && same_bytes)
+                {
+                    return false;
+                }
+            }
+        }
+        return plan.aliased_size <= plan.unaliased_size && plan.aliased_size >= plan.peak_live_size;
+    }
+
+    // replays the barriers in pass order, every transition has to start from the layout the last one left
+    bool barriers_valid(const FrameGraphBarrierPlan& plan, uint32_t resource_count)
+    {
+        std::vector<VkImageLayout> layouts(resource_count, VK_IMAGE_LAYOUT_UNDEFINED);
+        std::vector<bool>          touched(resource_count, false);
+
+        auto apply = [&](const FrameGraphBarrier& barrier) {
+            if (!barrier.image)
+            {
+                return true;
+            }
+            const uint32_t index = barrier.resource.index;
+            // first uses start undefined, aliased memory holds nothing to keep
+            const bool chained = !touched[index] ? barrier.src.layout == VK_IMAGE_LAYOUT_UNDEFINED : barrier.src.layout == layouts[index];
+            layouts[index]     = barrier.dst.layout;
+            touched[index]     = true;
+            return chained && barrier.src.stages != 0 && barrier.dst.stages != 0;
+        };
+
+        for (uint32_t pass = 0; pass < plan.passes.size(); ++pass)
+        {
+            for (uint32_t index : plan.passes[pass].wait_events)
+            {
+                const FrameGraphEvent& event = plan.events[index];
+                if (event.wait != pass || event.signal + 1 >= event.wait)
+                {
+                    return false;
+                }
+                for (const auto& barrier : event.barriers)
+                {
+                    if (!apply(barrier))
+                    {
+                        return false;
+                    }
+                }
+            }
+            for (const auto& barrier : plan.passes[pass].barriers)
+            {
+                if (!apply(barrier) || (barrier.src.stages & ~plan.passes[pass].src_stages) != 0 || (barrier.dst.stages & ~plan.passes[pass].dst_stages) != 0)
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // every dependency is ordered on its queue or covered by a semaphore, the estimate sits between the critical path and running serially
+    bool schedule_valid(const std::vector<FrameGraphSchedulePass>& passes, const FrameGraphSchedule& schedule)
+    {
+        const uint32_t count = static_cast<uint32_t>(passes.size());
+        if (schedule.order.size() != count || schedule.queues.size() != count || schedule.start.size() != count || schedule.finish.size() != count)
+        {
+            return false;
+        }
+
+        std::vector<uint32_t> position(count, k_invalid_index);
+        std::vector<uint32_t> batch_of(count, k_invalid_index);
+        uint32_t              next = 0;
+        for (uint32_t batch = 0; batch < schedule.batches.size(); ++batch)
+        {
+            const FrameGraphSubmitBatch& submit = schedule.batches[batch];
+            if (submit.first != next || submit.count == 0)
+            {
+                return false;
+            }
+            for (uint32_t index = submit.first; index < submit.first + submit.count; ++index)
+            {
+                if (schedule.order[index] >= count || position[schedule.order[index]] != k_invalid_index || schedule.queues[index] != submit.queue)
+                {
+                    return false;
+                }
+                position[schedule.order[index]] = index;
+                batch_of[index]                 = batch;
+            }
+            next += submit.count;
+        }
+        if (next != count)
+        {
+            return false;
+        }
+
+        for (const auto& semaphore : schedule.semaphores)
+        {
+            if (semaphore.signal_batch >= semaphore.wait_batch || semaphore.wait_batch >= schedule.batches.size() ||
+                schedule.batches[semaphore.signal_batch].queue == schedule.batches[semaphore.wait_batch].queue || semaphore.wait_stages == 0)
+            {
+                return false;
+            }
+        }
+
+        uint32_t last_graphics = 0;
+        for (uint32_t pass = 0; pass < count; ++pass)
+        {
+            const uint32_t at = position[pass];
+
+            // graphics passes keep the order they were given in
+            if (schedule.queues[at] == FrameGraphQueueType::Graphics)
+            {
+                if (at < last_graphics)
+                {
+                    return false;
+                }
+                last_graphics = at;
+            }
+
+            for (uint32_t dependency : passes[pass].dependencies)
+            {
+                const uint32_t from = position[dependency];
+                if (from >= at || schedule.start[at] + 1e-4f < schedule.finish[from])
+                {
+                    return false;
+                }
+                if (schedule.queues[from] == schedule.queues[at])
+                {
+                    continue;
+                }
+
+                bool covered = false;
+                for (const auto& semaphore : schedule.semaphores)
+                {
+                    covered |= schedule.batches[semaphore.wait_batch].queue == schedule.queues[at] && semaphore.wait_batch <= batch_of[at] &&
+                               schedule.batches[semaphore.signal_batch].queue == schedule.queues[from] && semaphore.signal_batch >= batch_of[from];
+                }
+                if (!covered)
+                {
+                    return false;
+                }
+            }
+        }
+
+        return schedule.critical_path <= schedule.scheduled_length + 1e-4f && schedule.scheduled_length <= schedule.serial_length + 1e-4f;
+    }
+
+    FrameGraphAccess make_access(uint32_t resource, VkPipelineStageFlags stages, VkAccessFlags access, VkImageLayout layout, bool write)
+    {
+        FrameGraphAccess result;
+        result.resource = {resource};
+        result.state    = {stages, access, layout};
+        result.image    = layout != VK_IMAGE_LAYOUT_UNDEFINED;
+        result.write    = write;
+        result.aspect   = VK_IMAGE_ASPECT_COLOR_BIT;
+        return result;
+    }
+
+    bool test_barrier_rules()
+    {
+        const FrameGraphAccess color_write   = make_access(0, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, true);
+        const FrameGraphAccess fragment_read = make_access(0, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false);
+        const FrameGraphAccess compute_read  = make_access(0, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false);
+
+        // write, two reads in the same stage, a read in another stage, then drawn over again
+        FrameGraphBarrierPlan chain;
+        plan_frame_graph_barriers({{color_write}, {fragment_read}, {fragment_read}, {compute_read}, {color_write}}, nullptr, nullptr, 1, false, chain);
+
+        const auto& war          = chain.passes[4].barriers;
+        const bool  war_waits    = war.size() == 1 && war[0].src.stages == (VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT) && war[0].src.access == 0;
+        const bool  chain_counts = chain.statistics.barriers == 4 && chain.statistics.skipped == 1 && chain.statistics.transitions == 3 && chain.passes[2].barriers.empty();
+
+        // a dependency skipping a pass becomes an event, without splitting it stays a barrier before the reader
+        const FrameGraphAccess other_write = make_access(1, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, true);
+
+        FrameGraphBarrierPlan split;
+        FrameGraphBarrierPlan joined;
+        plan_frame_graph_barriers({{color_write}, {other_write}, {fragment_read}}, nullptr, nullptr, 2, true, split);
+        plan_frame_graph_barriers({{color_write}, {other_write}, {fragment_read}}, nullptr, nullptr, 2, false, joined);
+
+        const bool split_event    = split.events.size() == 1 && split.events[0].signal == 0 && split.events[0].wait == 2 && split.passes[0].signal_events.size() == 1 &&
+                                    split.passes[2].wait_events.size() == 1 && split.passes[2].barriers.empty() && split.statistics.split == 1;
+        const bool joined_barrier = joined.events.empty() && joined.passes[2].barriers.size() == 1;
+
+        // two resources first used in one pass share one barrier, a resource listed twice is touched once
+        FrameGraphBarrierPlan merged;
+        plan_frame_graph_barriers({{color_write, other_write, color_write}}, nullptr, nullptr, 2, true, merged);
+
+        const bool one_barrier = merged.statistics.pipeline_barriers == 1 && merged.passes[0].barriers.size() == 2 && merged.statistics.accesses == 2 &&
+                                 merged.passes[0].dst_stages == (VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+        // resource 1 takes the bytes resource 0 used, its first use waits for the last use of resource 0, the read that already waited for the write
+        FrameGraphMemoryPlan memory;
+        memory.allocations.push_back({{0}, 0, 0, 1024, 0, 1});
+        memory.allocations.push_back({{1}, 0, 0, 1024, 2, 2});
+        memory.heaps.push_back({FrameGraphHeapType::Texture, 1024, 2});
+
+        FrameGraphBarrierPlan aliased;
+        plan_frame_graph_barriers({{color_write}, {fragment_read}, {other_write}}, nullptr, &memory, 2, true, aliased);
+
+        const auto& handover      = aliased.passes[2].barriers;
+        const bool  alias_barrier = handover.size() == 1 && handover[0].src.layout == VK_IMAGE_LAYOUT_UNDEFINED && handover[0].src.stages == VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+
+        bool passed = true;
+        passed &= check("read after read skipped", chain_counts && barriers_valid(chain, 1));
+        passed &= check("write after read waits for the readers", war_waits);
+        passed &= check("gap becomes a split barrier", split_event && joined_barrier && barriers_valid(split, 2));
+        passed &= check("barriers of a pass merged", one_barrier);
+        passed &= check("aliased first use waits for the previous owner", alias_barrier);
+        return passed;
+    }
+
+    void print_schedule(const char* name, const FrameGraphSchedule& schedule)
+    {
+        cout << name << ": serial " << schedule.serial_length << ", critical path " << schedule.critical_path << ", scheduled " << schedule.scheduled_length << ", "
+             << schedule.batches.size() << " batches, " << schedule.semaphores.size() << " semaphores for " << schedule.cross_queue_dependencies << " cross queue dependencies"
+             << endl;
+    }
+
+    FrameGraphSchedulePass make_pass(std::vector<uint32_t> dependencies, bool async)
+    {
+        FrameGraphSchedulePass pass;
+        pass.dependencies = std::move(dependencies);
+        pass.wait_stages  = async ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        pass.async        = async;
+        return pass;
+    }
+
+    bool test_schedule_rules()
+    {
+        // a graphics chain of eight passes, a compute chain of four hanging off the first one and feeding the last one
+        std::vector<FrameGraphSchedulePass> passes;
+        passes.push_back(make_pass({}, false));
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            passes.push_back(make_pass({i}, true));
+        }
+        passes.push_back(make_pass({0}, false));
+        for (uint32_t i = 0; i < 5; ++i)
+        {
+            passes.push_back(make_pass({5 + i}, false));
+        }
+        passes.push_back(make_pass({10, 4}, false));
+
+        FrameGraphSchedule serial;
+        FrameGraphSchedule overlapped;
+        plan_frame_graph_schedule(passes, false, serial);
+        plan_frame_graph_schedule(passes, true, overlapped);
+
+        bool same_order = true;
+        for (uint32_t i = 0; i < serial.order.size(); ++i)
+        {
+            same_order &= serial.order[i] == i;
+        }
+        const bool one_batch = serial.batches.size() == 1 && serial.semaphores.empty() && serial.scheduled_length == serial.serial_length;
+
+        // the compute chain runs beside graphics passes 5 to 10, one semaphore in and one out
+        const bool overlaps = overlapped.serial_length == 12.0f && overlapped.critical_path == 8.0f && overlapped.scheduled_length == 8.0f &&
+                              overlapped.semaphores.size() == 2 && overlapped.cross_queue_dependencies == 2 && overlapped.batches.size() == 4;
+
+        // two graphics passes reading the same compute pass, the first wait covers the second
+        FrameGraphSchedule pruned;
+        plan_frame_graph_schedule({make_pass({}, true), make_pass({}, false), make_pass({0, 1}, false), make_pass({0, 2}, false)}, true, pruned);
+
+        const bool one_wait = pruned.cross_queue_dependencies == 2 && pruned.semaphores.size() == 1 && pruned.semaphores[0].wait_stages == VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+
+        // a compute pass written after an independent graphics pass still goes first when its queue is free
+        FrameGraphSchedule hoisted;
+        plan_frame_graph_schedule({make_pass({}, false), make_pass({}, false), make_pass({}, true), make_pass({2, 1}, false)}, true, hoisted);
+
+        const bool compute_first = hoisted.order[0] == 2 && hoisted.scheduled_length == 3.0f;
+
+        bool passed = true;
+        passed &= check("schedule without async keeps one batch", same_order && one_batch && schedule_valid(passes, serial));
+        passed &= check("async compute overlaps graphics", overlaps && schedule_valid(passes, overlapped));
+        passed &= check("covered cross queue waits dropped", one_wait);
+        passed &= check("ready compute submitted first", compute_first);
+        return passed;
+    }
+
+    // random dependencies a few passes back, about a third of the passes async
+    bool test_synthetic_schedule(uint32_t pass_count, uint32_t seed)
+    {
+        std::mt19937                            random(seed);
+        std::uniform_int_distribution<uint32_t> input_count(1, 3);
+        std::uniform_int_distribution<uint32_t> distance(1, 12);
+        std::uniform_int_distribution<uint32_t> cost(1, 4);
+        std::uniform_int_distribution<uint32_t> async(0, 2);
+
+        std::vector<FrameGraphSchedulePass> passes(pass_count);
+        for (uint32_t pass = 0; pass < pass_count; ++pass)
+        {
+            for (uint32_t i = pass > 0 ? input_count(random) : 0; i > 0; --i)
+            {
+                passes[pass].dependencies.push_back(pass - std::min(distance(random), pass));
+            }
+            passes[pass].async       = async(random) == 0;
+            passes[pass].cost        = static_cast<float>(cost(random));
+            passes[pass].wait_stages = passes[pass].async ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        }
+
+        FrameGraphSchedule schedule;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        plan_frame_graph_schedule(passes, true, schedule);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        print_schedule(("synthetic schedule " + std::to_string(pass_count) + " passes, seed " + std::to_string(seed)).c_str(), schedule);
+        cout << "schedule: " << std::chrono::duration<double, std::milli>(end - start).count() << " ms" << endl;
+
+        bool passed = true;
+        passed &= check("synthetic schedule valid", schedule_valid(passes, schedule));
+        passed &= check("synthetic schedule overlaps", schedule.scheduled_length < schedule.serial_length);
+        return passed;
+    }
+
+    void print_barriers(const char* name, const FrameGraphBarrierPlan& plan)
+    {
+        const FrameGraphBarrierStatistics& statistics = plan.statistics;
+        cout << name << ": " << statistics.accesses << " accesses, " << statistics.barriers << " barriers (" << statistics.transitions << " transitions, " << statistics.split
+             << " split), " << statistics.skipped << " skipped, " << statistics.pipeline_barriers << " pipeline barriers, " << plan.events.size() << " events" << endl;
+    }
+
+    void print_plan(const char* name, const FrameGraphMemoryPlan& plan)
+    {
+        cout << name << ": " << plan.allocations.size() << " transients, " << plan.heaps.size() << " heaps, before " << to_mb(plan.unaliased_size) << " MB, after "
+             << to_mb(plan.aliased_size) << " MB, live peak " << to_mb(plan.peak_live_size) << " MB" << endl;
+    }
+
+    bool test_asset_graph(const std::shared_ptr<AssetManager>& asset_manager)
+    {
+        FrameGraphCreation create_info;
+
+        asset_manager->loadVFSAsset("asset/render/test.frame_graph.json", create_info);
+
+        // begin frame graph
+        FrameGraph graph;
+
+        graph.init(create_info);
+
+        graph.compile();
+
+        graph.printResult();
+
+        std::string result;
+        generate_graphviz(graph, result);
+        LOG_DEBUG("\n" + result);
+
+        FrameGraphResource* color_a = graph.builder.getResource("colorA");
+        FrameGraphResource* depth_a = graph.builder.getResource("depthA");
+        FrameGraphResource* color_e = graph.builder.getResource("colorE");
+
+        const bool lifetimes = color_a && depth_a && color_e && color_a->first_use == position_of(graph, "A") && color_a->last_use == position_of(graph, "B") &&
+                               depth_a->last_use == position_of(graph, "F") && color_e->first_use == color_e->last_use;
+
+        print_plan("test.frame_graph.json", graph.memory_plan);
+        print_barriers("test.frame_graph.json", graph.barrier_plan);
+
+        const uint32_t resource_count = static_cast<uint32_t>(graph.builder.resource_cache.resources.size());
+
+        bool passed = true;
+        passed &= check("asset graph sorted", graph.nodes.size() == 6 && sorted(graph));
+        passed &= check("asset graph lifetimes", lifetimes);
+        passed &= check("asset graph plan valid", graph.memory_plan.allocations.size() == 8 && plan_valid(graph.memory_plan));
+        passed &= check("asset graph aliases", graph.memory_plan.aliased_size < graph.memory_plan.unaliased_size);
+        passed &= check("asset graph barriers valid", graph.barrier_plan.passes.size() == 6 && barriers_valid(graph.barrier_plan, resource_count));
+        passed &= check("asset graph splits the skipping reads", graph.barrier_plan.statistics.split == 3);
+
+        graph.shutdown();
+        return passed;
+    }
+
+    // passes reading a few outputs of the passes shortly before them, like a long post process chain, every compute_every-th one a compute pass
+    FrameGraphCreation make_synthetic_graph(uint32_t pass_count, uint32_t seed, uint32_t compute_every = 0)
+    {
+        static const char* k_formats[] = {"VK_FORMAT_R8G8B8A8_UNORM", "VK_FORMAT_R16G16B16A16_SFLOAT", "VK_FORMAT_D32_SFLOAT", "VK_FORMAT_R32_SFLOAT"};
+
+        std::mt19937                            random(seed);
+        std::uniform_int_distribution<uint32_t> output_count(1, 3);
+        std::uniform_int_distribution<uint32_t> input_count(1, 3);
+        std::uniform_int_distribution<uint32_t> distance(1, 8);
+        std::uniform_int_distribution<uint32_t> format(0, 3);
+        std::uniform_int_distribution<uint32_t> scale(0, 2);
+
+        FrameGraphCreation creation;
+        creation.name = "synthetic";
+
+        std::vector<std::vector<std::string>> outputs(pass_count);
+        for (uint32_t pass = 0; pass < pass_count; ++pass)
+        {
+            FrameGraphNodeCreation node;
+            node.name    = "synthetic_pass_" + std::to_string(pass);
+            node.enabled = true;
+            node.compute = compute_every != 0 && pass % compute_every == compute_every - 1;
+
+            if (pass > 0)
+            {
+                for (uint32_t i = input_count(random); i > 0; --i)
+                {
+                    const uint32_t producer = pass - std::min(distance(random), pass);
+
+                    FrameGraphResourceInputCreation input;
+                    input.name = outputs[producer][i % outputs[producer].size()];
+                    node.inputs.push_back(input);
+                }
+            }
+
+            for (uint32_t i = output_count(random); i > 0; --i)
+            {
+                FrameGraphResourceOutputCreation output;
+                output.name = node.name + "_output_" + std::to_string(i);
+                if (pass % 16 == 15 && i == 1)
+                {
+                    output.type_name = "buffer";
+                    output.size      = 4 * 1024 * 1024;
+                }
+                else if (node.compute)
+                {
+                    output.type_name = "texture";
+                    output.format    = k_formats[format(random) % 2];
+                    output.width     = 1920 >> scale(random);
+                    output.height    = 1080 >> scale(random);
+                }
+                else
+                {
+                    output.type_name = "attachment";
+                    output.format    = k_formats[format(random)];
+                    output.width     = 1920 >> scale(random);
+                    output.height    = 1080 >> scale(random);
+                }
+                outputs[pass].push_back(output.name);
+                node.outputs.push_back(output);
+            }
+
+            creation.nodes.push_back(node);
+        }
+        return creation;
+    }
+
+    bool test_synthetic_graph(uint32_t pass_count, uint32_t seed)
+    {
+        FrameGraph graph;
+        graph.init(make_synthetic_graph(pass_count, seed));
+
+        auto start = std::chrono::high_resolution_clock::now();
+        graph.compile();
+        auto end = std::chrono::high_resolution_clock::now();
+
+        const std::string name = "synthetic " + std::to_string(pass_count) + " passes, seed " + std::to_string(seed);
+        print_plan(name.c_str(), graph.memory_plan);
+        print_barriers(name.c_str(), graph.barrier_plan);
+        cout << "compile: " << std::chrono::duration<double, std::milli>(end - start).count() << " ms" << endl;
+
+        bool passed = true;
+        passed &= check("synthetic graph sorted", graph.nodes.size() == pass_count && sorted(graph));
+        passed &= check("synthetic plan valid", plan_valid(graph.memory_plan) && graph.memory_plan.heaps.size() == 2);
+        passed &= check("synthetic graph aliases", graph.memory_plan.aliased_size * 4 < graph.memory_plan.unaliased_size);
+        passed &= check("synthetic barriers valid", barriers_valid(graph.barrier_plan, static_cast<uint32_t>(graph.builder.resource_cache.resources.size())));
+        passed &= check("synthetic barriers batched", graph.barrier_plan.statistics.pipeline_barriers <= pass_count && graph.barrier_plan.statistics.barriers <= graph.barrier_plan.statistics.accesses);
+
+        // a second compile of the same graph gives the same plan, planned again rather than taken from the cache
+        graph.reset();
+        graph.compiled_cache.clear();
+        FrameGraphMemoryPlan first = graph.memory_plan;
+        graph.compile();
+
+        bool same = first.allocations.size() == graph.memory_plan.allocations.size() && first.aliased_size == graph.memory_plan.aliased_size;
+        for (uint32_t i = 0; same && i < first.allocations.size(); ++i)
+        {
+            same &= first.allocations[i].offset == graph.memory_plan.allocations[i].offset && first.allocations[i].heap == graph.memory_plan.allocations[i].heap;
+        }
+        passed &= check("recompile gives the same plan", same && graph.compile_statistics.partial == 1);
+
+        graph.shutdown();
+        return passed;
+    }
+
+    // compute nodes move to the compute queue, the graph still runs every dependency in order
+    bool test_async_graph(uint32_t pass_count, uint32_t seed)
+    {
+        FrameGraph graph;
+        graph.init(make_synthetic_graph(pass_count, seed, 4));
+        graph.compile();
+
+        const std::string name = "synthetic async " + std::to_string(pass_count) + " passes, seed " + std::to_string(seed);
+        print_schedule(name.c_str(), graph.schedule);
+        print_plan(name.c_str(), graph.memory_plan);
+        print_barriers(name.c_str(), graph.barrier_plan);
+
+        uint32_t compute = 0;
+        for (auto queue : graph.schedule.queues)
+        {
+            compute += queue == FrameGraphQueueType::Compute ? 1 : 0;
+        }
+
+        const FrameGraphSchedule& schedule = graph.schedule;
+        const bool                batches  = !schedule.batches.empty() && schedule.batches.back().first + schedule.batches.back().count == pass_count;
+
+        bool passed = true;
+        passed &= check("async graph sorted", graph.nodes.size() == pass_count && sorted(graph));
+        passed &= check("async graph uses both queues", compute == pass_count / 4 && !schedule.semaphores.empty() && batches);
+        passed &= check("async graph overlaps", schedule.critical_path <= schedule.scheduled_length && schedule.scheduled_length < schedule.serial_length);
+        passed &= check("async graph plan valid", plan_valid(graph.memory_plan));
+        passed &= check("async graph barriers valid", barriers_valid(graph.barrier_plan, static_cast<uint32_t>(graph.builder.resource_cache.resources.size())));
+
+        graph.shutdown();
+        return passed;
+    }
+
+    bool same_compile(const FrameGraph& a, const FrameGraph& b)
+    {
+        bool same = a.nodes.size() == b.nodes.size() && a.memory_plan.aliased_size == b.memory_plan.aliased_size &&
+                    a.memory_plan.allocations.size() == b.memory_plan.allocations.size() && a.barrier_plan.statistics.barriers == b.barrier_plan.statistics.barriers &&
+                    a.barrier_plan.statistics.split == b.barrier_plan.statistics.split && a.schedule.batches.size() == b.schedule.batches.size();
+        for (uint32_t i = 0; same && i < a.nodes.size(); ++i)
+        {
+            same &= a.nodes[i].index == b.nodes[i].index;
+        }
+        for (uint32_t i = 0; same && i < a.memory_plan.allocations.size(); ++i)
+        {
+            same &= a.memory_plan.allocations[i].offset == b.memory_plan.allocations[i].offset;
+        }
+        for (uint32_t i = 0; same && i < a.builder.resource_cache.resources.size(); ++i)
+        {
+            same &= a.builder.resource_cache.resources[i].first_use == b.builder.resource_cache.resources[i].first_use &&
+                    a.builder.resource_cache.resources[i].last_use == b.builder.resource_cache.resources[i].last_use;
+        }
+        return same;
+    }
+
+    // an unchanged graph is reused, toggling a node filters the sorted order and comes out like a graph built with the node off
+    bool test_incremental_compile()
+    {
+        // nothing reads the last pass, turning it off drops it from the sorted nodes
+        const uint32_t     toggled  = 299;
+        FrameGraphCreation creation = make_synthetic_graph(300, 4, 8);
+
+        FrameGraph graph;
+        graph.init(creation);
+        graph.compile();
+
+        FrameGraph first;
+        first.init(creation);
+        first.compile();
+
+        graph.reset();
+        graph.compile();
+        const bool reused = graph.compile_statistics.cache_hits == 1 && graph.compile_statistics.full == 1 && same_compile(graph, first);
+
+        graph.builder.node_cache.nodes[toggled].enabled = false;
+        graph.reset();
+        graph.compile();
+
+        creation.nodes[toggled].enabled = false;
+        FrameGraph expected;
+        expected.init(creation);
+        expected.compile();
+
+        const bool partial = graph.compile_statistics.partial == 1 && graph.compile_statistics.full == 1 && graph.nodes.size() == 299 && same_compile(graph, expected);
+
+        // back on, the first compile comes out of the cache
+        graph.builder.node_cache.nodes[toggled].enabled = true;
+        graph.reset();
+        graph.compile();
+        const bool restored = graph.compile_statistics.cache_hits == 2 && graph.compile_statistics.partial == 1 && same_compile(graph, first);
+
+        // a resource description change sorts everything again
+        FrameGraphResourceOutputCreation output = creation.nodes[0].outputs[0];
+        output.width /= 2;
+        graph.builder.setResourceInfo(graph.builder.getResource(output.name)->output_handle, output);
+        graph.compile();
+        const bool resorted = graph.compile_statistics.full == 2 && plan_valid(graph.memory_plan);
+
+        // the cache never grows past its capacity
+        for (uint32_t node = 0; node < 20; ++node)
+        {
+            graph.builder.node_cache.nodes[node].enabled = !graph.builder.node_cache.nodes[node].enabled;
+            graph.compile();
+        }
+        const bool bounded = graph.compiled_cache.size() == graph.compiled_cache_capacity;
+
+        bool passed = true;
+        passed &= check("unchanged graph reused", reused);
+        passed &= check("toggled node compiles like a fresh graph", partial);
+        passed &= check("toggled back comes from the cache", restored);
+        passed &= check("resource change sorts again", resorted);
+        passed &= check("compiled cache bounded", bounded);
+
+        first.shutdown();
+        expected.shutdown();
+        graph.shutdown();
+        return passed;
+    }
+
+    // per frame compile cost: the first compile, the same graph again, toggling between two graphs, a new node toggled every frame
+    void benchmark_compile(uint32_t pass_count)
+    {
+        const uint32_t frames = 64;
+
+        FrameGraph graph;
+        graph.init(make_synthetic_graph(pass_count, 5, 8));
+
+        using clock = std::chrono::high_resolution_clock;
+        auto elapsed = [](clock::time_point start) { return std::chrono::duration<double, std::milli>(clock::now() - start).count(); };
+
+        auto start = clock::now();
+        graph.compile();
+        const double cold = elapsed(start);
+
+        start = clock::now();
+        for (uint32_t frame = 0; frame < frames; ++frame)
+        {
+            graph.reset();
+            graph.compile();
+        }
+        const double unchanged = elapsed(start) / frames;
+
+        FrameGraphNode& debug = graph.builder.node_cache.nodes[pass_count / 2];
+        start                 = clock::now();
+        for (uint32_t frame = 0; frame < frames; ++frame)
+        {
+            debug.enabled = !debug.enabled;
+            graph.reset();
+            graph.compile();
+        }
+        const double cached = elapsed(start) / frames;
+
+        start = clock::now();
+        for (uint32_t frame = 0; frame < frames; ++frame)
+        {
+            FrameGraphNode& node = graph.builder.node_cache.nodes[(frame * 7919) % pass_count];
+            node.enabled         = !node.enabled;
+            graph.reset();
+            graph.compile();
+        }
+        const double toggled = elapsed(start) / frames;
+
+        cout << "compile " << pass_count << " passes: first " << cold << " ms, unchanged " << unchanged << " ms, cached toggle " << cached << " ms, new toggle " << toggled
+             << " ms per frame" << endl;
+
+        graph.shutdown();
+    }
+} // namespace
+
 int main(int argc, char** argv)
 {
     std::filesystem::path executable_path(argv[0]);
@@ -28,24 +728,22 @@ int main(int argc, char** argv)
     vfs->mount(config);
     asset_manager->setVFS(vfs);
 
-    FrameGraphCreation create_info;
-
-    asset_manager->loadVFSAsset("asset/render/test.frame_graph.json", create_info);
-
-    // begin frame graph
-    FrameGraph graph;
-
-    graph.init(create_info);
-
-    graph.compile();
-
-    graph.printResult();
-
-    std::string result;
-    generate_graphviz(graph, result);
-    LOG_DEBUG("\n" + result);
+    bool passed = true;
+    passed &= test_barrier_rules();
+    passed &= test_schedule_rules();
+    passed &= test_asset_graph(asset_manager);
+    passed &= test_synthetic_graph(500, 1);
+    passed &= test_synthetic_graph(500, 2);
+    passed &= test_synthetic_schedule(500, 1);
+    passed &= test_synthetic_schedule(2000, 2);
+    passed &= test_async_graph(500, 3);
+    passed &= test_incremental_compile();
 
-    graph.shutdown();
+    for (uint32_t pass_count : {100u, 250u, 500u, 1000u, 2000u})
+    {
+        benchmark_compile(pass_count);
+    }
 
-    return 0;
+    cout << (passed ? "all passed" : "some failed") << endl;
+    return passed ? 0 : 1;
 }
@@ -0,0 +1,153 @@
+#include "runtime/core/memory/allocators/frame_linear_allocator.h"
+
+#include "unit_test/test_utils.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace ArchViz;
+using namespace std;
+
+namespace
+{
+    bool test_alignment()
+    {
+        FrameLinearAllocator allocator;
+        allocator.initialize(nullptr, 1024, 2, 256);
+
+        const size_t a = allocator.allocate(4);
+        const size_t b = allocator.allocate(300);
+        const size_t c = allocator.allocate(256);
+
+        bool passed = true;
+        passed &= check("offsets aligned", a % 256 == 0 && b % 256 == 0 && c % 256 == 0);
+        passed &= check("allocations padded to the alignment", a == 0 && b == 256 && c == 768);
+        passed &= check("full frame refuses", allocator.allocate(1) == FrameLinearAllocator::k_invalid_offset);
+        passed &= check("refusal counted", allocator.getStatistics().refused == 1 && allocator.getStatistics().bytes == 560);
+        passed &= check("used clamped to the frame", allocator.used() == 1024);
+        return passed;
+    }
+
+    bool test_frames()
+    {
+        FrameLinearAllocator allocator;
+        allocator.initialize(nullptr, 512, 3, 64);
+
+        bool passed = true;
+        for (uint32_t frame = 0; frame < 3; ++frame)
+        {
+            allocator.beginFrame(frame);
+            const size_t offset = allocator.allocate(64);
+            passed &= offset == frame * 512;
+        }
+        passed = check("each frame has a range of its own", passed);
+
+        // frame 0 comes around again once its fence signaled
+        allocator.beginFrame(0);
+        passed &= check("range reset when its frame begins again", allocator.used() == 0 && allocator.allocate(16) == 0);
+        passed &= check("peak kept across resets", allocator.getStatistics().peak == 64);
+        return passed;
+    }
+
+    bool test_push()
+    {
+        struct Data
+        {
+            float    values[4];
+            uint32_t index;
+        };
+
+        FrameLinearAllocator allocator;
+        allocator.initialize(nullptr, 4096, 2, 16);
+        allocator.beginFrame(1);
+
+        const Data   first {{1.0f, 2.0f, 3.0f, 4.0f}, 7};
+        const Data   second {{5.0f, 6.0f, 7.0f, 8.0f}, 9};
+        const size_t first_offset  = allocator.push(first);
+        const size_t second_offset = allocator.push(second);
+
+        const Data* read_first  = static_cast<const Data*>(allocator.data(first_offset));
+        const Data* read_second = static_cast<const Data*>(allocator.data(second_offset));
+
+        bool passed = true;
+        passed &= check("pushed data readable at its offset", read_first->index == 7 && read_first->values[2] == 3.0f && read_second->index == 9 && read_second->values[3] == 8.0f);
+        passed &= check("pushed into the current frame", first_offset >= 4096 && second_offset == first_offset + 32);
+        return passed;
+    }
+
+    bool test_external_memory()
+    {
+        // as a mapped buffer would be
+        std::vector<uint8_t> block(2 * 256, 0);
+
+        FrameLinearAllocator allocator;
+        allocator.initialize(block.data(), 256, 2, 64);
+        allocator.beginFrame(1);
+
+        const uint32_t value  = 0xdeadbeef;
+        const size_t   offset = allocator.push(value);
+
+        return check("writes go to the given memory", offset == 256 && *reinterpret_cast<uint32_t*>(block.data() + offset) == value);
+    }
+
+    // workers allocating at the same time never get overlapping ranges
+    bool test_threads()
+    {
+        const uint32_t thread_count = 4;
+        const uint32_t per_thread   = 2000;
+
+        FrameLinearAllocator allocator;
+        allocator.initialize(nullptr, thread_count * per_thread * 64, 2, 64);
+        allocator.beginFrame(0);
+
+        std::vector<std::vector<size_t>> offsets(thread_count);
+        std::vector<std::thread>         threads;
+        for (uint32_t t = 0; t < thread_count; ++t)
+        {
+            threads.emplace_back([&allocator, &offsets, t, per_thread]() {
+                for (uint32_t i = 0; i < per_thread; ++i)
+                {
+                    offsets[t].push_back(allocator.push(t * per_thread + i));
+                }
+            });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        std::vector<size_t> all;
+        bool                contents = true;
+        for (uint32_t t = 0; t < thread_count; ++t)
+        {
+            for (uint32_t i = 0; i < per_thread; ++i)
+            {
+                contents &= *static_cast<const uint32_t*>(allocator.data(offsets[t][i])) == t * per_thread + i;
+                all.push_back(offsets[t][i]);
+            }
+        }
+        std::sort(all.begin(), all.end());
+
+        bool passed = true;
+        passed &= check("concurrent allocations disjoint", std::adjacent_find(all.begin(), all.end()) == all.end() && all.back() != FrameLinearAllocator::k_invalid_offset);
+        passed &= check("concurrent writes kept", contents);
+        passed &= check("frame filled exactly", allocator.used() == allocator.frameSize() && allocator.allocate(1) == FrameLinearAllocator::k_invalid_offset);
+        return passed;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    bool passed = true;
+    passed &= test_alignment();
+    passed &= test_frames();
+    passed &= test_push();
+    passed &= test_external_memory();
+    passed &= test_threads();
+
+    cout << (passed ? "all passed" : "some failed") << endl;
+    return passed ? 0 : 1;
+}
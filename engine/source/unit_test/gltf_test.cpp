@@ -1,7 +1,11 @@
+#include "runtime/core/thread/work_executor.h"
+#include "runtime/function/global/global_context.h"
 #include "runtime/platform/file_system/vfs.h"
 #include "runtime/resource/asset_manager/asset_manager.h"
 #include "runtime/resource/config_manager/config_manager.h"
+#include "runtime/resource/resource_manager/loader/gltf_loader.h"
 
+#include <chrono>
 #include <filesystem>
 #include <iostream>
 #include <memory>
@@ -89,6 +93,10 @@ int main(int argc, char** argv)
 
     std::shared_ptr<AssetManager> asset_manager = std::make_shared<AssetManager>();
 
+    g_runtime_global_context.m_work_executor  = std::make_shared<WorkExecutor>();
+    g_runtime_global_context.m_config_manager = config_manager;
+    g_runtime_global_context.m_asset_manager  = asset_manager;
+
     VFSConfig config;
     asset_manager->loadAsset<VFSConfig>("config/config.vfs.json", config);
     std::shared_ptr<VFS> vfs = std::make_shared<VFS>();
@@ -102,8 +110,40 @@ int main(int argc, char** argv)
     std::string content;
     asset_manager->readTextFile(file_path, content);
 
-    tinygltf::Model model;
-    loadModelFromString(model, content, base_path);
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+
+        tinygltf::Model model;
+        loadModelFromString(model, content, base_path);
+
+        auto end = std::chrono::high_resolution_clock::now();
+        cout << "tinygltf: " << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << " ms" << endl;
+    }
+
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+
+        glTFLoader loader(g_runtime_global_context.m_work_executor);
+        auto [mesh, size] = loader.createResource(file_path);
+
+        auto end = std::chrono::high_resolution_clock::now();
+        cout << "glTFLoader: " << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << " ms";
+        if (mesh)
+        {
+            cout << ", vertices: " << mesh->vertex_buffer.size() << ", indices: " << mesh->index_buffer.size();
+        }
+        cout << endl;
+
+        for (const auto& image : loader.getModelImages(file_path))
+        {
+            auto texture = loader.getImage(image).get();
+            cout << "image: " << image << (texture ? " loaded" : " failed") << endl;
+        }
+    }
+
+    g_runtime_global_context.m_asset_manager.reset();
+    g_runtime_global_context.m_config_manager.reset();
+    g_runtime_global_context.m_work_executor.reset();
 
     return 0;
 }
@@ -0,0 +1,173 @@
+#include "runtime/core/thread/work_executor.h"
+#include "runtime/resource/config_manager/config_manager.h"
+#include "runtime/resource/resource_manager/compiler/bc_codec.h"
+#include "runtime/resource/resource_manager/loader/image/image_decoder.h"
+
+#include "unit_test/test_utils.h"
+
+#include <stb_image.h>
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ArchViz;
+using namespace std;
+
+namespace
+{
+    constexpr double k_min_jpeg_psnr = 40.0; // idct rounding and upsampling may differ slightly from stb_image
+
+    struct CorpusTotals
+    {
+        double megapixels {0.0};
+        double megabytes {0.0};
+        double stb_ms {0.0};
+        double native_ms {0.0};
+        double parallel_ms {0.0};
+        double probe_ms {0.0};
+    };
+
+    bool read_file(const std::filesystem::path& path, std::vector<uint8_t>& content)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            return false;
+        }
+        content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    bool test_image(const std::filesystem::path& path, std::shared_ptr<WorkExecutor> executor, CorpusTotals& totals)
+    {
+        const std::string name = path.filename().generic_string();
+
+        std::vector<uint8_t> file;
+        if (!check(("read " + name).c_str(), read_file(path, file)))
+        {
+            return false;
+        }
+
+        ImageInfo info;
+        double    probe_ms = best_ms([&]() { ImageDecoder::probe(file.data(), file.size(), info); });
+        if (!check(("probe " + name).c_str(), ImageDecoder::probe(file.data(), file.size(), info)))
+        {
+            return false;
+        }
+
+        int                  width, height, channels;
+        std::vector<uint8_t> reference;
+        double               stb_ms = best_ms([&]() {
+            stbi_uc* pixels = stbi_load_from_memory(file.data(), static_cast<int>(file.size()), &width, &height, &channels, STBI_rgb_alpha);
+            if (pixels != nullptr)
+            {
+                reference.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+                stbi_image_free(pixels);
+            }
+        });
+
+        std::vector<uint8_t> serial(ImageDecoder::decodedSize(info));
+        std::vector<uint8_t> parallel(ImageDecoder::decodedSize(info));
+        bool                 decoded     = true;
+        double               native_ms   = best_ms([&]() { decoded &= ImageDecoder::decode(file.data(), file.size(), serial.data(), serial.size(), nullptr); });
+        double               parallel_ms = best_ms([&]() { decoded &= ImageDecoder::decode(file.data(), file.size(), parallel.data(), parallel.size(), executor); });
+
+        bool passed = decoded && reference.size() == serial.size() && static_cast<uint32_t>(width) == info.width && static_cast<uint32_t>(height) == info.height &&
+                      static_cast<uint32_t>(channels) == info.channels && serial == parallel;
+
+        // png is lossless and must match bit for bit, jpeg is compared by psnr over rgb
+        double psnr = 0.0;
+        if (passed)
+        {
+            if (info.format == ImageFileFormat::JPEG)
+            {
+                psnr = BCCodec::computePSNR(serial.data(), reference.data(), serial.size() / 4, 3);
+                passed &= psnr >= k_min_jpeg_psnr;
+            }
+            else
+            {
+                passed &= serial == reference;
+            }
+        }
+
+        const double megapixels = static_cast<double>(info.width) * info.height / 1e6;
+        totals.megapixels += megapixels;
+        totals.megabytes += static_cast<double>(file.size()) / 1e6;
+        totals.stb_ms += stb_ms;
+        totals.native_ms += native_ms;
+        totals.parallel_ms += parallel_ms;
+        totals.probe_ms += probe_ms;
+
+        check((name + " matches stb_image").c_str(), passed);
+
+        cout << "  " << info.width << "x" << info.height << "x" << info.channels << (info.native ? "" : " (stb fallback)") << fixed << setprecision(1) << " stb "
+             << megapixels / stb_ms * 1000.0 << " MP/s, native " << megapixels / native_ms * 1000.0 << " MP/s, parallel " << megapixels / parallel_ms * 1000.0 << " MP/s";
+        if (info.format == ImageFileFormat::JPEG)
+        {
+            cout << ", psnr " << psnr << " dB";
+        }
+        cout << ", probe " << setprecision(3) << probe_ms * 1000.0 << " us" << endl;
+        return passed;
+    }
+
+    bool is_image(const std::filesystem::path& path)
+    {
+        std::string extension = path.extension().generic_string();
+        for (auto& c : extension)
+        {
+            c = static_cast<char>(std::tolower(c));
+        }
+        return extension == ".png" || extension == ".jpg" || extension == ".jpeg";
+    }
+} // namespace
+
+// decodes every png / jpeg under a directory with stb_image and ImageDecoder, e.g. a folder of 4k textures
+int main(int argc, char** argv)
+{
+    std::filesystem::path executable_path(argv[0]);
+    std::filesystem::path config_file_path = executable_path.parent_path() / "../ArchVizEditor.ini";
+
+    std::shared_ptr<ConfigManager> config_manager = std::make_shared<ConfigManager>();
+    config_manager->initialize(config_file_path.generic_string());
+
+    auto corpus = argc > 1 ? std::filesystem::path(argv[1]) : config_manager->getRootFolder() / "asset-test";
+    cout << "corpus: " << corpus << endl;
+
+    std::vector<std::filesystem::path> images;
+    std::error_code                    error;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(corpus, error))
+    {
+        if (entry.is_regular_file() && is_image(entry.path()))
+        {
+            images.push_back(entry.path());
+        }
+    }
+    std::sort(images.begin(), images.end());
+
+    std::shared_ptr<WorkExecutor> executor = std::make_shared<WorkExecutor>();
+
+    bool         passed = check("corpus has images", !images.empty());
+    CorpusTotals totals;
+    for (const auto& image : images)
+    {
+        passed &= test_image(image, executor, totals);
+    }
+
+    cout << fixed << setprecision(1) << images.size() << " images, " << totals.megapixels << " MP, " << totals.megabytes << " MB" << endl;
+    cout << "  stb_image: " << totals.megapixels / totals.stb_ms * 1000.0 << " MP/s, " << totals.megabytes / totals.stb_ms * 1000.0 << " MB/s" << endl;
+    cout << "  native (1 thread): " << totals.megapixels / totals.native_ms * 1000.0 << " MP/s, " << totals.megabytes / totals.native_ms * 1000.0 << " MB/s" << endl;
+    cout << "  native (" << std::thread::hardware_concurrency() << " threads): " << totals.megapixels / totals.parallel_ms * 1000.0 << " MP/s, "
+         << totals.megabytes / totals.parallel_ms * 1000.0 << " MB/s" << endl;
+    cout << "  probe: " << setprecision(3) << totals.probe_ms * 1000.0 / std::max<size_t>(images.size(), 1) << " us per image" << endl;
+
+    cout << (passed ? "all passed" : "some failed") << endl;
+    return passed ? 0 : 1;
+}
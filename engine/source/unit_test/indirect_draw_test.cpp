@@ -0,0 +1,315 @@
+#include "runtime/function/render/queue/indirect_command_builder.h"
+#include "runtime/function/render/queue/render_queue.h"
+#include "runtime/function/render/rhi/mesh_arena.h"
+
+#include "runtime/core/thread/work_executor.h"
+
+#include "unit_test/test_utils.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace ArchViz;
+using namespace std;
+
+namespace
+{
+    bool test_arena_allocate()
+    {
+        MeshArena arena;
+        arena.initialize(1000, 3000, 2);
+
+        bool passed = true;
+        passed &= check("first mesh at the start", arena.allocate(0, 100, 300) && arena.getRange(0).vertex_offset == 0 && arena.getRange(0).first_index == 0);
+        passed &= check("next mesh after it", arena.allocate(5, 200, 600) && arena.getRange(5).vertex_offset == 100 && arena.getRange(5).first_index == 300);
+        passed &= check("ids in between not resident", !arena.isResident(1) && !arena.isResident(4) && !arena.isResident(6));
+        passed &= check("too many vertices refused", !arena.allocate(1, 800, 10) && !arena.isResident(1));
+        passed &= check("too many indices refused", !arena.allocate(1, 10, 2500) && !arena.isResident(1));
+        passed &= check("refused leaves nothing behind", arena.usedVertices() == 300 && arena.usedIndices() == 900 && arena.getStatistics().refused == 2);
+        return passed;
+    }
+
+    // a freed range waits for the frames in flight, then merges with its free neighbours
+    bool test_arena_free()
+    {
+        MeshArena arena;
+        arena.initialize(300, 300, 2);
+        arena.allocate(0, 100, 100);
+        arena.allocate(1, 100, 100);
+        arena.allocate(2, 100, 100);
+
+        arena.free(1);
+
+        bool passed = true;
+        passed &= check("freed mesh not resident", !arena.isResident(1));
+        passed &= check("range not reused while in flight", !arena.allocate(3, 100, 100));
+
+        arena.advance();
+        passed &= check("still in flight a frame later", !arena.allocate(3, 100, 100));
+
+        arena.advance();
+        passed &= check("reused after the latency", arena.allocate(3, 100, 100) && arena.getRange(3).vertex_offset == 100);
+
+        // 0 and 2 around the hole of 3, freed together the whole arena is one block again
+        arena.free(0);
+        arena.free(3);
+        arena.free(2);
+        arena.advance();
+        arena.advance();
+        passed &= check("neighbours merged", arena.vertexBlocks() == 1 && arena.indexBlocks() == 1 && arena.usedVertices() == 0);
+        passed &= check("whole arena usable again", arena.allocate(4, 300, 300));
+        return passed;
+    }
+
+    // fragmentation under churn, meshes of random sizes loaded and unloaded for many frames
+    bool test_arena_churn()
+    {
+        MeshArena arena;
+        arena.initialize(1 << 20, 1 << 22, 2);
+
+        std::mt19937                            rng(11);
+        std::uniform_int_distribution<uint32_t> size_dist(64, 16 * 1024);
+        std::vector<uint32_t>                   resident;
+
+        uint32_t next_mesh = 0;
+        for (uint32_t frame = 0; frame < 2000; ++frame)
+        {
+            if (!resident.empty() && rng() % 2 == 0)
+            {
+                const uint32_t pick = rng() % resident.size();
+                arena.free(resident[pick]);
+                resident[pick] = resident.back();
+                resident.pop_back();
+            }
+            const uint32_t vertices = size_dist(rng);
+            if (arena.allocate(next_mesh, vertices, vertices * 3))
+            {
+                resident.push_back(next_mesh);
+            }
+            next_mesh += 1;
+            arena.advance();
+        }
+
+        // no two resident meshes overlap
+        std::vector<std::pair<uint32_t, uint32_t>> spans;
+        for (uint32_t mesh : resident)
+        {
+            spans.push_back({arena.getRange(mesh).vertex_offset, arena.getRange(mesh).vertex_count});
+        }
+        std::sort(spans.begin(), spans.end());
+        bool disjoint = true;
+        for (size_t i = 1; i < spans.size(); ++i)
+        {
+            disjoint &= spans[i - 1].first + spans[i - 1].second <= spans[i].first;
+        }
+
+        cout << "churn: " << resident.size() << " meshes resident, " << arena.usedVertices() << " of " << arena.vertexCapacity() << " vertices used, " << arena.vertexBlocks()
+             << " free blocks, " << arena.getStatistics().refused << " refused" << endl;
+
+        bool passed = true;
+        passed &= check("resident ranges disjoint", disjoint);
+        passed &= check("ranges inside the arena", spans.empty() || spans.back().first + spans.back().second <= arena.vertexCapacity());
+        return passed;
+    }
+
+    bool test_commands()
+    {
+        MeshArena arena;
+        arena.initialize(1000, 3000, 2);
+        arena.allocate(0, 100, 300);
+        arena.allocate(1, 50, 120);
+
+        std::vector<DrawBatch> batches = {
+            {SortKey::make(0, 0, 0, 0.1f), 0, 0, 0, 4},
+            {SortKey::make(0, 0, 1, 0.2f), 1, 1, 4, 2},
+            {SortKey::make(0, 1, 0, 0.3f), 0, 0, 6, 1},
+            {SortKey::make(0, 1, 2, 0.4f), 7, 2, 7, 3}, // mesh 7 was never loaded
+            {SortKey::make(1, 1, 0, 0.5f), 1, 0, 10, 5},
+        };
+
+        IndirectCommandBuilder builder;
+        builder.build(batches, arena);
+
+        const std::vector<DrawIndexedCommand>& commands = builder.getCommands();
+        const std::vector<DrawBucket>&         buckets  = builder.getBuckets();
+
+        bool passed = true;
+        passed &= check("one command per resident batch", commands.size() == 4 && builder.getStatistics().missing == 1);
+        passed &= check("offsets from the arena", commands[1].first_index == 300 && commands[1].vertex_offset == 100 && commands[1].index_count == 120);
+        passed &= check("instances from the batch", commands[0].instance_count == 4 && commands[3].first_instance == 10 && commands[3].instance_count == 5);
+        passed &= check("a bucket per pass and pipeline", buckets.size() == 3);
+        passed &= check("buckets cover the commands in order",
+                        buckets[0].first_command == 0 && buckets[0].command_count == 2 && buckets[1].first_command == 2 && buckets[1].command_count == 1 && buckets[2].first_command == 3 &&
+                            buckets[2].pass == 1 && buckets[2].pipeline == 1);
+        return passed;
+    }
+
+    // the batches of a mesh drawn elsewhere are left out, the buckets close over the gap
+    bool test_excluded_mesh()
+    {
+        MeshArena arena;
+        arena.initialize(1000, 3000, 2);
+        arena.allocate(0, 100, 300);
+        arena.allocate(1, 50, 120);
+
+        std::vector<DrawBatch> batches = {
+            {SortKey::make(0, 0, 0, 0.1f), 0, 0, 0, 4},
+            {SortKey::make(0, 0, 1, 0.2f), 1, 1, 4, 2},
+            {SortKey::make(0, 1, 0, 0.3f), 0, 0, 6, 1},
+            {SortKey::make(0, 1, 1, 0.4f), 1, 1, 7, 3},
+        };
+
+        IndirectCommandBuilder builder;
+        builder.m_excluded_mesh = 0;
+        builder.build(batches, arena);
+
+        const std::vector<DrawIndexedCommand>& commands = builder.getCommands();
+        const std::vector<DrawBucket>&         buckets  = builder.getBuckets();
+
+        bool passed = true;
+        passed &= check("excluded batches counted", commands.size() == 2 && builder.getStatistics().excluded == 2 && builder.getStatistics().missing == 0);
+        passed &= check("only the other mesh drawn", commands[0].vertex_offset == 100 && commands[1].vertex_offset == 100 && commands[1].first_instance == 7);
+        passed &= check("buckets over what is left", buckets.size() == 2 && buckets[1].first_command == 1 && buckets[1].command_count == 1);
+        return passed;
+    }
+
+    // the render queue of a large scene through the builder, inline and on the executor
+    bool test_queue_commands(std::shared_ptr<WorkExecutor> executor)
+    {
+        MeshArena arena;
+        arena.initialize(1 << 22, 1 << 24, 2);
+        for (uint32_t mesh = 0; mesh < 1024; ++mesh)
+        {
+            arena.allocate(mesh, 1000 + mesh, 3000 + mesh * 3);
+        }
+
+        std::mt19937                            rng(13);
+        std::uniform_int_distribution<uint32_t> mesh_dist(0, 1023);
+        std::uniform_real_distribution<float>   depth_dist(0.0f, 1.0f);
+
+        RenderQueue queue;
+        queue.m_executor     = executor;
+        queue.m_thread_count = 4;
+        queue.initialize();
+        for (uint32_t i = 0; i < 100000; ++i)
+        {
+            DrawPacket packet;
+            packet.mesh     = mesh_dist(rng);
+            packet.material = packet.mesh % 64;
+            packet.key      = SortKey::make(i % 2, packet.material % 8, packet.material, depth_dist(rng));
+            queue.submit(packet, DrawInstance {FMatrix4::Identity(), i});
+        }
+        queue.build();
+
+        IndirectCommandBuilder inline_builder;
+        inline_builder.build(queue.getBatches(), arena);
+
+        IndirectCommandBuilder builder;
+        builder.m_executor     = executor;
+        builder.m_thread_count = 4;
+        builder.build(queue.getBatches(), arena);
+
+        bool     same      = builder.getCommands().size() == inline_builder.getCommands().size();
+        uint32_t instances = 0;
+        for (size_t i = 0; same && i < builder.getCommands().size(); ++i)
+        {
+            const DrawIndexedCommand& a = builder.getCommands()[i];
+            const DrawIndexedCommand& b = inline_builder.getCommands()[i];
+            same &= a.index_count == b.index_count && a.instance_count == b.instance_count && a.first_index == b.first_index && a.vertex_offset == b.vertex_offset &&
+                    a.first_instance == b.first_instance;
+            instances += a.instance_count;
+        }
+
+        bool     covered = true;
+        uint32_t next    = 0;
+        for (const DrawBucket& bucket : builder.getBuckets())
+        {
+            covered &= bucket.first_command == next;
+            next += bucket.command_count;
+        }
+
+        bool passed = true;
+        passed &= check("executor writes the same commands", same);
+        passed &= check("every instance drawn", instances == queue.size());
+        passed &= check("buckets contiguous", covered && next == builder.getCommands().size());
+        passed &= check("16 buckets for 2 passes of 8 pipelines", builder.getBuckets().size() == 16);
+        return passed;
+    }
+
+    // what a frame costs on the cpu before any vulkan call, and how many draw calls each path records
+    void benchmark_build(uint32_t count, std::shared_ptr<WorkExecutor> executor, uint32_t threads)
+    {
+        const uint32_t frames = 8;
+
+        MeshArena arena;
+        arena.initialize(1 << 22, 1 << 24, 2);
+        for (uint32_t mesh = 0; mesh < 4096; ++mesh)
+        {
+            arena.allocate(mesh, 500, 1500);
+        }
+
+        std::mt19937                            rng(17);
+        std::uniform_int_distribution<uint32_t> mesh_dist(0, 4095);
+        std::uniform_int_distribution<uint32_t> pass_dist(0, 3);
+        std::uniform_real_distribution<float>   depth_dist(0.0f, 1.0f);
+
+        std::vector<DrawPacket>   packets(count);
+        std::vector<DrawInstance> instances(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            packets[i].mesh        = mesh_dist(rng);
+            packets[i].material    = (packets[i].mesh * 7) % 512;
+            packets[i].key         = SortKey::make(pass_dist(rng), packets[i].material % 16, packets[i].material, depth_dist(rng));
+            instances[i].object_id = i;
+        }
+
+        RenderQueue queue;
+        queue.m_executor     = executor;
+        queue.m_thread_count = threads;
+        queue.initialize();
+
+        IndirectCommandBuilder builder;
+        builder.m_executor     = executor;
+        builder.m_thread_count = threads;
+
+        float queue_ms   = 0.0f;
+        float command_ms = 0.0f;
+        for (uint32_t frame = 0; frame < frames; ++frame)
+        {
+            queue.reset();
+            queue.submit(packets.data(), instances.data(), count);
+            queue.build();
+            builder.build(queue.getBatches(), arena);
+
+            queue_ms += queue.getStatistics().sort_ms + queue.getStatistics().batch_ms;
+            command_ms += builder.getStatistics().build_ms;
+        }
+
+        cout << "indirect " << count << " packets on " << threads << " threads: queue " << queue_ms / frames << " ms, commands " << command_ms / frames << " ms per frame, draw calls "
+             << count << " per packet, " << queue.getBatches().size() << " per batch, " << builder.getBuckets().size() << " indirect" << endl;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const uint32_t                threads  = std::max(2u, std::thread::hardware_concurrency());
+    std::shared_ptr<WorkExecutor> executor = std::make_shared<WorkExecutor>(threads);
+
+    bool passed = true;
+    passed &= test_arena_allocate();
+    passed &= test_arena_free();
+    passed &= test_arena_churn();
+    passed &= test_commands();
+    passed &= test_excluded_mesh();
+    passed &= test_queue_commands(nullptr);
+    passed &= test_queue_commands(executor);
+
+    benchmark_threads({100000u, 1000000u}, executor, threads, benchmark_build);
+
+    cout << (passed ? "all passed" : "some failed") << endl;
+    return passed ? 0 : 1;
+}
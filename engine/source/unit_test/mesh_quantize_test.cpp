@@ -0,0 +1,138 @@
+#include "runtime/core/math/pack.h"
+#include "runtime/resource/resource_manager/compiler/mesh_quantizer.h"
+
+#include "unit_test/test_utils.h"
+
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+
+using namespace ArchViz;
+using namespace std;
+
+namespace
+{
+    Vector3 random_unit(std::mt19937& rng)
+    {
+        std::normal_distribution<float> dist(0.0f, 1.0f);
+
+        Vector3 v(dist(rng), dist(rng), dist(rng));
+        float   length = std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+        return v / length;
+    }
+
+    std::shared_ptr<MeshData> random_mesh(size_t vertex_count, float uv_range, std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> position_dist(-50.0f, 50.0f);
+        std::uniform_real_distribution<float> uv_dist(0.0f, uv_range);
+        std::uniform_int_distribution<int>    index_dist(0, static_cast<int>(vertex_count) - 1);
+
+        std::shared_ptr<MeshData> mesh = std::make_shared<MeshData>();
+        mesh->vertex_buffer.resize(vertex_count);
+        for (auto& vertex : mesh->vertex_buffer)
+        {
+            vertex.postion = Vector3(position_dist(rng), position_dist(rng), position_dist(rng) * 0.01f);
+            vertex.normal  = random_unit(rng);
+            vertex.tangent = random_unit(rng);
+            vertex.uv      = Vector2(uv_dist(rng), uv_dist(rng));
+        }
+        mesh->index_buffer.resize(vertex_count * 3);
+        for (auto& index : mesh->index_buffer)
+        {
+            index = index_dist(rng);
+        }
+        return mesh;
+    }
+
+    bool test_mesh(const char* name, const MeshData& mesh, MeshIndexType expected_index_type)
+    {
+        cout << name << ":" << endl;
+
+        MeshQuantizer                    quantizer;
+        std::shared_ptr<CompactMeshData> compact = quantizer.compileResource(std::make_shared<MeshData>(mesh)).first;
+        MeshQuantizeError                error   = MeshQuantizer::measureError(mesh, *compact);
+
+        Vector3 extent         = compact->aabb_max - compact->aabb_min;
+        float   position_bound = MeshQuantizer::positionErrorBound(std::max({extent.x, extent.y, extent.z})) * 1.01f;
+
+        // half keeps 11 significant bits, relative to the largest uv
+        float uv_bound = 0.5f / 65535.0f * 1.01f;
+        if (compact->uv_format == MeshUVFormat::Half)
+        {
+            float uv_max = 0.0f;
+            for (const auto& vertex : mesh.vertex_buffer)
+            {
+                uv_max = std::max({uv_max, std::fabs(vertex.uv.x), std::fabs(vertex.uv.y)});
+            }
+            uv_bound = uv_max * std::ldexp(1.0f, -11);
+        }
+
+        size_t source_bytes = mesh.vertex_buffer.size() * sizeof(MeshVertex);
+        cout << "  vertex bytes: " << source_bytes << " -> " << compact->vertexBytes() << " (" << sizeof(MeshVertex) << " -> " << CompactMeshData::k_vertex_size << " per vertex)" << endl;
+        cout << "  error position: " << error.position << " (bound " << position_bound << ")" << endl;
+        cout << "  error normal: " << error.normal_degree << " deg, tangent: " << error.tangent_degree << " deg" << endl;
+        cout << "  error uv: " << error.uv << " (bound " << uv_bound << ")" << endl;
+
+        MeshData decoded;
+        MeshQuantizer::dequantize(*compact, decoded);
+
+        bool passed = true;
+        passed &= check("position error", error.position <= position_bound);
+        passed &= check("normal error", error.normal_degree <= MeshQuantizer::k_frame_error_bound_degree);
+        passed &= check("tangent error", error.tangent_degree <= MeshQuantizer::k_frame_error_bound_degree);
+        passed &= check("uv error", error.uv <= uv_bound);
+        passed &= check("index type", compact->index_type == expected_index_type);
+        passed &= check("indices", decoded.index_buffer == mesh.index_buffer);
+        return passed;
+    }
+
+    bool test_half()
+    {
+        bool passed = true;
+
+        passed &= check("half zero", half_to_float(float_to_half(0.0f)) == 0.0f);
+        passed &= check("half one", half_to_float(float_to_half(1.0f)) == 1.0f);
+        passed &= check("half overflow", std::isinf(half_to_float(float_to_half(70000.0f))));
+        passed &= check("half subnormal", half_to_float(float_to_half(std::ldexp(1.0f, -24))) == std::ldexp(1.0f, -24));
+
+        float max_relative = 0.0f;
+        for (float value = 1e-4f; value < 60000.0f; value *= 1.0007f)
+        {
+            max_relative = std::max(max_relative, std::fabs(half_to_float(float_to_half(value)) - value) / value);
+        }
+        passed &= check("half relative error", max_relative <= std::ldexp(1.0f, -11));
+        return passed;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::mt19937 rng(42);
+
+    bool passed = true;
+    passed &= test_half();
+
+    // small mesh with uvs in [0, 1]: unorm16 uv, 16 bit index
+    passed &= test_mesh("unit uv mesh", *random_mesh(4096, 1.0f, rng), MeshIndexType::Uint16);
+
+    // tiled uvs fall back to half, more than 65536 vertices need 32 bit index
+    passed &= test_mesh("tiled uv mesh", *random_mesh(100000, 8.0f, rng), MeshIndexType::Uint32);
+
+    // degenerate aabb and missing tangents
+    {
+        MeshData flat;
+        flat.vertex_buffer.resize(3);
+        flat.vertex_buffer[1].postion = Vector3(1.0f, 0.0f, 0.0f);
+        flat.vertex_buffer[2].postion = Vector3(0.0f, 1.0f, 0.0f);
+        for (auto& vertex : flat.vertex_buffer)
+        {
+            vertex.normal = Vector3(0.0f, 0.0f, -1.0f);
+        }
+        flat.index_buffer = {0, 1, 2};
+        passed &= test_mesh("flat mesh", flat, MeshIndexType::Uint16);
+    }
+
+    cout << (passed ? "all passed" : "some failed") << endl;
+    return passed ? 0 : 1;
+}
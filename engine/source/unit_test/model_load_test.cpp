@@ -1,10 +1,20 @@
+#include "runtime/core/math/math.h"
+#include "runtime/core/thread/work_executor.h"
+#include "runtime/function/render/geometry/meshlet_culling.h"
 #include "runtime/platform/file_system/vfs.h"
 #include "runtime/resource/asset_manager/asset_manager.h"
 #include "runtime/resource/config_manager/config_manager.h"
+#include "runtime/resource/resource_manager/compiler/mesh_optimizer.h"
+#include "runtime/resource/resource_manager/loader/obj_parser.h"
 
+#include "unit_test/test_utils.h"
+
+#include <cstring>
 #include <filesystem>
 #include <iostream>
+#include <limits>
 #include <memory>
+#include <string>
 
 #define TINYOBJLOADER_IMPLEMENTATION
 #include <tiny_obj_loader.h>
@@ -12,8 +22,139 @@
 using namespace ArchViz;
 using namespace std;
 
+namespace
+{
+    // two quads sharing an edge, the second one written with relative indices
+    const char* k_quads_obj = R"(# fixture
+v 0 0 0
+v 1 0 0
+v 1 1 0
+v 0 1 0
+v 2 0 0
+v 2 1 0
+vt 0 0
+vt 1 0
+vt 1 1
+vt 0 1
+vn 0 0 1
+f 1/1/1 2/2/1 3/3/1 4/4/1
+f -5/-3/-1 -2/-3/-1 -1/-2/-1 -4/-2/-1
+)";
+
+    bool test_parse_fixture()
+    {
+        ObjParseResult result;
+        const bool     parsed = ObjParser::parse(k_quads_obj, std::strlen(k_quads_obj), result);
+
+        const std::vector<uint32_t> indices = {0, 1, 2, 0, 2, 3, 1, 4, 5, 1, 5, 2};
+
+        bool passed = true;
+        passed &= check("fixture parsed", parsed);
+        passed &= check("attribute counts", result.positions.size() == 18 && result.texcoords.size() == 8 && result.normals.size() == 3);
+        passed &= check("shared corners deduplicated", result.vertices.size() == 6);
+        passed &= check("quads fan triangulated", result.indices == indices);
+        if (!passed || result.vertices.size() != 6)
+        {
+            return false;
+        }
+
+        // the first new corner of the second quad is position 5 with uv 2, both written relative
+        const ObjIndex& corner = result.vertices[4];
+        passed &= check("relative indices resolved", corner.position == 4 && corner.texcoord == 1 && corner.normal == 0);
+        passed &= check("position read", result.positions[3 * corner.position] == 2.0f && result.positions[3 * corner.position + 1] == 0.0f);
+        passed &= check("uv read", result.texcoords[2 * corner.texcoord] == 1.0f && result.texcoords[2 * corner.texcoord + 1] == 0.0f);
+        return passed;
+    }
+
+    // a grid large enough to be split into several chunks, parsed inline and on the executor
+    bool test_parse_chunks(std::shared_ptr<WorkExecutor> executor)
+    {
+        const uint32_t size = 256;
+
+        std::string obj;
+        for (uint32_t y = 0; y <= size; ++y)
+        {
+            for (uint32_t x = 0; x <= size; ++x)
+            {
+                obj += "v " + std::to_string(x) + ".25 " + std::to_string(y) + ".5 -1.0\n";
+            }
+        }
+        for (uint32_t y = 0; y < size; ++y)
+        {
+            for (uint32_t x = 0; x < size; ++x)
+            {
+                const uint32_t corner = y * (size + 1) + x + 1;
+                obj += "f " + std::to_string(corner) + " " + std::to_string(corner + 1) + " " + std::to_string(corner + size + 2) + " " + std::to_string(corner + size + 1) + "\n";
+            }
+        }
+
+        ObjParseResult inline_result;
+        ObjParseResult result;
+        ObjParser::parse(obj.data(), obj.size(), inline_result);
+        ObjParser::parse(obj.data(), obj.size(), result, executor);
+
+        const uint32_t last = size * (size + 1) + size;
+
+        bool passed = true;
+        passed &= check("grid larger than one chunk", obj.size() > 2 * ObjParser::k_min_chunk_size);
+        passed &= check("every grid corner once", result.vertices.size() == (size + 1) * (size + 1) && result.indices.size() == size * size * 6);
+        passed &= check("executor parses the same mesh", result.vertices == inline_result.vertices && result.indices == inline_result.indices && result.positions == inline_result.positions);
+        passed &= check("last position read", result.positions.size() > 3 * last + 2 && result.positions[3 * last] == size + 0.25f && result.positions[3 * last + 1] == size + 0.5f);
+        return passed;
+    }
+
+    MeshletData make_meshlet(const Vector3& center, const Vector3& cone_axis)
+    {
+        MeshletData meshlet;
+        meshlet.triangle_count = 8;
+        meshlet.center         = center;
+        meshlet.radius         = 1.0f;
+        meshlet.cone_apex      = center + cone_axis;
+        meshlet.cone_axis      = cone_axis;
+        meshlet.cone_cutoff    = 0.5f;
+        return meshlet;
+    }
+
+    // camera at the origin looking down -z
+    bool test_cull_meshlets()
+    {
+        CookedMeshData mesh;
+        mesh.meshlets.push_back(make_meshlet(Vector3(0.0f, 0.0f, -10.0f), Vector3(0.0f, 0.0f, 1.0f)));
+        mesh.meshlets.push_back(make_meshlet(Vector3(0.0f, 0.0f, 10.0f), Vector3(0.0f, 0.0f, 1.0f)));
+        mesh.meshlets.push_back(make_meshlet(Vector3(2.0f, 0.0f, -10.0f), Vector3(0.0f, 0.0f, -1.0f)));
+
+        const FVector3 eye = FVector3::Zero();
+
+        Frustum frustum;
+        frustum.update(Math::perspective(45.0f, 16.0f / 9.0f, 0.1f, 100.0f) * Math::lookAt(eye, -FVector3::UnitZ(), FVector3::UnitY()));
+
+        std::vector<uint32_t> visible;
+        MeshletCullStatistics stats = cull_meshlets(mesh, FMatrix4::Identity(), frustum, eye, &visible);
+
+        bool passed = true;
+        passed &= check("meshlet in the frustum kept", visible == std::vector<uint32_t> {0});
+        passed &= check("meshlet behind the camera frustum culled", stats.frustum_culled_count == 1);
+        passed &= check("back facing meshlet cone culled", stats.cone_culled_count == 1);
+        passed &= check("visible triangles counted", stats.triangle_count == 24 && stats.visible_triangle_count == 8);
+
+        // a mirrored model flips the cones, only the frustum test applies
+        FMatrix4 mirror = FMatrix4::Identity();
+        mirror(0, 0)    = -1.0f;
+        stats           = cull_meshlets(mesh, mirror, frustum, eye, &visible);
+        passed &= check("mirrored model skips the cone test", visible == std::vector<uint32_t> {0, 2} && stats.cone_culled_count == 0);
+        return passed;
+    }
+} // namespace
+
 int main(int argc, char** argv)
 {
+    std::shared_ptr<WorkExecutor> executor = std::make_shared<WorkExecutor>();
+
+    bool passed = true;
+    passed &= test_parse_fixture();
+    passed &= test_parse_chunks(executor);
+    passed &= test_cull_meshlets();
+
     std::filesystem::path executable_path(argv[0]);
     std::filesystem::path config_file_path = executable_path.parent_path() / "../ArchVizEditor.ini";
     cout << config_file_path << endl;
@@ -21,15 +162,112 @@ int main(int argc, char** argv)
     std::shared_ptr<ConfigManager> config_manager = std::make_shared<ConfigManager>();
     config_manager->initialize(config_file_path.generic_string());
 
-    auto model_path = config_manager->getRootFolder() / "asset-test/data/model/basic/cube.obj";
+    // pass a large obj (e.g. a 1 GB scan) as first argument for benchmark
+    auto model_path = argc > 1 ? std::filesystem::path(argv[1]) : config_manager->getRootFolder() / "asset-test/data/model/basic/cube.obj";
+    cout << "model: " << model_path << endl;
+
+    {
+        tinyobj::ObjReaderConfig config;
+        tinyobj::ObjReader       reader;
+
+        size_t index_count = 0;
+        double ms          = elapsed_ms([&]() {
+            reader.ParseFromFile(model_path.generic_string(), config);
+            for (const auto& shape : reader.GetShapes())
+            {
+                index_count += shape.mesh.indices.size();
+            }
+        });
+        cout << "tinyobj: " << ms << " ms, positions: " << reader.GetAttrib().vertices.size() / 3 << ", indices: " << index_count << endl;
+    }
+
+    {
+        ObjParseResult result;
+        double         ms = elapsed_ms([&]() { ObjParser::parseFile(model_path.generic_string(), result); });
+        cout << "obj parser (1 thread): " << ms << " ms, positions: " << result.positions.size() / 3 << ", vertices: " << result.vertices.size() << ", indices: " << result.indices.size() << endl;
+    }
+
+    ObjParseResult result;
+    {
+        double ms = elapsed_ms([&]() { ObjParser::parseFile(model_path.generic_string(), result, executor); });
+        cout << "obj parser (" << std::thread::hardware_concurrency() << " threads): " << ms << " ms, positions: " << result.positions.size() / 3 << ", vertices: " << result.vertices.size()
+             << ", indices: " << result.indices.size() << endl;
+    }
+
+    // mesh optimization stage
+    {
+        std::shared_ptr<MeshData> mesh = std::make_shared<MeshData>();
+        mesh->vertex_buffer.resize(result.vertices.size());
+        for (size_t i = 0; i < result.vertices.size(); ++i)
+        {
+            const ObjIndex& index          = result.vertices[i];
+            mesh->vertex_buffer[i].postion = Vector3(&result.positions[3 * index.position]);
+            if (index.normal != ObjIndex::k_invalid_index)
+            {
+                mesh->vertex_buffer[i].normal = Vector3(&result.normals[3 * index.normal]);
+            }
+            if (index.texcoord != ObjIndex::k_invalid_index)
+            {
+                mesh->vertex_buffer[i].uv = Vector2(result.texcoords[2 * index.texcoord + 0], result.texcoords[2 * index.texcoord + 1]);
+            }
+        }
+        mesh->index_buffer.assign(result.indices.begin(), result.indices.end());
+
+        MeshOptimizer                                optimizer;
+        std::vector<MeshOptimizeStatistics>          statistics;
+        std::vector<std::shared_ptr<CookedMeshData>> cooked;
+
+        double ms = elapsed_ms([&]() { cooked = optimizer.compileResources({mesh}, executor, &statistics); });
+
+        const auto& stats = statistics[0];
+        cout << "mesh optimize: " << ms << " ms" << endl;
+        cout << "  acmr: " << stats.acmr_before << " -> " << stats.acmr_after << endl;
+        cout << "  atvr: " << stats.atvr_before << " -> " << stats.atvr_after << endl;
+        cout << "  overdraw: " << stats.overdraw_before << " -> " << stats.overdraw_after << endl;
+        cout << "  overfetch: " << stats.overfetch_before << " -> " << stats.overfetch_after << endl;
+        for (size_t i = 0; i < cooked[0]->lods.size(); ++i)
+        {
+            const auto& lod = cooked[0]->lods[i];
+            cout << "  lod " << i + 1 << ": indices " << lod.index_buffer.size() << ", error " << lod.error
+                 << ", screen error at 10m " << MeshOptimizer::computeScreenError(lod.error, 10.0f, 1.0f, 1080.0f) << " px" << endl;
+        }
+
+        // cpu meshlet culling from the six axis directions around the mesh
+        const auto& meshlets = cooked[0]->meshlets;
+        cout << "meshlets: " << meshlets.size() << endl;
+        if (!meshlets.empty())
+        {
+            FVector3 bound_min = FVector3::Constant(std::numeric_limits<float>::max());
+            FVector3 bound_max = FVector3::Constant(std::numeric_limits<float>::lowest());
+            for (const auto& meshlet : meshlets)
+            {
+                FVector3 center(meshlet.center.x, meshlet.center.y, meshlet.center.z);
+                bound_min = bound_min.cwiseMin(center - FVector3::Constant(meshlet.radius));
+                bound_max = bound_max.cwiseMax(center + FVector3::Constant(meshlet.radius));
+            }
+            FVector3 center   = (bound_min + bound_max) * 0.5f;
+            float    distance = (bound_max - bound_min).norm();
+
+            const FVector3 directions[6] = {FVector3::UnitX(), -FVector3::UnitX(), FVector3::UnitY(), -FVector3::UnitY(), FVector3::UnitZ(), -FVector3::UnitZ()};
 
-    tinyobj::ObjReaderConfig config;
-    tinyobj::ObjReader       reader;
+            MeshletCullStatistics total;
+            for (const auto& direction : directions)
+            {
+                FVector3 eye = center + direction * distance;
+                FVector3 up  = std::abs(direction.y()) > 0.5f ? FVector3::UnitZ() : FVector3::UnitY();
 
-    reader.ParseFromFile(model_path.generic_string());
+                Frustum frustum;
+                frustum.update(Math::perspective(45.0f, 16.0f / 9.0f, distance * 0.01f, distance * 4.0f) * Math::lookAt(eye, center, up));
 
-    auto& shapes    = reader.GetShapes();
-    auto& materials = reader.GetMaterials();
+                MeshletCullStatistics stats = cull_meshlets(*cooked[0], FMatrix4::Identity(), frustum, eye);
+                total += stats;
+                cout << "  view (" << direction.transpose() << "): visible meshlets " << stats.visible_meshlet_count << ", frustum culled " << stats.frustum_culled_count
+                     << ", cone culled " << stats.cone_culled_count << ", culled triangles " << stats.culledTriangleRatio() * 100.0f << "%" << endl;
+            }
+            cout << "  average culled triangles " << total.culledTriangleRatio() * 100.0f << "%" << endl;
+        }
+    }
 
-    return 0;
+    cout << (passed ? "all passed" : "some failed") << endl;
+    return passed ? 0 : 1;
 }
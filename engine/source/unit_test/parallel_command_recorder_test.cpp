@@ -0,0 +1,258 @@
+#include "runtime/function/render/rhi/parallel_command_recorder.h"
+
+#include "runtime/core/thread/work_executor.h"
+
+#include "unit_test/test_utils.h"
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using namespace ArchViz;
+using namespace std;
+
+namespace
+{
+    // stands in for a command buffer, the "commands" are the draw indices recorded into it
+    struct FakeBuffer
+    {
+        uint32_t frame {0};
+        uint32_t thread {0};
+        bool     open {false}; // between a pool reset and the first record
+
+        std::vector<uint32_t> draws;
+        uint32_t              state {0};
+    };
+
+    struct FakeDevice
+    {
+        std::vector<FakeBuffer> buffers;
+        uint32_t                resets {0};
+
+        std::atomic<uint32_t> misuse {0};
+        std::atomic<uint32_t> busy[16] {};
+    };
+
+    void connect(ParallelCommandRecorder<uint32_t>& recorder, FakeDevice& device, uint32_t frames, uint32_t threads, std::shared_ptr<WorkExecutor> executor)
+    {
+        auto allocate = [&device](uint32_t frame, uint32_t thread) {
+            FakeBuffer buffer;
+            buffer.frame  = frame;
+            buffer.thread = thread;
+            buffer.open   = true;
+            device.buffers.push_back(buffer);
+            return static_cast<uint32_t>(device.buffers.size() - 1);
+        };
+
+        auto reset = [&device](uint32_t frame, uint32_t thread) {
+            device.resets += 1;
+            for (auto& buffer : device.buffers)
+            {
+                if (buffer.frame == frame && buffer.thread == thread)
+                {
+                    buffer.open = true;
+                    buffer.draws.clear();
+                }
+            }
+        };
+
+        recorder.initialize(frames, threads, allocate, reset, executor);
+    }
+
+    // records the draws into the buffer, flags a buffer used twice without a reset, from another pool or by two tasks at once
+    ParallelCommandRecorder<uint32_t>::RecordFunc make_record(FakeDevice& device, uint32_t frame, uint32_t work = 0)
+    {
+        return [&device, frame, work](uint32_t index, uint32_t thread, uint32_t begin, uint32_t end) {
+            if (device.busy[thread].exchange(1) != 0)
+            {
+                device.misuse += 1;
+            }
+
+            FakeBuffer& buffer = device.buffers[index];
+            if (!buffer.open || buffer.thread != thread || buffer.frame != frame)
+            {
+                device.misuse += 1;
+            }
+            buffer.open = false;
+
+            for (uint32_t draw = begin; draw < end; ++draw)
+            {
+                // a few state changes worth of cpu per draw
+                uint32_t hash = draw;
+                for (uint32_t i = 0; i < work; ++i)
+                {
+                    hash = hash * 2654435761u + i;
+                }
+                buffer.draws.push_back(draw);
+                buffer.state ^= hash;
+            }
+
+            device.busy[thread] = 0;
+        };
+    }
+
+    // the draws of the buffers in the order they came back
+    bool in_order(const FakeDevice& device, const std::vector<uint32_t>& buffers, uint32_t draw_count)
+    {
+        uint32_t next = 0;
+        for (uint32_t index : buffers)
+        {
+            for (uint32_t draw : device.buffers[index].draws)
+            {
+                if (draw != next++)
+                {
+                    return false;
+                }
+            }
+        }
+        return next == draw_count;
+    }
+
+    bool test_chunks()
+    {
+        ParallelCommandRecorder<uint32_t> recorder;
+        FakeDevice                        device;
+        connect(recorder, device, 2, 8, nullptr);
+        recorder.m_min_chunk_draws = 64;
+
+        bool passed = true;
+        passed &= check("no draws no chunk", recorder.chunkCount(0) == 0);
+        passed &= check("a few draws stay on one thread", recorder.chunkCount(10) == 1 && recorder.chunkCount(64) == 1);
+        passed &= check("chunks of at least the minimum", recorder.chunkCount(65) == 2 && recorder.chunkCount(200) == 4);
+        passed &= check("never more chunks than threads", recorder.chunkCount(100000) == 8);
+
+        recorder.beginFrame(0);
+        passed &= check("no buffer for no draws", recorder.record(0, make_record(device, 0)).empty() && device.buffers.empty());
+        return passed;
+    }
+
+    bool test_order(std::shared_ptr<WorkExecutor> executor, const char* name)
+    {
+        cout << name << endl;
+
+        const uint32_t draw_count = 10000;
+
+        ParallelCommandRecorder<uint32_t> recorder;
+        FakeDevice                        device;
+        connect(recorder, device, 2, 8, executor);
+
+        recorder.beginFrame(0);
+        const std::vector<uint32_t> buffers = recorder.record(draw_count, make_record(device, 0));
+
+        const ParallelRecordStatistics& statistics = recorder.getStatistics();
+
+        uint32_t draws  = 0;
+        uint32_t chunks = 0;
+        for (const auto& thread : statistics.threads)
+        {
+            draws += thread.draws;
+            chunks += thread.chunks;
+        }
+
+        bool passed = true;
+        passed &= check("one buffer per thread", buffers.size() == 8);
+        passed &= check("draws come back in order", in_order(device, buffers, draw_count));
+        passed &= check("a pool is used by one task at a time", device.misuse == 0);
+        passed &= check("every draw counted once", draws == draw_count && chunks == 8 && statistics.records == 1);
+        return passed;
+    }
+
+    bool test_reuse(std::shared_ptr<WorkExecutor> executor)
+    {
+        const uint32_t frames  = 2;
+        const uint32_t threads = 4;
+
+        ParallelCommandRecorder<uint32_t> recorder;
+        FakeDevice                        device;
+        connect(recorder, device, frames, threads, executor);
+
+        // three passes a frame, each one gets its own buffers from the pools of the frame
+        bool     ordered   = true;
+        uint32_t allocated = 0;
+        for (uint32_t frame = 0; frame < 10; ++frame)
+        {
+            recorder.beginFrame(frame);
+            for (uint32_t pass = 0; pass < 3; ++pass)
+            {
+                const uint32_t              draw_count = 500 + pass * 700;
+                const std::vector<uint32_t> buffers    = recorder.record(draw_count, make_record(device, frame % frames));
+                ordered &= in_order(device, buffers, draw_count);
+            }
+
+            if (frame == frames - 1)
+            {
+                allocated = recorder.getStatistics().allocated;
+            }
+        }
+
+        bool passed = true;
+        passed &= check("every pass of a frame in order", ordered);
+        passed &= check("no buffer used before its pool was reset", device.misuse == 0);
+        passed &= check("buffers are reused after the first frames", recorder.getStatistics().allocated == allocated && allocated == device.buffers.size());
+        passed &= check("at most one buffer per pass, thread and frame", allocated <= frames * threads * 3);
+        passed &= check("the pools of a frame are reset when it comes around", device.resets == 8 * threads);
+        return passed;
+    }
+
+    // the same draw heavy frame on one thread and on the executor, cpu time per thread
+    bool test_draw_heavy(uint32_t thread_count, uint32_t draw_count)
+    {
+        cout << "draw heavy: " << draw_count << " draws" << endl;
+
+        auto run = [&](std::shared_ptr<WorkExecutor> executor, uint32_t threads, float& frame_ms, bool& ordered) {
+            ParallelCommandRecorder<uint32_t> recorder;
+            FakeDevice                        device;
+            connect(recorder, device, 2, threads, executor);
+
+            const uint32_t frames = 8;
+            ordered               = true;
+            for (uint32_t frame = 0; frame < frames; ++frame)
+            {
+                recorder.beginFrame(frame);
+                const std::vector<uint32_t> buffers = recorder.record(draw_count, make_record(device, frame % 2, 64));
+                ordered &= in_order(device, buffers, draw_count) && device.misuse == 0;
+            }
+
+            const ParallelRecordStatistics& statistics = recorder.getStatistics();
+            frame_ms                                   = statistics.wall_ms / frames;
+
+            cout << "    " << threads << " threads: " << frame_ms << " ms a frame" << endl;
+            for (uint32_t thread = 0; thread < statistics.threads.size(); ++thread)
+            {
+                const auto& stats = statistics.threads[thread];
+                cout << "        thread " << thread << ": " << stats.chunks << " chunks, " << stats.draws << " draws, " << stats.record_ms << " ms cpu" << endl;
+            }
+        };
+
+        float serial_ms      = 0.0f;
+        float parallel_ms    = 0.0f;
+        bool  serial_order   = false;
+        bool  parallel_order = false;
+        run(nullptr, 1, serial_ms, serial_order);
+        run(std::make_shared<WorkExecutor>(thread_count), thread_count, parallel_ms, parallel_order);
+
+        cout << "    speedup " << serial_ms / parallel_ms << "x" << endl;
+
+        bool passed = true;
+        passed &= check("draw heavy frame recorded in order", serial_order && parallel_order);
+        return passed;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    auto executor = std::make_shared<WorkExecutor>(4);
+
+    bool passed = true;
+    passed &= test_chunks();
+    passed &= test_order(nullptr, "inline recording");
+    passed &= test_order(executor, "recording on the executor");
+    passed &= test_reuse(nullptr);
+    passed &= test_reuse(executor);
+    passed &= test_draw_heavy(4, 200000);
+
+    cout << (passed ? "all passed" : "some failed") << endl;
+    return passed ? 0 : 1;
+}
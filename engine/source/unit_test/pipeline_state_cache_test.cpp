@@ -0,0 +1,242 @@
+#include "runtime/function/render/rhi/gpu_resources.h"
+#include "runtime/function/render/rhi/pipeline_state_cache.h"
+
+#include "runtime/core/thread/work_executor.h"
+
+#include "unit_test/test_utils.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace ArchViz;
+using namespace std;
+
+namespace
+{
+    PipelineCreation make_creation(const std::string& vertex, const std::string& fragment)
+    {
+        PipelineCreation creation;
+        creation.name = "test";
+        creation.shaders.reset().setName("test");
+        creation.shaders.addStage(vertex, static_cast<uint32_t>(vertex.size()), VK_SHADER_STAGE_VERTEX_BIT);
+        creation.shaders.addStage(fragment, static_cast<uint32_t>(fragment.size()), VK_SHADER_STAGE_FRAGMENT_BIT);
+        creation.render_pass.reset().color(VK_FORMAT_B8G8R8A8_UNORM).depth(VK_FORMAT_D32_SFLOAT);
+        creation.depth_stencil.setDepth(true, VK_COMPARE_OP_LESS);
+        creation.vertex_input.reset();
+        creation.vertex_input.addVertexStream({0, 32, VertexInputRate::PerVertex});
+        creation.vertex_input.addVertexAttribute({0, 0, 0, VertexComponentFormat::Float3});
+        creation.vertex_input.addVertexAttribute({1, 0, 12, VertexComponentFormat::Float3});
+        creation.blend_state.reset().addBlendState();
+        return creation;
+    }
+
+    bool test_keys()
+    {
+        const PipelineCreation base = make_creation("vertex", "fragment");
+
+        // names, the viewport pointer and entries behind the counts do not make a different pipeline
+        PipelineCreation renamed = base;
+        renamed.name             = "other";
+        renamed.shaders.setName("other");
+        ViewportState viewport;
+        renamed.viewport                                                      = &viewport;
+        renamed.vertex_input.vertex_attributes[5].offset                      = 99;
+        renamed.render_pass.color_formats[3]                                  = VK_FORMAT_R32_SFLOAT;
+        renamed.blend_state.blend_states[2].blend_enabled                     = 1;
+        renamed.depth_stencil.front.reference                                 = 7; // stencil is disabled
+        renamed.descriptor_set_layout[k_max_descriptor_set_layouts - 1].index = 3;
+
+        PipelineCreation culled        = base;
+        culled.rasterization.cull_mode = VK_CULL_MODE_BACK_BIT;
+
+        PipelineCreation blended = base;
+        blended.blend_state.blend_states[0].setColor(VK_BLEND_FACTOR_SRC_ALPHA, VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA, VK_BLEND_OP_ADD);
+
+        PipelineCreation depth_read                 = base;
+        depth_read.depth_stencil.depth_write_enable = 0;
+
+        PipelineCreation layout                         = base;
+        layout.vertex_input.vertex_attributes[1].offset = 16;
+
+        PipelineCreation format                 = base;
+        format.render_pass.depth_stencil_format = VK_FORMAT_D24_UNORM_S8_UINT;
+
+        PipelineCreation shader = make_creation("vertex", "fragment2");
+
+        const uint64_t key = base.hash();
+
+        bool passed = true;
+        passed &= check("key is stable", key == make_creation("vertex", "fragment").hash());
+        passed &= check("names and unused entries ignored", renamed.hash() == key);
+        passed &= check("rasterization changes key", culled.hash() != key);
+        passed &= check("blending changes key", blended.hash() != key);
+        passed &= check("depth state changes key", depth_read.hash() != key);
+        passed &= check("vertex layout changes key", layout.hash() != key);
+        passed &= check("output format changes key", format.hash() != key);
+        passed &= check("shader code changes key", shader.hash() != key);
+        return passed;
+    }
+
+    bool test_dedup(const std::shared_ptr<WorkExecutor>& executor)
+    {
+        std::atomic<uint32_t> compiles {0};
+        std::atomic<uint32_t> destroys {0};
+
+        PipelineStateCache<uint64_t> cache;
+        cache.initialize(
+            [&](const PipelineCreation& creation, uint64_t& pipeline) {
+                compiles += 1;
+                pipeline = creation.hash();
+                return creation.shaders.stages[1].code != "broken";
+            },
+            [&](uint64_t&) { destroys += 1; },
+            executor);
+
+        // 64 distinct pipelines requested from 8 threads, each 8 times
+        std::vector<PipelineCreation> creations;
+        for (uint32_t i = 0; i < 64; ++i)
+        {
+            creations.push_back(make_creation("vertex", "fragment" + std::to_string(i)));
+        }
+        parallel_for(executor, 8, 1, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t thread = begin; thread < end; ++thread)
+            {
+                for (uint32_t i = 0; i < 64 * 8; ++i)
+                {
+                    cache.request(creations[(i + thread) % 64], 0);
+                }
+            }
+        });
+        cache.wait();
+
+        bool ready = cache.size() == 64;
+        for (const auto& creation : creations)
+        {
+            uint64_t pipeline = 0;
+            ready &= cache.get(creation, pipeline) && pipeline == creation.hash() && cache.request(creation, 0) == creation.hash();
+        }
+
+        uint64_t   broken_pipeline = 1;
+        const bool broken          = !cache.get(make_creation("vertex", "broken"), broken_pipeline) && broken_pipeline == 0;
+        const auto failed_fallback = cache.request(make_creation("vertex", "broken"), 42);
+
+        PipelineStateStatistics statistics = cache.getStatistics();
+        cache.clear();
+
+        bool passed = true;
+        passed &= check(executor ? "threaded requests compile each key once" : "requests compile each key once", compiles == 65 && statistics.compiled == 64 && statistics.failed == 1);
+        passed &= check("compiled pipelines returned", ready);
+        passed &= check("failed pipeline uses the fallback", broken && failed_fallback == 42);
+        passed &= check("clear destroys compiled pipelines only", destroys == 64 && cache.size() == 0);
+        return passed;
+    }
+
+    bool test_fallback(const std::shared_ptr<WorkExecutor>& executor)
+    {
+        // the compile is held until the test lets it go, requests meanwhile get the fallback
+        std::mutex              mutex;
+        std::condition_variable condition;
+        bool                    release = false;
+
+        PipelineStateCache<uint64_t> cache;
+        cache.initialize(
+            [&](const PipelineCreation& creation, uint64_t& pipeline) {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [&]() { return release; });
+                pipeline = 7;
+                return true;
+            },
+            [](uint64_t&) {},
+            executor);
+
+        const PipelineCreation creation = make_creation("vertex", "fragment");
+
+        const uint64_t first   = cache.request(creation, 1);
+        const uint64_t second  = cache.request(creation, 1);
+        const bool     pending = cache.state(creation.hash()) == PipelineState::Pending;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            release = true;
+        }
+        condition.notify_all();
+        cache.wait();
+
+        const bool                    ready      = cache.state(creation.hash()) == PipelineState::Ready && cache.request(creation, 1) == 7;
+        const PipelineStateStatistics statistics = cache.getStatistics();
+        cache.clear();
+
+        bool passed = true;
+        passed &= check("fallback while pending", first == 1 && second == 1 && pending && statistics.fallbacks == 2);
+        passed &= check("compiled pipeline after the wait", ready && statistics.compiled == 1);
+        return passed;
+    }
+
+    bool test_blob()
+    {
+        VkPhysicalDeviceProperties properties {};
+        properties.vendorID = 0x10de;
+        properties.deviceID = 0x2484;
+        for (uint32_t i = 0; i < VK_UUID_SIZE; ++i)
+        {
+            properties.pipelineCacheUUID[i] = static_cast<uint8_t>(i * 7);
+        }
+
+        VkPipelineCacheHeaderVersionOne header {};
+        header.headerSize    = sizeof(header);
+        header.headerVersion = VK_PIPELINE_CACHE_HEADER_VERSION_ONE;
+        header.vendorID      = properties.vendorID;
+        header.deviceID      = properties.deviceID;
+        std::memcpy(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+
+        // header plus some driver data, at an odd offset to catch unaligned reads
+        auto blob = [](const VkPipelineCacheHeaderVersionOne& value) {
+            std::vector<std::byte> data(sizeof(value) + 65);
+            std::memcpy(data.data() + 1, &value, sizeof(value));
+            return data;
+        };
+        auto valid = [&](const VkPipelineCacheHeaderVersionOne& value) {
+            std::vector<std::byte> data = blob(value);
+            return validate_pipeline_cache(data.data() + 1, data.size() - 1, properties);
+        };
+
+        VkPipelineCacheHeaderVersionOne other_device = header;
+        other_device.deviceID += 1;
+        VkPipelineCacheHeaderVersionOne other_driver = header;
+        other_driver.pipelineCacheUUID[15] ^= 1;
+        VkPipelineCacheHeaderVersionOne bad_version = header;
+        bad_version.headerVersion                   = static_cast<VkPipelineCacheHeaderVersion>(2);
+        VkPipelineCacheHeaderVersionOne bad_size    = header;
+        bad_size.headerSize                         = 4096;
+
+        std::vector<std::byte> data = blob(header);
+
+        bool passed = true;
+        passed &= check("matching blob accepted", valid(header));
+        passed &= check("other device rejected", !valid(other_device));
+        passed &= check("other driver rejected", !valid(other_driver));
+        passed &= check("malformed header rejected", !valid(bad_version) && !valid(bad_size));
+        passed &= check("truncated blob rejected", !validate_pipeline_cache(data.data() + 1, sizeof(header) - 1, properties) && !validate_pipeline_cache(nullptr, 0, properties));
+        return passed;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    auto executor = std::make_shared<WorkExecutor>(4);
+
+    bool passed = true;
+    passed &= test_keys();
+    passed &= test_dedup(nullptr);
+    passed &= test_dedup(executor);
+    passed &= test_fallback(executor);
+    passed &= test_blob();
+
+    cout << (passed ? "all passed" : "some failed") << endl;
+    return passed ? 0 : 1;
+}
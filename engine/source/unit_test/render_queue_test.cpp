@@ -0,0 +1,234 @@
+#include "runtime/function/render/queue/render_queue.h"
+
+#include "runtime/core/thread/work_executor.h"
+
+#include "unit_test/test_utils.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace ArchViz;
+using namespace std;
+
+namespace
+{
+    // a scene of count packets over a few passes, pipelines and materials, meshes shared by many objects
+    void make_packets(uint32_t count, uint32_t seed, std::vector<DrawPacket>& packets, std::vector<DrawInstance>& instances)
+    {
+        std::mt19937                            rng(seed);
+        std::uniform_int_distribution<uint32_t> pass_dist(0, 3);
+        std::uniform_int_distribution<uint32_t> mesh_dist(0, 1023);
+        std::uniform_int_distribution<uint32_t> variant_dist(0, 3);
+        std::uniform_real_distribution<float>   depth_dist(0.0f, 1.0f);
+
+        packets.resize(count);
+        instances.resize(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            // a mesh comes with a few material variants, materials share 16 pipelines
+            const uint32_t pass     = pass_dist(rng);
+            const uint32_t mesh     = mesh_dist(rng);
+            const uint32_t material = (mesh + variant_dist(rng) * 97) % 256;
+
+            packets[i].mesh     = mesh;
+            packets[i].material = material;
+            packets[i].key      = SortKey::make(pass, material % 16, material, depth_dist(rng), pass == 3);
+
+            instances[i].model(0, 3) = static_cast<float>(i);
+            instances[i].object_id   = i;
+        }
+    }
+
+    bool test_sort_key()
+    {
+        const uint64_t base = SortKey::make(1, 2, 3, 0.5f);
+
+        bool passed = true;
+        passed &= check("fields read back", SortKey::pass(base) == 1 && SortKey::pipeline(base) == 2 && SortKey::material(base) == 3);
+        passed &= check("pass orders first", SortKey::make(0, 4000, 4000, 1.0f) < SortKey::make(1, 0, 0, 0.0f));
+        passed &= check("pipeline before material", SortKey::make(1, 1, 4000, 1.0f) < SortKey::make(1, 2, 0, 0.0f));
+        passed &= check("material before depth", SortKey::make(1, 2, 3, 1.0f) < SortKey::make(1, 2, 4, 0.0f));
+        passed &= check("front to back", SortKey::make(1, 2, 3, 0.25f) < base);
+        passed &= check("back to front", SortKey::make(1, 2, 3, 0.75f, true) < SortKey::make(1, 2, 3, 0.25f, true));
+        passed &= check("depth clamped", SortKey::depth(SortKey::make(0, 0, 0, -1.0f)) == 0 && SortKey::depth(SortKey::make(0, 0, 0, 2.0f)) == SortKey::mask(SortKey::k_depth_bits));
+        passed &= check("state ignores depth", SortKey::state(SortKey::make(1, 2, 3, 0.1f)) == SortKey::state(SortKey::make(1, 2, 3, 0.9f)));
+        return passed;
+    }
+
+    // the parallel radix sort against std::stable_sort, with the sort split in several chunks
+    bool test_sort(std::shared_ptr<WorkExecutor> executor)
+    {
+        std::vector<DrawPacket>   packets;
+        std::vector<DrawInstance> instances;
+        make_packets(100000, 3, packets, instances);
+
+        RenderQueue queue;
+        queue.m_executor     = executor;
+        queue.m_thread_count = 4;
+        queue.initialize();
+        queue.submit(packets.data(), instances.data(), static_cast<uint32_t>(packets.size()));
+        queue.build();
+
+        std::vector<uint32_t> expected(packets.size());
+        for (uint32_t i = 0; i < expected.size(); ++i)
+        {
+            expected[i] = i;
+        }
+        std::stable_sort(expected.begin(), expected.end(), [&packets](uint32_t a, uint32_t b) { return packets[a].key < packets[b].key; });
+
+        bool passed = true;
+        passed &= check("radix order matches a stable sort", queue.getOrder() == expected);
+        passed &= check("constant bytes skipped", queue.getStatistics().radix_passes < 8);
+
+        // the same queue again next frame
+        queue.reset();
+        queue.submit(packets.data(), instances.data(), 1000);
+        queue.build();
+        passed &= check("reset drops the last frame", queue.size() == 1000 && queue.getOrder().size() == 1000);
+        return passed;
+    }
+
+    bool test_instancing()
+    {
+        RenderQueue queue;
+        queue.initialize();
+
+        const uint32_t tree  = queue.getMeshId("tree");
+        const uint32_t rock  = queue.getMeshId("rock");
+        const uint32_t bark  = queue.getMaterialId("bark");
+        const uint32_t stone = queue.getMaterialId("stone");
+
+        // trees and rocks interleaved in depth, in one pass and pipeline
+        const float depths[] = {0.4f, 0.1f, 0.3f, 0.2f, 0.6f, 0.5f};
+        for (uint32_t i = 0; i < 6; ++i)
+        {
+            const bool   is_tree = i % 2 == 0;
+            DrawPacket   packet;
+            DrawInstance instance;
+            packet.mesh        = is_tree ? tree : rock;
+            packet.material    = is_tree ? bark : stone;
+            packet.key         = SortKey::make(0, 0, 0, depths[i]);
+            instance.object_id = i;
+            queue.submit(packet, instance);
+        }
+
+        // the same tree in another pass is a batch of its own
+        DrawPacket shadow;
+        shadow.mesh     = tree;
+        shadow.material = bark;
+        shadow.key      = SortKey::make(1, 0, 0, 0.0f);
+        queue.submit(shadow, DrawInstance {FMatrix4::Identity(), 6});
+
+        queue.build();
+
+        const std::vector<DrawBatch>&    batches   = queue.getBatches();
+        const std::vector<DrawInstance>& instances = queue.getInstances();
+
+        bool passed = true;
+        passed &= check("ids interned", queue.getMeshId("tree") == tree && tree != rock && queue.getMaterialId("stone") == stone);
+        passed &= check("same mesh and material merged", batches.size() == 3 && batches[0].instance_count == 3 && batches[1].instance_count == 3 && batches[2].instance_count == 1);
+        passed &= check("batch of the nearest packet first", batches[0].mesh == rock && batches[1].mesh == tree && SortKey::pass(batches[2].key) == 1);
+        passed &= check("instance ranges contiguous", batches[0].first_instance == 0 && batches[1].first_instance == 3 && batches[2].first_instance == 6 && instances.size() == 7);
+
+        // rocks at 0.1, 0.2, 0.5 then trees at 0.3, 0.4, 0.6
+        const uint32_t expected[] = {1, 3, 5, 2, 0, 4, 6};
+        bool           ordered    = true;
+        for (uint32_t i = 0; i < 7; ++i)
+        {
+            ordered &= instances[i].object_id == expected[i];
+        }
+        passed &= check("instances front to back within a batch", ordered);
+        return passed;
+    }
+
+    // every packet ends up in exactly one batch slot, and batches never mix meshes, materials or state
+    bool test_batches(std::shared_ptr<WorkExecutor> executor)
+    {
+        std::vector<DrawPacket>   packets;
+        std::vector<DrawInstance> instances;
+        make_packets(200000, 5, packets, instances);
+
+        RenderQueue queue;
+        queue.m_executor     = executor;
+        queue.m_thread_count = 4;
+        queue.initialize();
+        queue.submit(packets.data(), instances.data(), static_cast<uint32_t>(packets.size()));
+        queue.build();
+
+        std::vector<uint32_t> seen(packets.size(), 0);
+        bool                  consistent = true;
+        uint64_t              last_state = 0;
+        for (const DrawBatch& batch : queue.getBatches())
+        {
+            consistent &= SortKey::state(batch.key) >= last_state;
+            last_state = SortKey::state(batch.key);
+            for (uint32_t i = batch.first_instance; i < batch.first_instance + batch.instance_count; ++i)
+            {
+                const uint32_t    id     = queue.getInstances()[i].object_id;
+                const DrawPacket& packet = packets[id];
+                consistent &= packet.mesh == batch.mesh && packet.material == batch.material && SortKey::state(packet.key) == SortKey::state(batch.key);
+                consistent &= queue.getInstances()[i].model(0, 3) == static_cast<float>(id);
+                seen[id] += 1;
+            }
+        }
+
+        bool passed = true;
+        passed &= check("batches keep their state order and contents", consistent);
+        passed &= check("every packet drawn once", std::all_of(seen.begin(), seen.end(), [](uint32_t count) { return count == 1; }));
+        passed &= check("packets merged", queue.getBatches().size() < packets.size());
+        return passed;
+    }
+
+    void benchmark_build(uint32_t count, std::shared_ptr<WorkExecutor> executor, uint32_t threads)
+    {
+        const uint32_t frames = 8;
+
+        std::vector<DrawPacket>   packets;
+        std::vector<DrawInstance> instances;
+        make_packets(count, 7, packets, instances);
+
+        RenderQueue queue;
+        queue.m_executor     = executor;
+        queue.m_thread_count = threads;
+        queue.initialize();
+
+        float  sort_ms  = 0.0f;
+        float  batch_ms = 0.0f;
+        double total_ms = 0.0;
+        for (uint32_t frame = 0; frame < frames; ++frame)
+        {
+            queue.reset();
+            queue.submit(packets.data(), instances.data(), count);
+
+            total_ms += elapsed_ms([&]() { queue.build(); });
+
+            sort_ms += queue.getStatistics().sort_ms;
+            batch_ms += queue.getStatistics().batch_ms;
+        }
+
+        cout << "build " << count << " packets on " << threads << " threads: sort " << sort_ms / frames << " ms, batch " << batch_ms / frames << " ms, total "
+             << total_ms / frames << " ms per frame, " << queue.getStatistics().batches << " batches, " << queue.getStatistics().radix_passes << " radix passes" << endl;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const uint32_t                threads  = std::max(2u, std::thread::hardware_concurrency());
+    std::shared_ptr<WorkExecutor> executor = std::make_shared<WorkExecutor>(threads);
+
+    bool passed = true;
+    passed &= test_sort_key();
+    passed &= test_sort(nullptr);
+    passed &= test_sort(executor);
+    passed &= test_instancing();
+    passed &= test_batches(executor);
+
+    benchmark_threads({100000u, 1000000u}, executor, threads, benchmark_build);
+
+    cout << (passed ? "all passed" : "some failed") << endl;
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,156 @@
+#include "runtime/resource/config_manager/config_manager.h"
+
+#include "runtime/function/render/rhi/shader_reflection.h"
+#include "runtime/function/render/rhi/vulkan/utils/vulkan_shader_cache.h"
+#include "runtime/function/render/rhi/vulkan/utils/vulkan_shader_utils.h"
+
+#include "runtime/function/global/global_context.h"
+
+#include "unit_test/test_utils.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace ArchViz;
+using namespace std;
+
+namespace
+{
+    void write_text(const std::filesystem::path& path, const std::string& text)
+    {
+        std::ofstream file(path, std::ios::trunc);
+        file << text;
+    }
+
+    bool is_shader(const std::filesystem::path& path)
+    {
+        const std::string extension = path.extension().generic_string();
+        return extension == ".vert" || extension == ".frag" || extension == ".comp" || extension == ".geom" || extension == ".tesc" || extension == ".tese";
+    }
+
+    double compile_all(const std::vector<std::filesystem::path>& shaders, std::vector<std::vector<uint32_t>>& spirv)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        spirv.clear();
+        for (const auto& shader : shaders)
+        {
+            spirv.push_back(VulkanShaderUtils::createShaderModuleFromFile(shader.generic_string()));
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    // startup cost over every shader of the engine, cold (empty cache) and warm
+    bool test_startup(const std::filesystem::path& shader_folder)
+    {
+        std::vector<std::filesystem::path> shaders;
+        std::error_code                    error;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(shader_folder, error))
+        {
+            if (entry.is_regular_file() && is_shader(entry.path()))
+            {
+                shaders.push_back(entry.path());
+            }
+        }
+
+        VulkanShaderCache& cache = VulkanShaderUtils::getShaderCache();
+
+        std::vector<std::vector<uint32_t>> cold_spirv;
+        cache.resetStatistics();
+        double                cold_ms    = compile_all(shaders, cold_spirv);
+        ShaderCacheStatistics cold_stats = cache.getStatistics();
+
+        std::vector<std::vector<uint32_t>> warm_spirv;
+        cache.resetStatistics();
+        double                warm_ms    = compile_all(shaders, warm_spirv);
+        ShaderCacheStatistics warm_stats = cache.getStatistics();
+
+        cout << shaders.size() << " shaders in " << shader_folder.generic_string() << endl;
+        cout << "  cold: " << cold_ms << " ms, " << cold_stats.compiles << " glslang compiles (" << cold_stats.compile_ms << " ms)" << endl;
+        cout << "  warm: " << warm_ms << " ms, " << warm_stats.compiles << " glslang compiles, " << warm_stats.hits << " cache hits (" << warm_stats.load_ms << " ms)" << endl;
+
+        bool valid = true;
+        for (const auto& spirv : cold_spirv)
+        {
+            valid &= !spirv.empty() && spirv[0] == 0x07230203;
+        }
+
+        bool passed = true;
+        passed &= check("engine shaders found", !shaders.empty());
+        passed &= check("cold start compiles every shader", cold_stats.compiles == shaders.size() && valid);
+        passed &= check("warm start compiles nothing", warm_stats.compiles == 0 && warm_stats.hits == shaders.size());
+        passed &= check("cached spir-v identical", cold_spirv == warm_spirv);
+        return passed;
+    }
+
+    bool test_invalidation(const std::filesystem::path& folder)
+    {
+        VulkanShaderCache& cache = VulkanShaderUtils::getShaderCache();
+
+        const std::filesystem::path shader = folder / "tint.frag";
+        write_text(folder / "inner.glsl", "#define TINT vec4(1.0, 0.0, 0.0, 1.0)\n");
+        write_text(folder / "common.glsl", "#include \"inner.glsl\"\n");
+        write_text(shader, "#version 450\n#include \"common.glsl\"\nlayout(location = 0) out vec4 out_color;\nvoid main() { out_color = TINT; }\n");
+
+        ShaderReflection first_reflection;
+        ShaderReflection again_reflection;
+
+        cache.resetStatistics();
+        auto first = VulkanShaderUtils::createShaderModuleFromFile(shader.generic_string(), {}, &first_reflection);
+        auto again = VulkanShaderUtils::createShaderModuleFromFile(shader.generic_string(), {}, &again_reflection);
+
+        bool passed = true;
+        passed &= check("include compiled once", cache.getStatistics().compiles == 1 && cache.getStatistics().hits == 1 && first == again);
+        passed &= check("reflection cached with the spir-v", again_reflection.stage == VK_SHADER_STAGE_FRAGMENT_BIT && again_reflection.serialize() == first_reflection.serialize());
+
+        // a nested include changes, the entry of the shader must not be used any more
+        write_text(folder / "inner.glsl", "#define TINT vec4(0.25, 0.5, 0.75, 1.0) // changed\n");
+        cache.resetStatistics();
+        auto changed = VulkanShaderUtils::createShaderModuleFromFile(shader.generic_string());
+        passed &= check("nested include change invalidates", cache.getStatistics().stale == 1 && cache.getStatistics().compiles == 1 && changed != first);
+
+        cache.resetStatistics();
+        auto defined = VulkanShaderUtils::createShaderModuleFromFile(shader.generic_string(), {"EXTRA=1"});
+        VulkanShaderUtils::createShaderModuleFromFile(shader.generic_string(), {"EXTRA=1"});
+        passed &= check("defines are part of the key", cache.getStatistics().misses == 1 && cache.getStatistics().compiles == 1 && cache.getStatistics().hits == 1 && !defined.empty());
+
+        // a damaged entry is compiled again instead of being used
+        const uint64_t key = VulkanShaderCache::computeKey("x", "y", {}, 0);
+        write_text(cache.getEntryPath(key), "garbage");
+        std::vector<uint32_t> spirv;
+        ShaderReflection      reflection;
+        passed &= check("damaged entry rejected", !cache.load(key, spirv, reflection) && spirv.empty());
+        return passed;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::filesystem::path executable_path(argv[0]);
+    std::filesystem::path config_file_path = executable_path.parent_path() / "../ArchVizEditor.ini";
+
+    g_runtime_global_context.startSystems(config_file_path.generic_string());
+
+    const std::filesystem::path root_folder   = g_runtime_global_context.m_config_manager->getRootFolder();
+    const std::filesystem::path shader_folder = argc > 1 ? std::filesystem::path(argv[1]) : root_folder / "shader" / "glsl";
+
+    // a private cache folder, the real one is left alone
+    const std::filesystem::path cache_folder = std::filesystem::temp_directory_path() / "archviz_shader_cache_test";
+    std::error_code             error;
+    std::filesystem::remove_all(cache_folder, error);
+    std::filesystem::create_directories(cache_folder / "source", error);
+    VulkanShaderUtils::getShaderCache().setFolder(cache_folder / "spirv");
+
+    bool passed = true;
+    passed &= test_startup(shader_folder);
+    passed &= test_invalidation(cache_folder / "source");
+
+    std::filesystem::remove_all(cache_folder, error);
+    g_runtime_global_context.shutdownSystems();
+
+    cout << (passed ? "all passed" : "some failed") << endl;
+    return passed ? 0 : 1;
+}
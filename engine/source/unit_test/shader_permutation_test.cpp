@@ -0,0 +1,155 @@
+#include "runtime/resource/asset_manager/asset_manager.h"
+#include "runtime/resource/config_manager/config_manager.h"
+
+#include "runtime/function/render/rhi/shader_permutation.h"
+#include "runtime/function/render/rhi/vulkan/utils/vulkan_shader_cache.h"
+#include "runtime/function/render/rhi/vulkan/utils/vulkan_shader_utils.h"
+
+#include "runtime/function/global/global_context.h"
+
+#include "runtime/core/thread/work_executor.h"
+
+#include "unit_test/test_utils.h"
+
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace ArchViz;
+using namespace std;
+
+namespace
+{
+    bool test_variants()
+    {
+        std::vector<ShaderPermutationDesc> descs;
+        bool parsed = ShaderPermutationBuilder::parseDescs(R"({ "shaders": [ { "file": "a.frag", "axes": [ { "name": "SKINNING" }, { "name": "LIGHTING", "values": [ "0", "1", "2" ] } ] } ] })", descs);
+
+        bool passed = true;
+        passed &= check("permutations parsed", parsed && descs.size() == 1 && descs[0].axes.size() == 2);
+        passed &= check("variant count is the product of the axes", descs[0].variantCount() == 6);
+        passed &= check("variant defines", descs[0].variantDefines(0) == std::vector<std::string> {"LIGHTING=0"} && descs[0].variantDefines(5) == std::vector<std::string> {"SKINNING", "LIGHTING=2"});
+        passed &= check("single valued axis rejected", !ShaderPermutationBuilder::parseDescs(R"({ "shaders": [ { "file": "a.frag", "axes": [ { "name": "A", "values": [ "1" ] } ] } ] })", descs));
+        passed &= check("variant key ignores define order", ShaderPermutationManifest::variantKey("a.frag", {"A", "B=1"}) == ShaderPermutationManifest::variantKey("a.frag", {"B=1", "A"}));
+        return passed;
+    }
+
+    bool test_build(const std::vector<ShaderPermutationDesc>& descs, std::shared_ptr<WorkExecutor> executor, const std::filesystem::path& folder)
+    {
+        ShaderPermutationBuilder  builder;
+        ShaderPermutationManifest serial;
+        ShaderPermutationManifest parallel;
+
+        bool                  serial_built   = builder.build(descs, nullptr, serial);
+        ShaderBuildStatistics serial_stats   = builder.getStatistics();
+        bool                  parallel_built = builder.build(descs, executor, parallel);
+        ShaderBuildStatistics parallel_stats = builder.getStatistics();
+
+        cout << parallel_stats.shaders << " shaders, " << parallel_stats.variants << " variants, " << parallel_stats.blobs << " distinct spir-v" << endl;
+        cout << "  serial:   " << serial_stats.build_ms << " ms" << endl;
+        cout << "  parallel: " << parallel_stats.build_ms << " ms (" << serial_stats.build_ms / parallel_stats.build_ms << "x)" << endl;
+
+        // the phong fragment shader is declared with two switches, the unused axis on the base shader changes nothing
+        const ShaderManifestEntry* phong = parallel.findEntry("shader/glsl/shader_phong.frag");
+        const ShaderManifestEntry* base  = parallel.findEntry("shader/glsl/basic/shader_base.frag");
+
+        bool distinct = phong != nullptr && phong->variants.size() == 4;
+        for (size_t i = 0; distinct && i < phong->variants.size(); ++i)
+        {
+            for (size_t j = i + 1; j < phong->variants.size(); ++j)
+            {
+                distinct &= phong->variants[i].blob != phong->variants[j].blob;
+            }
+        }
+
+        bool same = true;
+        for (const auto& desc : descs)
+        {
+            for (uint32_t v = 0; v < desc.variantCount(); ++v)
+            {
+                const ShaderVariant* a = serial.findVariant(desc.file, desc.variantDefines(v));
+                const ShaderVariant* b = parallel.findVariant(desc.file, desc.variantDefines(v));
+                same &= a != nullptr && b != nullptr && serial.getBlob(a->blob) == parallel.getBlob(b->blob);
+            }
+        }
+
+        const ShaderVariant* alpha_test = parallel.findVariant("shader/glsl/shader_phong.frag", {"ALPHA_TEST", "LIGHTING_BLINN"});
+        bool                 reflected  = alpha_test != nullptr;
+        if (reflected)
+        {
+            const ShaderReflection& reflection = parallel.getReflection(alpha_test->blob);
+            reflected &= reflection.stage == VK_SHADER_STAGE_FRAGMENT_BIT && reflection.bindings.size() == 2;
+            reflected &= reflection.bindings[0].binding == 1 && reflection.bindings[0].type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            reflected &= reflection.bindings[1].binding == 2 && reflection.bindings[1].type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        }
+
+        ShaderPermutationManifest loaded;
+        bool                      saved      = parallel.save(folder);
+        bool                      loaded_ok  = loaded.load(folder);
+        bool                      round_trip = loaded_ok && loaded.blobCount() == parallel.blobCount() && loaded.entries().size() == parallel.entries().size();
+        for (size_t i = 0; round_trip && i < parallel.entries().size(); ++i)
+        {
+            const std::vector<ShaderDependency>& a = parallel.entries()[i].dependencies;
+            const std::vector<ShaderDependency>& b = loaded.entries()[i].dependencies;
+            round_trip &= a.size() == b.size();
+            for (size_t j = 0; round_trip && j < a.size(); ++j)
+            {
+                round_trip &= a[j].file == b[j].file && a[j].hash == b[j].hash;
+            }
+        }
+        if (round_trip && alpha_test != nullptr)
+        {
+            const ShaderVariant* loaded_variant = loaded.findVariant("shader/glsl/shader_phong.frag", {"LIGHTING_BLINN", "ALPHA_TEST"});
+            round_trip &= loaded_variant != nullptr && loaded.getBlob(loaded_variant->blob) == parallel.getBlob(alpha_test->blob) &&
+                          loaded.getReflection(loaded_variant->blob).serialize() == parallel.getReflection(alpha_test->blob).serialize();
+        }
+
+        bool passed = true;
+        passed &= check("every variant compiled", serial_built && parallel_built && parallel_stats.failed == 0);
+        passed &= check("parallel build matches serial build", same);
+        passed &= check("declared switches give distinct spir-v", distinct);
+        passed &= check("unused axis deduplicated", base != nullptr && base->variants.size() == 2 && base->variants[0].blob == base->variants[1].blob);
+        passed &= check("variants reflected", reflected);
+        passed &= check("manifest round trip", saved && round_trip);
+        return passed;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::filesystem::path executable_path(argv[0]);
+    std::filesystem::path config_file_path = executable_path.parent_path() / "../ArchVizEditor.ini";
+
+    g_runtime_global_context.startSystems(config_file_path.generic_string());
+
+    const std::filesystem::path root_folder = g_runtime_global_context.m_config_manager->getRootFolder();
+
+    // every variant really compiles, the shader cache would turn the second build into lookups
+    VulkanShaderUtils::getShaderCache().setFolder({});
+
+    std::vector<ShaderPermutationDesc> descs;
+    std::string                        json_text;
+    g_runtime_global_context.m_asset_manager->readTextFile(root_folder / "shader" / "permutations.json", json_text);
+    ShaderPermutationBuilder::parseDescs(json_text, descs);
+    descs.push_back({"shader/glsl/basic/shader_base.frag", {{"UNUSED", {}}}});
+    descs.push_back({"shader/glsl/shader_phong.vert", {}});
+    descs.push_back({"shader/glsl/shader_compute.comp", {}});
+    descs.push_back({"shader/glsl/imgui.frag", {}});
+
+    const std::filesystem::path folder = std::filesystem::temp_directory_path() / "archviz_shader_permutation_test";
+
+    std::shared_ptr<WorkExecutor> executor = std::make_shared<WorkExecutor>();
+
+    bool passed = true;
+    passed &= test_variants();
+    passed &= test_build(descs, executor, folder);
+
+    std::error_code error;
+    std::filesystem::remove_all(folder, error);
+    executor.reset();
+    g_runtime_global_context.shutdownSystems();
+
+    cout << (passed ? "all passed" : "some failed") << endl;
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,182 @@
+#include "runtime/resource/config_manager/config_manager.h"
+
+#include "runtime/function/render/rhi/shader_reflection.h"
+#include "runtime/function/render/rhi/spirv_parser.h"
+#include "runtime/function/render/rhi/vulkan/utils/vulkan_shader_cache.h"
+#include "runtime/function/render/rhi/vulkan/utils/vulkan_shader_utils.h"
+
+#include "runtime/function/global/global_context.h"
+
+#include "unit_test/test_utils.h"
+
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace ArchViz;
+using namespace std;
+
+namespace
+{
+    // push constants, a specialization constant, a storage image and a bindless array in one module
+    const char* k_probe_shader = R"(#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+layout(constant_id = 3) const int SAMPLE_COUNT = 8;
+layout(local_size_x = 8, local_size_y = 4, local_size_z = 1) in;
+layout(push_constant) uniform Push { mat4 transform; vec4 tint; uint index; } push;
+layout(set = 1, binding = 0, rgba8) uniform writeonly image2D target;
+layout(set = 1, binding = 10) uniform sampler2D textures[];
+layout(set = 2, binding = 0) uniform sampler2D shadows[4];
+void main()
+{
+    vec4 color = vec4(0.0);
+    for (int i = 0; i < SAMPLE_COUNT; ++i)
+    {
+        color += textureLod(textures[nonuniformEXT(push.index)], vec2(0.5), 0.0) + textureLod(shadows[i % 4], vec2(0.5), 0.0);
+    }
+    imageStore(target, ivec2(gl_GlobalInvocationID.xy), push.transform * color * push.tint);
+}
+)";
+
+    bool test_engine_shaders()
+    {
+        ShaderReflection vert;
+        ShaderReflection frag;
+        ShaderReflection comp;
+        VulkanShaderUtils::createShaderModuleFromVFS("shader/glsl/shader_phong.vert", {}, &vert);
+        VulkanShaderUtils::createShaderModuleFromVFS("shader/glsl/shader_phong.frag", {}, &frag);
+        VulkanShaderUtils::createShaderModuleFromVFS("shader/glsl/shader_compute.comp", {}, &comp);
+
+        bool inputs = vert.inputs.size() == 4;
+        for (uint32_t i = 0; inputs && i < 4; ++i)
+        {
+            inputs &= vert.inputs[i].location == i && vert.inputs[i].format == (i == 3 ? VK_FORMAT_R32G32_SFLOAT : VK_FORMAT_R32G32B32_SFLOAT);
+        }
+
+        // the texture comes from the bindless table in set 1, the material pushes its index
+        PipelineLayoutDesc phong;
+        bool merged = PipelineLayoutDesc::merge({&vert, &frag}, phong) && phong.sets.size() == 2 && phong.sets[0].bindings.size() == 2 && phong.sets[1].bindings.size() == 1;
+        if (merged)
+        {
+            const auto& bindings = phong.sets[0].bindings;
+            const auto& bindless = phong.sets[1].bindings[0];
+            merged &= bindings[0].binding == 0 && bindings[0].type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER && bindings[0].stages == VK_SHADER_STAGE_VERTEX_BIT;
+            merged &= bindings[1].binding == 2 && bindings[1].type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER && bindings[1].stages == VK_SHADER_STAGE_FRAGMENT_BIT;
+            merged &= bindless.binding == 10 && bindless.count == 0 && bindless.type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER && bindless.stages == VK_SHADER_STAGE_FRAGMENT_BIT;
+            merged &= phong.push_constants.size() == 1 && phong.push_constants[0].size == 20 && phong.push_constants[0].stages == VK_SHADER_STAGE_FRAGMENT_BIT;
+        }
+
+        const bool compute = comp.stage == VK_SHADER_STAGE_COMPUTE_BIT && comp.workgroup_size[0] == 256 && comp.workgroup_size[1] == 1 && comp.workgroup_size[2] == 1 && comp.bindings.size() == 3 &&
+                             comp.bindings[1].type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER && comp.bindings[2].type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+
+        // switches that do not touch the bindings give the same layout, a different shader does not
+        ShaderReflection   frag_variant;
+        PipelineLayoutDesc phong_variant;
+        PipelineLayoutDesc compute_layout;
+        VulkanShaderUtils::createShaderModuleFromVFS("shader/glsl/shader_phong.frag", {"ALPHA_TEST", "LIGHTING_BLINN"}, &frag_variant);
+        PipelineLayoutDesc::merge({&vert, &frag_variant}, phong_variant);
+        PipelineLayoutDesc::merge({&comp}, compute_layout);
+
+        bool passed = true;
+        passed &= check("vertex stage and entry point", vert.stage == VK_SHADER_STAGE_VERTEX_BIT && vert.entry_point == "main" && frag.stage == VK_SHADER_STAGE_FRAGMENT_BIT);
+        passed &= check("vertex inputs reflected", inputs && frag.inputs.empty());
+        passed &= check("phong layout matches the renderer", merged);
+        passed &= check("compute workgroup size and storage buffers", compute);
+        passed &= check("identical layouts share a hash", phong_variant.hash() == phong.hash() && phong_variant.sets[0].hash() == phong.sets[0].hash());
+        passed &= check("different layouts differ", compute_layout.hash() != phong.hash());
+        return passed;
+    }
+
+    bool test_probe_shader()
+    {
+        ShaderReflection probe;
+        bool             compiled = !VulkanShaderUtils::createShaderModuleFromCode(k_probe_shader, "probe.comp", {}, &probe).empty();
+
+        const bool bindings = probe.bindings.size() == 3 && probe.bindings[0].set == 1 && probe.bindings[0].type == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE &&
+                              probe.bindings[1].binding == 10 && probe.bindings[1].count == 0 && probe.bindings[1].type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER &&
+                              probe.bindings[2].set == 2 && probe.bindings[2].count == 4;
+
+        // mat4 + vec4 + uint, std430 puts the uint at 80
+        const bool push = probe.push_constants.size() == 1 && probe.push_constants[0].offset == 0 && probe.push_constants[0].size == 84;
+
+        const bool specialization = probe.specialization_constants.size() == 1 && probe.specialization_constants[0].id == 3 && probe.specialization_constants[0].default_value == 8;
+
+        // set 0 is unused, the pipeline layout still needs an empty set layout there
+        PipelineLayoutDesc layout;
+        bool               merged = PipelineLayoutDesc::merge({&probe}, layout) && layout.sets.size() == 3 && layout.sets[0].empty();
+
+        bool passed = true;
+        passed &= check("probe shader compiled", compiled);
+        passed &= check("storage image, runtime array and fixed array", bindings);
+        passed &= check("push constant range", push);
+        passed &= check("specialization constant", specialization);
+        passed &= check("workgroup size", probe.workgroup_size[0] == 8 && probe.workgroup_size[1] == 4 && probe.workgroup_size[2] == 1);
+        passed &= check("unused sets kept empty", merged);
+
+        // the old parser still skips the bindless binding managed by the rhi
+        auto                  parsed = std::make_unique<SPIRV::ParseResult>();
+        std::string           name_buffer;
+        std::vector<uint32_t> spirv = VulkanShaderUtils::createShaderModuleFromCode(k_probe_shader, "probe.comp");
+        SPIRV::parse_binary(spirv, name_buffer, *parsed);
+        passed &= check("parse_binary skips bindless", parsed->set_count == 3 && parsed->sets[1].num_bindings == 1);
+
+        std::vector<uint8_t> data = probe.serialize();
+        ShaderReflection     loaded;
+        passed &= check("serialize round trip", loaded.deserialize(data.data(), data.size()) && loaded.serialize() == data);
+
+        bool truncated = false;
+        for (size_t size = 0; size < data.size(); ++size)
+        {
+            truncated |= loaded.deserialize(data.data(), size);
+        }
+        passed &= check("truncated data rejected", !truncated && loaded.bindings.empty());
+        return passed;
+    }
+
+    bool test_conflict()
+    {
+        ShaderReflection vert;
+        vert.stage          = VK_SHADER_STAGE_VERTEX_BIT;
+        vert.bindings       = {{0, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, "a"}};
+        vert.push_constants = {{0, 64, VK_SHADER_STAGE_VERTEX_BIT}};
+
+        ShaderReflection frag = vert;
+        frag.stage            = VK_SHADER_STAGE_FRAGMENT_BIT;
+        frag.push_constants   = {{64, 16, VK_SHADER_STAGE_FRAGMENT_BIT}};
+
+        PipelineLayoutDesc shared;
+        bool               merged = PipelineLayoutDesc::merge({&vert, &frag}, shared);
+
+        frag.bindings[0].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        PipelineLayoutDesc conflict;
+
+        bool passed = true;
+        passed &= check("binding shared by stages", merged && shared.sets[0].bindings[0].stages == (VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT));
+        passed &= check("push constant ranges merged", shared.push_constants.size() == 1 && shared.push_constants[0].offset == 0 && shared.push_constants[0].size == 80);
+        passed &= check("type conflict rejected", !PipelineLayoutDesc::merge({&vert, &frag}, conflict));
+        return passed;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::filesystem::path executable_path(argv[0]);
+    std::filesystem::path config_file_path = executable_path.parent_path() / "../ArchVizEditor.ini";
+
+    g_runtime_global_context.startSystems(config_file_path.generic_string());
+
+    // reflection of fresh compiles, not of entries an older build left in the cache
+    VulkanShaderUtils::getShaderCache().setFolder({});
+
+    bool passed = true;
+    passed &= test_engine_shaders();
+    passed &= test_probe_shader();
+    passed &= test_conflict();
+
+    g_runtime_global_context.shutdownSystems();
+
+    cout << (passed ? "all passed" : "some failed") << endl;
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,150 @@
+#include "runtime/function/render/rhi/staging_ring.h"
+
+#include "unit_test/test_utils.h"
+
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace ArchViz;
+using namespace std;
+
+namespace
+{
+    bool test_allocate()
+    {
+        StagingRing ring;
+        ring.initialize(1024);
+
+        const uint64_t a = ring.allocate(100, 1);
+        const uint64_t b = ring.allocate(10, 64);
+        const uint64_t c = ring.allocate(4, 16);
+
+        bool passed = true;
+        passed &= check("first range at the start", a == 0);
+        passed &= check("ranges aligned", b == 128 && c == 144);
+        passed &= check("used counts the alignment padding", ring.used() == 148);
+        passed &= check("empty and oversize refused", ring.allocate(0, 1) == StagingRing::k_invalid_offset && ring.allocate(2048, 1) == StagingRing::k_invalid_offset);
+        return passed;
+    }
+
+    bool test_reclaim()
+    {
+        StagingRing ring;
+        ring.initialize(1024);
+
+        ring.allocate(512, 1);
+        ring.retire(1);
+        ring.allocate(256, 1);
+        ring.retire(2);
+
+        bool passed = true;
+        passed &= check("full ring refuses", ring.allocate(512, 1) == StagingRing::k_invalid_offset);
+        passed &= check("refusal counted", ring.getStatistics().full == 1);
+
+        ring.reclaim(0);
+        passed &= check("nothing given back before completion", ring.used() == 768);
+
+        ring.reclaim(1);
+        passed &= check("first batch given back", ring.used() == 256);
+
+        // 256 left at the end, the range does not fit there and starts over at 0
+        const uint64_t wrapped = ring.allocate(300, 1);
+        passed &= check("range wraps to the start", wrapped == 0);
+        passed &= check("skipped end counted", ring.getStatistics().wrapped_bytes == 256);
+        passed &= check("skipped end stays used", ring.used() == 256 + 256 + 300);
+
+        ring.retire(3);
+        ring.retire(3);
+        passed &= check("empty retire ignored", ring.idle());
+
+        ring.reclaim(3);
+        passed &= check("everything given back", ring.used() == 0);
+        return passed;
+    }
+
+    // random sizes and completion lag, no live range may ever overlap another
+    bool test_no_overlap()
+    {
+        struct Range
+        {
+            uint64_t token;
+            uint64_t offset;
+            uint64_t size;
+        };
+
+        const uint64_t capacity = 64 * 1024;
+
+        StagingRing ring;
+        ring.initialize(capacity);
+
+        std::mt19937                            rng(7);
+        std::uniform_int_distribution<uint64_t> size_dist(1, 9000);
+        std::uniform_int_distribution<uint32_t> count_dist(0, 12);
+        std::uniform_int_distribution<uint32_t> align_dist(0, 4);
+
+        std::deque<Range> live;
+        uint64_t          completed = 0;
+        uint64_t          refused   = 0;
+        bool              disjoint  = true;
+        bool              in_bounds = true;
+
+        for (uint64_t token = 1; token <= 4000; ++token)
+        {
+            const uint32_t count = count_dist(rng);
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const uint64_t size      = size_dist(rng);
+                const uint64_t alignment = 1ull << (align_dist(rng) * 2);
+                const uint64_t offset    = ring.allocate(size, alignment);
+                if (offset == StagingRing::k_invalid_offset)
+                {
+                    refused += 1;
+                    continue;
+                }
+
+                in_bounds &= offset % alignment == 0 && offset + size <= capacity;
+                for (const Range& range : live)
+                {
+                    disjoint &= offset + size <= range.offset || range.offset + range.size <= offset;
+                }
+                live.push_back({token, offset, size});
+            }
+            ring.retire(token);
+
+            // the gpu lags a few batches behind
+            if (token > 3)
+            {
+                completed = token - 3;
+                ring.reclaim(completed);
+                while (!live.empty() && live.front().token <= completed)
+                {
+                    live.pop_front();
+                }
+            }
+        }
+
+        ring.reclaim(~0ull);
+
+        cout << "    " << ring.getStatistics().allocations << " ranges, " << refused << " refused, peak " << ring.getStatistics().peak_used << " of " << capacity << " bytes" << endl;
+
+        bool passed = true;
+        passed &= check("live ranges never overlap", disjoint);
+        passed &= check("ranges aligned and inside the buffer", in_bounds);
+        passed &= check("ring drains", ring.used() == 0 && ring.getStatistics().peak_used <= capacity);
+        return passed;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    bool passed = true;
+    passed &= test_allocate();
+    passed &= test_reclaim();
+    passed &= test_no_overlap();
+
+    cout << (passed ? "all passed" : "some failed") << endl;
+    return passed ? 0 : 1;
+}
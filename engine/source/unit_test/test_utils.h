@@ -0,0 +1,53 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
+#include <iostream>
+#include <memory>
+
+namespace ArchViz
+{
+    class WorkExecutor;
+
+    // prints the name of a check with PASS or FAIL and returns its result
+    inline bool check(const char* name, bool result)
+    {
+        std::cout << (result ? "[PASS] " : "[FAIL] ") << name << std::endl;
+        return result;
+    }
+
+    // wall time of one call in milliseconds
+    template<typename Func>
+    double elapsed_ms(Func&& func)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        func();
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    // the fastest of repeat calls, the first one also pays for page faults
+    template<typename Func>
+    double best_ms(Func&& func, int repeat = 3)
+    {
+        double best = elapsed_ms(func);
+        for (int i = 1; i < repeat; ++i)
+        {
+            best = std::min(best, elapsed_ms(func));
+        }
+        return best;
+    }
+
+    // benchmark(count, executor, threads) for every count, inline on one thread and then on the executor. Benchmarks only
+    // print, they never decide whether a test passed
+    template<typename Func>
+    void benchmark_threads(std::initializer_list<uint32_t> counts, std::shared_ptr<WorkExecutor> executor, uint32_t threads, Func&& benchmark)
+    {
+        for (uint32_t count : counts)
+        {
+            benchmark(count, nullptr, 1);
+            benchmark(count, executor, threads);
+        }
+    }
+} // namespace ArchViz
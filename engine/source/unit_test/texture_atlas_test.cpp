@@ -0,0 +1,468 @@
+#include "runtime/core/thread/work_executor.h"
+#include "runtime/function/render/streaming/virtual_texture.h"
+#include "runtime/resource/resource_manager/compiler/texture_atlas.h"
+#include "runtime/resource/resource_manager/compiler/texture_cooker.h"
+
+#include "unit_test/test_utils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace ArchViz;
+using namespace std;
+
+namespace
+{
+    uint32_t align_up(uint32_t value, uint32_t alignment) { return (value + alignment - 1) / alignment * alignment; }
+
+    // r is the texture index, g / b the texel coordinates, so a texel from a neighbour is recognisable
+    std::shared_ptr<TextureData> make_texture(uint32_t index, uint32_t width, uint32_t height)
+    {
+        auto texture       = std::make_shared<TextureData>();
+        texture->m_width   = static_cast<int32_t>(width);
+        texture->m_height  = static_cast<int32_t>(height);
+        texture->m_channel = 4;
+        texture->m_srgb    = false;
+        texture->m_uri     = "texture_" + std::to_string(index);
+        texture->m_data.resize(static_cast<size_t>(width) * height * 4);
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                uint8_t* texel = texture->m_data.data() + (static_cast<size_t>(y) * width + x) * 4;
+                texel[0]       = static_cast<uint8_t>(index);
+                texel[1]       = static_cast<uint8_t>(x * 7);
+                texel[2]       = static_cast<uint8_t>(y * 13);
+                texel[3]       = 255;
+            }
+        }
+        return texture;
+    }
+
+    const uint8_t* texel_at(const TextureData& texture, uint32_t level, uint32_t x, uint32_t y)
+    {
+        const TextureLevel& info = texture.m_levels[level];
+        return texture.m_data.data() + info.offset + (static_cast<size_t>(y) * info.width + x) * 4;
+    }
+
+    bool test_pack()
+    {
+        std::mt19937                               random(7);
+        std::uniform_int_distribution<uint32_t>    size(8, 512);
+        std::vector<std::pair<uint32_t, uint32_t>> sizes;
+        for (uint32_t i = 0; i < 3000; ++i)
+        {
+            sizes.emplace_back(size(random), size(random));
+        }
+        sizes.emplace_back(1024, 64); // too large, stays standalone
+
+        TextureAtlasPacker packer;
+        auto               start      = std::chrono::high_resolution_clock::now();
+        auto               placements = packer.pack(sizes);
+        auto               end        = std::chrono::high_resolution_clock::now();
+
+        const uint32_t align = packer.alignment();
+        const uint32_t pad   = packer.padding();
+
+        bool all_placed = true;
+        bool in_bounds  = true;
+        bool aligned    = true;
+        for (size_t i = 0; i + 1 < sizes.size(); ++i)
+        {
+            const AtlasPlacement& placement = placements[i];
+            if (!placement.placed())
+            {
+                all_placed = false;
+                continue;
+            }
+            const AtlasPageInfo& page = packer.pages()[placement.atlas];
+            in_bounds &= placement.x >= pad && placement.y >= pad;
+            in_bounds &= placement.x + align_up(placement.width, align) + pad <= page.width && placement.y + align_up(placement.height, align) + pad <= page.height;
+            aligned &= placement.x % align == 0 && placement.y % align == 0;
+        }
+
+        // slots with their borders must not overlap
+        bool overlap = false;
+        for (size_t i = 0; i + 1 < sizes.size() && !overlap; ++i)
+        {
+            const AtlasPlacement& a = placements[i];
+            for (size_t j = i + 1; j + 1 < sizes.size(); ++j)
+            {
+                const AtlasPlacement& b = placements[j];
+                if (a.atlas != b.atlas)
+                {
+                    continue;
+                }
+                bool separate_x = a.x + align_up(a.width, align) + pad <= b.x - pad || b.x + align_up(b.width, align) + pad <= a.x - pad;
+                bool separate_y = a.y + align_up(a.height, align) + pad <= b.y - pad || b.y + align_up(b.height, align) + pad <= a.y - pad;
+                if (!separate_x && !separate_y)
+                {
+                    overlap = true;
+                    break;
+                }
+            }
+        }
+
+        uint64_t used = 0, total = 0;
+        for (const auto& page : packer.pages())
+        {
+            used += page.used_texels;
+            total += static_cast<uint64_t>(page.width) * page.height;
+        }
+
+        cout << "packed " << sizes.size() - 1 << " textures into " << packer.pages().size() << " atlases in "
+             << std::chrono::duration<double, std::milli>(end - start).count() << " ms, occupancy " << 100.0 * used / total << "%" << endl;
+
+        bool passed = true;
+        passed &= check("every small texture placed", all_placed);
+        passed &= check("oversized texture left standalone", !placements.back().placed());
+        passed &= check("slots inside their page", in_bounds);
+        passed &= check("entries aligned for every mip", aligned);
+        passed &= check("slots do not overlap", !overlap);
+        passed &= check("bind count reduced", packer.pages().size() * 20 < sizes.size());
+        return passed;
+    }
+
+    bool test_build(bool wrap, std::shared_ptr<WorkExecutor> executor)
+    {
+        TextureAtlasConfig config;
+        config.atlas_size = 512;
+        config.wrap       = wrap;
+
+        std::mt19937                               random(11);
+        std::uniform_int_distribution<uint32_t>    size(3, 90);
+        std::vector<std::shared_ptr<TextureData>>  textures;
+        std::vector<std::pair<uint32_t, uint32_t>> sizes;
+        for (uint32_t i = 1; i <= 60; ++i)
+        {
+            textures.push_back(make_texture(i, size(random), size(random)));
+            sizes.emplace_back(textures.back()->m_width, textures.back()->m_height);
+        }
+
+        TextureAtlasPacker packer(config);
+        auto               placements = packer.pack(sizes);
+        auto               atlases    = packer.build(textures, placements, executor);
+
+        const uint32_t align = packer.alignment();
+        const uint32_t pad   = packer.padding();
+
+        bool content  = true;
+        bool border   = true;
+        bool no_bleed = true;
+        bool levels   = atlases.size() == packer.pages().size();
+        for (size_t i = 0; i < textures.size() && levels; ++i)
+        {
+            const AtlasPlacement& placement = placements[i];
+            const TextureData&    atlas     = *atlases[placement.atlas];
+            levels &= atlas.mipLevels() == config.mip_levels;
+
+            // the entry's own chain, built the same way the packer does
+            TextureData       source = *textures[i];
+            TextureCookConfig mip_config;
+            mip_config.wrap = wrap;
+            TextureCooker::generateMips(source, mip_config, nullptr);
+
+            for (uint32_t level = 0; level < atlas.mipLevels(); ++level)
+            {
+                const TextureLevel& src_level = source.m_levels[std::min(level, source.mipLevels() - 1)];
+                const int32_t       w         = static_cast<int32_t>(src_level.width);
+                const int32_t       h         = static_cast<int32_t>(src_level.height);
+                const int32_t       b         = static_cast<int32_t>(pad >> level);
+                const int32_t       ox        = static_cast<int32_t>(placement.x >> level);
+                const int32_t       oy        = static_cast<int32_t>(placement.y >> level);
+                const int32_t       sw        = static_cast<int32_t>(align_up(placement.width, align) >> level);
+                const int32_t       sh        = static_cast<int32_t>(align_up(placement.height, align) >> level);
+
+                for (int32_t y = -b; y < sh + b; ++y)
+                {
+                    for (int32_t x = -b; x < sw + b; ++x)
+                    {
+                        const uint8_t* texel = texel_at(atlas, level, ox + x, oy + y);
+                        no_bleed &= texel[0] == i + 1;
+
+                        int32_t        sx       = wrap ? ((x % w) + w) % w : std::clamp(x, 0, w - 1);
+                        int32_t        sy       = wrap ? ((y % h) + h) % h : std::clamp(y, 0, h - 1);
+                        const uint8_t* expected = source.m_data.data() + src_level.offset + (static_cast<size_t>(sy) * w + sx) * 4;
+                        bool           inside   = x >= 0 && y >= 0 && x < w && y < h;
+                        (inside ? content : border) &= std::memcmp(texel, expected, 4) == 0;
+                    }
+                }
+            }
+        }
+
+        bool passed = true;
+        passed &= check(wrap ? "wrap atlas levels" : "clamp atlas levels", levels);
+        passed &= check(wrap ? "wrap atlas content matches every source mip" : "clamp atlas content matches every source mip", content);
+        passed &= check(wrap ? "wrap borders repeat the opposite edge" : "clamp borders extend the edge", border);
+        passed &= check(wrap ? "wrap mips never sample a neighbour" : "clamp mips never sample a neighbour", no_bleed);
+        return passed;
+    }
+
+    bool test_pages(std::shared_ptr<WorkExecutor> executor)
+    {
+        auto              texture = make_texture(1, 1000, 600);
+        TextureCookConfig mip_config;
+        mip_config.mip_filter = TextureMipFilter::Box;
+        TextureCooker::generateMips(*texture, mip_config, nullptr);
+
+        VirtualTextureConfig config;
+        VirtualTextureDesc   desc {1000, 600, texture->mipLevels()};
+
+        auto           clamped   = VirtualTexturePageTable::buildPages(*texture, config, false, executor);
+        auto           wrapped   = VirtualTexturePageTable::buildPages(*texture, config, true, executor);
+        const uint32_t physical  = config.physicalPageSize();
+        const size_t   page_size = static_cast<size_t>(physical) * physical * 4;
+        const uint32_t count     = VirtualTexturePageTable::pageCount(desc, config);
+
+        auto page_texel = [&](const std::vector<uint8_t>& pages, const VirtualPage& page, uint32_t x, uint32_t y) {
+            return pages.data() + VirtualTexturePageTable::pageIndex(desc, config, page) * page_size + (static_cast<size_t>(y) * physical + x) * 4;
+        };
+        const uint32_t b = config.page_border;
+
+        bool passed = true;
+        passed &= check("page count up to the tail", count == 8 * 5 + 4 * 3 + 2 * 2 + 1 && clamped.size() == count * page_size);
+        passed &= check("page payload", std::memcmp(page_texel(clamped, {0, 0, 1, 2}, b + 5, b + 7), texel_at(*texture, 0, 128 + 5, 256 + 7), 4) == 0);
+        passed &= check("page border from the neighbour", std::memcmp(page_texel(clamped, {0, 0, 1, 2}, 0, 0), texel_at(*texture, 0, 128 - b, 256 - b), 4) == 0);
+        passed &= check("clamped border at the edge", std::memcmp(page_texel(clamped, {0, 0, 0, 0}, 0, 0), texel_at(*texture, 0, 0, 0), 4) == 0);
+        passed &= check("wrapped border at the edge", std::memcmp(page_texel(wrapped, {0, 0, 0, 0}, 0, 0), texel_at(*texture, 0, 1000 - b, 600 - b), 4) == 0);
+        passed &= check("tail page", std::memcmp(page_texel(clamped, {0, 3, 0, 0}, b + 100, b + 70), texel_at(*texture, 3, 100, 70), 4) == 0);
+        return passed;
+    }
+
+    bool test_cache()
+    {
+        VirtualTextureCache cache(3);
+        uint64_t            evicted;
+
+        uint32_t a = cache.acquire(1, 1, false, evicted);
+        uint32_t b = cache.acquire(2, 1, false, evicted);
+        uint32_t c = cache.acquire(3, 1, true, evicted);
+
+        bool passed = true;
+        passed &= check("cache full within a frame", cache.acquire(4, 1, false, evicted) == VirtualTextureCache::k_no_slot);
+
+        cache.touch(a, 2);
+        uint32_t d = cache.acquire(4, 3, false, evicted);
+        passed &= check("least recently used evicted", d == b && evicted == 2);
+
+        d = cache.acquire(5, 4, false, evicted);
+        passed &= check("pinned slot kept", d == a && evicted == 1 && cache.key(c) == 3);
+
+        cache.release(c);
+        d = cache.acquire(6, 4, false, evicted);
+        passed &= check("released slot reused", d == c && evicted == VirtualTextureCache::k_no_key);
+        return passed;
+    }
+
+    // every page must resolve to a resident page that is itself or an ancestor, and the slot must hold it
+    bool table_consistent(const VirtualTexturePageTable& table, uint32_t texture)
+    {
+        for (uint32_t mip = 0; mip <= table.tailMip(texture); ++mip)
+        {
+            for (uint32_t y = 0; y < table.pagesY(texture, mip); ++y)
+            {
+                for (uint32_t x = 0; x < table.pagesX(texture, mip); ++x)
+                {
+                    uint32_t entry = table.entry({texture, mip, x, y});
+                    if (!virtual_page_entry_valid(entry))
+                    {
+                        return false;
+                    }
+                    uint32_t    entry_mip = virtual_page_entry_mip(entry);
+                    uint32_t    shift     = entry_mip - mip;
+                    VirtualPage source {texture, entry_mip, x >> shift, y >> shift};
+                    uint32_t    slot      = virtual_page_entry_y(entry) * table.m_config.physical_pages_x + virtual_page_entry_x(entry);
+                    if (entry_mip < mip || !table.resident(source) || table.cache().key(slot) != source.key())
+                    {
+                        return false;
+                    }
+                    // the closest resident ancestor, nothing finer was skipped
+                    for (uint32_t finer = mip; finer < entry_mip; ++finer)
+                    {
+                        if (table.resident({texture, finer, x >> (finer - mip), y >> (finer - mip)}))
+                        {
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    void complete_requests(VirtualTexturePageTable& table)
+    {
+        for (const auto& request : table.requests())
+        {
+            table.onPageLoaded(request.page);
+        }
+    }
+
+    bool test_page_table()
+    {
+        VirtualTextureConfig config;
+        config.physical_pages_x = 4;
+        config.physical_pages_y = 4;
+        config.max_requests     = 8;
+
+        VirtualTexturePageTable table(config);
+        uint32_t                texture = table.addTexture({2048, 2048, 12});
+
+        bool passed = true;
+        passed &= check("tail mip fits one page", table.tailMip(texture) == 4);
+
+        table.update({});
+        passed &= check("tail requested first", table.requests().size() == 1 && table.requests()[0].page.mip == 4);
+        complete_requests(table);
+        table.update({});
+        passed &= check("tail backs every page", table_consistent(table, texture) && table.dirtyTables().size() == 1);
+
+        table.update({{texture, 0, 5, 5}});
+        bool coarse_first = table.requests().size() == 4;
+        for (size_t i = 0; coarse_first && i < table.requests().size(); ++i)
+        {
+            coarse_first &= table.requests()[i].page.mip == 3 - i;
+        }
+        passed &= check("missing ancestors requested coarse first", coarse_first);
+        passed &= check("fallback while loading", virtual_page_entry_mip(table.entry({texture, 0, 5, 5})) == 4);
+
+        complete_requests(table);
+        table.update({{texture, 0, 5, 5}});
+        passed &= check("loaded page mapped", virtual_page_entry_mip(table.entry({texture, 0, 5, 5})) == 0 && table.requests().empty());
+        passed &= check("neighbour falls back to the parent", virtual_page_entry_mip(table.entry({texture, 0, 4, 4})) == 1);
+        passed &= check("table consistent", table_consistent(table, texture));
+
+        // a camera moving across the texture with a cache far too small for it
+        std::mt19937                            random(3);
+        std::uniform_int_distribution<uint32_t> jitter(0, 3);
+        bool                                    consistent  = true;
+        bool                                    within      = true;
+        bool                                    tail_kept   = true;
+        bool                                    lru_victims = true;
+        uint32_t                                evictions   = 0;
+        for (uint32_t frame = 0; frame < 200; ++frame)
+        {
+            std::vector<VirtualPage> feedback;
+            uint32_t                 cx = (frame / 4) % 14;
+            for (uint32_t i = 0; i < 6; ++i)
+            {
+                feedback.push_back({texture, jitter(random) / 2, (cx + jitter(random)) >> (jitter(random) / 2), (cx / 2 + jitter(random)) >> (jitter(random) / 2)});
+            }
+
+            std::vector<uint64_t> wanted_keys;
+            for (auto page : feedback)
+            {
+                wanted_keys.push_back(page.key());
+            }
+
+            complete_requests(table);
+            table.update(feedback);
+
+            for (const auto& eviction : table.evictions())
+            {
+                tail_kept &= eviction.page.mip != table.tailMip(texture);
+                lru_victims &= std::find(wanted_keys.begin(), wanted_keys.end(), eviction.page.key()) == wanted_keys.end();
+                evictions += 1;
+            }
+            within &= table.cache().usedCount() <= 16;
+            consistent &= table_consistent(table, texture);
+        }
+
+        passed &= check("cache stays within its slots", within);
+        passed &= check("tail never evicted", tail_kept);
+        passed &= check("pages sampled this frame never evicted", lru_victims && evictions > 0);
+        passed &= check("table consistent while streaming", consistent);
+        return passed;
+    }
+
+    // only a tail that covers the whole texture in one page is pinned, a chain cut short pages its last level
+    bool test_short_chain()
+    {
+        VirtualTextureConfig config;
+        config.physical_pages_x = 4;
+        config.physical_pages_y = 4;
+        config.max_requests     = 16;
+
+        VirtualTexturePageTable table(config);
+        uint32_t                full        = table.addTexture({2048, 2048, 12});
+        uint32_t                short_chain = table.addTexture({512, 512, 2});
+
+        table.update({});
+        complete_requests(table);
+        table.update({{short_chain, 1, 1, 0}, {short_chain, 1, 0, 1}, {short_chain, 1, 1, 1}});
+        complete_requests(table);
+
+        uint32_t pinned      = 0;
+        bool     full_pinned = false;
+        for (uint32_t slot = 0; slot < config.physical_pages_x * config.physical_pages_y; ++slot)
+        {
+            if (table.cache().pinned(slot))
+            {
+                pinned += 1;
+                full_pinned |= table.cache().key(slot) == VirtualPage {full, 4, 0, 0}.key();
+            }
+        }
+
+        bool passed = true;
+        passed &= check("short chain tail spans pages", table.tailMip(short_chain) == 1 && table.pagesX(short_chain, 1) == 2 && table.pagesY(short_chain, 1) == 2);
+        passed &= check("short chain tail loaded", table.resident({short_chain, 1, 1, 1}) && table.resident({full, 4, 0, 0}));
+        passed &= check("only the one page tail pinned", pinned == 1 && full_pinned);
+        return passed;
+    }
+
+    bool test_page_table_scale()
+    {
+        VirtualTextureConfig    config;
+        VirtualTexturePageTable table(config);
+        for (uint32_t i = 0; i < 64; ++i)
+        {
+            table.addTexture({16384, 16384, 15});
+        }
+        table.update({});
+        complete_requests(table);
+
+        std::mt19937                            random(5);
+        std::uniform_int_distribution<uint32_t> texture(0, 63);
+        std::uniform_int_distribution<uint32_t> page(0, 127);
+
+        double total_ms = 0.0;
+        for (uint32_t frame = 0; frame < 60; ++frame)
+        {
+            std::vector<VirtualPage> feedback;
+            for (uint32_t i = 0; i < 4096; ++i)
+            {
+                feedback.push_back({texture(random), 0, page(random), page(random)});
+            }
+            auto start = std::chrono::high_resolution_clock::now();
+            table.update(feedback);
+            auto end = std::chrono::high_resolution_clock::now();
+            total_ms += std::chrono::duration<double, std::milli>(end - start).count();
+            complete_requests(table);
+        }
+
+        cout << "page table update, 64 textures 16k, 4096 feedback pages: " << total_ms / 60.0 << " ms per frame" << endl;
+        return check("page table scale", table.cache().usedCount() == config.physical_pages_x * config.physical_pages_y);
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::shared_ptr<WorkExecutor> executor = std::make_shared<WorkExecutor>();
+
+    bool passed = true;
+    passed &= test_pack();
+    passed &= test_build(false, nullptr);
+    passed &= test_build(true, executor);
+    passed &= test_pages(executor);
+    passed &= test_cache();
+    passed &= test_page_table();
+    passed &= test_short_chain();
+    passed &= test_page_table_scale();
+
+    cout << (passed ? "all passed" : "some failed") << endl;
+    return passed ? 0 : 1;
+}
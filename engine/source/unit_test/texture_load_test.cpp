@@ -1,14 +1,44 @@
+#include "runtime/core/thread/work_executor.h"
 #include "runtime/platform/file_system/vfs.h"
 #include "runtime/resource/asset_manager/asset_manager.h"
 #include "runtime/resource/config_manager/config_manager.h"
+#include "runtime/resource/resource_manager/compiler/bc_codec.h"
+#include "runtime/resource/resource_manager/compiler/texture_cooker.h"
+#include "runtime/resource/resource_manager/loader/ktx2_file.h"
 
+#include "unit_test/test_utils.h"
+
+#include <stb_image.h>
+
+#include <cstring>
 #include <filesystem>
 #include <iostream>
 #include <memory>
+#include <vector>
 
 using namespace ArchViz;
 using namespace std;
 
+namespace
+{
+    double cook_ms(const TextureData& source, TextureMipFilter filter, std::shared_ptr<WorkExecutor> executor, TextureData& result)
+    {
+        TextureCookConfig config;
+        config.mip_filter = filter;
+
+        result = source;
+        return elapsed_ms([&]() { TextureCooker::generateMips(result, config, executor); });
+    }
+
+    struct CompressCase
+    {
+        const char*   name;
+        TextureFormat format;
+        uint32_t      channel_count; // channels the format keeps, compared by psnr
+        double        min_psnr;
+    };
+} // namespace
+
 int main(int argc, char** argv)
 {
     std::filesystem::path executable_path(argv[0]);
@@ -18,7 +48,124 @@ int main(int argc, char** argv)
     std::shared_ptr<ConfigManager> config_manager = std::make_shared<ConfigManager>();
     config_manager->initialize(config_file_path.generic_string());
 
+    auto image_path = argc > 1 ? std::filesystem::path(argv[1]) : config_manager->getRootFolder() / "asset-test/data/model/buster_drone/Assets/Models/Public/BusterDrone/Materials/body_albedo2048.png";
+    cout << "image: " << image_path << endl;
+
+    TextureData source;
+    {
+        stbi_uc* pixels = nullptr;
+        double   ms     = elapsed_ms([&]() { pixels = stbi_load(image_path.generic_string().c_str(), &source.m_width, &source.m_height, &source.m_channel, STBI_rgb_alpha); });
+        if (!pixels)
+        {
+            cout << "failed to load " << image_path << endl;
+            return 1;
+        }
+        source.m_data.assign(pixels, pixels + static_cast<size_t>(source.m_width) * source.m_height * 4);
+        source.m_uri = image_path.generic_string();
+        stbi_image_free(pixels);
+
+        cout << "decode: " << ms << " ms, " << source.m_width << "x" << source.m_height << endl;
+    }
+
+    std::shared_ptr<WorkExecutor> executor = std::make_shared<WorkExecutor>();
+
+    TextureData box, kaiser, kaiser_parallel;
+    cout << "box mips (1 thread): " << cook_ms(source, TextureMipFilter::Box, nullptr, box) << " ms" << endl;
+    cout << "kaiser mips (1 thread): " << cook_ms(source, TextureMipFilter::Kaiser, nullptr, kaiser) << " ms" << endl;
+    cout << "kaiser mips (" << std::thread::hardware_concurrency() << " threads): " << cook_ms(source, TextureMipFilter::Kaiser, executor, kaiser_parallel) << " ms, levels "
+         << kaiser_parallel.mipLevels() << endl;
+
+    bool passed = true;
+    if (kaiser.m_data != kaiser_parallel.m_data)
+    {
+        cout << "[FAIL] parallel mips differ from single thread" << endl;
+        passed = false;
+    }
+    if (std::memcmp(kaiser.m_data.data(), source.m_data.data(), source.m_data.size()) != 0)
+    {
+        cout << "[FAIL] level 0 changed" << endl;
+        passed = false;
+    }
+    const TextureLevel& last = kaiser.m_levels.back();
+    if (last.width != 1 || last.height != 1 || last.offset + last.size != kaiser.m_data.size())
+    {
+        cout << "[FAIL] mip chain layout" << endl;
+        passed = false;
+    }
+
+    // ktx2 round trip
+    {
+        std::filesystem::path ktx_path = std::filesystem::temp_directory_path() / "texture_load_test.ktx2";
+
+        bool                         saved = false;
+        std::shared_ptr<TextureData> loaded;
+
+        double save_ms = elapsed_ms([&]() { saved = Ktx2File::save(ktx_path, kaiser); });
+        double load_ms = elapsed_ms([&]() { loaded = Ktx2File::load(ktx_path, source.m_uri); });
+
+        cout << "ktx2 save: " << save_ms << " ms, load: " << load_ms << " ms, " << std::filesystem::file_size(ktx_path) << " bytes" << endl;
+
+        if (!saved || loaded == nullptr || loaded->m_data != kaiser.m_data || loaded->mipLevels() != kaiser.mipLevels() || loaded->m_srgb != kaiser.m_srgb)
+        {
+            cout << "[FAIL] ktx2 round trip" << endl;
+            passed = false;
+        }
+        std::filesystem::remove(ktx_path);
+    }
+
+    // block compression of level 0, speed and quality against the decoded blocks
+    {
+        const CompressCase cases[] = {
+            {"bc1", TextureFormat::BC1, 3, 28.0},
+            {"bc3", TextureFormat::BC3, 4, 28.0},
+            {"bc4", TextureFormat::BC4, 1, 35.0},
+            {"bc5", TextureFormat::BC5, 2, 35.0},
+            {"bc7", TextureFormat::BC7, 4, 32.0},
+        };
+
+        const uint32_t width       = static_cast<uint32_t>(source.m_width);
+        const uint32_t height      = static_cast<uint32_t>(source.m_height);
+        const double   mega_pixels = static_cast<double>(width) * height / 1e6;
+
+        std::vector<uint8_t> decoded(source.m_data.size());
+        for (const auto& test : cases)
+        {
+            std::vector<uint8_t> blocks(texture_level_size(test.format, width, height));
+
+            double ms = elapsed_ms([&]() { BCCodec::encodeImage(test.format, source.m_data.data(), width, height, blocks.data(), executor); });
+
+            BCCodec::decodeImage(test.format, blocks.data(), width, height, decoded.data());
+
+            double psnr = BCCodec::computePSNR(source.m_data.data(), decoded.data(), static_cast<size_t>(width) * height, test.channel_count);
+            cout << test.name << ": " << ms << " ms, " << mega_pixels / (ms / 1000.0) << " MP/s, psnr " << psnr << " dB" << endl;
+
+            if (psnr < test.min_psnr)
+            {
+                cout << "[FAIL] " << test.name << " psnr below " << test.min_psnr << " dB" << endl;
+                passed = false;
+            }
+        }
+    }
+
+    // compressed mip chain through ktx2
+    {
+        TextureData compressed = kaiser;
+        TextureCooker::compress(compressed, TextureFormat::BC7, executor);
+
+        std::filesystem::path ktx_path = std::filesystem::temp_directory_path() / "texture_load_test_bc7.ktx2";
+        bool                  saved    = Ktx2File::save(ktx_path, compressed);
+
+        std::shared_ptr<TextureData> loaded = Ktx2File::load(ktx_path, source.m_uri);
+        cout << "bc7 ktx2: " << std::filesystem::file_size(ktx_path) << " bytes, rgba8 " << kaiser.m_data.size() << " bytes" << endl;
 
+        if (!saved || loaded == nullptr || loaded->m_format != TextureFormat::BC7 || loaded->m_data != compressed.m_data || loaded->mipLevels() != kaiser.mipLevels())
+        {
+            cout << "[FAIL] bc7 ktx2 round trip" << endl;
+            passed = false;
+        }
+        std::filesystem::remove(ktx_path);
+    }
 
-    return 0;
+    cout << (passed ? "all passed" : "some failed") << endl;
+    return passed ? 0 : 1;
 }
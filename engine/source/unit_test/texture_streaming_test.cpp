@@ -0,0 +1,311 @@
+#include "runtime/core/math/math.h"
+#include "runtime/function/render/streaming/texture_streaming.h"
+
+#include "unit_test/test_utils.h"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace ArchViz;
+using namespace std;
+
+namespace
+{
+    constexpr float k_fov    = 45.0f;
+    constexpr float k_height = 1080.0f;
+
+    StreamingView make_view(const FVector3& eye, const FVector3& center)
+    {
+        StreamingView view;
+        view.position        = eye;
+        view.pixels_per_unit = k_height * 0.5f / std::tan(Math::degreesToRadians(k_fov) * 0.5f);
+        view.frustum.update(Math::perspective(k_fov, 16.0f / 9.0f, 0.1f, 5000.0f) * Math::lookAt(eye, center, FVector3(0.0f, 1.0f, 0.0f)));
+        return view;
+    }
+
+    StreamingTextureDesc make_desc(uint32_t size, TextureFormat format = TextureFormat::BC7)
+    {
+        StreamingTextureDesc desc;
+        desc.width      = size;
+        desc.height     = size;
+        desc.mip_levels = static_cast<uint32_t>(std::log2(size)) + 1;
+        desc.format     = format;
+        return desc;
+    }
+
+    // the streamer finishes everything requested last frame
+    void complete_requests(TextureStreamingPlanner& planner)
+    {
+        for (const auto& request : planner.requests())
+        {
+            planner.onMipLoaded(request.texture, request.mip);
+        }
+    }
+
+    bool test_screen_size()
+    {
+        TextureStreamingPlanner planner;
+        uint32_t                texture = planner.addTexture(make_desc(2048));
+
+        bool passed = true;
+        passed &= check("tail resident up front", planner.residentMip(texture) == planner.tailMip(texture) && planner.tailMip(texture) == 4);
+
+        planner.update(make_view(FVector3::Zero(), FVector3(0.0f, 0.0f, -1.0f)), {});
+        passed &= check("unused texture stays at the tail", planner.requests().empty() && planner.targetMip(texture) == 4);
+
+        std::vector<float> wanted;
+        // surface distances 1, 16 and 160, the last two stay finer than the tail
+        for (float distance : {11.0f, 26.0f, 170.0f})
+        {
+            StreamingInstance instance;
+            instance.texture = texture;
+            instance.center  = FVector3(0.0f, 0.0f, -distance);
+            instance.radius  = 10.0f;
+            planner.update(make_view(FVector3::Zero(), FVector3(0.0f, 0.0f, -1.0f)), {instance});
+            wanted.push_back(planner.wantedMip(texture));
+        }
+        passed &= check("close instance wants mip 0", wanted[0] == 0.0f);
+        passed &= check("ten times further is about log2(10) mips coarser", std::fabs((wanted[2] - wanted[1]) - std::log2(10.0f)) < 0.01f);
+
+        // offscreen instances are biased, not dropped
+        StreamingInstance behind;
+        behind.texture = texture;
+        behind.center  = FVector3(0.0f, 0.0f, 26.0f);
+        behind.radius  = 10.0f;
+        planner.update(make_view(FVector3::Zero(), FVector3(0.0f, 0.0f, -1.0f)), {behind});
+        passed &= check("offscreen bias", std::fabs(planner.wantedMip(texture) - (wanted[1] + planner.m_config.offscreen_mip_bias)) < 0.01f);
+        return passed;
+    }
+
+    bool test_budget()
+    {
+        TextureStreamingConfig config;
+        config.memory_budget = 8ull << 20;
+        config.upload_budget = 2ull << 20;
+
+        TextureStreamingPlanner        planner(config);
+        std::vector<StreamingInstance> instances;
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            StreamingInstance instance;
+            instance.texture = planner.addTexture(make_desc(2048));
+            instance.center  = FVector3(static_cast<float>(i) - 8.0f, 0.0f, -10.0f - static_cast<float>(i) * 4.0f);
+            instance.radius  = 4.0f;
+            instances.push_back(instance);
+        }
+
+        bool within_budget = true;
+        bool within_upload = true;
+        for (int frame = 0; frame < 64; ++frame)
+        {
+            planner.update(make_view(FVector3::Zero(), FVector3(0.0f, 0.0f, -1.0f)), instances);
+            within_budget &= planner.statistics().committed_bytes <= config.memory_budget;
+            within_upload &= planner.statistics().requested_bytes <= config.upload_budget || planner.requests().size() == 1;
+            complete_requests(planner);
+        }
+
+        const TextureStreamingStatistics& statistics = planner.statistics();
+        cout << "budget: committed " << statistics.committed_bytes / 1024 << " KB, limited " << statistics.budget_limited_count << " / " << planner.textureCount() << endl;
+
+        bool passed = true;
+        passed &= check("committed memory within budget", within_budget);
+        passed &= check("uploads within budget", within_upload);
+        passed &= check("budget limits some textures", statistics.budget_limited_count > 0);
+        passed &= check("converged to the targets", statistics.resident_at_target_count == planner.textureCount() && planner.requests().empty());
+        passed &= check("closest texture is the sharpest", planner.residentMip(instances.front().texture) <= planner.residentMip(instances.back().texture));
+        return passed;
+    }
+
+    bool test_eviction()
+    {
+        TextureStreamingPlanner        planner;
+        std::vector<StreamingInstance> instances;
+        for (uint32_t i = 0; i < 8; ++i)
+        {
+            StreamingInstance instance;
+            instance.texture = planner.addTexture(make_desc(1024));
+            instance.center  = FVector3(static_cast<float>(i), 0.0f, -2.0f);
+            instance.radius  = 1.0f;
+            instances.push_back(instance);
+        }
+
+        const StreamingView view = make_view(FVector3::Zero(), FVector3(0.0f, 0.0f, -1.0f));
+        for (int frame = 0; frame < 32; ++frame)
+        {
+            planner.update(view, instances);
+            complete_requests(planner);
+        }
+        const uint64_t full = planner.statistics().committed_bytes;
+
+        // nothing in view: under budget the mips stay cached
+        planner.update(view, {});
+        bool passed = check("surplus kept under budget", planner.evictions().empty() && planner.statistics().committed_bytes == full);
+
+        planner.m_config.memory_budget = full / 4;
+        planner.update(view, {});
+
+        bool above_tail = true;
+        for (uint32_t i = 0; i < planner.textureCount(); ++i)
+        {
+            above_tail &= planner.residentMip(i) <= planner.tailMip(i);
+        }
+        passed &= check("evicted to the budget", !planner.evictions().empty() && planner.statistics().committed_bytes <= planner.m_config.memory_budget);
+        passed &= check("tails never evicted", above_tail);
+        return passed;
+    }
+
+    // the budget drops the target below loads still in flight while the resident mip is coarser than it
+    bool test_eviction_in_flight()
+    {
+        TextureStreamingConfig config;
+        config.upload_budget = 64ull << 20;
+
+        const StreamingTextureDesc desc = make_desc(1024);
+
+        TextureStreamingPlanner planner(config);
+        StreamingInstance       instance;
+        instance.texture = planner.addTexture(desc);
+        instance.center  = FVector3(0.0f, 0.0f, -2.0f);
+        instance.radius  = 1.0f;
+
+        const StreamingView view = make_view(FVector3::Zero(), FVector3(0.0f, 0.0f, -1.0f));
+        const uint32_t      tail = planner.tailMip(instance.texture);
+
+        // every mip down to 0 requested, none of them arrived
+        planner.update(view, {instance});
+        bool passed = check("whole chain in flight", planner.requests().size() == tail && planner.requests().back().mip == 0);
+
+        planner.m_config.memory_budget = TextureStreamingPlanner::chainBytes(desc, 2);
+        planner.update(view, {instance});
+        passed &= check("target lowered by the budget", planner.targetMip(instance.texture) == 2);
+        passed &= check("resident mip not raised past what arrived", planner.residentMip(instance.texture) == tail);
+
+        // the loads finer than the target are dropped, the ones down to it still land
+        planner.onMipLoaded(instance.texture, 1);
+        passed &= check("load past the target dropped", planner.residentMip(instance.texture) == tail);
+        for (uint32_t mip = tail; mip-- > 2;)
+        {
+            planner.onMipLoaded(instance.texture, mip);
+        }
+        passed &= check("loads down to the target land", planner.residentMip(instance.texture) == 2);
+        return passed;
+    }
+
+    bool test_feedback()
+    {
+        TextureStreamingPlanner planner;
+        uint32_t                texture = planner.addTexture(make_desc(4096));
+
+        StreamingInstance instance;
+        instance.texture = texture;
+        instance.center  = FVector3(0.0f, 0.0f, -15.0f);
+        instance.radius  = 2.0f;
+
+        const StreamingView view = make_view(FVector3::Zero(), FVector3(0.0f, 0.0f, -1.0f));
+        planner.update(view, {instance});
+        const float estimate = planner.wantedMip(texture);
+
+        // the gpu keeps sampling one mip coarser than the bounds suggest, e.g. a texture tiled less than assumed
+        for (int frame = 0; frame < 64; ++frame)
+        {
+            planner.reportFeedback(texture, estimate + 1.0f);
+            planner.update(view, {instance});
+        }
+
+        bool passed = true;
+        passed &= check("feedback bias converges", std::fabs(planner.feedbackBias(texture) - 1.0f) < 0.01f);
+        passed &= check("wanted mip follows the feedback", std::fabs(planner.wantedMip(texture) - (estimate + 1.0f)) < 0.01f);
+        return passed;
+    }
+
+    // architectural scene flythrough: thousands of textured objects on a grid, loads land one frame later
+    void simulate()
+    {
+        std::mt19937                            rng(7);
+        std::uniform_real_distribution<float>   position_dist(-1000.0f, 1000.0f);
+        std::uniform_real_distribution<float>   radius_dist(2.0f, 30.0f);
+        std::uniform_int_distribution<uint32_t> size_dist(10, 12);
+
+        TextureStreamingConfig config;
+        config.memory_budget = 256ull << 20;
+        config.upload_budget = 16ull << 20;
+
+        TextureStreamingPlanner planner(config);
+        const uint32_t          texture_count = 4000;
+        for (uint32_t i = 0; i < texture_count; ++i)
+        {
+            planner.addTexture(make_desc(1u << size_dist(rng)));
+        }
+
+        std::vector<StreamingInstance> instances(20000);
+        std::uniform_int_distribution<uint32_t> texture_dist(0, texture_count - 1);
+        for (auto& instance : instances)
+        {
+            instance.texture  = texture_dist(rng);
+            instance.center   = FVector3(position_dist(rng), 0.0f, position_dist(rng));
+            instance.radius   = radius_dist(rng);
+            instance.uv_scale = instance.radius / 4.0f; // ~4 m texture repeat
+        }
+
+        const int frame_count = 400;
+        double    total_ms    = 0.0;
+        double    max_ms      = 0.0;
+        uint64_t  max_bytes   = 0;
+        uint64_t  streamed    = 0;
+        uint64_t  evicted     = 0;
+        double    at_target   = 0.0;
+
+        for (int frame = 0; frame < frame_count; ++frame)
+        {
+            float    t   = static_cast<float>(frame) / frame_count;
+            FVector3 eye = FVector3(-900.0f + 1800.0f * t, 20.0f, 300.0f * std::sin(t * 6.0f));
+
+            StreamingView view = make_view(eye, eye + FVector3(1.0f, -0.1f, 0.3f * std::cos(t * 6.0f)));
+
+            auto start = std::chrono::high_resolution_clock::now();
+            planner.update(view, instances);
+            auto end = std::chrono::high_resolution_clock::now();
+
+            double ms = std::chrono::duration<double, std::milli>(end - start).count();
+            total_ms += ms;
+            max_ms = std::max(max_ms, ms);
+
+            const TextureStreamingStatistics& statistics = planner.statistics();
+            max_bytes = std::max(max_bytes, statistics.committed_bytes);
+            streamed += statistics.requested_bytes;
+            evicted += statistics.evicted_bytes;
+            at_target += static_cast<double>(statistics.resident_at_target_count) / texture_count;
+
+            complete_requests(planner);
+        }
+
+        uint64_t full_bytes = 0;
+        for (uint32_t i = 0; i < texture_count; ++i)
+        {
+            full_bytes += TextureStreamingPlanner::chainBytes(make_desc(1u << size_dist(rng)), 0);
+        }
+
+        cout << "simulation: " << texture_count << " textures, " << instances.size() << " instances, " << frame_count << " frames" << endl;
+        cout << "  update " << total_ms / frame_count << " ms avg, " << max_ms << " ms max" << endl;
+        cout << "  peak committed " << (max_bytes >> 20) << " MB of " << (config.memory_budget >> 20) << " MB budget, fully resident ~" << (full_bytes >> 20) << " MB" << endl;
+        cout << "  streamed " << (streamed >> 20) << " MB, evicted " << (evicted >> 20) << " MB, resident at target " << at_target / frame_count * 100.0 << " % of frames" << endl;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    bool passed = true;
+    passed &= test_screen_size();
+    passed &= test_budget();
+    passed &= test_eviction();
+    passed &= test_eviction_in_flight();
+    passed &= test_feedback();
+
+    simulate();
+
+    cout << (passed ? "all passed" : "some failed") << endl;
+    return passed ? 0 : 1;
+}
@@ -36,6 +36,7 @@ int main(int argc, char** argv)
     std::shared_ptr<RenderSystem> render_system = std::make_shared<RenderSystem>();
     RenderSystemInitInfo render_init_info;
     render_init_info.window_system = window_system;
+    render_init_info.executor      = g_runtime_global_context.m_work_executor;
     render_system->initialize(render_init_info);
 
     using namespace std::chrono;